@@ -240,9 +240,9 @@ void SVNRepos::dump(File &path, OutputStream &dataOut,
                      " (%ld)"), youngest), );
     }
 
-  SVN_JNI_ERR(svn_repos_dump_fs4(repos, dataOut.getStream(requestPool),
+  SVN_JNI_ERR(svn_repos_dump_fs5(repos, dataOut.getStream(requestPool),
                                  lower, upper, incremental, useDeltas,
-                                 true, true,
+                                 true, true, 1,
                                  notifyCallback != NULL
                                     ? ReposNotifyCallback::notify
                                     : NULL,
@@ -269,9 +269,9 @@ void SVNRepos::hotcopy(File &path, File &targetPath,
       return;
     }
 
-  SVN_JNI_ERR(svn_repos_hotcopy3(path.getInternalStyle(requestPool),
+  SVN_JNI_ERR(svn_repos_hotcopy4(path.getInternalStyle(requestPool),
                                  targetPath.getInternalStyle(requestPool),
-                                 cleanLogs, incremental,
+                                 cleanLogs, incremental, 1,
                                  notifyCallback != NULL
                                     ? ReposNotifyCallback::notify
                                     : NULL,
@@ -369,10 +369,11 @@ void SVNRepos::load(File &path,
                               path.getInternalStyle(requestPool), NULL,
                               requestPool.getPool(), requestPool.getPool()), );
 
-  SVN_JNI_ERR(svn_repos_load_fs6(repos, dataIn.getStream(requestPool),
+  SVN_JNI_ERR(svn_repos_load_fs7(repos, dataIn.getStream(requestPool),
                                  lower, upper, uuid_action, relativePath,
                                  usePreCommitHook, usePostCommitHook,
                                  validateProps, ignoreDates, normalizeProps,
+                                 1,
                                  notifyCallback != NULL
                                     ? ReposNotifyCallback::notify
                                     : NULL,
@@ -641,9 +642,10 @@ SVNRepos::verify(File &path, Revision &revisionStart, Revision &revisionEnd,
       (SVN_ERR_INCORRECT_PARAMS, NULL,
        _("Start revision cannot be higher than end revision")), );
 
-  SVN_JNI_ERR(svn_repos_verify_fs3(repos, lower, upper,
+  SVN_JNI_ERR(svn_repos_verify_fs4(repos, lower, upper,
                                    checkNormalization,
                                    metadataOnly,
+                                   1 /* jobs */,
                                    (!notifyCallback ? NULL
                                     : ReposNotifyCallback::notify),
                                    notifyCallback,
@@ -669,7 +671,7 @@ void SVNRepos::pack(File &path, ReposNotifyCallback *notifyCallback)
                               path.getInternalStyle(requestPool), NULL,
                               requestPool.getPool(), requestPool.getPool()), );
 
-  SVN_JNI_ERR(svn_repos_fs_pack2(repos,
+  SVN_JNI_ERR(svn_repos_fs_pack3(repos, 1,
                                  notifyCallback != NULL
                                     ? ReposNotifyCallback::notify
                                     : NULL,
@@ -115,6 +115,11 @@ typedef struct svn_memcache_t svn_memcache_t;
  */
 typedef struct svn_membuffer_t svn_membuffer_t;
 
+/**
+ * An opaque structure representing a persistent, file-based cache store.
+ */
+typedef struct svn_cache__persistent_store_t svn_cache__persistent_store_t;
+
 /**
  * Opaque type for an in-memory cache.
  */
@@ -148,6 +153,17 @@ typedef struct svn_cache__info_t
    */
   apr_uint64_t failures;
 
+  /** Number of getter calls through all cache instances sharing the same
+   * key prefix as this one, i.e. accessing the same kind of data.
+   * Unlike @a gets, this will not be reset.
+   * May be 0 if that information is not available.
+   */
+  apr_uint64_t prefix_gets;
+
+  /** Number of @a prefix_gets that returned data.
+   */
+  apr_uint64_t prefix_hits;
+
   /** Size of the data currently stored in the cache.
    * May be 0 if that information is not available.
    */
@@ -270,6 +286,89 @@ svn_cache__make_memcache_from_config(svn_memcache_t **memcache_p,
                                      apr_pool_t *result_pool,
                                      apr_pool_t *scratch_pool);
 
+/**
+ * Open the persistent cache store file at @a path and return it in
+ * @a *store_p.  The file will be created if it does not exist yet.
+ *
+ * The contents of an existing file will only be used if it has been
+ * written with the same @a version tag, which should identify the data
+ * source as well as the layout of the serialized data.  Otherwise, the
+ * file gets replaced with an empty one.
+ *
+ * All data present in the file when it is being opened becomes available
+ * through the store (memory-mapped, if APR supports that).  Data added
+ * by other processes will only be visible to stores opened afterwards.
+ * Adding a different value for an existing key supersedes the old one;
+ * adding an identical value is a no-op.  Once the file would grow beyond
+ * @a max_size bytes, it gets replaced with a copy that keeps only the
+ * newest entries.
+ *
+ * If @a shared is set, return a process-wide instance for @a path and
+ * @a version, opening the file only once.  In that case, @a result_pool
+ * will not be used.  Otherwise, allocate the store in @a result_pool.
+ * Use @a scratch_pool for temporary allocations.
+ */
+svn_error_t *
+svn_cache__persistent_store_open(svn_cache__persistent_store_t **store_p,
+                                 const char *path,
+                                 const char *version,
+                                 apr_size_t max_size,
+                                 svn_boolean_t shared,
+                                 apr_pool_t *result_pool,
+                                 apr_pool_t *scratch_pool);
+
+/**
+ * Set @a *stamp to the stamp last set for @a store or to NULL if there
+ * is none.  Stamps allow users to tell whether the cached data still
+ * matches its source.  Allocate the result in @a result_pool.
+ */
+svn_error_t *
+svn_cache__persistent_store_get_stamp(const char **stamp,
+                                      svn_cache__persistent_store_t *store,
+                                      apr_pool_t *result_pool);
+
+/**
+ * Set the stamp of @a store to @a stamp.  This is a no-op if @a store is
+ * read-only.  Use @a scratch_pool for temporary allocations.
+ */
+svn_error_t *
+svn_cache__persistent_store_set_stamp(svn_cache__persistent_store_t *store,
+                                      const char *stamp,
+                                      apr_pool_t *scratch_pool);
+
+/**
+ * Remove all entries and the stamp from @a store.  If @a store is
+ * read-only, only stop using its contents in this process.  Use
+ * @a scratch_pool for temporary allocations.
+ */
+svn_error_t *
+svn_cache__persistent_store_reset(svn_cache__persistent_store_t *store,
+                                  apr_pool_t *scratch_pool);
+
+/**
+ * Creates a new cache in @a *cache_p that uses @a store as a persistent
+ * second level behind @a l1_cache.  Lookups that miss @a l1_cache will
+ * be served from @a store and the result be put into @a l1_cache.  New
+ * entries get written to both levels.
+ *
+ * @a id identifies this cache within @a store and must be non-empty and
+ * unique for all caches sharing the same store.  @a serialize_func,
+ * @a deserialize_func and @a klen must match those of @a l1_cache.  The
+ * partial setter updates both levels; iteration only covers @a l1_cache.
+ *
+ * These caches are thread safe if @a l1_cache is.  Allocate the cache in
+ * @a result_pool.
+ */
+svn_error_t *
+svn_cache__create_persistent(svn_cache__t **cache_p,
+                             svn_cache__t *l1_cache,
+                             svn_cache__persistent_store_t *store,
+                             const char *id,
+                             svn_cache__serialize_func_t serialize_func,
+                             svn_cache__deserialize_func_t deserialize_func,
+                             apr_ssize_t klen,
+                             apr_pool_t *result_pool);
+
 /**
  * Creates a new membuffer cache object in @a *cache. It will contain
  * up to @a total_size bytes of data, using @a directory_size bytes
@@ -310,6 +409,30 @@ svn_cache__membuffer_cache_create(svn_membuffer_t **cache,
                                   svn_boolean_t allow_blocking_writes,
                                   apr_pool_t *result_pool);
 
+/**
+ * Like svn_cache__membuffer_cache_create() but place all cache segments
+ * in an anonymous shared memory region.  Processes forked from the caller
+ * after this call will then share the cache contents with it and each
+ * other.  Readers may access the cache concurrently while writers get
+ * exclusive access across processes and threads.  Processes that die
+ * while accessing the cache don't block the others.
+ *
+ * The memory region will never be released.  Only the process-local
+ * bookkeeping gets allocated in @a result_pool.
+ *
+ * Returns #SVN_ERR_UNSUPPORTED_FEATURE if the platform does not provide
+ * robust process-shared mutexes and anonymous shared memory.
+ *
+ * @since New in 1.15.
+ */
+svn_error_t *
+svn_cache__membuffer_cache_create_shared(svn_membuffer_t **cache,
+                                         apr_size_t total_size,
+                                         apr_size_t directory_size,
+                                         apr_size_t segment_count,
+                                         svn_boolean_t allow_blocking_writes,
+                                         apr_pool_t *result_pool);
+
 /**
  * @defgroup Standard priority classes for #svn_cache__create_membuffer_cache.
  * @{
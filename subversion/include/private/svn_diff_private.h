@@ -30,6 +30,7 @@
 
 #include "svn_types.h"
 #include "svn_io.h"
+#include "svn_diff.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -148,6 +149,62 @@ svn_diff_hunk__create_deletes_single_line(svn_diff_hunk_t **hunk,
 svn_linenum_t
 svn_diff_hunk__get_fuzz_penalty(const svn_diff_hunk_t *hunk);
 
+/** A text split into lines, with the lines normalized according to
+ * sets of diff options and hashed.  Use this to diff the same text
+ * several times, e.g. against its predecessor and its successor, without
+ * splitting and hashing it again.
+ *
+ * The line boundaries are found once, when the object is created.  The
+ * normalized and hashed lines are computed the first time they are
+ * needed for a combination of the @c ignore_space and
+ * @c ignore_eol_style options, and kept for later diffs with the same
+ * combination.
+ *
+ * Computing them modifies the object.  Call svn_diff__tokens_prepare()
+ * for all options that will be used before using the object in several
+ * concurrent diffs.  Without further preparation it is then only read.
+ */
+typedef struct svn_diff__tokens_t svn_diff__tokens_t;
+
+/** Set @a *tokens to the lines of @a text.  The result does not refer
+ * to @a text.
+ *
+ * Allocate @a *tokens, and everything computed for it later, in
+ * @a result_pool.
+ */
+svn_error_t *
+svn_diff__tokens_create(svn_diff__tokens_t **tokens,
+                        const svn_string_t *text,
+                        apr_pool_t *result_pool);
+
+/** Make sure that the lines of @a tokens are normalized and hashed
+ * according to @a options.
+ */
+svn_error_t *
+svn_diff__tokens_prepare(svn_diff__tokens_t *tokens,
+                         const svn_diff_file_options_t *options);
+
+/** Return the approximate number of bytes allocated for @a tokens,
+ * including everything computed by svn_diff__tokens_prepare() so far.
+ */
+apr_size_t
+svn_diff__tokens_size(const svn_diff__tokens_t *tokens);
+
+/** Like svn_diff_mem_string_diff() but diff the texts tokenized as
+ * @a original and @a modified.
+ *
+ * Both are passed to svn_diff__tokens_prepare() with @a options first.
+ * Both may be the same object.
+ *
+ * Allocate @a *diff in @a pool.
+ */
+svn_error_t *
+svn_diff__tokens_diff(svn_diff_t **diff,
+                      svn_diff__tokens_t *original,
+                      svn_diff__tokens_t *modified,
+                      const svn_diff_file_options_t *options,
+                      apr_pool_t *pool);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
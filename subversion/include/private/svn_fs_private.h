@@ -59,6 +59,16 @@ extern "C" {
 apr_hash_t *
 svn_fs__access_get_lock_tokens(svn_fs_access_t *access_ctx);
 
+/** Set @a *warning and @a *warning_baton to the warning callback that has
+ * been set for @a fs.  This allows forwarding warnings from other
+ * instances of the same filesystem.
+ *
+ * @since New in 1.15. */
+void
+svn_fs__get_warning_func(svn_fs_warning_callback_t *warning,
+                         void **warning_baton,
+                         svn_fs_t *fs);
+
 
 /* Check whether PATH is valid for a filesystem, following (most of) the
  * requirements in svn_fs.h:"Directory entry names and directory paths".
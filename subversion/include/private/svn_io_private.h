@@ -85,6 +85,29 @@ svn_io__file_lock_autocreate(const char *lock_file,
                              apr_pool_t *pool);
 
 
+/** Create a hard link @a to_path pointing to the same file as
+ * @a from_path.  Use @a scratch_pool for temporary allocations.
+ *
+ * Return an error wrapping the APR status if the file system does not
+ * support hard links or the paths are on different devices.
+ */
+svn_error_t *
+svn_io__file_link(const char *from_path,
+                  const char *to_path,
+                  apr_pool_t *scratch_pool);
+
+/** Tell the OS that the @a length bytes at @a offset in @a file will
+ * probably be read soon, so it may start fetching them in the background.
+ *
+ * This is merely a hint.  It does nothing on systems that don't support
+ * posix_fadvise() and any failure will be ignored.
+ */
+void
+svn_io__file_advise_willneed(apr_file_t *file,
+                             apr_off_t offset,
+                             apr_off_t length);
+
+
 /** Return the underlying file, if any, associated with the stream, or
  * NULL if not available.  Accessing the file bypasses the stream.
  */
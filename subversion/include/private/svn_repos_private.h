@@ -390,6 +390,34 @@ svn_repos__get_dump_editor(const svn_delta_editor_t **editor,
                            const char *update_anchor_relpath,
                            apr_pool_t *pool);
 
+/**
+ * Like svn_repos_dump_fs5(), but if @a incremental is set, only warn
+ * about references to revisions older than @a oldest_dumped_rev.  This
+ * is for dumps that continue other dumps, which provide the revisions
+ * from @a oldest_dumped_rev up to @a start_rev.  @a oldest_dumped_rev
+ * may be #SVN_INVALID_REVNUM, meaning @a start_rev.
+ *
+ * @since New in 1.15.
+ */
+svn_error_t *
+svn_repos__dump_fs(svn_repos_t *repos,
+                   svn_stream_t *stream,
+                   svn_revnum_t start_rev,
+                   svn_revnum_t end_rev,
+                   svn_revnum_t oldest_dumped_rev,
+                   svn_boolean_t incremental,
+                   svn_boolean_t use_deltas,
+                   svn_boolean_t include_revprops,
+                   svn_boolean_t include_changes,
+                   int jobs,
+                   svn_repos_notify_func_t notify_func,
+                   void *notify_baton,
+                   svn_repos_dump_filter_func_t filter_func,
+                   void *filter_baton,
+                   svn_cancel_func_t cancel_func,
+                   void *cancel_baton,
+                   apr_pool_t *pool);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
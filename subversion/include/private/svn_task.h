@@ -0,0 +1,152 @@
+/**
+ * @copyright
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ * @endcopyright
+ *
+ * @file svn_task.h
+ * @brief Structures and functions for concurrent, ordered task execution
+ *
+ * A "task run" processes a fixed number of independent tasks, identified
+ * by their index 0 .. TASK_COUNT-1, on a number of worker threads.  The
+ * results are handed to an output function in the calling thread, strictly
+ * in task index order.  This allows for parallel execution of the expensive
+ * part of an operation while keeping all side effects (notifications,
+ * writing to streams, error reporting) deterministic.
+ *
+ * Workers only get a limited number of tasks ahead of the output function,
+ * such that the memory consumed by pending results remains bounded.
+ *
+ * If APR does not support threads or only a single thread is requested,
+ * all tasks get processed sequentially in the calling thread.
+ */
+
+#ifndef SVN_TASK_H
+#define SVN_TASK_H
+
+#include <apr_pools.h>
+
+#include "svn_types.h"
+#include "svn_error.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/**
+ * Callback constructing the per-thread data in @a *thread_context.
+ * It gets called once in each worker thread before it processes its
+ * first task.  @a baton is the context baton given to svn_task__run().
+ *
+ * Allocate the context in @a result_pool, which lives as long as the
+ * thread.  Use @a scratch_pool for temporary allocations.
+ *
+ * A typical use is to open a separate FS or repository handle for each
+ * thread since those cannot be shared between threads.
+ */
+typedef svn_error_t *
+(*svn_task__thread_context_constructor_t)(void **thread_context,
+                                          void *baton,
+                                          apr_pool_t *result_pool,
+                                          apr_pool_t *scratch_pool);
+
+/**
+ * Callback processing the task with number @a task_index.  Set
+ * @a *result to the data to pass to the output function; it may be
+ * @c NULL.  @a process_baton is the respective baton given to
+ * svn_task__run() and @a thread_context is the object created by the
+ * context constructor for the current thread (@c NULL if there is no
+ * constructor).
+ *
+ * This may be called from any worker thread and concurrently to other
+ * tasks.  Therefore, @a process_baton must be treated as read-only.
+ *
+ * Implementations should call @a cancel_func with @a cancel_baton
+ * periodically.  It will return #SVN_ERR_CANCELLED once the run has
+ * been aborted.
+ *
+ * Allocate @a *result in @a result_pool.  It will be destroyed after the
+ * output function has been called for this task.  Use @a scratch_pool
+ * for temporary allocations.
+ */
+typedef svn_error_t *
+(*svn_task__process_func_t)(void **result,
+                            apr_size_t task_index,
+                            void *process_baton,
+                            void *thread_context,
+                            svn_cancel_func_t cancel_func,
+                            void *cancel_baton,
+                            apr_pool_t *result_pool,
+                            apr_pool_t *scratch_pool);
+
+/**
+ * Callback consuming the @a result of the task with number @a task_index.
+ * @a output_baton is the respective baton given to svn_task__run().
+ *
+ * This is always called in the thread that called svn_task__run() and
+ * strictly in ascending @a task_index order.
+ *
+ * @a cancel_func and @a cancel_baton are the ones given to svn_task__run().
+ * Use @a scratch_pool for temporary allocations.
+ */
+typedef svn_error_t *
+(*svn_task__output_func_t)(void *output_baton,
+                           apr_size_t task_index,
+                           void *result,
+                           svn_cancel_func_t cancel_func,
+                           void *cancel_baton,
+                           apr_pool_t *scratch_pool);
+
+/**
+ * Process @a task_count tasks by calling @a process_func with
+ * @a process_baton on up to @a concurrency threads and pass their results
+ * to @a output_func with @a output_baton in task order.  @a output_func
+ * may be @c NULL.
+ *
+ * If @a context_constructor is not @c NULL, call it with @a context_baton
+ * once per worker thread and pass the resulting context to all
+ * @a process_func calls in that thread.
+ *
+ * If @a process_func returns an error for some task, call @a output_func
+ * for all preceding tasks, then stop processing and return that error.
+ * The same applies to errors returned by @a output_func.  Thus, the error
+ * returned from this function is the same that a sequential execution
+ * would have returned.
+ *
+ * @a cancel_func with @a cancel_baton will only be called from the thread
+ * calling this function.  Use @a scratch_pool for temporary allocations.
+ */
+svn_error_t *
+svn_task__run(int concurrency,
+              apr_size_t task_count,
+              svn_task__process_func_t process_func,
+              void *process_baton,
+              svn_task__output_func_t output_func,
+              void *output_baton,
+              svn_task__thread_context_constructor_t context_constructor,
+              void *context_baton,
+              svn_cancel_func_t cancel_func,
+              void *cancel_baton,
+              apr_pool_t *scratch_pool);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* SVN_TASK_H */
@@ -1042,7 +1042,8 @@ svn_wc__node_get_md5_from_sha1(const svn_checksum_t **md5_checksum,
 /* Like svn_wc_get_pristine_contents2(), but keyed on the CHECKSUM
    rather than on the local absolute path of the working file.
    WRI_ABSPATH is any versioned path of the working copy in whose
-   pristine database we'll be looking for these contents.  */
+   pristine database we'll be looking for these contents.  If they are
+   not found there, look into the shared pristine store, if configured.  */
 svn_error_t *
 svn_wc__get_pristine_contents_by_checksum(svn_stream_t **contents,
                                           svn_wc_context_t *wc_ctx,
@@ -2128,6 +2129,87 @@ svn_wc__translated_stream(svn_stream_t **stream,
                           apr_pool_t *result_pool,
                           apr_pool_t *scratch_pool);
 
+/**
+ * @defgroup svn_wc__text_delta Concurrent text delta transmission
+ * @{
+ *
+ * Split svn_wc_transmit_text_deltas3() into three steps, so that the
+ * expensive part can run in worker threads while the commit editor is
+ * still being driven from a single thread:
+ *
+ *   - svn_wc__text_delta_prepare() reads everything needed from the
+ *     working copy database.
+ *   - svn_wc__text_delta_compute() translates the working file, computes
+ *     the delta and the checksums and writes the new pristine text.  It
+ *     does not access the database and may be called from any thread.
+ *   - svn_wc__text_delta_send() drives the editor with the result and
+ *     installs the new pristine text.
+ */
+
+/** Opaque state of a text delta transmission.
+ *
+ * @since New in 1.15.
+ */
+typedef struct svn_wc__text_delta_t svn_wc__text_delta_t;
+
+/** Return the maximum number of concurrent jobs that the working copy
+ * library may use for operations on @a wc_ctx, as configured by the
+ * #SVN_CONFIG_OPTION_WC_JOBS option.
+ *
+ * @since New in 1.15.
+ */
+int
+svn_wc__get_jobs(svn_wc_context_t *wc_ctx);
+
+/** Prepare the transmission of the text delta for the file
+ * @a local_abspath in @a *delta, allocated in @a result_pool.
+ * @a fulltext has the same meaning as for svn_wc_transmit_text_deltas3().
+ * Use @a scratch_pool for temporary allocations.
+ *
+ * @since New in 1.15.
+ */
+svn_error_t *
+svn_wc__text_delta_prepare(svn_wc__text_delta_t **delta,
+                           svn_wc_context_t *wc_ctx,
+                           const char *local_abspath,
+                           svn_boolean_t fulltext,
+                           apr_pool_t *result_pool,
+                           apr_pool_t *scratch_pool);
+
+/** Compute the text delta for @a delta and store it in temporary files
+ * allocated in @a result_pool, which must live until
+ * svn_wc__text_delta_send() returns.  Use @a scratch_pool for temporary
+ * allocations.
+ *
+ * This may be called from any thread, but not concurrently for the same
+ * @a delta.
+ *
+ * @since New in 1.15.
+ */
+svn_error_t *
+svn_wc__text_delta_compute(svn_wc__text_delta_t *delta,
+                           apr_pool_t *result_pool,
+                           apr_pool_t *scratch_pool);
+
+/** Send the text delta computed for @a delta to @a editor and close
+ * @a file_baton, like svn_wc_transmit_text_deltas3() does.  Return the
+ * checksums of the new pristine text in @a *new_text_base_md5_checksum
+ * and @a *new_text_base_sha1_checksum, allocated in @a result_pool.
+ * Use @a scratch_pool for temporary allocations.
+ *
+ * @since New in 1.15.
+ */
+svn_error_t *
+svn_wc__text_delta_send(const svn_checksum_t **new_text_base_md5_checksum,
+                        const svn_checksum_t **new_text_base_sha1_checksum,
+                        svn_wc__text_delta_t *delta,
+                        const svn_delta_editor_t *editor,
+                        void *file_baton,
+                        apr_pool_t *result_pool,
+                        apr_pool_t *scratch_pool);
+
+/** @} */
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
@@ -83,6 +83,24 @@ svn_cache_config_get(void);
 void
 svn_cache_config_set(const svn_cache_config_t *settings);
 
+/** Create the process-wide cache according to the current configuration
+   in shared memory.  All processes forked from the current one after
+   this call will use the same cache, i.e. data fetched by one of them
+   becomes available to all others and survives the respective child
+   process.
+
+   This must be called after svn_cache_config_set() and before any
+   repository has been opened.  Return an error if the cache has
+   already been created or if shared caches are not supported on this
+   platform.  Does nothing if the cache size is 0.
+
+   @a scratch_pool is used for temporary allocations.
+
+   @since New in 1.15.
+ */
+svn_error_t *
+svn_cache_config_init_shared(apr_pool_t *scratch_pool);
+
 /** @} */
 
 /** @} */
@@ -171,6 +171,10 @@ typedef struct svn_config_t svn_config_t;
 #define SVN_CONFIG_OPTION_SQLITE_EXCLUSIVE_CLIENTS  "exclusive-locking-clients"
 /** @since New in 1.9. */
 #define SVN_CONFIG_OPTION_SQLITE_BUSY_TIMEOUT       "busy-timeout"
+/** @since New in 1.15. */
+#define SVN_CONFIG_OPTION_WC_JOBS                   "jobs"
+/** @since New in 1.15. */
+#define SVN_CONFIG_OPTION_WC_SHARED_PRISTINE_STORE  "shared-pristine-store"
 /** @} */
 
 /** @name Repository conf directory configuration files strings
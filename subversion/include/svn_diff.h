@@ -455,6 +455,24 @@ typedef enum svn_diff_file_ignore_space_t
   svn_diff_file_ignore_space_all
 } svn_diff_file_ignore_space_t;
 
+/** The algorithm used to find the lines two texts have in common.
+ *
+ * @since New in 1.15.
+ */
+typedef enum svn_diff_file_algorithm_t
+{
+  /** Compute a longest common subsequence of the lines, producing a
+   * minimal diff. */
+  svn_diff_file_algorithm_lcs,
+
+  /** Match the lines that occur exactly once in both texts first and
+   * only compute a longest common subsequence of what lies between them.
+   * The result is not always minimal, but tends to keep moved and
+   * reordered blocks together and stays fast on inputs with many
+   * repeated lines. */
+  svn_diff_file_algorithm_patience
+} svn_diff_file_algorithm_t;
+
 /** Options to control the behaviour of the file diff routines.
  *
  * @since New in 1.4.
@@ -487,6 +505,23 @@ typedef struct svn_diff_file_options_t
    *
    * @since New in 1.9 */
   int context_size;
+
+  /** The algorithm used to find the common lines.  The default is
+   * @c svn_diff_file_algorithm_lcs.
+   *
+   * @since New in 1.15. */
+  svn_diff_file_algorithm_t algorithm;
+
+  /** If not zero, the approximate number of bytes svn_diff_file_diff_2()
+   * may use to hold the lines of the files beyond their identical prefix
+   * and suffix.  If comparing those lines one by one would take more, the
+   * files are compared in blocks of lines instead, which finds the same
+   * changes but may report unchanged lines around them as changed.  The
+   * limit is not enforced when ignoring white space or EOL styles.  The
+   * default is 0, which means no limit.
+   *
+   * @since New in 1.15. */
+  apr_size_t memory_limit;
 } svn_diff_file_options_t;
 
 /** Allocate a @c svn_diff_file_options_t structure in @a pool, initializing
@@ -511,6 +546,8 @@ svn_diff_file_options_create(apr_pool_t *pool);
  * - --show-c-function, -p @since New in 1.5.
  * - --context, -U ARG @since New in 1.9.
  * - --unified, -u (for compatibility, does nothing).
+ * - --patience @since New in 1.15.
+ * - --memory-limit ARG (in megabytes) @since New in 1.15.
  */
 svn_error_t *
 svn_diff_file_options_parse(svn_diff_file_options_t *options,
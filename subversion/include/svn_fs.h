@@ -549,14 +549,38 @@ typedef void (*svn_fs_hotcopy_notify_t)(void *baton,
  * is not triggered by the BDB backend.  @a notify_func may be @c NULL
  * if this notification is not required.
  *
+ * Backends that support it will copy up to @a jobs files concurrently.
+ * Notifications and updates to the revision range visible to readers of
+ * the destination still happen in revision order.  Values of @a jobs
+ * smaller than 2 disable concurrency.
+ *
  * The optional @a cancel_func callback will be invoked with
  * @a cancel_baton as usual to allow the user to preempt this potentially
  * lengthy operation.
  *
  * Use @a scratch_pool for temporary allocations.
  *
+ * @since New in 1.15.
+ */
+svn_error_t *
+svn_fs_hotcopy4(const char *src_path,
+                const char *dest_path,
+                svn_boolean_t clean,
+                svn_boolean_t incremental,
+                int jobs,
+                svn_fs_hotcopy_notify_t notify_func,
+                void *notify_baton,
+                svn_cancel_func_t cancel_func,
+                void *cancel_baton,
+                apr_pool_t *scratch_pool);
+
+/**
+ * Like svn_fs_hotcopy4(), but with @a jobs always set to 1.
+ *
  * @since New in 1.9.
+ * @deprecated Provided for backward compatibility with the 1.14 API.
  */
+SVN_DEPRECATED
 svn_error_t *
 svn_fs_hotcopy3(const char *src_path,
                 const char *dest_path,
@@ -3304,8 +3328,32 @@ typedef svn_error_t *(*svn_fs_pack_notify_t)(void *baton,
  * Possibly update the filesystem located in the directory @a path
  * to use disk space more efficiently.
  *
+ * Backends that support it will process up to @a jobs parts of the
+ * filesystem (e.g. shards) concurrently.  The order of notifications
+ * sent to @a notify_func with @a notify_baton and the order in which
+ * the packed data becomes visible to readers will be the same as for
+ * a single job.  Values of @a jobs smaller than 2 disable concurrency.
+ *
+ * Use @a scratch_pool for temporary allocations.
+ *
+ * @since New in 1.15.
+ */
+svn_error_t *
+svn_fs_pack2(const char *db_path,
+             int jobs,
+             svn_fs_pack_notify_t notify_func,
+             void *notify_baton,
+             svn_cancel_func_t cancel_func,
+             void *cancel_baton,
+             apr_pool_t *scratch_pool);
+
+/**
+ * Like svn_fs_pack2() but with @a jobs always set to 1.
+ *
  * @since New in 1.6.
+ * @deprecated Provided for backward compatibility with the 1.14 API.
  */
+SVN_DEPRECATED
 svn_error_t *
 svn_fs_pack(const char *db_path,
             svn_fs_pack_notify_t notify_func,
@@ -250,7 +250,11 @@ typedef enum svn_repos_notify_action_t
   svn_repos_notify_pack_noop,
 
   /** The revision properties got set. @since New in 1.10. */
-  svn_repos_notify_load_revprop_set
+  svn_repos_notify_load_revprop_set,
+
+  /** A revision was added to the changed-paths index.
+   * @since New in 1.15. */
+  svn_repos_notify_log_index_rev
 } svn_repos_notify_action_t;
 
 /** The type of warning occurring.
@@ -317,8 +321,8 @@ typedef struct svn_repos_notify_t
   /** Action that describes what happened in the repository. */
   svn_repos_notify_action_t action;
 
-  /** For #svn_repos_notify_dump_rev_end and #svn_repos_notify_verify_rev_end,
-   * the revision which just completed.
+  /** For #svn_repos_notify_dump_rev_end, #svn_repos_notify_verify_rev_end
+   * and #svn_repos_notify_log_index_rev, the revision which just completed.
    * For #svn_fs_upgrade_format_bumped, the new format version. */
   svn_revnum_t revision;
 
@@ -676,14 +680,36 @@ svn_repos_fs_type(svn_repos_t *repos,
  * notification is not triggered by the BDB backend. @a notify_func
  * may be @c NULL if this notification is not required.
  *
+ * Copy up to @a jobs files concurrently if the filesystem backend
+ * supports it; see svn_fs_hotcopy4().
+ *
  * The optional @a cancel_func callback will be invoked with
  * @a cancel_baton as usual to allow the user to preempt this potentially
  * lengthy operation.
  *
  * Use @a scratch_pool for temporary allocations.
  *
+ * @since New in 1.15.
+ */
+svn_error_t *
+svn_repos_hotcopy4(const char *src_path,
+                   const char *dst_path,
+                   svn_boolean_t clean_logs,
+                   svn_boolean_t incremental,
+                   int jobs,
+                   svn_repos_notify_func_t notify_func,
+                   void *notify_baton,
+                   svn_cancel_func_t cancel_func,
+                   void *cancel_baton,
+                   apr_pool_t *scratch_pool);
+
+/**
+ * Like svn_repos_hotcopy4(), but with @a jobs always set to 1.
+ *
  * @since New in 1.9.
+ * @deprecated Provided for backward compatibility with the 1.14 API.
  */
+SVN_DEPRECATED
 svn_error_t *
 svn_repos_hotcopy3(const char *src_path,
                    const char *dst_path,
@@ -728,10 +754,28 @@ svn_repos_hotcopy(const char *src_path,
 
 /**
  * Possibly update the repository, @a repos, to use a more efficient
- * filesystem representation.  Use @a pool for allocations.
+ * filesystem representation.  Process up to @a jobs shards concurrently
+ * if the filesystem backend supports it; see svn_fs_pack2().
+ * Use @a scratch_pool for temporary allocations.
+ *
+ * @since New in 1.15.
+ */
+svn_error_t *
+svn_repos_fs_pack3(svn_repos_t *repos,
+                   int jobs,
+                   svn_repos_notify_func_t notify_func,
+                   void *notify_baton,
+                   svn_cancel_func_t cancel_func,
+                   void *cancel_baton,
+                   apr_pool_t *scratch_pool);
+
+/**
+ * Like svn_repos_fs_pack3() but with @a jobs always set to 1.
  *
  * @since New in 1.7.
+ * @deprecated Provided for backward compatibility with the 1.14 API.
  */
+SVN_DEPRECATED
 svn_error_t *
 svn_repos_fs_pack2(svn_repos_t *repos,
                    svn_repos_notify_func_t notify_func,
@@ -2172,6 +2216,10 @@ typedef svn_error_t *(*svn_repos_log_entry_receiver_t)(
  * @a path_change_receiver is @c NULL, the same filtering is performed
  * just without reporting any path changes.
  *
+ * If @a repos has a changed-paths index covering @a start and @a end
+ * (see svn_repos_build_log_index()), it is used to find the revisions
+ * in which @a paths were changed instead of walking their node history.
+ *
  * Use @a scratch_pool for temporary allocations.
  *
  * @see svn_repos_path_change_receiver_t, svn_repos_log_entry_receiver_t
@@ -2195,6 +2243,35 @@ svn_repos_get_logs5(svn_repos_t *repos,
                     void *revision_receiver_baton,
                     apr_pool_t *scratch_pool);
 
+/**
+ * Build the changed-paths index of @a repos from scratch, replacing any
+ * existing one.  The index maps each path to the revisions in which it
+ * or anything below it was changed, which lets svn_repos_get_logs5()
+ * answer path-restricted queries without walking the node history.
+ *
+ * Once built, commits made through svn_repos_fs_commit_txn() keep the
+ * index up to date.  Revisions committed by other means are added by
+ * the next such commit; until then, svn_repos_get_logs5() does not use
+ * the index for them.
+ *
+ * If @a notify_func is not @c NULL, call it with @a notify_baton and a
+ * #svn_repos_notify_log_index_rev notification after each revision.
+ *
+ * If @a cancel_func is not @c NULL, call it with @a cancel_baton as
+ * appropriate.
+ *
+ * Use @a scratch_pool for temporary allocations.
+ *
+ * @since New in 1.15.
+ */
+svn_error_t *
+svn_repos_build_log_index(svn_repos_t *repos,
+                          svn_repos_notify_func_t notify_func,
+                          void *notify_baton,
+                          svn_cancel_func_t cancel_func,
+                          void *cancel_baton,
+                          apr_pool_t *scratch_pool);
+
 /**
  * Similar to svn_repos_get_logs5 but using a #svn_log_entry_receiver_t
  * @a receiver to receive revision properties and changed paths through a
@@ -3220,12 +3297,42 @@ typedef svn_error_t *(*svn_repos_verify_callback_t)(void *baton,
  * cancel_baton as argument to see if the caller wishes to cancel the
  * verification.
  *
+ * If @a jobs is larger than 1, verify up to @a jobs revisions (or
+ * revision ranges for the backend-specific checks) concurrently, each
+ * with its own filesystem handle.  Notifications, @a verify_callback
+ * invocations and the returned error will be the same and in the same
+ * order as for sequential verification.  @a cancel_func, @a notify_func
+ * and @a verify_callback will only be called from the calling thread.
+ * Without thread support in APR, @a jobs is ignored.
+ *
  * Use @a scratch_pool for temporary allocation.
  *
  * @see svn_repos_verify_callback_t
  *
+ * @since New in 1.15.
+ */
+svn_error_t *
+svn_repos_verify_fs4(svn_repos_t *repos,
+                     svn_revnum_t start_rev,
+                     svn_revnum_t end_rev,
+                     svn_boolean_t check_normalization,
+                     svn_boolean_t metadata_only,
+                     int jobs,
+                     svn_repos_notify_func_t notify_func,
+                     void *notify_baton,
+                     svn_repos_verify_callback_t verify_callback,
+                     void *verify_baton,
+                     svn_cancel_func_t cancel,
+                     void *cancel_baton,
+                     apr_pool_t *scratch_pool);
+
+/**
+ * Like svn_repos_verify_fs4(), but with @a jobs set to 1.
+ *
  * @since New in 1.9.
+ * @deprecated Provided for backward compatibility with the 1.14 API.
  */
+SVN_DEPRECATED
 svn_error_t *
 svn_repos_verify_fs3(svn_repos_t *repos,
                      svn_revnum_t start_rev,
@@ -3334,14 +3441,45 @@ svn_repos_verify_fs(svn_repos_t *repos,
  * If @a filter_func is not @c NULL, it is called for each node being
  * dumped, allowing the caller to exclude it from dump.
  *
+ * If @a jobs is larger than 1, ranges of revisions get rendered on up to
+ * @a jobs threads, each using its own repository handle, and are then
+ * written to @a stream in revision order.  The output and notifications
+ * are the same as for a sequential dump but @a filter_func may be called
+ * from multiple threads concurrently.
+ *
  * If @a cancel_func is not @c NULL, it is called periodically with
  * @a cancel_baton as argument to see if the client wishes to cancel
  * the dump.
  *
  * Use @a scratch_pool for temporary allocation.
  *
+ * @since New in 1.15.
+ */
+svn_error_t *
+svn_repos_dump_fs5(svn_repos_t *repos,
+                   svn_stream_t *stream,
+                   svn_revnum_t start_rev,
+                   svn_revnum_t end_rev,
+                   svn_boolean_t incremental,
+                   svn_boolean_t use_deltas,
+                   svn_boolean_t include_revprops,
+                   svn_boolean_t include_changes,
+                   int jobs,
+                   svn_repos_notify_func_t notify_func,
+                   void *notify_baton,
+                   svn_repos_dump_filter_func_t filter_func,
+                   void *filter_baton,
+                   svn_cancel_func_t cancel_func,
+                   void *cancel_baton,
+                   apr_pool_t *pool);
+
+/**
+ * Similar to svn_repos_dump_fs5(), but with @a jobs set to 1.
+ *
  * @since New in 1.10.
+ * @deprecated Provided for backward compatibility with the 1.14 API.
  */
+SVN_DEPRECATED
 svn_error_t *
 svn_repos_dump_fs4(svn_repos_t *repos,
                    svn_stream_t *stream,
@@ -3479,8 +3617,42 @@ svn_repos_dump_fs(svn_repos_t *repos,
  * @a cancel_baton as argument to see if the client wishes to cancel
  * the load.
  *
+ * If @a jobs is larger than 1, read and parse @a dumpstream in a separate
+ * thread while the revisions get committed.  The parser may then run up
+ * to a few megabytes ahead of the commits.  Revisions will be committed
+ * and notifications sent exactly as for a sequential load and
+ * @a cancel_func and @a notify_func will only be called from the calling
+ * thread.  @a dumpstream must not be used by any other thread during this
+ * call.  Without thread support in APR, @a jobs is ignored.
+ *
+ * @since New in 1.15.
+ */
+svn_error_t *
+svn_repos_load_fs7(svn_repos_t *repos,
+                   svn_stream_t *dumpstream,
+                   svn_revnum_t start_rev,
+                   svn_revnum_t end_rev,
+                   enum svn_repos_load_uuid uuid_action,
+                   const char *parent_dir,
+                   svn_boolean_t use_pre_commit_hook,
+                   svn_boolean_t use_post_commit_hook,
+                   svn_boolean_t validate_props,
+                   svn_boolean_t ignore_dates,
+                   svn_boolean_t normalize_props,
+                   int jobs,
+                   svn_repos_notify_func_t notify_func,
+                   void *notify_baton,
+                   svn_cancel_func_t cancel_func,
+                   void *cancel_baton,
+                   apr_pool_t *pool);
+
+/**
+ * Like svn_repos_load_fs7(), but with @a jobs always set to 1.
+ *
  * @since New in 1.10.
+ * @deprecated Provided for backward compatibility with the 1.14 API.
  */
+SVN_DEPRECATED
 svn_error_t *
 svn_repos_load_fs6(svn_repos_t *repos,
                    svn_stream_t *dumpstream,
@@ -4306,6 +4478,65 @@ svn_repos_authz_check_access(svn_authz_t *authz,
                              svn_boolean_t *access_granted,
                              apr_pool_t *pool);
 
+/**
+ * Like svn_repos_authz_check_access(), but check the @a required_access
+ * for all of @a paths, an array of <tt>const char *</tt> absolute paths,
+ * at once.  Set the respective element of @a access_granted, which must
+ * have room for @a paths->nelts elements.
+ *
+ * Each lookup starts at the deepest common parent of its path and the
+ * previous one.  Sorting @a paths such that parents come before their
+ * children and siblings are next to each other, e.g. with
+ * svn_sort_compare_paths(), makes this a single walk over the rules.
+ *
+ * @since New in 1.15.
+ */
+svn_error_t *
+svn_repos_authz_check_access_many(svn_authz_t *authz,
+                                  const char *repos_name,
+                                  const apr_array_header_t *paths,
+                                  const char *user,
+                                  svn_repos_authz_access_t required_access,
+                                  svn_boolean_t *access_granted,
+                                  apr_pool_t *pool);
+
+/**
+ * The baton for svn_repos_authz_check_read().
+ *
+ * @since New in 1.15.
+ */
+typedef struct svn_repos_authz_read_baton_t
+{
+  /** The authz rules to check against. */
+  svn_authz_t *authz;
+
+  /** The repository name as used in svn_repos_authz_check_access(). */
+  const char *repos_name;
+
+  /** The user to check the access for, or @c NULL for anonymous. */
+  const char *user;
+} svn_repos_authz_read_baton_t;
+
+/**
+ * An #svn_repos_authz_func_t that checks read access to @a path with
+ * svn_repos_authz_check_access() as described by @a baton, which is an
+ * #svn_repos_authz_read_baton_t.  @a root is ignored.  Paths that are
+ * not absolute are treated as relative to the repository root.
+ *
+ * Functions in this library that check the access to many paths, like
+ * svn_repos_get_logs5(), svn_repos_list() and svn_repos_replay2(),
+ * recognize this function and check those paths with
+ * svn_repos_authz_check_access_many() instead of one at a time.
+ *
+ * @since New in 1.15.
+ */
+svn_error_t *
+svn_repos_authz_check_read(svn_boolean_t *allowed,
+                           svn_fs_root_t *root,
+                           const char *path,
+                           void *baton,
+                           apr_pool_t *pool);
+
 
 
 /** Revision Access Levels
@@ -38,6 +38,9 @@
 #include "svn_sorts.h"
 
 #include "private/svn_wc_private.h"
+#include "private/svn_diff_private.h"
+#include "private/svn_string_private.h"
+#include "private/svn_task.h"
 
 #include "svn_private_config.h"
 
@@ -74,6 +77,27 @@ struct diff_baton {
   const struct rev *rev;
 };
 
+/* The tokenized contents of one revision of the file.  It is shared by
+   the diffs against its predecessor and its successor, so every revision
+   gets split into lines and hashed only once. */
+struct blame_text {
+  svn_diff__tokens_t *tokens;
+  apr_pool_t *pool;         /* TOKENS live in here. */
+  int refcount;             /* POOL gets destroyed when this drops to 0. */
+};
+
+/* A diff between two revisions of the file whose result still has to be
+   applied to a blame chain. */
+struct blame_job {
+  struct blame_text *original;  /* NULL for the first revision */
+  struct blame_text *modified;
+  struct blame_chain *chain;    /* the chain to update */
+  const struct rev *rev;        /* the revision responsible for MODIFIED */
+};
+
+/* Number of diffs to queue per thread before running them. */
+#define BLAME_LOOKAHEAD 4
+
 /* The baton used for a file revision. Lives the entire operation */
 struct file_rev_baton {
   svn_revnum_t start_rev, end_rev;
@@ -83,6 +107,7 @@ struct file_rev_baton {
   const svn_diff_file_options_t *diff_options;
   /* name of file containing the previous revision of the file */
   const char *last_filename;
+  struct blame_text *last_text;  /* the tokenized LAST_FILENAME */
   struct rev *last_rev;   /* the rev of the last modification */
   struct blame_chain *chain;      /* the original blame chain. */
   const char *repos_root_url;    /* To construct a url */
@@ -93,8 +118,8 @@ struct file_rev_baton {
   /* These are used for tracking merged revisions. */
   svn_boolean_t include_merged_revisions;
   struct blame_chain *merged_chain;  /* the merged blame chain. */
-  /* name of file containing the previous merged revision of the file */
-  const char *last_original_filename;
+  /* tokenized contents of the previous non-merged revision of the file */
+  struct blame_text *last_original_text;
   /* pools for files which may need to persist for more than one rev. */
   apr_pool_t *filepool;
   apr_pool_t *prevfilepool;
@@ -106,6 +131,13 @@ struct file_rev_baton {
      happens when we move to the previous revision */
   svn_revnum_t last_revnum;
   apr_hash_t *last_props;
+
+  /* Diffs waiting to be run by flush_blame_jobs(), as struct blame_job.
+     They are run on up to JOBS threads once there are BATCH_SIZE of them,
+     overlapping with applying the earlier diffs to the blame chains. */
+  apr_array_header_t *pending_jobs;
+  int jobs;
+  int batch_size;
 };
 
 /* The baton used by the txdelta window handler. Allocated per revision */
@@ -117,6 +149,7 @@ struct delta_baton {
   svn_stream_t *source_stream;  /* the delta source */
   const char *filename;
   svn_boolean_t is_merged_revision;
+  svn_boolean_t unchanged;  /* same contents as the previous revision */
   struct rev *rev;     /* the rev struct for the current revision */
 };
 
@@ -282,42 +315,169 @@ static const svn_diff_output_fns_t output_fns = {
         output_diff_modified
 };
 
-/* Add the blame for the diffs between LAST_FILE and CUR_FILE to CHAIN,
-   for revision REV.  LAST_FILE may be NULL in which
-   case blame is added for every line of CUR_FILE. */
+/* Set *TEXT to the contents of FILENAME, tokenized according to
+   FRB->diff_options, with a reference count of 1.  Allocate it in a new
+   subpool of FRB->mainpool and use SCRATCH_POOL for temporaries.
+
+   The diffs run in other threads, so don't leave any tokenizing to them. */
+static svn_error_t *
+blame_text_create(struct blame_text **text,
+                  struct file_rev_baton *frb,
+                  const char *filename,
+                  apr_pool_t *scratch_pool)
+{
+  apr_pool_t *pool = svn_pool_create(frb->mainpool);
+  apr_pool_t *contents_pool = svn_pool_create(scratch_pool);
+  svn_stringbuf_t *contents;
+
+  *text = apr_palloc(pool, sizeof(**text));
+  (*text)->pool = pool;
+  (*text)->refcount = 1;
+
+  /* The tokens don't refer to the file contents, so don't keep them. */
+  SVN_ERR(svn_stringbuf_from_file2(&contents, filename, contents_pool));
+  SVN_ERR(svn_diff__tokens_create(&(*text)->tokens,
+                                  svn_stringbuf__morph_into_string(contents),
+                                  pool));
+  svn_pool_destroy(contents_pool);
+
+  return svn_error_trace(svn_diff__tokens_prepare((*text)->tokens,
+                                                  frb->diff_options));
+}
+
+/* Add a reference to TEXT and return it.  TEXT may be NULL. */
+static struct blame_text *
+blame_text_ref(struct blame_text *text)
+{
+  if (text)
+    text->refcount++;
+
+  return text;
+}
+
+/* Drop a reference to TEXT, destroying it when it was the last one.
+   TEXT may be NULL. */
+static void
+blame_text_release(struct blame_text *text)
+{
+  if (text && --text->refcount == 0)
+    svn_pool_destroy(text->pool);
+}
+
+/* Queue the diff between ORIGINAL and MODIFIED in FRB to update CHAIN for
+   revision REV.  ORIGINAL may be NULL, in which case blame is added for
+   every line of MODIFIED. */
+static void
+queue_blame_job(struct file_rev_baton *frb,
+                struct blame_text *original,
+                struct blame_text *modified,
+                struct blame_chain *chain,
+                const struct rev *rev)
+{
+  struct blame_job *job = apr_array_push(frb->pending_jobs);
+
+  job->original = blame_text_ref(original);
+  job->modified = blame_text_ref(modified);
+  job->chain = chain;
+  job->rev = rev;
+}
+
+/* Implements svn_task__process_func_t for the jobs pending in the
+   struct file_rev_baton given as PROCESS_BATON.  Set *RESULT to the
+   svn_diff_t for the job.  The tokens have all been prepared, so this
+   only reads them. */
 static svn_error_t *
-add_file_blame(const char *last_file,
-               const char *cur_file,
-               struct blame_chain *chain,
-               struct rev *rev,
-               const svn_diff_file_options_t *diff_options,
-               svn_cancel_func_t cancel_func,
-               void *cancel_baton,
-               apr_pool_t *pool)
+blame_job_process(void **result,
+                  apr_size_t task_index,
+                  void *process_baton,
+                  void *thread_context,
+                  svn_cancel_func_t cancel_func,
+                  void *cancel_baton,
+                  apr_pool_t *result_pool,
+                  apr_pool_t *scratch_pool)
 {
-  if (!last_file)
+  const struct file_rev_baton *frb = process_baton;
+  const struct blame_job *job
+    = &APR_ARRAY_IDX(frb->pending_jobs, task_index, struct blame_job);
+  svn_diff_t *diff = NULL;
+
+  if (job->original)
+    SVN_ERR(svn_diff__tokens_diff(&diff, job->original->tokens,
+                                  job->modified->tokens, frb->diff_options,
+                                  result_pool));
+
+  *result = diff;
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_task__output_func_t for the apr_array_header_t * of
+   struct blame_job given as OUTPUT_BATON.  Apply the svn_diff_t RESULT
+   to the job's blame chain. */
+static svn_error_t *
+blame_job_output(void *output_baton,
+                 apr_size_t task_index,
+                 void *result,
+                 svn_cancel_func_t cancel_func,
+                 void *cancel_baton,
+                 apr_pool_t *scratch_pool)
+{
+  const apr_array_header_t *jobs = output_baton;
+  const struct blame_job *job
+    = &APR_ARRAY_IDX(jobs, task_index, struct blame_job);
+  struct blame_chain *chain = job->chain;
+
+  if (!job->original)
     {
       SVN_ERR_ASSERT(chain->blame == NULL);
-      chain->blame = blame_create(chain, rev, 0);
+      chain->blame = blame_create(chain, job->rev, 0);
     }
   else
     {
-      svn_diff_t *diff;
       struct diff_baton diff_baton;
 
       diff_baton.chain = chain;
-      diff_baton.rev = rev;
+      diff_baton.rev = job->rev;
 
-      /* We have a previous file.  Get the diff and adjust blame info. */
-      SVN_ERR(svn_diff_file_diff_2(&diff, last_file, cur_file,
-                                   diff_options, pool));
-      SVN_ERR(svn_diff_output2(diff, &diff_baton, &output_fns,
+      /* Adjust blame info. */
+      SVN_ERR(svn_diff_output2(result, &diff_baton, &output_fns,
                                cancel_func, cancel_baton));
     }
 
   return SVN_NO_ERROR;
 }
 
+/* Run all diffs queued in FRB and apply them to their blame chains, in
+   the order they were queued.  Use SCRATCH_POOL for temporaries. */
+static svn_error_t *
+flush_blame_jobs(struct file_rev_baton *frb,
+                 apr_pool_t *scratch_pool)
+{
+  apr_array_header_t *jobs = frb->pending_jobs;
+  svn_error_t *err;
+  int i;
+
+  if (jobs->nelts == 0)
+    return SVN_NO_ERROR;
+
+  err = svn_task__run(MIN(frb->jobs, jobs->nelts), jobs->nelts,
+                      blame_job_process, frb,
+                      blame_job_output, jobs,
+                      NULL, NULL,
+                      frb->ctx->cancel_func, frb->ctx->cancel_baton,
+                      scratch_pool);
+
+  for (i = 0; i < jobs->nelts; i++)
+    {
+      struct blame_job *job = &APR_ARRAY_IDX(jobs, i, struct blame_job);
+
+      blame_text_release(job->original);
+      blame_text_release(job->modified);
+    }
+  apr_array_clear(jobs);
+
+  return svn_error_trace(err);
+}
+
 /* Record the blame information for the revision in BATON->file_rev_baton.
  */
 static svn_error_t *
@@ -326,6 +486,7 @@ update_blame(void *baton)
   struct delta_baton *dbaton = baton;
   struct file_rev_baton *frb = dbaton->file_rev_baton;
   struct blame_chain *chain;
+  struct blame_text *text;
 
   /* Close the source file used for the delta.
      It is important to do this early, since otherwise, they will be deleted
@@ -341,12 +502,15 @@ update_blame(void *baton)
   else
     chain = frb->chain;
 
+  /* Tokenize this file once for the diffs against both of its neighbours,
+     unless we already did. */
+  if (dbaton->unchanged && frb->last_text)
+    text = blame_text_ref(frb->last_text);
+  else
+    SVN_ERR(blame_text_create(&text, frb, dbaton->filename, frb->currpool));
+
   /* Process this file. */
-  SVN_ERR(add_file_blame(frb->last_filename,
-                         dbaton->filename, chain, dbaton->rev,
-                         frb->diff_options,
-                         frb->ctx->cancel_func, frb->ctx->cancel_baton,
-                         frb->currpool));
+  queue_blame_job(frb, frb->last_text, text, chain, dbaton->rev);
 
   /* If we are including merged revisions, and the current revision is not a
      merged one, we need to add its blame info to the chain for the original
@@ -355,11 +519,8 @@ update_blame(void *baton)
     {
       apr_pool_t *tmppool;
 
-      SVN_ERR(add_file_blame(frb->last_original_filename,
-                             dbaton->filename, frb->chain, dbaton->rev,
-                             frb->diff_options,
-                             frb->ctx->cancel_func, frb->ctx->cancel_baton,
-                             frb->currpool));
+      queue_blame_job(frb, frb->last_original_text, text, frb->chain,
+                      dbaton->rev);
 
       /* This filename could be around for a while, potentially, so
          use the longer lifetime pool, and switch it with the previous one*/
@@ -368,14 +529,17 @@ update_blame(void *baton)
       frb->filepool = frb->prevfilepool;
       frb->prevfilepool = tmppool;
 
-      frb->last_original_filename = apr_pstrdup(frb->filepool,
-                                                dbaton->filename);
+      blame_text_release(frb->last_original_text);
+      frb->last_original_text = blame_text_ref(text);
     }
 
   /* Prepare for next revision. */
 
-  /* Remember the file name so we can diff it with the next revision. */
+  /* Remember the file name so we can apply the next delta to it and its
+     contents so we can diff it with the next revision. */
   frb->last_filename = dbaton->filename;
+  blame_text_release(frb->last_text);
+  frb->last_text = text;
 
   /* Switch pools. */
   {
@@ -384,6 +548,11 @@ update_blame(void *baton)
     frb->currpool = tmp_pool;
   }
 
+  /* Run the queued diffs once there are enough to keep all threads busy.
+     The new CURRPOOL only holds data of older revisions by now. */
+  if (frb->pending_jobs->nelts >= frb->batch_size)
+    SVN_ERR(flush_blame_jobs(frb, frb->currpool));
+
   return SVN_NO_ERROR;
 }
 
@@ -585,6 +754,7 @@ file_rev_handler(void *baton, const char *path, svn_revnum_t revnum,
          We can't simply use the existing file due to the pool rotation logic.
          Trigger the blame update magic. */
       SVN_ERR(svn_stream_copy3(last_stream, cur_stream, NULL, NULL, pool));
+      delta_baton->unchanged = TRUE;
       SVN_ERR(update_blame(delta_baton));
     }
 
@@ -655,6 +825,97 @@ normalize_blames(struct blame_chain *chain,
     }
 }
 
+/* If the working file TARGET_ABSPATH is locally modified, add blame for
+   its local changes to FRB->chain, with keywords unexpanded.  Use POOL
+   for all allocations. */
+static svn_error_t *
+blame_local_changes(struct file_rev_baton *frb,
+                    const char *target_abspath,
+                    apr_pool_t *pool)
+{
+  svn_client_ctx_t *ctx = frb->ctx;
+  svn_wc_status3_t *status;
+
+  SVN_ERR(svn_wc_status3(&status, ctx->wc_ctx, target_abspath, pool,
+                         pool));
+
+  if (status->text_status != svn_wc_status_normal
+      || (status->prop_status != svn_wc_status_normal
+          && status->prop_status != svn_wc_status_none))
+    {
+      svn_stream_t *wcfile;
+      svn_stream_t *tempfile;
+      svn_opt_revision_t rev;
+      svn_boolean_t normalize_eols = FALSE;
+      const char *temppath;
+      struct blame_text *text;
+
+      if (status->prop_status != svn_wc_status_none)
+        {
+          const svn_string_t *eol_style;
+          SVN_ERR(svn_wc_prop_get2(&eol_style, ctx->wc_ctx,
+                                   target_abspath,
+                                   SVN_PROP_EOL_STYLE,
+                                   pool, pool));
+
+          if (eol_style)
+            {
+              svn_subst_eol_style_t style;
+              const char *eol;
+              svn_subst_eol_style_from_value(&style, &eol, eol_style->data);
+
+              normalize_eols = (style == svn_subst_eol_style_native);
+            }
+        }
+
+      rev.kind = svn_opt_revision_working;
+      SVN_ERR(svn_client__get_normalized_stream(&wcfile, ctx->wc_ctx,
+                                                target_abspath, &rev,
+                                                FALSE, normalize_eols,
+                                                ctx->cancel_func,
+                                                ctx->cancel_baton,
+                                                pool, pool));
+
+      SVN_ERR(svn_stream_open_unique(&tempfile, &temppath, NULL,
+                                     svn_io_file_del_on_pool_cleanup,
+                                     pool, pool));
+
+      SVN_ERR(svn_stream_copy3(wcfile, tempfile, ctx->cancel_func,
+                               ctx->cancel_baton, pool));
+
+      SVN_ERR(blame_text_create(&text, frb, temppath, pool));
+      queue_blame_job(frb, frb->last_text, text, frb->chain, NULL);
+      blame_text_release(text);
+      SVN_ERR(flush_blame_jobs(frb, pool));
+
+      frb->last_filename = temppath;
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Drop all references to tokenized texts that FRB holds. */
+static void
+release_blame_texts(struct file_rev_baton *frb)
+{
+  int i;
+
+  for (i = 0; i < frb->pending_jobs->nelts; i++)
+    {
+      struct blame_job *job
+        = &APR_ARRAY_IDX(frb->pending_jobs, i, struct blame_job);
+
+      blame_text_release(job->original);
+      blame_text_release(job->modified);
+    }
+  apr_array_clear(frb->pending_jobs);
+
+  blame_text_release(frb->last_text);
+  blame_text_release(frb->last_original_text);
+  frb->last_text = NULL;
+  frb->last_original_text = NULL;
+}
+
 svn_error_t *
 svn_client_blame6(svn_revnum_t *start_revnum_p,
                   svn_revnum_t *end_revnum_p,
@@ -678,6 +939,7 @@ svn_client_blame6(svn_revnum_t *start_revnum_p,
   svn_stream_t *last_stream;
   svn_stream_t *stream;
   const char *target_abspath_or_url;
+  svn_error_t *err;
 
   if (start->kind == svn_opt_revision_unspecified
       || end->kind == svn_opt_revision_unspecified)
@@ -779,8 +1041,9 @@ svn_client_blame6(svn_revnum_t *start_revnum_p,
   frb.diff_options = diff_options;
   frb.include_merged_revisions = include_merged_revisions;
   frb.last_filename = NULL;
+  frb.last_text = NULL;
   frb.last_rev = NULL;
-  frb.last_original_filename = NULL;
+  frb.last_original_text = NULL;
   frb.chain = apr_palloc(pool, sizeof(*frb.chain));
   frb.chain->blame = NULL;
   frb.chain->avail = NULL;
@@ -796,6 +1059,9 @@ svn_client_blame6(svn_revnum_t *start_revnum_p,
   frb.last_revnum = SVN_INVALID_REVNUM;
   frb.last_props = NULL;
   frb.check_mime_type = (frb.backwards && !ignore_mime_type);
+  frb.pending_jobs = apr_array_make(pool, 0, sizeof(struct blame_job));
+  frb.jobs = svn_wc__get_jobs(ctx->wc_ctx);
+  frb.batch_size = (frb.jobs > 1) ? frb.jobs * BLAME_LOOKAHEAD : 1;
 
   SVN_ERR(svn_ra_get_repos_root2(ra_session, &frb.repos_root_url, pool));
 
@@ -815,72 +1081,23 @@ svn_client_blame6(svn_revnum_t *start_revnum_p,
      We need to ensure that we get one revision before the start_rev,
      if available so that we can know what was actually changed in the start
      revision. */
-  SVN_ERR(svn_ra_get_file_revs2(ra_session, "",
-                                frb.backwards ? start_revnum
-                                              : MAX(0, start_revnum-1),
-                                end_revnum,
-                                include_merged_revisions,
-                                file_rev_handler, &frb, pool));
-
-  if (end->kind == svn_opt_revision_working)
-    {
-      /* If the local file is modified we have to call the handler on the
-         working copy file with keywords unexpanded */
-      svn_wc_status3_t *status;
-
-      SVN_ERR(svn_wc_status3(&status, ctx->wc_ctx, target_abspath_or_url, pool,
-                             pool));
-
-      if (status->text_status != svn_wc_status_normal
-          || (status->prop_status != svn_wc_status_normal
-              && status->prop_status != svn_wc_status_none))
-        {
-          svn_stream_t *wcfile;
-          svn_stream_t *tempfile;
-          svn_opt_revision_t rev;
-          svn_boolean_t normalize_eols = FALSE;
-          const char *temppath;
-
-          if (status->prop_status != svn_wc_status_none)
-            {
-              const svn_string_t *eol_style;
-              SVN_ERR(svn_wc_prop_get2(&eol_style, ctx->wc_ctx,
-                                       target_abspath_or_url,
-                                       SVN_PROP_EOL_STYLE,
-                                       pool, pool));
-
-              if (eol_style)
-                {
-                  svn_subst_eol_style_t style;
-                  const char *eol;
-                  svn_subst_eol_style_from_value(&style, &eol, eol_style->data);
-
-                  normalize_eols = (style == svn_subst_eol_style_native);
-                }
-            }
-
-          rev.kind = svn_opt_revision_working;
-          SVN_ERR(svn_client__get_normalized_stream(&wcfile, ctx->wc_ctx,
-                                                    target_abspath_or_url, &rev,
-                                                    FALSE, normalize_eols,
-                                                    ctx->cancel_func,
-                                                    ctx->cancel_baton,
-                                                    pool, pool));
-
-          SVN_ERR(svn_stream_open_unique(&tempfile, &temppath, NULL,
-                                         svn_io_file_del_on_pool_cleanup,
-                                         pool, pool));
-
-          SVN_ERR(svn_stream_copy3(wcfile, tempfile, ctx->cancel_func,
-                                   ctx->cancel_baton, pool));
-
-          SVN_ERR(add_file_blame(frb.last_filename, temppath, frb.chain, NULL,
-                                 frb.diff_options,
-                                 ctx->cancel_func, ctx->cancel_baton, pool));
-
-          frb.last_filename = temppath;
-        }
-    }
+  err = svn_ra_get_file_revs2(ra_session, "",
+                              frb.backwards ? start_revnum
+                                            : MAX(0, start_revnum-1),
+                              end_revnum,
+                              include_merged_revisions,
+                              file_rev_handler, &frb, pool);
+  if (!err)
+    err = flush_blame_jobs(&frb, pool);
+
+  /* If the local file is modified we have to call the handler on the
+     working copy file with keywords unexpanded */
+  if (!err && end->kind == svn_opt_revision_working)
+    err = blame_local_changes(&frb, target_abspath_or_url, pool);
+
+  /* Free the tokenized texts, even after an error. */
+  release_blame_texts(&frb);
+  SVN_ERR(err);
 
   /* Report the blame to the caller. */
 
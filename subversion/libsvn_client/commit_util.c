@@ -45,6 +45,7 @@
 #include "private/svn_wc_private.h"
 #include "private/svn_client_private.h"
 #include "private/svn_sorts_private.h"
+#include "private/svn_task.h"
 
 /*** Uncomment this to turn on commit driver debugging. ***/
 /*
@@ -1856,6 +1857,231 @@ fixup_error:
                                             err, ctx, pool));
 }
 
+/* Return TRUE if ITEM has no history, so that its full text has to be
+   transmitted. */
+static svn_boolean_t
+needs_fulltext(const svn_client_commit_item3_t *item)
+{
+  return (item->state_flags & SVN_CLIENT_COMMIT_ITEM_ADD)
+         && ! (item->state_flags & SVN_CLIENT_COMMIT_ITEM_IS_COPY);
+}
+
+/* Notify CTX that the text delta for ITEM is being transmitted. */
+static void
+notify_txdelta(const svn_client_commit_item3_t *item,
+               const char *notify_path_prefix,
+               svn_client_ctx_t *ctx,
+               apr_pool_t *scratch_pool)
+{
+  svn_wc_notify_t *notify;
+
+  if (!ctx->notify_func2)
+    return;
+
+  notify = svn_wc_create_notify(item->path,
+                                svn_wc_notify_commit_postfix_txdelta,
+                                scratch_pool);
+  notify->kind = svn_node_file;
+  notify->path_prefix = notify_path_prefix;
+  ctx->notify_func2(ctx->notify_baton2, notify, scratch_pool);
+}
+
+/* The number of files per worker thread for which the text deltas get
+   computed ahead of their transmission. */
+#define TXDELTA_LOOKAHEAD 4
+
+/* A batch of text deltas being computed and transmitted concurrently. */
+typedef struct txdelta_batch_t
+{
+  /* The struct file_mod_t * to transmit and their prepared deltas. */
+  struct file_mod_t **mods;
+  svn_wc__text_delta_t **deltas;
+
+  const svn_delta_editor_t *editor;
+  const char *base_url;
+  const char *notify_path_prefix;
+  apr_hash_t *sha1_checksums;
+  svn_client_ctx_t *ctx;
+  apr_pool_t *result_pool;
+} txdelta_batch_t;
+
+/* APR pool cleanup handler clearing the svn_error_t * at DATA. */
+static apr_status_t
+clear_error(void *data)
+{
+  svn_error_t **err = data;
+
+  svn_error_clear(*err);
+  *err = NULL;
+
+  return APR_SUCCESS;
+}
+
+/* Implements svn_task__process_func_t.  Compute the text delta number
+   TASK_INDEX in the txdelta_batch_t PROCESS_BATON.  Return the resulting
+   error, if any, in *RESULT so transmit_txdelta() can report it in task
+   order. */
+static svn_error_t *
+compute_txdelta(void **result,
+                apr_size_t task_index,
+                void *process_baton,
+                void *thread_context,
+                svn_cancel_func_t cancel_func,
+                void *cancel_baton,
+                apr_pool_t *result_pool,
+                apr_pool_t *scratch_pool)
+{
+  const txdelta_batch_t *batch = process_baton;
+  svn_error_t **err = apr_pcalloc(result_pool, sizeof(*err));
+
+  apr_pool_cleanup_register(result_pool, err, clear_error,
+                            apr_pool_cleanup_null);
+  *err = svn_wc__text_delta_compute(batch->deltas[task_index],
+                                    result_pool, scratch_pool);
+
+  *result = err;
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_task__output_func_t.  Transmit the text delta number
+   TASK_INDEX in the txdelta_batch_t OUTPUT_BATON, which compute_txdelta()
+   has computed with the error in RESULT. */
+static svn_error_t *
+transmit_txdelta(void *output_baton,
+                 apr_size_t task_index,
+                 void *result,
+                 svn_cancel_func_t cancel_func,
+                 void *cancel_baton,
+                 apr_pool_t *scratch_pool)
+{
+  txdelta_batch_t *batch = output_baton;
+  struct file_mod_t *mod = batch->mods[task_index];
+  const svn_client_commit_item3_t *item = mod->item;
+  svn_error_t **compute_err = result;
+  const svn_checksum_t *new_text_base_md5_checksum;
+  const svn_checksum_t *new_text_base_sha1_checksum;
+  svn_error_t *err;
+
+  if (cancel_func)
+    SVN_ERR(cancel_func(cancel_baton));
+
+  notify_txdelta(item, batch->notify_path_prefix, batch->ctx, scratch_pool);
+
+  /* Take ownership of the error. */
+  err = *compute_err;
+  *compute_err = NULL;
+
+  if (!err)
+    err = svn_wc__text_delta_send(&new_text_base_md5_checksum,
+                                  &new_text_base_sha1_checksum,
+                                  batch->deltas[task_index],
+                                  batch->editor, mod->file_baton,
+                                  batch->result_pool, scratch_pool);
+  if (err)
+    return svn_error_trace(fixup_commit_error(item->path,
+                                              batch->base_url,
+                                              item->session_relpath,
+                                              svn_node_file,
+                                              err, batch->ctx,
+                                              scratch_pool));
+
+  if (batch->sha1_checksums)
+    svn_hash_sets(batch->sha1_checksums, item->path,
+                  new_text_base_sha1_checksum);
+
+  svn_pool_destroy(mod->file_pool);
+  return SVN_NO_ERROR;
+}
+
+/* Transmit the text deltas for the struct file_mod_t * in MODS like
+   svn_client__do_commit() does, but compute them on up to JOBS threads
+   ahead of their transmission.  The editor is still being driven in
+   order from the calling thread.
+
+   The other parameters are the same as for svn_client__do_commit(). */
+static svn_error_t *
+transmit_txdeltas_concurrently(const apr_array_header_t *mods,
+                               int jobs,
+                               const svn_delta_editor_t *editor,
+                               const char *base_url,
+                               const char *notify_path_prefix,
+                               apr_hash_t *sha1_checksums,
+                               svn_client_ctx_t *ctx,
+                               apr_pool_t *result_pool,
+                               apr_pool_t *scratch_pool)
+{
+  apr_pool_t *batch_pool = svn_pool_create(scratch_pool);
+  int batch_size = jobs * TXDELTA_LOOKAHEAD;
+  txdelta_batch_t batch;
+  int first;
+
+  batch.editor = editor;
+  batch.base_url = base_url;
+  batch.notify_path_prefix = notify_path_prefix;
+  batch.sha1_checksums = sha1_checksums;
+  batch.ctx = ctx;
+  batch.result_pool = result_pool;
+
+  /* Prepare the deltas in batches, so we don't keep too many of them
+     around at the same time. */
+  for (first = 0; first < mods->nelts; first += batch_size)
+    {
+      int count = MIN(batch_size, mods->nelts - first);
+      svn_error_t *err = SVN_NO_ERROR;
+      int i;
+
+      svn_pool_clear(batch_pool);
+
+      batch.mods = &APR_ARRAY_IDX(mods, first, struct file_mod_t *);
+      batch.deltas = apr_pcalloc(batch_pool, count * sizeof(*batch.deltas));
+
+      /* The working copy database may only be accessed from this thread. */
+      for (i = 0; i < count && !err; i++)
+        {
+          const svn_client_commit_item3_t *item = batch.mods[i]->item;
+
+          err = svn_wc__text_delta_prepare(&batch.deltas[i], ctx->wc_ctx,
+                                           item->path, needs_fulltext(item),
+                                           batch_pool, batch_pool);
+          if (err)
+            {
+              /* Transmit the preceding files first, as a sequential
+                 transmission would have done. */
+              err = fixup_commit_error(item->path, base_url,
+                                       item->session_relpath, svn_node_file,
+                                       err, ctx, scratch_pool);
+              count = i;
+            }
+        }
+
+      if (count)
+        {
+          svn_error_t *run_err;
+
+          run_err = svn_task__run(MIN(jobs, count), count,
+                                  compute_txdelta, &batch,
+                                  transmit_txdelta, &batch,
+                                  NULL, NULL,
+                                  ctx->cancel_func, ctx->cancel_baton,
+                                  batch_pool);
+          if (run_err)
+            {
+              svn_error_clear(err);
+              err = run_err;
+            }
+        }
+
+      if (err)
+        {
+          svn_pool_destroy(batch_pool); /* Close tempfiles */
+          return svn_error_trace(err);
+        }
+    }
+
+  svn_pool_destroy(batch_pool);
+  return SVN_NO_ERROR;
+}
+
 svn_error_t *
 svn_client__do_commit(const char *base_url,
                       const apr_array_header_t *commit_items,
@@ -1872,6 +2098,7 @@ svn_client__do_commit(const char *base_url,
   apr_pool_t *iterpool = svn_pool_create(scratch_pool);
   apr_hash_index_t *hi;
   int i;
+  int jobs;
   struct item_commit_baton cb_baton;
   apr_array_header_t *paths =
     apr_array_make(scratch_pool, commit_items->nelts, sizeof(const char *));
@@ -1904,59 +2131,69 @@ svn_client__do_commit(const char *base_url,
                                  do_item_commit, &cb_baton, scratch_pool));
 
   /* Transmit outstanding text deltas. */
-  for (hi = apr_hash_first(scratch_pool, file_mods);
-       hi;
-       hi = apr_hash_next(hi))
+  jobs = svn_wc__get_jobs(ctx->wc_ctx);
+  if (jobs > 1 && apr_hash_count(file_mods) > 1)
     {
-      struct file_mod_t *mod = apr_hash_this_val(hi);
-      const svn_client_commit_item3_t *item = mod->item;
-      const svn_checksum_t *new_text_base_md5_checksum;
-      const svn_checksum_t *new_text_base_sha1_checksum;
-      svn_boolean_t fulltext = FALSE;
-      svn_error_t *err;
+      apr_array_header_t *mods
+        = apr_array_make(scratch_pool, apr_hash_count(file_mods),
+                         sizeof(struct file_mod_t *));
 
-      svn_pool_clear(iterpool);
+      for (hi = apr_hash_first(scratch_pool, file_mods);
+           hi;
+           hi = apr_hash_next(hi))
+        APR_ARRAY_PUSH(mods, struct file_mod_t *) = apr_hash_this_val(hi);
+
+      SVN_ERR(transmit_txdeltas_concurrently(mods, jobs, editor, base_url,
+                                             notify_path_prefix,
+                                             sha1_checksums
+                                               ? *sha1_checksums : NULL,
+                                             ctx, result_pool,
+                                             scratch_pool));
+    }
+  else
+    {
+      for (hi = apr_hash_first(scratch_pool, file_mods);
+           hi;
+           hi = apr_hash_next(hi))
+        {
+          struct file_mod_t *mod = apr_hash_this_val(hi);
+          const svn_client_commit_item3_t *item = mod->item;
+          const svn_checksum_t *new_text_base_md5_checksum;
+          const svn_checksum_t *new_text_base_sha1_checksum;
+          svn_error_t *err;
 
-      /* Transmit the entry. */
-      if (ctx->cancel_func)
-        SVN_ERR(ctx->cancel_func(ctx->cancel_baton));
+          svn_pool_clear(iterpool);
 
-      if (ctx->notify_func2)
-        {
-          svn_wc_notify_t *notify;
-          notify = svn_wc_create_notify(item->path,
-                                        svn_wc_notify_commit_postfix_txdelta,
-                                        iterpool);
-          notify->kind = svn_node_file;
-          notify->path_prefix = notify_path_prefix;
-          ctx->notify_func2(ctx->notify_baton2, notify, iterpool);
-        }
+          /* Transmit the entry. */
+          if (ctx->cancel_func)
+            SVN_ERR(ctx->cancel_func(ctx->cancel_baton));
 
-      /* If the node has no history, transmit full text */
-      if ((item->state_flags & SVN_CLIENT_COMMIT_ITEM_ADD)
-          && ! (item->state_flags & SVN_CLIENT_COMMIT_ITEM_IS_COPY))
-        fulltext = TRUE;
+          notify_txdelta(item, notify_path_prefix, ctx, iterpool);
 
-      err = svn_wc_transmit_text_deltas3(&new_text_base_md5_checksum,
-                                         &new_text_base_sha1_checksum,
-                                         ctx->wc_ctx, item->path,
-                                         fulltext, editor, mod->file_baton,
-                                         result_pool, iterpool);
+          err = svn_wc_transmit_text_deltas3(&new_text_base_md5_checksum,
+                                             &new_text_base_sha1_checksum,
+                                             ctx->wc_ctx, item->path,
+                                             needs_fulltext(item),
+                                             editor, mod->file_baton,
+                                             result_pool, iterpool);
 
-      if (err)
-        {
-          svn_pool_destroy(iterpool); /* Close tempfiles */
-          return svn_error_trace(fixup_commit_error(item->path,
-                                                    base_url,
-                                                    item->session_relpath,
-                                                    svn_node_file,
-                                                    err, ctx, scratch_pool));
-        }
+          if (err)
+            {
+              svn_pool_destroy(iterpool); /* Close tempfiles */
+              return svn_error_trace(fixup_commit_error(item->path,
+                                                        base_url,
+                                                        item->session_relpath,
+                                                        svn_node_file,
+                                                        err, ctx,
+                                                        scratch_pool));
+            }
 
-      if (sha1_checksums)
-        svn_hash_sets(*sha1_checksums, item->path, new_text_base_sha1_checksum);
+          if (sha1_checksums)
+            svn_hash_sets(*sha1_checksums, item->path,
+                          new_text_base_sha1_checksum);
 
-      svn_pool_destroy(mod->file_pool);
+          svn_pool_destroy(mod->file_pool);
+        }
     }
 
   if (ctx->notify_func2)
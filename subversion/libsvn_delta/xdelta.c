@@ -295,12 +295,19 @@ find_match(const struct blocks *blocks,
                                     max_delta);
 
   /* See if we can extend backwards (max MATCH_BLOCKSIZE-1 steps because A's
-     content has been sampled only every MATCH_BLOCKSIZE positions).  */
-  while (apos > 0 && bpos > pending_insert_start && a[apos-1] == b[bpos-1])
+     content has been sampled only every MATCH_BLOCKSIZE positions).
+     Compare whole machine words where possible instead of single bytes. */
+  max_delta = apos < bpos - pending_insert_start
+            ? apos
+            : bpos - pending_insert_start;
+  if (max_delta > 0)
     {
-      --apos;
-      --bpos;
-      ++delta;
+      apr_size_t back = svn_cstring__reverse_match_length(a + apos,
+                                                          b + bpos,
+                                                          max_delta);
+      apos -= back;
+      bpos -= back;
+      delta += back;
     }
 
   *aposp = apos;
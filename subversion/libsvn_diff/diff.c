@@ -126,10 +126,11 @@ svn_diff__diff(svn_diff__lcs_t *lcs,
 
 
 svn_error_t *
-svn_diff_diff_2(svn_diff_t **diff,
-                void *diff_baton,
-                const svn_diff_fns2_t *vtable,
-                apr_pool_t *pool)
+svn_diff__diff_2(svn_diff_t **diff,
+                 void *diff_baton,
+                 const svn_diff_fns2_t *vtable,
+                 svn_diff_file_algorithm_t algorithm,
+                 apr_pool_t *pool)
 {
   svn_diff__tree_t *tree;
   svn_diff__position_t *position_list[2];
@@ -187,7 +188,7 @@ svn_diff_diff_2(svn_diff_t **diff,
   /* Get the lcs */
   lcs = svn_diff__lcs(position_list[0], position_list[1], token_counts[0],
                       token_counts[1], num_tokens, prefix_lines,
-                      suffix_lines, subpool);
+                      suffix_lines, algorithm, subpool);
 
   /* Produce the diff */
   *diff = svn_diff__diff(lcs, 1, 1, TRUE, pool);
@@ -197,3 +198,13 @@ svn_diff_diff_2(svn_diff_t **diff,
 
   return SVN_NO_ERROR;
 }
+
+svn_error_t *
+svn_diff_diff_2(svn_diff_t **diff,
+                void *diff_baton,
+                const svn_diff_fns2_t *vtable,
+                apr_pool_t *pool)
+{
+  return svn_diff__diff_2(diff, diff_baton, vtable,
+                          svn_diff_file_algorithm_lcs, pool);
+}
@@ -101,6 +101,10 @@ typedef enum svn_diff__normalize_state_t
  * equal and be excluded from the comparison process. Similarly, SUFFIX_LINES
  * at the end of both sequences will be skipped.
  *
+ * ALGORITHM selects how the common subsequence is found; with
+ * svn_diff_file_algorithm_patience the result is not necessarily the
+ * longest one.
+ *
  * The resulting lcs structure will be the return value of this function.
  * Allocations will be made from POOL.
  */
@@ -112,8 +116,24 @@ svn_diff__lcs(svn_diff__position_t *position_list1, /* pointer to tail (ring) */
               svn_diff__token_index_t num_tokens, /* length of count arrays */
               apr_off_t prefix_lines,
               apr_off_t suffix_lines,
+              svn_diff_file_algorithm_t algorithm,
               apr_pool_t *pool);
 
+/*
+ * Find the common parts of the non-empty rings POSITION_LIST1 and
+ * POSITION_LIST2 (pointers to their tails) with the patience diff
+ * algorithm, for svn_diff__lcs().  NUM_TOKENS is one more than the
+ * highest token index in either ring.
+ *
+ * Return the matching regions as a chain in reverse order (last match
+ * first), without the EOF element.  Allocations will be made from POOL.
+ */
+svn_diff__lcs_t *
+svn_diff__lcs_patience(svn_diff__position_t *position_list1,
+                       svn_diff__position_t *position_list2,
+                       svn_diff__token_index_t num_tokens,
+                       apr_pool_t *pool);
+
 
 /*
  * Returns number of tokens in a tree
@@ -158,6 +178,29 @@ svn_diff__diff(svn_diff__lcs_t *lcs,
                svn_boolean_t want_common,
                apr_pool_t *pool);
 
+/* Like svn_diff_diff_2(), svn_diff_diff3_2() and svn_diff_diff4_2(),
+ * but find the common parts with ALGORITHM. */
+svn_error_t *
+svn_diff__diff_2(svn_diff_t **diff,
+                 void *diff_baton,
+                 const svn_diff_fns2_t *vtable,
+                 svn_diff_file_algorithm_t algorithm,
+                 apr_pool_t *pool);
+
+svn_error_t *
+svn_diff__diff3(svn_diff_t **diff,
+                void *diff_baton,
+                const svn_diff_fns2_t *vtable,
+                svn_diff_file_algorithm_t algorithm,
+                apr_pool_t *pool);
+
+svn_error_t *
+svn_diff__diff4(svn_diff_t **diff,
+                void *diff_baton,
+                const svn_diff_fns2_t *vtable,
+                svn_diff_file_algorithm_t algorithm,
+                apr_pool_t *pool);
+
 void
 svn_diff__resolve_conflict(svn_diff_t *hunk,
                            svn_diff__position_t **position_list1,
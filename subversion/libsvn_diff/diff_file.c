@@ -91,11 +91,28 @@ typedef struct svn_diff__file_baton_t
     /* Where the identical suffix starts in this datasource */
     int suffix_start_chunk;
     apr_off_t suffix_offset_in_chunk;
+
+    /* In block mode, the number of lines after the identical prefix that
+     * precede each token read so far, and the total number of lines in
+     * those tokens. */
+    apr_array_header_t *block_starts;
+    apr_off_t block_lines_read;
   } files[4];
 
   /* List of free tokens that may be reused. */
   svn_diff__file_token_t *tokens;
 
+  /* The number of identical prefix lines. */
+  apr_off_t prefix_lines;
+
+  /* If not zero, tokens are blocks of lines rather than single lines, and
+   * this is the minimum number of lines per block. */
+  apr_off_t block_lines;
+
+  /* Pool for the block_starts arrays, which must survive the tokens.
+   * Block mode is only used if this is set. */
+  apr_pool_t *block_pool;
+
   apr_pool_t *pool;
 } svn_diff__file_baton_t;
 
@@ -130,7 +147,7 @@ datasource_to_index(svn_diff_datasource_e datasource)
 #define CHUNK_SHIFT 17
 #define CHUNK_SIZE (1 << CHUNK_SHIFT)
 
-#define chunk_to_offset(chunk) ((chunk) << CHUNK_SHIFT)
+#define chunk_to_offset(chunk) ((apr_off_t)(chunk) << CHUNK_SHIFT)
 #define offset_to_chunk(offset) ((offset) >> CHUNK_SHIFT)
 #define offset_in_chunk(offset) ((offset) & (CHUNK_SIZE - 1))
 
@@ -355,21 +372,53 @@ is_one_at_eof(struct file_info file[], apr_size_t file_len)
   return FALSE;
 }
 
-/* Quickly determine whether there is a eol char in CHUNK.
- * (mainly copy-n-paste from eol.c#svn_eol__find_eol_start).
+/* Helpers to process chunks of bytes a machine word at a time
+ * (see also eol.c#svn_eol__find_eol_start).
  */
 
 #if SVN_UNALIGNED_ACCESS_IS_OK
-static svn_boolean_t contains_eol(apr_uintptr_t chunk)
+/* Words with every byte set to \n resp. \r. */
+#define NL_BYTES ((SVN__BIT_7_SET >> 7) * '\n')
+#define CR_BYTES ((SVN__BIT_7_SET >> 7) * '\r')
+
+/* Return a word with bit 7 set in exactly those bytes in which CHUNK
+ * equals BYTES, e.g. NL_BYTES.  The test is exact for every byte, as
+ * opposed to the usual strlen test, because no carry crosses a byte. */
+static APR_INLINE apr_uintptr_t
+matching_bytes(apr_uintptr_t chunk, apr_uintptr_t bytes)
 {
-  apr_uintptr_t r_test = chunk ^ SVN__R_MASK;
-  apr_uintptr_t n_test = chunk ^ SVN__N_MASK;
+  apr_uintptr_t test = chunk ^ bytes;
 
-  r_test |= (r_test & SVN__LOWER_7BITS_SET) + SVN__LOWER_7BITS_SET;
-  n_test |= (n_test & SVN__LOWER_7BITS_SET) + SVN__LOWER_7BITS_SET;
+  test |= (test & SVN__LOWER_7BITS_SET) + SVN__LOWER_7BITS_SET;
 
-  return (r_test & n_test & SVN__BIT_7_SET) != SVN__BIT_7_SET;
+  return ~test & SVN__BIT_7_SET;
+}
+
+/* Return the number of bytes flagged in MATCHES, a result of
+ * matching_bytes().  The multiplication sums up all flags in the
+ * most significant byte. */
+static APR_INLINE apr_off_t
+count_matching_bytes(apr_uintptr_t matches)
+{
+  return (apr_off_t)(((matches >> 7) * (SVN__BIT_7_SET >> 7))
+                     >> (8 * (sizeof(apr_uintptr_t) - 1)));
 }
+
+/* The flags of matching_bytes() for the first resp. last byte of a word
+ * in memory order and ways to move all flags of a word to the next resp.
+ * previous byte in memory order.  They tell a \r\n from a \r and a \n.
+ */
+#if APR_IS_BIGENDIAN
+#define FIRST_BYTE_FLAG (SVN__BIT_7_SET ^ (SVN__BIT_7_SET >> 8))
+#define LAST_BYTE_FLAG ((apr_uintptr_t)0x80)
+#define TO_NEXT_BYTES(flags) ((flags) >> 8)
+#define TO_PREVIOUS_BYTES(flags) ((flags) << 8)
+#else
+#define FIRST_BYTE_FLAG ((apr_uintptr_t)0x80)
+#define LAST_BYTE_FLAG (SVN__BIT_7_SET ^ (SVN__BIT_7_SET >> 8))
+#define TO_NEXT_BYTES(flags) ((flags) << 8)
+#define TO_PREVIOUS_BYTES(flags) ((flags) >> 8)
+#endif
 #endif
 
 /* Find the prefix which is identical between all elements of the FILE array.
@@ -398,6 +447,7 @@ find_identical_prefix(svn_boolean_t *reached_one_eof, apr_off_t *prefix_lines,
     {
 #if SVN_UNALIGNED_ACCESS_IS_OK
       apr_ssize_t max_delta, delta;
+      apr_uintptr_t cr_before;
 #endif /* SVN_UNALIGNED_ACCESS_IS_OK */
 
       /* ### TODO: see if we can take advantage of
@@ -434,12 +484,17 @@ find_identical_prefix(svn_boolean_t *reached_one_eof, apr_off_t *prefix_lines,
             max_delta = delta;
         }
 
+      /* Lines are counted a whole word at a time, so short lines don't
+       * throw us back to the bytewise loop above.  A \r\n may straddle
+       * two words, so CR_BEFORE flags the first byte of the next word if
+       * the byte before it is a \r.
+       */
+      cr_before = had_cr ? FIRST_BYTE_FLAG : 0;
       is_match = TRUE;
       for (delta = 0; delta < max_delta; delta += sizeof(apr_uintptr_t))
         {
           apr_uintptr_t chunk = *(const apr_uintptr_t *)(file[0].curp + delta);
-          if (contains_eol(chunk))
-            break;
+          apr_uintptr_t nls, crs;
 
           for (i = 1; i < file_len; i++)
             if (chunk != *(const apr_uintptr_t *)(file[i].curp + delta))
@@ -450,19 +505,28 @@ find_identical_prefix(svn_boolean_t *reached_one_eof, apr_off_t *prefix_lines,
 
           if (! is_match)
             break;
+
+          /* Count every \r and every \n not preceded by a \r, just like
+           * the bytewise loop does. */
+          nls = matching_bytes(chunk, NL_BYTES);
+          crs = matching_bytes(chunk, CR_BYTES);
+          lines += count_matching_bytes(
+                     crs | (nls & ~(TO_NEXT_BYTES(crs) | cr_before)));
+          cr_before = (crs & LAST_BYTE_FLAG) ? FIRST_BYTE_FLAG : 0;
         }
 
       if (delta /* > 0*/)
         {
-          /* We either found a mismatch or an EOL at or shortly behind curp+delta
-           * or we cannot proceed with chunky ops without exceeding endp.
-           * In any way, everything up to curp + delta is equal and not an EOL.
+          /* We either found a mismatch at or shortly behind curp+delta or
+           * we cannot proceed with chunky ops without exceeding endp.
+           * In any way, everything up to curp + delta is equal and we
+           * counted the EOLs in there.
            */
           for (i = 0; i < file_len; i++)
             file[i].curp += delta;
 
-          /* Skipped data without EOL markers, so last char was not a CR. */
-          had_cr = FALSE;
+          /* Was the last byte we skipped a CR? */
+          had_cr = cr_before != 0;
         }
 #endif
 
@@ -615,6 +679,7 @@ find_identical_suffix(apr_off_t *suffix_lines, struct file_info file[],
       /* Initialize the minimum pointer positions. */
       const char *min_curp[4];
       svn_boolean_t can_read_word;
+      apr_uintptr_t nl_behind;
 #endif /* SVN_UNALIGNED_ACCESS_IS_OK */
 
       /* ### TODO: see if we can take advantage of
@@ -651,9 +716,12 @@ find_identical_suffix(apr_off_t *suffix_lines, struct file_info file[],
         can_read_word = ((file_for_suffix[i].curp + 1 - sizeof(apr_uintptr_t))
                          > min_curp[i]);
 
+      /* Like CR_BEFORE in find_identical_prefix(), NL_BEHIND flags the
+         last byte of the next word if the byte behind it is a \n. */
+      nl_behind = had_nl ? LAST_BYTE_FLAG : 0;
       while (can_read_word)
         {
-          apr_uintptr_t chunk;
+          apr_uintptr_t chunk, nls, crs;
 
           /* For each file curp is positioned at the current byte, but we
              want to examine the current byte and the ones before the current
@@ -661,8 +729,6 @@ find_identical_suffix(apr_off_t *suffix_lines, struct file_info file[],
 
           chunk = *(const apr_uintptr_t *)(file_for_suffix[0].curp + 1
                                              - sizeof(apr_uintptr_t));
-          if (contains_eol(chunk))
-            break;
 
           for (i = 1, is_match = TRUE; is_match && i < file_len; i++)
             is_match = (chunk
@@ -673,6 +739,14 @@ find_identical_suffix(apr_off_t *suffix_lines, struct file_info file[],
           if (! is_match)
             break;
 
+          /* Count every \n and every \r not followed by a \n, just like
+             the bytewise loop does. */
+          nls = matching_bytes(chunk, NL_BYTES);
+          crs = matching_bytes(chunk, CR_BYTES);
+          lines += count_matching_bytes(
+                     nls | (crs & ~(TO_PREVIOUS_BYTES(nls) | nl_behind)));
+          nl_behind = (nls & FIRST_BYTE_FLAG) ? LAST_BYTE_FLAG : 0;
+
           for (i = 0; i < file_len; i++)
             {
               file_for_suffix[i].curp -= sizeof(apr_uintptr_t);
@@ -682,8 +756,9 @@ find_identical_suffix(apr_off_t *suffix_lines, struct file_info file[],
                                   > min_curp[i]);
             }
 
-          /* We skipped some bytes, so there are no closing EOLs */
-          had_nl = FALSE;
+          /* A CR right before the skipped bytes may start a CRLF that we
+             already counted. */
+          had_nl = nl_behind != 0;
         }
 
       /* The > min_curp[i] check leaves at least one final byte for checking
@@ -752,6 +827,175 @@ find_identical_suffix(apr_off_t *suffix_lines, struct file_info file[],
 }
 
 
+/* The approximate number of bytes the diff needs per token: the token
+ * itself, its position in the token list, its node in the token tree and
+ * its share of the LCS state. */
+#define MEMORY_PER_TOKEN 128
+
+/* The largest number of lines block mode puts into one block. */
+#define MAX_BLOCK_LINES (1 << 16)
+
+/* count_lines() maps the files in windows of this many bytes.  It must be
+ * a multiple of the page size. */
+#define COUNT_WINDOW_SIZE (16 * 1024 * 1024)
+
+/* Add the number of LFs and CRs in the LEN bytes at DATA to *NEWLINES and
+ * *RETURNS, respectively. */
+static void
+count_eols(apr_off_t *newlines, apr_off_t *returns,
+           const char *data, apr_size_t len)
+{
+  const char *end = data + len;
+
+#if SVN_UNALIGNED_ACCESS_IS_OK
+  for (; data + sizeof(apr_uintptr_t) <= end; data += sizeof(apr_uintptr_t))
+    {
+      apr_uintptr_t chunk = *(const apr_uintptr_t *)data;
+
+      *newlines += count_matching_bytes(matching_bytes(chunk, NL_BYTES));
+      *returns += count_matching_bytes(matching_bytes(chunk, CR_BYTES));
+    }
+#endif
+
+  for (; data < end; data++)
+    {
+      if (*data == '\n')
+        ++*newlines;
+      else if (*data == '\r')
+        ++*returns;
+    }
+}
+
+/* Set *LINES to an estimate of the number of lines between the offsets
+ * START and END of FILE, without keeping more than a window of the file in
+ * memory: map it in windows of COUNT_WINDOW_SIZE bytes, or read it in
+ * chunks if it cannot be mapped.  Use SCRATCH_POOL for temporary
+ * allocations. */
+static svn_error_t *
+count_lines(apr_off_t *lines,
+            struct file_info *file,
+            apr_off_t start,
+            apr_off_t end,
+            apr_pool_t *scratch_pool)
+{
+  apr_pool_t *iterpool = svn_pool_create(scratch_pool);
+  apr_off_t newlines = 0;
+  apr_off_t returns = 0;
+  char *buffer = NULL;
+  apr_off_t window;
+
+  for (window = start - start % COUNT_WINDOW_SIZE;
+       window < end;
+       window += COUNT_WINDOW_SIZE)
+    {
+      apr_off_t from = start > window ? start : window;
+      apr_off_t to = end < window + COUNT_WINDOW_SIZE
+                     ? end : window + COUNT_WINDOW_SIZE;
+      svn_boolean_t counted = FALSE;
+
+      svn_pool_clear(iterpool);
+
+#if APR_HAS_MMAP
+      {
+        apr_mmap_t *mm;
+
+        /* The mapping is removed when ITERPOOL is cleared. */
+        if (apr_mmap_create(&mm, file->file, window,
+                            (apr_size_t)(to - window), APR_MMAP_READ,
+                            iterpool) == APR_SUCCESS)
+          {
+            count_eols(&newlines, &returns,
+                       (const char *)mm->mm + (from - window),
+                       (apr_size_t)(to - from));
+            counted = TRUE;
+          }
+      }
+#endif
+
+      for (; !counted && from < to; from += CHUNK_SIZE)
+        {
+          apr_off_t length = to - from < CHUNK_SIZE ? to - from : CHUNK_SIZE;
+
+          if (buffer == NULL)
+            buffer = apr_palloc(scratch_pool, CHUNK_SIZE);
+
+          SVN_ERR(read_chunk(file->file, buffer, length, from, iterpool));
+          count_eols(&newlines, &returns, buffer, (apr_size_t)length);
+        }
+    }
+
+  svn_pool_destroy(iterpool);
+
+  /* CRLFs count twice; a last line may lack its EOL. */
+  *lines = (newlines > returns ? newlines : returns) + 1;
+
+  return SVN_NO_ERROR;
+}
+
+/* If the options of FILE_BATON limit the memory for the diff, estimate the
+ * number of lines of the DATASOURCES_LEN files in DATASOURCES beyond their
+ * identical prefix and suffix.  If holding all those lines as tokens would
+ * exceed the limit, switch FILE_BATON to block mode with blocks large
+ * enough to fit.
+ *
+ * read_line() normalizes every line in place, so the normalized contents
+ * of a block are not contiguous in memory, which token_compare() expects.
+ * Therefore, don't use block mode when ignoring white space or EOL styles.
+ */
+static svn_error_t *
+choose_block_mode(svn_diff__file_baton_t *file_baton,
+                  const svn_diff_datasource_e *datasources,
+                  apr_size_t datasources_len)
+{
+  apr_size_t memory_limit = file_baton->options->memory_limit;
+  apr_off_t lines = 0;
+  apr_off_t block_lines = 1;
+  apr_size_t i;
+
+  if (memory_limit == 0 || file_baton->block_pool == NULL
+      || file_baton->options->ignore_space != svn_diff_file_ignore_space_none
+      || file_baton->options->ignore_eol_style)
+    return SVN_NO_ERROR;
+
+  for (i = 0; i < datasources_len; i++)
+    {
+      struct file_info *file
+          = &file_baton->files[datasource_to_index(datasources[i])];
+      apr_off_t start = chunk_to_offset(file->chunk)
+                        + (file->curp - file->buffer);
+      apr_off_t end = file->size;
+      apr_off_t file_lines;
+
+      if (file->suffix_start_chunk >= 0)
+        end = chunk_to_offset(file->suffix_start_chunk)
+              + file->suffix_offset_in_chunk;
+
+      SVN_ERR(count_lines(&file_lines, file, start, end, file_baton->pool));
+      lines += file_lines;
+    }
+
+  while (lines / block_lines > memory_limit / MEMORY_PER_TOKEN
+         && block_lines < MAX_BLOCK_LINES)
+    block_lines *= 2;
+
+  if (block_lines == 1)
+    return SVN_NO_ERROR;
+
+  file_baton->block_lines = block_lines;
+  for (i = 0; i < datasources_len; i++)
+    {
+      struct file_info *file
+          = &file_baton->files[datasource_to_index(datasources[i])];
+
+      file->block_starts = apr_array_make(file_baton->block_pool, 64,
+                                          sizeof(apr_off_t));
+      file->block_lines_read = 0;
+    }
+
+  return SVN_NO_ERROR;
+}
+
+
 /* Let FILE stand for the array of file_info struct elements of BATON->files
  * that are indexed by the elements of the DATASOURCE array.
  * BATON's type is (svn_diff__file_baton_t *).
@@ -816,7 +1060,8 @@ datasources_open(void *baton,
   for (i = 0; i < datasources_len; i++)
     if (length[i] == 0)
       /* There will not be any identical prefix/suffix, so we're done. */
-      return SVN_NO_ERROR;
+      return svn_error_trace(choose_block_mode(file_baton, datasources,
+                                               datasources_len));
 
 #ifndef SVN_DISABLE_PREFIX_SUFFIX_SCANNING
 
@@ -835,7 +1080,10 @@ datasources_open(void *baton,
   for (i = 0; i < datasources_len; i++)
     file_baton->files[datasource_to_index(datasources[i])] = files[i];
 
-  return SVN_NO_ERROR;
+  file_baton->prefix_lines = *prefix_lines;
+
+  return svn_error_trace(choose_block_mode(file_baton, datasources,
+                                           datasources_len));
 }
 
 
@@ -850,67 +1098,54 @@ datasource_close(void *baton, svn_diff_datasource_e datasource)
   return SVN_NO_ERROR;
 }
 
-/* Implements svn_diff_fns2_t::datasource_get_next_token */
-static svn_error_t *
-datasource_get_next_token(apr_uint32_t *hash, void **token, void *baton,
-                          svn_diff_datasource_e datasource)
+/* Return TRUE if FILE has no more tokens, because it is at its end or at
+ * the start of the identical suffix. */
+static svn_boolean_t
+at_last_token(const struct file_info *file)
 {
-  svn_diff__file_baton_t *file_baton = baton;
-  svn_diff__file_token_t *file_token;
-  struct file_info *file = &file_baton->files[datasource_to_index(datasource)];
-  char *endp;
-  char *curp;
-  char *eol;
-  apr_off_t last_chunk;
-  apr_off_t length;
-  apr_uint32_t h = 0;
-  /* Did the last chunk end in a CR character? */
-  svn_boolean_t had_cr = FALSE;
-
-  *token = NULL;
-
-  curp = file->curp;
-  endp = file->endp;
-
-  last_chunk = offset_to_chunk(file->size);
-
   /* Are we already at the end of a chunk? */
-  if (curp == endp)
+  if (file->curp == file->endp)
     {
       /* Are we at EOF */
-      if (last_chunk == file->chunk)
-        return SVN_NO_ERROR; /* EOF */
+      if (offset_to_chunk(file->size) == file->chunk)
+        return TRUE; /* EOF */
 
       /* Or right before an identical suffix in the next chunk? */
       if (file->chunk + 1 == file->suffix_start_chunk
           && file->suffix_offset_in_chunk == 0)
-        return SVN_NO_ERROR;
+        return TRUE;
     }
 
   /* Stop when we encounter the identical suffix. If suffix scanning was not
    * performed, suffix_start_chunk will be -1, so this condition will never
    * be true. */
-  if (file->chunk == file->suffix_start_chunk
-      && (curp - file->buffer) == file->suffix_offset_in_chunk)
-    return SVN_NO_ERROR;
+  return (file->chunk == file->suffix_start_chunk
+          && (file->curp - file->buffer) == file->suffix_offset_in_chunk);
+}
 
-  /* Allocate a new token, or fetch one from the "reusable tokens" list. */
-  file_token = file_baton->tokens;
-  if (file_token)
-    {
-      file_baton->tokens = file_token->next;
-    }
-  else
-    {
-      file_token = apr_palloc(file_baton->pool, sizeof(*file_token));
-    }
+/* Append the line at the current position of FILE to FILE_TOKEN and move
+ * past it.  Set *HASH to the hash of the normalized line.  FILE_BATON is
+ * the baton of the diff. */
+static svn_error_t *
+read_line(apr_uint32_t *hash,
+          svn_diff__file_token_t *file_token,
+          struct file_info *file,
+          svn_diff__file_baton_t *file_baton)
+{
+  char *endp;
+  char *curp;
+  char *eol;
+  apr_off_t last_chunk;
+  apr_off_t length;
+  apr_off_t raw_length = 0;
+  apr_uint32_t h = 0;
+  /* Did the last chunk end in a CR character? */
+  svn_boolean_t had_cr = FALSE;
 
-  file_token->datasource = datasource;
-  file_token->offset = chunk_to_offset(file->chunk)
-                       + (curp - file->buffer);
-  file_token->norm_offset = file_token->offset;
-  file_token->raw_length = 0;
-  file_token->length = 0;
+  curp = file->curp;
+  endp = file->endp;
+
+  last_chunk = offset_to_chunk(file->size);
 
   while (1)
     {
@@ -936,7 +1171,7 @@ datasource_get_next_token(apr_uint32_t *hash, void **token, void *baton,
         }
 
       length = endp - curp;
-      file_token->raw_length += length;
+      raw_length += length;
       {
         char *c = curp;
 
@@ -984,15 +1219,15 @@ datasource_get_next_token(apr_uint32_t *hash, void **token, void *baton,
     }
 
   length = eol - curp;
-  file_token->raw_length += length;
+  raw_length += length;
   file->curp = eol;
 
   /* If the file length is exactly a multiple of CHUNK_SIZE, we will end up
-   * with a spurious empty token.  Avoid returning it.
+   * with a spurious empty line.  Don't add it to the token.
    * Note that we use the unnormalized length; we don't want a line containing
    * only spaces (and no trailing newline) to appear like a non-existent
    * line. */
-  if (file_token->raw_length > 0)
+  if (raw_length > 0)
     {
       char *c = curp;
       svn_diff__normalize_buffer(&c, &length,
@@ -1006,8 +1241,97 @@ datasource_get_next_token(apr_uint32_t *hash, void **token, void *baton,
         }
 
       file_token->length += length;
+      file_token->raw_length += raw_length;
+      h = svn__adler32(h, c, length);
+    }
+
+  *hash = h;
+
+  return SVN_NO_ERROR;
+}
+
+/* Return TRUE if a block of LINES lines that ends with a line with hash
+ * HASH is complete in block mode with BLOCK_LINES lines per block.
+ *
+ * Whether a line ends a block depends only on its contents, so that
+ * identical runs of lines in both files are cut into identical blocks
+ * again soon after a change. */
+static APR_INLINE svn_boolean_t
+is_block_end(apr_uint32_t hash, apr_off_t lines, apr_off_t block_lines)
+{
+  if (lines >= 4 * block_lines)
+    return TRUE;
+
+  if (lines < block_lines)
+    return FALSE;
+
+  /* Adler-32 distributes its low bits poorly; mix it first. */
+  return (((hash * 0x9E3779B1U) >> 16) & (block_lines - 1)) == 0;
+}
+
+/* Implements svn_diff_fns2_t::datasource_get_next_token */
+static svn_error_t *
+datasource_get_next_token(apr_uint32_t *hash, void **token, void *baton,
+                          svn_diff_datasource_e datasource)
+{
+  svn_diff__file_baton_t *file_baton = baton;
+  svn_diff__file_token_t *file_token;
+  struct file_info *file = &file_baton->files[datasource_to_index(datasource)];
+  apr_uint32_t h;
+
+  *token = NULL;
+
+  if (at_last_token(file))
+    return SVN_NO_ERROR;
+
+  /* Allocate a new token, or fetch one from the "reusable tokens" list. */
+  file_token = file_baton->tokens;
+  if (file_token)
+    {
+      file_baton->tokens = file_token->next;
+    }
+  else
+    {
+      file_token = apr_palloc(file_baton->pool, sizeof(*file_token));
+    }
+
+  file_token->datasource = datasource;
+  file_token->offset = chunk_to_offset(file->chunk)
+                       + (file->curp - file->buffer);
+  file_token->norm_offset = file_token->offset;
+  file_token->raw_length = 0;
+  file_token->length = 0;
+
+  SVN_ERR(read_line(&h, file_token, file, file_baton));
+
+  /* In block mode, add further lines up to the end of the block.  The
+   * hash of the block combines the hashes of its lines. */
+  if (file_baton->block_lines && file_token->raw_length > 0)
+    {
+      apr_off_t lines = 1;
+      apr_uint32_t block_hash = h;
+
+      while (!is_block_end(h, lines, file_baton->block_lines)
+             && !at_last_token(file))
+        {
+          apr_off_t raw_length = file_token->raw_length;
 
-      *hash = svn__adler32(h, c, length);
+          SVN_ERR(read_line(&h, file_token, file, file_baton));
+          if (file_token->raw_length == raw_length)
+            break;
+
+          block_hash = block_hash * 33 + h;
+          lines++;
+        }
+
+      APR_ARRAY_PUSH(file->block_starts, apr_off_t) = file->block_lines_read;
+      file->block_lines_read += lines;
+      h = block_hash;
+    }
+
+  if (file_token->raw_length > 0)
+    {
+      *hash = h;
       *token = file_token;
     }
 
@@ -1179,8 +1503,10 @@ static const svn_diff_fns2_t svn_diff__file_vtable =
   token_discard_all
 };
 
-/* Id for the --ignore-eol-style option, which doesn't have a short name. */
+/* Ids for the options which don't have a short name. */
 #define SVN_DIFF__OPT_IGNORE_EOL_STYLE 256
+#define SVN_DIFF__OPT_PATIENCE 257
+#define SVN_DIFF__OPT_MEMORY_LIMIT 258
 
 /* Options supported by svn_diff_file_options_parse(). */
 static const apr_getopt_option_t diff_options[] =
@@ -1193,6 +1519,8 @@ static const apr_getopt_option_t diff_options[] =
    * ### we don't have optional argument support. */
   { "unified", 'u', 0, NULL },
   { "context", 'U', 1, NULL },
+  { "patience", SVN_DIFF__OPT_PATIENCE, 0, NULL },
+  { "memory-limit", SVN_DIFF__OPT_MEMORY_LIMIT, 1, NULL },
   { NULL, 0, 0, NULL }
 };
 
@@ -1298,6 +1626,18 @@ svn_diff_file_options_parse(svn_diff_file_options_t *options,
         case 'U':
           SVN_ERR(svn_cstring_atoi(&options->context_size, opt_arg));
           break;
+        case SVN_DIFF__OPT_PATIENCE:
+          options->algorithm = svn_diff_file_algorithm_patience;
+          break;
+        case SVN_DIFF__OPT_MEMORY_LIMIT:
+          {
+            apr_uint64_t megabytes;
+
+            SVN_ERR(svn_cstring_strtoui64(&megabytes, opt_arg, 0,
+                                          APR_SIZE_MAX / (1024 * 1024), 10));
+            options->memory_limit = (apr_size_t)megabytes * 1024 * 1024;
+          }
+          break;
         default:
           break;
         }
@@ -1312,6 +1652,56 @@ svn_diff_file_options_parse(svn_diff_file_options_t *options,
   return SVN_NO_ERROR;
 }
 
+/* Return the line number that corresponds to the token number TOKEN of
+ * FILE, read in block mode after PREFIX_LINES identical prefix lines. */
+static apr_off_t
+token_to_line(const struct file_info *file,
+              apr_off_t prefix_lines,
+              apr_off_t token)
+{
+  apr_off_t blocks = file->block_starts->nelts;
+
+  if (token <= prefix_lines)
+    return token;
+
+  token -= prefix_lines;
+  if (token < blocks)
+    return prefix_lines + APR_ARRAY_IDX(file->block_starts, token, apr_off_t);
+
+  /* The identical suffix. */
+  return prefix_lines + file->block_lines_read + (token - blocks);
+}
+
+/* Convert the hunks of DIFF, which FILE_BATON produced in block mode and
+ * count blocks, to count lines. */
+static void
+convert_blocks_to_lines(svn_diff_t *diff,
+                        const svn_diff__file_baton_t *file_baton)
+{
+  const struct file_info *original = &file_baton->files[0];
+  const struct file_info *modified = &file_baton->files[1];
+  apr_off_t prefix_lines = file_baton->prefix_lines;
+
+  for (; diff; diff = diff->next)
+    {
+      apr_off_t start;
+
+      start = token_to_line(original, prefix_lines, diff->original_start);
+      diff->original_length
+        = token_to_line(original, prefix_lines,
+                        diff->original_start + diff->original_length)
+          - start;
+      diff->original_start = start;
+
+      start = token_to_line(modified, prefix_lines, diff->modified_start);
+      diff->modified_length
+        = token_to_line(modified, prefix_lines,
+                        diff->modified_start + diff->modified_length)
+          - start;
+      diff->modified_start = start;
+    }
+}
+
 svn_error_t *
 svn_diff_file_diff_2(svn_diff_t **diff,
                      const char *original,
@@ -1324,9 +1714,14 @@ svn_diff_file_diff_2(svn_diff_t **diff,
   baton.options = options;
   baton.files[0].path = original;
   baton.files[1].path = modified;
+  baton.block_pool = pool;
   baton.pool = svn_pool_create(pool);
 
-  SVN_ERR(svn_diff_diff_2(diff, &baton, &svn_diff__file_vtable, pool));
+  SVN_ERR(svn_diff__diff_2(diff, &baton, &svn_diff__file_vtable,
+                           options->algorithm, pool));
+
+  if (baton.block_lines)
+    convert_blocks_to_lines(*diff, &baton);
 
   svn_pool_destroy(baton.pool);
   return SVN_NO_ERROR;
@@ -1348,7 +1743,8 @@ svn_diff_file_diff3_2(svn_diff_t **diff,
   baton.files[2].path = latest;
   baton.pool = svn_pool_create(pool);
 
-  SVN_ERR(svn_diff_diff3_2(diff, &baton, &svn_diff__file_vtable, pool));
+  SVN_ERR(svn_diff__diff3(diff, &baton, &svn_diff__file_vtable,
+                          options->algorithm, pool));
 
   svn_pool_destroy(baton.pool);
   return SVN_NO_ERROR;
@@ -1372,7 +1768,8 @@ svn_diff_file_diff4_2(svn_diff_t **diff,
   baton.files[3].path = ancestor;
   baton.pool = svn_pool_create(pool);
 
-  SVN_ERR(svn_diff_diff4_2(diff, &baton, &svn_diff__file_vtable, pool));
+  SVN_ERR(svn_diff__diff4(diff, &baton, &svn_diff__file_vtable,
+                          options->algorithm, pool));
 
   svn_pool_destroy(baton.pool);
   return SVN_NO_ERROR;
@@ -31,6 +31,7 @@
 
 #include "svn_diff.h"
 #include "svn_pools.h"
+#include "svn_sorts.h"
 #include "svn_types.h"
 #include "svn_string.h"
 #include "svn_utf.h"
@@ -293,7 +294,8 @@ svn_diff_mem_string_diff(svn_diff_t **diff,
 
   baton.normalization_options = options;
 
-  return svn_diff_diff_2(diff, &baton, &svn_diff__mem_vtable, pool);
+  return svn_diff__diff_2(diff, &baton, &svn_diff__mem_vtable,
+                          options->algorithm, pool);
 }
 
 svn_error_t *
@@ -313,7 +315,8 @@ svn_diff_mem_string_diff3(svn_diff_t **diff,
 
   baton.normalization_options = options;
 
-  return svn_diff_diff3_2(diff, &baton, &svn_diff__mem_vtable, pool);
+  return svn_diff__diff3(diff, &baton, &svn_diff__mem_vtable,
+                         options->algorithm, pool);
 }
 
 
@@ -336,7 +339,301 @@ svn_diff_mem_string_diff4(svn_diff_t **diff,
 
   baton.normalization_options = options;
 
-  return svn_diff_diff4_2(diff, &baton, &svn_diff__mem_vtable, pool);
+  return svn_diff__diff4(diff, &baton, &svn_diff__mem_vtable,
+                         options->algorithm, pool);
+}
+
+
+/* Number of lines of an identical suffix to still run through the LCS
+   algorithm, like diff_file.c does. */
+#define TOKENS_SUFFIX_LINES_TO_KEEP 50
+
+/* Number of combinations of svn_diff_file_ignore_space_t and the
+   ignore_eol_style flag, i.e. of differently normalized token arrays a
+   svn_diff__tokens_t may hold. */
+#define TOKENS_VARIANTS 6
+
+/* A line of a svn_diff__tokens_t, normalized and hashed. */
+typedef struct normalized_token_t
+{
+  const char *data;
+  apr_size_t len;
+  apr_uint32_t hash;
+} normalized_token_t;
+
+struct svn_diff__tokens_t
+{
+  /* Our copy of the text. */
+  const char *data;
+  apr_size_t len;
+
+  /* Offset of the start of each line in DATA, followed by LEN. */
+  apr_size_t *line_starts;
+
+  /* Number of lines in DATA. */
+  apr_off_t count;
+
+  /* COUNT tokens for each set of normalization options, indexed by
+     tokens_variant(), or NULL if not computed yet. */
+  normalized_token_t *variants[TOKENS_VARIANTS];
+
+  /* Approximate number of bytes allocated for this object. */
+  apr_size_t size;
+
+  /* Where to allocate the variants. */
+  apr_pool_t *pool;
+};
+
+/* Return the index in svn_diff__tokens_t::variants for OPTIONS. */
+static int
+tokens_variant(const svn_diff_file_options_t *options)
+{
+  return (int)options->ignore_space * 2 + (options->ignore_eol_style ? 1 : 0);
+}
+
+/* Baton for diffing two svn_diff__tokens_t. */
+typedef struct tokens_baton_t
+{
+  /* 0 == original; 1 == modified */
+  const normalized_token_t *sources[2];
+  apr_off_t count[2];
+
+  /* The next token to return and the first one not to return any more,
+     i.e. the start of the identical suffix. */
+  apr_off_t next_token[2];
+  apr_off_t end_token[2];
+} tokens_baton_t;
+
+/* Return TRUE if TOKEN1 and TOKEN2 have the same normalized contents. */
+static svn_boolean_t
+tokens_equal(const normalized_token_t *token1,
+             const normalized_token_t *token2)
+{
+  return token1->hash == token2->hash
+      && token1->len == token2->len
+      && memcmp(token1->data, token2->data, token1->len) == 0;
+}
+
+/* Implements svn_diff_fns2_t::datasources_open for the tokens_baton_t
+   BATON, skipping the identical prefix and most of the identical suffix
+   of both sources. */
+static svn_error_t *
+tokens_datasources_open(void *baton,
+                        apr_off_t *prefix_lines,
+                        apr_off_t *suffix_lines,
+                        const svn_diff_datasource_e *datasources,
+                        apr_size_t datasources_len)
+{
+  tokens_baton_t *btn = baton;
+  const normalized_token_t *original = btn->sources[0];
+  const normalized_token_t *modified = btn->sources[1];
+  apr_off_t original_count = btn->count[0];
+  apr_off_t modified_count = btn->count[1];
+  apr_off_t max_common = MIN(original_count, modified_count);
+  apr_off_t prefix = 0;
+  apr_off_t suffix = 0;
+
+  while (prefix < max_common
+         && tokens_equal(&original[prefix], &modified[prefix]))
+    prefix++;
+
+  while (suffix < max_common - prefix
+         && tokens_equal(&original[original_count - suffix - 1],
+                         &modified[modified_count - suffix - 1]))
+    suffix++;
+
+  suffix = (suffix > TOKENS_SUFFIX_LINES_TO_KEEP)
+         ? suffix - TOKENS_SUFFIX_LINES_TO_KEEP
+         : 0;
+
+  btn->next_token[0] = prefix;
+  btn->next_token[1] = prefix;
+  btn->end_token[0] = original_count - suffix;
+  btn->end_token[1] = modified_count - suffix;
+
+  *prefix_lines = prefix;
+  *suffix_lines = suffix;
+
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_diff_fns2_t::datasource_get_next_token for the
+   tokens_baton_t BATON. */
+static svn_error_t *
+tokens_datasource_get_next_token(apr_uint32_t *hash, void **token,
+                                 void *baton,
+                                 svn_diff_datasource_e datasource)
+{
+  tokens_baton_t *btn = baton;
+  int idx = datasource_to_index(datasource);
+
+  if (btn->next_token[idx] < btn->end_token[idx])
+    {
+      const normalized_token_t *tok
+        = &btn->sources[idx][btn->next_token[idx]++];
+
+      *hash = tok->hash;
+      *token = (void *)tok;
+    }
+  else
+    *token = NULL;
+
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_diff_fns2_t::token_compare for normalized_token_t. */
+static svn_error_t *
+tokens_token_compare(void *baton, void *token1, void *token2, int *result)
+{
+  const normalized_token_t *t1 = token1;
+  const normalized_token_t *t2 = token2;
+
+  if (t1->len != t2->len)
+    *result = (t1->len < t2->len) ? -1 : 1;
+  else
+    *result = (t1->len == 0) ? 0 : memcmp(t1->data, t2->data, t1->len);
+
+  return SVN_NO_ERROR;
+}
+
+static const svn_diff_fns2_t svn_diff__tokens_vtable =
+{
+  tokens_datasources_open,
+  datasource_close,
+  tokens_datasource_get_next_token,
+  tokens_token_compare,
+  token_discard,
+  token_discard_all
+};
+
+svn_error_t *
+svn_diff__tokens_create(svn_diff__tokens_t **tokens,
+                        const svn_string_t *text,
+                        apr_pool_t *result_pool)
+{
+  svn_diff__tokens_t *result = apr_pcalloc(result_pool, sizeof(*result));
+  const char *endp = text->data + text->len;
+  const char *curp;
+  apr_off_t count = 0;
+
+  /* Count the lines first, splitting them like fill_source_tokens(). */
+  for (curp = text->data; curp != endp; curp++)
+    {
+      if (*curp == '\r' && curp + 1 != endp && *(curp + 1) == '\n')
+        curp++;
+
+      if (*curp == '\r' || *curp == '\n')
+        count++;
+    }
+  if (text->len && endp[-1] != '\r' && endp[-1] != '\n')
+    count++;
+
+  result->data = apr_pmemdup(result_pool, text->data, text->len + 1);
+  result->len = text->len;
+  result->line_starts = apr_palloc(result_pool,
+                                   (count + 1) * sizeof(*result->line_starts));
+  result->pool = result_pool;
+
+  for (curp = text->data; curp != endp; curp++)
+    {
+      if (*curp == '\r' && curp + 1 != endp && *(curp + 1) == '\n')
+        curp++;
+
+      if (*curp == '\r' || *curp == '\n')
+        result->line_starts[++result->count] = curp + 1 - text->data;
+    }
+  result->line_starts[0] = 0;
+
+  /* If there's anything remaining (ie last line doesn't have a newline) */
+  if (result->count < count)
+    result->count++;
+  result->line_starts[result->count] = text->len;
+
+  result->size = sizeof(*result) + text->len
+               + (count + 1) * sizeof(*result->line_starts);
+
+  *tokens = result;
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_diff__tokens_prepare(svn_diff__tokens_t *tokens,
+                         const svn_diff_file_options_t *options)
+{
+  int variant = tokens_variant(options);
+  normalized_token_t *result;
+  char *buffer = NULL;
+  apr_off_t i;
+
+  if (tokens->variants[variant])
+    return SVN_NO_ERROR;
+
+  result = apr_palloc(tokens->pool, tokens->count * sizeof(*result) + 1);
+  tokens->size += tokens->count * sizeof(*result);
+
+  /* Unnormalized lines point into our copy of the text; the normalized
+     ones never get longer than the original ones. */
+  if (variant != 0)
+    {
+      buffer = apr_palloc(tokens->pool, tokens->len + 1);
+      tokens->size += tokens->len;
+    }
+
+  for (i = 0; i < tokens->count; i++)
+    {
+      normalized_token_t *token = &result[i];
+      const char *line = tokens->data + tokens->line_starts[i];
+      apr_off_t len = tokens->line_starts[i + 1] - tokens->line_starts[i];
+
+      if (buffer)
+        {
+          svn_diff__normalize_state_t state
+            = svn_diff__normalize_state_normal;
+          char *tgt = buffer;
+
+          svn_diff__normalize_buffer(&tgt, &len, &state, line, options);
+          if (tgt != buffer)
+            memcpy(buffer, tgt, len);
+
+          line = buffer;
+          buffer += len;
+        }
+
+      token->data = line;
+      token->len = len;
+      token->hash = svn__adler32(0, line, len);
+    }
+
+  tokens->variants[variant] = result;
+  return SVN_NO_ERROR;
+}
+
+apr_size_t
+svn_diff__tokens_size(const svn_diff__tokens_t *tokens)
+{
+  return tokens->size;
+}
+
+svn_error_t *
+svn_diff__tokens_diff(svn_diff_t **diff,
+                      svn_diff__tokens_t *original,
+                      svn_diff__tokens_t *modified,
+                      const svn_diff_file_options_t *options,
+                      apr_pool_t *pool)
+{
+  int variant = tokens_variant(options);
+  tokens_baton_t baton;
+
+  SVN_ERR(svn_diff__tokens_prepare(original, options));
+  SVN_ERR(svn_diff__tokens_prepare(modified, options));
+
+  baton.sources[0] = original->variants[variant];
+  baton.sources[1] = modified->variants[variant];
+  baton.count[0] = original->count;
+  baton.count[1] = modified->count;
+
+  return svn_diff__diff_2(diff, &baton, &svn_diff__tokens_vtable,
+                          options->algorithm, pool);
 }
 
 
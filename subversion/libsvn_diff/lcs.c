@@ -228,65 +228,53 @@ prepend_lcs(svn_diff__lcs_t *lcs, apr_off_t lines,
 }
 
 
-svn_diff__lcs_t *
-svn_diff__lcs(svn_diff__position_t *position_list1, /* pointer to tail (ring) */
-              svn_diff__position_t *position_list2, /* pointer to tail (ring) */
-              svn_diff__token_index_t *token_counts_list1, /* array of counts */
-              svn_diff__token_index_t *token_counts_list2, /* array of counts */
-              svn_diff__token_index_t num_tokens,
-              apr_off_t prefix_lines,
-              apr_off_t suffix_lines,
-              apr_pool_t *pool)
+/* Find the longest common subsequence of the non-empty rings
+ * POSITION_LIST1 and POSITION_LIST2 (pointers to their tails), with
+ * TOKEN_COUNTS_LIST1 and TOKEN_COUNTS_LIST2 the counts of the tokens in
+ * each ring.  Return the matching regions as a chain in reverse order,
+ * without the EOF element.  Allocations will be made from POOL.
+ */
+static svn_diff__lcs_t *
+lcs_myers(svn_diff__position_t *position_list1,
+          svn_diff__position_t *position_list2,
+          svn_diff__token_index_t *token_counts_list1,
+          svn_diff__token_index_t *token_counts_list2,
+          apr_pool_t *pool)
 {
   apr_off_t length[2];
   svn_diff__token_index_t *token_counts[2];
   svn_diff__token_index_t unique_count[2];
-  svn_diff__token_index_t token_index;
+  svn_diff__position_t *position;
   svn_diff__snake_t *fp;
   apr_off_t d;
   apr_off_t k;
   apr_off_t p = 0;
-  svn_diff__lcs_t *lcs, *lcs_freelist = NULL;
+  svn_diff__lcs_t *lcs_freelist = NULL;
 
   svn_diff__position_t sentinel_position[2];
 
-  /* Since EOF is always a sync point we tack on an EOF link
-   * with sentinel positions
+  /* Count the tokens unique to one of the rings.  Walk the rings rather
+   * than the count arrays, which cover all tokens of the datasources even
+   * when we are only looking at a small part of them.
    */
-  lcs = apr_palloc(pool, sizeof(*lcs));
-  lcs->position[0] = apr_pcalloc(pool, sizeof(*lcs->position[0]));
-  lcs->position[0]->offset = position_list1
-                             ? position_list1->offset + suffix_lines + 1
-                             : prefix_lines + suffix_lines + 1;
-  lcs->position[1] = apr_pcalloc(pool, sizeof(*lcs->position[1]));
-  lcs->position[1]->offset = position_list2
-                             ? position_list2->offset + suffix_lines + 1
-                             : prefix_lines + suffix_lines + 1;
-  lcs->length = 0;
-  lcs->refcount = 1;
-  lcs->next = NULL;
-
-  if (position_list1 == NULL || position_list2 == NULL)
+  unique_count[1] = unique_count[0] = 0;
+  position = position_list1;
+  do
     {
-      if (suffix_lines)
-        lcs = prepend_lcs(lcs, suffix_lines,
-                          lcs->position[0]->offset - suffix_lines,
-                          lcs->position[1]->offset - suffix_lines,
-                          pool);
-      if (prefix_lines)
-        lcs = prepend_lcs(lcs, prefix_lines, 1, 1, pool);
-
-      return lcs;
+      position = position->next;
+      if (token_counts_list2[position->token_index] == 0)
+        unique_count[0]++;
     }
+  while (position != position_list1);
 
-  unique_count[1] = unique_count[0] = 0;
-  for (token_index = 0; token_index < num_tokens; token_index++)
+  position = position_list2;
+  do
     {
-      if (token_counts_list1[token_index] == 0)
-        unique_count[1] += token_counts_list2[token_index];
-      if (token_counts_list2[token_index] == 0)
-        unique_count[0] += token_counts_list1[token_index];
+      position = position->next;
+      if (token_counts_list1[position->token_index] == 0)
+        unique_count[1]++;
     }
+  while (position != position_list2);
 
   /* Calculate lengths M and N of the sequences to be compared. Do not
    * count tokens unique to one file, as those are ignored in __snake.
@@ -355,19 +343,73 @@ svn_diff__lcs(svn_diff__position_t *position_list1, /* pointer to tail (ring) */
     }
   while (fp[0].position[1] != &sentinel_position[1]);
 
+  position_list1->next = sentinel_position[0].next;
+  position_list2->next = sentinel_position[1].next;
+
+  return fp[0].lcs;
+}
+
+
+svn_diff__lcs_t *
+svn_diff__lcs(svn_diff__position_t *position_list1, /* pointer to tail (ring) */
+              svn_diff__position_t *position_list2, /* pointer to tail (ring) */
+              svn_diff__token_index_t *token_counts_list1, /* array of counts */
+              svn_diff__token_index_t *token_counts_list2, /* array of counts */
+              svn_diff__token_index_t num_tokens,
+              apr_off_t prefix_lines,
+              apr_off_t suffix_lines,
+              svn_diff_file_algorithm_t algorithm,
+              apr_pool_t *pool)
+{
+  svn_diff__lcs_t *lcs;
+  svn_diff__lcs_t *matches;
+
+  /* Since EOF is always a sync point we tack on an EOF link
+   * with sentinel positions
+   */
+  lcs = apr_palloc(pool, sizeof(*lcs));
+  lcs->position[0] = apr_pcalloc(pool, sizeof(*lcs->position[0]));
+  lcs->position[0]->offset = position_list1
+                             ? position_list1->offset + suffix_lines + 1
+                             : prefix_lines + suffix_lines + 1;
+  lcs->position[1] = apr_pcalloc(pool, sizeof(*lcs->position[1]));
+  lcs->position[1]->offset = position_list2
+                             ? position_list2->offset + suffix_lines + 1
+                             : prefix_lines + suffix_lines + 1;
+  lcs->length = 0;
+  lcs->refcount = 1;
+  lcs->next = NULL;
+
+  if (position_list1 == NULL || position_list2 == NULL)
+    {
+      if (suffix_lines)
+        lcs = prepend_lcs(lcs, suffix_lines,
+                          lcs->position[0]->offset - suffix_lines,
+                          lcs->position[1]->offset - suffix_lines,
+                          pool);
+      if (prefix_lines)
+        lcs = prepend_lcs(lcs, prefix_lines, 1, 1, pool);
+
+      return lcs;
+    }
+
+  if (algorithm == svn_diff_file_algorithm_patience)
+    matches = svn_diff__lcs_patience(position_list1, position_list2,
+                                     num_tokens, pool);
+  else
+    matches = lcs_myers(position_list1, position_list2,
+                        token_counts_list1, token_counts_list2, pool);
+
   if (suffix_lines)
-    lcs->next = prepend_lcs(fp[0].lcs, suffix_lines,
+    lcs->next = prepend_lcs(matches, suffix_lines,
                             lcs->position[0]->offset - suffix_lines,
                             lcs->position[1]->offset - suffix_lines,
                             pool);
   else
-    lcs->next = fp[0].lcs;
+    lcs->next = matches;
 
   lcs = svn_diff__lcs_reverse(lcs);
 
-  position_list1->next = sentinel_position[0].next;
-  position_list2->next = sentinel_position[1].next;
-
   if (prefix_lines)
     return prepend_lcs(lcs, prefix_lines, 1, 1, pool);
   else
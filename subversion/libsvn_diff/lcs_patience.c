@@ -0,0 +1,387 @@
+/*
+ * lcs_patience.c :  finding common lines with the patience algorithm
+ *
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ */
+
+
+#include <apr.h>
+#include <apr_pools.h>
+#include <apr_general.h>
+#include <apr_tables.h>
+
+#include "svn_pools.h"
+
+#include "diff.h"
+
+
+/*
+ * Patience diff, as described by Bram Cohen:
+ *
+ *   1. Match the common head and tail of both sequences.
+ *   2. Of the tokens that occur exactly once in each of the remaining
+ *      sequences, take the longest subsequence that appears in the same
+ *      order in both.  These tokens are the anchors.
+ *   3. Repeat the procedure for the regions between consecutive anchors.
+ *
+ * Regions without any anchors are handed to the regular LCS algorithm,
+ * which is cheap there because such regions tend to be short.  Splitting
+ * at anchors keeps the work close to linear on large inputs whose
+ * differences would make the LCS algorithm explore many paths, and tends
+ * to produce diffs that keep moved blocks together.
+ *
+ * The regions are processed with an explicit stack rather than
+ * recursion, so deeply nested splits cannot overflow the C stack.
+ */
+
+/* A region of both sequences that still needs to be compared, or a run of
+ * matching tokens to report, on the work stack. */
+typedef struct patience_item_t
+{
+  /* Index of the first token of each sequence. */
+  apr_off_t start[2];
+
+  /* Index just past the last token of each sequence. */
+  apr_off_t end[2];
+
+  /* Whether this is a known match of END[0] - START[0] tokens rather than
+   * a region to compare. */
+  svn_boolean_t is_match;
+} patience_item_t;
+
+typedef struct patience_baton_t
+{
+  /* The positions of both sequences, indexed by their distance from the
+   * start of the ring. */
+  svn_diff__position_t **positions[2];
+
+  /* For every token, its number of occurrences in the current region of
+   * each sequence.  All zeros outside of process_region(). */
+  svn_diff__token_index_t *counts[2];
+
+  /* For every token that occurs in the current region of the second
+   * sequence, the index of its last occurrence there. */
+  apr_off_t *last_index;
+
+  /* Scratch space for the candidate anchors of a region: their indices in
+   * both sequences, the previous anchor on the best subsequence ending at
+   * each of them, and the last anchor of each pile. */
+  apr_off_t *anchor_index[2];
+  apr_off_t *anchor_prev;
+  apr_off_t *piles;
+
+  svn_diff__token_index_t num_tokens;
+
+  /* Regions and matches still to be processed. */
+  apr_array_header_t *stack;
+
+  /* The matches found so far, in reverse order. */
+  svn_diff__lcs_t *lcs;
+
+  apr_pool_t *pool;
+} patience_baton_t;
+
+
+/* Return the token index at INDEX of sequence IDX. */
+#define TOKEN(pb, idx, index) ((pb)->positions[idx][index]->token_index)
+
+/* Record that LENGTH tokens match, starting at INDEX0 and INDEX1.  Matches
+ * must be added in order; adjacent matches are merged. */
+static void
+add_match(patience_baton_t *pb,
+          apr_off_t index0,
+          apr_off_t index1,
+          apr_off_t length)
+{
+  svn_diff__position_t *position[2];
+  svn_diff__lcs_t *lcs = pb->lcs;
+
+  if (length == 0)
+    return;
+
+  position[0] = pb->positions[0][index0];
+  position[1] = pb->positions[1][index1];
+
+  if (lcs
+      && lcs->position[0]->offset + lcs->length == position[0]->offset
+      && lcs->position[1]->offset + lcs->length == position[1]->offset)
+    {
+      lcs->length += length;
+      return;
+    }
+
+  lcs = apr_palloc(pb->pool, sizeof(*lcs));
+  lcs->position[0] = position[0];
+  lcs->position[1] = position[1];
+  lcs->length = length;
+  lcs->refcount = 1;
+  lcs->next = pb->lcs;
+  pb->lcs = lcs;
+}
+
+/* Push a region or match from START0, START1 to END0, END1 onto the work
+ * stack.  Empty regions are dropped, as they cannot contain matches. */
+static void
+push_item(patience_baton_t *pb,
+          apr_off_t start0,
+          apr_off_t end0,
+          apr_off_t start1,
+          apr_off_t end1,
+          svn_boolean_t is_match)
+{
+  patience_item_t *item;
+
+  if (start0 == end0 || start1 == end1)
+    return;
+
+  item = apr_array_push(pb->stack);
+  item->start[0] = start0;
+  item->start[1] = start1;
+  item->end[0] = end0;
+  item->end[1] = end1;
+  item->is_match = is_match;
+}
+
+/* Compare the region ITEM, whose tokens have been counted in PB->counts,
+ * with the regular LCS algorithm and record the matches. */
+static void
+compare_region_lcs(patience_baton_t *pb,
+                   const patience_item_t *item)
+{
+  svn_diff__position_t *tail[2];
+  svn_diff__position_t *next[2];
+  apr_off_t first_offset[2];
+  svn_diff__lcs_t *lcs;
+  apr_pool_t *subpool = svn_pool_create(pb->pool);
+  int idx;
+
+  /* Temporarily turn the region into a ring of its own. */
+  for (idx = 0; idx < 2; idx++)
+    {
+      tail[idx] = pb->positions[idx][item->end[idx] - 1];
+      next[idx] = tail[idx]->next;
+      tail[idx]->next = pb->positions[idx][item->start[idx]];
+      first_offset[idx] = pb->positions[idx][0]->offset;
+    }
+
+  lcs = svn_diff__lcs(tail[0], tail[1], pb->counts[0], pb->counts[1],
+                      pb->num_tokens, 0, 0, svn_diff_file_algorithm_lcs,
+                      subpool);
+
+  for (; lcs; lcs = lcs->next)
+    add_match(pb, lcs->position[0]->offset - first_offset[0],
+              lcs->position[1]->offset - first_offset[1], lcs->length);
+
+  for (idx = 0; idx < 2; idx++)
+    tail[idx]->next = next[idx];
+
+  svn_pool_destroy(subpool);
+}
+
+/* Process the region ITEM: record its common head, split it at its
+ * anchors and push the parts onto the work stack, or compare it with the
+ * regular LCS algorithm if it has no anchors. */
+static void
+process_region(patience_baton_t *pb,
+               const patience_item_t *region)
+{
+  patience_item_t item = *region;
+  apr_off_t anchor_count = 0;
+  apr_off_t pile_count = 0;
+  apr_off_t length;
+  apr_off_t i;
+
+  /* Match the common head ... */
+  for (length = 0;
+       item.start[0] + length < item.end[0]
+       && item.start[1] + length < item.end[1]
+       && TOKEN(pb, 0, item.start[0] + length)
+          == TOKEN(pb, 1, item.start[1] + length);
+       length++)
+    ;
+
+  add_match(pb, item.start[0], item.start[1], length);
+  item.start[0] += length;
+  item.start[1] += length;
+
+  /* ... and the common tail, which is reported after the rest. */
+  for (length = 0;
+       item.end[0] - length > item.start[0]
+       && item.end[1] - length > item.start[1]
+       && TOKEN(pb, 0, item.end[0] - length - 1)
+          == TOKEN(pb, 1, item.end[1] - length - 1);
+       length++)
+    ;
+
+  push_item(pb, item.end[0] - length, item.end[0],
+            item.end[1] - length, item.end[1], TRUE);
+  item.end[0] -= length;
+  item.end[1] -= length;
+
+  if (item.start[0] == item.end[0] || item.start[1] == item.end[1])
+    return;
+
+  for (i = item.start[0]; i < item.end[0]; i++)
+    pb->counts[0][TOKEN(pb, 0, i)]++;
+
+  for (i = item.start[1]; i < item.end[1]; i++)
+    {
+      pb->counts[1][TOKEN(pb, 1, i)]++;
+      pb->last_index[TOKEN(pb, 1, i)] = i;
+    }
+
+  /* Collect the tokens unique to both sides in the order of the first
+   * sequence, and find the longest run of them that is in order in the
+   * second sequence as well by patience sorting: put every anchor on the
+   * leftmost pile whose top is further along in the second sequence. */
+  for (i = item.start[0]; i < item.end[0]; i++)
+    {
+      svn_diff__token_index_t token_index = TOKEN(pb, 0, i);
+      apr_off_t index1;
+      apr_off_t low, high;
+
+      if (pb->counts[0][token_index] != 1 || pb->counts[1][token_index] != 1)
+        continue;
+
+      index1 = pb->last_index[token_index];
+
+      low = 0;
+      high = pile_count;
+      while (low < high)
+        {
+          apr_off_t middle = low + (high - low) / 2;
+
+          if (pb->anchor_index[1][pb->piles[middle]] < index1)
+            low = middle + 1;
+          else
+            high = middle;
+        }
+
+      pb->anchor_index[0][anchor_count] = i;
+      pb->anchor_index[1][anchor_count] = index1;
+      pb->anchor_prev[anchor_count] = low > 0 ? pb->piles[low - 1] : -1;
+      pb->piles[low] = anchor_count;
+      if (low == pile_count)
+        pile_count++;
+      anchor_count++;
+    }
+
+  if (pile_count == 0)
+    compare_region_lcs(pb, &item);
+
+  for (i = item.start[0]; i < item.end[0]; i++)
+    pb->counts[0][TOKEN(pb, 0, i)] = 0;
+
+  for (i = item.start[1]; i < item.end[1]; i++)
+    pb->counts[1][TOKEN(pb, 1, i)] = 0;
+
+  if (pile_count > 0)
+    {
+      apr_off_t end[2];
+      apr_off_t anchor;
+
+      /* Walk the anchors back to front, pushing the region after each
+       * anchor and then the anchor itself, so that they are popped in
+       * order. */
+      end[0] = item.end[0];
+      end[1] = item.end[1];
+      for (anchor = pb->piles[pile_count - 1];
+           anchor >= 0;
+           anchor = pb->anchor_prev[anchor])
+        {
+          apr_off_t index0 = pb->anchor_index[0][anchor];
+          apr_off_t index1 = pb->anchor_index[1][anchor];
+
+          push_item(pb, index0 + 1, end[0], index1 + 1, end[1], FALSE);
+          push_item(pb, index0, index0 + 1, index1, index1 + 1, TRUE);
+          end[0] = index0;
+          end[1] = index1;
+        }
+
+      push_item(pb, item.start[0], end[0], item.start[1], end[1], FALSE);
+    }
+}
+
+svn_diff__lcs_t *
+svn_diff__lcs_patience(svn_diff__position_t *position_list1,
+                       svn_diff__position_t *position_list2,
+                       svn_diff__token_index_t num_tokens,
+                       apr_pool_t *pool)
+{
+  patience_baton_t pb;
+  svn_diff__position_t *tail[2];
+  apr_off_t length[2];
+  apr_pool_t *scratch_pool = svn_pool_create(pool);
+  int idx;
+
+  tail[0] = position_list1;
+  tail[1] = position_list2;
+
+  for (idx = 0; idx < 2; idx++)
+    {
+      svn_diff__position_t *position = tail[idx];
+      apr_off_t i;
+
+      length[idx] = tail[idx]->offset - tail[idx]->next->offset + 1;
+      pb.positions[idx] = apr_palloc(scratch_pool,
+                                     sizeof(*pb.positions[idx])
+                                     * (apr_size_t)length[idx]);
+      for (i = 0; i < length[idx]; i++)
+        {
+          position = position->next;
+          pb.positions[idx][i] = position;
+        }
+
+      pb.counts[idx] = apr_pcalloc(scratch_pool,
+                                   sizeof(*pb.counts[idx])
+                                   * (apr_size_t)num_tokens);
+      pb.anchor_index[idx] = apr_palloc(scratch_pool,
+                                        sizeof(*pb.anchor_index[idx])
+                                        * (apr_size_t)length[0]);
+    }
+
+  pb.last_index = apr_palloc(scratch_pool,
+                             sizeof(*pb.last_index) * (apr_size_t)num_tokens);
+  pb.anchor_prev = apr_palloc(scratch_pool,
+                              sizeof(*pb.anchor_prev) * (apr_size_t)length[0]);
+  pb.piles = apr_palloc(scratch_pool,
+                        sizeof(*pb.piles) * (apr_size_t)length[0]);
+  pb.num_tokens = num_tokens;
+  pb.stack = apr_array_make(scratch_pool, 64, sizeof(patience_item_t));
+  pb.lcs = NULL;
+  pb.pool = pool;
+
+  push_item(&pb, 0, length[0], 0, length[1], FALSE);
+
+  while (pb.stack->nelts > 0)
+    {
+      patience_item_t item = *(patience_item_t *)apr_array_pop(pb.stack);
+
+      if (item.is_match)
+        add_match(&pb, item.start[0], item.start[1],
+                  item.end[0] - item.start[0]);
+      else
+        process_region(&pb, &item);
+    }
+
+  svn_pool_destroy(scratch_pool);
+
+  return pb.lcs;
+}
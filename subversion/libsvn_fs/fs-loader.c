@@ -521,6 +521,15 @@ svn_fs_set_warning_func(svn_fs_t *fs, svn_fs_warning_callback_t warning,
   fs->warning_baton = warning_baton;
 }
 
+void
+svn_fs__get_warning_func(svn_fs_warning_callback_t *warning,
+                         void **warning_baton,
+                         svn_fs_t *fs)
+{
+  *warning = fs->warning;
+  *warning_baton = fs->warning_baton;
+}
+
 svn_error_t *
 svn_fs_create2(svn_fs_t **fs_p,
                const char *path,
@@ -645,8 +654,9 @@ svn_fs_delete_fs(const char *path, apr_pool_t *pool)
 }
 
 svn_error_t *
-svn_fs_hotcopy3(const char *src_path, const char *dst_path,
+svn_fs_hotcopy4(const char *src_path, const char *dst_path,
                 svn_boolean_t clean, svn_boolean_t incremental,
+                int jobs,
                 svn_fs_hotcopy_notify_t notify_func,
                 void *notify_baton,
                 svn_cancel_func_t cancel_func,
@@ -703,29 +713,30 @@ svn_fs_hotcopy3(const char *src_path, const char *dst_path,
     }
 
   SVN_ERR(vtable->hotcopy(src_fs, dst_fs, src_path, dst_path, clean,
-                          incremental, notify_func, notify_baton,
+                          incremental, jobs, notify_func, notify_baton,
                           cancel_func, cancel_baton, common_pool_lock,
                           scratch_pool, common_pool));
   return svn_error_trace(write_fs_type(dst_path, src_fs_type, scratch_pool));
 }
 
 svn_error_t *
-svn_fs_pack(const char *path,
-            svn_fs_pack_notify_t notify_func,
-            void *notify_baton,
-            svn_cancel_func_t cancel_func,
-            void *cancel_baton,
-            apr_pool_t *pool)
+svn_fs_pack2(const char *path,
+             int jobs,
+             svn_fs_pack_notify_t notify_func,
+             void *notify_baton,
+             svn_cancel_func_t cancel_func,
+             void *cancel_baton,
+             apr_pool_t *scratch_pool)
 {
   fs_library_vtable_t *vtable;
   svn_fs_t *fs;
 
-  SVN_ERR(fs_library_vtable(&vtable, path, pool));
-  fs = fs_new(NULL, pool);
+  SVN_ERR(fs_library_vtable(&vtable, path, scratch_pool));
+  fs = fs_new(NULL, scratch_pool);
 
-  SVN_ERR(vtable->pack_fs(fs, path, notify_func, notify_baton,
+  SVN_ERR(vtable->pack_fs(fs, path, jobs, notify_func, notify_baton,
                           cancel_func, cancel_baton, common_pool_lock,
-                          pool, common_pool));
+                          scratch_pool, common_pool));
   return SVN_NO_ERROR;
 }
 
@@ -816,8 +827,8 @@ svn_error_t *
 svn_fs_hotcopy_berkeley(const char *src_path, const char *dest_path,
                         svn_boolean_t clean_logs, apr_pool_t *pool)
 {
-  return svn_error_trace(svn_fs_hotcopy3(src_path, dest_path, clean_logs,
-                                         FALSE, NULL, NULL, NULL, NULL,
+  return svn_error_trace(svn_fs_hotcopy4(src_path, dest_path, clean_logs,
+                                         FALSE, 1, NULL, NULL, NULL, NULL,
                                          pool));
 }
 
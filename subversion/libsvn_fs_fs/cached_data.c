@@ -3658,6 +3658,110 @@ block_read_noderev(node_revision_t **noderev_p,
   return SVN_NO_ERROR;
 }
 
+/* Ask the OS to prefetch the FS' configured number of blocks following
+ * OFFSET in REV_FILE, unless it has been asked to do so recently.  Items
+ * are stored in tree walk order, so these will most likely be needed next.
+ * Revision contents end where the indexes start, so stop there.
+ */
+static svn_error_t *
+block_readahead(svn_fs_t *fs,
+                svn_fs_fs__revision_file_t *rev_file,
+                apr_off_t offset)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+  apr_off_t window = ffd->readahead_blocks * ffd->block_size;
+  apr_off_t start, end;
+
+  if (window == 0)
+    return SVN_NO_ERROR;
+
+  /* Only issue a new request once we got past the middle of the last one
+   * or left it altogether. */
+  if (   offset >= rev_file->readahead_start
+      && offset + window / 2 < rev_file->readahead_end)
+    return SVN_NO_ERROR;
+
+  SVN_ERR(svn_fs_fs__auto_read_footer(rev_file));
+  end = MIN(offset + window, rev_file->l2p_offset);
+
+  /* Don't request what is still covered by the last request. */
+  start = (   offset >= rev_file->readahead_start
+           && offset < rev_file->readahead_end)
+        ? rev_file->readahead_end
+        : offset;
+
+  if (start < end)
+    svn_io__file_advise_willneed(rev_file->file, start, end - start);
+
+  rev_file->readahead_start = offset;
+  rev_file->readahead_end = end;
+
+  return SVN_NO_ERROR;
+}
+
+/* The contents of a directory or file are usually read right after its
+ * node revision NODEREV.  If they live in REV_FILE as well, look up their
+ * extent in the P2L index and ask the OS to prefetch them, unless they
+ * are within the block at BLOCK_START that has just been read or the
+ * last readahead window.  At most the FS' readahead window size will be
+ * requested per representation.  Use SCRATCH_POOL for temporaries.
+ */
+static svn_error_t *
+rep_readahead(svn_fs_t *fs,
+              svn_fs_fs__revision_file_t *rev_file,
+              const node_revision_t *noderev,
+              apr_off_t block_start,
+              apr_pool_t *scratch_pool)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+  apr_off_t window = ffd->readahead_blocks * ffd->block_size;
+  apr_off_t block_end = block_start + ffd->block_size;
+  representation_t *reps[2];
+  apr_size_t i;
+
+  if (window == 0)
+    return SVN_NO_ERROR;
+
+  reps[0] = noderev->data_rep;
+  reps[1] = noderev->prop_rep;
+
+  for (i = 0; i < sizeof(reps) / sizeof(reps[0]); ++i)
+    {
+      representation_t *rep = reps[i];
+      svn_fs_fs__p2l_entry_t *entry;
+      apr_off_t offset, end;
+
+      /* Skip reps that are not in REV_FILE. */
+      if (!rep || svn_fs_fs__id_txn_used(&rep->txn_id))
+        continue;
+
+      if (rev_file->is_packed
+          ? (   !svn_fs_fs__is_packed_rev(fs, rep->revision)
+             || svn_fs_fs__packed_base_rev(fs, rep->revision)
+                  != rev_file->start_revision)
+          : rep->revision != rev_file->start_revision)
+        continue;
+
+      SVN_ERR(svn_fs_fs__item_offset(&offset, fs, rev_file, rep->revision,
+                                     NULL, rep->item_index, scratch_pool));
+      SVN_ERR(svn_fs_fs__p2l_entry_lookup(&entry, fs, rev_file,
+                                          rep->revision, offset,
+                                          scratch_pool, scratch_pool));
+      if (!entry)
+        continue;
+
+      end = entry->offset + MIN(entry->size, window);
+      if (   (offset >= block_start && end <= block_end)
+          || (   offset >= rev_file->readahead_start
+              && end <= rev_file->readahead_end))
+        continue;
+
+      svn_io__file_advise_willneed(rev_file->file, offset, end - offset);
+    }
+
+  return SVN_NO_ERROR;
+}
+
 /* Read the whole (e.g. 64kB) block containing ITEM_INDEX of REVISION in FS
  * and put all data into cache.  If necessary and depending on heuristics,
  * neighboring blocks may also get read.  The data is being read from
@@ -3682,6 +3786,7 @@ block_read(void **result,
   apr_array_header_t *entries;
   int run_count = 0;
   int i;
+  svn_boolean_t is_noderev = FALSE;
   apr_pool_t *iterpool;
 
   /* Block read is an optional feature. If the caller does not want anything
@@ -3784,7 +3889,10 @@ block_read(void **result,
                 }
 
               if (is_result)
-                *result = item;
+                {
+                  *result = item;
+                  is_noderev = entry->type == SVN_FS_FS__ITEM_TYPE_NODEREV;
+                }
 
               /* if we crossed a block boundary, read the remainder of
                * the last block as well */
@@ -3798,6 +3906,12 @@ block_read(void **result,
   while(run_count++ == 1); /* can only be true once and only if a block
                             * boundary got crossed */
 
+  /* Get the data that we will probably need next on its way. */
+  SVN_ERR(block_readahead(fs, revision_file, block_start + ffd->block_size));
+  if (is_noderev)
+    SVN_ERR(rep_readahead(fs, revision_file, *result, block_start,
+                          scratch_pool));
+
   /* if the caller requested a result, we must have provided one by now */
   assert(!result || *result);
   svn_pool_destroy(iterpool);
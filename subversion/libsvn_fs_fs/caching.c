@@ -27,10 +27,14 @@
 #include "tree.h"
 #include "index.h"
 #include "temp_serializer.h"
+#include "util.h"
 #include "../libsvn_fs/fs-loader.h"
 
 #include "svn_config.h"
 #include "svn_cache_config.h"
+#include "svn_dirent_uri.h"
+#include "svn_sorts.h"
+#include "svn_version.h"
 
 #include "svn_private_config.h"
 #include "svn_hash.h"
@@ -346,6 +350,164 @@ create_cache(svn_cache__t **cache_p,
   return SVN_NO_ERROR;
 }
 
+/* If PERSISTENT_STORE is not NULL, wrap *CACHE_P such that PERSISTENT_STORE
+ * becomes its second level, using ID to identify the data within the store.
+ * SERIALIZER, DESERIALIZER and KLEN must match those used for *CACHE_P.
+ * NO_HANDLER and FS are as for create_cache.
+ *
+ * Only caches of immutable data may be made persistent.
+ *
+ * The cache is allocated in RESULT_POOL.
+ */
+static svn_error_t *
+add_persistent_layer(svn_cache__t **cache_p,
+                     svn_cache__persistent_store_t *persistent_store,
+                     const char *id,
+                     svn_cache__serialize_func_t serializer,
+                     svn_cache__deserialize_func_t deserializer,
+                     apr_ssize_t klen,
+                     svn_fs_t *fs,
+                     svn_boolean_t no_handler,
+                     apr_pool_t *result_pool)
+{
+  if (*cache_p == NULL || persistent_store == NULL)
+    return SVN_NO_ERROR;
+
+  SVN_ERR(svn_cache__create_persistent(cache_p, *cache_p, persistent_store,
+                                       id, serializer, deserializer, klen,
+                                       result_pool));
+
+  /* Problems with the persistent storage are never fatal unless the
+   * user asked us to fail. */
+  SVN_ERR(init_callbacks(*cache_p, fs,
+                         no_handler ? NULL
+                                    : warn_and_continue_on_cache_errors,
+                         result_pool));
+
+  return SVN_NO_ERROR;
+}
+
+/* Set *STAMP to a string that identifies the state of FS up to revision
+ * REV, or to NULL if REV does not exist.  It consists of REV, followed by
+ * the size and modification time of the file containing REV.  These will
+ * change when the repository gets replaced, e.g. by restoring a backup,
+ * but also when REV gets packed.  Allocate *STAMP in RESULT_POOL and use
+ * SCRATCH_POOL for temporary allocations.
+ */
+static svn_error_t *
+make_stamp(const char **stamp,
+           svn_fs_t *fs,
+           svn_revnum_t rev,
+           apr_pool_t *result_pool,
+           apr_pool_t *scratch_pool)
+{
+  const char *path = svn_fs_fs__path_rev_absolute(fs, rev, scratch_pool);
+  apr_finfo_t finfo;
+  svn_error_t *err = svn_io_stat(&finfo, path,
+                                 APR_FINFO_SIZE | APR_FINFO_MTIME,
+                                 scratch_pool);
+
+  if (err && APR_STATUS_IS_ENOENT(err->apr_err))
+    {
+      svn_error_clear(err);
+      *stamp = NULL;
+      return SVN_NO_ERROR;
+    }
+
+  SVN_ERR(err);
+  *stamp = apr_psprintf(result_pool,
+                        "%ld %" APR_OFF_T_FMT " %" APR_TIME_T_FMT,
+                        rev, finfo.size, finfo.mtime);
+
+  return SVN_NO_ERROR;
+}
+
+/* Make sure that the contents of STORE has been written for the same
+ * history of FS that we see now, resetting STORE otherwise.  Update the
+ * stamp of STORE to the current youngest revision of FS.  Use
+ * SCRATCH_POOL for temporary allocations.
+ */
+static svn_error_t *
+check_stamp(svn_cache__persistent_store_t *store,
+            svn_fs_t *fs,
+            apr_pool_t *scratch_pool)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+  svn_revnum_t youngest;
+  const char *stamp;
+  const char *expected = NULL;
+
+  SVN_ERR(svn_fs_fs__youngest_rev(&youngest, fs, scratch_pool));
+  SVN_ERR(svn_cache__persistent_store_get_stamp(&stamp, store,
+                                                scratch_pool));
+
+  /* The stamp must match the revision it has been taken for.  That one
+   * will not exist if the repository has been replaced by an older one. */
+  if (stamp)
+    {
+      svn_revnum_t rev = SVN_STR_TO_REV(stamp);
+      if (SVN_IS_VALID_REVNUM(rev) && rev <= youngest)
+        SVN_ERR(make_stamp(&expected, fs, rev, scratch_pool, scratch_pool));
+    }
+
+  if (!expected || strcmp(stamp, expected))
+    SVN_ERR(svn_cache__persistent_store_reset(store, scratch_pool));
+
+  SVN_ERR(make_stamp(&stamp, fs, youngest, scratch_pool, scratch_pool));
+  if (stamp)
+    SVN_ERR(svn_cache__persistent_store_set_stamp(store, stamp,
+                                                  scratch_pool));
+
+  ffd->persistent_stamp_rev = youngest;
+
+  return SVN_NO_ERROR;
+}
+
+/* Open the persistent cache store for FS in *STORE_P if it has been
+ * enabled in the FS configuration.  Set it to NULL otherwise.  Drop its
+ * contents if they don't match the repository.  Unless NO_HANDLER is set,
+ * report failures to do so as warnings instead of returning them.  Use
+ * SCRATCH_POOL for temporary allocations.
+ */
+static svn_error_t *
+open_persistent_store(svn_cache__persistent_store_t **store_p,
+                      svn_fs_t *fs,
+                      svn_boolean_t no_handler,
+                      apr_pool_t *scratch_pool)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+  const char *version;
+  svn_error_t *err;
+
+  *store_p = NULL;
+  if (ffd->persistent_cache_size <= 0)
+    return SVN_NO_ERROR;
+
+  /* Only use data written for the same repository instance and format by
+   * the same implementation. */
+  version = apr_psprintf(scratch_pool, "%s %s %d %s",
+                         fs->uuid, ffd->instance_id, ffd->format,
+                         SVN_VER_NUMBER);
+
+  err = svn_cache__persistent_store_open(
+          store_p,
+          svn_dirent_join(fs->path, PATH_PERSISTENT_CACHE, scratch_pool),
+          version,
+          (apr_size_t)MIN(ffd->persistent_cache_size, SVN_MAX_OBJECT_SIZE),
+          TRUE, NULL, scratch_pool);
+  if (!err)
+    err = check_stamp(*store_p, fs, scratch_pool);
+
+  if (err && !no_handler)
+    {
+      *store_p = NULL;
+      return svn_error_trace(warn_and_continue_on_cache_errors(err, fs,
+                                                               scratch_pool));
+    }
+
+  return svn_error_trace(err);
+}
+
 svn_error_t *
 svn_fs_fs__initialize_caches(svn_fs_t *fs,
                              apr_pool_t *pool)
@@ -363,6 +525,7 @@ svn_fs_fs__initialize_caches(svn_fs_t *fs,
   svn_boolean_t cache_nodeprops;
   const char *cache_namespace;
   svn_boolean_t has_namespace;
+  svn_cache__persistent_store_t *persistent_store;
 
   /* Evaluating the cache configuration. */
   SVN_ERR(read_config(&cache_namespace,
@@ -376,6 +539,8 @@ svn_fs_fs__initialize_caches(svn_fs_t *fs,
   has_namespace = strlen(cache_namespace) > 0;
 
   membuffer = svn_cache__get_global_membuffer_cache();
+  SVN_ERR(open_persistent_store(&persistent_store, fs, no_handler, pool));
+  ffd->persistent_store = persistent_store;
 
   /* General rules for assigning cache priorities:
    *
@@ -434,6 +599,12 @@ svn_fs_fs__initialize_caches(svn_fs_t *fs,
                        fs,
                        no_handler,
                        fs->pool, pool));
+  SVN_ERR(add_persistent_layer(&(ffd->rev_node_cache), persistent_store,
+                               "DAG",
+                               svn_fs_fs__dag_serialize,
+                               svn_fs_fs__dag_deserialize,
+                               APR_HASH_KEY_STRING,
+                               fs, no_handler, fs->pool));
 
   /* 1st level DAG node cache */
   ffd->dag_node_cache = svn_fs_fs__create_dag_cache(fs->pool);
@@ -452,6 +623,11 @@ svn_fs_fs__initialize_caches(svn_fs_t *fs,
                        fs,
                        no_handler,
                        fs->pool, pool));
+  SVN_ERR(add_persistent_layer(&(ffd->dir_cache), persistent_store, "DIR",
+                               svn_fs_fs__serialize_dir_entries,
+                               svn_fs_fs__deserialize_dir_entries,
+                               sizeof(pair_cache_key_t),
+                               fs, no_handler, fs->pool));
 
   /* 8 kBytes per entry (1000 revs / shared, one file offset per rev).
      Covering about 8 pack files gives us an "o.k." hit rate. */
@@ -484,6 +660,12 @@ svn_fs_fs__initialize_caches(svn_fs_t *fs,
                        fs,
                        no_handler,
                        fs->pool, pool));
+  SVN_ERR(add_persistent_layer(&(ffd->node_revision_cache),
+                               persistent_store, "NODEREVS",
+                               svn_fs_fs__serialize_node_revision,
+                               svn_fs_fs__deserialize_node_revision,
+                               sizeof(pair_cache_key_t),
+                               fs, no_handler, fs->pool));
 
   /* initialize representation header cache, if caching has been enabled */
   SVN_ERR(create_cache(&(ffd->rep_header_cache),
@@ -727,6 +909,32 @@ svn_fs_fs__initialize_caches(svn_fs_t *fs,
   return SVN_NO_ERROR;
 }
 
+svn_error_t *
+svn_fs_fs__update_persistent_stamp(svn_fs_t *fs,
+                                   svn_revnum_t youngest,
+                                   apr_pool_t *scratch_pool)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+  const char *stamp;
+  svn_error_t *err;
+
+  if (!ffd->persistent_store || youngest <= ffd->persistent_stamp_rev)
+    return SVN_NO_ERROR;
+
+  err = make_stamp(&stamp, fs, youngest, scratch_pool, scratch_pool);
+  if (!err && stamp)
+    err = svn_cache__persistent_store_set_stamp(ffd->persistent_store,
+                                                stamp, scratch_pool);
+  if (!err)
+    ffd->persistent_stamp_rev = youngest;
+
+  if (err && !ffd->fail_stop)
+    return svn_error_trace(warn_and_continue_on_cache_errors(err, fs,
+                                                             scratch_pool));
+
+  return svn_error_trace(err);
+}
+
 /* Baton to be used for the remove_txn_cache() pool cleanup function, */
 struct txn_cleanup_baton_t
 {
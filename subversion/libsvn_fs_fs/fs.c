@@ -446,6 +446,37 @@ fs_open(svn_fs_t *fs,
 
 
 
+svn_error_t *
+svn_fs_fs__open_instance(svn_fs_t **new_fs,
+                         svn_fs_t *fs,
+                         apr_pool_t *result_pool,
+                         apr_pool_t *scratch_pool)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+  fs_fs_data_t *new_ffd;
+  svn_fs_t *instance = apr_pcalloc(result_pool, sizeof(*instance));
+
+  instance->pool = result_pool;
+  instance->warning = fs->warning;
+  instance->warning_baton = fs->warning_baton;
+  instance->config = fs->config;
+
+  SVN_ERR(initialize_fs_struct(instance));
+  SVN_ERR(svn_fs_fs__open(instance, fs->path, scratch_pool));
+  SVN_ERR(svn_fs_fs__initialize_caches(instance, scratch_pool));
+
+  /* The FS-global data has already been set up for FS.  Simply share it
+     instead of going through the serialized initialization again. */
+  new_ffd = instance->fsap_data;
+  new_ffd->shared = ffd->shared;
+  new_ffd->svn_fs_open_ = ffd->svn_fs_open_;
+
+  *new_fs = instance;
+  return SVN_NO_ERROR;
+}
+
+
+
 /* This implements the fs_library_vtable_t.open_for_recovery() API. */
 static svn_error_t *
 fs_open_for_recovery(svn_fs_t *fs,
@@ -545,6 +576,7 @@ fs_verify(svn_fs_t *fs, const char *path,
 static svn_error_t *
 fs_pack(svn_fs_t *fs,
         const char *path,
+        int jobs,
         svn_fs_pack_notify_t notify_func,
         void *notify_baton,
         svn_cancel_func_t cancel_func,
@@ -554,7 +586,7 @@ fs_pack(svn_fs_t *fs,
         apr_pool_t *common_pool)
 {
   SVN_ERR(fs_open(fs, path, common_pool_lock, pool, common_pool));
-  return svn_fs_fs__pack(fs, 0, notify_func, notify_baton,
+  return svn_fs_fs__pack(fs, 0, jobs, notify_func, notify_baton,
                          cancel_func, cancel_baton, pool);
 }
 
@@ -564,7 +596,8 @@ fs_pack(svn_fs_t *fs,
 /* This implements the fs_library_vtable_t.hotcopy() API.  Copy a
    possibly live Subversion filesystem SRC_FS from SRC_PATH to a
    DST_FS at DEST_PATH. If INCREMENTAL is TRUE, make an effort not to
-   re-copy data which already exists in DST_FS.
+   re-copy data which already exists in DST_FS.  Copy up to JOBS files
+   concurrently.
    The CLEAN_LOGS argument is ignored and included for Subversion
    1.0.x compatibility.  Indicate progress via the optional NOTIFY_FUNC
    callback using NOTIFY_BATON.  Perform all temporary allocations in POOL. */
@@ -575,6 +608,7 @@ fs_hotcopy(svn_fs_t *src_fs,
            const char *dst_path,
            svn_boolean_t clean_logs,
            svn_boolean_t incremental,
+           int jobs,
            svn_fs_hotcopy_notify_t notify_func,
            void *notify_baton,
            svn_cancel_func_t cancel_func,
@@ -593,7 +627,7 @@ fs_hotcopy(svn_fs_t *src_fs,
      can't be opened.
    */
   return svn_fs_fs__hotcopy(src_fs, dst_fs, src_path, dst_path,
-                            incremental, notify_func, notify_baton,
+                            incremental, jobs, notify_func, notify_baton,
                             cancel_func, cancel_baton, common_pool_lock,
                             pool, common_pool);
 }
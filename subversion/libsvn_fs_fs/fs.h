@@ -78,6 +78,8 @@ extern "C" {
                                                     to-log index */
 /* If you change this, look at tests/svn_test_fs.c(maybe_install_fsfs_conf) */
 #define PATH_CONFIG           "fsfs.conf"        /* Configuration */
+#define PATH_PERSISTENT_CACHE "persistent-cache" /* On-disk cache of
+                                                    immutable metadata */
 
 /* Names of special files and file extensions for transactions */
 #define PATH_CHANGES       "changes"       /* Records changes made so far */
@@ -100,6 +102,7 @@ extern "C" {
 /* Names of sections and options in fsfs.conf. */
 #define CONFIG_SECTION_CACHES            "caches"
 #define CONFIG_OPTION_FAIL_STOP          "fail-stop"
+#define CONFIG_OPTION_PERSISTENT_CACHE_SIZE "persistent-cache-size"
 #define CONFIG_SECTION_REP_SHARING       "rep-sharing"
 #define CONFIG_OPTION_ENABLE_REP_SHARING "enable-rep-sharing"
 #define CONFIG_SECTION_DELTIFICATION     "deltification"
@@ -115,6 +118,7 @@ extern "C" {
 #define CONFIG_OPTION_BLOCK_SIZE         "block-size"
 #define CONFIG_OPTION_L2P_PAGE_SIZE      "l2p-page-size"
 #define CONFIG_OPTION_P2L_PAGE_SIZE      "p2l-page-size"
+#define CONFIG_OPTION_READAHEAD_BLOCKS   "readahead-blocks"
 #define CONFIG_SECTION_DEBUG             "debug"
 #define CONFIG_OPTION_PACK_AFTER_COMMIT  "pack-after-commit"
 #define CONFIG_OPTION_VERIFY_BEFORE_COMMIT "verify-before-commit"
@@ -347,6 +351,10 @@ typedef struct fs_fs_data_t
    * (not just the one bit that we need, atm). */
   svn_boolean_t use_block_read;
 
+  /* Number of blocks following the one being read that the OS shall
+   * prefetch in the background.  0 disables read-ahead. */
+  apr_int64_t readahead_blocks;
+
   /* The revision that was youngest, last time we checked. */
   svn_revnum_t youngest_rev_cache;
 
@@ -360,6 +368,17 @@ typedef struct fs_fs_data_t
      e.g. memcached may be ignored as caching is an optional feature. */
   svn_boolean_t fail_stop;
 
+  /* Maximum size of the persistent, on-disk second-level cache in bytes.
+     0 disables it. */
+  apr_int64_t persistent_cache_size;
+
+  /* The persistent cache store backing some of the caches below.  May be
+     NULL. */
+  svn_cache__persistent_store_t *persistent_store;
+
+  /* Youngest revision that PERSISTENT_STORE has been stamped with. */
+  svn_revnum_t persistent_stamp_rev;
+
   /* A cache of revision root IDs, mapping from (svn_revnum_t *) to
      (svn_fs_id_t *).  (Not threadsafe.) */
   svn_cache__t *rev_root_id_cache;
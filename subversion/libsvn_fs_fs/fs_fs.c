@@ -825,6 +825,10 @@ read_config(fs_fs_data_t *ffd,
                                    CONFIG_SECTION_IO,
                                    CONFIG_OPTION_P2L_PAGE_SIZE,
                                    0x400));
+      SVN_ERR(svn_config_get_int64(config, &ffd->readahead_blocks,
+                                   CONFIG_SECTION_IO,
+                                   CONFIG_OPTION_READAHEAD_BLOCKS,
+                                   8));
 
       /* Don't accept unreasonable or illegal values.
        * Block size and P2L page size are in kbytes;
@@ -840,6 +844,8 @@ read_config(fs_fs_data_t *ffd,
       ffd->block_size *= 0x400;
       ffd->p2l_page_size *= 0x400;
       /* L2P pages are in entries - not in (k)Bytes */
+
+      ffd->readahead_blocks = MAX(ffd->readahead_blocks, 0);
     }
   else
     {
@@ -847,6 +853,7 @@ read_config(fs_fs_data_t *ffd,
       ffd->block_size = 0x1000; /* Matches default APR file buffer size. */
       ffd->l2p_page_size = 0x2000;    /* Matches above default. */
       ffd->p2l_page_size = 0x100000;  /* Matches above default in bytes. */
+      ffd->readahead_blocks = 0;
     }
 
   if (ffd->format >= SVN_FS_FS__MIN_PACKED_FORMAT)
@@ -946,6 +953,13 @@ read_config(fs_fs_data_t *ffd,
                               CONFIG_SECTION_CACHES, CONFIG_OPTION_FAIL_STOP,
                               FALSE));
 
+  /* The persistent cache size is given in MB. */
+  SVN_ERR(svn_config_get_int64(config, &ffd->persistent_cache_size,
+                               CONFIG_SECTION_CACHES,
+                               CONFIG_OPTION_PERSISTENT_CACHE_SIZE, 0));
+  ffd->persistent_cache_size = MAX(ffd->persistent_cache_size, 0)
+                             * 0x100000;
+
   return SVN_NO_ERROR;
 }
 
@@ -978,6 +992,14 @@ write_config(svn_fs_t *fs,
 "### configured (and ignoring it with file:// access).  To make"             NL
 "### Subversion never ignore cache errors, uncomment this line."             NL
 "# " CONFIG_OPTION_FAIL_STOP " = true"                                       NL
+"### Directory listings and node revisions can also be kept in a file in"    NL
+"### the db directory, such that they survive server restarts.  This avoids" NL
+"### the slow start with cold caches after restarting svnserve or httpd."    NL
+"### The following option sets the maximum size of that file in MB;"         NL
+"### 0 (the default) disables it.  The file is safe to delete at any time"   NL
+"### and must be deleted when restoring the repository from a plain file"    NL
+"### copy backup."                                                           NL
+"# " CONFIG_OPTION_PERSISTENT_CACHE_SIZE " = 0"                              NL
 ""                                                                           NL
 "[" CONFIG_SECTION_REP_SHARING "]"                                           NL
 "### To conserve space, the filesystem can optionally avoid storing"         NL
@@ -1148,6 +1170,15 @@ write_config(svn_fs_t *fs,
 "### Must be a power of 2."                                                  NL
 "### p2l-page-size is given in kBytes and with a default of 1024 kBytes."    NL
 "# " CONFIG_OPTION_P2L_PAGE_SIZE " = 1024"                                   NL
+"###"                                                                        NL
+"### When reading a block, the OS may be asked to fetch the blocks that"     NL
+"### follow it in the background.  Data is stored in the order in which"     NL
+"### trees are being walked, e.g. by checkouts and exports, so these tend"   NL
+"### to be needed next.  Larger values help with high-latency storage such"  NL
+"### as rotational disks or network file systems.  0 disables read-ahead."   NL
+"### This is only supported on some platforms and ignored elsewhere."        NL
+"### readahead-blocks is 8 by default."                                      NL
+"# " CONFIG_OPTION_READAHEAD_BLOCKS " = 8"                                   NL
 ""                                                                           NL
 "[" CONFIG_SECTION_DEBUG "]"                                                 NL
 "###"                                                                        NL
@@ -1452,6 +1483,7 @@ svn_fs_fs__youngest_rev(svn_revnum_t *youngest_p,
 
   SVN_ERR(get_youngest(youngest_p, fs, pool));
   ffd->youngest_rev_cache = *youngest_p;
+  SVN_ERR(svn_fs_fs__update_persistent_stamp(fs, *youngest_p, pool));
 
   return SVN_NO_ERROR;
 }
@@ -48,6 +48,16 @@ svn_error_t *svn_fs_fs__initialize_shared_data(svn_fs_t *fs,
                                                apr_pool_t *pool,
                                                apr_pool_t *common_pool);
 
+/* Open a new, independent instance of the filesystem FS and return it in
+   *NEW_FS.  It shares the FS-global data (e.g. locks) with FS but has its
+   own caches and file handles.  Hence, FS and *NEW_FS may be used from
+   different threads.  Allocate *NEW_FS in RESULT_POOL and use SCRATCH_POOL
+   for temporary allocations. */
+svn_error_t *svn_fs_fs__open_instance(svn_fs_t **new_fs,
+                                      svn_fs_t *fs,
+                                      apr_pool_t *result_pool,
+                                      apr_pool_t *scratch_pool);
+
 /* Upgrade the fsfs filesystem FS.  Indicate progress via the optional
  * NOTIFY_FUNC callback using NOTIFY_BATON.  The optional CANCEL_FUNC
  * will periodically be called with CANCEL_BATON to allow for preemption.
@@ -288,6 +298,14 @@ svn_fs_fs__get_node_origin(const svn_fs_id_t **origin_id,
 svn_error_t *
 svn_fs_fs__initialize_caches(svn_fs_t *fs, apr_pool_t *pool);
 
+/* Record in the persistent cache store of FS, if any, that its contents
+   match revisions up to YOUNGEST.  This is cheap if nothing changed since
+   the last call.  Use SCRATCH_POOL for temporary allocations. */
+svn_error_t *
+svn_fs_fs__update_persistent_stamp(svn_fs_t *fs,
+                                   svn_revnum_t youngest,
+                                   apr_pool_t *scratch_pool);
+
 /* Initialize all transaction-local caches in FS according to the global
    cache settings and make TXN_ID part of their key space. Use POOL for
    allocations.
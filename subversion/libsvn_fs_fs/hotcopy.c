@@ -23,6 +23,8 @@
 #include "svn_path.h"
 #include "svn_dirent_uri.h"
 
+#include "private/svn_task.h"
+
 #include "fs_fs.h"
 #include "hotcopy.h"
 #include "util.h"
@@ -237,6 +239,28 @@ hotcopy_io_copy_dir_recursively(svn_boolean_t *skipped_p,
   return SVN_NO_ERROR;
 }
 
+/* Create the shard directory for revision REV, which must be the first
+ * revision in its shard, in DST_SUBDIR with the permissions of DST_SUBDIR.
+ * Assume a sharding layout based on MAX_FILES_PER_DIR.
+ * Use SCRATCH_POOL for temporary allocations. */
+static svn_error_t *
+hotcopy_make_shard_dir(const char *dst_subdir,
+                       svn_revnum_t rev,
+                       int max_files_per_dir,
+                       apr_pool_t *scratch_pool)
+{
+  const char *dst_subdir_shard
+    = svn_dirent_join(dst_subdir,
+                      apr_psprintf(scratch_pool, "%ld",
+                                   rev / max_files_per_dir),
+                      scratch_pool);
+
+  SVN_ERR(svn_io_make_dir_recursively(dst_subdir_shard, scratch_pool));
+  SVN_ERR(svn_io_copy_perms(dst_subdir, dst_subdir_shard, scratch_pool));
+
+  return SVN_NO_ERROR;
+}
+
 /* Copy an un-packed revision or revprop file for revision REV from SRC_SUBDIR
  * to DST_SUBDIR. Assume a sharding layout based on MAX_FILES_PER_DIR.
  * Set *SKIPPED_P to FALSE only if the file was copied, do not change the
@@ -261,11 +285,8 @@ hotcopy_copy_shard_file(svn_boolean_t *skipped_p,
       dst_subdir_shard = svn_dirent_join(dst_subdir, shard, scratch_pool);
 
       if (rev % max_files_per_dir == 0)
-        {
-          SVN_ERR(svn_io_make_dir_recursively(dst_subdir_shard, scratch_pool));
-          SVN_ERR(svn_io_copy_perms(dst_subdir, dst_subdir_shard,
-                                    scratch_pool));
-        }
+        SVN_ERR(hotcopy_make_shard_dir(dst_subdir, rev, max_files_per_dir,
+                                       scratch_pool));
     }
 
   SVN_ERR(hotcopy_io_dir_file_copy(skipped_p,
@@ -279,19 +300,25 @@ hotcopy_copy_shard_file(svn_boolean_t *skipped_p,
 
 /* Copy a packed shard containing revision REV, and which contains
  * MAX_FILES_PER_DIR revisions, from SRC_FS to DST_FS.
- * Update *DST_MIN_UNPACKED_REV in case the shard is new in DST_FS.
  * Do not re-copy data which already exists in DST_FS.
  * Set *SKIPPED_P to FALSE only if at least one part of the shard
  * was copied, do not change the value in *SKIPPED_P otherwise.
  * SKIPPED_P may be NULL if not required.
+ *
+ * This does not update any of the state files in DST_FS and may be called
+ * concurrently for different shards.  The caller is responsible for
+ * updating the min-unpacked-rev in DST_FS.
+ *
+ * CANCEL_FUNC and CANCEL_BATON do the usual thing.
  * Use SCRATCH_POOL for temporary allocations. */
 static svn_error_t *
 hotcopy_copy_packed_shard(svn_boolean_t *skipped_p,
-                          svn_revnum_t *dst_min_unpacked_rev,
                           svn_fs_t *src_fs,
                           svn_fs_t *dst_fs,
                           svn_revnum_t rev,
                           int max_files_per_dir,
+                          svn_cancel_func_t cancel_func,
+                          void *cancel_baton,
                           apr_pool_t *scratch_pool)
 {
   const char *src_subdir;
@@ -312,7 +339,7 @@ hotcopy_copy_packed_shard(svn_boolean_t *skipped_p,
   SVN_ERR(hotcopy_io_copy_dir_recursively(skipped_p, src_subdir_packed_shard,
                                           dst_subdir, packed_shard,
                                           TRUE /* copy_perms */,
-                                          NULL /* cancel_func */, NULL,
+                                          cancel_func, cancel_baton,
                                           scratch_pool));
 
   /* Copy revprops belonging to revisions in this pack. */
@@ -353,19 +380,10 @@ hotcopy_copy_packed_shard(svn_boolean_t *skipped_p,
                                               src_subdir_packed_shard,
                                               dst_subdir, packed_shard,
                                               TRUE /* copy_perms */,
-                                              NULL /* cancel_func */, NULL,
+                                              cancel_func, cancel_baton,
                                               scratch_pool));
     }
 
-  /* If necessary, update the min-unpacked rev file in the hotcopy. */
-  if (*dst_min_unpacked_rev < rev + max_files_per_dir)
-    {
-      *dst_min_unpacked_rev = rev + max_files_per_dir;
-      SVN_ERR(svn_fs_fs__write_min_unpacked_rev(dst_fs,
-                                                *dst_min_unpacked_rev,
-                                                scratch_pool));
-    }
-
   return SVN_NO_ERROR;
 }
 
@@ -532,13 +550,232 @@ remove_folder(const char *path,
   return svn_error_trace(err);
 }
 
+/* Baton type used with the concurrent copy tasks in hotcopy_revisions().
+ * The processing functions treat it as read-only while the output
+ * functions may update the DST_MIN_UNPACKED_REV field.
+ */
+typedef struct hotcopy_revs_baton_t
+{
+  svn_fs_t *src_fs;
+  svn_fs_t *dst_fs;
+
+  /* See hotcopy_revisions(). */
+  svn_revnum_t dst_youngest;
+  svn_boolean_t incremental;
+  const char *src_revs_dir;
+  const char *dst_revs_dir;
+  const char *src_revprops_dir;
+  const char *dst_revprops_dir;
+  svn_fs_hotcopy_notify_t notify_func;
+  void *notify_baton;
+
+  /* Sharding configuration of SRC_FS. */
+  int max_files_per_dir;
+
+  /* Revision to be copied by the first task. */
+  svn_revnum_t start_rev;
+
+  /* Current min-unpacked-rev value in DST_FS. */
+  svn_revnum_t dst_min_unpacked_rev;
+} hotcopy_revs_baton_t;
+
+/* Implement svn_task__process_func_t.  Copy the packed shard with the index
+ * TASK_INDEX relative to PROCESS_BATON, a hotcopy_revs_baton_t *.
+ * Return whether all of its data had been present in the destination as
+ * svn_boolean_t * in *RESULT.
+ */
+static svn_error_t *
+copy_packed_shard_task(void **result,
+                       apr_size_t task_index,
+                       void *process_baton,
+                       void *thread_context,
+                       svn_cancel_func_t cancel_func,
+                       void *cancel_baton,
+                       apr_pool_t *result_pool,
+                       apr_pool_t *scratch_pool)
+{
+  hotcopy_revs_baton_t *hrb = process_baton;
+  svn_boolean_t *skipped = apr_palloc(result_pool, sizeof(*skipped));
+  svn_revnum_t rev = hrb->start_rev
+                   + (svn_revnum_t)task_index * hrb->max_files_per_dir;
+
+  *skipped = TRUE;
+  SVN_ERR(hotcopy_copy_packed_shard(skipped, hrb->src_fs, hrb->dst_fs,
+                                    rev, hrb->max_files_per_dir,
+                                    cancel_func, cancel_baton,
+                                    scratch_pool));
+
+  *result = skipped;
+  return SVN_NO_ERROR;
+}
+
+/* Implement svn_task__output_func_t.  The packed shard with the index
+ * TASK_INDEX relative to OUTPUT_BATON, a hotcopy_revs_baton_t *, has been
+ * copied.  Make it visible to readers of the destination and send the
+ * notification.  RESULT is the svn_boolean_t * returned by
+ * copy_packed_shard_task().
+ */
+static svn_error_t *
+output_copied_packed_shard(void *output_baton,
+                           apr_size_t task_index,
+                           void *result,
+                           svn_cancel_func_t cancel_func,
+                           void *cancel_baton,
+                           apr_pool_t *scratch_pool)
+{
+  hotcopy_revs_baton_t *hrb = output_baton;
+  svn_fs_t *dst_fs = hrb->dst_fs;
+  fs_fs_data_t *dst_ffd = dst_fs->fsap_data;
+  svn_boolean_t skipped = *(svn_boolean_t *)result;
+  int max_files_per_dir = hrb->max_files_per_dir;
+  svn_revnum_t rev = hrb->start_rev
+                   + (svn_revnum_t)task_index * max_files_per_dir;
+  svn_revnum_t pack_end_rev = rev + max_files_per_dir - 1;
+
+  /* If necessary, update the min-unpacked rev file in the hotcopy. */
+  if (hrb->dst_min_unpacked_rev < rev + max_files_per_dir)
+    {
+      hrb->dst_min_unpacked_rev = rev + max_files_per_dir;
+      SVN_ERR(svn_fs_fs__write_min_unpacked_rev(dst_fs,
+                                                hrb->dst_min_unpacked_rev,
+                                                scratch_pool));
+    }
+
+  /* Whenever this pack did not previously exist in the destination,
+   * update 'current' to the most recent packed rev (so readers can see
+   * new revisions which arrived in this pack). */
+  if (pack_end_rev > hrb->dst_youngest)
+    {
+      SVN_ERR(svn_fs_fs__write_current(dst_fs, pack_end_rev, 0, 0,
+                                       scratch_pool));
+    }
+
+  /* When notifying about packed shards, make things simpler by either
+   * reporting a full revision range, i.e [pack start, pack end] or
+   * reporting nothing. There is one case when this approach might not
+   * be exact (incremental hotcopy with a pack replacing last unpacked
+   * revisions), but generally this is good enough. */
+  if (hrb->notify_func && !skipped)
+    hrb->notify_func(hrb->notify_baton, rev, pack_end_rev, scratch_pool);
+
+  /* Remove revision files which are now packed. */
+  if (hrb->incremental)
+    {
+      SVN_ERR(hotcopy_remove_rev_files(dst_fs, rev,
+                                       rev + max_files_per_dir,
+                                       max_files_per_dir, scratch_pool));
+      if (dst_ffd->format >= SVN_FS_FS__MIN_PACKED_REVPROP_FORMAT)
+        SVN_ERR(hotcopy_remove_revprop_files(dst_fs, rev,
+                                             rev + max_files_per_dir,
+                                             max_files_per_dir,
+                                             scratch_pool));
+    }
+
+  /* Now that all revisions have moved into the pack, the original
+   * rev dir can be removed. */
+  SVN_ERR(remove_folder(svn_fs_fs__path_rev_shard(dst_fs, rev, scratch_pool),
+                        cancel_func, cancel_baton, scratch_pool));
+  if (rev > 0 && dst_ffd->format >= SVN_FS_FS__MIN_PACKED_REVPROP_FORMAT)
+    SVN_ERR(remove_folder(svn_fs_fs__path_revprops_shard(dst_fs, rev,
+                                                         scratch_pool),
+                          cancel_func, cancel_baton, scratch_pool));
+
+  return SVN_NO_ERROR;
+}
+
+/* Implement svn_task__process_func_t.  Copy the non-packed revision and
+ * revprop files of the revision with the index TASK_INDEX relative to
+ * PROCESS_BATON, a hotcopy_revs_baton_t *.  Return whether both had been
+ * present in the destination as svn_boolean_t * in *RESULT.
+ */
+static svn_error_t *
+copy_revision_task(void **result,
+                   apr_size_t task_index,
+                   void *process_baton,
+                   void *thread_context,
+                   svn_cancel_func_t cancel_func,
+                   void *cancel_baton,
+                   apr_pool_t *result_pool,
+                   apr_pool_t *scratch_pool)
+{
+  hotcopy_revs_baton_t *hrb = process_baton;
+  svn_boolean_t *skipped = apr_palloc(result_pool, sizeof(*skipped));
+  svn_revnum_t rev = hrb->start_rev + (svn_revnum_t)task_index;
+
+  /* Copying non-packed revisions is racy in case the source repository is
+   * being packed concurrently with this hotcopy operation. The race can
+   * happen with FS formats prior to SVN_FS_FS__MIN_PACK_LOCK_FORMAT that
+   * support packed revisions. With the pack lock, however, the race is
+   * impossible, because hotcopy and pack operations block each other.
+   *
+   * We assume that all revisions coming after 'min-unpacked-rev' really
+   * are unpacked and that's not necessarily true with concurrent packing.
+   * Don't try to be smart in this edge case, because handling it properly
+   * might require copying *everything* from the start. Just abort the
+   * hotcopy with an ENOENT (revision file moved to a pack, so it is no
+   * longer where we expect it to be). */
+
+  *skipped = TRUE;
+
+  /* Copy the rev file. */
+  SVN_ERR(hotcopy_copy_shard_file(skipped,
+                                  hrb->src_revs_dir, hrb->dst_revs_dir, rev,
+                                  hrb->max_files_per_dir,
+                                  scratch_pool));
+  /* Copy the revprop file. */
+  SVN_ERR(hotcopy_copy_shard_file(skipped,
+                                  hrb->src_revprops_dir,
+                                  hrb->dst_revprops_dir,
+                                  rev, hrb->max_files_per_dir,
+                                  scratch_pool));
+
+  *result = skipped;
+  return SVN_NO_ERROR;
+}
+
+/* Implement svn_task__output_func_t.  The revision with the index
+ * TASK_INDEX relative to OUTPUT_BATON, a hotcopy_revs_baton_t *, has been
+ * copied.  Checkpoint the progress and send the notification.  RESULT is
+ * the svn_boolean_t * returned by copy_revision_task().
+ */
+static svn_error_t *
+output_copied_revision(void *output_baton,
+                       apr_size_t task_index,
+                       void *result,
+                       svn_cancel_func_t cancel_func,
+                       void *cancel_baton,
+                       apr_pool_t *scratch_pool)
+{
+  hotcopy_revs_baton_t *hrb = output_baton;
+  svn_boolean_t skipped = *(svn_boolean_t *)result;
+  svn_revnum_t rev = hrb->start_rev + (svn_revnum_t)task_index;
+
+  /* Whenever this revision did not previously exist in the destination,
+   * checkpoint the progress via 'current' (do that once per full shard
+   * in order not to slow things down). */
+  if (rev > hrb->dst_youngest)
+    {
+      if (hrb->max_files_per_dir && (rev % hrb->max_files_per_dir == 0))
+        {
+          SVN_ERR(svn_fs_fs__write_current(hrb->dst_fs, rev, 0, 0,
+                                           scratch_pool));
+        }
+    }
+
+  if (hrb->notify_func && !skipped)
+    hrb->notify_func(hrb->notify_baton, rev, rev, scratch_pool);
+
+  return SVN_NO_ERROR;
+}
+
 /* Copy the revision and revprop files (possibly sharded / packed) from
  * SRC_FS to DST_FS.  Do not re-copy data which already exists in DST_FS.
  * When copying packed or unpacked shards, checkpoint the result in DST_FS
  * for every shard by updating the 'current' file if necessary.  Assume
  * the >= SVN_FS_FS__MIN_NO_GLOBAL_IDS_FORMAT filesystem format without
- * global next-ID counters.  Indicate progress via the optional NOTIFY_FUNC
- * callback using NOTIFY_BATON.  Use POOL for temporary allocations.
+ * global next-ID counters.  Copy up to JOBS packed shards or revisions
+ * concurrently.  Indicate progress via the optional NOTIFY_FUNC callback
+ * using NOTIFY_BATON.  Use POOL for temporary allocations.
  */
 static svn_error_t *
 hotcopy_revisions(svn_fs_t *src_fs,
@@ -546,6 +783,7 @@ hotcopy_revisions(svn_fs_t *src_fs,
                   svn_revnum_t src_youngest,
                   svn_revnum_t dst_youngest,
                   svn_boolean_t incremental,
+                  int jobs,
                   const char *src_revs_dir,
                   const char *dst_revs_dir,
                   const char *src_revprops_dir,
@@ -557,12 +795,11 @@ hotcopy_revisions(svn_fs_t *src_fs,
                   apr_pool_t *pool)
 {
   fs_fs_data_t *src_ffd = src_fs->fsap_data;
-  fs_fs_data_t *dst_ffd = dst_fs->fsap_data;
   int max_files_per_dir = src_ffd->max_files_per_dir;
   svn_revnum_t src_min_unpacked_rev;
   svn_revnum_t dst_min_unpacked_rev;
   svn_revnum_t rev;
-  apr_pool_t *iterpool;
+  hotcopy_revs_baton_t hrb;
 
   /* Copy the min unpacked rev, and read its value. */
   if (src_ffd->format >= SVN_FS_FS__MIN_PACKED_FORMAT)
@@ -596,131 +833,71 @@ hotcopy_revisions(svn_fs_t *src_fs,
   if (cancel_func)
     SVN_ERR(cancel_func(cancel_baton));
 
+  hrb.src_fs = src_fs;
+  hrb.dst_fs = dst_fs;
+  hrb.dst_youngest = dst_youngest;
+  hrb.incremental = incremental;
+  hrb.src_revs_dir = src_revs_dir;
+  hrb.dst_revs_dir = dst_revs_dir;
+  hrb.src_revprops_dir = src_revprops_dir;
+  hrb.dst_revprops_dir = dst_revprops_dir;
+  hrb.notify_func = notify_func;
+  hrb.notify_baton = notify_baton;
+  hrb.max_files_per_dir = max_files_per_dir;
+  hrb.dst_min_unpacked_rev = dst_min_unpacked_rev;
+
   /*
    * Copy the necessary rev files.
    */
 
-  iterpool = svn_pool_create(pool);
-  /* First, copy packed shards. */
-  for (rev = 0; rev < src_min_unpacked_rev; rev += max_files_per_dir)
-    {
-      svn_boolean_t skipped = TRUE;
-      svn_revnum_t pack_end_rev;
-
-      svn_pool_clear(iterpool);
-
-      if (cancel_func)
-        SVN_ERR(cancel_func(cancel_baton));
-
-      /* Copy the packed shard. */
-      SVN_ERR(hotcopy_copy_packed_shard(&skipped, &dst_min_unpacked_rev,
-                                        src_fs, dst_fs,
-                                        rev, max_files_per_dir,
-                                        iterpool));
-
-      pack_end_rev = rev + max_files_per_dir - 1;
+  /* First, copy packed shards.  The workers only copy files while all
+   * updates to the destination's state files happen in revision order. */
+  hrb.start_rev = 0;
+  if (src_min_unpacked_rev > 0)
+    SVN_ERR(svn_task__run(jobs, src_min_unpacked_rev / max_files_per_dir,
+                          copy_packed_shard_task, &hrb,
+                          output_copied_packed_shard, &hrb,
+                          NULL, NULL, cancel_func, cancel_baton, pool));
 
-      /* Whenever this pack did not previously exist in the destination,
-       * update 'current' to the most recent packed rev (so readers can see
-       * new revisions which arrived in this pack). */
-      if (pack_end_rev > dst_youngest)
-        {
-          SVN_ERR(svn_fs_fs__write_current(dst_fs, pack_end_rev, 0, 0,
-                                           iterpool));
-        }
-
-      /* When notifying about packed shards, make things simpler by either
-       * reporting a full revision range, i.e [pack start, pack end] or
-       * reporting nothing. There is one case when this approach might not
-       * be exact (incremental hotcopy with a pack replacing last unpacked
-       * revisions), but generally this is good enough. */
-      if (notify_func && !skipped)
-        notify_func(notify_baton, rev, pack_end_rev, iterpool);
-
-      /* Remove revision files which are now packed. */
-      if (incremental)
-        {
-          SVN_ERR(hotcopy_remove_rev_files(dst_fs, rev,
-                                           rev + max_files_per_dir,
-                                           max_files_per_dir, iterpool));
-          if (dst_ffd->format >= SVN_FS_FS__MIN_PACKED_REVPROP_FORMAT)
-            SVN_ERR(hotcopy_remove_revprop_files(dst_fs, rev,
-                                                 rev + max_files_per_dir,
-                                                 max_files_per_dir,
-                                                 iterpool));
-        }
-
-      /* Now that all revisions have moved into the pack, the original
-       * rev dir can be removed. */
-      SVN_ERR(remove_folder(svn_fs_fs__path_rev_shard(dst_fs, rev, iterpool),
-                            cancel_func, cancel_baton, iterpool));
-      if (rev > 0 && dst_ffd->format >= SVN_FS_FS__MIN_PACKED_REVPROP_FORMAT)
-        SVN_ERR(remove_folder(svn_fs_fs__path_revprops_shard(dst_fs, rev,
-                                                             iterpool),
-                              cancel_func, cancel_baton, iterpool));
-    }
+  rev = src_min_unpacked_rev;
+  dst_min_unpacked_rev = hrb.dst_min_unpacked_rev;
 
   if (cancel_func)
     SVN_ERR(cancel_func(cancel_baton));
 
-  SVN_ERR_ASSERT(rev == src_min_unpacked_rev);
   SVN_ERR_ASSERT(src_min_unpacked_rev == dst_min_unpacked_rev);
 
   /* Now, copy pairs of non-packed revisions and revprop files.
-   * If necessary, update 'current' after copying all files from a shard. */
-  for (; rev <= src_youngest; rev++)
+   * If necessary, update 'current' after copying all files from a shard.
+   *
+   * Revisions may get copied in arbitrary order when running concurrently,
+   * so create all the shard folders up-front. */
+  if (jobs > 1 && max_files_per_dir)
     {
-      svn_boolean_t skipped = TRUE;
-
-      svn_pool_clear(iterpool);
-
-      if (cancel_func)
-        SVN_ERR(cancel_func(cancel_baton));
+      apr_pool_t *iterpool = svn_pool_create(pool);
+      svn_revnum_t shard_rev;
 
-      /* Copying non-packed revisions is racy in case the source repository is
-       * being packed concurrently with this hotcopy operation. The race can
-       * happen with FS formats prior to SVN_FS_FS__MIN_PACK_LOCK_FORMAT that
-       * support packed revisions. With the pack lock, however, the race is
-       * impossible, because hotcopy and pack operations block each other.
-       *
-       * We assume that all revisions coming after 'min-unpacked-rev' really
-       * are unpacked and that's not necessarily true with concurrent packing.
-       * Don't try to be smart in this edge case, because handling it properly
-       * might require copying *everything* from the start. Just abort the
-       * hotcopy with an ENOENT (revision file moved to a pack, so it is no
-       * longer where we expect it to be). */
-
-      /* Copy the rev file. */
-      SVN_ERR(hotcopy_copy_shard_file(&skipped,
-                                      src_revs_dir, dst_revs_dir, rev,
-                                      max_files_per_dir,
-                                      iterpool));
-      /* Copy the revprop file. */
-      SVN_ERR(hotcopy_copy_shard_file(&skipped,
-                                      src_revprops_dir, dst_revprops_dir,
-                                      rev, max_files_per_dir,
-                                      iterpool));
-
-      /* Whenever this revision did not previously exist in the destination,
-       * checkpoint the progress via 'current' (do that once per full shard
-       * in order not to slow things down). */
-      if (rev > dst_youngest)
+      for (shard_rev = rev + (max_files_per_dir - rev % max_files_per_dir)
+                           % max_files_per_dir;
+           shard_rev <= src_youngest;
+           shard_rev += max_files_per_dir)
         {
-          if (max_files_per_dir && (rev % max_files_per_dir == 0))
-            {
-              SVN_ERR(svn_fs_fs__write_current(dst_fs, rev, 0, 0,
-                                               iterpool));
-            }
+          svn_pool_clear(iterpool);
+          SVN_ERR(hotcopy_make_shard_dir(dst_revs_dir, shard_rev,
+                                         max_files_per_dir, iterpool));
+          SVN_ERR(hotcopy_make_shard_dir(dst_revprops_dir, shard_rev,
+                                         max_files_per_dir, iterpool));
         }
 
-      if (notify_func && !skipped)
-        notify_func(notify_baton, rev, rev, iterpool);
+      svn_pool_destroy(iterpool);
     }
-  svn_pool_destroy(iterpool);
 
-  /* We assume that all revisions were copied now, i.e. we didn't exit the
-   * above loop early. 'rev' was last incremented during exit of the loop. */
-  SVN_ERR_ASSERT(rev == src_youngest + 1);
+  hrb.start_rev = rev;
+  if (rev <= src_youngest)
+    SVN_ERR(svn_task__run(jobs, src_youngest - rev + 1,
+                          copy_revision_task, &hrb,
+                          output_copied_revision, &hrb,
+                          NULL, NULL, cancel_func, cancel_baton, pool));
 
   return SVN_NO_ERROR;
 }
@@ -780,6 +957,7 @@ struct hotcopy_body_baton {
   svn_fs_t *src_fs;
   svn_fs_t *dst_fs;
   svn_boolean_t incremental;
+  int jobs;
   svn_fs_hotcopy_notify_t notify_func;
   void *notify_baton;
   svn_cancel_func_t cancel_func;
@@ -928,7 +1106,8 @@ hotcopy_body(void *baton, apr_pool_t *pool)
   if (src_ffd->format >= SVN_FS_FS__MIN_NO_GLOBAL_IDS_FORMAT)
     {
       SVN_ERR(hotcopy_revisions(src_fs, dst_fs, src_youngest, dst_youngest,
-                                incremental, src_revs_dir, dst_revs_dir,
+                                incremental, hbb->jobs,
+                                src_revs_dir, dst_revs_dir,
                                 src_revprops_dir, dst_revprops_dir,
                                 notify_func, notify_baton,
                                 cancel_func, cancel_baton, pool));
@@ -1007,6 +1186,7 @@ svn_fs_fs__hotcopy(svn_fs_t *src_fs,
                    const char *src_path,
                    const char *dst_path,
                    svn_boolean_t incremental,
+                   int jobs,
                    svn_fs_hotcopy_notify_t notify_func,
                    void *notify_baton,
                    svn_cancel_func_t cancel_func,
@@ -1082,6 +1262,7 @@ svn_fs_fs__hotcopy(svn_fs_t *src_fs,
   hbb.src_fs = src_fs;
   hbb.dst_fs = dst_fs;
   hbb.incremental = incremental;
+  hbb.jobs = jobs;
   hbb.notify_func = notify_func;
   hbb.notify_baton = notify_baton;
   hbb.cancel_func = cancel_func;
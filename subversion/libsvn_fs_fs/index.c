@@ -22,6 +22,8 @@
 
 #include <assert.h>
 
+#include <apr_mmap.h>
+
 #include "svn_io.h"
 #include "svn_pools.h"
 #include "svn_sorts.h"
@@ -70,6 +72,15 @@ const apr_uint64_t off_t_max = (sizeof(apr_off_t) == sizeof(apr_int64_t))
 #define STREAM_PREFIX_LEN MAX(sizeof(L2P_STREAM_PREFIX), \
                               sizeof(P2L_STREAM_PREFIX))
 
+/* Memory mappings of index data start at multiples of this offset.
+ * It covers the page size and allocation granularity of all common
+ * platforms. */
+#define INDEX_MMAP_ALIGNMENT 0x10000
+
+/* Don't map index data larger than this.  Huge indexes may exhaust the
+ * address space of 32 bit processes; we read them through the file API. */
+#define MAX_INDEX_MMAP_SIZE (64 * 1024 * 1024)
+
 /* Page tables in the log-to-phys index file exclusively contain entries
  * of this type to describe position and size of a given page.
  */
@@ -214,6 +225,12 @@ struct svn_fs_fs__packed_number_stream_t
   /* pool to be used for file ops etc. */
   apr_pool_t *pool;
 
+  /* If not NULL, the stream data has been mapped into memory and MAPPED
+   * points to the byte at offset MAPPED_START in FILE.  All reads will
+   * then be served from memory. */
+  const unsigned char *mapped;
+  apr_off_t mapped_start;
+
   /* buffer for prefetched values */
   value_position_pair_t buffer[MAX_NUMBER_PREFETCH];
 };
@@ -240,7 +257,8 @@ stream_error_create(svn_fs_fs__packed_number_stream_t *stream,
 }
 
 /* Read up to MAX_NUMBER_PREFETCH numbers from the STREAM->NEXT_OFFSET in
- * STREAM->FILE and buffer them.
+ * STREAM->FILE and buffer them.  Decode them straight from the mapped
+ * file contents, if available.
  *
  * We don't want GCC and others to inline this (infrequently called)
  * function into packed_stream_get() because it prevents the latter from
@@ -250,43 +268,56 @@ SVN__PREVENT_INLINE
 static svn_error_t *
 packed_stream_read(svn_fs_fs__packed_number_stream_t *stream)
 {
-  unsigned char buffer[MAX_NUMBER_PREFETCH];
+  unsigned char file_buffer[MAX_NUMBER_PREFETCH];
+  const unsigned char *buffer = file_buffer;
   apr_size_t bytes_read = 0;
   apr_size_t i;
   value_position_pair_t *target;
-  apr_off_t block_start = 0;
-  apr_off_t block_left = 0;
-  apr_status_t err;
+  apr_status_t err = APR_SUCCESS;
 
   /* all buffered data will have been read starting here */
   stream->start_offset = stream->next_offset;
 
-  /* packed numbers are usually not aligned to MAX_NUMBER_PREFETCH blocks,
-   * i.e. the last number has been incomplete (and not buffered in stream)
-   * and need to be re-read.  Therefore, always correct the file pointer.
-   */
-  SVN_ERR(svn_io_file_aligned_seek(stream->file, stream->block_size,
-                                   &block_start, stream->next_offset,
-                                   stream->pool));
+  if (stream->mapped)
+    {
+      /* No need to copy anything.  Parse the data where it is. */
+      buffer = stream->mapped + (stream->next_offset - stream->mapped_start);
+      bytes_read = (apr_size_t)MIN(MAX_NUMBER_PREFETCH,
+                                   stream->stream_end - stream->next_offset);
+    }
+  else
+    {
+      apr_off_t block_start = 0;
+      apr_off_t block_left = 0;
 
-  /* prefetch at least one number but, if feasible, don't cross block
-   * boundaries.  This shall prevent jumping back and forth between two
-   * blocks because the extra data was not actually request _now_.
-   */
-  bytes_read = sizeof(buffer);
-  block_left = stream->block_size - (stream->next_offset - block_start);
-  if (block_left >= 10 && block_left < bytes_read)
-    bytes_read = (apr_size_t)block_left;
-
-  /* Don't read beyond the end of the file section that belongs to this
-   * index / stream. */
-  bytes_read = (apr_size_t)MIN(bytes_read,
-                               stream->stream_end - stream->next_offset);
-
-  err = apr_file_read(stream->file, buffer, &bytes_read);
-  if (err && !APR_STATUS_IS_EOF(err))
-    return stream_error_create(stream, err,
-      _("Can't read index file '%s' at offset 0x%s"));
+      /* packed numbers are usually not aligned to MAX_NUMBER_PREFETCH blocks,
+       * i.e. the last number has been incomplete (and not buffered in stream)
+       * and need to be re-read.  Therefore, always correct the file pointer.
+       */
+      SVN_ERR(svn_io_file_aligned_seek(stream->file, stream->block_size,
+                                       &block_start,
+                                       stream->next_offset,
+                                       stream->pool));
+
+      /* prefetch at least one number but, if feasible, don't cross block
+       * boundaries.  This shall prevent jumping back and forth between two
+       * blocks because the extra data was not actually request _now_.
+       */
+      bytes_read = sizeof(file_buffer);
+      block_left = stream->block_size - (stream->next_offset - block_start);
+      if (block_left >= 10 && block_left < bytes_read)
+        bytes_read = (apr_size_t)block_left;
+
+      /* Don't read beyond the end of the file section that belongs to this
+       * index / stream. */
+      bytes_read = (apr_size_t)MIN(bytes_read,
+                                   stream->stream_end - stream->next_offset);
+
+      err = apr_file_read(stream->file, file_buffer, &bytes_read);
+      if (err && !APR_STATUS_IS_EOF(err))
+        return stream_error_create(stream, err,
+          _("Can't read index file '%s' at offset 0x%s"));
+    }
 
   /* if the last number is incomplete, trim it from the buffer */
   while (bytes_read > 0 && buffer[bytes_read-1] >= 0x80)
@@ -346,7 +377,9 @@ packed_stream_read(svn_fs_fs__packed_number_stream_t *stream)
 /* Create and open a packed number stream reading from offsets START to
  * END in FILE and return it in *STREAM.  Access the file in chunks of
  * BLOCK_SIZE bytes.  Expect the stream to be prefixed by STREAM_PREFIX.
- * Allocate *STREAM in RESULT_POOL and use SCRATCH_POOL for temporaries.
+ * If possible, map the stream data into memory for the lifetime of
+ * RESULT_POOL.  Allocate *STREAM in RESULT_POOL and use SCRATCH_POOL for
+ * temporaries.
  */
 static svn_error_t *
 packed_stream_open(svn_fs_fs__packed_number_stream_t **stream,
@@ -391,6 +424,30 @@ packed_stream_open(svn_fs_fs__packed_number_stream_t **stream,
   result->start_offset = result->stream_start;
   result->next_offset = result->stream_start;
   result->block_size = block_size;
+  result->mapped = NULL;
+  result->mapped_start = 0;
+
+#if APR_HAS_MMAP && !defined(WIN32)
+  /* Index data never changes once written, so we may map it into memory
+   * and save the seek() and read() calls per number batch.  If that fails,
+   * simply fall back to reading the file.  We don't do this on Windows
+   * because mapped files can't be deleted or replaced, e.g. by pack. */
+  {
+    apr_off_t map_start = start & ~(apr_off_t)(INDEX_MMAP_ALIGNMENT - 1);
+    if (end > map_start && end - map_start <= MAX_INDEX_MMAP_SIZE)
+      {
+        apr_mmap_t *mmap;
+        apr_status_t status = apr_mmap_create(&mmap, file, map_start,
+                                              (apr_size_t)(end - map_start),
+                                              APR_MMAP_READ, result_pool);
+        if (status == APR_SUCCESS)
+          {
+            result->mapped = mmap->mm;
+            result->mapped_start = map_start;
+          }
+      }
+  }
+#endif
 
   *stream = result;
 
@@ -1501,6 +1558,64 @@ l2p_page_get_entry(l2p_entry_baton_t *baton,
   return SVN_NO_ERROR;
 }
 
+/* If the log-to-phys index in REV_FILE can be mapped into memory, decode
+ * the entry at BATON->PAGE_OFFSET in the page identified by TABLE_ENTRY
+ * directly from there, write it to BATON->OFFSET and set *FOUND.  This
+ * does not require the whole page to be read.  Otherwise, set *FOUND to
+ * FALSE.  The index is identified by START_REVISION in FS.
+ *
+ * Since this decodes all entries before the one requested, it is only
+ * worth it if the page can't be cached.
+ * Use SCRATCH_POOL for temporary allocations.
+ */
+static svn_error_t *
+l2p_mapped_page_get_entry(svn_boolean_t *found,
+                          l2p_entry_baton_t *baton,
+                          svn_fs_fs__revision_file_t *rev_file,
+                          svn_fs_t *fs,
+                          svn_revnum_t start_revision,
+                          const l2p_page_table_entry_t *table_entry,
+                          apr_pool_t *scratch_pool)
+{
+  svn_fs_fs__packed_number_stream_t *stream;
+  apr_uint64_t last_value = 0;
+  apr_uint32_t i;
+
+  SVN_ERR(auto_open_l2p_index(rev_file, fs, start_revision));
+  stream = rev_file->l2p_stream;
+  *found = stream->mapped != NULL;
+  if (!*found)
+    return SVN_NO_ERROR;
+
+  /* overflow check */
+  if (table_entry->entry_count <= baton->page_offset)
+    return svn_error_createf(SVN_ERR_FS_INDEX_OVERFLOW , NULL,
+                             _("Item index %s"
+                               " too large in revision %ld"),
+                             apr_psprintf(scratch_pool, "%" APR_UINT64_T_FMT,
+                                          baton->item_index),
+                             baton->revision);
+
+  /* Entries are delta-encoded, so we have to decode all preceding ones
+   * as well.  But we may stop right after the one we need. */
+  packed_stream_seek(stream, table_entry->offset);
+  for (i = 0; i <= baton->page_offset; ++i)
+    {
+      apr_uint64_t value = 0;
+      SVN_ERR(packed_stream_get(&value, stream));
+      last_value += decode_int(value);
+    }
+
+  if (   packed_stream_offset(stream)
+      > table_entry->offset + table_entry->size)
+    return svn_error_create(SVN_ERR_FS_INDEX_CORRUPTION, NULL,
+                _("L2P actual page size does not match page table value."));
+
+  baton->offset = last_value - 1;
+
+  return SVN_NO_ERROR;
+}
+
 /* Implement svn_cache__partial_getter_func_t: copy the data requested in
  * l2p_entry_baton_t *BATON from l2p_page_t *DATA into BATON->OFFSET.
  * *OUT remains unchanged.
@@ -1562,6 +1677,18 @@ l2p_index_lookup(apr_off_t *offset,
                                  l2p_entry_access_func, &page_baton,
                                  scratch_pool));
 
+  /* Pages that the cache would not take, have to be decoded for every
+   * lookup.  If the index is mapped into memory, decode only as much of
+   * the page as we need.  All other pages get read and cached below
+   * (which will use the mapping as well). */
+  if (   !is_cached
+      && !svn_cache__is_cachable(ffd->l2p_page_cache,
+                                 info_baton.entry.entry_count
+                                   * sizeof(apr_uint64_t)))
+    SVN_ERR(l2p_mapped_page_get_entry(&is_cached, &page_baton, rev_file, fs,
+                                      info_baton.first_revision,
+                                      &info_baton.entry, scratch_pool));
+
   if (!is_cached)
     {
       /* we need to read the info from disk (might already be in the
@@ -30,6 +30,7 @@
 #include "private/svn_subr_private.h"
 #include "private/svn_string_private.h"
 #include "private/svn_io_private.h"
+#include "private/svn_task.h"
 
 #include "fs_fs.h"
 #include "pack.h"
@@ -1865,6 +1866,7 @@ struct pack_baton
   svn_cancel_func_t cancel_func;
   void *cancel_baton;
   size_t max_mem;
+  int jobs;
 
   /* Additional entries valid when entering pack_shard(). */
   const char *revs_dir;
@@ -1957,6 +1959,59 @@ synced_pack_shard(void *baton,
   return SVN_NO_ERROR;
 }
 
+/* Return the path of the pack directory for SHARD in REVS_DIR.
+ * Allocate the result in RESULT_POOL. */
+static const char *
+rev_pack_file_dir(const char *revs_dir,
+                  apr_int64_t shard,
+                  apr_pool_t *result_pool)
+{
+  return svn_dirent_join(revs_dir,
+                         apr_psprintf(result_pool,
+                                      "%" APR_INT64_T_FMT PATH_EXT_PACKED_SHARD,
+                                      shard),
+                         result_pool);
+}
+
+/* Return the path of the non-packed SHARD in REVS_DIR.
+ * Allocate the result in RESULT_POOL. */
+static const char *
+rev_shard_dir(const char *revs_dir,
+              apr_int64_t shard,
+              apr_pool_t *result_pool)
+{
+  return svn_dirent_join(revs_dir,
+                         apr_psprintf(result_pool, "%" APR_INT64_T_FMT, shard),
+                         result_pool);
+}
+
+/* The revision contents of the shard described by BATON has already been
+ * packed.  Now, make the packed shard the one visible to readers and
+ * notify the caller.
+ */
+static svn_error_t *
+switch_to_packed_shard(struct pack_baton *baton,
+                       apr_pool_t *pool)
+{
+  fs_fs_data_t *ffd = baton->fs->fsap_data;
+
+  /* For newer repo formats, we only acquired the pack lock so far.
+     Before modifying the repo state by switching over to the packed
+     data, we need to acquire the global (write) lock. */
+  if (ffd->format >= SVN_FS_FS__MIN_PACK_LOCK_FORMAT)
+    SVN_ERR(svn_fs_fs__with_write_lock(baton->fs, synced_pack_shard, baton,
+                                       pool));
+  else
+    SVN_ERR(synced_pack_shard(baton, pool));
+
+  /* Notify caller we're starting to pack this shard. */
+  if (baton->notify_func)
+    SVN_ERR(baton->notify_func(baton->notify_baton, baton->shard,
+                               svn_fs_pack_notify_end, pool));
+
+  return SVN_NO_ERROR;
+}
+
 /* Pack the shard described by BATON.
  *
  * If for some reason we detect a partial packing already performed,
@@ -1967,48 +2022,120 @@ pack_shard(struct pack_baton *baton,
            apr_pool_t *pool)
 {
   fs_fs_data_t *ffd = baton->fs->fsap_data;
-  const char *rev_pack_file_dir;
 
   /* Notify caller we're starting to pack this shard. */
   if (baton->notify_func)
     SVN_ERR(baton->notify_func(baton->notify_baton, baton->shard,
                                svn_fs_pack_notify_start, pool));
 
-  /* Some useful paths. */
-  rev_pack_file_dir = svn_dirent_join(baton->revs_dir,
-                  apr_psprintf(pool,
-                               "%" APR_INT64_T_FMT PATH_EXT_PACKED_SHARD,
-                               baton->shard),
-                  pool);
-  baton->rev_shard_path = svn_dirent_join(baton->revs_dir,
-                                          apr_psprintf(pool,
-                                                       "%" APR_INT64_T_FMT,
-                                                       baton->shard),
-                                          pool);
-
   /* pack the revision content */
-  SVN_ERR(pack_rev_shard(baton->fs, rev_pack_file_dir, baton->rev_shard_path,
+  baton->rev_shard_path = rev_shard_dir(baton->revs_dir, baton->shard, pool);
+  SVN_ERR(pack_rev_shard(baton->fs,
+                         rev_pack_file_dir(baton->revs_dir, baton->shard,
+                                           pool),
+                         baton->rev_shard_path,
                          baton->shard, ffd->max_files_per_dir,
                          baton->max_mem, ffd->flush_to_disk,
                          baton->cancel_func, baton->cancel_baton, pool));
 
-  /* For newer repo formats, we only acquired the pack lock so far.
-     Before modifying the repo state by switching over to the packed
-     data, we need to acquire the global (write) lock. */
-  if (ffd->format >= SVN_FS_FS__MIN_PACK_LOCK_FORMAT)
-    SVN_ERR(svn_fs_fs__with_write_lock(baton->fs, synced_pack_shard, baton,
-                                       pool));
-  else
-    SVN_ERR(synced_pack_shard(baton, pool));
+  return svn_error_trace(switch_to_packed_shard(baton, pool));
+}
 
-  /* Notify caller we're starting to pack this shard. */
-  if (baton->notify_func)
-    SVN_ERR(baton->notify_func(baton->notify_baton, baton->shard,
-                               svn_fs_pack_notify_end, pool));
+/* Baton type used with the concurrent pack tasks, see pack_body(). */
+typedef struct pack_task_baton_t
+{
+  /* The pack operation as set up by pack_body().  Its contents must not
+     be modified while the tasks are being processed, except by
+     output_packed_shard(). */
+  struct pack_baton *pb;
+
+  /* The shard to be packed by the first task. */
+  apr_int64_t first_shard;
+
+  /* Memory budget per shard being packed. */
+  apr_size_t max_mem;
+} pack_task_baton_t;
+
+/* Implement svn_task__thread_context_constructor_t.  Open a separate
+ * instance of the filesystem to pack for the current thread because
+ * svn_fs_t objects must not be shared between threads.  BATON is a
+ * pack_task_baton_t *.
+ */
+static svn_error_t *
+open_pack_thread_fs(void **thread_context,
+                    void *baton,
+                    apr_pool_t *result_pool,
+                    apr_pool_t *scratch_pool)
+{
+  pack_task_baton_t *tb = baton;
+  svn_fs_t *fs;
+
+  SVN_ERR(svn_fs_fs__open_instance(&fs, tb->pb->fs, result_pool,
+                                   scratch_pool));
+  *thread_context = fs;
 
   return SVN_NO_ERROR;
 }
 
+/* Implement svn_task__process_func_t.  Pack the revision contents of the
+ * shard with the index TASK_INDEX relative to PROCESS_BATON, which is a
+ * pack_task_baton_t *.  THREAD_CONTEXT is the svn_fs_t * to use.
+ */
+static svn_error_t *
+pack_rev_shard_task(void **result,
+                    apr_size_t task_index,
+                    void *process_baton,
+                    void *thread_context,
+                    svn_cancel_func_t cancel_func,
+                    void *cancel_baton,
+                    apr_pool_t *result_pool,
+                    apr_pool_t *scratch_pool)
+{
+  pack_task_baton_t *tb = process_baton;
+  svn_fs_t *fs = thread_context;
+  fs_fs_data_t *ffd = fs->fsap_data;
+  apr_int64_t shard = tb->first_shard + (apr_int64_t)task_index;
+
+  SVN_ERR(pack_rev_shard(fs,
+                         rev_pack_file_dir(tb->pb->revs_dir, shard,
+                                           scratch_pool),
+                         rev_shard_dir(tb->pb->revs_dir, shard,
+                                       scratch_pool),
+                         shard, ffd->max_files_per_dir, tb->max_mem,
+                         ffd->flush_to_disk, cancel_func, cancel_baton,
+                         scratch_pool));
+
+  *result = NULL;
+  return SVN_NO_ERROR;
+}
+
+/* Implement svn_task__output_func_t.  The revision contents of the shard
+ * with the index TASK_INDEX relative to OUTPUT_BATON, a pack_task_baton_t *,
+ * has been packed.  Switch over to it, i.e. finish packing that shard.
+ */
+static svn_error_t *
+output_packed_shard(void *output_baton,
+                    apr_size_t task_index,
+                    void *result,
+                    svn_cancel_func_t cancel_func,
+                    void *cancel_baton,
+                    apr_pool_t *scratch_pool)
+{
+  pack_task_baton_t *tb = output_baton;
+  struct pack_baton *pb = tb->pb;
+
+  pb->shard = tb->first_shard + (apr_int64_t)task_index;
+  pb->rev_shard_path = rev_shard_dir(pb->revs_dir, pb->shard, scratch_pool);
+
+  /* The actual work has already been done but we want to produce the
+     same sequence of notifications as a single-threaded pack. */
+  if (pb->notify_func)
+    SVN_ERR(pb->notify_func(pb->notify_baton, pb->shard,
+                            svn_fs_pack_notify_start, scratch_pool));
+
+  return svn_error_trace(switch_to_packed_shard(pb, scratch_pool));
+}
+
 /* Read the youngest rev and the first non-packed rev info for FS from disk.
    Set *FULLY_PACKED when there is no completed unpacked shard.
    Use SCRATCH_POOL for temporary allocations.
@@ -2080,6 +2207,26 @@ pack_body(void *baton,
     pb->revsprops_dir = svn_dirent_join(pb->fs->path, PATH_REVPROPS_DIR,
                                         pool);
 
+  /* Pack multiple shards concurrently but switch over to them in order.
+     Each shard being worked on gets its share of the memory budget. */
+  if (pb->jobs > 1)
+    {
+      pack_task_baton_t tb;
+
+      tb.pb = pb;
+      tb.first_shard = ffd->min_unpacked_rev / ffd->max_files_per_dir;
+      tb.max_mem = pb->max_mem / pb->jobs;
+
+      return svn_error_trace(svn_task__run(pb->jobs,
+                                           (apr_size_t)(completed_shards
+                                                        - tb.first_shard),
+                                           pack_rev_shard_task, &tb,
+                                           output_packed_shard, &tb,
+                                           open_pack_thread_fs, &tb,
+                                           pb->cancel_func,
+                                           pb->cancel_baton, pool));
+    }
+
   iterpool = svn_pool_create(pool);
   for (pb->shard = ffd->min_unpacked_rev / ffd->max_files_per_dir;
        pb->shard < completed_shards;
@@ -2100,6 +2247,7 @@ pack_body(void *baton,
 svn_error_t *
 svn_fs_fs__pack(svn_fs_t *fs,
                 apr_size_t max_mem,
+                int jobs,
                 svn_fs_pack_notify_t notify_func,
                 void *notify_baton,
                 svn_cancel_func_t cancel_func,
@@ -2146,6 +2294,7 @@ svn_fs_fs__pack(svn_fs_t *fs,
   pb.cancel_func = cancel_func;
   pb.cancel_baton = cancel_baton;
   pb.max_mem = max_mem ? max_mem : DEFAULT_MAX_MEM;
+  pb.jobs = jobs;
 
   if (ffd->format >= SVN_FS_FS__MIN_PACK_LOCK_FORMAT)
     {
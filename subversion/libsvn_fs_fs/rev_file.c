@@ -54,6 +54,8 @@ init_revision_file(svn_fs_fs__revision_file_t *file,
   file->p2l_offset = -1;
   file->p2l_checksum = NULL;
   file->footer_offset = -1;
+  file->readahead_start = 0;
+  file->readahead_end = 0;
   file->pool = pool;
 }
 
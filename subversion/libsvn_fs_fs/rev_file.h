@@ -90,6 +90,11 @@ typedef struct svn_fs_fs__revision_file_t
    * been called, yet. */
   apr_off_t footer_offset;
 
+  /* Range within FILE that the OS has last been asked to prefetch.
+   * Both are 0 if there was no such request, yet. */
+  apr_off_t readahead_start;
+  apr_off_t readahead_end;
+
   /* pool containing this object */
   apr_pool_t *pool;
 } svn_fs_fs__revision_file_t;
@@ -3929,6 +3929,9 @@ commit_body(void *baton, apr_pool_t *pool)
    * visible. */
   SVN_ERR(promote_cached_directories(cb->fs, directory_ids, pool));
 
+  /* Cached data for NEW_REV may already have been persisted. */
+  SVN_ERR(svn_fs_fs__update_persistent_stamp(cb->fs, new_rev, pool));
+
   /* Remove this transaction directory. */
   SVN_ERR(svn_fs_fs__purge_txn(cb->fs, cb->txn->id, pool));
 
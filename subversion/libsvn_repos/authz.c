@@ -124,10 +124,20 @@ combine_right_limits(limited_rights_t *target,
 /*** Authz cache access. ***/
 
 /* All authz instances currently in use as well as all filtered authz
- * instances in use will be cached here.
- * Both caches will be instantiated at most once. */
+ * instances in use will be cached here.  Since many users tend to have
+ * the same rules, e.g. because they are members of the same groups,
+ * the filtered trees themselves are cached by their effective rules in
+ * the RULES_POOL and FILTERED_POOL maps users to those shared trees.
+ *
+ * These are plain object pools, i.e. trees are only shared between the
+ * users and threads of a single process.  Filtered trees are webs of
+ * hashes and pattern arrays that point into each other; they are not
+ * serialized into the membuffer cache.
+ *
+ * All caches will be instantiated at most once. */
 static svn_object_pool__t *authz_pool = NULL;
 static svn_object_pool__t *filtered_pool = NULL;
+static svn_object_pool__t *rules_pool = NULL;
 static svn_atomic_t authz_pool_initialized = FALSE;
 
 /* Implements svn_atomic__err_init_func_t. */
@@ -142,6 +152,7 @@ synchronized_authz_initialize(void *baton, apr_pool_t *pool)
 
   SVN_ERR(svn_object_pool__create(&authz_pool, multi_threaded, pool));
   SVN_ERR(svn_object_pool__create(&filtered_pool, multi_threaded, pool));
+  SVN_ERR(svn_object_pool__create(&rules_pool, multi_threaded, pool));
 
   return SVN_NO_ERROR;
 }
@@ -215,6 +226,64 @@ construct_filtered_key(const char *repos_name,
 }
 
 
+/* Return a combination of REPOS_NAME, the sequence numbers and access
+ * rights of those ACLS that apply to USER and AUTHZ_ID, allocated in
+ * RESULT_POOL.  ACLS is an array of authz_acl_t * as returned by
+ * get_repos_acls.  USER may be NULL.  This is the key for the RULES_POOL.
+ * Use SCRATCH_POOL for temporary allocations.
+ */
+static svn_membuf_t *
+construct_rules_key(const apr_array_header_t *acls,
+                    const char *repos_name,
+                    const char *user,
+                    const svn_membuf_t *authz_id,
+                    apr_pool_t *result_pool,
+                    apr_pool_t *scratch_pool)
+{
+  svn_membuf_t *result = apr_pcalloc(result_pool, sizeof(*result));
+  svn_checksum_ctx_t *ctx = svn_checksum_ctx_create(svn_checksum_md5,
+                                                    scratch_pool);
+  svn_checksum_t *checksum;
+  apr_size_t repos_len = strlen(repos_name);
+  apr_size_t digest_size;
+  apr_size_t size;
+  int i;
+
+  /* The filtered tree depends on nothing but the rules that apply to
+   * USER and the access they grant.  Rules are identified by their
+   * sequence numbers. */
+  for (i = 0; i < acls->nelts; ++i)
+    {
+      const authz_acl_t *acl = APR_ARRAY_IDX(acls, i, const authz_acl_t *);
+      authz_access_t access;
+
+      if (svn_authz__get_acl_access(&access, acl, user, repos_name))
+        {
+          apr_int32_t entry[2];
+          entry[0] = acl->sequence_number;
+          entry[1] = access;
+
+          svn_error_clear(svn_checksum_update(ctx, entry, sizeof(entry)));
+        }
+    }
+
+  svn_error_clear(svn_checksum_final(&checksum, ctx, scratch_pool));
+  digest_size = svn_checksum_size(checksum);
+  size = repos_len + 1 + digest_size + authz_id->size;
+
+  svn_membuf__create(result, size, result_pool);
+  result->size = size; /* exact length is required! */
+
+  memcpy(result->data, repos_name, repos_len + 1);
+  size = repos_len + 1;
+  memcpy((char *)result->data + size, checksum->digest, digest_size);
+  size += digest_size;
+  memcpy((char *)result->data + size, authz_id->data, authz_id->size);
+
+  return result;
+}
+
+
 /*** Constructing the prefix tree. ***/
 
 /* Since prefix arrays may have more than one hit, we need to link them
@@ -872,27 +941,19 @@ finalize_tree(node_t *node,
   combine_right_limits(sum, local_sum);
 }
 
-/* From the authz CONFIG, extract the parts relevant to USER and REPOSITORY.
- * Return the filtered rule tree.
+/* Return an array of all authz_acl_t * in AUTHZ that apply to REPOSITORY,
+ * allocated in RESULT_POOL.
  */
-static node_t *
-create_user_authz(authz_full_t *authz,
-                  const char *repository,
-                  const char *user,
-                  apr_pool_t *result_pool,
-                  apr_pool_t *scratch_pool)
+static apr_array_header_t *
+get_repos_acls(authz_full_t *authz,
+               const char *repository,
+               apr_pool_t *result_pool)
 {
   int i;
-  node_t *root = create_node(NULL, result_pool);
-  construction_context_t *ctx = create_construction_context(scratch_pool);
 
-  /* Use a separate sub-pool to keep memory usage tight. */
-  apr_pool_t *subpool = svn_pool_create(scratch_pool);
-
-  /* Find all ACLs for REPOSITORY.
-   * Note that repo-specific rules replace global rules,
+  /* Note that repo-specific rules replace global rules,
    * even if they don't apply to the current user. */
-  apr_array_header_t *acls = apr_array_make(subpool, authz->acls->nelts,
+  apr_array_header_t *acls = apr_array_make(result_pool, authz->acls->nelts,
                                             sizeof(authz_acl_t *));
   for (i = 0; i < authz->acls->nelts; ++i)
     {
@@ -920,6 +981,26 @@ create_user_authz(authz_full_t *authz,
         }
     }
 
+  return acls;
+}
+
+/* From the ACLS for REPOSITORY, as returned by get_repos_acls, extract the
+ * parts relevant to USER.  Return the filtered rule tree.
+ */
+static node_t *
+create_user_authz(const apr_array_header_t *acls,
+                  const char *repository,
+                  const char *user,
+                  apr_pool_t *result_pool,
+                  apr_pool_t *scratch_pool)
+{
+  int i;
+  node_t *root = create_node(NULL, result_pool);
+  construction_context_t *ctx = create_construction_context(scratch_pool);
+
+  /* Use a separate sub-pool to keep memory usage tight. */
+  apr_pool_t *subpool = svn_pool_create(scratch_pool);
+
   /* Filtering and tree construction. */
   for (i = 0; i < acls->nelts; ++i)
     process_acl(ctx, APR_ARRAY_IDX(acls, i, const authz_acl_t *),
@@ -967,6 +1048,23 @@ create_user_authz(authz_full_t *authz,
 
 /*** Lookup. ***/
 
+/* The nodes and rights that apply to a parent path in a previous lookup.
+ * Recording these for every parent path lets a lookup resume at the
+ * deepest common ancestor of the previous path, not only at its parent. */
+typedef struct lookup_level_t
+{
+  /* Length of the parent path this level applies to. */
+  apr_size_t path_len;
+
+  /* Rights that apply at this parent path. */
+  limited_rights_t rights;
+
+  /* Index of the first of this level's nodes in the NODES array of the
+   * lookup state.  The level's nodes extend to the first node of the next
+   * level or to the end of that array. */
+  int first_node;
+} lookup_level_t;
+
 /* Reusable lookup state object. It is easy to pass to functions and
  * recycling it between lookups saves significant setup costs. */
 typedef struct lookup_state_t
@@ -992,6 +1090,13 @@ typedef struct lookup_state_t
   /* Rights that apply at PARENT_PATH, if PARENT_PATH is not empty. */
   limited_rights_t parent_rights;
 
+  /* Array of lookup_level_t, one for every non-empty parent path of
+   * PARENT_PATH (including itself), ordered by depth. */
+  apr_array_header_t *levels;
+
+  /* The node_t * lists of all LEVELS, concatenated. */
+  apr_array_header_t *nodes;
+
 } lookup_state_t;
 
 /* Constructor for lookup_state_t. */
@@ -1002,6 +1107,8 @@ create_lookup_state(apr_pool_t *result_pool)
 
   state->next = apr_array_make(result_pool, 4, sizeof(node_t *));
   state->current = apr_array_make(result_pool, 4, sizeof(node_t *));
+  state->levels = apr_array_make(result_pool, 8, sizeof(lookup_level_t));
+  state->nodes = apr_array_make(result_pool, 16, sizeof(node_t *));
 
   /* Virtually all path segments should fit into this buffer.  If they
    * don't, the buffer gets automatically reallocated.
@@ -1018,6 +1125,41 @@ create_lookup_state(apr_pool_t *result_pool)
   return state;
 }
 
+/* Record the CURRENT nodes and PARENT_RIGHTS of STATE as the level for
+ * its PARENT_PATH. */
+static void
+push_lookup_level(lookup_state_t *state)
+{
+  lookup_level_t *level = apr_array_push(state->levels);
+  int i;
+
+  level->path_len = state->parent_path->len;
+  level->rights = state->parent_rights;
+  level->first_node = state->nodes->nelts;
+
+  for (i = 0; i < state->current->nelts; ++i)
+    APR_ARRAY_PUSH(state->nodes, node_t *)
+      = APR_ARRAY_IDX(state->current, i, node_t *);
+}
+
+/* Return the number of leading bytes that LHS of length LHS_LEN and RHS
+ * of length RHS_LEN have in common. */
+static apr_size_t
+common_prefix_len(const char *lhs,
+                  apr_size_t lhs_len,
+                  const char *rhs,
+                  apr_size_t rhs_len)
+{
+  apr_size_t len = MIN(lhs_len, rhs_len);
+  apr_size_t i;
+
+  for (i = 0; i < len; ++i)
+    if (lhs[i] != rhs[i])
+      break;
+
+  return i;
+}
+
 /* Clear the current contents of STATE and re-initialize it for ROOT.
  * Check whether we can reuse a previous parent path lookup to shorten
  * the current PATH walk.  Return the full or remaining portion of
@@ -1028,18 +1170,50 @@ init_lockup_state(lookup_state_t *state,
                   const char *path)
 {
   apr_size_t len = strlen(path);
-  if (   (len > state->parent_path->len)
-      && state->parent_path->len
-      && (path[state->parent_path->len] == '/')
-      && !memcmp(path, state->parent_path->data, state->parent_path->len))
+  apr_size_t common = common_prefix_len(path, len, state->parent_path->data,
+                                        state->parent_path->len);
+  int i;
+
+  /* Find the deepest parent path of the previous lookup that is also a
+   * parent path of PATH.  Paths that are siblings or cousins of previous
+   * ones, as in the changed paths list of a revision, will only walk
+   * the part of the tree below their common ancestor. */
+  for (i = state->levels->nelts - 1; i >= 0; --i)
     {
-      /* The PARENT_PATH of the previous lookup is actually a parent path
-       * of PATH.  The CURRENT node list already matches the parent path
-       * and we only have to set the correct rights info. */
-      state->rights = state->parent_rights;
+      const lookup_level_t *level
+        = &APR_ARRAY_IDX(state->levels, i, lookup_level_t);
 
-      /* Tell the caller where to proceed. */
-      return path + state->parent_path->len;
+      if (level->path_len <= common && path[level->path_len] == '/')
+        {
+          int last = state->levels->nelts - 1;
+          int k;
+
+          /* If the level is that of the previous PARENT_PATH, the CURRENT
+           * node list already matches it.  Otherwise, restore the level's
+           * node list and forget about the deeper levels. */
+          if (i < last)
+            {
+              int end = APR_ARRAY_IDX(state->levels, i + 1,
+                                      lookup_level_t).first_node;
+
+              apr_array_clear(state->current);
+              for (k = level->first_node; k < end; ++k)
+                APR_ARRAY_PUSH(state->current, node_t *)
+                  = APR_ARRAY_IDX(state->nodes, k, node_t *);
+
+              state->nodes->nelts = end;
+              state->levels->nelts = i + 1;
+              svn_stringbuf_chop(state->parent_path,
+                                 state->parent_path->len - level->path_len);
+              state->parent_rights = level->rights;
+            }
+
+          /* We only have to set the correct rights info. */
+          state->rights = state->parent_rights;
+
+          /* Tell the caller where to proceed. */
+          return path + state->parent_path->len;
+        }
     }
 
   /* Start lookup at ROOT for the full PATH. */
@@ -1063,6 +1237,8 @@ init_lockup_state(lookup_state_t *state,
 
   svn_stringbuf_setempty(state->parent_path);
   svn_stringbuf_setempty(state->scratch_pad);
+  apr_array_clear(state->levels);
+  apr_array_clear(state->nodes);
 
   return path;
 }
@@ -1359,6 +1535,7 @@ lookup(lookup_state_t *state,
 
           /* In STATE, PARENT_PATH, PARENT_RIGHTS and CURRENT are now in sync. */
           state->parent_rights = state->rights;
+          push_lookup_level(state);
         }
     }
 
@@ -1479,7 +1656,8 @@ filter_tree(svn_authz_t *authz,
   const char *user = authz->filtered->user;
   node_t *root;
 
-  if (filtered_pool)
+  /* Models parsed from streams have no ID and can't be cached. */
+  if (filtered_pool && authz->authz_id)
     {
       svn_membuf_t *key = construct_filtered_key(repos_name, user,
                                                  authz->authz_id,
@@ -1492,24 +1670,50 @@ filter_tree(svn_authz_t *authz,
       if (!root)
         {
           apr_pool_t *item_pool = svn_object_pool__new_item_pool(authz_pool);
-          authz_full_t *add_ref = NULL;
-
-          /* Make sure the underlying full authz object lives as long as the
-           * filtered one that we are about to create.  We do this by adding
-           * a reference to it in ITEM_POOL (which may live longer than AUTHZ).
-           *
-           * Note that we already have a reference to that full authz in
-           * AUTHZ->FULL. Assert that we actually don't created multiple
-           * instances of the same full model.
-           */
-          svn_error_clear(svn_object_pool__lookup((void **)&add_ref,
-                                                  authz_pool, authz->authz_id,
-                                                  item_pool));
-          SVN_ERR_ASSERT(add_ref == authz->full);
-
-          /* Now construct the new filtered tree and cache it. */
-          root = create_user_authz(authz->full, repos_name, user, item_pool,
-                                   scratch_pool);
+          apr_array_header_t *acls = get_repos_acls(authz->full, repos_name,
+                                                    scratch_pool);
+          svn_membuf_t *rules_key = construct_rules_key(acls, repos_name,
+                                                        user,
+                                                        authz->authz_id,
+                                                        scratch_pool,
+                                                        scratch_pool);
+
+          /* Another user with the same rules may already have a filtered
+           * tree in this process.  Its entry for USER in the FILTERED_POOL
+           * will hold a reference to that tree in ITEM_POOL. */
+          SVN_ERR(svn_object_pool__lookup((void **)&root, rules_pool,
+                                          rules_key, item_pool));
+
+          if (!root)
+            {
+              apr_pool_t *rules_item_pool
+                = svn_object_pool__new_item_pool(authz_pool);
+              authz_full_t *add_ref = NULL;
+
+              /* Make sure the underlying full authz object lives as long as
+               * the filtered one that we are about to create.  We do this
+               * by adding a reference to it in RULES_ITEM_POOL (which may
+               * live longer than AUTHZ).
+               *
+               * Note that we already have a reference to that full authz in
+               * AUTHZ->FULL. Assert that we actually don't created multiple
+               * instances of the same full model.
+               */
+              svn_error_clear(svn_object_pool__lookup((void **)&add_ref,
+                                                      authz_pool,
+                                                      authz->authz_id,
+                                                      rules_item_pool));
+              SVN_ERR_ASSERT(add_ref == authz->full);
+
+              /* Now construct the new filtered tree and cache it. */
+              root = create_user_authz(acls, repos_name, user,
+                                       rules_item_pool, scratch_pool);
+              svn_error_clear(svn_object_pool__insert((void **)&root,
+                                                      rules_pool, rules_key,
+                                                      root, rules_item_pool,
+                                                      item_pool));
+            }
+
           svn_error_clear(svn_object_pool__insert((void **)&root,
                                                   filtered_pool, key, root,
                                                   item_pool, pool));
@@ -1517,8 +1721,9 @@ filter_tree(svn_authz_t *authz,
      }
   else
     {
-      root = create_user_authz(authz->full, repos_name, user, pool,
-                               scratch_pool);
+      root = create_user_authz(get_repos_acls(authz->full, repos_name,
+                                              scratch_pool),
+                               repos_name, user, pool, scratch_pool);
     }
 
   /* Write a new entry. */
@@ -1674,6 +1879,15 @@ svn_repos_authz_parse2(svn_authz_t **authz_p,
   return SVN_NO_ERROR;
 }
 
+/* Return the authz_access_t equivalent of REQUIRED_ACCESS, ignoring the
+ * svn_authz_recursive flag. */
+static authz_access_t
+required_rights(svn_repos_authz_access_t required_access)
+{
+  return ((required_access & svn_authz_read ? authz_access_read_flag : 0)
+          | (required_access & svn_authz_write ? authz_access_write_flag : 0));
+}
+
 svn_error_t *
 svn_repos_authz_check_access(svn_authz_t *authz, const char *repos_name,
                              const char *path, const char *user,
@@ -1681,9 +1895,7 @@ svn_repos_authz_check_access(svn_authz_t *authz, const char *repos_name,
                              svn_boolean_t *access_granted,
                              apr_pool_t *pool)
 {
-  const authz_access_t required =
-    ((required_access & svn_authz_read ? authz_access_read_flag : 0)
-     | (required_access & svn_authz_write ? authz_access_write_flag : 0));
+  const authz_access_t required = required_rights(required_access);
 
   /* Pick or create the suitable pre-filtered path rule tree. */
   authz_user_rules_t *rules = get_user_rules(
@@ -1736,3 +1948,111 @@ svn_repos_authz_check_access(svn_authz_t *authz, const char *repos_name,
 
   return SVN_NO_ERROR;
 }
+
+svn_error_t *
+svn_repos_authz_check_access_many(svn_authz_t *authz,
+                                  const char *repos_name,
+                                  const apr_array_header_t *paths,
+                                  const char *user,
+                                  svn_repos_authz_access_t required_access,
+                                  svn_boolean_t *access_granted,
+                                  apr_pool_t *pool)
+{
+  const authz_access_t required = required_rights(required_access);
+  const svn_boolean_t recursive = !!(required_access & svn_authz_recursive);
+  authz_user_rules_t *rules = get_user_rules(
+      authz,
+      (repos_name ? repos_name : AUTHZ_ANY_REPOSITORY),
+      user);
+  int i;
+
+  /* With uniform access to the repository, all paths get the same
+   * answer. */
+  if (   (rules->global_rights.min_access & required) == required
+      || (rules->global_rights.max_access & required) != required)
+    {
+      svn_boolean_t granted
+        = (rules->global_rights.min_access & required) == required;
+
+      for (i = 0; i < paths->nelts; ++i)
+        access_granted[i] = granted;
+
+      return SVN_NO_ERROR;
+    }
+
+  /* Did we already filter the data model? */
+  if (!rules->root)
+    SVN_ERR(filter_tree(authz, pool));
+
+  /* Consecutive lookups share the walk down to their common parent. */
+  for (i = 0; i < paths->nelts; ++i)
+    {
+      const char *path = APR_ARRAY_IDX(paths, i, const char *);
+
+      path = init_lockup_state(rules->lookup_state, rules->root, path);
+      SVN_ERR_ASSERT(path[0] == '/');
+
+      access_granted[i] = lookup(rules->lookup_state, path, required,
+                                 recursive, pool);
+    }
+
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_repos_authz_check_read(svn_boolean_t *allowed,
+                           svn_fs_root_t *root,
+                           const char *path,
+                           void *baton,
+                           apr_pool_t *pool)
+{
+  svn_repos_authz_read_baton_t *b = baton;
+
+  if (path[0] != '/')
+    path = svn_fspath__canonicalize(path, pool);
+
+  return svn_error_trace(svn_repos_authz_check_access(b->authz,
+                                                      b->repos_name, path,
+                                                      b->user,
+                                                      svn_authz_read,
+                                                      allowed, pool));
+}
+
+svn_error_t *
+svn_repos__authz_read_many(svn_boolean_t **readable,
+                           svn_fs_root_t *root,
+                           const apr_array_header_t *paths,
+                           svn_repos_authz_func_t authz_read_func,
+                           void *authz_read_baton,
+                           apr_pool_t *result_pool,
+                           apr_pool_t *scratch_pool)
+{
+  svn_repos_authz_read_baton_t *b = authz_read_baton;
+  apr_array_header_t *fspaths;
+  svn_boolean_t *result;
+  int i;
+
+  /* Only our own callback can be batched. */
+  *readable = NULL;
+  if (authz_read_func != svn_repos_authz_check_read)
+    return SVN_NO_ERROR;
+
+  fspaths = apr_array_make(scratch_pool, paths->nelts, sizeof(const char *));
+  for (i = 0; i < paths->nelts; ++i)
+    {
+      const char *path = APR_ARRAY_IDX(paths, i, const char *);
+      if (path[0] != '/')
+        path = svn_fspath__canonicalize(path, scratch_pool);
+
+      APR_ARRAY_PUSH(fspaths, const char *) = path;
+    }
+
+  result = apr_pcalloc(result_pool, (paths->nelts + 1) * sizeof(*result));
+  SVN_ERR(svn_repos_authz_check_access_many(b->authz, b->repos_name,
+                                            fspaths, b->user,
+                                            svn_authz_read, result,
+                                            scratch_pool));
+
+  *readable = result;
+  return SVN_NO_ERROR;
+}
@@ -45,6 +45,8 @@
 #include "private/svn_utf_private.h"
 #include "private/svn_cache.h"
 #include "private/svn_fspath.h"
+#include "private/svn_subr_private.h"
+#include "private/svn_task.h"
 
 #define ARE_VALID_COPY_ARGS(p,r) ((p) && SVN_IS_VALID_REVNUM(r))
 
@@ -2020,17 +2022,388 @@ dump_filter_authz_func(svn_boolean_t *allowed,
 }
 
 
+/* Implements svn_repos_notify_func_t.  Append a copy of NOTIFY to the
+ * array of svn_repos_notify_t * given as BATON.  This is used to collect
+ * notifications in worker threads for later replay in the main thread. */
+static void
+record_notification(void *baton,
+                    const svn_repos_notify_t *notify,
+                    apr_pool_t *scratch_pool)
+{
+  apr_array_header_t *notifications = baton;
+  apr_pool_t *result_pool = notifications->pool;
+  svn_repos_notify_t *copy = apr_pmemdup(result_pool, notify,
+                                         sizeof(*notify));
+
+  copy->warning_str = apr_pstrdup(result_pool, notify->warning_str);
+  copy->path = apr_pstrdup(result_pool, notify->path);
+
+  APR_ARRAY_PUSH(notifications, svn_repos_notify_t *) = copy;
+}
+
+/* Helper for svn_repos_dump_fs5.
+
+   Write revision REV of REPOS to STREAM, i.e. the revision record plus,
+   if INCLUDE_CHANGES is set, all node changes.  START_REV is the first
+   revision of the dump range; its tree gets dumped in full unless
+   INCREMENTAL has been set.  References to revisions older than
+   OLDEST_DUMPED_REV trigger warnings.  USE_DELTAS, INCLUDE_REVPROPS,
+   NOTIFY_FUNC and NOTIFY_BATON are as for svn_repos_dump_fs5.  AUTHZ_FUNC
+   and AUTHZ_BATON are passed directly to the repos layer.  Set
+   *FOUND_OLD_REFERENCE and *FOUND_OLD_MERGEINFO if the respective warnings
+   have been issued.
+
+   Use SCRATCH_POOL for temporary allocations.
+ */
+static svn_error_t *
+dump_revision(svn_stream_t *stream,
+              svn_repos_t *repos,
+              svn_revnum_t rev,
+              svn_revnum_t start_rev,
+              svn_revnum_t oldest_dumped_rev,
+              svn_boolean_t incremental,
+              svn_boolean_t use_deltas,
+              svn_boolean_t include_revprops,
+              svn_boolean_t include_changes,
+              svn_repos_authz_func_t authz_func,
+              void *authz_baton,
+              svn_boolean_t *found_old_reference,
+              svn_boolean_t *found_old_mergeinfo,
+              svn_repos_notify_func_t notify_func,
+              void *notify_baton,
+              apr_pool_t *scratch_pool)
+{
+  const svn_delta_editor_t *dump_editor;
+  void *dump_edit_baton = NULL;
+  svn_fs_t *fs = svn_repos_fs(repos);
+  svn_fs_root_t *to_root;
+  svn_boolean_t use_deltas_for_rev;
+
+  /* Write the revision record. */
+  SVN_ERR(write_revision_record(stream, repos, rev, include_revprops,
+                                authz_func, authz_baton, scratch_pool));
+
+  /* When dumping revision 0, we just write out the revision record.
+     The parser might want to use its properties.
+     If we don't want revision changes at all, skip in any case. */
+  if (rev == 0 || !include_changes)
+    return SVN_NO_ERROR;
+
+  /* Fetch the editor which dumps nodes to a file.  Regardless of
+     what we've been told, don't use deltas for the first rev of a
+     non-incremental dump. */
+  use_deltas_for_rev = use_deltas && (incremental || rev != start_rev);
+  SVN_ERR(get_dump_editor(&dump_editor, &dump_edit_baton, fs, rev,
+                          "", stream, found_old_reference,
+                          found_old_mergeinfo, NULL,
+                          notify_func, notify_baton,
+                          oldest_dumped_rev, use_deltas_for_rev,
+                          FALSE, FALSE,
+                          scratch_pool));
+
+  /* Drive the editor in one way or another. */
+  SVN_ERR(svn_fs_revision_root(&to_root, fs, rev, scratch_pool));
+
+  /* If this is the first revision of a non-incremental dump,
+     we're in for a full tree dump.  Otherwise, we want to simply
+     replay the revision.  */
+  if ((rev == start_rev) && (! incremental))
+    {
+      /* Compare against revision 0, so everything appears to be added. */
+      svn_fs_root_t *from_root;
+      SVN_ERR(svn_fs_revision_root(&from_root, fs, 0, scratch_pool));
+      SVN_ERR(svn_repos_dir_delta2(from_root, "", "",
+                                   to_root, "",
+                                   dump_editor, dump_edit_baton,
+                                   authz_func, authz_baton,
+                                   FALSE, /* don't send text-deltas */
+                                   svn_depth_infinity,
+                                   FALSE, /* don't send entry props */
+                                   FALSE, /* don't ignore ancestry */
+                                   scratch_pool));
+    }
+  else
+    {
+      /* The normal case: compare consecutive revs. */
+      SVN_ERR(svn_repos_replay2(to_root, "", SVN_INVALID_REVNUM, FALSE,
+                                dump_editor, dump_edit_baton,
+                                authz_func, authz_baton, scratch_pool));
+
+      /* While our editor close_edit implementation is a no-op, we still
+         do this for completeness. */
+      SVN_ERR(dump_editor->close_edit(dump_edit_baton, scratch_pool));
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Number of consecutive revisions rendered by a single concurrent dump
+ * task.  Larger ranges reduce the per-task overhead while smaller ones
+ * keep the buffered output and the load imbalance between threads low. */
+#define DUMP_CHUNK_SIZE 16
+
+/* Amount of dump data per task to keep in memory before spilling the
+ * remainder to a temporary file. */
+#define DUMP_SPILL_SIZE 0x400000
+
+/* Read-only parameters shared by all concurrent dump tasks. */
+typedef struct dump_task_baton_t
+{
+  /* Repository location and FS open parameters for the per-thread
+   * repository handles. */
+  const char *repos_path;
+  apr_hash_t *fs_config;
+
+  /* Revision range to dump. */
+  svn_revnum_t start_rev;
+  svn_revnum_t end_rev;
+
+  /* As passed to svn_repos__dump_fs(). */
+  svn_revnum_t oldest_dumped_rev;
+
+  /* As passed to svn_repos_dump_fs5(). */
+  svn_boolean_t incremental;
+  svn_boolean_t use_deltas;
+  svn_boolean_t include_revprops;
+  svn_boolean_t include_changes;
+  svn_repos_authz_func_t authz_func;
+  void *authz_baton;
+
+  /* Whether notifications shall be collected at all. */
+  svn_boolean_t record_notifications;
+} dump_task_baton_t;
+
+/* Rendered output of a single concurrent dump task. */
+typedef struct dump_task_result_t
+{
+  /* The dump data of all revisions in the task's range. */
+  svn_spillbuf_t *buffer;
+
+  /* Notifications issued while dumping, svn_repos_notify_t *, including
+   * the svn_repos_notify_dump_rev_end notifications. */
+  apr_array_header_t *notifications;
+
+  /* Set if the respective warnings have been issued for this range. */
+  svn_boolean_t found_old_reference;
+  svn_boolean_t found_old_mergeinfo;
+} dump_task_result_t;
+
+/* Baton for the output function of concurrent dumps. */
+typedef struct dump_output_baton_t
+{
+  /* Target stream, as passed to svn_repos_dump_fs5(). */
+  svn_stream_t *stream;
+
+  /* As passed to svn_repos_dump_fs5(). */
+  svn_repos_notify_func_t notify_func;
+  void *notify_baton;
+
+  /* Accumulated warning flags of all ranges written so far. */
+  svn_boolean_t found_old_reference;
+  svn_boolean_t found_old_mergeinfo;
+} dump_output_baton_t;
+
+/* Implements svn_task__thread_context_constructor_t.  Open a private
+ * repository handle for the dump_task_baton_t BATON. */
+static svn_error_t *
+dump_thread_context_create(void **thread_context,
+                           void *baton,
+                           apr_pool_t *result_pool,
+                           apr_pool_t *scratch_pool)
+{
+  dump_task_baton_t *task_baton = baton;
+  svn_repos_t *repos;
+
+  SVN_ERR(svn_repos_open3(&repos, task_baton->repos_path,
+                          task_baton->fs_config, result_pool,
+                          scratch_pool));
+
+  *thread_context = repos;
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_task__process_func_t.  Render the TASK_INDEX-th range
+ * of DUMP_CHUNK_SIZE revisions into a spill buffer. */
+static svn_error_t *
+dump_range_task(void **result_p,
+                apr_size_t task_index,
+                void *baton,
+                void *thread_context,
+                svn_cancel_func_t cancel_func,
+                void *cancel_baton,
+                apr_pool_t *result_pool,
+                apr_pool_t *scratch_pool)
+{
+  dump_task_baton_t *task_baton = baton;
+  svn_repos_t *repos = thread_context;
+  dump_task_result_t *result = apr_pcalloc(result_pool, sizeof(*result));
+  apr_pool_t *iterpool = svn_pool_create(scratch_pool);
+  svn_repos_notify_t *notify
+    = svn_repos_notify_create(svn_repos_notify_dump_rev_end, scratch_pool);
+  svn_stream_t *stream;
+  svn_revnum_t start = task_baton->start_rev
+                     + (svn_revnum_t)task_index * DUMP_CHUNK_SIZE;
+  svn_revnum_t end = start + DUMP_CHUNK_SIZE - 1;
+  svn_revnum_t rev;
+
+  if (end > task_baton->end_rev)
+    end = task_baton->end_rev;
+
+  result->buffer = svn_spillbuf__create(SVN__STREAM_CHUNK_SIZE,
+                                        DUMP_SPILL_SIZE, result_pool);
+  result->notifications = apr_array_make(result_pool, 0,
+                                         sizeof(svn_repos_notify_t *));
+  stream = svn_stream__from_spillbuf(result->buffer, scratch_pool);
+
+  for (rev = start; rev <= end; ++rev)
+    {
+      svn_pool_clear(iterpool);
+
+      if (cancel_func)
+        SVN_ERR(cancel_func(cancel_baton));
+
+      /* START_REV is that of the whole dump, not of this range, such
+       * that full-tree dumps, delta bases and "old reference" checks
+       * come out exactly as in a sequential dump. */
+      SVN_ERR(dump_revision(stream, repos, rev, task_baton->start_rev,
+                            task_baton->oldest_dumped_rev,
+                            task_baton->incremental,
+                            task_baton->use_deltas,
+                            task_baton->include_revprops,
+                            task_baton->include_changes,
+                            task_baton->authz_func,
+                            task_baton->authz_baton,
+                            &result->found_old_reference,
+                            &result->found_old_mergeinfo,
+                            task_baton->record_notifications
+                              ? record_notification : NULL,
+                            result->notifications,
+                            iterpool));
+
+      if (task_baton->record_notifications)
+        {
+          notify->revision = rev;
+          record_notification(result->notifications, notify, iterpool);
+        }
+    }
+
+  svn_pool_destroy(iterpool);
+  *result_p = result;
+
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_task__output_func_t.  Append the dump data of the
+ * TASK_INDEX-th range to the target stream and replay its notifications.
+ */
+static svn_error_t *
+output_dumped_range(void *baton,
+                    apr_size_t task_index,
+                    void *result_p,
+                    svn_cancel_func_t cancel_func,
+                    void *cancel_baton,
+                    apr_pool_t *scratch_pool)
+{
+  dump_output_baton_t *output_baton = baton;
+  dump_task_result_t *result = result_p;
+  int i;
+
+  SVN_ERR(svn_stream_copy3(svn_stream__from_spillbuf(result->buffer,
+                                                     scratch_pool),
+                           svn_stream_disown(output_baton->stream,
+                                             scratch_pool),
+                           cancel_func, cancel_baton, scratch_pool));
+
+  if (output_baton->notify_func)
+    for (i = 0; i < result->notifications->nelts; ++i)
+      output_baton->notify_func(output_baton->notify_baton,
+                                APR_ARRAY_IDX(result->notifications, i,
+                                              svn_repos_notify_t *),
+                                scratch_pool);
+
+  output_baton->found_old_reference |= result->found_old_reference;
+  output_baton->found_old_mergeinfo |= result->found_old_mergeinfo;
+
+  return SVN_NO_ERROR;
+}
+
+/* Dump revisions START_REV to END_REV of REPOS to STREAM using up to JOBS
+ * threads.  Ranges of DUMP_CHUNK_SIZE revisions get rendered into spill
+ * buffers by the workers and are then written to STREAM in revision order.
+ * The output is identical to that of a sequential dump.
+ *
+ * The other parameters are as for dump_revision, with AUTHZ_FUNC and
+ * AUTHZ_BATON being called from multiple threads.  Use SCRATCH_POOL for
+ * temporary allocations.
+ */
+static svn_error_t *
+dump_concurrently(svn_repos_t *repos,
+                  svn_stream_t *stream,
+                  svn_revnum_t start_rev,
+                  svn_revnum_t end_rev,
+                  svn_revnum_t oldest_dumped_rev,
+                  svn_boolean_t incremental,
+                  svn_boolean_t use_deltas,
+                  svn_boolean_t include_revprops,
+                  svn_boolean_t include_changes,
+                  int jobs,
+                  svn_repos_authz_func_t authz_func,
+                  void *authz_baton,
+                  svn_boolean_t *found_old_reference,
+                  svn_boolean_t *found_old_mergeinfo,
+                  svn_repos_notify_func_t notify_func,
+                  void *notify_baton,
+                  svn_cancel_func_t cancel_func,
+                  void *cancel_baton,
+                  apr_pool_t *scratch_pool)
+{
+  dump_task_baton_t task_baton = { 0 };
+  dump_output_baton_t output_baton = { 0 };
+  apr_size_t task_count = (apr_size_t)(end_rev - start_rev)
+                        / DUMP_CHUNK_SIZE + 1;
+
+  task_baton.repos_path = svn_repos_path(repos, scratch_pool);
+  task_baton.fs_config = svn_fs_config(svn_repos_fs(repos), scratch_pool);
+  task_baton.start_rev = start_rev;
+  task_baton.end_rev = end_rev;
+  task_baton.oldest_dumped_rev = oldest_dumped_rev;
+  task_baton.incremental = incremental;
+  task_baton.use_deltas = use_deltas;
+  task_baton.include_revprops = include_revprops;
+  task_baton.include_changes = include_changes;
+  task_baton.authz_func = authz_func;
+  task_baton.authz_baton = authz_baton;
+  task_baton.record_notifications = notify_func != NULL;
+
+  output_baton.stream = stream;
+  output_baton.notify_func = notify_func;
+  output_baton.notify_baton = notify_baton;
+
+  SVN_ERR(svn_task__run(jobs, task_count,
+                        dump_range_task, &task_baton,
+                        output_dumped_range, &output_baton,
+                        dump_thread_context_create, &task_baton,
+                        cancel_func, cancel_baton, scratch_pool));
+
+  *found_old_reference |= output_baton.found_old_reference;
+  *found_old_mergeinfo |= output_baton.found_old_mergeinfo;
+
+  return SVN_NO_ERROR;
+}
+
 
 /* The main dumper. */
 svn_error_t *
-svn_repos_dump_fs4(svn_repos_t *repos,
+svn_repos__dump_fs(svn_repos_t *repos,
                    svn_stream_t *stream,
                    svn_revnum_t start_rev,
                    svn_revnum_t end_rev,
+                   svn_revnum_t oldest_dumped_rev,
                    svn_boolean_t incremental,
                    svn_boolean_t use_deltas,
                    svn_boolean_t include_revprops,
                    svn_boolean_t include_changes,
+                   int jobs,
                    svn_repos_notify_func_t notify_func,
                    void *notify_baton,
                    svn_repos_dump_filter_func_t filter_func,
@@ -2039,8 +2412,6 @@ svn_repos_dump_fs4(svn_repos_t *repos,
                    void *cancel_baton,
                    apr_pool_t *pool)
 {
-  const svn_delta_editor_t *dump_editor;
-  void *dump_edit_baton = NULL;
   svn_revnum_t rev;
   svn_fs_t *fs = svn_repos_fs(repos);
   apr_pool_t *iterpool = svn_pool_create(pool);
@@ -2080,6 +2451,16 @@ svn_repos_dump_fs4(svn_repos_t *repos,
                                "(youngest revision is %ld)"),
                              end_rev, youngest);
 
+  /* References to anything before START_REV can only be valid if some
+     other dump provides those revisions. */
+  if (!SVN_IS_VALID_REVNUM(oldest_dumped_rev) || !incremental)
+    oldest_dumped_rev = start_rev;
+  else if (oldest_dumped_rev > start_rev)
+    return svn_error_createf(SVN_ERR_REPOS_BAD_ARGS, NULL,
+                             _("Oldest dumped revision %ld"
+                               " is greater than start revision %ld"),
+                             oldest_dumped_rev, start_rev);
+
   /* We use read authz callback to implement dump filtering. If there is no
    * read access for some node, it will be excluded from dump as well as
    * references to it (e.g. copy source). */
@@ -2108,82 +2489,46 @@ svn_repos_dump_fs4(svn_repos_t *repos,
   SVN_ERR(svn_repos__dump_magic_header_record(stream, version, pool));
   SVN_ERR(svn_repos__dump_uuid_header_record(stream, uuid, pool));
 
-  /* Create a notify object that we can reuse in the loop. */
-  if (notify_func)
-    notify = svn_repos_notify_create(svn_repos_notify_dump_rev_end,
-                                     pool);
-
-  /* Main loop:  we're going to dump revision REV.  */
-  for (rev = start_rev; rev <= end_rev; rev++)
+  if (jobs > 1 && end_rev > start_rev)
+    {
+      SVN_ERR(dump_concurrently(repos, stream, start_rev, end_rev,
+                                oldest_dumped_rev, incremental,
+                                use_deltas, include_revprops,
+                                include_changes, jobs,
+                                authz_func, &authz_baton,
+                                &found_old_reference, &found_old_mergeinfo,
+                                notify_func, notify_baton,
+                                cancel_func, cancel_baton, iterpool));
+    }
+  else
     {
-      svn_fs_root_t *to_root;
-      svn_boolean_t use_deltas_for_rev;
+      /* Create a notify object that we can reuse in the loop. */
+      if (notify_func)
+        notify = svn_repos_notify_create(svn_repos_notify_dump_rev_end,
+                                         pool);
 
-      svn_pool_clear(iterpool);
+      /* Main loop:  we're going to dump revision REV.  */
+      for (rev = start_rev; rev <= end_rev; rev++)
+        {
+          svn_pool_clear(iterpool);
 
-      /* Check for cancellation. */
-      if (cancel_func)
-        SVN_ERR(cancel_func(cancel_baton));
+          /* Check for cancellation. */
+          if (cancel_func)
+            SVN_ERR(cancel_func(cancel_baton));
 
-      /* Write the revision record. */
-      SVN_ERR(write_revision_record(stream, repos, rev, include_revprops,
-                                    authz_func, &authz_baton, iterpool));
-
-      /* When dumping revision 0, we just write out the revision record.
-         The parser might want to use its properties.
-         If we don't want revision changes at all, skip in any case. */
-      if (rev == 0 || !include_changes)
-        goto loop_end;
-
-      /* Fetch the editor which dumps nodes to a file.  Regardless of
-         what we've been told, don't use deltas for the first rev of a
-         non-incremental dump. */
-      use_deltas_for_rev = use_deltas && (incremental || rev != start_rev);
-      SVN_ERR(get_dump_editor(&dump_editor, &dump_edit_baton, fs, rev,
-                              "", stream, &found_old_reference,
-                              &found_old_mergeinfo, NULL,
-                              notify_func, notify_baton,
-                              start_rev, use_deltas_for_rev, FALSE, FALSE,
-                              iterpool));
-
-      /* Drive the editor in one way or another. */
-      SVN_ERR(svn_fs_revision_root(&to_root, fs, rev, iterpool));
-
-      /* If this is the first revision of a non-incremental dump,
-         we're in for a full tree dump.  Otherwise, we want to simply
-         replay the revision.  */
-      if ((rev == start_rev) && (! incremental))
-        {
-          /* Compare against revision 0, so everything appears to be added. */
-          svn_fs_root_t *from_root;
-          SVN_ERR(svn_fs_revision_root(&from_root, fs, 0, iterpool));
-          SVN_ERR(svn_repos_dir_delta2(from_root, "", "",
-                                       to_root, "",
-                                       dump_editor, dump_edit_baton,
-                                       authz_func, &authz_baton,
-                                       FALSE, /* don't send text-deltas */
-                                       svn_depth_infinity,
-                                       FALSE, /* don't send entry props */
-                                       FALSE, /* don't ignore ancestry */
-                                       iterpool));
-        }
-      else
-        {
-          /* The normal case: compare consecutive revs. */
-          SVN_ERR(svn_repos_replay2(to_root, "", SVN_INVALID_REVNUM, FALSE,
-                                    dump_editor, dump_edit_baton,
-                                    authz_func, &authz_baton, iterpool));
-
-          /* While our editor close_edit implementation is a no-op, we still
-             do this for completeness. */
-          SVN_ERR(dump_editor->close_edit(dump_edit_baton, iterpool));
-        }
+          SVN_ERR(dump_revision(stream, repos, rev, start_rev,
+                                oldest_dumped_rev, incremental,
+                                use_deltas, include_revprops,
+                                include_changes,
+                                authz_func, &authz_baton,
+                                &found_old_reference, &found_old_mergeinfo,
+                                notify_func, notify_baton, iterpool));
 
-    loop_end:
-      if (notify_func)
-        {
-          notify->revision = rev;
-          notify_func(notify_baton, notify, iterpool);
+          if (notify_func)
+            {
+              notify->revision = rev;
+              notify_func(notify_baton, notify, iterpool);
+            }
         }
     }
 
@@ -2225,6 +2570,35 @@ svn_repos_dump_fs4(svn_repos_t *repos,
   return SVN_NO_ERROR;
 }
 
+svn_error_t *
+svn_repos_dump_fs5(svn_repos_t *repos,
+                   svn_stream_t *stream,
+                   svn_revnum_t start_rev,
+                   svn_revnum_t end_rev,
+                   svn_boolean_t incremental,
+                   svn_boolean_t use_deltas,
+                   svn_boolean_t include_revprops,
+                   svn_boolean_t include_changes,
+                   int jobs,
+                   svn_repos_notify_func_t notify_func,
+                   void *notify_baton,
+                   svn_repos_dump_filter_func_t filter_func,
+                   void *filter_baton,
+                   svn_cancel_func_t cancel_func,
+                   void *cancel_baton,
+                   apr_pool_t *pool)
+{
+  return svn_error_trace(svn_repos__dump_fs(repos, stream, start_rev,
+                                            end_rev, SVN_INVALID_REVNUM,
+                                            incremental, use_deltas,
+                                            include_revprops,
+                                            include_changes, jobs,
+                                            notify_func, notify_baton,
+                                            filter_func, filter_baton,
+                                            cancel_func, cancel_baton,
+                                            pool));
+}
+
 
 /*----------------------------------------------------------------------*/
 
@@ -2459,12 +2833,435 @@ report_error(svn_revnum_t revision,
     }
 }
 
+/* Read-only parameters shared by all concurrent verification tasks. */
+typedef struct verify_task_baton_t
+{
+  /* Filesystem location and open parameters for the per-thread FS. */
+  const char *fs_path;
+  apr_hash_t *fs_config;
+
+  /* Revision range to verify. */
+  svn_revnum_t start_rev;
+  svn_revnum_t end_rev;
+
+  /* Number of revisions per backend-specific verification task.  Chunks
+   * start at multiples of this.  0 means a single chunk. */
+  svn_revnum_t chunk_size;
+
+  /* As passed to svn_repos_verify_fs4(). */
+  svn_boolean_t check_normalization;
+
+  /* Whether notifications shall be collected at all. */
+  svn_boolean_t record_notifications;
+} verify_task_baton_t;
+
+/* Result of a single verification task.  The notifications get collected
+ * while the task runs in some worker thread and will later be replayed
+ * in the calling thread. */
+typedef struct verify_task_result_t
+{
+  /* Repository notifications, svn_repos_notify_t *. */
+  apr_array_header_t *notifications;
+
+  /* FS progress notifications, i.e. revision numbers (svn_revnum_t). */
+  apr_array_header_t *fs_progress;
+
+  /* FS warnings, svn_error_t *. */
+  apr_array_header_t *warnings;
+
+  /* Verification failure or SVN_NO_ERROR. */
+  svn_error_t *err;
+} verify_task_result_t;
+
+/* Per-thread data for the revision verification tasks. */
+typedef struct verify_thread_context_t
+{
+  /* Private filesystem handle of the current thread. */
+  svn_fs_t *fs;
+
+  /* Result of the task currently being processed in this thread. */
+  verify_task_result_t *current;
+} verify_thread_context_t;
+
+/* Baton for the output function of concurrent verification. */
+typedef struct verify_output_baton_t
+{
+  /* First revision of the task's range. */
+  svn_revnum_t start_rev;
+
+  /* As passed to svn_repos_verify_fs4(). */
+  svn_repos_notify_func_t notify_func;
+  void *notify_baton;
+  svn_repos_verify_callback_t verify_callback;
+  void *verify_baton;
+
+  /* Warning callback of the caller's filesystem. */
+  svn_fs_warning_callback_t warning_func;
+  void *warning_baton;
+
+  /* Reusable notification objects. */
+  svn_repos_notify_t *rev_end_notify;
+  svn_fs_progress_notify_func_t verify_notify;
+  struct verify_fs_notify_func_baton_t *verify_notify_baton;
+
+  /* Set once a backend-specific verification error has been reported. */
+  svn_boolean_t fs_failed;
+} verify_output_baton_t;
+
+/* Pool cleanup function for verify_task_result_t instances in DATA.
+ * Make sure we don't leak errors that never got reported. */
+static apr_status_t
+clear_verify_task_result(void *data)
+{
+  verify_task_result_t *result = data;
+  int i;
+
+  svn_error_clear(result->err);
+  result->err = SVN_NO_ERROR;
+
+  for (i = 0; i < result->warnings->nelts; ++i)
+    svn_error_clear(APR_ARRAY_IDX(result->warnings, i, svn_error_t *));
+  apr_array_clear(result->warnings);
+
+  return APR_SUCCESS;
+}
+
+/* Return a new, empty verify_task_result_t allocated in RESULT_POOL. */
+static verify_task_result_t *
+create_verify_task_result(apr_pool_t *result_pool)
+{
+  verify_task_result_t *result = apr_pcalloc(result_pool, sizeof(*result));
+  result->notifications = apr_array_make(result_pool, 0,
+                                         sizeof(svn_repos_notify_t *));
+  result->fs_progress = apr_array_make(result_pool, 0,
+                                       sizeof(svn_revnum_t));
+  result->warnings = apr_array_make(result_pool, 0, sizeof(svn_error_t *));
+  apr_pool_cleanup_register(result_pool, result, clear_verify_task_result,
+                            apr_pool_cleanup_null);
+
+  return result;
+}
+
+/* Implements svn_fs_progress_notify_func_t.  Append REVISION to the
+ * verify_task_result_t in BATON. */
+static void
+record_fs_progress(svn_revnum_t revision,
+                   void *baton,
+                   apr_pool_t *pool)
+{
+  verify_task_result_t *result = baton;
+  APR_ARRAY_PUSH(result->fs_progress, svn_revnum_t) = revision;
+}
+
+/* Implements svn_fs_warning_callback_t.  Record FS warnings in the
+ * result of the current task in the verify_thread_context_t BATON, such
+ * that they can be forwarded to the caller's filesystem later. */
+static void
+verify_thread_warning_func(void *baton,
+                           svn_error_t *err)
+{
+  verify_thread_context_t *context = baton;
+  if (context->current)
+    APR_ARRAY_PUSH(context->current->warnings, svn_error_t *)
+      = svn_error_dup(err);
+}
+
+/* Implements svn_task__thread_context_constructor_t.  Open a private
+ * filesystem handle for the verify_task_baton_t BATON. */
+static svn_error_t *
+verify_thread_context_create(void **thread_context,
+                             void *baton,
+                             apr_pool_t *result_pool,
+                             apr_pool_t *scratch_pool)
+{
+  verify_task_baton_t *task_baton = baton;
+  verify_thread_context_t *context = apr_pcalloc(result_pool,
+                                                 sizeof(*context));
+
+  SVN_ERR(svn_fs_open2(&context->fs, task_baton->fs_path,
+                       task_baton->fs_config, result_pool, scratch_pool));
+  svn_fs_set_warning_func(context->fs, verify_thread_warning_func, context);
+
+  *thread_context = context;
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_task__process_func_t.  Verify revision
+ * BATON->START_REV + TASK_INDEX. */
+static svn_error_t *
+verify_revision_task(void **result_p,
+                     apr_size_t task_index,
+                     void *baton,
+                     void *thread_context,
+                     svn_cancel_func_t cancel_func,
+                     void *cancel_baton,
+                     apr_pool_t *result_pool,
+                     apr_pool_t *scratch_pool)
+{
+  verify_task_baton_t *task_baton = baton;
+  verify_thread_context_t *context = thread_context;
+  verify_task_result_t *result = create_verify_task_result(result_pool);
+  svn_error_t *err;
+
+  context->current = result;
+  err = verify_one_revision(context->fs,
+                            task_baton->start_rev
+                              + (svn_revnum_t)task_index,
+                            task_baton->record_notifications
+                              ? record_notification : NULL,
+                            result->notifications,
+                            task_baton->start_rev,
+                            task_baton->check_normalization,
+                            cancel_func, cancel_baton,
+                            scratch_pool);
+  context->current = NULL;
+
+  result->err = svn_error_compose_create(err, result->err);
+  *result_p = result;
+
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_task__output_func_t.  Replay the notifications and
+ * report the outcome of verifying revision BATON->START_REV + TASK_INDEX
+ * like the sequential loop in svn_repos_verify_fs4() does. */
+static svn_error_t *
+output_verified_revision(void *baton,
+                         apr_size_t task_index,
+                         void *result_p,
+                         svn_cancel_func_t cancel_func,
+                         void *cancel_baton,
+                         apr_pool_t *scratch_pool)
+{
+  verify_output_baton_t *output_baton = baton;
+  verify_task_result_t *result = result_p;
+  svn_revnum_t rev = output_baton->start_rev + (svn_revnum_t)task_index;
+  svn_error_t *err = result->err;
+  int i;
+
+  result->err = SVN_NO_ERROR;
+
+  /* Warnings don't fail the verification, just like in the sequential
+   * case where they go directly to the caller's filesystem. */
+  for (i = 0; i < result->warnings->nelts; ++i)
+    {
+      svn_error_t *warning = APR_ARRAY_IDX(result->warnings, i,
+                                           svn_error_t *);
+      output_baton->warning_func(output_baton->warning_baton, warning);
+      svn_error_clear(warning);
+    }
+  apr_array_clear(result->warnings);
+
+  if (output_baton->notify_func)
+    for (i = 0; i < result->notifications->nelts; ++i)
+      output_baton->notify_func(output_baton->notify_baton,
+                                APR_ARRAY_IDX(result->notifications, i,
+                                              svn_repos_notify_t *),
+                                scratch_pool);
+
+  if (err && err->apr_err == SVN_ERR_CANCELLED)
+    {
+      return svn_error_trace(err);
+    }
+  else if (err)
+    {
+      SVN_ERR(report_error(rev, err, output_baton->verify_callback,
+                           output_baton->verify_baton, scratch_pool));
+    }
+  else if (output_baton->notify_func)
+    {
+      /* Tell the caller that we're done with this revision. */
+      output_baton->rev_end_notify->revision = rev;
+      output_baton->notify_func(output_baton->notify_baton,
+                                output_baton->rev_end_notify,
+                                scratch_pool);
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_task__process_func_t.  Run the backend-specific checks
+ * for the TASK_INDEX-th chunk of revisions within the range given by the
+ * verify_task_baton_t BATON. */
+static svn_error_t *
+verify_fs_chunk_task(void **result_p,
+                     apr_size_t task_index,
+                     void *baton,
+                     void *thread_context,
+                     svn_cancel_func_t cancel_func,
+                     void *cancel_baton,
+                     apr_pool_t *result_pool,
+                     apr_pool_t *scratch_pool)
+{
+  verify_task_baton_t *task_baton = baton;
+  verify_task_result_t *result = create_verify_task_result(result_pool);
+  svn_revnum_t chunk_size = task_baton->chunk_size;
+  svn_revnum_t start = task_baton->start_rev;
+  svn_revnum_t end = task_baton->end_rev;
+
+  if (chunk_size)
+    {
+      start = (start / chunk_size + (svn_revnum_t)task_index) * chunk_size;
+      end = MIN(start + chunk_size - 1, end);
+      start = MAX(start, task_baton->start_rev);
+    }
+
+  result->err = svn_fs_verify(task_baton->fs_path, task_baton->fs_config,
+                              start, end,
+                              task_baton->record_notifications
+                                ? record_fs_progress : NULL,
+                              result,
+                              cancel_func, cancel_baton, scratch_pool);
+  *result_p = result;
+
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_task__output_func_t.  Replay the progress notifications
+ * of a backend-specific verification chunk and report the first failure,
+ * just like a single svn_fs_verify() call over the whole range would. */
+static svn_error_t *
+output_verified_fs_chunk(void *baton,
+                         apr_size_t task_index,
+                         void *result_p,
+                         svn_cancel_func_t cancel_func,
+                         void *cancel_baton,
+                         apr_pool_t *scratch_pool)
+{
+  verify_output_baton_t *output_baton = baton;
+  verify_task_result_t *result = result_p;
+  svn_error_t *err = result->err;
+  int i;
+
+  result->err = SVN_NO_ERROR;
+
+  /* Sequential verification stops at the first error. */
+  if (output_baton->fs_failed)
+    {
+      svn_error_clear(err);
+      return SVN_NO_ERROR;
+    }
+
+  if (output_baton->verify_notify)
+    for (i = 0; i < result->fs_progress->nelts; ++i)
+      output_baton->verify_notify(APR_ARRAY_IDX(result->fs_progress, i,
+                                                svn_revnum_t),
+                                  output_baton->verify_notify_baton,
+                                  scratch_pool);
+
+  if (err && err->apr_err == SVN_ERR_CANCELLED)
+    {
+      return svn_error_trace(err);
+    }
+  else if (err)
+    {
+      output_baton->fs_failed = TRUE;
+      SVN_ERR(report_error(SVN_INVALID_REVNUM, err,
+                           output_baton->verify_callback,
+                           output_baton->verify_baton, scratch_pool));
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Set *CHUNK_SIZE to the number of revisions that the backend-specific
+ * checks for FS shall cover per task.  Tasks must not share shards as the
+ * backend would check those for each of them.  Return 0 if the checks
+ * cannot be split.  Use SCRATCH_POOL for temporary allocations. */
+static svn_error_t *
+get_verify_chunk_size(svn_revnum_t *chunk_size,
+                      svn_fs_t *fs,
+                      apr_pool_t *scratch_pool)
+{
+  const svn_fs_info_placeholder_t *info;
+
+  SVN_ERR(svn_fs_info(&info, fs, scratch_pool, scratch_pool));
+  if (strcmp(info->fs_type, SVN_FS_TYPE_FSFS) == 0)
+    *chunk_size = ((const svn_fs_fsfs_info_t *)info)->shard_size;
+  else if (strcmp(info->fs_type, SVN_FS_TYPE_FSX) == 0)
+    *chunk_size = ((const svn_fs_fsx_info_t *)info)->shard_size;
+  else
+    *chunk_size = 0;
+
+  return SVN_NO_ERROR;
+}
+
+/* Run the backend-specific and per-revision checks of
+ * svn_repos_verify_fs4() on up to JOBS threads.  The parameters are the
+ * same as for svn_repos_verify_fs4() with the revision range already
+ * validated.  VERIFY_NOTIFY and VERIFY_NOTIFY_BATON forward FS progress
+ * notifications. */
+static svn_error_t *
+verify_fs_concurrently(svn_fs_t *fs,
+                       svn_revnum_t start_rev,
+                       svn_revnum_t end_rev,
+                       svn_boolean_t check_normalization,
+                       svn_boolean_t metadata_only,
+                       int jobs,
+                       svn_repos_notify_func_t notify_func,
+                       void *notify_baton,
+                       svn_fs_progress_notify_func_t verify_notify,
+                       struct verify_fs_notify_func_baton_t *verify_notify_baton,
+                       svn_repos_verify_callback_t verify_callback,
+                       void *verify_baton,
+                       svn_cancel_func_t cancel_func,
+                       void *cancel_baton,
+                       apr_pool_t *scratch_pool)
+{
+  verify_task_baton_t task_baton = { 0 };
+  verify_output_baton_t output_baton = { 0 };
+  apr_size_t chunk_count;
+
+  task_baton.fs_path = svn_fs_path(fs, scratch_pool);
+  task_baton.fs_config = svn_fs_config(fs, scratch_pool);
+  task_baton.start_rev = start_rev;
+  task_baton.end_rev = end_rev;
+  task_baton.check_normalization = check_normalization;
+  SVN_ERR(get_verify_chunk_size(&task_baton.chunk_size, fs, scratch_pool));
+  task_baton.record_notifications = notify_func != NULL;
+
+  output_baton.start_rev = start_rev;
+  output_baton.notify_func = notify_func;
+  output_baton.notify_baton = notify_baton;
+  output_baton.verify_callback = verify_callback;
+  output_baton.verify_baton = verify_baton;
+  svn_fs__get_warning_func(&output_baton.warning_func,
+                           &output_baton.warning_baton, fs);
+  output_baton.verify_notify = verify_notify;
+  output_baton.verify_notify_baton = verify_notify_baton;
+  if (notify_func)
+    output_baton.rev_end_notify
+      = svn_repos_notify_create(svn_repos_notify_verify_rev_end,
+                                scratch_pool);
+
+  /* Verify global metadata and backend-specific data first. */
+  chunk_count = task_baton.chunk_size
+              ? (apr_size_t)(end_rev / task_baton.chunk_size
+                             - start_rev / task_baton.chunk_size + 1)
+              : 1;
+  SVN_ERR(svn_task__run(jobs, chunk_count,
+                        verify_fs_chunk_task, &task_baton,
+                        output_verified_fs_chunk, &output_baton,
+                        NULL, NULL,
+                        cancel_func, cancel_baton, scratch_pool));
+
+  if (!metadata_only)
+    SVN_ERR(svn_task__run(jobs, (apr_size_t)(end_rev - start_rev + 1),
+                          verify_revision_task, &task_baton,
+                          output_verified_revision, &output_baton,
+                          verify_thread_context_create, &task_baton,
+                          cancel_func, cancel_baton, scratch_pool));
+
+  return SVN_NO_ERROR;
+}
+
 svn_error_t *
-svn_repos_verify_fs3(svn_repos_t *repos,
+svn_repos_verify_fs4(svn_repos_t *repos,
                      svn_revnum_t start_rev,
                      svn_revnum_t end_rev,
                      svn_boolean_t check_normalization,
                      svn_boolean_t metadata_only,
+                     int jobs,
                      svn_repos_notify_func_t notify_func,
                      void *notify_baton,
                      svn_repos_verify_callback_t verify_callback,
@@ -2521,49 +3318,61 @@ svn_repos_verify_fs3(svn_repos_t *repos,
         = svn_repos_notify_create(svn_repos_notify_verify_rev_structure, pool);
     }
 
-  /* Verify global metadata and backend-specific data first. */
-  err = svn_fs_verify(svn_fs_path(fs, pool), svn_fs_config(fs, pool),
-                      start_rev, end_rev,
-                      verify_notify, verify_notify_baton,
-                      cancel_func, cancel_baton, pool);
-
-  if (err && err->apr_err == SVN_ERR_CANCELLED)
+  if (jobs > 1)
     {
-      return svn_error_trace(err);
+      SVN_ERR(verify_fs_concurrently(fs, start_rev, end_rev,
+                                     check_normalization, metadata_only,
+                                     jobs, notify_func, notify_baton,
+                                     verify_notify, verify_notify_baton,
+                                     verify_callback, verify_baton,
+                                     cancel_func, cancel_baton, iterpool));
     }
-  else if (err)
+  else
     {
-      SVN_ERR(report_error(SVN_INVALID_REVNUM, err, verify_callback,
-                           verify_baton, iterpool));
-    }
+      /* Verify global metadata and backend-specific data first. */
+      err = svn_fs_verify(svn_fs_path(fs, pool), svn_fs_config(fs, pool),
+                          start_rev, end_rev,
+                          verify_notify, verify_notify_baton,
+                          cancel_func, cancel_baton, pool);
 
-  if (!metadata_only)
-    for (rev = start_rev; rev <= end_rev; rev++)
-      {
-        svn_pool_clear(iterpool);
-
-        /* Wrapper function to catch the possible errors. */
-        err = verify_one_revision(fs, rev, notify_func, notify_baton,
-                                  start_rev, check_normalization,
-                                  cancel_func, cancel_baton,
-                                  iterpool);
+      if (err && err->apr_err == SVN_ERR_CANCELLED)
+        {
+          return svn_error_trace(err);
+        }
+      else if (err)
+        {
+          SVN_ERR(report_error(SVN_INVALID_REVNUM, err, verify_callback,
+                               verify_baton, iterpool));
+        }
 
-        if (err && err->apr_err == SVN_ERR_CANCELLED)
+      if (!metadata_only)
+        for (rev = start_rev; rev <= end_rev; rev++)
           {
-            return svn_error_trace(err);
+            svn_pool_clear(iterpool);
+
+            /* Wrapper function to catch the possible errors. */
+            err = verify_one_revision(fs, rev, notify_func, notify_baton,
+                                      start_rev, check_normalization,
+                                      cancel_func, cancel_baton,
+                                      iterpool);
+
+            if (err && err->apr_err == SVN_ERR_CANCELLED)
+              {
+                return svn_error_trace(err);
+              }
+            else if (err)
+              {
+                SVN_ERR(report_error(rev, err, verify_callback,
+                                     verify_baton, iterpool));
+              }
+            else if (notify_func)
+              {
+                /* Tell the caller that we're done with this revision. */
+                notify->revision = rev;
+                notify_func(notify_baton, notify, iterpool);
+              }
           }
-        else if (err)
-          {
-            SVN_ERR(report_error(rev, err, verify_callback, verify_baton,
-                                 iterpool));
-          }
-        else if (notify_func)
-          {
-            /* Tell the caller that we're done with this revision. */
-            notify->revision = rev;
-            notify_func(notify_baton, notify, iterpool);
-          }
-      }
+    }
 
   /* We're done. */
   if (notify_func)
@@ -111,6 +111,12 @@ svn_repos_fs_commit_txn(const char **conflict_p,
       return err;
     }
 
+  /* Keep the changed-paths index, if any, up to date.  The commit has
+     happened anyway and the index only speeds up queries, so a failure
+     here is not reported.  It will catch up with the next commit; until
+     then, log requests simply won't use it. */
+  svn_error_clear(svn_repos__log_index_update(repos, *new_rev, pool));
+
   /* Run post-commit hooks. */
   if ((err2 = svn_repos__hooks_post_commit(repos, hooks_env,
                                            *new_rev, txn_name, pool)))
@@ -439,6 +445,13 @@ svn_repos_fs_change_rev_prop4(svn_repos_t *repos,
       SVN_ERR(svn_fs_change_rev_prop2(repos->fs, rev, name,
                                       &old_value, new_value, pool));
 
+      /* Like after a commit, a failure to update the index is not
+         reported.  Log requests won't use the index until it gets
+         rebuilt. */
+      if (strcmp(name, SVN_PROP_REVISION_DATE) == 0)
+        svn_error_clear(svn_repos__log_index_date_changed(repos, rev,
+                                                          old_value, pool));
+
       if (use_post_revprop_change_hook)
         SVN_ERR(svn_repos__hooks_post_revprop_change(repos, hooks_env, rev,
                                                      author, name, old_value,
@@ -1033,22 +1046,23 @@ pack_notify_func(void *baton,
 }
 
 svn_error_t *
-svn_repos_fs_pack2(svn_repos_t *repos,
+svn_repos_fs_pack3(svn_repos_t *repos,
+                   int jobs,
                    svn_repos_notify_func_t notify_func,
                    void *notify_baton,
                    svn_cancel_func_t cancel_func,
                    void *cancel_baton,
-                   apr_pool_t *pool)
+                   apr_pool_t *scratch_pool)
 {
   struct pack_notify_baton pnb;
 
   pnb.notify_func = notify_func;
   pnb.notify_baton = notify_baton;
 
-  return svn_fs_pack(repos->db_path,
-                     notify_func ? pack_notify_func : NULL,
-                     notify_func ? &pnb : NULL,
-                     cancel_func, cancel_baton, pool);
+  return svn_fs_pack2(repos->db_path, jobs,
+                      notify_func ? pack_notify_func : NULL,
+                      notify_func ? &pnb : NULL,
+                      cancel_func, cancel_baton, scratch_pool);
 }
 
 svn_error_t *
@@ -184,6 +184,8 @@ do_list(svn_fs_root_t *root,
   apr_pool_t *iterpool = svn_pool_create(scratch_pool);
   apr_hash_index_t *hi;
   apr_array_header_t *sorted;
+  apr_array_header_t *sub_paths;
+  svn_boolean_t *has_access = NULL;
   int i;
 
   /* Fetch all directory entries, filter and sort them.
@@ -219,6 +221,21 @@ do_list(svn_fs_root_t *root,
 
   svn_sort__array(sorted, compare_filtered_dirent);
 
+  /* Construct the full paths and check access to all of them at once. */
+  sub_paths = apr_array_make(scratch_pool, sorted->nelts,
+                             sizeof(const char *));
+  for (i = 0; i < sorted->nelts; ++i)
+    {
+      filtered_dirent_t *filtered
+        = &APR_ARRAY_IDX(sorted, i, filtered_dirent_t);
+      APR_ARRAY_PUSH(sub_paths, const char *)
+        = svn_dirent_join(path, filtered->dirent->name, scratch_pool);
+    }
+
+  SVN_ERR(svn_repos__authz_read_many(&has_access, root, sub_paths,
+                                     authz_read_func, authz_read_baton,
+                                     scratch_pool, iterpool));
+
   /* Iterate over all remaining directory entries and report them.
    * Recurse into sub-directories if requested. */
   for (i = 0; i < sorted->nelts; ++i)
@@ -233,13 +250,18 @@ do_list(svn_fs_root_t *root,
       dirent = filtered->dirent;
 
       /* Skip paths that we don't have access to? */
-      sub_path = svn_dirent_join(path, dirent->name, iterpool);
-      if (authz_read_func)
+      sub_path = APR_ARRAY_IDX(sub_paths, i, const char *);
+      if (has_access)
+        {
+          if (!has_access[i])
+            continue;
+        }
+      else if (authz_read_func)
         {
-          svn_boolean_t has_access;
-          SVN_ERR(authz_read_func(&has_access, root, sub_path,
+          svn_boolean_t readable;
+          SVN_ERR(authz_read_func(&readable, root, sub_path,
                                   authz_read_baton, iterpool));
-          if (!has_access)
+          if (!readable)
             continue;
         }
 
@@ -176,9 +176,24 @@ change_rev_prop(svn_repos_t *repos,
     return svn_repos_fs_change_rev_prop4(repos, revision, NULL, name,
                                          NULL, value, FALSE, FALSE,
                                          NULL, NULL, pool);
-  else
-    return svn_fs_change_rev_prop2(svn_repos_fs(repos), revision, name,
-                                   NULL, value, pool);
+
+  /* Keep the changed-paths index in sync when loading revprops of
+     existing revisions, like svn_repos_fs_change_rev_prop4() does. */
+  if (strcmp(name, SVN_PROP_REVISION_DATE) == 0)
+    {
+      svn_string_t *old_value;
+
+      SVN_ERR(svn_fs_revision_prop2(&old_value, svn_repos_fs(repos),
+                                    revision, name, TRUE, pool, pool));
+      SVN_ERR(svn_fs_change_rev_prop2(svn_repos_fs(repos), revision, name,
+                                      NULL, value, pool));
+      svn_error_clear(svn_repos__log_index_date_changed(repos, revision,
+                                                        old_value, pool));
+      return SVN_NO_ERROR;
+    }
+
+  return svn_fs_change_rev_prop2(svn_repos_fs(repos), revision, name,
+                                 NULL, value, pool);
 }
 
 /* Change property NAME to VALUE for PATH in TXN_ROOT.
@@ -1272,7 +1287,7 @@ svn_repos_get_fs_build_parser6(const svn_repos_parse_fns3_t **callbacks,
 
 
 svn_error_t *
-svn_repos_load_fs6(svn_repos_t *repos,
+svn_repos_load_fs7(svn_repos_t *repos,
                    svn_stream_t *dumpstream,
                    svn_revnum_t start_rev,
                    svn_revnum_t end_rev,
@@ -1283,6 +1298,7 @@ svn_repos_load_fs6(svn_repos_t *repos,
                    svn_boolean_t validate_props,
                    svn_boolean_t ignore_dates,
                    svn_boolean_t normalize_props,
+                   int jobs,
                    svn_repos_notify_func_t notify_func,
                    void *notify_baton,
                    svn_cancel_func_t cancel_func,
@@ -1309,6 +1325,13 @@ svn_repos_load_fs6(svn_repos_t *repos,
                                          notify_baton,
                                          pool));
 
+  if (jobs > 1)
+    return svn_error_trace(
+             svn_repos__parse_dumpstream_pipelined(dumpstream, parser,
+                                                   parse_baton, FALSE,
+                                                   cancel_func, cancel_baton,
+                                                   pool));
+
   return svn_repos_parse_dumpstream3(dumpstream, parser, parse_baton, FALSE,
                                      cancel_func, cancel_baton, pool);
 }
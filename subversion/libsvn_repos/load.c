@@ -22,6 +22,8 @@
 
 
 #include <apr.h>
+#include <apr_thread_proc.h>
+#include <apr_thread_cond.h>
 
 #include "svn_hash.h"
 #include "svn_pools.h"
@@ -32,7 +34,9 @@
 #include "svn_private_config.h"
 #include "svn_ctype.h"
 
+#include "private/svn_atomic.h"
 #include "private/svn_dep_compat.h"
+#include "private/svn_mutex.h"
 
 /*----------------------------------------------------------------------*/
 
@@ -832,3 +836,909 @@ svn_repos_parse_dumpstream3(svn_stream_t *stream,
   svn_pool_destroy(nodepool);
   return SVN_NO_ERROR;
 }
+
+
+/*----------------------------------------------------------------------*/
+
+/** Pipelined parsing **/
+
+/* svn_repos__parse_dumpstream_pipelined() runs svn_repos_parse_dumpstream3()
+ * in a separate thread, using a vtable that merely records all callbacks.
+ * The calling thread replays the recorded callbacks on the actual vtable.
+ * Reading the stream, parsing the records and decoding svndiff data thus
+ * overlap with whatever the actual vtable does, e.g. committing revisions.
+ *
+ * Records get handed over in batches.  Only a limited number of batches
+ * may be queued, which caps the amount of memory used by the pipeline.
+ */
+
+#if APR_HAS_THREADS
+
+/* Number of bytes after which a record batch gets handed over.  Larger
+ * batches reduce the synchronization overhead. */
+#define PIPELINE_BATCH_SIZE 0x100000
+
+/* Maximum number of batches queued up for replay.  The parser thread
+ * blocks until the replaying thread catches up. */
+#define PIPELINE_MAX_BATCHES 8
+
+/* Number of microseconds the replaying thread waits for the parser
+ * before checking for cancellation again. */
+#define PIPELINE_CANCEL_CHECK_INTERVAL 100000
+
+/* The parser callbacks that we record. */
+typedef enum record_kind_t
+{
+  record_kind_magic_header,
+  record_kind_uuid,
+  record_kind_new_revision,
+  record_kind_new_node,
+  record_kind_revision_property,
+  record_kind_node_property,
+  record_kind_delete_node_property,
+  record_kind_remove_node_props,
+  record_kind_set_fulltext,
+  record_kind_text_chunk,
+  record_kind_text_end,
+  record_kind_apply_textdelta,
+  record_kind_window,
+  record_kind_close_node,
+  record_kind_close_revision
+} record_kind_t;
+
+/* A single recorded parser callback. */
+typedef struct record_t
+{
+  /* Callback that was called. */
+  record_kind_t kind;
+
+  /* Set, if the callback received the node baton rather than the
+   * revision baton. */
+  svn_boolean_t on_node;
+
+  /* Dumpfile format version for record_magic_header. */
+  int version;
+
+  /* Headers for record_new_revision and record_new_node. */
+  apr_hash_t *headers;
+
+  /* UUID or property name. */
+  const char *name;
+
+  /* Property value or text chunk. */
+  svn_string_t *value;
+
+  /* Delta window for record_window.  NULL for the final window. */
+  svn_txdelta_window_t *window;
+
+  /* Next record in the same batch. */
+  struct record_t *next;
+} record_t;
+
+/* A sequence of records handed over from the parser thread. */
+typedef struct record_batch_t
+{
+  /* Root pool containing this structure and all records. */
+  apr_pool_t *pool;
+
+  /* Recorded callbacks, in order. */
+  record_t *first;
+  record_t *last;
+
+  /* Approximate number of bytes allocated for the records. */
+  apr_size_t size;
+
+  /* Set for the final batch of the parser run. */
+  svn_boolean_t is_last;
+
+  /* Error returned by the parser.  Only used in the final batch. */
+  svn_error_t *error;
+
+  /* Next batch in the queue. */
+  struct record_batch_t *next;
+} record_batch_t;
+
+struct pipeline_t;
+
+/* Baton passed to the recording revision and node callbacks. */
+typedef struct record_baton_t
+{
+  /* The pipeline to record into. */
+  struct pipeline_t *pipeline;
+
+  /* Whether this represents the current node or the current revision. */
+  svn_boolean_t is_node;
+
+  /* Stream to record fulltexts with. */
+  svn_stream_t *text_stream;
+} record_baton_t;
+
+/* Shared state of a pipelined parser run. */
+typedef struct pipeline_t
+{
+  /* Stream and options to pass to the parser. */
+  svn_stream_t *stream;
+  svn_boolean_t deltas_are_text;
+
+  /* Vtable recording the callbacks. */
+  svn_repos_parse_fns3_t recorder;
+
+  /* Batons handed out by the recording vtable. */
+  record_baton_t revision_baton;
+  record_baton_t node_baton;
+
+  /* Batch being recorded.  Only used by the parser thread. */
+  record_batch_t *current;
+
+  /* Completed batches, waiting to be replayed.  Protected by MUTEX. */
+  record_batch_t *first;
+  record_batch_t *last;
+  int batch_count;
+
+  /* Non-zero once the replaying thread gave up. */
+  volatile svn_atomic_t aborted;
+
+  /* Synchronization objects.  COND gets signaled whenever the queue
+   * changes or the run gets aborted. */
+  svn_mutex__t *mutex;
+  apr_thread_cond_t *cond;
+} pipeline_t;
+
+/* Implements svn_cancel_func_t for the parser thread.  BATON is the
+ * pipeline_t.  Cancel as soon as the replaying thread gave up. */
+static svn_error_t *
+pipeline_cancel_func(void *baton)
+{
+  pipeline_t *pipeline = baton;
+  if (svn_atomic_read(&pipeline->aborted))
+    return svn_error_create(SVN_ERR_CANCELLED, NULL, NULL);
+
+  return SVN_NO_ERROR;
+}
+
+/* Return a new, empty record batch. */
+static record_batch_t *
+create_batch(void)
+{
+  /* Batches get destroyed by the replaying thread. */
+  apr_pool_t *pool = svn_pool_create(NULL);
+  record_batch_t *batch = apr_pcalloc(pool, sizeof(*batch));
+  batch->pool = pool;
+
+  return batch;
+}
+
+/* Wake up all threads waiting for PIPELINE->COND. */
+static svn_error_t *
+pipeline_broadcast(pipeline_t *pipeline)
+{
+  apr_status_t status = apr_thread_cond_broadcast(pipeline->cond);
+  if (status)
+    return svn_error_wrap_apr(status, _("Can't broadcast condition variable"));
+
+  return SVN_NO_ERROR;
+}
+
+/* Append BATCH to the queue in PIPELINE.  Wait until there is room for it
+ * unless the run has been aborted.  PIPELINE->MUTEX must be held by the
+ * caller. */
+static svn_error_t *
+push_batch(pipeline_t *pipeline,
+           record_batch_t *batch)
+{
+  while (   pipeline->batch_count >= PIPELINE_MAX_BATCHES
+         && !svn_atomic_read(&pipeline->aborted))
+    {
+      apr_thread_mutex_t *mutex = svn_mutex__get(pipeline->mutex);
+      apr_status_t status = apr_thread_cond_wait(pipeline->cond, mutex);
+      if (status)
+        return svn_error_wrap_apr(status, _("Can't wait for condition"));
+    }
+
+  if (pipeline->last)
+    pipeline->last->next = batch;
+  else
+    pipeline->first = batch;
+
+  pipeline->last = batch;
+  pipeline->batch_count++;
+
+  return svn_error_trace(pipeline_broadcast(pipeline));
+}
+
+/* Set *BATCH to the first batch in the queue of PIPELINE and remove it
+ * from there.  If no batch becomes available within a short time, set
+ * *BATCH to NULL.  PIPELINE->MUTEX must be held by the caller. */
+static svn_error_t *
+pop_batch(record_batch_t **batch,
+          pipeline_t *pipeline)
+{
+  if (!pipeline->first)
+    {
+      apr_status_t status
+        = apr_thread_cond_timedwait(pipeline->cond,
+                                    svn_mutex__get(pipeline->mutex),
+                                    PIPELINE_CANCEL_CHECK_INTERVAL);
+      if (status && !APR_STATUS_IS_TIMEUP(status))
+        return svn_error_wrap_apr(status, _("Can't wait for condition"));
+    }
+
+  *batch = pipeline->first;
+  if (*batch)
+    {
+      pipeline->first = (*batch)->next;
+      if (!pipeline->first)
+        pipeline->last = NULL;
+
+      pipeline->batch_count--;
+      SVN_ERR(pipeline_broadcast(pipeline));
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Mark the run in PIPELINE as aborted and wake up the parser thread.
+ * PIPELINE->MUTEX must be held by the caller. */
+static svn_error_t *
+abort_pipeline(pipeline_t *pipeline)
+{
+  svn_atomic_set(&pipeline->aborted, TRUE);
+  return svn_error_trace(pipeline_broadcast(pipeline));
+}
+
+/* Append a new record of type KIND to the current batch in PIPELINE and
+ * return it.  SIZE is the number of bytes of payload that will be
+ * allocated for it. */
+static record_t *
+add_record(pipeline_t *pipeline,
+           record_kind_t kind,
+           apr_size_t size)
+{
+  record_batch_t *batch = pipeline->current;
+  record_t *record = apr_pcalloc(batch->pool, sizeof(*record));
+  record->kind = kind;
+
+  if (batch->last)
+    batch->last->next = record;
+  else
+    batch->first = record;
+
+  batch->last = record;
+  batch->size += sizeof(*record) + size;
+
+  return record;
+}
+
+/* Hand over the current batch in PIPELINE, if it is large enough, and
+ * start a new one.  Return SVN_ERR_CANCELLED if the run has been
+ * aborted. */
+static svn_error_t *
+finish_record(pipeline_t *pipeline)
+{
+  if (pipeline->current->size >= PIPELINE_BATCH_SIZE)
+    {
+      SVN_ERR(svn_mutex__lock(pipeline->mutex));
+      SVN_ERR(svn_mutex__unlock(pipeline->mutex,
+                                push_batch(pipeline, pipeline->current)));
+      pipeline->current = create_batch();
+    }
+
+  return svn_error_trace(pipeline_cancel_func(pipeline));
+}
+
+/* Return a deep copy of HEADERS, allocated in RESULT_POOL.  Set *SIZE to
+ * the approximate number of bytes allocated. */
+static apr_hash_t *
+copy_headers(apr_size_t *size,
+             apr_hash_t *headers,
+             apr_pool_t *result_pool)
+{
+  apr_hash_t *result = apr_hash_make(result_pool);
+  apr_hash_index_t *hi;
+
+  *size = 0;
+  for (hi = apr_hash_first(result_pool, headers); hi; hi = apr_hash_next(hi))
+    {
+      const char *name = apr_hash_this_key(hi);
+      const char *value = apr_hash_this_val(hi);
+
+      svn_hash_sets(result, apr_pstrdup(result_pool, name),
+                    apr_pstrdup(result_pool, value));
+      *size += strlen(name) + strlen(value) + 32;
+    }
+
+  return result;
+}
+
+/* Record the HEADERS of a revision or node record of type KIND into
+ * PIPELINE. */
+static svn_error_t *
+record_headers(pipeline_t *pipeline,
+               record_kind_t kind,
+               apr_hash_t *headers)
+{
+  apr_size_t size;
+  apr_hash_t *copy = copy_headers(&size, headers, pipeline->current->pool);
+  record_t *record = add_record(pipeline, kind, size);
+  record->headers = copy;
+
+  return svn_error_trace(finish_record(pipeline));
+}
+
+/* Record a callback of type KIND for BATON, a record_baton_t, with the
+ * optional NAME and VALUE. */
+static svn_error_t *
+record_simple(void *baton,
+              record_kind_t kind,
+              const char *name,
+              const svn_string_t *value)
+{
+  record_baton_t *rb = baton;
+  pipeline_t *pipeline = rb->pipeline;
+  apr_pool_t *pool = pipeline->current->pool;
+  record_t *record = add_record(pipeline, kind,
+                                  (name ? strlen(name) : 0)
+                                + (value ? value->len : 0));
+
+  record->on_node = rb->is_node;
+  record->name = name ? apr_pstrdup(pool, name) : NULL;
+  record->value = value ? svn_string_dup(value, pool) : NULL;
+
+  return svn_error_trace(finish_record(pipeline));
+}
+
+/* Implements svn_repos_parse_fns3_t.magic_header_record by recording
+ * the call. */
+static svn_error_t *
+record_magic_header_record(int version,
+                           void *parse_baton,
+                           apr_pool_t *pool)
+{
+  pipeline_t *pipeline = parse_baton;
+  record_t *record = add_record(pipeline, record_kind_magic_header, 0);
+  record->version = version;
+
+  return svn_error_trace(finish_record(pipeline));
+}
+
+/* Implements svn_repos_parse_fns3_t.uuid_record by recording the call. */
+static svn_error_t *
+record_uuid_record(const char *uuid,
+                   void *parse_baton,
+                   apr_pool_t *pool)
+{
+  pipeline_t *pipeline = parse_baton;
+  return svn_error_trace(record_simple(&pipeline->revision_baton,
+                                       record_kind_uuid, uuid, NULL));
+}
+
+/* Implements svn_repos_parse_fns3_t.new_revision_record by recording
+ * the call. */
+static svn_error_t *
+record_new_revision_record(void **revision_baton,
+                           apr_hash_t *headers,
+                           void *parse_baton,
+                           apr_pool_t *pool)
+{
+  pipeline_t *pipeline = parse_baton;
+  *revision_baton = &pipeline->revision_baton;
+
+  return svn_error_trace(record_headers(pipeline, record_kind_new_revision,
+                                        headers));
+}
+
+/* Implements svn_repos_parse_fns3_t.new_node_record by recording the
+ * call. */
+static svn_error_t *
+record_new_node_record(void **node_baton,
+                       apr_hash_t *headers,
+                       void *revision_baton,
+                       apr_pool_t *pool)
+{
+  record_baton_t *rb = revision_baton;
+  *node_baton = &rb->pipeline->node_baton;
+
+  return svn_error_trace(record_headers(rb->pipeline, record_kind_new_node,
+                                        headers));
+}
+
+/* Implements svn_repos_parse_fns3_t.set_revision_property by recording
+ * the call. */
+static svn_error_t *
+record_set_revision_property(void *revision_baton,
+                             const char *name,
+                             const svn_string_t *value)
+{
+  return svn_error_trace(record_simple(revision_baton,
+                                       record_kind_revision_property,
+                                       name, value));
+}
+
+/* Implements svn_repos_parse_fns3_t.set_node_property by recording the
+ * call. */
+static svn_error_t *
+record_set_node_property(void *node_baton,
+                         const char *name,
+                         const svn_string_t *value)
+{
+  return svn_error_trace(record_simple(node_baton,
+                                       record_kind_node_property,
+                                       name, value));
+}
+
+/* Implements svn_repos_parse_fns3_t.delete_node_property by recording
+ * the call. */
+static svn_error_t *
+record_delete_node_property(void *node_baton,
+                            const char *name)
+{
+  return svn_error_trace(record_simple(node_baton,
+                                       record_kind_delete_node_property,
+                                       name, NULL));
+}
+
+/* Implements svn_repos_parse_fns3_t.remove_node_props by recording the
+ * call. */
+static svn_error_t *
+record_remove_node_props(void *node_baton)
+{
+  return svn_error_trace(record_simple(node_baton,
+                                       record_kind_remove_node_props,
+                                       NULL, NULL));
+}
+
+/* Implements svn_write_fn_t for the streams returned by
+ * record_set_fulltext.  BATON is a record_baton_t. */
+static svn_error_t *
+record_text_write(void *baton,
+                  const char *data,
+                  apr_size_t *len)
+{
+  svn_string_t chunk;
+  chunk.data = data;
+  chunk.len = *len;
+
+  return svn_error_trace(record_simple(baton, record_kind_text_chunk, NULL,
+                                       &chunk));
+}
+
+/* Implements svn_close_fn_t for the streams returned by
+ * record_set_fulltext.  BATON is a record_baton_t. */
+static svn_error_t *
+record_text_close(void *baton)
+{
+  return svn_error_trace(record_simple(baton, record_kind_text_end,
+                                       NULL, NULL));
+}
+
+/* Implements svn_repos_parse_fns3_t.set_fulltext by recording the call
+ * and returning a stream that records all the text. */
+static svn_error_t *
+record_set_fulltext(svn_stream_t **stream,
+                    void *node_baton)
+{
+  record_baton_t *rb = node_baton;
+  *stream = rb->text_stream;
+
+  return svn_error_trace(record_simple(node_baton,
+                                       record_kind_set_fulltext,
+                                       NULL, NULL));
+}
+
+/* Implements svn_txdelta_window_handler_t for record_apply_textdelta.
+ * BATON is a record_baton_t. */
+static svn_error_t *
+record_window_handler(svn_txdelta_window_t *window,
+                      void *baton)
+{
+  record_baton_t *rb = baton;
+  pipeline_t *pipeline = rb->pipeline;
+  record_t *record
+    = add_record(pipeline, record_kind_window,
+                 window ? window->new_data->len
+                          + window->num_ops * sizeof(*window->ops)
+                        : 0);
+
+  record->on_node = rb->is_node;
+  record->window = window
+                 ? svn_txdelta_window_dup(window, pipeline->current->pool)
+                 : NULL;
+
+  return svn_error_trace(finish_record(pipeline));
+}
+
+/* Implements svn_repos_parse_fns3_t.apply_textdelta by recording the
+ * call and returning a handler that records all windows. */
+static svn_error_t *
+record_apply_textdelta(svn_txdelta_window_handler_t *handler,
+                       void **handler_baton,
+                       void *node_baton)
+{
+  *handler = record_window_handler;
+  *handler_baton = node_baton;
+
+  return svn_error_trace(record_simple(node_baton,
+                                       record_kind_apply_textdelta,
+                                       NULL, NULL));
+}
+
+/* Implements svn_repos_parse_fns3_t.close_node by recording the call. */
+static svn_error_t *
+record_close_node(void *node_baton)
+{
+  return svn_error_trace(record_simple(node_baton,
+                                       record_kind_close_node,
+                                       NULL, NULL));
+}
+
+/* Implements svn_repos_parse_fns3_t.close_revision by recording the
+ * call. */
+static svn_error_t *
+record_close_revision(void *revision_baton)
+{
+  return svn_error_trace(record_simple(revision_baton,
+                                       record_kind_close_revision,
+                                       NULL, NULL));
+}
+
+/* Set the recording callbacks in PIPELINE->RECORDER for all callbacks
+ * that PARSE_FNS provides.  The parser treats missing callbacks
+ * differently, so we must not add any. */
+static void
+init_recorder(pipeline_t *pipeline,
+              const svn_repos_parse_fns3_t *parse_fns)
+{
+  svn_repos_parse_fns3_t *recorder = &pipeline->recorder;
+
+#define SET_RECORDER_ENTRY(entry) \
+  recorder->entry = parse_fns->entry ? record_##entry : NULL
+
+  SET_RECORDER_ENTRY(magic_header_record);
+  SET_RECORDER_ENTRY(uuid_record);
+  SET_RECORDER_ENTRY(new_revision_record);
+  SET_RECORDER_ENTRY(new_node_record);
+  SET_RECORDER_ENTRY(set_revision_property);
+  SET_RECORDER_ENTRY(set_node_property);
+  SET_RECORDER_ENTRY(delete_node_property);
+  SET_RECORDER_ENTRY(remove_node_props);
+  SET_RECORDER_ENTRY(set_fulltext);
+  SET_RECORDER_ENTRY(apply_textdelta);
+  SET_RECORDER_ENTRY(close_node);
+  SET_RECORDER_ENTRY(close_revision);
+
+#undef SET_RECORDER_ENTRY
+}
+
+/* Queue the current batch of PIPELINE as the final one, with ERR being
+ * the result of the parser run.  PIPELINE->MUTEX must be held by the
+ * caller. */
+static svn_error_t *
+push_last_batch(pipeline_t *pipeline,
+                svn_error_t *err)
+{
+  pipeline->current->is_last = TRUE;
+  pipeline->current->error = err;
+
+  return svn_error_trace(push_batch(pipeline, pipeline->current));
+}
+
+/* Thread function running the parser for the pipeline_t in DATA. */
+static void * APR_THREAD_FUNC
+parser_thread(apr_thread_t *thread,
+              void *data)
+{
+  pipeline_t *pipeline = data;
+  apr_pool_t *pool = svn_pool_create(NULL);
+  svn_error_t *parse_err;
+  svn_error_t *err;
+
+  parse_err = svn_repos_parse_dumpstream3(pipeline->stream,
+                                          &pipeline->recorder, pipeline,
+                                          pipeline->deltas_are_text,
+                                          pipeline_cancel_func, pipeline,
+                                          pool);
+
+  /* The replaying thread waits for the last batch.  If we can't queue it,
+   * it would hang, i.e. we can't do anything but give up. */
+  err = svn_mutex__lock(pipeline->mutex);
+  if (!err)
+    err = svn_mutex__unlock(pipeline->mutex,
+                            push_last_batch(pipeline, parse_err));
+  if (err)
+    SVN_ERR_MALFUNCTION_NO_RETURN();
+
+  svn_pool_destroy(pool);
+  apr_thread_exit(thread, APR_SUCCESS);
+
+  return NULL;
+}
+
+/* State of the replaying thread. */
+typedef struct replay_t
+{
+  /* Actual callbacks, all of them non-NULL, and their baton. */
+  const svn_repos_parse_fns3_t *parse_fns;
+  void *parse_baton;
+
+  /* Batons returned by the actual callbacks for the current revision
+   * and node. */
+  void *revision_baton;
+  void *node_baton;
+
+  /* Sinks for the text of the current node, if any. */
+  svn_stream_t *text_stream;
+  svn_txdelta_window_handler_t handler;
+  void *handler_baton;
+
+  /* Pools with the same lifetimes that the parser would use. */
+  apr_pool_t *pool;
+  apr_pool_t *revpool;
+  apr_pool_t *nodepool;
+} replay_t;
+
+/* Call the actual callback in REPLAY for RECORD. */
+static svn_error_t *
+replay_record(replay_t *replay,
+              const record_t *record)
+{
+  const svn_repos_parse_fns3_t *parse_fns = replay->parse_fns;
+  void *record_baton = record->on_node ? replay->node_baton
+                                       : replay->revision_baton;
+  apr_size_t size;
+
+  switch (record->kind)
+    {
+      case record_kind_magic_header:
+        return svn_error_trace(parse_fns->magic_header_record(
+                                 record->version, replay->parse_baton,
+                                 replay->pool));
+
+      case record_kind_uuid:
+        return svn_error_trace(parse_fns->uuid_record(
+                                 apr_pstrdup(replay->pool, record->name),
+                                 replay->parse_baton, replay->pool));
+
+      case record_kind_new_revision:
+        return svn_error_trace(parse_fns->new_revision_record(
+                                 &replay->revision_baton,
+                                 copy_headers(&size, record->headers,
+                                              replay->revpool),
+                                 replay->parse_baton, replay->revpool));
+
+      case record_kind_new_node:
+        return svn_error_trace(parse_fns->new_node_record(
+                                 &replay->node_baton,
+                                 copy_headers(&size, record->headers,
+                                              replay->nodepool),
+                                 replay->revision_baton,
+                                 replay->nodepool));
+
+      case record_kind_revision_property:
+        return svn_error_trace(parse_fns->set_revision_property(
+                                 record_baton, record->name,
+                                 record->value));
+
+      case record_kind_node_property:
+        return svn_error_trace(parse_fns->set_node_property(
+                                 record_baton, record->name,
+                                 record->value));
+
+      case record_kind_delete_node_property:
+        return svn_error_trace(parse_fns->delete_node_property(
+                                 record_baton, record->name));
+
+      case record_kind_remove_node_props:
+        return svn_error_trace(parse_fns->remove_node_props(record_baton));
+
+      case record_kind_set_fulltext:
+        return svn_error_trace(parse_fns->set_fulltext(&replay->text_stream,
+                                                       record_baton));
+
+      case record_kind_text_chunk:
+        if (replay->text_stream)
+          {
+            apr_size_t len = record->value->len;
+            SVN_ERR(svn_stream_write(replay->text_stream,
+                                     record->value->data, &len));
+            if (len != record->value->len)
+              return svn_error_create(SVN_ERR_STREAM_UNEXPECTED_EOF, NULL,
+                                      _("Unexpected EOF writing contents"));
+          }
+        return SVN_NO_ERROR;
+
+      case record_kind_text_end:
+        if (replay->text_stream)
+          {
+            svn_stream_t *stream = replay->text_stream;
+            replay->text_stream = NULL;
+            SVN_ERR(svn_stream_close(stream));
+          }
+        return SVN_NO_ERROR;
+
+      case record_kind_apply_textdelta:
+        return svn_error_trace(parse_fns->apply_textdelta(
+                                 &replay->handler, &replay->handler_baton,
+                                 record_baton));
+
+      case record_kind_window:
+        if (replay->handler)
+          {
+            svn_txdelta_window_handler_t handler = replay->handler;
+            if (!record->window)
+              replay->handler = NULL;
+
+            SVN_ERR(handler(record->window, replay->handler_baton));
+          }
+        return SVN_NO_ERROR;
+
+      case record_kind_close_node:
+        SVN_ERR(parse_fns->close_node(replay->node_baton));
+        svn_pool_clear(replay->nodepool);
+        replay->node_baton = NULL;
+        return SVN_NO_ERROR;
+
+      case record_kind_close_revision:
+        SVN_ERR(parse_fns->close_revision(replay->revision_baton));
+        svn_pool_clear(replay->revpool);
+        replay->revision_baton = NULL;
+        return SVN_NO_ERROR;
+
+      default:
+        SVN_ERR_MALFUNCTION();
+    }
+}
+
+/* Call the actual callbacks in REPLAY for all records in BATCH. */
+static svn_error_t *
+replay_batch(replay_t *replay,
+             const record_batch_t *batch)
+{
+  const record_t *record;
+  for (record = batch->first; record; record = record->next)
+    SVN_ERR(replay_record(replay, record));
+
+  return SVN_NO_ERROR;
+}
+
+/* Replay all batches produced by the parser thread in PIPELINE on the
+ * actual callbacks in REPLAY until the final batch has been processed.
+ * Call CANCEL_FUNC with CANCEL_BATON periodically. */
+static svn_error_t *
+replay_batches(replay_t *replay,
+               pipeline_t *pipeline,
+               svn_cancel_func_t cancel_func,
+               void *cancel_baton)
+{
+  svn_boolean_t done = FALSE;
+  while (!done)
+    {
+      record_batch_t *batch;
+      svn_error_t *err;
+
+      if (cancel_func)
+        SVN_ERR(cancel_func(cancel_baton));
+
+      SVN_ERR(svn_mutex__lock(pipeline->mutex));
+      SVN_ERR(svn_mutex__unlock(pipeline->mutex,
+                                pop_batch(&batch, pipeline)));
+      if (!batch)
+        continue;
+
+      /* Callbacks precede any parser error.  So, the latter only counts
+       * if all replays succeeded. */
+      err = replay_batch(replay, batch);
+      if (batch->is_last)
+        {
+          done = TRUE;
+          if (err)
+            svn_error_clear(batch->error);
+          else
+            err = batch->error;
+        }
+
+      svn_pool_destroy(batch->pool);
+      SVN_ERR(err);
+    }
+
+  return SVN_NO_ERROR;
+}
+
+#endif
+
+svn_error_t *
+svn_repos__parse_dumpstream_pipelined(svn_stream_t *stream,
+                                      const svn_repos_parse_fns3_t *parse_fns,
+                                      void *parse_baton,
+                                      svn_boolean_t deltas_are_text,
+                                      svn_cancel_func_t cancel_func,
+                                      void *cancel_baton,
+                                      apr_pool_t *pool)
+{
+#if APR_HAS_THREADS
+  /* The pipeline will be used from multiple threads, so allocate it in
+   * a thread-safe pool. */
+  apr_pool_t *shared_pool = svn_pool_create(NULL);
+  pipeline_t *pipeline = apr_pcalloc(shared_pool, sizeof(*pipeline));
+  replay_t replay = { 0 };
+  apr_thread_t *thread;
+  apr_status_t status, retval;
+  svn_error_t *err;
+
+  pipeline->stream = stream;
+  pipeline->deltas_are_text = deltas_are_text;
+  init_recorder(pipeline, parse_fns);
+
+  pipeline->revision_baton.pipeline = pipeline;
+  pipeline->node_baton.pipeline = pipeline;
+  pipeline->node_baton.is_node = TRUE;
+  pipeline->revision_baton.text_stream
+    = svn_stream_create(&pipeline->revision_baton, shared_pool);
+  pipeline->node_baton.text_stream
+    = svn_stream_create(&pipeline->node_baton, shared_pool);
+  svn_stream_set_write(pipeline->revision_baton.text_stream,
+                       record_text_write);
+  svn_stream_set_close(pipeline->revision_baton.text_stream,
+                       record_text_close);
+  svn_stream_set_write(pipeline->node_baton.text_stream, record_text_write);
+  svn_stream_set_close(pipeline->node_baton.text_stream, record_text_close);
+
+  pipeline->current = create_batch();
+
+  SVN_ERR(svn_mutex__init(&pipeline->mutex, TRUE, shared_pool));
+  status = apr_thread_cond_create(&pipeline->cond, shared_pool);
+  if (status)
+    return svn_error_wrap_apr(status, _("Can't create condition variable"));
+
+  replay.parse_fns = complete_vtable(parse_fns, pool);
+  replay.parse_baton = parse_baton;
+  replay.pool = pool;
+  replay.revpool = svn_pool_create(pool);
+  replay.nodepool = svn_pool_create(pool);
+
+  status = apr_thread_create(&thread, NULL, parser_thread, pipeline,
+                             shared_pool);
+  if (status)
+    return svn_error_wrap_apr(status, _("Can't create thread"));
+
+  err = replay_batches(&replay, pipeline, cancel_func, cancel_baton);
+
+  /* Stop the parser thread, in case we did not replay everything. */
+  if (err)
+    {
+      svn_error_t *lock_err = svn_mutex__lock(pipeline->mutex);
+      if (!lock_err)
+        lock_err = svn_mutex__unlock(pipeline->mutex,
+                                     abort_pipeline(pipeline));
+      err = svn_error_compose_create(err, lock_err);
+    }
+
+  status = apr_thread_join(&retval, thread);
+  if (status && !err)
+    err = svn_error_wrap_apr(status, _("Can't join thread"));
+
+  /* Discard whatever has not been replayed. */
+  while (pipeline->first)
+    {
+      record_batch_t *batch = pipeline->first;
+      pipeline->first = batch->next;
+
+      svn_error_clear(batch->error);
+      svn_pool_destroy(batch->pool);
+    }
+
+  svn_pool_destroy(shared_pool);
+  if (!err)
+    {
+      svn_pool_destroy(replay.revpool);
+      svn_pool_destroy(replay.nodepool);
+    }
+
+  return svn_error_trace(err);
+#else
+  return svn_error_trace(svn_repos_parse_dumpstream3(stream, parse_fns,
+                                                     parse_baton,
+                                                     deltas_are_text,
+                                                     cancel_func,
+                                                     cancel_baton, pool));
+#endif
+}
@@ -0,0 +1,121 @@
+/* log-index-db.sql -- schema of the repository changed-paths index
+ *   This is intended for use with SQLite 3
+ *
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ */
+
+-- STMT_CREATE_SCHEMA
+/* The repository the index was built for and the youngest revision
+   it covers.  There is only ever one row, with ID 0. */
+CREATE TABLE info (
+  id INTEGER NOT NULL PRIMARY KEY,
+  uuid TEXT NOT NULL,
+  revision INTEGER NOT NULL
+  );
+
+/* One row for every indexed revision, with its svn:date.  The dates tell
+   whether the indexed revisions are still the ones in the repository,
+   e.g. after it has been restored from a backup and new revisions have
+   been committed on top of it. */
+CREATE TABLE revisions (
+  revision INTEGER NOT NULL PRIMARY KEY,
+  date TEXT
+  );
+
+/* One row for every revision in which PATH or anything below it was
+   changed.  PATH is an fspath; the root directory is not indexed
+   because it changes in every revision. */
+CREATE TABLE touched (
+  path TEXT NOT NULL,
+  revision INTEGER NOT NULL,
+  PRIMARY KEY (path, revision)
+  ) WITHOUT ROWID;
+
+/* One row for every node added or replaced at PATH in REVISION, with
+   its copy source, if any.  These are the points at which the history
+   of PATH and the paths below it starts or crosses a copy. */
+CREATE TABLE added (
+  path TEXT NOT NULL,
+  revision INTEGER NOT NULL,
+  copyfrom_path TEXT,
+  copyfrom_rev INTEGER,
+  PRIMARY KEY (path, revision)
+  ) WITHOUT ROWID;
+
+PRAGMA USER_VERSION = 1;
+
+-- STMT_GET_INFO
+SELECT uuid, revision
+FROM info
+WHERE id = 0
+
+-- STMT_SET_INFO
+INSERT OR REPLACE INTO info (id, uuid, revision)
+VALUES (0, ?1, ?2)
+
+-- STMT_ADD_REVISION
+INSERT OR REPLACE INTO revisions (revision, date)
+VALUES (?1, ?2)
+
+-- STMT_GET_REVISION_DATE
+SELECT date
+FROM revisions
+WHERE revision = ?1
+
+-- STMT_UPDATE_REVISION_DATE
+UPDATE revisions
+SET date = ?3
+WHERE revision = ?1 AND date IS ?2
+
+-- STMT_DELETE_REVISIONS_ABOVE
+DELETE FROM revisions
+WHERE revision > ?1
+
+-- STMT_DELETE_TOUCHED_ABOVE
+DELETE FROM touched
+WHERE revision > ?1
+
+-- STMT_DELETE_ADDED_ABOVE
+DELETE FROM added
+WHERE revision > ?1
+
+-- STMT_ADD_TOUCHED
+INSERT OR IGNORE INTO touched (path, revision)
+VALUES (?1, ?2)
+
+-- STMT_ADD_ADDED
+INSERT OR REPLACE INTO added (path, revision, copyfrom_path, copyfrom_rev)
+VALUES (?1, ?2, ?3, ?4)
+
+-- STMT_GET_PREV_TOUCHED
+/* The youngest revision in the range (?2, ?3] in which ?1 was touched. */
+SELECT revision
+FROM touched
+WHERE path = ?1 AND revision > ?2 AND revision <= ?3
+ORDER BY revision DESC
+LIMIT 1
+
+-- STMT_GET_PREV_ADDED
+/* The youngest addition of ?1 up to revision ?2. */
+SELECT revision, copyfrom_path, copyfrom_rev
+FROM added
+WHERE path = ?1 AND revision <= ?2
+ORDER BY revision DESC
+LIMIT 1
@@ -0,0 +1,751 @@
+/* log-index.c --- the changed-paths index used by svn_repos_get_logs5()
+ *
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ */
+
+/* The index records, for every path, the revisions in which that path
+ * or anything below it was changed ("touched"), and the revisions in
+ * which a node was added at that path, with its copy source.  That is
+ * enough to reproduce the sequence of locations that svn_fs_history_prev2()
+ * reports for a path:
+ *
+ *   - The youngest addition of the path or one of its parents marks the
+ *     oldest location of the current line of history under that name.
+ *   - Every revision younger than that in which the path was touched is
+ *     a history location, followed by the revision of the addition.
+ *   - If the addition was a copy, the history continues at the copy
+ *     source, with the path below the copied directory appended.
+ *
+ * Each step is a single lookup in the primary key of a table, so the cost
+ * does not depend on how many revisions or copies the history spans.
+ */
+
+#include <string.h>
+
+#include "svn_pools.h"
+#include "svn_dirent_uri.h"
+#include "svn_fs.h"
+#include "svn_hash.h"
+#include "svn_io.h"
+#include "svn_props.h"
+#include "svn_repos.h"
+#include "svn_sorts.h"
+
+#include "private/svn_fspath.h"
+#include "private/svn_sqlite.h"
+
+#include "repos.h"
+#include "svn_private_config.h"
+
+#include "log-index-db.h"
+
+LOG_INDEX_DB_SQL_DECLARE_STATEMENTS(statements);
+
+/* Number of revisions svn_repos_build_log_index() adds to the index in
+   a single SQLite transaction. */
+#define BUILD_BATCH_SIZE 1000
+
+struct svn_repos__log_index_t
+{
+  svn_sqlite__db_t *sdb;
+
+  /* The youngest revision covered by the index. */
+  svn_revnum_t youngest;
+};
+
+struct svn_repos__log_index_history_t
+{
+  svn_repos__log_index_t *index;
+
+  /* Don't follow copies. */
+  svn_boolean_t strict;
+
+  /* We are done with this history. */
+  svn_boolean_t done;
+
+  /* The path we currently follow and the youngest revision at which we
+     have not reported it yet. */
+  const char *path;
+  svn_revnum_t revision;
+
+  /* Whether the ADDED_* fields below are valid for PATH@REVISION. */
+  svn_boolean_t addition_known;
+
+  /* The youngest revision not younger than REVISION at which PATH or one
+     of its parents, ADDED_PATH, was added; SVN_INVALID_REVNUM if none.
+     COPYFROM_PATH and COPYFROM_REV are the copy source of that addition,
+     NULL and SVN_INVALID_REVNUM if it was not a copy. */
+  svn_revnum_t added_rev;
+  const char *added_path;
+  const char *copyfrom_path;
+  svn_revnum_t copyfrom_rev;
+
+  /* For all allocations that need to live as long as the history. */
+  apr_pool_t *pool;
+};
+
+
+/* Set *INFO_UUID and *INFO_REV to the repository UUID and the youngest
+   revision recorded in SDB.  Set *INFO_UUID to NULL if SDB has no such
+   record. */
+static svn_error_t *
+read_info(const char **info_uuid,
+          svn_revnum_t *info_rev,
+          svn_sqlite__db_t *sdb,
+          apr_pool_t *result_pool)
+{
+  svn_sqlite__stmt_t *stmt;
+  svn_boolean_t have_row;
+
+  SVN_ERR(svn_sqlite__get_statement(&stmt, sdb, STMT_GET_INFO));
+  SVN_ERR(svn_sqlite__step(&have_row, stmt));
+  if (have_row)
+    {
+      *info_uuid = svn_sqlite__column_text(stmt, 0, result_pool);
+      *info_rev = svn_sqlite__column_revnum(stmt, 1);
+    }
+  else
+    {
+      *info_uuid = NULL;
+      *info_rev = SVN_INVALID_REVNUM;
+    }
+
+  return svn_error_trace(svn_sqlite__reset(stmt));
+}
+
+/* Record that SDB covers all revisions up to REVISION of the repository
+   with the given UUID. */
+static svn_error_t *
+write_info(svn_sqlite__db_t *sdb,
+           const char *uuid,
+           svn_revnum_t revision)
+{
+  svn_sqlite__stmt_t *stmt;
+
+  SVN_ERR(svn_sqlite__get_statement(&stmt, sdb, STMT_SET_INFO));
+  SVN_ERR(svn_sqlite__bindf(stmt, "sr", uuid, revision));
+
+  return svn_error_trace(svn_sqlite__insert(NULL, stmt));
+}
+
+/* Set *DATE to the svn:date of REVISION in FS, or to NULL if there is
+   none.  Allocate it in POOL. */
+static svn_error_t *
+get_revision_date(const char **date,
+                  svn_fs_t *fs,
+                  svn_revnum_t revision,
+                  apr_pool_t *pool)
+{
+  svn_string_t *value;
+
+  SVN_ERR(svn_fs_revision_prop2(&value, fs, revision, SVN_PROP_REVISION_DATE,
+                                FALSE, pool, pool));
+  *date = value ? value->data : NULL;
+
+  return SVN_NO_ERROR;
+}
+
+/* Set *MATCHES to whether SDB has indexed REVISION of FS, as opposed to
+   some other revision with the same number, e.g. one that got replaced
+   by restoring the repository from a backup. */
+static svn_error_t *
+revision_matches(svn_boolean_t *matches,
+                 svn_sqlite__db_t *sdb,
+                 svn_fs_t *fs,
+                 svn_revnum_t revision,
+                 apr_pool_t *scratch_pool)
+{
+  svn_sqlite__stmt_t *stmt;
+  svn_boolean_t have_row;
+  const char *indexed_date;
+  const char *date;
+
+  SVN_ERR(svn_sqlite__get_statement(&stmt, sdb, STMT_GET_REVISION_DATE));
+  SVN_ERR(svn_sqlite__bindf(stmt, "r", revision));
+  SVN_ERR(svn_sqlite__step(&have_row, stmt));
+  indexed_date = have_row ? svn_sqlite__column_text(stmt, 0, scratch_pool)
+                          : NULL;
+  SVN_ERR(svn_sqlite__reset(stmt));
+
+  if (!have_row)
+    {
+      *matches = FALSE;
+      return SVN_NO_ERROR;
+    }
+
+  SVN_ERR(get_revision_date(&date, fs, revision, scratch_pool));
+  *matches = (date && indexed_date) ? strcmp(date, indexed_date) == 0
+                                    : date == indexed_date;
+
+  return SVN_NO_ERROR;
+}
+
+/* Remove all data on revisions younger than REVISION from SDB. */
+static svn_error_t *
+delete_revisions_above(svn_sqlite__db_t *sdb,
+                       svn_revnum_t revision)
+{
+  svn_sqlite__stmt_t *stmt;
+
+  SVN_ERR(svn_sqlite__get_statement(&stmt, sdb, STMT_DELETE_REVISIONS_ABOVE));
+  SVN_ERR(svn_sqlite__bindf(stmt, "r", revision));
+  SVN_ERR(svn_sqlite__update(NULL, stmt));
+
+  SVN_ERR(svn_sqlite__get_statement(&stmt, sdb, STMT_DELETE_TOUCHED_ABOVE));
+  SVN_ERR(svn_sqlite__bindf(stmt, "r", revision));
+  SVN_ERR(svn_sqlite__update(NULL, stmt));
+
+  SVN_ERR(svn_sqlite__get_statement(&stmt, sdb, STMT_DELETE_ADDED_ABOVE));
+  SVN_ERR(svn_sqlite__bindf(stmt, "r", revision));
+  SVN_ERR(svn_sqlite__update(NULL, stmt));
+
+  return SVN_NO_ERROR;
+}
+
+/* Add the changes of REVISION in FS to SDB. */
+static svn_error_t *
+index_revision(svn_sqlite__db_t *sdb,
+               svn_fs_t *fs,
+               svn_revnum_t revision,
+               apr_pool_t *scratch_pool)
+{
+  svn_fs_root_t *root;
+  svn_fs_path_change_iterator_t *iterator;
+  svn_fs_path_change3_t *change;
+  svn_sqlite__stmt_t *stmt;
+  apr_hash_t *touched = apr_hash_make(scratch_pool);
+  apr_pool_t *iterpool = svn_pool_create(scratch_pool);
+  const char *date;
+
+  SVN_ERR(get_revision_date(&date, fs, revision, scratch_pool));
+  SVN_ERR(svn_sqlite__get_statement(&stmt, sdb, STMT_ADD_REVISION));
+  SVN_ERR(svn_sqlite__bindf(stmt, "rs", revision, date));
+  SVN_ERR(svn_sqlite__insert(NULL, stmt));
+
+  SVN_ERR(svn_fs_revision_root(&root, fs, revision, scratch_pool));
+  SVN_ERR(svn_fs_paths_changed3(&iterator, root, scratch_pool,
+                                scratch_pool));
+  SVN_ERR(svn_fs_path_change_get(&change, iterator));
+
+  while (change)
+    {
+      const char *path = change->path.data;
+
+      svn_pool_clear(iterpool);
+
+      if (   change->change_kind == svn_fs_path_change_add
+          || change->change_kind == svn_fs_path_change_replace)
+        {
+          const char *copyfrom_path = change->copyfrom_path;
+          svn_revnum_t copyfrom_rev = change->copyfrom_rev;
+
+          if (!change->copyfrom_known)
+            SVN_ERR(svn_fs_copied_from(&copyfrom_rev, &copyfrom_path,
+                                       root, path, iterpool));
+          if (!SVN_IS_VALID_REVNUM(copyfrom_rev))
+            copyfrom_path = NULL;
+
+          SVN_ERR(svn_sqlite__get_statement(&stmt, sdb, STMT_ADD_ADDED));
+          SVN_ERR(svn_sqlite__bindf(stmt, "srsr", path, revision,
+                                    copyfrom_path, copyfrom_rev));
+          SVN_ERR(svn_sqlite__insert(NULL, stmt));
+        }
+
+      /* Mark PATH and its parents, except for the root, as touched.  Stop
+         at the first parent that we already marked for this revision. */
+      while (!svn_fspath__is_root(path, strlen(path))
+             && !svn_hash_gets(touched, path))
+        {
+          path = apr_pstrdup(scratch_pool, path);
+          svn_hash_sets(touched, path, path);
+
+          SVN_ERR(svn_sqlite__get_statement(&stmt, sdb, STMT_ADD_TOUCHED));
+          SVN_ERR(svn_sqlite__bindf(stmt, "sr", path, revision));
+          SVN_ERR(svn_sqlite__insert(NULL, stmt));
+
+          path = svn_fspath__dirname(path, scratch_pool);
+        }
+
+      SVN_ERR(svn_fs_path_change_get(&change, iterator));
+    }
+
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
+
+/* Add revisions START to END of REPOS to SDB, in a single transaction,
+   and record that SDB now covers END.  UUID is the UUID of REPOS.
+   Notify and check for cancellation as described for
+   svn_repos_build_log_index(). */
+static svn_error_t *
+index_revisions(svn_sqlite__db_t *sdb,
+                svn_repos_t *repos,
+                const char *uuid,
+                svn_revnum_t start,
+                svn_revnum_t end,
+                svn_repos_notify_func_t notify_func,
+                void *notify_baton,
+                svn_cancel_func_t cancel_func,
+                void *cancel_baton,
+                apr_pool_t *scratch_pool)
+{
+  apr_pool_t *iterpool = svn_pool_create(scratch_pool);
+  svn_revnum_t revision;
+
+  SVN_ERR(svn_sqlite__begin_immediate_transaction(sdb));
+  for (revision = start; revision <= end; revision++)
+    {
+      svn_error_t *err;
+
+      svn_pool_clear(iterpool);
+
+      err = cancel_func ? cancel_func(cancel_baton) : SVN_NO_ERROR;
+      if (!err)
+        err = index_revision(sdb, repos->fs, revision, iterpool);
+      if (err)
+        return svn_error_trace(svn_sqlite__finish_transaction(sdb, err));
+
+      if (notify_func)
+        {
+          svn_repos_notify_t *notify
+            = svn_repos_notify_create(svn_repos_notify_log_index_rev,
+                                      iterpool);
+
+          notify->revision = revision;
+          notify_func(notify_baton, notify, iterpool);
+        }
+    }
+  svn_pool_destroy(iterpool);
+
+  return svn_error_trace(
+           svn_sqlite__finish_transaction(sdb, write_info(sdb, uuid, end)));
+}
+
+/* Baton for update_index(). */
+typedef struct update_baton_t
+{
+  svn_repos_t *repos;
+  svn_revnum_t revision;
+} update_baton_t;
+
+/* Add all revisions up to BATON->REVISION that SDB does not cover yet.
+   Implements svn_sqlite__transaction_callback_t. */
+static svn_error_t *
+update_index(void *baton,
+             svn_sqlite__db_t *sdb,
+             apr_pool_t *scratch_pool)
+{
+  update_baton_t *b = baton;
+  const char *uuid;
+  const char *info_uuid;
+  svn_revnum_t info_rev;
+  svn_revnum_t youngest;
+  svn_revnum_t valid_rev;
+  svn_revnum_t revision;
+  apr_pool_t *iterpool;
+
+  SVN_ERR(svn_fs_get_uuid(b->repos->fs, &uuid, scratch_pool));
+  SVN_ERR(read_info(&info_uuid, &info_rev, sdb, scratch_pool));
+
+  /* Leave an index that does not belong to this repository alone; it
+     will not be used for queries either. */
+  if (!info_uuid || strcmp(info_uuid, uuid) != 0)
+    return SVN_NO_ERROR;
+
+  /* If the repository has been restored from a backup, the index may
+     cover revisions that have been replaced or that don't exist anymore.
+     Find the youngest indexed revision that is still valid.  That is
+     almost always the first one that we check. */
+  SVN_ERR(svn_fs_youngest_rev(&youngest, b->repos->fs, scratch_pool));
+  iterpool = svn_pool_create(scratch_pool);
+  for (valid_rev = MIN(info_rev, youngest); valid_rev >= 0; valid_rev--)
+    {
+      svn_boolean_t matches;
+
+      /* Don't rebuild large parts of the index while committing.  Leave
+         it to svnadmin build-log-index.  Until then, queries will not use
+         the index because it does not match the repository. */
+      if (MIN(info_rev, youngest) - valid_rev >= BUILD_BATCH_SIZE)
+        {
+          svn_pool_destroy(iterpool);
+          return SVN_NO_ERROR;
+        }
+
+      svn_pool_clear(iterpool);
+      SVN_ERR(revision_matches(&matches, sdb, b->repos->fs, valid_rev,
+                               iterpool));
+      if (matches)
+        break;
+    }
+
+  if (valid_rev < info_rev)
+    SVN_ERR(delete_revisions_above(sdb, valid_rev));
+
+  for (revision = valid_rev + 1; revision <= b->revision; revision++)
+    {
+      svn_pool_clear(iterpool);
+      SVN_ERR(index_revision(sdb, b->repos->fs, revision, iterpool));
+    }
+  svn_pool_destroy(iterpool);
+
+  if (valid_rev < info_rev || b->revision > info_rev)
+    SVN_ERR(write_info(sdb, uuid, MAX(valid_rev, b->revision)));
+
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_repos__log_index_update(svn_repos_t *repos,
+                            svn_revnum_t revision,
+                            apr_pool_t *scratch_pool)
+{
+  const char *db_path = svn_dirent_join(repos->path, SVN_REPOS__LOG_INDEX,
+                                        scratch_pool);
+  svn_node_kind_t kind;
+  svn_sqlite__db_t *sdb;
+  update_baton_t baton;
+
+  /* The index is optional. */
+  SVN_ERR(svn_io_check_path(db_path, &kind, scratch_pool));
+  if (kind != svn_node_file)
+    return SVN_NO_ERROR;
+
+  SVN_ERR(svn_sqlite__open(&sdb, db_path, svn_sqlite__mode_readwrite,
+                           statements, 0, NULL, 0,
+                           scratch_pool, scratch_pool));
+
+  baton.repos = repos;
+  baton.revision = revision;
+  SVN_SQLITE__ERR_CLOSE(svn_sqlite__with_immediate_transaction(sdb,
+                                                               update_index,
+                                                               &baton,
+                                                               scratch_pool),
+                        sdb);
+
+  return svn_error_trace(svn_sqlite__close(sdb));
+}
+
+svn_error_t *
+svn_repos__log_index_date_changed(svn_repos_t *repos,
+                                  svn_revnum_t revision,
+                                  const svn_string_t *old_date,
+                                  apr_pool_t *scratch_pool)
+{
+  const char *db_path = svn_dirent_join(repos->path, SVN_REPOS__LOG_INDEX,
+                                        scratch_pool);
+  svn_node_kind_t kind;
+  svn_sqlite__db_t *sdb;
+  svn_sqlite__stmt_t *stmt;
+  const char *date;
+
+  /* The index is optional. */
+  SVN_ERR(svn_io_check_path(db_path, &kind, scratch_pool));
+  if (kind != svn_node_file)
+    return SVN_NO_ERROR;
+
+  SVN_ERR(svn_sqlite__open(&sdb, db_path, svn_sqlite__mode_readwrite,
+                           statements, 0, NULL, 0,
+                           scratch_pool, scratch_pool));
+
+  /* Store the date that the revision has now rather than the one that our
+     caller set.  Concurrent changes may then be applied in any order. */
+  SVN_SQLITE__ERR_CLOSE(get_revision_date(&date, repos->fs, revision,
+                                          scratch_pool),
+                        sdb);
+  SVN_SQLITE__ERR_CLOSE(svn_sqlite__get_statement(&stmt, sdb,
+                                                  STMT_UPDATE_REVISION_DATE),
+                        sdb);
+  SVN_SQLITE__ERR_CLOSE(svn_sqlite__bindf(stmt, "rss", revision,
+                                          old_date ? old_date->data : NULL,
+                                          date),
+                        sdb);
+  SVN_SQLITE__ERR_CLOSE(svn_sqlite__update(NULL, stmt), sdb);
+
+  return svn_error_trace(svn_sqlite__close(sdb));
+}
+
+svn_error_t *
+svn_repos_build_log_index(svn_repos_t *repos,
+                          svn_repos_notify_func_t notify_func,
+                          void *notify_baton,
+                          svn_cancel_func_t cancel_func,
+                          void *cancel_baton,
+                          apr_pool_t *scratch_pool)
+{
+  const char *db_path = svn_dirent_join(repos->path, SVN_REPOS__LOG_INDEX,
+                                        scratch_pool);
+  const char *tmp_path = apr_pstrcat(scratch_pool, db_path, ".tmp",
+                                     SVN_VA_NULL);
+  apr_pool_t *iterpool = svn_pool_create(scratch_pool);
+  svn_sqlite__db_t *sdb;
+  const char *uuid;
+  svn_revnum_t youngest;
+  svn_revnum_t revision = 0;
+
+  SVN_ERR(svn_fs_get_uuid(repos->fs, &uuid, scratch_pool));
+
+  /* Build the new index next to the old one, so that log requests and
+     commits keep using the old one until we are done. */
+  SVN_ERR(svn_io_remove_file2(tmp_path, TRUE, scratch_pool));
+  SVN_ERR(svn_io_file_create_empty(tmp_path, scratch_pool));
+#ifndef WIN32
+  /* The index has to be writable by everyone who can commit. */
+  SVN_ERR(svn_io_copy_perms(svn_repos_db_lockfile(repos, scratch_pool),
+                            tmp_path, scratch_pool));
+#endif
+
+  SVN_ERR(svn_sqlite__open(&sdb, tmp_path, svn_sqlite__mode_readwrite,
+                           statements, 0, NULL, 0,
+                           scratch_pool, scratch_pool));
+  SVN_SQLITE__ERR_CLOSE(svn_sqlite__exec_statements(sdb,
+                                                    STMT_CREATE_SCHEMA),
+                        sdb);
+
+  /* Commits that happen while we are busy will not find the new index,
+     so keep going until we have caught up with them. */
+  SVN_SQLITE__ERR_CLOSE(svn_fs_youngest_rev(&youngest, repos->fs,
+                                            scratch_pool),
+                        sdb);
+  while (revision <= youngest)
+    {
+      svn_revnum_t end = MIN(youngest, revision + BUILD_BATCH_SIZE - 1);
+
+      svn_pool_clear(iterpool);
+      SVN_SQLITE__ERR_CLOSE(index_revisions(sdb, repos, uuid, revision, end,
+                                            notify_func, notify_baton,
+                                            cancel_func, cancel_baton,
+                                            iterpool),
+                            sdb);
+      revision = end + 1;
+
+      if (revision > youngest)
+        SVN_SQLITE__ERR_CLOSE(svn_fs_youngest_rev(&youngest, repos->fs,
+                                                  iterpool),
+                              sdb);
+    }
+  svn_pool_destroy(iterpool);
+
+  SVN_ERR(svn_sqlite__close(sdb));
+
+  return svn_error_trace(svn_io_file_rename2(tmp_path, db_path, FALSE,
+                                             scratch_pool));
+}
+
+svn_error_t *
+svn_repos__log_index_open(svn_repos__log_index_t **index,
+                          svn_repos_t *repos,
+                          apr_pool_t *result_pool,
+                          apr_pool_t *scratch_pool)
+{
+  const char *db_path = svn_dirent_join(repos->path, SVN_REPOS__LOG_INDEX,
+                                        scratch_pool);
+  svn_node_kind_t kind;
+  svn_sqlite__db_t *sdb;
+  const char *uuid;
+  const char *info_uuid;
+  svn_revnum_t info_rev;
+  svn_revnum_t youngest;
+  svn_boolean_t matches;
+
+  *index = NULL;
+
+  SVN_ERR(svn_io_check_path(db_path, &kind, scratch_pool));
+  if (kind != svn_node_file)
+    return SVN_NO_ERROR;
+
+  SVN_ERR(svn_sqlite__open(&sdb, db_path, svn_sqlite__mode_readonly,
+                           statements, 0, NULL, 0,
+                           result_pool, scratch_pool));
+  SVN_SQLITE__ERR_CLOSE(read_info(&info_uuid, &info_rev, sdb, scratch_pool),
+                        sdb);
+  SVN_SQLITE__ERR_CLOSE(svn_fs_get_uuid(repos->fs, &uuid, scratch_pool),
+                        sdb);
+  SVN_SQLITE__ERR_CLOSE(svn_fs_youngest_rev(&youngest, repos->fs,
+                                            scratch_pool),
+                        sdb);
+
+  /* An index of some other repository, or one that covers revisions that
+     the repository does not have (anymore), must not be used.  The latter
+     happens when the repository gets restored from a backup. */
+  if (!info_uuid || strcmp(info_uuid, uuid) != 0 || info_rev > youngest)
+    return svn_error_trace(svn_sqlite__close(sdb));
+
+  /* After such a restore, new commits may have replaced the revisions
+     that we indexed, while the next update has not fixed that, yet. */
+  SVN_SQLITE__ERR_CLOSE(revision_matches(&matches, sdb, repos->fs, info_rev,
+                                         scratch_pool),
+                        sdb);
+  if (!matches)
+    return svn_error_trace(svn_sqlite__close(sdb));
+
+  *index = apr_pcalloc(result_pool, sizeof(**index));
+  (*index)->sdb = sdb;
+  (*index)->youngest = info_rev;
+
+  return SVN_NO_ERROR;
+}
+
+svn_revnum_t
+svn_repos__log_index_youngest(svn_repos__log_index_t *index)
+{
+  return index->youngest;
+}
+
+svn_error_t *
+svn_repos__log_index_history(svn_repos__log_index_history_t **history,
+                             svn_repos__log_index_t *index,
+                             const char *path,
+                             svn_revnum_t revision,
+                             svn_boolean_t strict,
+                             apr_pool_t *result_pool)
+{
+  svn_repos__log_index_history_t *hist = apr_pcalloc(result_pool,
+                                                     sizeof(*hist));
+
+  SVN_ERR_ASSERT(revision <= index->youngest);
+
+  hist->index = index;
+  hist->strict = strict;
+  hist->path = svn_fspath__canonicalize(path, result_pool);
+  hist->revision = revision;
+  hist->pool = result_pool;
+
+  *history = hist;
+
+  return SVN_NO_ERROR;
+}
+
+/* Find the youngest addition of HISTORY->PATH or one of its parents at
+   or before HISTORY->REVISION and fill in the ADDED_* fields of HISTORY
+   accordingly. */
+static svn_error_t *
+find_addition(svn_repos__log_index_history_t *history,
+              apr_pool_t *scratch_pool)
+{
+  const char *path = history->path;
+  svn_sqlite__stmt_t *stmt;
+
+  history->added_rev = SVN_INVALID_REVNUM;
+  history->added_path = NULL;
+  history->copyfrom_path = NULL;
+  history->copyfrom_rev = SVN_INVALID_REVNUM;
+
+  /* Start at PATH itself and let a parent only win if it was added later,
+     so that of several additions in the same revision the innermost one
+     counts. */
+  while (!svn_fspath__is_root(path, strlen(path)))
+    {
+      svn_boolean_t have_row;
+
+      SVN_ERR(svn_sqlite__get_statement(&stmt, history->index->sdb,
+                                        STMT_GET_PREV_ADDED));
+      SVN_ERR(svn_sqlite__bindf(stmt, "sr", path, history->revision));
+      SVN_ERR(svn_sqlite__step(&have_row, stmt));
+      if (have_row)
+        {
+          svn_revnum_t added_rev = svn_sqlite__column_revnum(stmt, 0);
+
+          if (added_rev > history->added_rev)
+            {
+              history->added_rev = added_rev;
+              history->added_path = apr_pstrdup(history->pool, path);
+              history->copyfrom_path
+                = svn_sqlite__column_text(stmt, 1, history->pool);
+              history->copyfrom_rev = svn_sqlite__column_revnum(stmt, 2);
+            }
+        }
+      SVN_ERR(svn_sqlite__reset(stmt));
+
+      path = svn_fspath__dirname(path, scratch_pool);
+    }
+
+  history->addition_known = TRUE;
+
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_repos__log_index_history_prev(svn_revnum_t *revision,
+                                  const char **path,
+                                  svn_repos__log_index_history_t *history,
+                                  apr_pool_t *scratch_pool)
+{
+  svn_sqlite__stmt_t *stmt;
+  svn_boolean_t have_row;
+
+  *revision = SVN_INVALID_REVNUM;
+  *path = history->path;
+
+  if (history->done)
+    return SVN_NO_ERROR;
+
+  /* The root directory changes in every revision. */
+  if (svn_fspath__is_root(history->path, strlen(history->path)))
+    {
+      *revision = history->revision;
+      if (history->revision-- == 0)
+        history->done = TRUE;
+
+      return SVN_NO_ERROR;
+    }
+
+  if (!history->addition_known)
+    SVN_ERR(find_addition(history, scratch_pool));
+
+  /* Report the changes younger than the addition first.  An invalid
+     ADDED_REV is -1 and thus works as the lower bound as well. */
+  SVN_ERR(svn_sqlite__get_statement(&stmt, history->index->sdb,
+                                    STMT_GET_PREV_TOUCHED));
+  SVN_ERR(svn_sqlite__bindf(stmt, "sir", history->path,
+                            (apr_int64_t)history->added_rev,
+                            history->revision));
+  SVN_ERR(svn_sqlite__step(&have_row, stmt));
+  if (have_row)
+    *revision = svn_sqlite__column_revnum(stmt, 0);
+  SVN_ERR(svn_sqlite__reset(stmt));
+
+  if (SVN_IS_VALID_REVNUM(*revision))
+    {
+      history->revision = *revision - 1;
+      return SVN_NO_ERROR;
+    }
+
+  /* Then the addition itself. */
+  *revision = history->added_rev;
+  history->done = TRUE;
+
+  /* And continue at the copy source. */
+  if (SVN_IS_VALID_REVNUM(*revision)
+      && history->copyfrom_path
+      && !history->strict)
+    {
+      const char *remainder = svn_fspath__skip_ancestor(history->added_path,
+                                                        history->path);
+
+      history->path = svn_fspath__join(history->copyfrom_path, remainder,
+                                       history->pool);
+      history->revision = history->copyfrom_rev;
+      history->addition_known = FALSE;
+      history->done = FALSE;
+    }
+
+  return SVN_NO_ERROR;
+}
@@ -56,6 +56,9 @@ typedef struct log_callbacks_t
   void *revision_receiver_baton;
   svn_repos_authz_func_t authz_read_func;
   void *authz_read_baton;
+
+  /* The changed-paths index of the repository, or NULL if it has none. */
+  svn_repos__log_index_t *log_index;
 } log_callbacks_t;
 
 
@@ -110,6 +113,56 @@ svn_repos_log_entry_dup(const svn_repos_log_entry_t *log_entry,
   return new_entry;
 }
 
+/* Number of changed paths whose readability gets checked at once. */
+#define CHANGES_BATCH_SIZE 1000
+
+/* Starting with *CHANGE, fetch up to CHANGES_BATCH_SIZE changes from
+ * ITERATOR and return copies of them, allocated in RESULT_POOL, in
+ * *CHANGES as an array of svn_fs_path_change3_t *.  Set *CHANGE to the
+ * change following them or to NULL at the end of the list.
+ *
+ * If AUTHZ_READ_FUNC can check many paths at once, set *READABLE to an
+ * array telling whether the respective change's path is readable in ROOT
+ * according to AUTHZ_READ_FUNC and AUTHZ_READ_BATON.  Otherwise, set it
+ * to NULL and leave the checks to the caller; see
+ * svn_repos__authz_read_many.  Use SCRATCH_POOL for temporary allocations.
+ */
+static svn_error_t *
+get_changes_batch(apr_array_header_t **changes,
+                  svn_boolean_t **readable,
+                  svn_fs_path_change3_t **change,
+                  svn_fs_path_change_iterator_t *iterator,
+                  svn_fs_root_t *root,
+                  svn_repos_authz_func_t authz_read_func,
+                  void *authz_read_baton,
+                  apr_pool_t *result_pool,
+                  apr_pool_t *scratch_pool)
+{
+  apr_array_header_t *paths = apr_array_make(scratch_pool,
+                                             CHANGES_BATCH_SIZE,
+                                             sizeof(const char *));
+
+  *changes = apr_array_make(result_pool, CHANGES_BATCH_SIZE,
+                            sizeof(svn_fs_path_change3_t *));
+  while (*change && (*changes)->nelts < CHANGES_BATCH_SIZE)
+    {
+      svn_fs_path_change3_t *copy = svn_fs_path_change3_dup(*change,
+                                                            result_pool);
+
+      APR_ARRAY_PUSH(*changes, svn_fs_path_change3_t *) = copy;
+      APR_ARRAY_PUSH(paths, const char *) = copy->path.data;
+
+      SVN_ERR(svn_fs_path_change_get(change, iterator));
+    }
+
+  /* Check all paths of the batch at once, if possible. */
+  SVN_ERR(svn_repos__authz_read_many(readable, root, paths,
+                                     authz_read_func, authz_read_baton,
+                                     result_pool, scratch_pool));
+
+  return SVN_NO_ERROR;
+}
+
 svn_error_t *
 svn_repos_check_revision_access(svn_repos_revision_access_level_t *access_level,
                                 svn_repos_t *repos,
@@ -121,9 +174,13 @@ svn_repos_check_revision_access(svn_repos_revision_access_level_t *access_level,
   svn_fs_t *fs = svn_repos_fs(repos);
   svn_fs_root_t *rev_root;
   svn_fs_path_change_iterator_t *iterator;
-  svn_fs_path_change3_t *change;
+  svn_fs_path_change3_t *next_change;
+  apr_array_header_t *changes = NULL;
+  svn_boolean_t *readable_paths = NULL;
+  int i = 0;
   svn_boolean_t found_readable = FALSE;
   svn_boolean_t found_unreadable = FALSE;
+  apr_pool_t *batchpool;
   apr_pool_t *iterpool;
 
   /* By default, we'll grant full read access to REVISION. */
@@ -136,26 +193,45 @@ svn_repos_check_revision_access(svn_repos_revision_access_level_t *access_level,
   /* Fetch the changes associated with REVISION. */
   SVN_ERR(svn_fs_revision_root(&rev_root, fs, revision, pool));
   SVN_ERR(svn_fs_paths_changed3(&iterator, rev_root, pool, pool));
-  SVN_ERR(svn_fs_path_change_get(&change, iterator));
+  SVN_ERR(svn_fs_path_change_get(&next_change, iterator));
 
   /* No changed paths?  We're done.
 
      Note that the check at "decision:" assumes that at least one
      path has been processed.  So, this actually affects functionality. */
-  if (!change)
+  if (!next_change)
     return SVN_NO_ERROR;
 
   /* Otherwise, we have to check the readability of each changed
      path, or at least enough to answer the question asked. */
+  batchpool = svn_pool_create(pool);
   iterpool = svn_pool_create(pool);
-  while (change)
+  while (next_change || (changes && i < changes->nelts))
     {
+      svn_fs_path_change3_t *change;
       svn_boolean_t readable;
 
       svn_pool_clear(iterpool);
 
-      SVN_ERR(authz_read_func(&readable, rev_root, change->path.data,
-                              authz_read_baton, iterpool));
+      /* Fetch the next batch of changes and check the readability of
+         their paths at once. */
+      if (!changes || i == changes->nelts)
+        {
+          svn_pool_clear(batchpool);
+          SVN_ERR(get_changes_batch(&changes, &readable_paths, &next_change,
+                                    iterator, rev_root, authz_read_func,
+                                    authz_read_baton, batchpool, iterpool));
+          i = 0;
+        }
+
+      change = APR_ARRAY_IDX(changes, i, svn_fs_path_change3_t *);
+      if (readable_paths)
+        readable = readable_paths[i];
+      else
+        SVN_ERR(authz_read_func(&readable, rev_root, change->path.data,
+                                authz_read_baton, iterpool));
+      ++i;
+
       if (! readable)
         found_unreadable = TRUE;
       else
@@ -201,12 +277,11 @@ svn_repos_check_revision_access(svn_repos_revision_access_level_t *access_level,
         default:
           break;
         }
-
-      SVN_ERR(svn_fs_path_change_get(&change, iterator));
     }
 
  decision:
   svn_pool_destroy(iterpool);
+  svn_pool_destroy(batchpool);
 
   /* Either every changed path was unreadable... */
   if (! found_readable)
@@ -252,16 +327,20 @@ detect_changed(svn_repos_revision_access_level_t *access_level,
                apr_pool_t *scratch_pool)
 {
   svn_fs_path_change_iterator_t *iterator;
-  svn_fs_path_change3_t *change;
+  svn_fs_path_change3_t *next_change;
+  apr_array_header_t *changes = NULL;
+  svn_boolean_t *readable_paths = NULL;
+  int i = 0;
+  apr_pool_t *batchpool;
   apr_pool_t *iterpool;
   svn_boolean_t found_readable = FALSE;
   svn_boolean_t found_unreadable = FALSE;
 
   /* Retrieve the first change in the list. */
   SVN_ERR(svn_fs_paths_changed3(&iterator, root, scratch_pool, scratch_pool));
-  SVN_ERR(svn_fs_path_change_get(&change, iterator));
+  SVN_ERR(svn_fs_path_change_get(&next_change, iterator));
 
-  if (!change)
+  if (!next_change)
     {
       /* No paths changed in this revision?  Uh, sure, I guess the
          revision is readable, then.  */
@@ -269,28 +348,48 @@ detect_changed(svn_repos_revision_access_level_t *access_level,
       return SVN_NO_ERROR;
     }
 
+  batchpool = svn_pool_create(scratch_pool);
   iterpool = svn_pool_create(scratch_pool);
-  while (change)
+  while (next_change || (changes && i < changes->nelts))
     {
       /* NOTE:  Much of this loop is going to look quite similar to
          svn_repos_check_revision_access(), but we have to do more things
          here, so we'll live with the duplication. */
-      const char *path = change->path.data;
+      svn_fs_path_change3_t *change;
+      const char *path;
+      svn_boolean_t readable;
       svn_pool_clear(iterpool);
 
+      /* Fetch the next batch of changes and check the readability of
+         their paths at once. */
+      if (!changes || i == changes->nelts)
+        {
+          svn_pool_clear(batchpool);
+          SVN_ERR(get_changes_batch(&changes, &readable_paths, &next_change,
+                                    iterator, root,
+                                    callbacks->authz_read_func,
+                                    callbacks->authz_read_baton,
+                                    batchpool, iterpool));
+          i = 0;
+        }
+
+      change = APR_ARRAY_IDX(changes, i, svn_fs_path_change3_t *);
+      path = change->path.data;
+      if (readable_paths)
+        readable = readable_paths[i];
+      else if (callbacks->authz_read_func)
+        SVN_ERR(callbacks->authz_read_func(&readable, root, path,
+                                           callbacks->authz_read_baton,
+                                           iterpool));
+      else
+        readable = TRUE;
+      ++i;
+
       /* Skip path if unreadable. */
-      if (callbacks->authz_read_func)
+      if (! readable)
         {
-          svn_boolean_t readable;
-          SVN_ERR(callbacks->authz_read_func(&readable, root, path,
-                                             callbacks->authz_read_baton,
-                                             iterpool));
-          if (! readable)
-            {
-              found_unreadable = TRUE;
-              SVN_ERR(svn_fs_path_change_get(&change, iterator));
-              continue;
-            }
+          found_unreadable = TRUE;
+          continue;
         }
 
       /* At least one changed-path was readable. */
@@ -382,12 +481,10 @@ detect_changed(svn_repos_revision_access_level_t *access_level,
                                      callbacks->path_change_receiver_baton,
                                      change,
                                      iterpool));
-
-      /* Next changed path. */
-      SVN_ERR(svn_fs_path_change_get(&change, iterator));
     }
 
   svn_pool_destroy(iterpool);
+  svn_pool_destroy(batchpool);
 
   if (! found_readable)
     {
@@ -429,8 +526,54 @@ struct path_info
   svn_fs_history_t *hist;
   apr_pool_t *newpool;
   apr_pool_t *oldpool;
+
+  /* If not NULL, read the history from the changed-paths index instead
+     of the filesystem.  HIST and the pools above are NULL then. */
+  svn_repos__log_index_history_t *index_hist;
 };
 
+/* Like get_history() below, but for a path whose history is read from
+ * the changed-paths index in INFO->INDEX_HIST.
+ */
+static svn_error_t *
+get_index_history(struct path_info *info,
+                  svn_fs_t *fs,
+                  svn_repos_authz_func_t authz_read_func,
+                  void *authz_read_baton,
+                  svn_revnum_t start,
+                  apr_pool_t *scratch_pool)
+{
+  const char *path;
+
+  SVN_ERR(svn_repos__log_index_history_prev(&info->history_rev, &path,
+                                            info->index_hist, scratch_pool));
+
+  if (! SVN_IS_VALID_REVNUM(info->history_rev)
+      || info->history_rev < start)
+    {
+      info->done = TRUE;
+      return SVN_NO_ERROR;
+    }
+
+  svn_stringbuf_set(info->path, path);
+
+  /* Is the history item readable?  If not, done with path. */
+  if (authz_read_func)
+    {
+      svn_fs_root_t *history_root;
+      svn_boolean_t readable;
+
+      SVN_ERR(svn_fs_revision_root(&history_root, fs, info->history_rev,
+                                   scratch_pool));
+      SVN_ERR(authz_read_func(&readable, history_root, info->path->data,
+                              authz_read_baton, scratch_pool));
+      if (! readable)
+        info->done = TRUE;
+    }
+
+  return SVN_NO_ERROR;
+}
+
 /* Advance to the next history for the path.
  *
  * If INFO->HIST is not NULL we do this using that existing history object,
@@ -462,6 +605,11 @@ get_history(struct path_info *info,
   apr_pool_t *subpool;
   const char *path;
 
+  if (info->index_hist)
+    return svn_error_trace(get_index_history(info, fs, authz_read_func,
+                                             authz_read_baton, start,
+                                             scratch_pool));
+
   if (info->hist)
     {
       subpool = info->newpool;
@@ -1389,6 +1537,9 @@ send_log(svn_revnum_t rev,
 
 /* Get the histories for PATHS, and store them in *HISTORIES.
 
+   If LOG_INDEX is not NULL and covers HIST_END, read the histories from
+   it instead of the filesystem.
+
    If IGNORE_MISSING_LOCATIONS is set, don't treat requests for bogus
    repository locations as fatal -- just ignore them.  */
 static svn_error_t *
@@ -1401,6 +1552,7 @@ get_path_histories(apr_array_header_t **histories,
                    svn_boolean_t ignore_missing_locations,
                    svn_repos_authz_func_t authz_read_func,
                    void *authz_read_baton,
+                   svn_repos__log_index_t *log_index,
                    apr_pool_t *pool)
 {
   svn_fs_root_t *root;
@@ -1408,6 +1560,9 @@ get_path_histories(apr_array_header_t **histories,
   svn_error_t *err;
   int i;
 
+  if (log_index && hist_end > svn_repos__log_index_youngest(log_index))
+    log_index = NULL;
+
   /* Create a history object for each path so we can walk through
      them all at the same time until we have all changes or LIMIT
      is reached.
@@ -1442,8 +1597,32 @@ get_path_histories(apr_array_header_t **histories,
       info->done = FALSE;
       info->history_rev = hist_end;
       info->first_time = TRUE;
+      info->index_hist = NULL;
 
-      if (i < MAX_OPEN_HISTORIES)
+      if (log_index)
+        {
+          svn_node_kind_t kind;
+
+          SVN_ERR(svn_fs_check_path(&kind, root, this_path, iterpool));
+          if (kind == svn_node_none)
+            {
+              if (ignore_missing_locations)
+                continue;
+
+              return svn_error_createf(SVN_ERR_FS_NOT_FOUND, NULL,
+                                       _("File not found: revision %ld, "
+                                         "path '%s'"),
+                                       hist_end, this_path);
+            }
+
+          SVN_ERR(svn_repos__log_index_history(&info->index_hist, log_index,
+                                               this_path, hist_end,
+                                               strict_node_history, pool));
+          info->hist = NULL;
+          info->oldpool = NULL;
+          info->newpool = NULL;
+        }
+      else if (i < MAX_OPEN_HISTORIES)
         {
           err = svn_fs_node_history2(&info->hist, root, this_path, pool,
                                      iterpool);
@@ -2015,7 +2194,8 @@ do_logs(svn_fs_t *fs,
   SVN_ERR(get_path_histories(&histories, fs, paths, hist_start, hist_end,
                              strict_node_history, ignore_missing_locations,
                              callbacks->authz_read_func,
-                             callbacks->authz_read_baton, pool));
+                             callbacks->authz_read_baton,
+                             callbacks->log_index, pool));
 
   /* Loop through all the revisions in the range and add any
      where a path was changed to the array, or if they wanted
@@ -2332,6 +2512,7 @@ svn_repos_get_logs5(svn_repos_t *repos,
   callbacks.revision_receiver_baton = revision_receiver_baton;
   callbacks.authz_read_func = authz_read_func;
   callbacks.authz_read_baton = authz_read_baton;
+  callbacks.log_index = NULL;
 
   if (revprops)
     {
@@ -2460,6 +2641,11 @@ svn_repos_get_logs5(svn_repos_t *repos,
       svn_pool_destroy(subpool);
     }
 
+  /* Look up the revisions in which PATHS changed in the changed-paths
+     index rather than walking their history, if there is one. */
+  SVN_ERR(svn_repos__log_index_open(&callbacks.log_index, repos,
+                                    scratch_pool, scratch_pool));
+
   return do_logs(repos->fs, paths, paths_history_mergeinfo, NULL, NULL,
                  start, end, limit, strict_node_history,
                  include_merged_revisions, FALSE, FALSE, FALSE,
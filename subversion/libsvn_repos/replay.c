@@ -40,6 +40,7 @@
 #include "private/svn_repos_private.h"
 #include "private/svn_delta_private.h"
 #include "private/svn_sorts_private.h"
+#include "repos.h"
 
 
 /*** Backstory ***/
@@ -861,28 +862,55 @@ get_relevant_changes(apr_hash_t **changed_paths,
 {
   svn_fs_path_change_iterator_t *iterator;
   svn_fs_path_change3_t *change;
+  apr_array_header_t *changes;
+  apr_array_header_t *changed;
+  svn_boolean_t *allowed = NULL;
   apr_pool_t *iterpool = svn_pool_create(scratch_pool);
+  int i;
 
   /* Fetch the paths changed under ROOT. */
   SVN_ERR(svn_fs_paths_changed3(&iterator, root, scratch_pool, scratch_pool));
   SVN_ERR(svn_fs_path_change_get(&change, iterator));
 
+  /* Collect all changes so that we can check access to them at once,
+     if AUTHZ_READ_FUNC supports that. */
+  changes = apr_array_make(scratch_pool, 16, sizeof(svn_fs_path_change3_t *));
+  changed = apr_array_make(scratch_pool, 16, sizeof(const char *));
+  while (change)
+    {
+      change = svn_fs_path_change3_dup(change, scratch_pool);
+      APR_ARRAY_PUSH(changes, svn_fs_path_change3_t *) = change;
+      APR_ARRAY_PUSH(changed, const char *) = change->path.data;
+
+      SVN_ERR(svn_fs_path_change_get(&change, iterator));
+    }
+
+  SVN_ERR(svn_repos__authz_read_many(&allowed, root, changed,
+                                     authz_read_func, authz_read_baton,
+                                     scratch_pool, scratch_pool));
+
   /* Make an array from the keys of our CHANGED_PATHS hash, and copy
      the values into a new hash whose keys have no leading slashes. */
   *paths = apr_array_make(result_pool, 16, sizeof(const char *));
   *changed_paths = apr_hash_make(result_pool);
-  while (change)
+  for (i = 0; i < changes->nelts; ++i)
     {
-      const char *path = change->path.data;
-      apr_ssize_t keylen = change->path.len;
-      svn_boolean_t allowed = TRUE;
+      const char *path;
+      apr_ssize_t keylen;
+      svn_boolean_t readable = TRUE;
 
       svn_pool_clear(iterpool);
-      if (authz_read_func)
-        SVN_ERR(authz_read_func(&allowed, root, path, authz_read_baton,
-                                iterpool));
+      change = APR_ARRAY_IDX(changes, i, svn_fs_path_change3_t *);
+      path = change->path.data;
+      keylen = change->path.len;
 
       if (allowed)
+        readable = allowed[i];
+      else if (authz_read_func)
+        SVN_ERR(authz_read_func(&readable, root, path, authz_read_baton,
+                                iterpool));
+
+      if (readable)
         {
           if (path[0] == '/')
             {
@@ -906,8 +934,6 @@ get_relevant_changes(apr_hash_t **changed_paths,
               apr_hash_set(*changed_paths, path, keylen, change);
             }
         }
-
-      SVN_ERR(svn_fs_path_change_get(&change, iterator));
     }
 
   svn_pool_destroy(iterpool);
@@ -1849,7 +1849,8 @@ struct hotcopy_ctx_t {
 
 /* Copy the repository structure of PATH to BATON->DEST, with exception of
  * @c SVN_REPOS__DB_DIR, @c SVN_REPOS__LOCK_DIR and @c SVN_REPOS__FORMAT;
- * those directories and files are handled separately.
+ * those directories and files are handled separately.  The changed-paths
+ * index @c SVN_REPOS__LOG_INDEX is not copied at all.
  *
  * BATON is a (struct hotcopy_ctx_t *).  BATON->SRC_LEN is the length
  * of PATH.
@@ -1892,6 +1893,12 @@ static svn_error_t *hotcopy_structure(void *baton,
           (svn_dirent_get_longest_ancestor(SVN_REPOS__FORMAT, sub_path, pool),
            SVN_REPOS__FORMAT) == 0)
         return SVN_NO_ERROR;
+
+      /* The changed-paths index may be written to while we copy it.  It
+         can be rebuilt from the copied revisions at any time. */
+      if (strncmp(sub_path, SVN_REPOS__LOG_INDEX,
+                  sizeof(SVN_REPOS__LOG_INDEX) - 1) == 0)
+        return SVN_NO_ERROR;
     }
 
   target = svn_dirent_join(ctx->dest, sub_path, pool);
@@ -1964,10 +1971,11 @@ fs_hotcopy_notify(void *baton,
 
 /* Make a copy of a repository with hot backup of fs. */
 svn_error_t *
-svn_repos_hotcopy3(const char *src_path,
+svn_repos_hotcopy4(const char *src_path,
                    const char *dst_path,
                    svn_boolean_t clean_logs,
                    svn_boolean_t incremental,
+                   int jobs,
                    svn_repos_notify_func_t notify_func,
                    void *notify_baton,
                    svn_cancel_func_t cancel_func,
@@ -2052,8 +2060,8 @@ svn_repos_hotcopy3(const char *src_path,
   fs_notify_baton.notify_func = notify_func;
   fs_notify_baton.notify_baton = notify_baton;
 
-  SVN_ERR(svn_fs_hotcopy3(src_repos->db_path, dst_repos->db_path,
-                          clean_logs, incremental,
+  SVN_ERR(svn_fs_hotcopy4(src_repos->db_path, dst_repos->db_path,
+                          clean_logs, incremental, jobs,
                           fs_notify_func, &fs_notify_baton,
                           cancel_func, cancel_baton, scratch_pool));
 
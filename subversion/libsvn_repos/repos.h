@@ -65,6 +65,7 @@ extern "C" {
 #define SVN_REPOS__LOCK_DIR    "locks"      /* Lock files live here. */
 #define SVN_REPOS__HOOK_DIR    "hooks"      /* Hook programs. */
 #define SVN_REPOS__CONF_DIR    "conf"       /* Configuration files. */
+#define SVN_REPOS__LOG_INDEX   "log-index.db" /* Changed-paths index. */
 
 /* Things for which we keep lockfiles. */
 #define SVN_REPOS__DB_LOCKFILE "db.lock" /* Our Berkeley lockfile. */
@@ -387,6 +388,118 @@ svn_repos__prev_location(svn_revnum_t *appeared_rev,
                          const char *path,
                          apr_pool_t *pool);
 
+/* If AUTHZ_READ_FUNC is svn_repos_authz_check_read, set *READABLE to an
+   array of PATHS->NELTS booleans, allocated in RESULT_POOL, telling
+   whether the respective element of PATHS, an array of const char * paths
+   in ROOT, is readable according to AUTHZ_READ_BATON.  All PATHS get
+   checked in a single call to svn_repos_authz_check_access_many, so they
+   should be ordered such that parent paths come before their sub-paths
+   and siblings are next to each other.
+
+   For any other AUTHZ_READ_FUNC, including NULL, set *READABLE to NULL.
+   Checking paths up front would defeat the callers' short-cuts and can
+   be expensive for callbacks like mod_dav_svn's, so the callers have to
+   invoke AUTHZ_READ_FUNC for every path as they get to it.
+
+   Use SCRATCH_POOL for temporary allocations. */
+svn_error_t *
+svn_repos__authz_read_many(svn_boolean_t **readable,
+                           svn_fs_root_t *root,
+                           const apr_array_header_t *paths,
+                           svn_repos_authz_func_t authz_read_func,
+                           void *authz_read_baton,
+                           apr_pool_t *result_pool,
+                           apr_pool_t *scratch_pool);
+
+
+/*** Dumpstream Parsing ***/
+
+/* Like svn_repos_parse_dumpstream3() but read and parse STREAM in a
+   separate thread while the callbacks in PARSE_FNS get called from the
+   calling thread.  The callbacks will be called in the same order and
+   with the same data as for svn_repos_parse_dumpstream3().  CANCEL_FUNC
+   will only be called from the calling thread.
+
+   Without thread support in APR, this is the same as
+   svn_repos_parse_dumpstream3(). */
+svn_error_t *
+svn_repos__parse_dumpstream_pipelined(svn_stream_t *stream,
+                                      const svn_repos_parse_fns3_t *parse_fns,
+                                      void *parse_baton,
+                                      svn_boolean_t deltas_are_text,
+                                      svn_cancel_func_t cancel_func,
+                                      void *cancel_baton,
+                                      apr_pool_t *pool);
+
+
+/*** Changed-paths Index ***/
+
+/* An open, read-only changed-paths index of a repository, as built by
+   svn_repos_build_log_index(). */
+typedef struct svn_repos__log_index_t svn_repos__log_index_t;
+
+/* The history of one path, read from a svn_repos__log_index_t. */
+typedef struct svn_repos__log_index_history_t svn_repos__log_index_history_t;
+
+/* Set *INDEX to the changed-paths index of REPOS, allocated in
+   RESULT_POOL.  Set it to NULL if REPOS has no index or if the index
+   does not belong to the current contents of REPOS.  Use SCRATCH_POOL
+   for temporary allocations. */
+svn_error_t *
+svn_repos__log_index_open(svn_repos__log_index_t **index,
+                          svn_repos_t *repos,
+                          apr_pool_t *result_pool,
+                          apr_pool_t *scratch_pool);
+
+/* Return the youngest revision covered by INDEX. */
+svn_revnum_t
+svn_repos__log_index_youngest(svn_repos__log_index_t *index);
+
+/* Set *HISTORY to a new history object for PATH in REVISION, which must
+   not be younger than svn_repos__log_index_youngest(INDEX).  PATH must
+   exist in REVISION.  If STRICT is set, the history will stop at the
+   first copy instead of following it.  Allocate *HISTORY in
+   RESULT_POOL. */
+svn_error_t *
+svn_repos__log_index_history(svn_repos__log_index_history_t **history,
+                             svn_repos__log_index_t *index,
+                             const char *path,
+                             svn_revnum_t revision,
+                             svn_boolean_t strict,
+                             apr_pool_t *result_pool);
+
+/* Set *REVISION and *PATH to the next older location of HISTORY at which
+   its node was changed, in the same order in which svn_fs_history_prev2()
+   would return them.  Set *REVISION to SVN_INVALID_REVNUM when there is
+   no more history.  *PATH is valid until the next call.  Use SCRATCH_POOL
+   for temporary allocations. */
+svn_error_t *
+svn_repos__log_index_history_prev(svn_revnum_t *revision,
+                                  const char **path,
+                                  svn_repos__log_index_history_t *history,
+                                  apr_pool_t *scratch_pool);
+
+/* If REPOS has a changed-paths index, add all revisions up to REVISION
+   to it that it does not cover yet.  Replace indexed revisions that are
+   not the ones in REPOS anymore, e.g. after a restore from a backup.
+   Use SCRATCH_POOL for temporary allocations. */
+svn_error_t *
+svn_repos__log_index_update(svn_repos_t *repos,
+                            svn_revnum_t revision,
+                            apr_pool_t *scratch_pool);
+
+/* If REPOS has a changed-paths index, tell it that the svn:date of
+   REVISION has been changed from OLD_DATE, which may be NULL.  The index
+   identifies revisions by their date, so it would not be used anymore
+   otherwise.  Revisions that the index has recorded with a different
+   date than OLD_DATE remain mismatched.  Use SCRATCH_POOL for temporary
+   allocations. */
+svn_error_t *
+svn_repos__log_index_date_changed(svn_repos_t *repos,
+                                  svn_revnum_t revision,
+                                  const svn_string_t *old_date,
+                                  apr_pool_t *scratch_pool);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
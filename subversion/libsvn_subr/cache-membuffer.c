@@ -23,6 +23,7 @@
 
 #include <assert.h>
 #include <apr_md5.h>
+#include <apr_shm.h>
 #include <apr_thread_rwlock.h>
 
 #include "svn_pools.h"
@@ -40,6 +41,7 @@
 
 #include "cache.h"
 #include "fnv1a.h"
+#include "pools.h"
 
 /*
  * This svn_cache__t implementation actually consists of two parts:
@@ -146,6 +148,130 @@
 #  define USE_SIMPLE_MUTEX 0
 #endif
 
+/* Even with segmentation, read locks become a bottleneck on machines with
+ * many cores because every reader modifies the (shared) lock object.
+ * Therefore, lookups may first try to read the cache without taking any
+ * lock at all.
+ *
+ * This is implemented as a sequence lock:  Every writer increments the
+ * segment's WRITE_SEQUENCE counter right after acquiring the write lock
+ * and again right before releasing it, i.e. the counter is odd while a
+ * modification is in progress.  Lock-free readers copy the data they need
+ * and check afterwards that the counter has neither been odd nor changed
+ * in the meantime.  If it has, they discard the copy and retry under the
+ * read lock.
+ *
+ * Lock-free readers never write to the segment:  Once a writer got in, the
+ * entry they found may have been moved or reused for another key.  Hence,
+ * they don't count hits in the entries' HIT_COUNT and count their lookups
+ * in separate atomic counters.  Their accesses still get recorded in the
+ * frequency sketch (see SKETCH_HASH_COUNT) that decides about promotion
+ * into L2.
+ *
+ * This requires a read memory barrier, which APR does not provide.  So,
+ * we can only support it for some compilers.  Also, debug builds use the
+ * locking code paths only to be able to verify the data being read.
+ */
+#if APR_HAS_THREADS && !defined(SVN_DEBUG_CACHE_MEMBUFFER)
+#  if defined(__ATOMIC_ACQUIRE)
+#    define OPTIMISTIC_READS 1
+#    define READ_BARRIER() __atomic_thread_fence(__ATOMIC_ACQUIRE)
+#  elif defined(_MSC_VER)
+#    define OPTIMISTIC_READS 1
+#    define READ_BARRIER() MemoryBarrier()
+#  endif
+#endif
+
+#ifndef OPTIMISTIC_READS
+#  define OPTIMISTIC_READS 0
+#endif
+
+/* The cache may be allocated in shared memory such that processes forked
+ * from the creator share it (see svn_cache__membuffer_cache_create_shared).
+ * Because the segments then contain pointers, we can't support named
+ * mappings that unrelated processes might attach at different addresses.
+ *
+ * Access is serialized across processes by a few shared_lock_t that live
+ * in the shared region itself and need no re-initialization in child
+ * processes.  Each consists of a robust, process-shared pthread mutex and
+ * a table of per-process reader counts.  Readers register under the mutex
+ * and release it right away; writers keep the mutex and wait for all
+ * readers to leave.
+ *
+ * Processes may die while holding a lock.  The robust mutex tells the next
+ * one to acquire it (EOWNERDEAD), which then detects an interrupted
+ * modification through the odd WRITE_SEQUENCE and clears the segment.
+ * Reader counts of dead processes get dropped by the next writer.  Without
+ * robust mutexes, a single crash could deadlock all processes; we don't
+ * support shared caches on such platforms.
+ */
+#if APR_HAS_THREADS && !USE_SIMPLE_MUTEX && APR_HAS_SHARED_MEMORY \
+    && defined(HAVE_PTHREAD_MUTEXATTR_SETROBUST)
+#  define SHARED_MEMORY_CACHE 1
+#else
+#  define SHARED_MEMORY_CACHE 0
+#endif
+
+#if SHARED_MEMORY_CACHE
+#  include <errno.h>
+#  include <pthread.h>
+#  include <signal.h>
+#  include <unistd.h>
+#endif
+
+/* Maximum number of cross-process locks for a shared cache.  Segments
+ * share locks if there are more segments than that.
+ */
+#define SHARED_LOCK_COUNT 16
+
+/* Number of processes that may hold a read lock on the same shared_lock_t
+ * at the same time.  Further readers wait for a slot to become free.
+ */
+#define SHARED_READER_SLOTS 64
+
+/* Time in microseconds to sleep between checks while waiting for the
+ * readers of a shared_lock_t to leave or for a free reader slot.
+ */
+#define SHARED_LOCK_POLL_TIME 50
+
+#if SHARED_MEMORY_CACHE
+
+/* A process that holds read locks on a shared_lock_t.
+ */
+typedef struct shared_reader_t
+{
+  /* The process ID.  Only valid while COUNT is not 0. */
+  pid_t pid;
+
+  /* Number of read locks held by threads of process PID.  Incremented
+   * under the mutex but decremented without it. */
+  volatile svn_atomic_t count;
+} shared_reader_t;
+
+/* A readers / writer lock that serializes access to some shared memory
+ * cache segments across processes.  It lives in shared memory itself.
+ */
+typedef struct shared_lock_t
+{
+  /* Robust, process-shared mutex.  Writers hold it for the duration of
+   * their access, readers only while registering in READERS. */
+  pthread_mutex_t mutex;
+
+  /* Processes that currently hold read locks. */
+  shared_reader_t readers[SHARED_READER_SLOTS];
+} shared_lock_t;
+
+#endif
+
+/* Alignment of the cache structures within shared memory.
+ */
+#define SHARED_ALIGNMENT 64
+
+/* Lock-free partial getters operate on a stack copy of the cached item.
+ * Larger items are read under the lock, i.e. without copying them.
+ */
+#define OPTIMISTIC_PARTIAL_READ_LIMIT 0x1000
+
 /* For more efficient copy operations, let's align all data items properly.
  * Since we can't portably align pointers, this is rather the item size
  * granularity which ensures *relative* alignment within the cache - still
@@ -197,6 +323,21 @@
  */
 #define MAX_ITEM_SIZE ((apr_uint32_t)(0 - ITEM_ALIGNMENT))
 
+/* Entries only get promoted from L1 to L2 if they are accessed at least
+ * as often as the L2 entries they would replace.  Because hit counters
+ * get lost once an entry has been evicted, each segment keeps a TinyLFU-
+ * style frequency sketch of all recent accesses, including misses:
+ * A count-min sketch with SKETCH_HASH_COUNT counters per key, each
+ * saturating at SKETCH_MAX_COUNT.  Once SKETCH_SAMPLE_FACTOR accesses per
+ * counter have been recorded, all counters get halved.
+ *
+ * Thus, a single large scan (e.g. a full dump or log) will not flush
+ * items that are frequently requested by other users.
+ */
+#define SKETCH_HASH_COUNT 4
+#define SKETCH_MAX_COUNT 15
+#define SKETCH_SAMPLE_FACTOR 10
+
 /* We use this structure to identify cache entries. There cannot be two
  * entries with the same entry key. However unlikely, though, two different
  * full keys (see full_key_t) may have the same entry key.  That is a
@@ -240,6 +381,19 @@ typedef struct full_key_t
   svn_membuf_t full_key;
 } full_key_t;
 
+/* Access statistics for all cache front-ends that use the same key prefix.
+ * Updates are not synchronized and values may be nonsensicle on some
+ * platforms.
+ */
+typedef struct prefix_stats_t
+{
+  /* Number of lookups. */
+  apr_uint64_t gets;
+
+  /* Number of lookups that found the requested item. */
+  apr_uint64_t hits;
+} prefix_stats_t;
+
 /* A limited capacity, thread-safe pool of unique C strings.  Operations on
  * this data structure are defined by prefix_pool_* functions.  The only
  * "public" member is VALUES (r/o access only).
@@ -267,6 +421,10 @@ typedef struct prefix_pool_t
    * the implementation may . */
   apr_size_t bytes_used;
 
+  /* Map C string to the prefix_stats_t for that prefix.  This is
+   * independent from VALUES but has the same capacity VALUES_MAX. */
+  apr_hash_t *stats;
+
   /* The serialization object. */
   svn_mutex__t *mutex;
 } prefix_pool_t;
@@ -307,6 +465,8 @@ prefix_pool_create(prefix_pool_t **prefix_pool,
   result->bytes_max = bytes_max;
   result->bytes_used = capacity * sizeof(svn_membuf_t);
 
+  result->stats = svn_hash__make(result_pool);
+
   SVN_ERR(svn_mutex__init(&result->mutex, mutex_required, result_pool));
 
   /* Done. */
@@ -391,6 +551,44 @@ prefix_pool_get(apr_uint32_t *prefix_idx,
   return SVN_NO_ERROR;
 }
 
+/* Set *STATS to the access statistics for PREFIX in PREFIX_POOL.  If none
+ * exist, auto-insert them.  If we can't due to capacity exhaustion, set
+ * *STATS to NULL.  To be called by prefix_pool_get_stats() only. */
+static svn_error_t *
+prefix_pool_get_stats_internal(prefix_stats_t **stats,
+                               prefix_pool_t *prefix_pool,
+                               const char *prefix)
+{
+  apr_pool_t *pool;
+  apr_size_t prefix_len = strlen(prefix);
+
+  /* Lookup.  Those are permanent, so return them if they exist. */
+  *stats = apr_hash_get(prefix_pool->stats, prefix, prefix_len);
+  if (*stats || apr_hash_count(prefix_pool->stats) >= prefix_pool->values_max)
+    return SVN_NO_ERROR;
+
+  /* Add new entry. */
+  pool = apr_hash_pool_get(prefix_pool->stats);
+  *stats = apr_pcalloc(pool, sizeof(**stats));
+  apr_hash_set(prefix_pool->stats, apr_pstrndup(pool, prefix, prefix_len),
+               prefix_len, *stats);
+
+  return SVN_NO_ERROR;
+}
+
+/* Thread-safe wrapper around prefix_pool_get_stats_internal. */
+static svn_error_t *
+prefix_pool_get_stats(prefix_stats_t **stats,
+                      prefix_pool_t *prefix_pool,
+                      const char *prefix)
+{
+  SVN_MUTEX__WITH_LOCK(prefix_pool->mutex,
+                       prefix_pool_get_stats_internal(stats, prefix_pool,
+                                                      prefix));
+
+  return SVN_NO_ERROR;
+}
+
 /* Debugging / corruption detection support.
  * If you define this macro, the getter functions will performed expensive
  * checks on the item data, requested keys and entry types. If there is
@@ -748,6 +946,21 @@ struct svn_membuffer_t
    */
   apr_uint64_t max_entry_size;
 
+  /* Access frequency sketch with SKETCH_MASK + 1 counters.  See
+   * SKETCH_HASH_COUNT for details.  Never NULL.
+   * Updates are not synchronized.
+   */
+  unsigned char *sketch;
+
+  /* Number of counters in SKETCH minus 1.  SKETCH's size is a power of 2.
+   */
+  apr_uint32_t sketch_mask;
+
+  /* Number of accesses recorded in SKETCH since its counters have been
+   * halved the last time.  Updated atomically.
+   */
+  svn_atomic_t sketch_samples;
+
   /* The cache levels, organized as sub-buffers.  Since entries in the
    * DIRECTORY use offsets in DATA for addressing, a cache lookup does
    * not need to know the cache level of a specific item.  Cache levels
@@ -796,6 +1009,13 @@ struct svn_membuffer_t
    */
   apr_uint64_t total_hits;
 
+  /* Number of lookups and hits served without taking any lock.  These are
+   * not included in TOTAL_READS and TOTAL_HITS.  Purely statistical
+   * information as well but updated atomically.  They may wrap around.
+   */
+  svn_atomic_t optimistic_reads;
+  svn_atomic_t optimistic_hits;
+
 #if (APR_HAS_THREADS && USE_SIMPLE_MUTEX)
   /* A lock for intra-process synchronization to the cache, or NULL if
    * the cache's creator doesn't feel the cache needs to be
@@ -813,6 +1033,19 @@ struct svn_membuffer_t
   svn_boolean_t allow_blocking_writes;
 #endif
 
+#if SHARED_MEMORY_CACHE
+  /* If not NULL, this segment lives in shared memory and LOCK is NULL.
+   * This lock then serializes all access across processes and threads.
+   * It may be shared with other segments.
+   */
+  shared_lock_t *shared_lock;
+#endif
+
+  /* Modification counter.  It is odd while some thread holds the write
+   * lock.  See OPTIMISTIC_READS.
+   */
+  svn_atomic_t write_sequence;
+
   /* A write lock counter, must be either 0 or 1.
    * This one is only used in debug assertions to verify that you used
    * the correct multi-threading settings. */
@@ -823,11 +1056,285 @@ struct svn_membuffer_t
  */
 #define ALIGN_VALUE(value) (((value) + ITEM_ALIGNMENT-1) & -ITEM_ALIGNMENT)
 
+/* Drop all contents of the segment CACHE.  The caller must hold the
+ * write lock.
+ */
+static void
+reset_segment(svn_membuffer_t *cache)
+{
+  /* Length of the group_initialized array in bytes.
+     See also svn_cache__membuffer_cache_create(). */
+  apr_size_t group_init_size
+    = 1 + (cache->group_count + cache->spare_group_count)
+            / (8 * GROUP_INIT_GRANULARITY);
+
+  /* Mark all groups as "not initialized", which implies "empty". */
+  cache->first_spare_group = NO_INDEX;
+  cache->max_spare_used = 0;
+
+  memset(cache->group_initialized, 0, group_init_size);
+
+  /* Unlink L1 contents. */
+  cache->l1.first = NO_INDEX;
+  cache->l1.last = NO_INDEX;
+  cache->l1.next = NO_INDEX;
+  cache->l1.current_data = cache->l1.start_offset;
+
+  /* Unlink L2 contents. */
+  cache->l2.first = NO_INDEX;
+  cache->l2.last = NO_INDEX;
+  cache->l2.next = NO_INDEX;
+  cache->l2.current_data = cache->l2.start_offset;
+
+  /* Reset content counters. */
+  cache->data_used = 0;
+  cache->used_entries = 0;
+}
+
+/* Return TRUE, if access to CACHE is serialized by some lock.
+ */
+static APR_INLINE svn_boolean_t
+is_synchronized(svn_membuffer_t *cache)
+{
+#if SHARED_MEMORY_CACHE
+  if (cache->shared_lock)
+    return TRUE;
+#endif
+
+#if APR_HAS_THREADS
+  return cache->lock != NULL;
+#else
+  return FALSE;
+#endif
+}
+
+#if SHARED_MEMORY_CACHE
+
+/* Acquire the mutex of the cross-process lock of the shared memory
+ * segment CACHE.  If TRY_ONLY is set, don't wait for the mutex but set
+ * *SUCCESS to FALSE if it is taken.  Otherwise, set it to TRUE.
+ *
+ * If the previous owner died while modifying the segment, clear it.
+ */
+static svn_error_t *
+lock_shared_mutex(svn_membuffer_t *cache,
+                  svn_boolean_t try_only,
+                  svn_boolean_t *success)
+{
+  pthread_mutex_t *mutex = &cache->shared_lock->mutex;
+  int rc = try_only ? pthread_mutex_trylock(mutex)
+                    : pthread_mutex_lock(mutex);
+
+  if (rc == EBUSY)
+    {
+      *success = FALSE;
+      return SVN_NO_ERROR;
+    }
+
+  /* The previous owner died while holding the mutex.  We own it now but
+   * must mark it as usable again. */
+  if (rc == EOWNERDEAD)
+    rc = pthread_mutex_consistent(mutex);
+
+  if (rc)
+    return svn_error_wrap_apr(APR_FROM_OS_ERROR(rc),
+                              _("Can't lock cache mutex"));
+
+  /* Some process died while modifying this segment.  Its contents
+   * may be inconsistent, so drop them.  Because modifications drain
+   * all readers first and readers need the mutex to register, nobody
+   * else can be looking at the segment right now. */
+  if (svn_atomic_read(&cache->write_sequence) & 1)
+    {
+      reset_segment(cache);
+      svn_atomic_inc(&cache->write_sequence);
+    }
+
+  *success = TRUE;
+  return SVN_NO_ERROR;
+}
+
+/* Release the mutex of the cross-process lock of CACHE.
+ * Return ERR upon success.
+ */
+static svn_error_t *
+unlock_shared_mutex(svn_membuffer_t *cache, svn_error_t *err)
+{
+  int rc = pthread_mutex_unlock(&cache->shared_lock->mutex);
+  if (err)
+    return err;
+
+  if (rc)
+    return svn_error_wrap_apr(APR_FROM_OS_ERROR(rc),
+                              _("Can't unlock cache mutex"));
+
+  return SVN_NO_ERROR;
+}
+
+/* Return TRUE if the process of READER does no longer exist.
+ */
+static svn_boolean_t
+is_dead_reader(const shared_reader_t *reader)
+{
+  return kill(reader->pid, 0) != 0 && errno == ESRCH;
+}
+
+/* Return the slot in the cross-process lock of CACHE to register a read
+ * lock of process PID in.  Prefer the slot that PID already uses.  Return
+ * NULL, if all slots are being used by other processes.  The caller must
+ * hold the mutex.
+ */
+static shared_reader_t *
+find_reader_slot(svn_membuffer_t *cache, pid_t pid)
+{
+  shared_reader_t *readers = cache->shared_lock->readers;
+  shared_reader_t *unused = NULL;
+  int i;
+
+  for (i = 0; i < SHARED_READER_SLOTS; ++i)
+    if (svn_atomic_read(&readers[i].count) == 0)
+      {
+        if (unused == NULL)
+          unused = &readers[i];
+      }
+    else if (readers[i].pid == pid)
+      {
+        return &readers[i];
+      }
+
+  /* All taken.  Reclaim slots from processes that died with read locks. */
+  if (unused == NULL)
+    for (i = 0; i < SHARED_READER_SLOTS; ++i)
+      if (is_dead_reader(&readers[i]))
+        {
+          svn_atomic_set(&readers[i].count, 0);
+          if (unused == NULL)
+            unused = &readers[i];
+        }
+
+  return unused;
+}
+
+/* Return TRUE if any living process holds a read lock on the cross-process
+ * lock of CACHE.  Drop the read locks of dead processes.  The caller must
+ * hold the mutex.
+ */
+static svn_boolean_t
+has_shared_readers(svn_membuffer_t *cache)
+{
+  shared_reader_t *readers = cache->shared_lock->readers;
+  svn_boolean_t result = FALSE;
+  int i;
+
+  for (i = 0; i < SHARED_READER_SLOTS; ++i)
+    if (svn_atomic_read(&readers[i].count))
+      {
+        if (is_dead_reader(&readers[i]))
+          svn_atomic_set(&readers[i].count, 0);
+        else
+          result = TRUE;
+      }
+
+  return result;
+}
+
+/* Acquire a read lock on the cross-process lock of CACHE.  Other readers
+ * may hold it at the same time, in this and other processes.
+ */
+static svn_error_t *
+read_lock_shared_cache(svn_membuffer_t *cache)
+{
+  pid_t pid = getpid();
+  while (TRUE)
+    {
+      shared_reader_t *slot;
+      svn_boolean_t got_lock;
+      SVN_ERR(lock_shared_mutex(cache, FALSE, &got_lock));
+
+      slot = find_reader_slot(cache, pid);
+      if (slot)
+        {
+          /* The writers only check the count, so set the PID first. */
+          slot->pid = pid;
+          svn_atomic_inc(&slot->count);
+          return svn_error_trace(unlock_shared_mutex(cache, SVN_NO_ERROR));
+        }
+
+      SVN_ERR(unlock_shared_mutex(cache, SVN_NO_ERROR));
+      apr_sleep(SHARED_LOCK_POLL_TIME);
+    }
+}
+
+/* Release a read lock acquired by read_lock_shared_cache on CACHE.
+ * Return ERR upon success.
+ */
+static svn_error_t *
+read_unlock_shared_cache(svn_membuffer_t *cache, svn_error_t *err)
+{
+  shared_reader_t *readers = cache->shared_lock->readers;
+  pid_t pid = getpid();
+  int i;
+
+  /* Our slot can't be reclaimed while we hold the read lock.  Other slots
+   * may get claimed concurrently but their PID is set before the count. */
+  for (i = 0; i < SHARED_READER_SLOTS; ++i)
+    if (svn_atomic_read(&readers[i].count) && readers[i].pid == pid)
+      {
+        svn_atomic_dec(&readers[i].count);
+        return err;
+      }
+
+  return svn_error_compose_create(
+           err,
+           svn_error_create(SVN_ERR_ASSERTION_FAIL, NULL,
+                            _("Cache read lock not held")));
+}
+
+/* Acquire a write lock on the cross-process lock of CACHE.  If SUCCESS is
+ * not NULL and CACHE does not allow for blocking writes, don't wait for
+ * the mutex or for readers to leave but set *SUCCESS to FALSE instead.
+ */
+static svn_error_t *
+write_lock_shared_cache(svn_membuffer_t *cache, svn_boolean_t *success)
+{
+  svn_boolean_t try_only = success && !cache->allow_blocking_writes;
+  svn_boolean_t got_lock;
+
+  SVN_ERR(lock_shared_mutex(cache, try_only, &got_lock));
+  if (!got_lock)
+    {
+      *success = FALSE;
+      return SVN_NO_ERROR;
+    }
+
+  /* New readers can't register while we hold the mutex.  Wait for the
+   * current ones to finish. */
+  while (has_shared_readers(cache))
+    {
+      if (try_only)
+        {
+          *success = FALSE;
+          return svn_error_trace(unlock_shared_mutex(cache, SVN_NO_ERROR));
+        }
+
+      apr_sleep(SHARED_LOCK_POLL_TIME);
+    }
+
+  return SVN_NO_ERROR;
+}
+
+#endif
+
 /* If locking is supported for CACHE, acquire a read lock for it.
  */
 static svn_error_t *
 read_lock_cache(svn_membuffer_t *cache)
 {
+#if SHARED_MEMORY_CACHE
+  if (cache->shared_lock)
+    return svn_error_trace(read_lock_shared_cache(cache));
+#endif
+
 #if (APR_HAS_THREADS && USE_SIMPLE_MUTEX)
   return svn_mutex__lock(cache->lock);
 #elif (APR_HAS_THREADS && !USE_SIMPLE_MUTEX)
@@ -844,6 +1351,24 @@ read_lock_cache(svn_membuffer_t *cache)
 #endif
 }
 
+/* Tell lock-free readers of CACHE that a modification is about to begin.
+ * The caller must hold the write lock.
+ */
+static APR_INLINE void
+begin_modification(svn_membuffer_t *cache)
+{
+  svn_atomic_inc(&cache->write_sequence);
+}
+
+/* Tell lock-free readers of CACHE that the current modification has been
+ * completed.  The caller must still hold the write lock.
+ */
+static APR_INLINE void
+end_modification(svn_membuffer_t *cache)
+{
+  svn_atomic_inc(&cache->write_sequence);
+}
+
 /* If locking is supported for CACHE, acquire a write lock for it.
  * Set *SUCCESS to FALSE, if we couldn't acquire the write lock;
  * leave it untouched otherwise.
@@ -851,8 +1376,24 @@ read_lock_cache(svn_membuffer_t *cache)
 static svn_error_t *
 write_lock_cache(svn_membuffer_t *cache, svn_boolean_t *success)
 {
+#if SHARED_MEMORY_CACHE
+  if (cache->shared_lock)
+    {
+      svn_boolean_t got_lock = TRUE;
+      SVN_ERR(write_lock_shared_cache(cache, &got_lock));
+      if (!got_lock)
+        {
+          *success = FALSE;
+          return SVN_NO_ERROR;
+        }
+
+      begin_modification(cache);
+      return SVN_NO_ERROR;
+    }
+#endif
+
 #if (APR_HAS_THREADS && USE_SIMPLE_MUTEX)
-  return svn_mutex__lock(cache->lock);
+  SVN_ERR(svn_mutex__lock(cache->lock));
 #elif (APR_HAS_THREADS && !USE_SIMPLE_MUTEX)
   if (cache->lock)
     {
@@ -867,7 +1408,7 @@ write_lock_cache(svn_membuffer_t *cache, svn_boolean_t *success)
           if (SVN_LOCK_IS_BUSY(status))
             {
               *success = FALSE;
-              status = APR_SUCCESS;
+              return SVN_NO_ERROR;
             }
         }
 
@@ -875,11 +1416,10 @@ write_lock_cache(svn_membuffer_t *cache, svn_boolean_t *success)
         return svn_error_wrap_apr(status,
                                   _("Can't write-lock cache mutex"));
     }
+#endif
 
+  begin_modification(cache);
   return SVN_NO_ERROR;
-#else
-  return SVN_NO_ERROR;
-#endif
 }
 
 /* If locking is supported for CACHE, acquire an unconditional write lock
@@ -888,26 +1428,42 @@ write_lock_cache(svn_membuffer_t *cache, svn_boolean_t *success)
 static svn_error_t *
 force_write_lock_cache(svn_membuffer_t *cache)
 {
+#if SHARED_MEMORY_CACHE
+  if (cache->shared_lock)
+    {
+      SVN_ERR(write_lock_shared_cache(cache, NULL));
+      begin_modification(cache);
+      return SVN_NO_ERROR;
+    }
+#endif
+
 #if (APR_HAS_THREADS && USE_SIMPLE_MUTEX)
-  return svn_mutex__lock(cache->lock);
+  SVN_ERR(svn_mutex__lock(cache->lock));
 #elif (APR_HAS_THREADS && !USE_SIMPLE_MUTEX)
-  apr_status_t status = apr_thread_rwlock_wrlock(cache->lock);
-  if (status)
-    return svn_error_wrap_apr(status,
-                              _("Can't write-lock cache mutex"));
+  {
+    apr_status_t status = apr_thread_rwlock_wrlock(cache->lock);
+    if (status)
+      return svn_error_wrap_apr(status,
+                                _("Can't write-lock cache mutex"));
+  }
+#endif
 
+  begin_modification(cache);
   return SVN_NO_ERROR;
-#else
-  return SVN_NO_ERROR;
-#endif
 }
 
 /* If locking is supported for CACHE, release the current lock
- * (read or write).  Return ERR upon success.
+ * (read or write).  Return ERR upon success.  For shared memory caches,
+ * this releases the write lock only; see read_unlock_cache.
  */
 static svn_error_t *
 unlock_cache(svn_membuffer_t *cache, svn_error_t *err)
 {
+#if SHARED_MEMORY_CACHE
+  if (cache->shared_lock)
+    return unlock_shared_mutex(cache, err);
+#endif
+
 #if (APR_HAS_THREADS && USE_SIMPLE_MUTEX)
   return svn_mutex__unlock(cache->lock, err);
 #elif (APR_HAS_THREADS && !USE_SIMPLE_MUTEX)
@@ -927,13 +1483,37 @@ unlock_cache(svn_membuffer_t *cache, svn_error_t *err)
 #endif
 }
 
+/* Release the write lock on CACHE acquired by write_lock_cache or
+ * force_write_lock_cache.  Return ERR upon success.
+ */
+static svn_error_t *
+write_unlock_cache(svn_membuffer_t *cache, svn_error_t *err)
+{
+  end_modification(cache);
+  return unlock_cache(cache, err);
+}
+
+/* Release the read lock on CACHE acquired by read_lock_cache.
+ * Return ERR upon success.
+ */
+static svn_error_t *
+read_unlock_cache(svn_membuffer_t *cache, svn_error_t *err)
+{
+#if SHARED_MEMORY_CACHE
+  if (cache->shared_lock)
+    return read_unlock_shared_cache(cache, err);
+#endif
+
+  return unlock_cache(cache, err);
+}
+
 /* If supported, guard the execution of EXPR with a read lock to CACHE.
  * The macro has been modeled after SVN_MUTEX__WITH_LOCK.
  */
 #define WITH_READ_LOCK(cache, expr)         \
 do {                                        \
   SVN_ERR(read_lock_cache(cache));          \
-  SVN_ERR(unlock_cache(cache, (expr)));     \
+  SVN_ERR(read_unlock_cache(cache, (expr)));\
 } while (0)
 
 /* If supported, guard the execution of EXPR with a write lock to CACHE.
@@ -959,7 +1539,7 @@ do {                                                            \
       else                                                      \
         break;                                                  \
     }                                                           \
-  SVN_ERR(unlock_cache(cache, (expr)));                         \
+  SVN_ERR(write_unlock_cache(cache, (expr)));                   \
 } while (0)
 
 /* Returns 0 if the entry group identified by GROUP_INDEX in CACHE has not
@@ -1365,6 +1945,90 @@ let_entry_age(svn_membuffer_t *cache, entry_t *entry)
     }
 }
 
+/* Return the position of the INDEX-th counter for KEY in CACHE's
+ * frequency sketch.
+ */
+static APR_INLINE apr_uint32_t
+sketch_position(svn_membuffer_t *cache,
+                const entry_key_t *key,
+                int index)
+{
+  /* Double hashing.  Use the upper bits of the products because those
+   * depend on all bits of the fingerprint. */
+  apr_uint64_t h1 = key->fingerprint[0] * APR_UINT64_C(0x9e3779b97f4a7c15);
+  apr_uint64_t h2 = key->fingerprint[1] * APR_UINT64_C(0xc2b2ae3d27d4eb4f);
+
+  return (apr_uint32_t)((h1 + index * (h2 | 1)) >> 32) & cache->sketch_mask;
+}
+
+/* Return the estimated number of recent accesses to KEY in CACHE.
+ */
+static apr_uint32_t
+get_frequency(svn_membuffer_t *cache, const entry_key_t *key)
+{
+  apr_uint32_t result = SKETCH_MAX_COUNT;
+  int i;
+
+  for (i = 0; i < SKETCH_HASH_COUNT; ++i)
+    result = MIN(result, cache->sketch[sketch_position(cache, key, i)]);
+
+  return result;
+}
+
+/* Halve all counters in CACHE's frequency sketch such that old accesses
+ * lose their weight over time.  This does not require any lock, either.
+ */
+static void
+age_frequencies(svn_membuffer_t *cache)
+{
+  apr_size_t i;
+  apr_size_t count = (apr_size_t)cache->sketch_mask + 1;
+  apr_uint32_t samples;
+
+  for (i = 0; i < count; ++i)
+    cache->sketch[i] >>= 1;
+
+  /* Other threads may have recorded further accesses in the meantime. */
+  do
+    samples = svn_atomic_read(&cache->sketch_samples);
+  while (svn_atomic_cas(&cache->sketch_samples, samples / 2, samples)
+         != samples);
+}
+
+/* Record an access to KEY in CACHE's frequency sketch and age the sketch
+ * once enough accesses have been recorded.  Lookups call this, so the
+ * frequencies decay even if the cache is hardly ever written to.
+ *
+ * This does not require any lock.  Concurrent updates may get lost but
+ * that will only make the frequency estimates slightly less accurate.
+ */
+static void
+record_access(svn_membuffer_t *cache, const entry_key_t *key)
+{
+  apr_uint64_t threshold
+    = ((apr_uint64_t)cache->sketch_mask + 1) * SKETCH_SAMPLE_FACTOR;
+  unsigned char *counters[SKETCH_HASH_COUNT];
+  unsigned char min_count = SKETCH_MAX_COUNT;
+  int i;
+
+  for (i = 0; i < SKETCH_HASH_COUNT; ++i)
+    {
+      counters[i] = &cache->sketch[sketch_position(cache, key, i)];
+      min_count = MIN(min_count, *counters[i]);
+    }
+
+  /* Conservative update: only increment the counters that determine
+   * the estimate.  This reduces the over-estimation due to collisions. */
+  for (i = 0; i < SKETCH_HASH_COUNT; ++i)
+    if (*counters[i] == min_count && min_count < SKETCH_MAX_COUNT)
+      ++*counters[i];
+
+  /* The counter only grows until the sketch gets aged, so exactly one
+   * of the concurrent callers will see it reach the threshold. */
+  if ((apr_uint64_t)svn_atomic_inc(&cache->sketch_samples) + 1 == threshold)
+    age_frequencies(cache);
+}
+
 /* Return whether the keys in LHS and RHS match.
  */
 static svn_boolean_t
@@ -1646,8 +2310,12 @@ ensure_data_insertable_l2(svn_membuffer_t *cache,
   /* accumulated "worth" of items dropped so far */
   apr_uint64_t drop_hits = 0;
 
+  /* Number of recent accesses to the new entry, including those before
+   * it had been added to the cache. */
+  apr_uint32_t frequency = get_frequency(cache, &to_fit_in->key);
+
   /* estimated "worth" of the new entry */
-  apr_uint64_t drop_hits_limit = (to_fit_in->hit_count + 1)
+  apr_uint64_t drop_hits_limit = (frequency + 1)
                                * (apr_uint64_t)to_fit_in->priority;
 
   /* This loop will eventually terminate because every cache entry
@@ -1702,15 +2370,17 @@ ensure_data_insertable_l2(svn_membuffer_t *cache,
       else
         {
           svn_boolean_t keep;
+          apr_uint32_t entry_frequency;
           entry = get_entry(cache, cache->l2.next);
+          entry_frequency = get_frequency(cache, &entry->key);
 
           if (to_fit_in->priority < SVN_CACHE__MEMBUFFER_DEFAULT_PRIORITY)
             {
               /* Low prio items can only be accepted only if the current
-               * entry is of even lower prio and has fewer hits.
+               * entry is of even lower prio and is accessed less often.
                */
               if (   entry->priority > to_fit_in->priority
-                  || entry->hit_count > to_fit_in->hit_count)
+                  || entry_frequency > frequency)
                 return FALSE;
             }
 
@@ -1726,12 +2396,14 @@ ensure_data_insertable_l2(svn_membuffer_t *cache,
             {
               /* If the existing data is the same prio as the incoming data,
                * drop the existing entry if it had seen fewer (probably 0)
-               * hits than the entry coming in from L1.  In case of different
-               * priorities, keep the current entry of it has higher prio.
+               * recent accesses than the entry coming in from L1.  Items
+               * touched only once by some scan will therefore not replace
+               * frequently used ones.  In case of different priorities,
+               * keep the current entry of it has higher prio.
                * The new entry may still find room by ousting other entries.
                */
               keep = to_fit_in->priority == entry->priority
-                   ? entry->hit_count >= to_fit_in->hit_count
+                   ? entry_frequency >= frequency
                    : entry->priority > to_fit_in->priority;
             }
 
@@ -1753,7 +2425,7 @@ ensure_data_insertable_l2(svn_membuffer_t *cache,
                * provide the same data but in a further stage of processing.
                */
               if (entry->priority > SVN_CACHE__MEMBUFFER_LOW_PRIORITY)
-                drop_hits += entry->hit_count * (apr_uint64_t)entry->priority;
+                drop_hits += entry_frequency * (apr_uint64_t)entry->priority;
 
               drop_entry(cache, entry);
             }
@@ -1832,30 +2504,74 @@ ensure_data_insertable_l1(svn_membuffer_t *cache, apr_size_t size)
    * right answer. */
 }
 
-svn_error_t *
-svn_cache__membuffer_cache_create(svn_membuffer_t **cache,
-                                  apr_size_t total_size,
-                                  apr_size_t directory_size,
-                                  apr_size_t segment_count,
-                                  svn_boolean_t thread_safe,
-                                  svn_boolean_t allow_blocking_writes,
-                                  apr_pool_t *pool)
+/* Return SIZE bytes of memory for a cache structure.  If *SHARED_NEXT is
+ * not NULL, take them from the shared memory region at that position and
+ * advance *SHARED_NEXT accordingly.  Otherwise, allocate them in POOL and
+ * zero them if CLEAR is set.  Shared memory is always zero-initialized.
+ */
+static void *
+cache_alloc(char **shared_next,
+            apr_uint64_t size,
+            svn_boolean_t clear,
+            apr_pool_t *pool)
+{
+  void *result;
+  if (*shared_next == NULL)
+    return clear ? apr_pcalloc(pool, (apr_size_t)size)
+                 : apr_palloc(pool, (apr_size_t)size);
+
+  result = *shared_next;
+  *shared_next += APR_ALIGN(size, SHARED_ALIGNMENT);
+
+  return result;
+}
+
+/* Implement svn_cache__membuffer_cache_create and
+ * svn_cache__membuffer_cache_create_shared.  If SHARED is set, allocate
+ * all segments in an anonymous shared memory region and serialize access
+ * with cross-process locks.  THREAD_SAFE is ignored in that case.
+ */
+static svn_error_t *
+membuffer_cache_create(svn_membuffer_t **cache,
+                       apr_size_t total_size,
+                       apr_size_t directory_size,
+                       apr_size_t segment_count,
+                       svn_boolean_t thread_safe,
+                       svn_boolean_t allow_blocking_writes,
+                       svn_boolean_t shared,
+                       apr_pool_t *pool)
 {
   svn_membuffer_t *c;
   prefix_pool_t *prefix_pool;
+  char *shared_next = NULL;
+#if SHARED_MEMORY_CACHE
+  shared_lock_t *shared_locks = NULL;
+  apr_size_t shared_lock_count = 0;
+#endif
 
   apr_uint32_t seg;
   apr_uint32_t group_count;
   apr_uint32_t main_group_count;
   apr_uint32_t spare_group_count;
   apr_uint32_t group_init_size;
+  apr_uint64_t sketch_size;
   apr_uint64_t data_size;
   apr_uint64_t max_entry_size;
 
+#if !SHARED_MEMORY_CACHE
+  if (shared)
+    return svn_error_create(SVN_ERR_UNSUPPORTED_FEATURE, NULL,
+                            _("Shared memory caches are not supported "
+                              "on this platform"));
+#endif
+
   /* Allocate 1% of the cache capacity to the prefix string pool.
+   *
+   * Prefix indexes are process-local.  Thus, entries in a shared cache
+   * can't use them and the pool remains empty.
    */
-  SVN_ERR(prefix_pool_create(&prefix_pool, total_size / 100, thread_safe,
-                             pool));
+  SVN_ERR(prefix_pool_create(&prefix_pool, shared ? 0 : total_size / 100,
+                             thread_safe || shared, pool));
   total_size -= total_size / 100;
 
   /* Limit the total size (only relevant if we can address > 4GB)
@@ -1910,9 +2626,6 @@ svn_cache__membuffer_cache_create(svn_membuffer_t **cache,
          && segment_count < MAX_SEGMENT_COUNT)
     segment_count *= 2;
 
-  /* allocate cache as an array of segments / cache objects */
-  c = apr_palloc(pool, segment_count * sizeof(*c));
-
   /* Split total cache size into segments of equal size
    */
   total_size /= segment_count;
@@ -1931,21 +2644,6 @@ svn_cache__membuffer_cache_create(svn_membuffer_t **cache,
   if (directory_size < 2 * sizeof(entry_group_t))
     directory_size = 2 * sizeof(entry_group_t);
 
-  /* limit the data size to what we can address.
-   * Note that this cannot overflow since all values are of size_t.
-   * Also, make it a multiple of the item placement granularity to
-   * prevent subtle overflows.
-   */
-  data_size = ALIGN_VALUE(total_size - directory_size + 1) - ITEM_ALIGNMENT;
-
-  /* For cache sizes > 16TB, individual cache segments will be larger
-   * than 32GB allowing for >4GB entries.  But caching chunks larger
-   * than 4GB are simply not supported.
-   */
-  max_entry_size = data_size / 8 > MAX_ITEM_SIZE
-                 ? MAX_ITEM_SIZE
-                 : data_size / 8;
-
   /* to keep the entries small, we use 32 bit indexes only
    * -> we need to ensure that no more than 4G entries exist.
    *
@@ -1963,6 +2661,95 @@ svn_cache__membuffer_cache_create(svn_membuffer_t **cache,
   assert(spare_group_count > 0 && main_group_count > 0);
 
   group_init_size = 1 + group_count / (8 * GROUP_INIT_GRANULARITY);
+
+  /* one frequency counter per (main) entry, rounded down to a power of 2 */
+  for (sketch_size = 1;
+       sketch_size * 2 <= (apr_uint64_t)main_group_count * GROUP_SIZE
+         && sketch_size < APR_UINT32_MAX / 2;
+       sketch_size *= 2)
+    ;
+
+  /* The sketch counts against the cache size as well.  Take it from the
+   * data buffer but leave at least half of the latter for the data.
+   */
+  while (sketch_size > 1 && sketch_size > (total_size - directory_size) / 2)
+    sketch_size /= 2;
+
+  /* limit the data size to what we can address.
+   * Note that this cannot overflow since all values are of size_t.
+   * Also, make it a multiple of the item placement granularity to
+   * prevent subtle overflows.
+   */
+  data_size = ALIGN_VALUE(total_size - directory_size - sketch_size + 1)
+            - ITEM_ALIGNMENT;
+
+  /* For cache sizes > 16TB, individual cache segments will be larger
+   * than 32GB allowing for >4GB entries.  But caching chunks larger
+   * than 4GB are simply not supported.
+   */
+  max_entry_size = data_size / 8 > MAX_ITEM_SIZE
+                 ? MAX_ITEM_SIZE
+                 : data_size / 8;
+
+#if SHARED_MEMORY_CACHE
+  if (shared)
+    {
+      /* Map one region for all segments and their buffers.  The region
+       * and the locks must never be released because other processes
+       * may still use them.  Hence, use an unmanaged pool that won't run
+       * any cleanups in the forked children either. */
+      apr_pool_t *shared_pool = svn_pool__create_unmanaged(FALSE);
+      apr_shm_t *shm;
+      apr_status_t status;
+      apr_uint64_t region_size
+        = APR_ALIGN(SHARED_LOCK_COUNT * sizeof(*shared_locks),
+                    SHARED_ALIGNMENT)
+        + APR_ALIGN(segment_count * sizeof(*c), SHARED_ALIGNMENT)
+        + segment_count
+          * (  APR_ALIGN(group_count * sizeof(entry_group_t),
+                         SHARED_ALIGNMENT)
+             + APR_ALIGN(group_init_size, SHARED_ALIGNMENT)
+             + APR_ALIGN(ALIGN_VALUE(data_size), SHARED_ALIGNMENT)
+             + APR_ALIGN(sketch_size, SHARED_ALIGNMENT));
+
+      if (region_size != (apr_size_t)region_size)
+        return svn_error_wrap_apr(APR_ENOMEM, "OOM");
+
+      status = apr_shm_create(&shm, (apr_size_t)region_size, NULL,
+                              shared_pool);
+      if (status)
+        return svn_error_wrap_apr(status,
+                                  _("Can't create shared memory cache"));
+
+      shared_next = apr_shm_baseaddr_get(shm);
+
+      shared_lock_count = MIN(segment_count, SHARED_LOCK_COUNT);
+      shared_locks = cache_alloc(&shared_next,
+                                 SHARED_LOCK_COUNT * sizeof(*shared_locks),
+                                 TRUE, pool);
+      for (seg = 0; seg < shared_lock_count; ++seg)
+        {
+          pthread_mutexattr_t attr;
+          int rc = pthread_mutexattr_init(&attr);
+          if (!rc)
+            rc = pthread_mutexattr_setpshared(&attr,
+                                              PTHREAD_PROCESS_SHARED);
+          if (!rc)
+            rc = pthread_mutexattr_setrobust(&attr, PTHREAD_MUTEX_ROBUST);
+          if (!rc)
+            rc = pthread_mutex_init(&shared_locks[seg].mutex, &attr);
+
+          pthread_mutexattr_destroy(&attr);
+          if (rc)
+            return svn_error_wrap_apr(APR_FROM_OS_ERROR(rc),
+                                      _("Can't create cache mutex"));
+        }
+    }
+#endif
+
+  /* allocate cache as an array of segments / cache objects */
+  c = cache_alloc(&shared_next, segment_count * sizeof(*c), FALSE, pool);
+
   for (seg = 0; seg < segment_count; ++seg)
     {
       /* allocate buffers and initialize cache members
@@ -1978,12 +2765,14 @@ svn_cache__membuffer_cache_create(svn_membuffer_t **cache,
       /* Allocate but don't clear / zero the directory because it would add
          significantly to the server start-up time if the caches are large.
          Group initialization will take care of that in stead. */
-      c[seg].directory = apr_palloc(pool,
-                                    group_count * sizeof(entry_group_t));
+      c[seg].directory = cache_alloc(&shared_next,
+                                     group_count * sizeof(entry_group_t),
+                                     FALSE, pool);
 
       /* Allocate and initialize directory entries as "not initialized",
          hence "unused" */
-      c[seg].group_initialized = apr_pcalloc(pool, group_init_size);
+      c[seg].group_initialized = cache_alloc(&shared_next, group_init_size,
+                                             TRUE, pool);
 
       /* Allocate 1/4th of the data buffer to L1
        */
@@ -2004,14 +2793,21 @@ svn_cache__membuffer_cache_create(svn_membuffer_t **cache,
       c[seg].l2.current_data = c[seg].l2.start_offset;
 
       /* This cast is safe because DATA_SIZE <= MAX_SEGMENT_SIZE. */
-      c[seg].data = apr_palloc(pool, (apr_size_t)ALIGN_VALUE(data_size));
+      c[seg].data = cache_alloc(&shared_next, ALIGN_VALUE(data_size),
+                                FALSE, pool);
       c[seg].data_used = 0;
       c[seg].max_entry_size = max_entry_size;
 
+      c[seg].sketch = cache_alloc(&shared_next, sketch_size, TRUE, pool);
+      c[seg].sketch_mask = (apr_uint32_t)(sketch_size - 1);
+      c[seg].sketch_samples = 0;
+
       c[seg].used_entries = 0;
       c[seg].total_reads = 0;
       c[seg].total_writes = 0;
       c[seg].total_hits = 0;
+      c[seg].optimistic_reads = 0;
+      c[seg].optimistic_hits = 0;
 
       /* were allocations successful?
        * If not, initialize a minimal cache structure.
@@ -2023,6 +2819,12 @@ svn_cache__membuffer_cache_create(svn_membuffer_t **cache,
           return svn_error_wrap_apr(APR_ENOMEM, "OOM");
         }
 
+#if SHARED_MEMORY_CACHE
+      /* Shared segments are synchronized by SHARED_LOCK only. */
+      c[seg].shared_lock = shared ? &shared_locks[seg % shared_lock_count]
+                                  : NULL;
+#endif
+
 #if (APR_HAS_THREADS && USE_SIMPLE_MUTEX)
       /* A lock for intra-process synchronization to the cache, or NULL if
        * the cache's creator doesn't feel the cache needs to be
@@ -2032,7 +2834,7 @@ svn_cache__membuffer_cache_create(svn_membuffer_t **cache,
 #elif (APR_HAS_THREADS && !USE_SIMPLE_MUTEX)
       /* Same for read-write lock. */
       c[seg].lock = NULL;
-      if (thread_safe)
+      if (thread_safe && !shared)
         {
           apr_status_t status =
               apr_thread_rwlock_create(&(c[seg].lock), pool);
@@ -2044,6 +2846,8 @@ svn_cache__membuffer_cache_create(svn_membuffer_t **cache,
        */
       c[seg].allow_blocking_writes = allow_blocking_writes;
 #endif
+      c[seg].write_sequence = 0;
+
       /* No writers at the moment. */
       c[seg].write_lock_count = 0;
     }
@@ -2054,18 +2858,43 @@ svn_cache__membuffer_cache_create(svn_membuffer_t **cache,
   return SVN_NO_ERROR;
 }
 
+svn_error_t *
+svn_cache__membuffer_cache_create(svn_membuffer_t **cache,
+                                  apr_size_t total_size,
+                                  apr_size_t directory_size,
+                                  apr_size_t segment_count,
+                                  svn_boolean_t thread_safe,
+                                  svn_boolean_t allow_blocking_writes,
+                                  apr_pool_t *pool)
+{
+  return svn_error_trace(membuffer_cache_create(cache, total_size,
+                                                directory_size,
+                                                segment_count, thread_safe,
+                                                allow_blocking_writes,
+                                                FALSE, pool));
+}
+
+svn_error_t *
+svn_cache__membuffer_cache_create_shared(svn_membuffer_t **cache,
+                                         apr_size_t total_size,
+                                         apr_size_t directory_size,
+                                         apr_size_t segment_count,
+                                         svn_boolean_t allow_blocking_writes,
+                                         apr_pool_t *pool)
+{
+  return svn_error_trace(membuffer_cache_create(cache, total_size,
+                                                directory_size,
+                                                segment_count, TRUE,
+                                                allow_blocking_writes,
+                                                TRUE, pool));
+}
+
 svn_error_t *
 svn_cache__membuffer_clear(svn_membuffer_t *cache)
 {
   apr_size_t seg;
   apr_size_t segment_count = cache->segment_count;
 
-  /* Length of the group_initialized array in bytes.
-     See also svn_cache__membuffer_cache_create(). */
-  apr_size_t group_init_size
-    = 1 + (cache->group_count + cache->spare_group_count)
-            / (8 * GROUP_INIT_GRANULARITY);
-
   /* Clear segment by segment.  This implies that other thread may read
      and write to other segments after we cleared them and before the
      last segment is done.
@@ -2079,30 +2908,10 @@ svn_cache__membuffer_clear(svn_membuffer_t *cache)
       /* Unconditionally acquire the write lock. */
       SVN_ERR(force_write_lock_cache(&cache[seg]));
 
-      /* Mark all groups as "not initialized", which implies "empty". */
-      cache[seg].first_spare_group = NO_INDEX;
-      cache[seg].max_spare_used = 0;
-
-      memset(cache[seg].group_initialized, 0, group_init_size);
-
-      /* Unlink L1 contents. */
-      cache[seg].l1.first = NO_INDEX;
-      cache[seg].l1.last = NO_INDEX;
-      cache[seg].l1.next = NO_INDEX;
-      cache[seg].l1.current_data = cache[seg].l1.start_offset;
-
-      /* Unlink L2 contents. */
-      cache[seg].l2.first = NO_INDEX;
-      cache[seg].l2.last = NO_INDEX;
-      cache[seg].l2.next = NO_INDEX;
-      cache[seg].l2.current_data = cache[seg].l2.start_offset;
-
-      /* Reset content counters. */
-      cache[seg].data_used = 0;
-      cache[seg].used_entries = 0;
+      reset_segment(&cache[seg]);
 
       /* Segment may be used again. */
-      SVN_ERR(unlock_cache(&cache[seg], SVN_NO_ERROR));
+      SVN_ERR(write_unlock_cache(&cache[seg], SVN_NO_ERROR));
     }
 
   /* done here */
@@ -2143,12 +2952,13 @@ entry_exists(svn_membuffer_t *cache,
   return SVN_NO_ERROR;
 }
 
-/* Given the SIZE and PRIORITY of a new item, return the cache level
+/* Given the KEY, SIZE and PRIORITY of a new item, return the cache level
    (L1 or L2) in fragment CACHE that this item shall be inserted into.
    If we can't find nor make enough room for the item, return NULL.
  */
 static cache_level_t *
 select_level(svn_membuffer_t *cache,
+             const entry_key_t *key,
              apr_size_t size,
              apr_uint32_t priority)
 {
@@ -2165,6 +2975,7 @@ select_level(svn_membuffer_t *cache,
     {
       /* Large but important items go into L2. */
       entry_t dummy_entry = { { { 0 } } };
+      dummy_entry.key = *key;
       dummy_entry.priority = priority;
       dummy_entry.size = size;
 
@@ -2257,7 +3068,9 @@ membuffer_cache_set_internal(svn_membuffer_t *cache,
 
   /* if necessary, enlarge the insertion window.
    */
-  level = buffer ? select_level(cache, size, priority) : NULL;
+  level = buffer
+        ? select_level(cache, &to_find->entry_key, size, priority)
+        : NULL;
   if (level)
     {
       /* Remove old data for this key, if that exists.
@@ -2370,6 +3183,153 @@ increment_hit_counters(svn_membuffer_t *cache, entry_t *entry)
   cache->total_hits++;
 }
 
+#if OPTIMISTIC_READS
+
+/* Begin a lock-free read from CACHE and return the modification counter
+ * to pass to optimistic_read_valid afterwards.
+ */
+static APR_INLINE apr_uint32_t
+optimistic_read_begin(svn_membuffer_t *cache)
+{
+  apr_uint32_t sequence = svn_atomic_read(&cache->write_sequence);
+  READ_BARRIER();
+
+  return sequence;
+}
+
+/* Return TRUE, if no writer modified CACHE since optimistic_read_begin
+ * returned SEQUENCE, i.e. if all data read from CACHE in between is
+ * consistent.
+ */
+static APR_INLINE svn_boolean_t
+optimistic_read_valid(svn_membuffer_t *cache, apr_uint32_t sequence)
+{
+  READ_BARRIER();
+
+  return (sequence & 1) == 0
+      && svn_atomic_read(&cache->write_sequence) == sequence;
+}
+
+/* Lock-free variant of find_entry with FIND_EMPTY being FALSE.  Return
+ * the entry in CACHE's group GROUP_INDEX that matches TO_FIND, or NULL.
+ * Copy the entry's contents to *COPY because the entry itself may change
+ * at any time.
+ *
+ * Writers may modify CACHE concurrently.  Therefore, all indexes, offsets
+ * and sizes read from CACHE get checked before being used and the group
+ * chain walk is bounded.  The result may still be bogus and must only be
+ * used if optimistic_read_valid confirms the read.
+ */
+static entry_t *
+find_entry_optimistic(svn_membuffer_t *cache,
+                      apr_uint32_t group_index,
+                      const full_key_t *to_find,
+                      entry_t *copy)
+{
+  apr_uint32_t group_limit = cache->group_count + cache->spare_group_count;
+  apr_uint64_t data_size = cache->l2.start_offset + cache->l2.size;
+  entry_group_t *group = &cache->directory[group_index];
+  int chain_length;
+  apr_size_t i;
+
+  if (! is_group_initialized(cache, group_index))
+    return NULL;
+
+  for (chain_length = 0;
+       chain_length < MAX_GROUP_CHAIN_LENGTH;
+       ++chain_length)
+    {
+      apr_uint32_t used = group->header.used;
+      apr_uint32_t next = group->header.next;
+
+      if (used > GROUP_SIZE)
+        return NULL;
+
+      for (i = 0; i < used; ++i)
+        if (entry_keys_match(&group->entries[i].key, &to_find->entry_key))
+          {
+            *copy = group->entries[i];
+
+            /* Valid entries never exceed the data buffer. */
+            if (   copy->size > cache->max_entry_size
+                || copy->key.key_len > copy->size
+                || copy->offset > data_size - ALIGN_VALUE(copy->size))
+              return NULL;
+
+            /* Compare the full key. Upon conflict, the entry to find
+             * cannot be anywhere else. */
+            if (   copy->key.key_len
+                && memcmp(to_find->full_key.data,
+                          cache->data + copy->offset,
+                          copy->key.key_len) != 0)
+              return NULL;
+
+            return &group->entries[i];
+          }
+
+      /* end of chain? */
+      if (next >= group_limit)
+        return NULL;
+
+      group = &cache->directory[next];
+    }
+
+  return NULL;
+}
+
+/* Lock-free variant of membuffer_cache_get_internal.  Set *SUCCESS to
+ * TRUE if the lookup was not disturbed by concurrent modifications.
+ * Otherwise, set it to FALSE and the caller must repeat the lookup under
+ * the read lock.
+ */
+static void
+membuffer_cache_get_optimistic(svn_membuffer_t *cache,
+                               apr_uint32_t group_index,
+                               const full_key_t *to_find,
+                               char **buffer,
+                               apr_size_t *item_size,
+                               svn_boolean_t *success,
+                               apr_pool_t *result_pool)
+{
+  entry_t *entry;
+  entry_t copy;
+  apr_size_t size;
+  apr_uint32_t sequence = optimistic_read_begin(cache);
+
+  /* Don't bother while some writer is active. */
+  *success = FALSE;
+  if (sequence & 1)
+    return;
+
+  entry = find_entry_optimistic(cache, group_index, to_find, &copy);
+  if (entry == NULL)
+    {
+      *buffer = NULL;
+      *item_size = 0;
+    }
+  else
+    {
+      size = ALIGN_VALUE(copy.size) - copy.key.key_len;
+      *buffer = apr_palloc(result_pool, size);
+      memcpy(*buffer, cache->data + copy.offset + copy.key.key_len, size);
+      *item_size = copy.size - copy.key.key_len;
+    }
+
+  /* This must come after the last access to ENTRY and the data. */
+  if (!optimistic_read_valid(cache, sequence))
+    return;
+
+  /* Update the statistics but don't touch ENTRY anymore.  A writer may
+   * have got in by now. */
+  svn_atomic_inc(&cache->optimistic_reads);
+  if (entry)
+    svn_atomic_inc(&cache->optimistic_hits);
+
+  *success = TRUE;
+}
+
+#endif
+
 /* Look for the cache entry in group GROUP_INDEX of CACHE, identified
  * by the hash value TO_FIND. If no item has been stored for KEY,
  * *BUFFER will be NULL. Otherwise, return a copy of the serialized
@@ -2449,18 +3409,30 @@ membuffer_cache_get(svn_membuffer_t *cache,
   apr_uint32_t group_index;
   char *buffer;
   apr_size_t size;
+  svn_boolean_t done = FALSE;
 
   /* find the entry group that will hold the key.
    */
   group_index = get_group_index(&cache, &key->entry_key);
-  WITH_READ_LOCK(cache,
-                 membuffer_cache_get_internal(cache,
-                                              group_index,
-                                              key,
-                                              &buffer,
-                                              &size,
-                                              DEBUG_CACHE_MEMBUFFER_TAG
-                                              result_pool));
+  record_access(cache, &key->entry_key);
+
+#if OPTIMISTIC_READS
+  /* Try without locking first.  Only if that gets disturbed by some
+   * writer, we need to wait for the lock. */
+  if (is_synchronized(cache))
+    membuffer_cache_get_optimistic(cache, group_index, key, &buffer, &size,
+                                   &done, result_pool);
+#endif
+
+  if (!done)
+    WITH_READ_LOCK(cache,
+                   membuffer_cache_get_internal(cache,
+                                                group_index,
+                                                key,
+                                                &buffer,
+                                                &size,
+                                                DEBUG_CACHE_MEMBUFFER_TAG
+                                                result_pool));
 
   /* re-construct the original data object from its serialized form.
    */
@@ -2516,6 +3488,7 @@ membuffer_cache_has_key(svn_membuffer_t *cache,
    */
   apr_uint32_t group_index = get_group_index(&cache, &key->entry_key);
   cache->total_reads++;
+  record_access(cache, &key->entry_key);
 
   WITH_READ_LOCK(cache,
                  membuffer_cache_has_key_internal(cache,
@@ -2583,6 +3556,74 @@ membuffer_cache_get_partial_internal(svn_membuffer_t *cache,
     }
 }
 
+#if OPTIMISTIC_READS
+
+/* Lock-free variant of membuffer_cache_get_partial_internal.  Because the
+ * DESERIALIZER must not see inconsistent data, it operates on a copy of
+ * the cached item.  Set *SUCCESS to TRUE if the lookup was not disturbed
+ * by concurrent modifications and the item was small enough to be copied.
+ * Otherwise, set it to FALSE and the caller must repeat the lookup under
+ * the read lock.
+ */
+static svn_error_t *
+membuffer_cache_get_partial_optimistic(svn_membuffer_t *cache,
+                                       apr_uint32_t group_index,
+                                       const full_key_t *to_find,
+                                       void **item,
+                                       svn_boolean_t *found,
+                                       svn_cache__partial_getter_func_t deserializer,
+                                       void *baton,
+                                       svn_boolean_t *success,
+                                       apr_pool_t *result_pool)
+{
+  /* Use an integer array to get a properly aligned copy. */
+  apr_uint64_t item_copy[OPTIMISTIC_PARTIAL_READ_LIMIT
+                         / sizeof(apr_uint64_t)];
+  entry_t *entry;
+  entry_t copy;
+  apr_size_t item_size = 0;
+  apr_uint32_t sequence = optimistic_read_begin(cache);
+
+  /* Don't bother while some writer is active. */
+  *success = FALSE;
+  if (sequence & 1)
+    return SVN_NO_ERROR;
+
+  entry = find_entry_optimistic(cache, group_index, to_find, &copy);
+  if (entry)
+    {
+      item_size = copy.size - copy.key.key_len;
+      if (item_size > sizeof(item_copy))
+        return SVN_NO_ERROR;
+
+      memcpy(item_copy, cache->data + copy.offset + copy.key.key_len,
+             item_size);
+    }
+
+  /* This must come after the last access to ENTRY and the data.  From
+   * here on, we only use our copies. */
+  if (!optimistic_read_valid(cache, sequence))
+    return SVN_NO_ERROR;
+
+  svn_atomic_inc(&cache->optimistic_reads);
+  *success = TRUE;
+
+  if (entry == NULL)
+    {
+      *item = NULL;
+      *found = FALSE;
+
+      return SVN_NO_ERROR;
+    }
+
+  *found = TRUE;
+  svn_atomic_inc(&cache->optimistic_hits);
+
+  return deserializer(item, item_copy, item_size, baton, result_pool);
+}
+
+#endif
+
 /* Look for the cache entry identified by KEY. FOUND indicates
  * whether that entry exists. If not found, *ITEM will be NULL. Otherwise,
  * the DESERIALIZER is called with that entry and the BATON provided
@@ -2600,12 +3641,25 @@ membuffer_cache_get_partial(svn_membuffer_t *cache,
                             apr_pool_t *result_pool)
 {
   apr_uint32_t group_index = get_group_index(&cache, &key->entry_key);
+  svn_boolean_t done = FALSE;
 
-  WITH_READ_LOCK(cache,
-                 membuffer_cache_get_partial_internal
-                     (cache, group_index, key, item, found,
-                      deserializer, baton, DEBUG_CACHE_MEMBUFFER_TAG
-                      result_pool));
+  record_access(cache, &key->entry_key);
+
+#if OPTIMISTIC_READS
+  /* Try without locking first. */
+  if (is_synchronized(cache))
+    SVN_ERR(membuffer_cache_get_partial_optimistic(cache, group_index, key,
+                                                   item, found, deserializer,
+                                                   baton, &done,
+                                                   result_pool));
+#endif
+
+  if (!done)
+    WITH_READ_LOCK(cache,
+                   membuffer_cache_get_partial_internal
+                       (cache, group_index, key, item, found,
+                        deserializer, baton, DEBUG_CACHE_MEMBUFFER_TAG
+                        result_pool));
 
   return SVN_NO_ERROR;
 }
@@ -2799,6 +3853,11 @@ typedef struct svn_membuffer_cache_t
   /* priority class for all items written through this interface */
   apr_uint32_t priority;
 
+  /* Access statistics shared by all caches with the same prefix.
+   * NULL if not available.
+   */
+  prefix_stats_t *stats;
+
   /* Temporary buffer containing the hash key for the current access
    */
   full_key_t combined_key;
@@ -2917,6 +3976,21 @@ combine_key(svn_membuffer_cache_t *cache,
     = data[1] ^ cache->prefix.fingerprint[1];
 }
 
+/* Count a lookup through CACHE in its per-prefix statistics.  FOUND tells
+ * whether the lookup returned data.
+ */
+static APR_INLINE void
+count_prefix_access(svn_membuffer_cache_t *cache,
+                    svn_boolean_t found)
+{
+  if (cache->stats)
+    {
+      cache->stats->gets++;
+      if (found)
+        cache->stats->hits++;
+    }
+}
+
 /* Implement svn_cache__vtable_t.get (not thread-safe)
  */
 static svn_error_t *
@@ -2954,6 +4028,7 @@ svn_membuffer_cache_get(void **value_p,
 
   /* return result */
   *found = *value_p != NULL;
+  count_prefix_access(cache, *found);
 
   return SVN_NO_ERROR;
 }
@@ -3068,6 +4143,7 @@ svn_membuffer_cache_get_partial(void **value_p,
                                       baton,
                                       DEBUG_CACHE_MEMBUFFER_TAG
                                       result_pool));
+  count_prefix_access(cache, *found);
 
   return SVN_NO_ERROR;
 }
@@ -3162,6 +4238,11 @@ svn_membuffer_cache_get_info(void *cache_void,
   /* cache front-end specific data */
 
   info->id = apr_pstrdup(result_pool, get_prefix_key(cache));
+  if (cache->stats)
+    {
+      info->prefix_gets = cache->stats->gets;
+      info->prefix_hits = cache->stats->hits;
+    }
 
   /* collect info from shared cache back-end */
 
@@ -3407,6 +4488,14 @@ svn_cache__create_membuffer_cache(svn_cache__t **cache_p,
   else
     cache->prefix.prefix_idx = NO_INDEX;
 
+  /* Short-lived caches tend to use unique prefixes that would exhaust
+   * the per-prefix statistics quickly. */
+  if (short_lived)
+    cache->stats = NULL;
+  else
+    SVN_ERR(prefix_pool_get_stats(&cache->stats, membuffer->prefix_pool,
+                                  prefix));
+
   /* If key combining is not guaranteed to produce unique results, we have
    * to handle full keys.  Otherwise, leave it NULL. */
   if (cache->prefix.prefix_idx == NO_INDEX)
@@ -3448,9 +4537,11 @@ static svn_error_t *
 svn_membuffer_get_global_segment_info(svn_membuffer_t *segment,
                                       svn_cache__info_t *info)
 {
-  info->gets += segment->total_reads;
+  info->gets += segment->total_reads
+              + svn_atomic_read(&segment->optimistic_reads);
   info->sets += segment->total_writes;
-  info->hits += segment->total_hits;
+  info->hits += segment->total_hits
+              + svn_atomic_read(&segment->optimistic_hits);
 
   WITH_READ_LOCK(segment,
                   svn_membuffer_get_segment_info(segment, info, TRUE));
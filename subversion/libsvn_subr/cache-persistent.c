@@ -0,0 +1,1242 @@
+/*
+ * cache-persistent.c: file-based, persistent second-level caching
+ *
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ */
+
+#include <apr_mmap.h>
+
+#include "svn_pools.h"
+#include "svn_io.h"
+#include "svn_dirent_uri.h"
+#include "svn_hash.h"
+#include "svn_sorts.h"
+
+#include "svn_private_config.h"
+#include "private/svn_atomic.h"
+#include "private/svn_cache.h"
+#include "private/svn_mutex.h"
+#include "private/svn_subr_private.h"
+
+#include "cache.h"
+
+/* A note on the file format:
+
+   The store file starts with a single header line that identifies the
+   file format, the platform's data layout and the user-provided version
+   tag.  It is followed by a sequence of records, each consisting of
+
+     - the key length, value length and FNV-1a checksum over key and value
+       as native 32 bit integers (RECORD_HEADER_SIZE bytes in total),
+     - the key, prefixed by the ID of the cache that it belongs to,
+     - the serialized value.
+
+   A later record for the same key supersedes the earlier ones.  The
+   store's stamp is kept in records with the key STAMP_KEY.
+
+   Records get only ever appended to the file, under an exclusive file
+   lock.  The file is never truncated in-place; instead, it is atomically
+   replaced by a new one.  Thus, other processes can safely keep their
+   memory mappings of the old file.  Before appending, writers check
+   whether the file has been replaced and switch to the new one.
+
+   When the file would grow beyond its maximum size, the writer replaces
+   it with a copy that holds only the latest record for each key, and
+   only the newest ones of those that fit into half the maximum size.
+
+   When opening the store, all records get indexed until the first one
+   that is incomplete or corrupted, e.g. due to a crash while writing it.
+   In the latter case, the file gets reset because later additions would
+   not be reachable otherwise.
+ */
+
+/* Version of the file format.  Bump this whenever the record format
+ * changes. */
+#define PERSISTENT_FORMAT 1
+
+/* Size of the binary record header. */
+#define RECORD_HEADER_SIZE (3 * sizeof(apr_uint32_t))
+
+/* Key of the stamp records.  Cache IDs are never empty, so this cannot
+ * collide with cache entries. */
+#define STAMP_KEY "\0stamp"
+#define STAMP_KEY_LEN (sizeof(STAMP_KEY) - 1)
+
+/* How often a writer switches to a replaced file before giving up. */
+#define MAX_REOPEN_ATTEMPTS 3
+
+/* Location of a value within the store's memory image. */
+typedef struct store_entry_t
+{
+  /* Start of the serialized value.  NULL for records that this process
+   * appended after loading the file. */
+  const char *data;
+
+  /* Length of the serialized value in bytes. */
+  apr_size_t size;
+
+  /* FNV-1a checksum of the serialized value.  Only set if DATA is NULL. */
+  apr_uint32_t checksum;
+} store_entry_t;
+
+/* The (internal) persistent store object. */
+struct svn_cache__persistent_store_t
+{
+  /* Path of the store file. */
+  const char *path;
+
+  /* Header line identifying compatible files. */
+  const char *header;
+
+  /* Keep the file below this size. */
+  apr_size_t max_size;
+
+  /* The open store file. */
+  apr_file_t *file;
+
+  /* Whether we may append to FILE.  This will not be the case if we don't
+   * have write access to it. */
+  svn_boolean_t writable;
+
+  /* Index over all records found when loading the file and those that
+   * we appended since.  Maps the prefixed key to store_entry_t *. */
+  apr_hash_t *index;
+
+  /* The latest stamp or NULL. */
+  const char *stamp;
+
+  /* Pool containing FILE, the memory image of the file, INDEX and STAMP.
+   * Gets replaced whenever we switch to a new file. */
+  apr_pool_t *image_pool;
+
+  /* Serializes all access to the members above, except the first three,
+   * which are constant. */
+  svn_mutex__t *mutex;
+
+  /* Pool containing the store.  Only to be used while holding MUTEX. */
+  apr_pool_t *pool;
+};
+
+/* The (internal) cache object. */
+typedef struct persistent_cache_t
+{
+  /* The first-level cache. */
+  svn_cache__t *l1_cache;
+
+  /* The second-level, persistent store. */
+  svn_cache__persistent_store_t *store;
+
+  /* Cache ID used to prefix all keys within STORE, including its
+   * terminating NUL. */
+  const char *id;
+  apr_size_t id_len;
+
+  /* The size of the key: either a fixed number of bytes or
+   * APR_HASH_KEY_STRING. */
+  apr_ssize_t klen;
+
+  /* Used to marshal values in and out of the store. */
+  svn_cache__serialize_func_t serialize_func;
+  svn_cache__deserialize_func_t deserialize_func;
+} persistent_cache_t;
+
+
+/* Return the header line for files written with VERSION, allocated in
+ * RESULT_POOL. */
+static const char *
+make_header(const char *version,
+            apr_pool_t *result_pool)
+{
+  const apr_uint32_t probe = 1;
+
+  /* The serialized data is in native format, so make sure that we don't
+   * mix data from different platform ABIs. */
+  return apr_psprintf(result_pool, "SVN-PERSISTENT-CACHE %d %s %d %d %s\n",
+                      PERSISTENT_FORMAT,
+                      *(const char *)&probe ? "le" : "be",
+                      (int)sizeof(void *), (int)sizeof(long),
+                      version);
+}
+
+/* Read the record header at DATA into *KEY_LEN, *VALUE_LEN and
+ * *CHECKSUM. */
+static void
+read_record_header(apr_uint32_t *key_len,
+                   apr_uint32_t *value_len,
+                   apr_uint32_t *checksum,
+                   const char *data)
+{
+  memcpy(key_len, data, sizeof(*key_len));
+  memcpy(value_len, data + sizeof(*key_len), sizeof(*value_len));
+  memcpy(checksum, data + 2 * sizeof(*key_len), sizeof(*checksum));
+}
+
+/* Return the checksum over the KEY_LEN bytes of KEY followed by the
+ * VALUE_LEN bytes of VALUE. */
+static apr_uint32_t
+record_checksum(const char *key,
+                apr_size_t key_len,
+                const char *value,
+                apr_size_t value_len)
+{
+  /* Keys and values are contiguous in the file as well as in the write
+   * buffer, so checksum them in one go. */
+  SVN_ERR_ASSERT_NO_RETURN(key + key_len == value);
+  return svn__fnv1a_32(key, key_len + value_len);
+}
+
+/* Parse the record at OFFSET within the SIZE bytes of DATA.  Set *KEY,
+ * *KEY_LEN, *VALUE and *VALUE_LEN to its contents and return the offset
+ * of the next record.  Return OFFSET if there is no complete and valid
+ * record at OFFSET. */
+static apr_size_t
+parse_record(const char **key,
+             apr_size_t *key_len,
+             const char **value,
+             apr_size_t *value_len,
+             const char *data,
+             apr_size_t offset,
+             apr_size_t size)
+{
+  apr_uint32_t klen, vlen, checksum;
+
+  if (size - offset < RECORD_HEADER_SIZE)
+    return offset;
+
+  read_record_header(&klen, &vlen, &checksum, data + offset);
+  if (   size - offset - RECORD_HEADER_SIZE < klen
+      || size - offset - RECORD_HEADER_SIZE - klen < vlen)
+    return offset;
+
+  *key = data + offset + RECORD_HEADER_SIZE;
+  *key_len = klen;
+  *value = *key + klen;
+  *value_len = vlen;
+  if (record_checksum(*key, *key_len, *value, *value_len) != checksum)
+    return offset;
+
+  return offset + RECORD_HEADER_SIZE + klen + vlen;
+}
+
+/* Return TRUE if the KEY_LEN bytes at KEY are the stamp key. */
+static svn_boolean_t
+is_stamp_key(const char *key,
+             apr_size_t key_len)
+{
+  return key_len == STAMP_KEY_LEN && memcmp(key, STAMP_KEY, key_len) == 0;
+}
+
+/* Index the records in the SIZE bytes of DATA, starting at offset START,
+ * and add them to STORE->INDEX.  Set *CORRUPT if not all data up to SIZE
+ * could be indexed.
+ */
+static void
+index_records(svn_cache__persistent_store_t *store,
+              svn_boolean_t *corrupt,
+              const char *data,
+              apr_size_t start,
+              apr_size_t size)
+{
+  apr_size_t offset = start;
+
+  while (TRUE)
+    {
+      const char *key, *value;
+      apr_size_t key_len, value_len;
+      apr_size_t next = parse_record(&key, &key_len, &value, &value_len,
+                                     data, offset, size);
+      store_entry_t *entry;
+
+      if (next == offset)
+        break;
+
+      if (is_stamp_key(key, key_len))
+        store->stamp = apr_pstrmemdup(store->image_pool, value, value_len);
+
+      entry = apr_pcalloc(store->image_pool, sizeof(*entry));
+      entry->data = value;
+      entry->size = value_len;
+      apr_hash_set(store->index, key, key_len, entry);
+
+      offset = next;
+    }
+
+  *corrupt = offset != size;
+}
+
+/* Set *DATA to the first SIZE bytes of STORE->FILE, mapped into or
+ * allocated in RESULT_POOL.  Use SCRATCH_POOL for temporary allocations.
+ */
+static svn_error_t *
+read_image(const char **data,
+           svn_cache__persistent_store_t *store,
+           apr_size_t size,
+           apr_pool_t *result_pool,
+           apr_pool_t *scratch_pool)
+{
+#if APR_HAS_MMAP
+  apr_mmap_t *mmap;
+  apr_status_t status = apr_mmap_create(&mmap, store->file, 0, size,
+                                        APR_MMAP_READ, result_pool);
+  if (status)
+    return svn_error_wrap_apr(status, _("Can't mmap '%s'"),
+                              svn_dirent_local_style(store->path,
+                                                     scratch_pool));
+
+  *data = mmap->mm;
+#else
+  char *buffer = apr_palloc(result_pool, size);
+  apr_off_t offset = 0;
+
+  SVN_ERR(svn_io_file_seek(store->file, APR_SET, &offset, scratch_pool));
+  SVN_ERR(svn_io_file_read_full2(store->file, buffer, size, NULL, NULL,
+                                 scratch_pool));
+  *data = buffer;
+#endif
+
+  return SVN_NO_ERROR;
+}
+
+/* Read and index the contents of STORE->FILE.  Set *VALID if the file
+ * header matches STORE->HEADER and the file contains no corrupted data.
+ * Use SCRATCH_POOL for temporary allocations.
+ */
+static svn_error_t *
+load_store(svn_cache__persistent_store_t *store,
+           svn_boolean_t *valid,
+           apr_pool_t *scratch_pool)
+{
+  apr_size_t header_len = strlen(store->header);
+  apr_pool_t *lock_pool = svn_pool_create(store->pool);
+  svn_filesize_t file_size;
+  apr_size_t size;
+  const char *data = NULL;
+  svn_boolean_t corrupt;
+  svn_error_t *err;
+
+  /* Appends are done under an exclusive lock, so this guarantees that
+   * we don't see partially written records (unless a writer crashed). */
+  SVN_ERR(svn_io_lock_open_file(store->file, FALSE, FALSE, lock_pool));
+
+  err = svn_io_file_size_get(&file_size, store->file, scratch_pool);
+  if (err || file_size < (svn_filesize_t)header_len)
+    {
+      *valid = FALSE;
+      svn_pool_destroy(lock_pool);
+      return svn_error_trace(err);
+    }
+
+  /* Ignore anything beyond MAX_SIZE.  It should not exist anyway. */
+  size = (apr_size_t)MIN(file_size, (svn_filesize_t)store->max_size);
+
+  err = read_image(&data, store, size, store->image_pool, scratch_pool);
+
+  svn_pool_destroy(lock_pool);
+  SVN_ERR(err);
+
+  if (memcmp(data, store->header, header_len))
+    {
+      *valid = FALSE;
+      return SVN_NO_ERROR;
+    }
+
+  index_records(store, &corrupt, data, header_len, size);
+
+  /* Junk at the end of a file that has been cut off at MAX_SIZE is o.k. */
+  *valid = !corrupt || size < file_size;
+
+  return SVN_NO_ERROR;
+}
+
+/* Drop all data that STORE loaded from its current file and close it. */
+static void
+unload_store(svn_cache__persistent_store_t *store)
+{
+  /* This closes the file and removes the memory mapping. */
+  if (store->image_pool)
+    svn_pool_destroy(store->image_pool);
+
+  store->image_pool = svn_pool_create(store->pool);
+  store->file = NULL;
+  store->index = apr_hash_make(store->image_pool);
+  store->stamp = NULL;
+}
+
+/* Atomically replace the file of STORE with one that contains the LEN
+ * bytes of DATA.  Use SCRATCH_POOL for temporary allocations. */
+static svn_error_t *
+replace_file(svn_cache__persistent_store_t *store,
+             const char *data,
+             apr_size_t len,
+             apr_pool_t *scratch_pool)
+{
+  svn_node_kind_t kind;
+
+  /* Keep the permissions of the existing file, which may be shared by
+   * several users of the repository. */
+  SVN_ERR(svn_io_check_path(store->path, &kind, scratch_pool));
+
+  return svn_error_trace(svn_io_write_atomic2(store->path, data, len,
+                                              kind == svn_node_file
+                                                ? store->path
+                                                : NULL,
+                                              FALSE, scratch_pool));
+}
+
+/* (Re-)Open the file for STORE, creating or replacing it if necessary,
+ * and index its contents, replacing any data previously loaded.  Use
+ * SCRATCH_POOL for temporary allocations.
+ */
+static svn_error_t *
+open_store(svn_cache__persistent_store_t *store,
+           apr_pool_t *scratch_pool)
+{
+  svn_boolean_t valid;
+  svn_error_t *err;
+
+  unload_store(store);
+  err = svn_io_file_open(&store->file, store->path,
+                         APR_READ | APR_WRITE | APR_CREATE | APR_BINARY,
+                         APR_OS_DEFAULT, store->image_pool);
+  store->writable = err == SVN_NO_ERROR;
+
+  /* Users without write access may still use the existing contents. */
+  if (err && APR_STATUS_IS_EACCES(err->apr_err))
+    {
+      svn_error_clear(err);
+      err = svn_io_file_open(&store->file, store->path,
+                             APR_READ | APR_BINARY, APR_OS_DEFAULT,
+                             store->image_pool);
+    }
+
+  SVN_ERR(err);
+  SVN_ERR(load_store(store, &valid, scratch_pool));
+  if (valid || !store->writable)
+    return SVN_NO_ERROR;
+
+  /* The file is from a different source or version, or it is corrupted.
+   * Replace it with an empty one.  Don't touch the old file as other
+   * processes might still have it mapped. */
+  unload_store(store);
+  SVN_ERR(replace_file(store, store->header, strlen(store->header),
+                       scratch_pool));
+  SVN_ERR(svn_io_file_open(&store->file, store->path,
+                           APR_READ | APR_WRITE | APR_BINARY,
+                           APR_OS_DEFAULT, store->image_pool));
+
+  return SVN_NO_ERROR;
+}
+
+/* Return a new store object for PATH, VERSION and MAX_SIZE in *STORE_P,
+ * allocated in RESULT_POOL.  Use SCRATCH_POOL for temporary allocations.
+ */
+static svn_error_t *
+create_store(svn_cache__persistent_store_t **store_p,
+             const char *path,
+             const char *version,
+             apr_size_t max_size,
+             apr_pool_t *result_pool,
+             apr_pool_t *scratch_pool)
+{
+  svn_cache__persistent_store_t *store = apr_pcalloc(result_pool,
+                                                     sizeof(*store));
+
+  store->path = apr_pstrdup(result_pool, path);
+  store->header = make_header(version, result_pool);
+  store->max_size = max_size;
+  store->pool = result_pool;
+  SVN_ERR(svn_mutex__init(&store->mutex, TRUE, result_pool));
+
+  SVN_ERR(open_store(store, scratch_pool));
+
+  *store_p = store;
+  return SVN_NO_ERROR;
+}
+
+/* Process-wide registry of shared stores, mapping "<path>\n<version>" to
+ * svn_cache__persistent_store_t *.  REGISTRY_MUTEX serializes all access
+ * to REGISTRY and its pool. */
+static apr_hash_t *registry = NULL;
+static svn_mutex__t *registry_mutex = NULL;
+static svn_atomic_t registry_initialized = 0;
+
+/* Initializer function as required by svn_atomic__init_once.  Create the
+ * process-wide store registry.  BATON and UNUSED_POOL are unused.
+ */
+static svn_error_t *
+initialize_registry(void *baton, apr_pool_t *unused_pool)
+{
+  apr_pool_t *pool = svn_pool_create(NULL);
+
+  SVN_ERR(svn_mutex__init(&registry_mutex, TRUE, pool));
+  registry = apr_hash_make(pool);
+
+  return SVN_NO_ERROR;
+}
+
+/* Set *STORE_P to the shared store for PATH and VERSION, opening it with
+ * MAX_SIZE if it does not exist yet.  Use SCRATCH_POOL for temporary
+ * allocations.  The caller must hold REGISTRY_MUTEX.
+ */
+static svn_error_t *
+get_shared_store(svn_cache__persistent_store_t **store_p,
+                 const char *path,
+                 const char *version,
+                 apr_size_t max_size,
+                 apr_pool_t *scratch_pool)
+{
+  apr_pool_t *registry_pool = apr_hash_pool_get(registry);
+  const char *key = apr_pstrcat(scratch_pool, path, "\n", version,
+                                SVN_VA_NULL);
+  apr_pool_t *store_pool;
+  svn_error_t *err;
+
+  *store_p = svn_hash_gets(registry, key);
+  if (*store_p)
+    return SVN_NO_ERROR;
+
+  /* Each store gets its own root pool such that it can allocate without
+   * holding the registry lock. */
+  store_pool = svn_pool_create(NULL);
+  err = create_store(store_p, path, version, max_size, store_pool,
+                     scratch_pool);
+  if (err)
+    {
+      svn_pool_destroy(store_pool);
+      return svn_error_trace(err);
+    }
+
+  svn_hash_sets(registry, apr_pstrdup(registry_pool, key), *store_p);
+
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_cache__persistent_store_open(svn_cache__persistent_store_t **store_p,
+                                 const char *path,
+                                 const char *version,
+                                 apr_size_t max_size,
+                                 svn_boolean_t shared,
+                                 apr_pool_t *result_pool,
+                                 apr_pool_t *scratch_pool)
+{
+  if (!shared)
+    return svn_error_trace(create_store(store_p, path, version, max_size,
+                                        result_pool, scratch_pool));
+
+  SVN_ERR(svn_atomic__init_once(&registry_initialized, initialize_registry,
+                                NULL, NULL));
+  SVN_MUTEX__WITH_LOCK(registry_mutex,
+                       get_shared_store(store_p, path, version, max_size,
+                                        scratch_pool));
+
+  return SVN_NO_ERROR;
+}
+
+/* Set *REPLACED if STORE->PATH no longer refers to STORE->FILE, e.g.
+ * because another process compacted the store.  Use SCRATCH_POOL for
+ * temporary allocations. */
+static svn_error_t *
+check_replaced(svn_boolean_t *replaced,
+               svn_cache__persistent_store_t *store,
+               apr_pool_t *scratch_pool)
+{
+  apr_finfo_t file_info;
+  apr_finfo_t path_info;
+  apr_status_t status;
+
+  *replaced = FALSE;
+
+  status = apr_file_info_get(&file_info, APR_FINFO_IDENT, store->file);
+  if (!status)
+    status = apr_stat(&path_info, store->path, APR_FINFO_IDENT,
+                      scratch_pool);
+
+  /* Without file identities, all we can do is using the file we have. */
+  if (status == APR_INCOMPLETE || APR_STATUS_IS_ENOTIMPL(status))
+    return SVN_NO_ERROR;
+
+  if (APR_STATUS_IS_ENOENT(status))
+    {
+      *replaced = TRUE;
+      return SVN_NO_ERROR;
+    }
+
+  if (status)
+    return svn_error_wrap_apr(status, _("Can't stat '%s'"),
+                              svn_dirent_local_style(store->path,
+                                                     scratch_pool));
+
+  *replaced = file_info.inode != path_info.inode
+           || file_info.device != path_info.device;
+
+  return SVN_NO_ERROR;
+}
+
+/* Replace the file of STORE, which has a size of FILE_SIZE bytes, with a
+ * copy that contains only the latest record for each key.  Of those,
+ * keep the latest stamp and the newest records that fit into half of
+ * STORE->MAX_SIZE.  The caller must hold STORE->MUTEX and an exclusive
+ * lock on STORE->FILE.  Use SCRATCH_POOL for temporary allocations.
+ */
+static svn_error_t *
+compact_store(svn_cache__persistent_store_t *store,
+              apr_off_t file_size,
+              apr_pool_t *scratch_pool)
+{
+  apr_size_t header_len = strlen(store->header);
+  apr_size_t size = (apr_size_t)MIN(file_size,
+                                    (apr_off_t)store->max_size);
+  apr_array_header_t *offsets = apr_array_make(scratch_pool, 256,
+                                               sizeof(apr_size_t));
+  apr_hash_t *latest = apr_hash_make(scratch_pool);
+  svn_stringbuf_t *contents;
+  svn_boolean_t *keep;
+  apr_size_t budget = store->max_size / 2;
+  apr_size_t offset = header_len;
+  const char *data;
+  int i;
+
+  SVN_ERR(read_image(&data, store, size, scratch_pool, scratch_pool));
+
+  /* Find all records and the latest one for each key. */
+  if (size < header_len || memcmp(data, store->header, header_len))
+    size = header_len;
+
+  while (TRUE)
+    {
+      const char *key, *value;
+      apr_size_t key_len, value_len;
+      apr_size_t next = parse_record(&key, &key_len, &value, &value_len,
+                                     data, offset, size);
+      int *index;
+
+      if (next == offset)
+        break;
+
+      index = apr_palloc(scratch_pool, sizeof(*index));
+      *index = offsets->nelts;
+      apr_hash_set(latest, key, key_len, index);
+      APR_ARRAY_PUSH(offsets, apr_size_t) = offset;
+
+      offset = next;
+    }
+
+  /* Select the newest records within the budget, going backwards. */
+  keep = apr_pcalloc(scratch_pool, (offsets->nelts + 1) * sizeof(*keep));
+  budget -= MIN(budget, header_len);
+  for (i = offsets->nelts - 1; i >= 0; i--)
+    {
+      const char *key, *value;
+      apr_size_t key_len, value_len;
+      apr_size_t record_offset = APR_ARRAY_IDX(offsets, i, apr_size_t);
+      apr_size_t record_len
+        = parse_record(&key, &key_len, &value, &value_len, data,
+                       record_offset, size) - record_offset;
+      int *index = apr_hash_get(latest, key, key_len);
+
+      if (*index != i)
+        continue;
+
+      if (is_stamp_key(key, key_len) || record_len <= budget)
+        {
+          keep[i] = TRUE;
+          budget -= MIN(budget, record_len);
+        }
+    }
+
+  /* Write them in their original order. */
+  contents = svn_stringbuf_create_ensure(store->max_size / 2, scratch_pool);
+  svn_stringbuf_appendbytes(contents, data, header_len);
+  for (i = 0; i < offsets->nelts; i++)
+    if (keep[i])
+      {
+        const char *key, *value;
+        apr_size_t key_len, value_len;
+        apr_size_t record_offset = APR_ARRAY_IDX(offsets, i, apr_size_t);
+        apr_size_t next = parse_record(&key, &key_len, &value, &value_len,
+                                       data, record_offset, size);
+
+        svn_stringbuf_appendbytes(contents, data + record_offset,
+                                  next - record_offset);
+      }
+
+  return svn_error_trace(replace_file(store, contents->data, contents->len,
+                                      scratch_pool));
+}
+
+/* Append a record with the KEY_LEN bytes of KEY and the VALUE_LEN bytes
+ * of VALUE to STORE and set *APPENDED to TRUE.  Leave the store untouched
+ * and set *APPENDED to FALSE if STORE is read-only or the record is too
+ * large.  Compact the store file if it grows too large.  Use SCRATCH_POOL
+ * for temporary allocations.  The caller must hold STORE->MUTEX.
+ */
+static svn_error_t *
+append_record(svn_boolean_t *appended,
+              svn_cache__persistent_store_t *store,
+              const char *key,
+              apr_size_t key_len,
+              const char *value,
+              apr_size_t value_len,
+              apr_pool_t *scratch_pool)
+{
+  apr_size_t record_len = RECORD_HEADER_SIZE + key_len + value_len;
+  char *record;
+  apr_uint32_t header[3];
+  int attempt;
+
+  /* Leave enough room for other records after compaction. */
+  *appended = FALSE;
+  if (!store->writable || !store->file
+      || record_len > store->max_size / 4)
+    return SVN_NO_ERROR;
+
+  record = apr_palloc(scratch_pool, record_len);
+  header[0] = (apr_uint32_t)key_len;
+  header[1] = (apr_uint32_t)value_len;
+  memcpy(record + RECORD_HEADER_SIZE, key, key_len);
+  memcpy(record + RECORD_HEADER_SIZE + key_len, value, value_len);
+  header[2] = record_checksum(record + RECORD_HEADER_SIZE, key_len,
+                              record + RECORD_HEADER_SIZE + key_len,
+                              value_len);
+  memcpy(record, header, RECORD_HEADER_SIZE);
+
+  for (attempt = 0; attempt < MAX_REOPEN_ATTEMPTS; attempt++)
+    {
+      apr_pool_t *lock_pool = svn_pool_create(store->pool);
+      apr_off_t offset = 0;
+      svn_boolean_t replaced;
+      svn_error_t *err;
+
+      /* Other processes may append to the same file or replace it. */
+      SVN_ERR(svn_io_lock_open_file(store->file, TRUE, FALSE, lock_pool));
+
+      err = check_replaced(&replaced, store, scratch_pool);
+      if (!err && !replaced)
+        err = svn_io_file_seek(store->file, APR_END, &offset, scratch_pool);
+      if (!err && !replaced && offset + record_len > store->max_size)
+        {
+          err = compact_store(store, offset, scratch_pool);
+          replaced = TRUE;
+        }
+
+      if (!err && !replaced)
+        {
+          err = svn_io_file_write_full(store->file, record, record_len,
+                                       NULL, scratch_pool);
+          *appended = !err;
+        }
+
+      svn_pool_destroy(lock_pool);
+      SVN_ERR(err);
+
+      if (!replaced)
+        break;
+
+      /* Continue with the new file. */
+      SVN_ERR(open_store(store, scratch_pool));
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Add the VALUE_LEN bytes of VALUE to STORE under the KEY_LEN bytes of
+ * KEY, unless STORE already holds that value.  Use SCRATCH_POOL for
+ * temporary allocations.  The caller must hold STORE->MUTEX.
+ */
+static svn_error_t *
+add_record(svn_cache__persistent_store_t *store,
+           const char *key,
+           apr_size_t key_len,
+           const char *value,
+           apr_size_t value_len,
+           apr_pool_t *scratch_pool)
+{
+  store_entry_t *entry = apr_hash_get(store->index, key, key_len);
+  apr_uint32_t checksum = svn__fnv1a_32(value, value_len);
+  svn_boolean_t appended;
+
+  if (entry && entry->size == value_len
+      && (entry->data ? memcmp(entry->data, value, value_len) == 0
+                      : entry->checksum == checksum))
+    return SVN_NO_ERROR;
+
+  SVN_ERR(append_record(&appended, store, key, key_len, value, value_len,
+                        scratch_pool));
+  if (!appended)
+    return SVN_NO_ERROR;
+
+  /* Remember what we wrote.  This may be a new memory image. */
+  entry = apr_pcalloc(store->image_pool, sizeof(*entry));
+  entry->size = value_len;
+  entry->checksum = checksum;
+  apr_hash_set(store->index, apr_pmemdup(store->image_pool, key, key_len),
+               key_len, entry);
+
+  if (is_stamp_key(key, key_len))
+    store->stamp = apr_pstrmemdup(store->image_pool, value, value_len);
+
+  return SVN_NO_ERROR;
+}
+
+/* Set *DATA and *SIZE to a copy of the value stored for the KEY_LEN bytes
+ * of KEY in STORE, allocated in RESULT_POOL.  Set *DATA to NULL if that
+ * is not available.  The caller must hold STORE->MUTEX. */
+static svn_error_t *
+read_value(char **data,
+           apr_size_t *size,
+           svn_cache__persistent_store_t *store,
+           const char *key,
+           apr_size_t key_len,
+           apr_pool_t *result_pool)
+{
+  store_entry_t *entry = apr_hash_get(store->index, key, key_len);
+
+  /* Copy while the memory image is guaranteed to exist. */
+  if (entry && entry->data)
+    {
+      *data = apr_pmemdup(result_pool, entry->data, entry->size);
+      *size = entry->size;
+    }
+  else
+    {
+      *data = NULL;
+      *size = 0;
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Set *STAMP to a copy of the stamp of STORE, allocated in RESULT_POOL.
+ * The caller must hold STORE->MUTEX. */
+static svn_error_t *
+get_stamp(const char **stamp,
+          svn_cache__persistent_store_t *store,
+          apr_pool_t *result_pool)
+{
+  *stamp = store->stamp ? apr_pstrdup(result_pool, store->stamp) : NULL;
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_cache__persistent_store_get_stamp(const char **stamp,
+                                      svn_cache__persistent_store_t *store,
+                                      apr_pool_t *result_pool)
+{
+  SVN_MUTEX__WITH_LOCK(store->mutex, get_stamp(stamp, store, result_pool));
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_cache__persistent_store_set_stamp(svn_cache__persistent_store_t *store,
+                                      const char *stamp,
+                                      apr_pool_t *scratch_pool)
+{
+  SVN_MUTEX__WITH_LOCK(store->mutex,
+                       add_record(store, STAMP_KEY, STAMP_KEY_LEN,
+                                  stamp, strlen(stamp), scratch_pool));
+  return SVN_NO_ERROR;
+}
+
+/* Implement svn_cache__persistent_store_reset() while the caller holds
+ * STORE->MUTEX. */
+static svn_error_t *
+reset_store(svn_cache__persistent_store_t *store,
+            apr_pool_t *scratch_pool)
+{
+  if (!store->writable)
+    {
+      unload_store(store);
+      return SVN_NO_ERROR;
+    }
+
+  SVN_ERR(replace_file(store, store->header, strlen(store->header),
+                       scratch_pool));
+  return svn_error_trace(open_store(store, scratch_pool));
+}
+
+svn_error_t *
+svn_cache__persistent_store_reset(svn_cache__persistent_store_t *store,
+                                  apr_pool_t *scratch_pool)
+{
+  SVN_MUTEX__WITH_LOCK(store->mutex, reset_store(store, scratch_pool));
+  return SVN_NO_ERROR;
+}
+
+/* Set *KEY_P and *KEY_LEN to the store key for KEY in CACHE, allocated
+ * in RESULT_POOL. */
+static void
+build_key(const char **key_p,
+          apr_size_t *key_len,
+          persistent_cache_t *cache,
+          const void *key,
+          apr_pool_t *result_pool)
+{
+  apr_size_t len = cache->klen == APR_HASH_KEY_STRING
+                 ? strlen(key)
+                 : (apr_size_t)cache->klen;
+  char *result = apr_palloc(result_pool, cache->id_len + len);
+
+  memcpy(result, cache->id, cache->id_len);
+  memcpy(result + cache->id_len, key, len);
+
+  *key_p = result;
+  *key_len = cache->id_len + len;
+}
+
+/* Set *DATA and *SIZE to a copy of the serialized value for KEY in the
+ * store of CACHE, allocated in RESULT_POOL.  Set *DATA to NULL if the
+ * store does not provide it. */
+static svn_error_t *
+lookup_value(char **data,
+             apr_size_t *size,
+             persistent_cache_t *cache,
+             const void *key,
+             apr_pool_t *result_pool)
+{
+  const char *store_key;
+  apr_size_t store_key_len;
+
+  build_key(&store_key, &store_key_len, cache, key, result_pool);
+  SVN_MUTEX__WITH_LOCK(cache->store->mutex,
+                       read_value(data, size, cache->store, store_key,
+                                  store_key_len, result_pool));
+
+  return SVN_NO_ERROR;
+}
+
+/* Set *VALUE_P to the deserialized contents of the SIZE bytes of DATA in
+ * CACHE, allocated in RESULT_POOL.  This takes ownership of DATA. */
+static svn_error_t *
+deserialize_value(void **value_p,
+                  persistent_cache_t *cache,
+                  char *data,
+                  apr_size_t size,
+                  apr_pool_t *result_pool)
+{
+  if (cache->deserialize_func)
+    {
+      SVN_ERR((cache->deserialize_func)(value_p, data, size, result_pool));
+    }
+  else
+    {
+      svn_stringbuf_t *value = svn_stringbuf_create_empty(result_pool);
+      value->data = data;
+      value->blocksize = size;
+      value->len = size - 1; /* account for trailing NUL */
+      *value_p = value;
+    }
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+persistent_cache_get(void **value_p,
+                     svn_boolean_t *found,
+                     void *cache_void,
+                     const void *key,
+                     apr_pool_t *result_pool)
+{
+  persistent_cache_t *cache = cache_void;
+  char *data;
+  apr_size_t size;
+
+  SVN_ERR(svn_cache__get(value_p, found, cache->l1_cache, key, result_pool));
+  if (*found || key == NULL)
+    return SVN_NO_ERROR;
+
+  SVN_ERR(lookup_value(&data, &size, cache, key, result_pool));
+  if (data)
+    {
+      apr_pool_t *subpool = svn_pool_create(result_pool);
+
+      SVN_ERR(deserialize_value(value_p, cache, data, size, result_pool));
+      *found = TRUE;
+
+      /* Promote the entry to the first level. */
+      SVN_ERR(svn_cache__set(cache->l1_cache, key, *value_p, subpool));
+      svn_pool_destroy(subpool);
+    }
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+persistent_cache_has_key(svn_boolean_t *found,
+                         void *cache_void,
+                         const void *key,
+                         apr_pool_t *scratch_pool)
+{
+  persistent_cache_t *cache = cache_void;
+
+  SVN_ERR(svn_cache__has_key(found, cache->l1_cache, key, scratch_pool));
+  if (!*found && key)
+    {
+      char *data;
+      apr_size_t size;
+
+      SVN_ERR(lookup_value(&data, &size, cache, key, scratch_pool));
+      *found = data != NULL;
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Add the SIZE bytes of serialized DATA under KEY to the store of CACHE
+ * unless it is already there.  Use SCRATCH_POOL for temporary
+ * allocations. */
+static svn_error_t *
+store_data(persistent_cache_t *cache,
+           const void *key,
+           const void *data,
+           apr_size_t size,
+           apr_pool_t *scratch_pool)
+{
+  const char *store_key;
+  apr_size_t store_key_len;
+
+  if (!cache->store->writable)
+    return SVN_NO_ERROR;
+
+  build_key(&store_key, &store_key_len, cache, key, scratch_pool);
+  SVN_MUTEX__WITH_LOCK(cache->store->mutex,
+                       add_record(cache->store, store_key, store_key_len,
+                                  data, size, scratch_pool));
+
+  return SVN_NO_ERROR;
+}
+
+/* Add VALUE to the store of CACHE unless it is already there.  Use
+ * SCRATCH_POOL for temporary allocations. */
+static svn_error_t *
+store_value(persistent_cache_t *cache,
+            const void *key,
+            void *value,
+            apr_pool_t *scratch_pool)
+{
+  void *data;
+  apr_size_t data_len;
+
+  if (!cache->store->writable || value == NULL)
+    return SVN_NO_ERROR;
+
+  if (cache->serialize_func)
+    {
+      SVN_ERR((cache->serialize_func)(&data, &data_len, value,
+                                      scratch_pool));
+    }
+  else
+    {
+      svn_stringbuf_t *value_str = value;
+      data = value_str->data;
+      data_len = value_str->len + 1; /* copy trailing NUL */
+    }
+
+  return svn_error_trace(store_data(cache, key, data, data_len,
+                                    scratch_pool));
+}
+
+static svn_error_t *
+persistent_cache_set(void *cache_void,
+                     const void *key,
+                     void *value,
+                     apr_pool_t *scratch_pool)
+{
+  persistent_cache_t *cache = cache_void;
+  apr_pool_t *subpool;
+
+  SVN_ERR(svn_cache__set(cache->l1_cache, key, value, scratch_pool));
+  if (key == NULL)
+    return SVN_NO_ERROR;
+
+  subpool = svn_pool_create(scratch_pool);
+  SVN_ERR(store_value(cache, key, value, subpool));
+  svn_pool_destroy(subpool);
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+persistent_cache_iter(svn_boolean_t *completed,
+                      void *cache_void,
+                      svn_iter_apr_hash_cb_t user_cb,
+                      void *user_baton,
+                      apr_pool_t *scratch_pool)
+{
+  persistent_cache_t *cache = cache_void;
+
+  return svn_error_trace(svn_cache__iter(completed, cache->l1_cache,
+                                         user_cb, user_baton,
+                                         scratch_pool));
+}
+
+static svn_error_t *
+persistent_cache_get_partial(void **value_p,
+                             svn_boolean_t *found,
+                             void *cache_void,
+                             const void *key,
+                             svn_cache__partial_getter_func_t func,
+                             void *baton,
+                             apr_pool_t *result_pool)
+{
+  persistent_cache_t *cache = cache_void;
+  char *data;
+  apr_size_t size;
+
+  SVN_ERR(svn_cache__get_partial(value_p, found, cache->l1_cache, key,
+                                 func, baton, result_pool));
+  if (*found || key == NULL)
+    return SVN_NO_ERROR;
+
+  /* The partial getter works on the serialized representation, which is
+   * exactly what we have in the store. */
+  SVN_ERR(lookup_value(&data, &size, cache, key, result_pool));
+  if (data)
+    {
+      SVN_ERR(func(value_p, data, size, baton, result_pool));
+      *found = TRUE;
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_cache__partial_getter_func_t by returning a copy of
+ * the serialized DATA of DATA_LEN bytes as svn_string_t in *OUT. */
+static svn_error_t *
+copy_serialized(void **out,
+                const void *data,
+                apr_size_t data_len,
+                void *baton,
+                apr_pool_t *result_pool)
+{
+  *out = svn_string_ncreate(data, data_len, result_pool);
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+persistent_cache_set_partial(void *cache_void,
+                             const void *key,
+                             svn_cache__partial_setter_func_t func,
+                             void *baton,
+                             apr_pool_t *scratch_pool)
+{
+  persistent_cache_t *cache = cache_void;
+  apr_pool_t *subpool;
+  svn_string_t *serialized;
+  svn_boolean_t found;
+
+  SVN_ERR(svn_cache__set_partial(cache->l1_cache, key, func, baton,
+                                 scratch_pool));
+  if (key == NULL || !cache->store->writable)
+    return SVN_NO_ERROR;
+
+  /* Update the store as well, preferably with the modified entry from the
+   * first level.  Otherwise, modify the stored one, if any. */
+  subpool = svn_pool_create(scratch_pool);
+  SVN_ERR(svn_cache__get_partial((void **)&serialized, &found,
+                                 cache->l1_cache, key, copy_serialized,
+                                 NULL, subpool));
+  if (found)
+    {
+      SVN_ERR(store_data(cache, key, serialized->data, serialized->len,
+                         subpool));
+    }
+  else
+    {
+      char *data;
+      apr_size_t size;
+
+      SVN_ERR(lookup_value(&data, &size, cache, key, subpool));
+      if (data)
+        {
+          SVN_ERR(func((void **)&data, &size, baton, subpool));
+          SVN_ERR(store_data(cache, key, data, size, subpool));
+        }
+    }
+
+  svn_pool_destroy(subpool);
+
+  return SVN_NO_ERROR;
+}
+
+static svn_boolean_t
+persistent_cache_is_cachable(void *cache_void,
+                             apr_size_t size)
+{
+  persistent_cache_t *cache = cache_void;
+
+  return svn_cache__is_cachable(cache->l1_cache, size);
+}
+
+static svn_error_t *
+persistent_cache_get_info(void *cache_void,
+                          svn_cache__info_t *info,
+                          svn_boolean_t reset,
+                          apr_pool_t *result_pool)
+{
+  persistent_cache_t *cache = cache_void;
+
+  return svn_error_trace(svn_cache__get_info(cache->l1_cache, info, reset,
+                                             result_pool));
+}
+
+static svn_cache__vtable_t persistent_cache_vtable = {
+  persistent_cache_get,
+  persistent_cache_has_key,
+  persistent_cache_set,
+  persistent_cache_iter,
+  persistent_cache_is_cachable,
+  persistent_cache_get_partial,
+  persistent_cache_set_partial,
+  persistent_cache_get_info
+};
+
+svn_error_t *
+svn_cache__create_persistent(svn_cache__t **cache_p,
+                             svn_cache__t *l1_cache,
+                             svn_cache__persistent_store_t *store,
+                             const char *id,
+                             svn_cache__serialize_func_t serialize_func,
+                             svn_cache__deserialize_func_t deserialize_func,
+                             apr_ssize_t klen,
+                             apr_pool_t *result_pool)
+{
+  svn_cache__t *wrapper = apr_pcalloc(result_pool, sizeof(*wrapper));
+  persistent_cache_t *cache = apr_pcalloc(result_pool, sizeof(*cache));
+
+  SVN_ERR_ASSERT(*id != '\0');
+
+  cache->l1_cache = l1_cache;
+  cache->store = store;
+  cache->id = apr_pstrdup(result_pool, id);
+  cache->id_len = strlen(id) + 1;
+  cache->klen = klen;
+  cache->serialize_func = serialize_func;
+  cache->deserialize_func = deserialize_func;
+
+  wrapper->vtable = &persistent_cache_vtable;
+  wrapper->cache_internal = cache;
+  wrapper->error_handler = 0;
+  wrapper->error_baton = 0;
+  wrapper->pretend_empty = !!getenv("SVN_X_DOES_NOT_MARK_THE_SPOT");
+
+  *cache_p = wrapper;
+  return SVN_NO_ERROR;
+}
@@ -257,7 +257,18 @@ svn_cache__format_info(const svn_cache__info_t *info,
   double data_entry_rate = (100.0 * (double)info->used_entries)
                  / (double)(info->total_entries ? info->total_entries : 1);
 
+  const char *prefix_stats = "";
   const char *histogram = "";
+
+  if (info->prefix_gets)
+    prefix_stats = svn_string_createf(result_pool,
+                                      "prefix  : %" APR_UINT64_T_FMT
+                                      " gets, %" APR_UINT64_T_FMT
+                                      " hits (%5.2f%%)\n",
+                                      info->prefix_gets, info->prefix_hits,
+                                      (100.0 * (double)info->prefix_hits)
+                                        / (double)info->prefix_gets)->data;
+
   if (!access_only)
     {
       svn_stringbuf_t *text = svn_stringbuf_create_empty(result_pool);
@@ -283,11 +294,12 @@ svn_cache__format_info(const svn_cache__info_t *info,
                             "gets    : %" APR_UINT64_T_FMT
                             ", %" APR_UINT64_T_FMT " hits (%5.2f%%)\n"
                             "sets    : %" APR_UINT64_T_FMT
-                            " (%5.2f%% of misses)\n",
+                            " (%5.2f%% of misses)\n%s",
                             info->id,
                             info->gets,
                             info->hits, hit_rate,
-                            info->sets, write_rate)
+                            info->sets, write_rate,
+                            prefix_stats)
        : svn_string_createf(result_pool,
 
                             "%s\n"
@@ -296,6 +308,7 @@ svn_cache__format_info(const svn_cache__info_t *info,
                             "sets    : %" APR_UINT64_T_FMT
                             " (%5.2f%% of misses)\n"
                             "failures: %" APR_UINT64_T_FMT "\n"
+                            "%s"
                             "used    : %" APR_UINT64_T_FMT " MB (%5.2f%%)"
                             " of %" APR_UINT64_T_FMT " MB data cache"
                             " / %" APR_UINT64_T_FMT " MB total cache memory\n"
@@ -308,6 +321,7 @@ svn_cache__format_info(const svn_cache__info_t *info,
                             info->hits, hit_rate,
                             info->sets, write_rate,
                             info->failures,
+                            prefix_stats,
 
                             info->used_size / _1MB, data_usage_rate,
                             info->data_size / _1MB,
@@ -28,6 +28,7 @@
 
 #include "svn_pools.h"
 #include "svn_sorts.h"
+#include "svn_private_config.h"
 
 /* The cache settings as a process-wide singleton.
  */
@@ -64,6 +65,16 @@ static svn_cache_config_t cache_settings =
 #endif
 };
 
+/* If set, the singleton membuffer cache shall be created in shared memory.
+ * See svn_cache_config_init_shared().
+ */
+static svn_boolean_t use_shared_memory = FALSE;
+
+/* The process-global (singleton) membuffer cache and its init state.
+ */
+static svn_membuffer_t *global_cache = NULL;
+static svn_atomic_t global_cache_initialized = 0;
+
 /* Get the current FSFS cache configuration. */
 const svn_cache_config_t *
 svn_cache_config_get(void)
@@ -120,14 +131,23 @@ initialize_cache(void *baton, apr_pool_t *unused_pool)
         return SVN_NO_ERROR;
       apr_allocator_owner_set(allocator, pool);
 
-      err = svn_cache__membuffer_cache_create(
-          &cache,
-          (apr_size_t)cache_size,
-          (apr_size_t)(cache_size / 5),
-          0,
-          ! svn_cache_config_get()->single_threaded,
-          FALSE,
-          pool);
+      if (use_shared_memory)
+        err = svn_cache__membuffer_cache_create_shared(
+            &cache,
+            (apr_size_t)cache_size,
+            (apr_size_t)(cache_size / 5),
+            0,
+            FALSE,
+            pool);
+      else
+        err = svn_cache__membuffer_cache_create(
+            &cache,
+            (apr_size_t)cache_size,
+            (apr_size_t)(cache_size / 5),
+            0,
+            ! svn_cache_config_get()->single_threaded,
+            FALSE,
+            pool);
 
       /* Some error occurred. Most likely it's an OOM error but we don't
        * really care. Simply release all cache memory and disable caching
@@ -158,11 +178,9 @@ initialize_cache(void *baton, apr_pool_t *unused_pool)
 svn_membuffer_t *
 svn_cache__get_global_membuffer_cache(void)
 {
-  static svn_membuffer_t *cache = NULL;
-  static svn_atomic_t initialized = 0;
-
   svn_error_t *err
-    = svn_atomic__init_once(&initialized, initialize_cache, &cache, NULL);
+    = svn_atomic__init_once(&global_cache_initialized, initialize_cache,
+                            &global_cache, NULL);
   if (err)
     {
       /* no caches today ... */
@@ -170,7 +188,7 @@ svn_cache__get_global_membuffer_cache(void)
       return NULL;
     }
 
-  return cache;
+  return global_cache;
 }
 
 void
@@ -179,3 +197,18 @@ svn_cache_config_set(const svn_cache_config_t *settings)
   cache_settings = *settings;
 }
 
+svn_error_t *
+svn_cache_config_init_shared(apr_pool_t *scratch_pool)
+{
+  /* Too late?  The singleton may only be created once. */
+  if (svn_atomic_read(&global_cache_initialized) && !use_shared_memory)
+    return svn_error_create(SVN_ERR_INCORRECT_PARAMS, NULL,
+                            _("The in-memory cache has already been "
+                              "created for this process"));
+
+  use_shared_memory = TRUE;
+  return svn_error_trace(svn_atomic__init_once(&global_cache_initialized,
+                                               initialize_cache,
+                                               &global_cache, NULL));
+}
+
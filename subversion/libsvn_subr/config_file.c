@@ -1552,6 +1552,18 @@ svn_config_ensure(const char *config_dir, apr_pool_t *pool)
         "### returning an error.  The default is 10000, i.e. 10 seconds."    NL
         "### Longer values may be useful when exclusive locking is enabled." NL
         "# busy-timeout = 10000"                                             NL
+        "### Set the number of threads the working copy library may use"    NL
+        "### to examine files on disk concurrently, e.g. when comparing"     NL
+        "### files with their pristine text during 'svn status',"            NL
+        "### computing text deltas during 'svn commit', installing files"    NL
+        "### during 'svn checkout' and 'svn update' or diffing revisions"    NL
+        "### during 'svn blame'.  The default is 1, i.e. no concurrency."    NL
+        "# jobs = 1"                                                         NL
+        "### Set the directory of a pristine store to share between"         NL
+        "### working copies.  Pristine texts are then stored only once and"  NL
+        "### hard linked into each working copy, if the file system allows." NL
+        "### Texts found in the shared store are not downloaded again."      NL
+        "# shared-pristine-store = /var/cache/svn-pristine"                  NL
         ;
 
       err = svn_io_file_open(&f, path,
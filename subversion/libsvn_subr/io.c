@@ -871,6 +871,71 @@ svn_io_temp_dir(const char **dir,
 
 /*** Creating, copying and appending files. ***/
 
+#ifdef HAVE_COPY_FILE_RANGE
+/* Maximum number of bytes to transfer in a single copy_file_range() call. */
+#define COPY_FILE_RANGE_CHUNK_SIZE 0x40000000
+
+/* Try to let the kernel transfer the contents of FROM_FILE to TO_FILE.
+ * Depending on the filesystem, this may result in a reflink, a server-side
+ * copy or at least does not route the data through user space.
+ *
+ * Set *COPIED to TRUE, if the contents has been transferred.  Set it to
+ * FALSE, if the OS does not support this operation for the given files.
+ * In that case, no data has been transferred and the file pointers are
+ * unchanged, i.e. the caller should fall back to a regular copy.
+ */
+static apr_status_t
+copy_contents_in_kernel(svn_boolean_t *copied,
+                        apr_file_t *from_file,
+                        apr_file_t *to_file)
+{
+  apr_os_file_t from_fd, to_fd;
+  apr_off_t total = 0;
+  apr_status_t status;
+
+  *copied = FALSE;
+
+  status = apr_os_file_get(&from_fd, from_file);
+  if (status)
+    return status;
+
+  status = apr_os_file_get(&to_fd, to_file);
+  if (status)
+    return status;
+
+  while (1)
+    {
+      ssize_t result = copy_file_range(from_fd, NULL, to_fd, NULL,
+                                       COPY_FILE_RANGE_CHUNK_SIZE, 0);
+      if (result > 0)
+        {
+          total += result;
+          continue;
+        }
+
+      /* End of file.  Some filesystems silently report 0 bytes instead of
+         an error when they don't support this operation.  So, we leave
+         empty files to the regular copy code. */
+      if (result == 0)
+        {
+          *copied = total > 0;
+          return APR_SUCCESS;
+        }
+
+      if (errno == EINTR)
+        continue;
+
+      /* Not supported for this combination of files? */
+      if (total == 0
+          && (   errno == ENOSYS || errno == EXDEV || errno == EINVAL
+              || errno == EOPNOTSUPP || errno == EBADF || errno == EPERM))
+        return APR_SUCCESS;
+
+      return apr_get_os_error();
+    }
+}
+#endif
+
 /* Transfer the contents of FROM_FILE to TO_FILE, using POOL for temporary
  * allocations.
  *
@@ -885,6 +950,13 @@ copy_contents(apr_file_t *from_file,
               apr_file_t *to_file,
               apr_pool_t *pool)
 {
+#ifdef HAVE_COPY_FILE_RANGE
+  svn_boolean_t copied;
+  apr_status_t status = copy_contents_in_kernel(&copied, from_file, to_file);
+  if (status || copied)
+    return status;
+#endif
+
   /* Copy bytes till the cows come home. */
   while (1)
     {
@@ -4628,6 +4700,40 @@ svn_io_file_move(const char *from_path, const char *to_path,
   return err;
 }
 
+svn_error_t *
+svn_io__file_link(const char *from_path,
+                  const char *to_path,
+                  apr_pool_t *scratch_pool)
+{
+  apr_status_t status;
+  const char *from_path_apr, *to_path_apr;
+
+  SVN_ERR(cstring_from_utf8(&from_path_apr, from_path, scratch_pool));
+  SVN_ERR(cstring_from_utf8(&to_path_apr, to_path, scratch_pool));
+
+  status = apr_file_link(from_path_apr, to_path_apr);
+  if (status)
+    return svn_error_wrap_apr(status, _("Can't link '%s' to '%s'"),
+                              svn_dirent_local_style(to_path, scratch_pool),
+                              svn_dirent_local_style(from_path,
+                                                     scratch_pool));
+
+  return SVN_NO_ERROR;
+}
+
+void
+svn_io__file_advise_willneed(apr_file_t *file,
+                             apr_off_t offset,
+                             apr_off_t length)
+{
+#if defined(HAVE_POSIX_FADVISE) && defined(POSIX_FADV_WILLNEED)
+  apr_os_file_t fd;
+
+  if (length > 0 && apr_os_file_get(&fd, file) == APR_SUCCESS)
+    (void)posix_fadvise(fd, offset, length, POSIX_FADV_WILLNEED);
+#endif
+}
+
 /* Common implementation of svn_io_dir_make and svn_io_dir_make_hidden.
    HIDDEN determines if the hidden attribute
    should be set on the newly created directory. */
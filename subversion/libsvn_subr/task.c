@@ -0,0 +1,528 @@
+/*
+ * task.c :  concurrent execution of tasks with ordered output
+ *
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ */
+
+#include <apr_thread_proc.h>
+#include <apr_thread_cond.h>
+
+#include "svn_error.h"
+#include "svn_pools.h"
+
+#include "private/svn_atomic.h"
+#include "private/svn_mutex.h"
+#include "private/svn_task.h"
+
+#include "svn_private_config.h"
+
+
+
+/* Number of result slots per worker thread.  This limits how far the
+ * workers may get ahead of the output function. */
+#define SLOTS_PER_THREAD 4
+
+/* Number of microseconds the output thread waits for a task to complete
+ * before checking for cancellation again. */
+#define CANCEL_CHECK_INTERVAL 100000
+
+/* Process all tasks in the current thread.  The parameters are the same
+ * as for svn_task__run(). */
+static svn_error_t *
+run_sequentially(apr_size_t task_count,
+                 svn_task__process_func_t process_func,
+                 void *process_baton,
+                 svn_task__output_func_t output_func,
+                 void *output_baton,
+                 svn_task__thread_context_constructor_t context_constructor,
+                 void *context_baton,
+                 svn_cancel_func_t cancel_func,
+                 void *cancel_baton,
+                 apr_pool_t *scratch_pool)
+{
+  apr_pool_t *context_pool = svn_pool_create(scratch_pool);
+  apr_pool_t *result_pool = svn_pool_create(scratch_pool);
+  apr_pool_t *iterpool = svn_pool_create(scratch_pool);
+  void *thread_context = NULL;
+  apr_size_t i;
+
+  if (context_constructor)
+    SVN_ERR(context_constructor(&thread_context, context_baton,
+                                context_pool, iterpool));
+
+  for (i = 0; i < task_count; ++i)
+    {
+      void *result = NULL;
+
+      svn_pool_clear(result_pool);
+      svn_pool_clear(iterpool);
+
+      if (cancel_func)
+        SVN_ERR(cancel_func(cancel_baton));
+
+      SVN_ERR(process_func(&result, i, process_baton, thread_context,
+                           cancel_func, cancel_baton, result_pool, iterpool));
+      if (output_func)
+        SVN_ERR(output_func(output_baton, i, result, cancel_func,
+                            cancel_baton, iterpool));
+    }
+
+  svn_pool_destroy(iterpool);
+  svn_pool_destroy(result_pool);
+  svn_pool_destroy(context_pool);
+
+  return SVN_NO_ERROR;
+}
+
+#if APR_HAS_THREADS
+
+/* Processing state of a single task.  Instances get reused for every
+ * SLOT_COUNT-th task. */
+typedef struct slot_t
+{
+  /* Result as returned by the process function. */
+  void *result;
+
+  /* Error as returned by the process function. */
+  svn_error_t *error;
+
+  /* Root pool that RESULT is allocated in.  NULL while unused. */
+  apr_pool_t *pool;
+
+  /* Set once the task has been processed and RESULT / ERROR are valid. */
+  svn_boolean_t done;
+} slot_t;
+
+/* Shared state of a single svn_task__run() invocation.  Unless noted
+ * otherwise, the members are read-only while the workers are running. */
+typedef struct run_t
+{
+  /* Parameters as passed to svn_task__run(). */
+  apr_size_t task_count;
+  svn_task__process_func_t process_func;
+  void *process_baton;
+  svn_task__thread_context_constructor_t context_constructor;
+  void *context_baton;
+
+  /* Ring buffer of SLOT_COUNT slots.  Task I uses slot I % SLOT_COUNT. */
+  slot_t *slots;
+  apr_size_t slot_count;
+
+  /* Index of the next task to be picked up by a worker.
+   * Protected by MUTEX. */
+  apr_size_t next_task;
+
+  /* Index of the next task to be passed to the output function.
+   * Protected by MUTEX. */
+  apr_size_t next_output;
+
+  /* Errors that terminated workers outside any task.
+   * Protected by MUTEX. */
+  svn_error_t *worker_error;
+
+  /* Non-zero, once the workers shall not start any further tasks. */
+  volatile svn_atomic_t aborted;
+
+  /* Synchronization objects.  COND gets signaled whenever any of the
+   * protected members or a slot changes. */
+  svn_mutex__t *mutex;
+  apr_thread_cond_t *cond;
+} run_t;
+
+/* Implements svn_cancel_func_t for the worker threads.  BATON is the
+ * run_t.  Cancel as soon as the run has been aborted. */
+static svn_error_t *
+worker_cancel_func(void *baton)
+{
+  run_t *run = baton;
+  if (svn_atomic_read(&run->aborted))
+    return svn_error_create(SVN_ERR_CANCELLED, NULL, NULL);
+
+  return SVN_NO_ERROR;
+}
+
+/* Wake up all threads waiting for RUN->COND.  Return ERR. */
+static svn_error_t *
+broadcast(run_t *run,
+          svn_error_t *err)
+{
+  apr_status_t status = apr_thread_cond_broadcast(run->cond);
+  if (status && !err)
+    return svn_error_wrap_apr(status, _("Can't broadcast condition variable"));
+
+  return err;
+}
+
+/* Set *INDEX to the next task to process in RUN or to RUN->TASK_COUNT if
+ * there is nothing left to do.  Wait for a free result slot if necessary.
+ * RUN->MUTEX must be held by the caller. */
+static svn_error_t *
+claim_task(apr_size_t *index,
+           run_t *run)
+{
+  while (   !svn_atomic_read(&run->aborted)
+         && run->next_task < run->task_count
+         && run->next_task >= run->next_output + run->slot_count)
+    {
+      apr_status_t status
+        = apr_thread_cond_wait(run->cond, svn_mutex__get(run->mutex));
+      if (status)
+        return svn_error_wrap_apr(status, _("Can't wait for condition"));
+    }
+
+  if (svn_atomic_read(&run->aborted) || run->next_task >= run->task_count)
+    {
+      *index = run->task_count;
+    }
+  else
+    {
+      *index = run->next_task;
+      ++run->next_task;
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Store RESULT, allocated in RESULT_POOL, and ERROR in the slot for
+ * task INDEX in RUN and notify the output thread.  RUN->MUTEX must be
+ * held by the caller. */
+static svn_error_t *
+complete_task(run_t *run,
+              apr_size_t index,
+              void *result,
+              svn_error_t *error,
+              apr_pool_t *result_pool)
+{
+  slot_t *slot = &run->slots[index % run->slot_count];
+
+  slot->result = result;
+  slot->error = error;
+  slot->pool = result_pool;
+  slot->done = TRUE;
+
+  return svn_error_trace(broadcast(run, SVN_NO_ERROR));
+}
+
+/* Body of each worker thread in RUN.  Use POOL for all allocations
+ * that shall live as long as the thread. */
+static svn_error_t *
+worker(run_t *run,
+       apr_pool_t *pool)
+{
+  apr_pool_t *iterpool = svn_pool_create(pool);
+  void *thread_context = NULL;
+
+  if (run->context_constructor)
+    SVN_ERR(run->context_constructor(&thread_context, run->context_baton,
+                                     pool, iterpool));
+
+  while (TRUE)
+    {
+      apr_size_t index;
+      apr_pool_t *result_pool;
+      void *result = NULL;
+      svn_error_t *err;
+
+      svn_pool_clear(iterpool);
+
+      SVN_ERR(svn_mutex__lock(run->mutex));
+      SVN_ERR(svn_mutex__unlock(run->mutex, claim_task(&index, run)));
+      if (index >= run->task_count)
+        break;
+
+      /* Results get destroyed by the output thread, i.e. they must not
+       * be allocated in any of our thread-local pools. */
+      result_pool = svn_pool_create(NULL);
+      err = run->process_func(&result, index, run->process_baton,
+                              thread_context, worker_cancel_func, run,
+                              result_pool, iterpool);
+
+      SVN_ERR(svn_mutex__lock(run->mutex));
+      SVN_ERR(svn_mutex__unlock(run->mutex,
+                                complete_task(run, index, result, err,
+                                              result_pool)));
+    }
+
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
+
+/* Thread entry function.  DATA is the run_t. */
+static void * APR_THREAD_FUNC
+worker_thread(apr_thread_t *thread,
+              void *data)
+{
+  run_t *run = data;
+  apr_pool_t *pool = svn_pool_create(NULL);
+  svn_error_t *err = worker(run, pool);
+
+  svn_pool_destroy(pool);
+
+  /* Make sure the output thread does not wait for tasks that will never
+   * be processed. */
+  if (err)
+    {
+      svn_atomic_set(&run->aborted, TRUE);
+      if (svn_mutex__lock(run->mutex) == SVN_NO_ERROR)
+        {
+          run->worker_error = svn_error_compose_create(run->worker_error,
+                                                       err);
+          svn_error_clear(svn_mutex__unlock(run->mutex,
+                                            broadcast(run, SVN_NO_ERROR)));
+        }
+      else
+        {
+          svn_error_clear(err);
+        }
+    }
+
+  return NULL;
+}
+
+/* Wait until the task with number INDEX in RUN has completed or the run
+ * has failed.  Call CANCEL_FUNC with CANCEL_BATON periodically.
+ * RUN->MUTEX must be held by the caller. */
+static svn_error_t *
+wait_for_task(run_t *run,
+              apr_size_t index,
+              svn_cancel_func_t cancel_func,
+              void *cancel_baton)
+{
+  slot_t *slot = &run->slots[index % run->slot_count];
+
+  while (!slot->done)
+    {
+      apr_status_t status;
+
+      if (run->worker_error)
+        {
+          svn_error_t *err = run->worker_error;
+          run->worker_error = NULL;
+
+          return svn_error_trace(err);
+        }
+
+      status = apr_thread_cond_timedwait(run->cond,
+                                         svn_mutex__get(run->mutex),
+                                         CANCEL_CHECK_INTERVAL);
+      if (status && !APR_STATUS_IS_TIMEUP(status))
+        return svn_error_wrap_apr(status, _("Can't wait for condition"));
+
+      if (cancel_func)
+        SVN_ERR(cancel_func(cancel_baton));
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Mark the task with number INDEX in RUN as consumed, making its slot
+ * available for future tasks.  RUN->MUTEX must be held by the caller. */
+static svn_error_t *
+release_task(run_t *run,
+             apr_size_t index)
+{
+  slot_t *slot = &run->slots[index % run->slot_count];
+
+  slot->result = NULL;
+  slot->error = NULL;
+  slot->pool = NULL;
+  slot->done = FALSE;
+  run->next_output = index + 1;
+
+  return svn_error_trace(broadcast(run, SVN_NO_ERROR));
+}
+
+/* Pass the results of all tasks in RUN to OUTPUT_FUNC with OUTPUT_BATON,
+ * in order.  The other parameters are the same as for svn_task__run(). */
+static svn_error_t *
+output_results(run_t *run,
+               svn_task__output_func_t output_func,
+               void *output_baton,
+               svn_cancel_func_t cancel_func,
+               void *cancel_baton,
+               apr_pool_t *scratch_pool)
+{
+  apr_pool_t *iterpool = svn_pool_create(scratch_pool);
+  apr_size_t i;
+
+  for (i = 0; i < run->task_count; ++i)
+    {
+      slot_t *slot = &run->slots[i % run->slot_count];
+      svn_error_t *err;
+
+      svn_pool_clear(iterpool);
+
+      SVN_ERR(svn_mutex__lock(run->mutex));
+      SVN_ERR(svn_mutex__unlock(run->mutex,
+                                wait_for_task(run, i, cancel_func,
+                                              cancel_baton)));
+
+      /* The slot contents are stable until we release it. */
+      err = slot->error;
+      slot->error = NULL;
+      if (!err && output_func)
+        err = output_func(output_baton, i, slot->result, cancel_func,
+                          cancel_baton, iterpool);
+
+      svn_pool_destroy(slot->pool);
+      slot->pool = NULL;
+      SVN_ERR(err);
+
+      SVN_ERR(svn_mutex__lock(run->mutex));
+      SVN_ERR(svn_mutex__unlock(run->mutex, release_task(run, i)));
+    }
+
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
+
+/* Core of svn_task__run() for the multi-threaded case.  THREAD_COUNT is
+ * > 1.  The other parameters are the same as for svn_task__run(). */
+static svn_error_t *
+run_concurrently(int thread_count,
+                 apr_size_t task_count,
+                 svn_task__process_func_t process_func,
+                 void *process_baton,
+                 svn_task__output_func_t output_func,
+                 void *output_baton,
+                 svn_task__thread_context_constructor_t context_constructor,
+                 void *context_baton,
+                 svn_cancel_func_t cancel_func,
+                 void *cancel_baton,
+                 apr_pool_t *scratch_pool)
+{
+  /* The synchronization objects and thread handles will be used from
+   * multiple threads, so allocate them in a thread-safe pool. */
+  apr_pool_t *pool = svn_pool_create(NULL);
+  apr_thread_t **threads = apr_pcalloc(pool, thread_count * sizeof(*threads));
+  run_t *run = apr_pcalloc(pool, sizeof(*run));
+  svn_error_t *err = SVN_NO_ERROR;
+  apr_status_t status;
+  apr_size_t i;
+  int k;
+
+  run->task_count = task_count;
+  run->process_func = process_func;
+  run->process_baton = process_baton;
+  run->context_constructor = context_constructor;
+  run->context_baton = context_baton;
+  run->slot_count = (apr_size_t)thread_count * SLOTS_PER_THREAD;
+  run->slots = apr_pcalloc(pool, run->slot_count * sizeof(*run->slots));
+
+  err = svn_mutex__init(&run->mutex, TRUE, pool);
+  if (!err)
+    {
+      status = apr_thread_cond_create(&run->cond, pool);
+      if (status)
+        err = svn_error_wrap_apr(status, _("Can't create condition variable"));
+    }
+
+  for (k = 0; k < thread_count && !err; ++k)
+    {
+      status = apr_thread_create(&threads[k], NULL, worker_thread, run, pool);
+      if (status)
+        err = svn_error_wrap_apr(status, _("Can't create thread"));
+    }
+
+  if (!err)
+    err = output_results(run, output_func, output_baton,
+                         cancel_func, cancel_baton, scratch_pool);
+
+  /* Stop all workers.  Those still processing a task will be cancelled. */
+  svn_atomic_set(&run->aborted, TRUE);
+  if (run->cond)
+    {
+      svn_error_t *lock_err = svn_mutex__lock(run->mutex);
+      if (lock_err)
+        err = svn_error_compose_create(err, lock_err);
+      else
+        err = svn_error_compose_create(err,
+                                       svn_mutex__unlock(run->mutex,
+                                                         broadcast(run,
+                                                           SVN_NO_ERROR)));
+    }
+
+  for (k = 0; k < thread_count; ++k)
+    if (threads[k])
+      {
+        apr_status_t retval;
+        status = apr_thread_join(&retval, threads[k]);
+        if (status)
+          err = svn_error_compose_create(err,
+                    svn_error_wrap_apr(status, _("Can't join thread")));
+      }
+
+  /* Drop results that will not be output anymore. */
+  for (i = 0; i < run->slot_count; ++i)
+    {
+      svn_error_clear(run->slots[i].error);
+      if (run->slots[i].pool)
+        svn_pool_destroy(run->slots[i].pool);
+    }
+
+  if (run->worker_error)
+    err = svn_error_compose_create(err, run->worker_error);
+
+  svn_pool_destroy(pool);
+
+  return svn_error_trace(err);
+}
+
+#endif /* APR_HAS_THREADS */
+
+svn_error_t *
+svn_task__run(int concurrency,
+              apr_size_t task_count,
+              svn_task__process_func_t process_func,
+              void *process_baton,
+              svn_task__output_func_t output_func,
+              void *output_baton,
+              svn_task__thread_context_constructor_t context_constructor,
+              void *context_baton,
+              svn_cancel_func_t cancel_func,
+              void *cancel_baton,
+              apr_pool_t *scratch_pool)
+{
+#if APR_HAS_THREADS
+  if (concurrency > 1 && task_count > 1)
+    {
+      int thread_count = task_count < (apr_size_t)concurrency
+                       ? (int)task_count
+                       : concurrency;
+
+      return svn_error_trace(run_concurrently(thread_count, task_count,
+                                              process_func, process_baton,
+                                              output_func, output_baton,
+                                              context_constructor,
+                                              context_baton,
+                                              cancel_func, cancel_baton,
+                                              scratch_pool));
+    }
+#endif
+
+  return svn_error_trace(run_sequentially(task_count,
+                                          process_func, process_baton,
+                                          output_func, output_baton,
+                                          context_constructor, context_baton,
+                                          cancel_func, cancel_baton,
+                                          scratch_pool));
+}
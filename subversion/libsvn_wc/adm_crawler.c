@@ -39,6 +39,7 @@
 #include "svn_dirent_uri.h"
 #include "svn_path.h"
 
+#include "private/svn_io_private.h"
 #include "private/svn_wc_private.h"
 
 #include "wc.h"
@@ -1247,6 +1248,331 @@ svn_wc_transmit_text_deltas3(const svn_checksum_t **new_text_base_md5_checksum,
                                                scratch_pool);
 }
 
+/*** Concurrent text delta transmission ***/
+
+struct svn_wc__text_delta_t
+{
+  svn_wc__db_t *db;
+  const char *local_abspath;
+
+  /* Translation of the working file to normal form. */
+  svn_subst_eol_style_t eol_style;
+  const char *eol;
+  apr_hash_t *keywords;
+  svn_boolean_t special;
+
+  /* The pristine text to use as delta base and its recorded MD5.
+     Both are NULL when sending a fulltext. */
+  const char *base_abspath;
+  const svn_checksum_t *expected_md5_checksum;
+
+  /* Where to create the new pristine text and how to install it. */
+  const char *install_dir_abspath;
+  svn_wc__db_install_data_t *install_data;
+
+  /* The following are set by svn_wc__text_delta_compute(). */
+
+  /* The delta in svndiff0 format (without header) and the number of
+     windows in it. */
+  const char *spool_abspath;
+  int window_count;
+
+  /* The MD5 calculated while reading the delta base. */
+  svn_checksum_t *verify_checksum;
+
+  /* The checksums of the new pristine text. */
+  svn_checksum_t *local_md5_checksum;
+  svn_checksum_t *local_sha1_checksum;
+};
+
+svn_error_t *
+svn_wc__text_delta_prepare(svn_wc__text_delta_t **delta,
+                           svn_wc_context_t *wc_ctx,
+                           const char *local_abspath,
+                           svn_boolean_t fulltext,
+                           apr_pool_t *result_pool,
+                           apr_pool_t *scratch_pool)
+{
+  svn_wc__db_t *db = wc_ctx->db;
+  svn_wc__text_delta_t *d = apr_pcalloc(result_pool, sizeof(*d));
+
+  d->db = db;
+  d->local_abspath = apr_pstrdup(result_pool, local_abspath);
+
+  SVN_ERR(svn_wc__get_translate_info(&d->eol_style, &d->eol, &d->keywords,
+                                     &d->special, db, local_abspath, NULL,
+                                     FALSE, result_pool, scratch_pool));
+
+  /* See read_and_checksum_pristine_text(). */
+  if (! fulltext)
+    {
+      svn_wc__db_status_t status;
+      svn_node_kind_t kind;
+      const svn_checksum_t *sha1_checksum;
+
+      SVN_ERR(svn_wc__db_read_pristine_info(&status, &kind, NULL, NULL, NULL,
+                                            NULL, &sha1_checksum, NULL, NULL,
+                                            NULL, db, local_abspath,
+                                            scratch_pool, scratch_pool));
+      if (kind != svn_node_file)
+        return svn_error_createf(SVN_ERR_NODE_UNEXPECTED_KIND, NULL,
+                                 _("Can only get the pristine contents of "
+                                   "files; '%s' is not a file"),
+                                 svn_dirent_local_style(local_abspath,
+                                                        scratch_pool));
+
+      if (sha1_checksum)
+        {
+          SVN_ERR(svn_wc__db_pristine_get_path(&d->base_abspath, db,
+                                               local_abspath, sha1_checksum,
+                                               result_pool, scratch_pool));
+          SVN_ERR(svn_wc__db_pristine_get_md5(&d->expected_md5_checksum, db,
+                                              local_abspath, sha1_checksum,
+                                              result_pool, scratch_pool));
+        }
+    }
+
+  SVN_ERR(svn_wc__db_pristine_prepare_install_deferred(&d->install_data,
+                                                       &d->install_dir_abspath,
+                                                       db, local_abspath,
+                                                       result_pool,
+                                                       scratch_pool));
+
+  *delta = d;
+  return SVN_NO_ERROR;
+}
+
+/* Baton for count_window(). */
+typedef struct count_window_baton_t
+{
+  svn_txdelta_window_handler_t handler;
+  void *handler_baton;
+  int *count;
+} count_window_baton_t;
+
+/* Implements svn_txdelta_window_handler_t.  Count the non-NULL windows
+   before passing them on. */
+static svn_error_t *
+count_window(svn_txdelta_window_t *window,
+             void *baton)
+{
+  count_window_baton_t *b = baton;
+
+  if (window)
+    ++*b->count;
+
+  return svn_error_trace(b->handler(window, b->handler_baton));
+}
+
+svn_error_t *
+svn_wc__text_delta_compute(svn_wc__text_delta_t *delta,
+                           apr_pool_t *result_pool,
+                           apr_pool_t *scratch_pool)
+{
+  svn_stream_t *local_stream;
+  svn_stream_t *base_stream;
+  svn_stream_t *install_stream;
+  svn_stream_t *spool_stream;
+  svn_txdelta_stream_t *txdelta_stream;
+  count_window_baton_t cb;
+  svn_error_t *err;
+
+  SVN_ERR(svn_wc__translated_stream_to_nf(&local_stream,
+                                          delta->local_abspath,
+                                          delta->eol_style, delta->eol,
+                                          delta->keywords, delta->special,
+                                          FALSE, scratch_pool,
+                                          scratch_pool));
+
+  /* Write the new pristine text while reading the working file. */
+  SVN_ERR(svn_stream__create_for_install(&install_stream,
+                                         delta->install_dir_abspath,
+                                         result_pool, scratch_pool));
+  svn_wc__db_pristine_install_set_stream(delta->install_data,
+                                         install_stream);
+  local_stream = copying_stream(local_stream,
+                                svn_stream_checksummed2(
+                                  install_stream, NULL,
+                                  &delta->local_sha1_checksum,
+                                  svn_checksum_sha1, FALSE, result_pool),
+                                scratch_pool);
+  local_stream = svn_stream_checksummed2(local_stream,
+                                         &delta->local_md5_checksum,
+                                         NULL, svn_checksum_md5, TRUE,
+                                         result_pool);
+
+  if (delta->base_abspath)
+    {
+      SVN_ERR(svn_stream_open_readonly(&base_stream, delta->base_abspath,
+                                       scratch_pool, scratch_pool));
+      base_stream = svn_stream_checksummed2(base_stream,
+                                            &delta->verify_checksum, NULL,
+                                            svn_checksum_md5, TRUE,
+                                            result_pool);
+    }
+  else
+    base_stream = svn_stream_empty(scratch_pool);
+
+  /* Spool the delta.  Compression is left to the editor. */
+  SVN_ERR(svn_stream_open_unique(&spool_stream, &delta->spool_abspath,
+                                 NULL, svn_io_file_del_on_pool_cleanup,
+                                 result_pool, scratch_pool));
+  svn_txdelta_to_svndiff3(&cb.handler, &cb.handler_baton,
+                          svn_stream_disown(spool_stream, scratch_pool),
+                          0, SVN_DELTA_COMPRESSION_LEVEL_NONE,
+                          scratch_pool);
+  delta->window_count = 0;
+  cb.count = &delta->window_count;
+
+  svn_txdelta2(&txdelta_stream, base_stream, local_stream, FALSE,
+               scratch_pool);
+  err = svn_txdelta_send_txstream(txdelta_stream, count_window, &cb,
+                                  scratch_pool);
+
+  /* Close the streams to force writing the digests. */
+  err = svn_error_compose_create(err, svn_stream_close(base_stream));
+  err = svn_error_compose_create(err, svn_stream_close(local_stream));
+  err = svn_error_compose_create(err, svn_stream_close(spool_stream));
+
+  if (err)
+    {
+      delta->verify_checksum = NULL;
+      err = svn_error_compose_create(
+              err, svn_stream__install_delete(install_stream, scratch_pool));
+
+      return svn_error_quick_wrapf(err,
+                                   _("While preparing '%s' for commit"),
+                                   svn_dirent_local_style(
+                                     delta->local_abspath, scratch_pool));
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Baton for open_spooled_txdelta_stream() and read_spooled_window(). */
+typedef struct spooled_txdelta_baton_t
+{
+  const svn_wc__text_delta_t *delta;
+  svn_stream_t *stream;
+  int windows_left;
+} spooled_txdelta_baton_t;
+
+/* Implements svn_txdelta_next_window_fn_t. */
+static svn_error_t *
+read_spooled_window(svn_txdelta_window_t **window,
+                    void *baton,
+                    apr_pool_t *pool)
+{
+  spooled_txdelta_baton_t *b = baton;
+
+  if (b->windows_left == 0)
+    {
+      *window = NULL;
+      return SVN_NO_ERROR;
+    }
+
+  b->windows_left--;
+  return svn_error_trace(svn_txdelta_read_svndiff_window(window, b->stream,
+                                                         0, pool));
+}
+
+/* Implements svn_txdelta_md5_digest_fn_t. */
+static const unsigned char *
+spooled_md5_digest(void *baton)
+{
+  spooled_txdelta_baton_t *b = baton;
+
+  return b->windows_left ? NULL : b->delta->local_md5_checksum->digest;
+}
+
+/* Implements svn_txdelta_stream_open_func_t.  BATON is the
+   svn_wc__text_delta_t whose spooled delta to return. */
+static svn_error_t *
+open_spooled_txdelta_stream(svn_txdelta_stream_t **txdelta_stream_p,
+                            void *baton,
+                            apr_pool_t *result_pool,
+                            apr_pool_t *scratch_pool)
+{
+  spooled_txdelta_baton_t *b = apr_pcalloc(result_pool, sizeof(*b));
+  char header[4];
+  apr_size_t len = sizeof(header);
+
+  b->delta = baton;
+  b->windows_left = b->delta->window_count;
+
+  /* Every call restarts from the beginning. */
+  SVN_ERR(svn_stream_open_readonly(&b->stream, b->delta->spool_abspath,
+                                   result_pool, scratch_pool));
+  SVN_ERR(svn_stream_read_full(b->stream, header, &len));
+  if (len != sizeof(header))
+    return svn_error_create(SVN_ERR_SVNDIFF_UNEXPECTED_END, NULL,
+                            _("Unexpected end of svndiff input"));
+
+  *txdelta_stream_p = svn_txdelta_stream_create(b, read_spooled_window,
+                                                spooled_md5_digest,
+                                                result_pool);
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_wc__text_delta_send(const svn_checksum_t **new_text_base_md5_checksum,
+                        const svn_checksum_t **new_text_base_sha1_checksum,
+                        svn_wc__text_delta_t *delta,
+                        const svn_delta_editor_t *editor,
+                        void *file_baton,
+                        apr_pool_t *result_pool,
+                        apr_pool_t *scratch_pool)
+{
+  const char *base_digest_hex = NULL;
+
+  /* See svn_wc__internal_transmit_text_deltas(). */
+  if (delta->expected_md5_checksum
+      && !svn_checksum_match(delta->expected_md5_checksum,
+                             delta->verify_checksum))
+    {
+      svn_error_t *err;
+
+      err = svn_checksum_mismatch_err(delta->expected_md5_checksum,
+                                      delta->verify_checksum, scratch_pool,
+                                      _("Checksum mismatch for text base "
+                                        "of '%s'"),
+                                      svn_dirent_local_style(
+                                        delta->local_abspath, scratch_pool));
+
+      return svn_error_create(SVN_ERR_WC_CORRUPT_TEXT_BASE, err, NULL);
+    }
+
+  if (delta->expected_md5_checksum)
+    base_digest_hex = svn_checksum_to_cstring_display(
+                        delta->expected_md5_checksum, scratch_pool);
+
+  SVN_ERR_W(editor->apply_textdelta_stream(editor, file_baton,
+                                           base_digest_hex,
+                                           open_spooled_txdelta_stream,
+                                           delta, scratch_pool),
+            apr_psprintf(scratch_pool, _("While preparing '%s' for commit"),
+                         svn_dirent_local_style(delta->local_abspath,
+                                                scratch_pool)));
+
+  SVN_ERR(svn_wc__db_pristine_install(delta->install_data,
+                                      delta->local_sha1_checksum,
+                                      delta->local_md5_checksum,
+                                      scratch_pool));
+
+  if (new_text_base_md5_checksum)
+    *new_text_base_md5_checksum = svn_checksum_dup(delta->local_md5_checksum,
+                                                   result_pool);
+  if (new_text_base_sha1_checksum)
+    *new_text_base_sha1_checksum
+      = svn_checksum_dup(delta->local_sha1_checksum, result_pool);
+
+  return svn_error_trace(
+             editor->close_file(file_baton,
+                                svn_checksum_to_cstring(
+                                  delta->local_md5_checksum, scratch_pool),
+                                scratch_pool));
+}
+
 svn_error_t *
 svn_wc__internal_transmit_prop_deltas(svn_wc__db_t *db,
                                      const char *local_abspath,
@@ -78,16 +78,10 @@
 */
 
 
-/* Set *MODIFIED_P to TRUE if (after translation) VERSIONED_FILE_ABSPATH
- * (of VERSIONED_FILE_SIZE bytes) differs from PRISTINE_STREAM (of
- * PRISTINE_SIZE bytes), else to FALSE if not.
- *
- * If EXACT_COMPARISON is FALSE, translate VERSIONED_FILE_ABSPATH's EOL
- * style and keywords to repository-normal form according to its properties,
- * and compare the result with PRISTINE_STREAM.  If EXACT_COMPARISON is
- * TRUE, translate PRISTINE_STREAM's EOL style and keywords to working-copy
- * form according to VERSIONED_FILE_ABSPATH's properties, and compare the
- * result with VERSIONED_FILE_ABSPATH.
+/* Determine how to translate VERSIONED_FILE_ABSPATH in DB before comparing
+ * it with its pristine text.  Set *NEED_TRANSLATION to TRUE if any
+ * translation is required and fill *EOL_STYLE, *EOL_STR, *KEYWORDS and
+ * *SPECIAL accordingly.
  *
  * HAS_PROPS should be TRUE if the file had properties when it was not
  * modified, otherwise FALSE.
@@ -95,50 +89,89 @@
  * PROPS_MOD should be TRUE if the file's properties have been changed,
  * otherwise FALSE.
  *
- * PRISTINE_STREAM will be closed before a successful return.
- *
- * DB is a wc_db; use SCRATCH_POOL for temporary allocation.
+ * EXACT_COMPARISON is as for compare_contents().  Allocate the results
+ * in RESULT_POOL and use SCRATCH_POOL for temporary allocations.
  */
 static svn_error_t *
-compare_and_verify(svn_boolean_t *modified_p,
-                   svn_wc__db_t *db,
-                   const char *versioned_file_abspath,
-                   svn_filesize_t versioned_file_size,
-                   svn_stream_t *pristine_stream,
-                   svn_filesize_t pristine_size,
-                   svn_boolean_t has_props,
-                   svn_boolean_t props_mod,
-                   svn_boolean_t exact_comparison,
-                   apr_pool_t *scratch_pool)
+get_translation(svn_boolean_t *need_translation,
+                svn_subst_eol_style_t *eol_style,
+                const char **eol_str,
+                apr_hash_t **keywords,
+                svn_boolean_t *special,
+                svn_wc__db_t *db,
+                const char *versioned_file_abspath,
+                svn_boolean_t has_props,
+                svn_boolean_t props_mod,
+                svn_boolean_t exact_comparison,
+                apr_pool_t *result_pool,
+                apr_pool_t *scratch_pool)
 {
-  svn_boolean_t same;
-  svn_subst_eol_style_t eol_style;
-  const char *eol_str;
-  apr_hash_t *keywords;
-  svn_boolean_t special = FALSE;
-  svn_boolean_t need_translation;
-  svn_stream_t *v_stream; /* versioned_file */
-
-  SVN_ERR_ASSERT(svn_dirent_is_absolute(versioned_file_abspath));
+  *eol_style = svn_subst_eol_style_none;
+  *eol_str = NULL;
+  *keywords = NULL;
+  *special = FALSE;
 
   if (props_mod)
     has_props = TRUE; /* Maybe it didn't have properties; but it has now */
 
   if (has_props)
     {
-      SVN_ERR(svn_wc__get_translate_info(&eol_style, &eol_str,
-                                         &keywords,
-                                         &special,
+      SVN_ERR(svn_wc__get_translate_info(eol_style, eol_str,
+                                         keywords,
+                                         special,
                                          db, versioned_file_abspath, NULL,
                                          !exact_comparison,
-                                         scratch_pool, scratch_pool));
+                                         result_pool, scratch_pool));
 
-      need_translation = svn_subst_translation_required(eol_style, eol_str,
-                                                        keywords, special,
-                                                        TRUE);
+      *need_translation = svn_subst_translation_required(*eol_style,
+                                                         *eol_str,
+                                                         *keywords,
+                                                         *special,
+                                                         TRUE);
     }
   else
-    need_translation = FALSE;
+    *need_translation = FALSE;
+
+  return SVN_NO_ERROR;
+}
+
+/* Set *MODIFIED_P to TRUE if (after translation) VERSIONED_FILE_ABSPATH
+ * (of VERSIONED_FILE_SIZE bytes) differs from PRISTINE_STREAM (of
+ * PRISTINE_SIZE bytes), else to FALSE if not.
+ *
+ * If EXACT_COMPARISON is FALSE, translate VERSIONED_FILE_ABSPATH's EOL
+ * style and keywords to repository-normal form according to its properties,
+ * and compare the result with PRISTINE_STREAM.  If EXACT_COMPARISON is
+ * TRUE, translate PRISTINE_STREAM's EOL style and keywords to working-copy
+ * form according to VERSIONED_FILE_ABSPATH's properties, and compare the
+ * result with VERSIONED_FILE_ABSPATH.
+ *
+ * NEED_TRANSLATION, EOL_STYLE, EOL_STR, KEYWORDS and SPECIAL describe
+ * these properties as returned by get_translation().
+ *
+ * PRISTINE_STREAM will be closed before a successful return.
+ *
+ * This does not access the working copy database.  Use SCRATCH_POOL for
+ * temporary allocation.
+ */
+static svn_error_t *
+compare_contents(svn_boolean_t *modified_p,
+                 const char *versioned_file_abspath,
+                 svn_filesize_t versioned_file_size,
+                 svn_stream_t *pristine_stream,
+                 svn_filesize_t pristine_size,
+                 svn_boolean_t need_translation,
+                 svn_subst_eol_style_t eol_style,
+                 const char *eol_str,
+                 apr_hash_t *keywords,
+                 svn_boolean_t special,
+                 svn_boolean_t exact_comparison,
+                 apr_pool_t *scratch_pool)
+{
+  svn_boolean_t same;
+  svn_stream_t *v_stream; /* versioned_file */
+
+  SVN_ERR_ASSERT(svn_dirent_is_absolute(versioned_file_abspath));
 
   if (! need_translation
       && (versioned_file_size != pristine_size))
@@ -206,6 +239,43 @@ compare_and_verify(svn_boolean_t *modified_p,
   return SVN_NO_ERROR;
 }
 
+/* Like compare_contents() but get the translation information for
+ * VERSIONED_FILE_ABSPATH from DB.  HAS_PROPS and PROPS_MOD are as for
+ * get_translation().
+ */
+static svn_error_t *
+compare_and_verify(svn_boolean_t *modified_p,
+                   svn_wc__db_t *db,
+                   const char *versioned_file_abspath,
+                   svn_filesize_t versioned_file_size,
+                   svn_stream_t *pristine_stream,
+                   svn_filesize_t pristine_size,
+                   svn_boolean_t has_props,
+                   svn_boolean_t props_mod,
+                   svn_boolean_t exact_comparison,
+                   apr_pool_t *scratch_pool)
+{
+  svn_subst_eol_style_t eol_style;
+  const char *eol_str;
+  apr_hash_t *keywords;
+  svn_boolean_t special;
+  svn_boolean_t need_translation;
+
+  SVN_ERR(get_translation(&need_translation, &eol_style, &eol_str,
+                          &keywords, &special,
+                          db, versioned_file_abspath, has_props, props_mod,
+                          exact_comparison, scratch_pool, scratch_pool));
+
+  return svn_error_trace(compare_contents(modified_p,
+                                          versioned_file_abspath,
+                                          versioned_file_size,
+                                          pristine_stream, pristine_size,
+                                          need_translation, eol_style,
+                                          eol_str, keywords, special,
+                                          exact_comparison,
+                                          scratch_pool));
+}
+
 svn_error_t *
 svn_wc__internal_file_modified_p(svn_boolean_t *modified_p,
                                  svn_wc__db_t *db,
@@ -325,19 +395,167 @@ svn_wc__internal_file_modified_p(svn_boolean_t *modified_p,
   }
 
   if (!*modified_p)
+    SVN_ERR(svn_wc__repair_timestamps(db, local_abspath, dirent,
+                                      scratch_pool));
+
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_wc__repair_timestamps(svn_wc__db_t *db,
+                          const char *local_abspath,
+                          const svn_io_dirent2_t *dirent,
+                          apr_pool_t *scratch_pool)
+{
+  svn_boolean_t own_lock;
+
+  /* The timestamp is missing or "broken" so "repair" it if we can. */
+  SVN_ERR(svn_wc__db_wclock_owns_lock(&own_lock, db, local_abspath, FALSE,
+                                      scratch_pool));
+  if (own_lock)
+    SVN_ERR(svn_wc__db_global_record_fileinfo(db, local_abspath,
+                                              dirent->filesize,
+                                              dirent->mtime,
+                                              scratch_pool));
+
+  return SVN_NO_ERROR;
+}
+
+/* The database-independent part of a text modification check.  */
+struct svn_wc__text_check_t
+{
+  /* The working file. */
+  const char *local_abspath;
+
+  /* Its pristine text and the size of that. */
+  const char *pristine_abspath;
+  svn_filesize_t pristine_size;
+
+  /* Size and timestamp of the working file as recorded in the DB. */
+  svn_filesize_t recorded_size;
+  apr_time_t recorded_mod_time;
+
+  /* Translation to apply before comparing, see get_translation(). */
+  svn_boolean_t need_translation;
+  svn_subst_eol_style_t eol_style;
+  const char *eol_str;
+  apr_hash_t *keywords;
+  svn_boolean_t special;
+};
+
+svn_error_t *
+svn_wc__text_modified_prepare(svn_wc__text_check_t **check,
+                              svn_boolean_t *modified_p,
+                              svn_wc__db_t *db,
+                              const char *local_abspath,
+                              apr_pool_t *result_pool,
+                              apr_pool_t *scratch_pool)
+{
+  svn_wc__text_check_t *result;
+  svn_wc__db_status_t status;
+  svn_node_kind_t kind;
+  const svn_checksum_t *checksum;
+  svn_boolean_t has_props;
+  svn_boolean_t props_mod;
+
+  result = apr_pcalloc(result_pool, sizeof(*result));
+  result->local_abspath = apr_pstrdup(result_pool, local_abspath);
+
+  /* Read the same info as svn_wc__internal_file_modified_p(). */
+  SVN_ERR(svn_wc__db_read_info(&status, &kind, NULL, NULL, NULL, NULL, NULL,
+                               NULL, NULL, NULL, &checksum, NULL, NULL, NULL,
+                               NULL, NULL, NULL,
+                               &result->recorded_size,
+                               &result->recorded_mod_time,
+                               NULL, NULL, NULL, &has_props, &props_mod,
+                               NULL, NULL, NULL,
+                               db, local_abspath,
+                               scratch_pool, scratch_pool));
+
+  /* No pristine to compare with means "modified", see above. */
+  if (!checksum
+      || (kind != svn_node_file)
+      || ((status != svn_wc__db_status_normal)
+          && (status != svn_wc__db_status_added)))
     {
-      svn_boolean_t own_lock;
+      *check = NULL;
+      *modified_p = TRUE;
+      return SVN_NO_ERROR;
+    }
 
-      /* The timestamp is missing or "broken" so "repair" it if we can. */
-      SVN_ERR(svn_wc__db_wclock_owns_lock(&own_lock, db, local_abspath, FALSE,
-                                          scratch_pool));
-      if (own_lock)
-        SVN_ERR(svn_wc__db_global_record_fileinfo(db, local_abspath,
-                                                  dirent->filesize,
-                                                  dirent->mtime,
-                                                  scratch_pool));
+  SVN_ERR(svn_wc__db_pristine_read(NULL, &result->pristine_size,
+                                   db, local_abspath, checksum,
+                                   scratch_pool, scratch_pool));
+  SVN_ERR(svn_wc__db_pristine_get_path(&result->pristine_abspath,
+                                       db, local_abspath, checksum,
+                                       result_pool, scratch_pool));
+  SVN_ERR(get_translation(&result->need_translation, &result->eol_style,
+                          &result->eol_str, &result->keywords,
+                          &result->special,
+                          db, local_abspath, has_props, props_mod,
+                          FALSE /* exact_comparison */,
+                          result_pool, scratch_pool));
+
+  *check = result;
+  *modified_p = FALSE;
+
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_wc__text_modified_check(svn_boolean_t *modified_p,
+                            const svn_io_dirent2_t **compared_dirent,
+                            const svn_wc__text_check_t *check,
+                            apr_pool_t *result_pool,
+                            apr_pool_t *scratch_pool)
+{
+  const svn_io_dirent2_t *dirent;
+  apr_file_t *pristine_file;
+  svn_stream_t *pristine_stream;
+  svn_error_t *err;
+
+  *compared_dirent = NULL;
+
+  SVN_ERR(svn_io_stat_dirent2(&dirent, check->local_abspath, FALSE, TRUE,
+                              result_pool, scratch_pool));
+
+  if (dirent->kind != svn_node_file)
+    {
+      /* There is no file on disk, so the text is missing, not modified. */
+      *modified_p = FALSE;
+      return SVN_NO_ERROR;
     }
 
+  /* The same heuristic as in svn_wc__internal_file_modified_p(). */
+  if ((check->recorded_size == SVN_INVALID_FILESIZE
+       || dirent->filesize == check->recorded_size)
+      && check->recorded_mod_time == dirent->mtime)
+    {
+      *modified_p = FALSE;
+      return SVN_NO_ERROR;
+    }
+
+  SVN_ERR(svn_io_file_open(&pristine_file, check->pristine_abspath,
+                           APR_READ, APR_OS_DEFAULT, scratch_pool));
+  pristine_stream = svn_stream_from_aprfile2(pristine_file, FALSE,
+                                             scratch_pool);
+
+  err = compare_contents(modified_p, check->local_abspath, dirent->filesize,
+                         pristine_stream, check->pristine_size,
+                         check->need_translation, check->eol_style,
+                         check->eol_str, check->keywords, check->special,
+                         FALSE /* exact_comparison */, scratch_pool);
+
+  /* At this point we already opened the pristine file, so we know that
+     the access denied applies to the working copy path */
+  if (err && APR_STATUS_IS_EACCES(err->apr_err))
+    return svn_error_create(SVN_ERR_WC_PATH_ACCESS_DENIED, err, NULL);
+  else
+    SVN_ERR(err);
+
+  if (!*modified_p)
+    *compared_dirent = dirent;
+
   return SVN_NO_ERROR;
 }
 
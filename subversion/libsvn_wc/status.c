@@ -51,6 +51,7 @@
 #include "private/svn_wc_private.h"
 #include "private/svn_fspath.h"
 #include "private/svn_editor.h"
+#include "private/svn_task.h"
 
 
 /* The file internal variant of svn_wc_status3_t, with slightly more
@@ -333,6 +334,9 @@ internal_status(svn_wc__internal_status_t **status,
    returned to reflect that assumption. If CHECK_WORKING_COPY is FALSE,
    do not adjust the result for missing working copy files.
 
+   If TEXT_MODIFIED is not NULL, it is the result of a text modification
+   check for LOCAL_ABSPATH that has already been performed by the caller.
+
    The status struct's repos_lock field will be set to REPOS_LOCK.
 */
 static svn_error_t *
@@ -347,6 +351,7 @@ assemble_status(svn_wc__internal_status_t **status,
                 svn_boolean_t get_all,
                 svn_boolean_t ignore_text_mods,
                 svn_boolean_t check_working_copy,
+                const svn_boolean_t *text_modified,
                 const svn_lock_t *repos_lock,
                 apr_pool_t *result_pool,
                 apr_pool_t *scratch_pool)
@@ -468,6 +473,8 @@ assemble_status(svn_wc__internal_status_t **status,
                      && info->recorded_size == dirent->filesize
                      && info->recorded_time == dirent->mtime))
             text_modified_p = FALSE;
+          else if (text_modified)
+            text_modified_p = *text_modified;
           else
             {
               svn_error_t *err;
@@ -797,6 +804,7 @@ send_status_structure(const struct walk_status_baton *wb,
                       const struct svn_wc__db_info_t *info,
                       const svn_io_dirent2_t *dirent,
                       svn_boolean_t get_all,
+                      const svn_boolean_t *text_modified,
                       svn_wc_status_func4_t status_func,
                       void *status_baton,
                       apr_pool_t *scratch_pool)
@@ -831,7 +839,8 @@ send_status_structure(const struct walk_status_baton *wb,
                           parent_repos_uuid,
                           info, dirent, get_all,
                           wb->ignore_text_mods, wb->check_working_copy,
-                          repos_lock, scratch_pool, scratch_pool));
+                          text_modified, repos_lock,
+                          scratch_pool, scratch_pool));
 
   if (statstruct && status_func)
     return svn_error_trace((*status_func)(status_baton, local_abspath,
@@ -1059,6 +1068,9 @@ get_dir_status(const struct walk_status_baton *wb,
  *
  * DIRENT should reflect LOCAL_ABSPATH's dirent information.
  *
+ * TEXT_MODIFIED may point to the precomputed result of a text modification
+ * check for LOCAL_ABSPATH, see assemble_status().
+ *
  * DIR_REPOS_* should reflect LOCAL_ABSPATH's parent URL, i.e. LOCAL_ABSPATH's
  * URL treated with svn_uri_dirname(). ### TODO verify this (externals)
  *
@@ -1079,6 +1091,7 @@ one_child_status(const struct walk_status_baton *wb,
                  const char *parent_abspath,
                  const struct svn_wc__db_info_t *info,
                  const svn_io_dirent2_t *dirent,
+                 const svn_boolean_t *text_modified,
                  const char *dir_repos_root_url,
                  const char *dir_repos_relpath,
                  const char *dir_repos_uuid,
@@ -1115,7 +1128,7 @@ one_child_status(const struct walk_status_baton *wb,
                                     dir_repos_root_url,
                                     dir_repos_relpath,
                                     dir_repos_uuid,
-                                    info, dirent, get_all,
+                                    info, dirent, get_all, text_modified,
                                     status_func, status_baton,
                                     scratch_pool));
 
@@ -1188,6 +1201,238 @@ one_child_status(const struct walk_status_baton *wb,
   return SVN_NO_ERROR;
 }
 
+/* A text modification check to be run by check_text_mods(). */
+typedef struct text_check_task_t
+{
+  /* Name and path of the child node to check. */
+  const char *name;
+  const char *local_abspath;
+
+  /* The check as returned by svn_wc__text_modified_prepare(). */
+  const svn_wc__text_check_t *check;
+} text_check_task_t;
+
+/* The result of a text_check_task_t. */
+typedef struct text_check_result_t
+{
+  /* Whether the file has been modified. */
+  svn_boolean_t modified;
+
+  /* The file's dirent, if it needs a timestamp repair.  NULL otherwise. */
+  const svn_io_dirent2_t *compared_dirent;
+} text_check_result_t;
+
+/* Baton for text_check_output(). */
+typedef struct text_check_output_baton_t
+{
+  /* The DB to record repaired timestamps in. */
+  svn_wc__db_t *db;
+
+  /* The array of text_check_task_t that is being processed. */
+  const apr_array_header_t *tasks;
+
+  /* Child name -> svn_boolean_t *, allocated in RESULT_POOL. */
+  apr_hash_t *text_mods;
+  apr_pool_t *result_pool;
+} text_check_output_baton_t;
+
+/* Implements svn_task__process_func_t for the apr_array_header_t * of
+ * text_check_task_t given as PROCESS_BATON.
+ *
+ * Set *RESULT to NULL if the check failed with an error.  Such checks are
+ * simply repeated by assemble_status(), which will then report that error
+ * at the same point of the status walk as before.
+ */
+static svn_error_t *
+text_check_process(void **result,
+                   apr_size_t task_index,
+                   void *process_baton,
+                   void *thread_context,
+                   svn_cancel_func_t cancel_func,
+                   void *cancel_baton,
+                   apr_pool_t *result_pool,
+                   apr_pool_t *scratch_pool)
+{
+  const apr_array_header_t *tasks = process_baton;
+  const text_check_task_t *task
+    = &APR_ARRAY_IDX(tasks, task_index, text_check_task_t);
+  text_check_result_t *check_result
+    = apr_pcalloc(result_pool, sizeof(*check_result));
+  svn_error_t *err;
+
+  err = svn_wc__text_modified_check(&check_result->modified,
+                                    &check_result->compared_dirent,
+                                    task->check, result_pool, scratch_pool);
+  if (err && err->apr_err == SVN_ERR_WC_PATH_ACCESS_DENIED)
+    {
+      /* Same as in assemble_status(). */
+      svn_error_clear(err);
+      check_result->modified = TRUE;
+      check_result->compared_dirent = NULL;
+    }
+  else if (err)
+    {
+      svn_error_clear(err);
+      check_result = NULL;
+    }
+
+  *result = check_result;
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_task__output_func_t for the text_check_result_t RESULT
+ * of the text_check_task_t with index TASK_INDEX.  OUTPUT_BATON is a
+ * text_check_output_baton_t.
+ */
+static svn_error_t *
+text_check_output(void *output_baton,
+                  apr_size_t task_index,
+                  void *result,
+                  svn_cancel_func_t cancel_func,
+                  void *cancel_baton,
+                  apr_pool_t *scratch_pool)
+{
+  text_check_output_baton_t *baton = output_baton;
+  const text_check_result_t *check_result = result;
+  const text_check_task_t *task
+    = &APR_ARRAY_IDX(baton->tasks, task_index, text_check_task_t);
+  svn_boolean_t *modified;
+
+  if (!check_result)
+    return SVN_NO_ERROR;
+
+  /* The DB may only be accessed from this thread. */
+  if (check_result->compared_dirent)
+    SVN_ERR(svn_wc__repair_timestamps(baton->db,
+                                      task->local_abspath,
+                                      check_result->compared_dirent,
+                                      scratch_pool));
+
+  modified = apr_palloc(baton->result_pool, sizeof(*modified));
+  *modified = check_result->modified;
+  svn_hash_sets(baton->text_mods, task->name, modified);
+
+  return SVN_NO_ERROR;
+}
+
+/* Compare the files in SORTED_CHILDREN of directory LOCAL_ABSPATH with
+ * their pristine texts, using up to svn_wc__db_get_jobs() threads.
+ * NODES and DIRENTS are the children's infos and dirents as read by
+ * get_dir_status().
+ *
+ * Set *TEXT_MODS to a hash mapping child names to svn_boolean_t *,
+ * telling whether that child's text is modified.  Only the files for which
+ * assemble_status() would have to call svn_wc__internal_file_modified_p()
+ * are checked; all others are not in the hash.  The order in which the
+ * status callback sees the results is not affected by this.
+ *
+ * Allocate *TEXT_MODS in RESULT_POOL and use SCRATCH_POOL for temporaries.
+ */
+static svn_error_t *
+check_text_mods(apr_hash_t **text_mods,
+                const struct walk_status_baton *wb,
+                const char *local_abspath,
+                const apr_array_header_t *sorted_children,
+                apr_hash_t *nodes,
+                apr_hash_t *dirents,
+                svn_cancel_func_t cancel_func,
+                void *cancel_baton,
+                apr_pool_t *result_pool,
+                apr_pool_t *scratch_pool)
+{
+  int jobs = svn_wc__db_get_jobs(wb->db);
+  apr_array_header_t *tasks;
+  text_check_output_baton_t baton;
+  apr_pool_t *iterpool;
+  int i;
+
+  *text_mods = apr_hash_make(result_pool);
+  if (jobs < 2 || wb->ignore_text_mods || !wb->check_working_copy)
+    return SVN_NO_ERROR;
+
+  /* Prepare the checks.  This needs the DB and must be done here. */
+  tasks = apr_array_make(scratch_pool, 16, sizeof(text_check_task_t));
+  iterpool = svn_pool_create(scratch_pool);
+  for (i = 0; i < sorted_children->nelts; i++)
+    {
+      const svn_sort__item_t *item
+        = &APR_ARRAY_IDX(sorted_children, i, svn_sort__item_t);
+      const struct svn_wc__db_info_t *info
+        = apr_hash_get(nodes, item->key, item->klen);
+      const svn_io_dirent2_t *dirent
+        = apr_hash_get(dirents, item->key, item->klen);
+      text_check_task_t *task;
+      const char *child_abspath;
+      svn_wc__text_check_t *check;
+      svn_boolean_t modified;
+      svn_error_t *err;
+
+      /* Only files whose recorded info doesn't match, see
+         assemble_status(). */
+      if (!info
+          || !dirent
+          || (info->kind != svn_node_file && info->kind != svn_node_symlink)
+          || dirent->kind != svn_node_file
+          || !info->has_checksum
+          || info->incomplete
+          || (info->status != svn_wc__db_status_normal
+              && info->status != svn_wc__db_status_added)
+          || (info->recorded_size != SVN_INVALID_FILESIZE
+              && info->recorded_time != 0
+              && info->recorded_size == dirent->filesize
+              && info->recorded_time == dirent->mtime))
+        continue;
+
+#ifdef HAVE_SYMLINK
+      if (info->special != dirent->special)
+        continue;
+#endif /* HAVE_SYMLINK */
+
+      svn_pool_clear(iterpool);
+      child_abspath = svn_dirent_join(local_abspath, item->key,
+                                      scratch_pool);
+      err = svn_wc__text_modified_prepare(&check, &modified, wb->db,
+                                          child_abspath,
+                                          scratch_pool, iterpool);
+      if (err)
+        {
+          /* Let assemble_status() report it. */
+          svn_error_clear(err);
+          continue;
+        }
+
+      if (!check)
+        {
+          svn_boolean_t *value = apr_palloc(result_pool, sizeof(*value));
+          *value = modified;
+          svn_hash_sets(*text_mods, item->key, value);
+          continue;
+        }
+
+      task = apr_array_push(tasks);
+      task->name = item->key;
+      task->local_abspath = child_abspath;
+      task->check = check;
+    }
+  svn_pool_destroy(iterpool);
+
+  if (tasks->nelts == 0)
+    return SVN_NO_ERROR;
+
+  baton.db = wb->db;
+  baton.tasks = tasks;
+  baton.text_mods = *text_mods;
+  baton.result_pool = result_pool;
+
+  return svn_error_trace(svn_task__run(MIN(jobs, tasks->nelts),
+                                       tasks->nelts,
+                                       text_check_process, tasks,
+                                       text_check_output, &baton,
+                                       NULL, NULL,
+                                       cancel_func, cancel_baton,
+                                       scratch_pool));
+}
+
 /* Send svn_wc_status3_t * structures for the directory LOCAL_ABSPATH and
    for all its child nodes (according to DEPTH) through STATUS_FUNC /
    STATUS_BATON.
@@ -1231,6 +1476,7 @@ get_dir_status(const struct walk_status_baton *wb,
   const char *dir_repos_relpath;
   const char *dir_repos_uuid;
   apr_hash_t *dirents, *nodes, *conflicts, *all_children;
+  apr_hash_t *text_mods;
   apr_array_header_t *sorted_children;
   apr_array_header_t *collected_ignore_patterns = NULL;
   apr_pool_t *iterpool;
@@ -1319,6 +1565,7 @@ get_dir_status(const struct walk_status_baton *wb,
                                         parent_repos_relpath,
                                         parent_repos_uuid,
                                         dir_info, this_dirent, get_all,
+                                        NULL /* text_modified */,
                                         status_func, status_baton,
                                         iterpool));
         }
@@ -1328,6 +1575,7 @@ get_dir_status(const struct walk_status_baton *wb,
                                       parent_repos_relpath,
                                       parent_repos_uuid,
                                       dir_info, dirent, get_all,
+                                      NULL /* text_modified */,
                                       status_func, status_baton,
                                       iterpool));
     }
@@ -1340,6 +1588,12 @@ get_dir_status(const struct walk_status_baton *wb,
   sorted_children = svn_sort__hash(all_children,
                                    svn_sort_compare_items_lexically,
                                    scratch_pool);
+
+  /* Compare files concurrently before reporting them in order. */
+  SVN_ERR(check_text_mods(&text_mods, wb, local_abspath, sorted_children,
+                          nodes, dirents, cancel_func, cancel_baton,
+                          scratch_pool, iterpool));
+
   for (i = 0; i < sorted_children->nelts; i++)
     {
       const void *key;
@@ -1364,6 +1618,7 @@ get_dir_status(const struct walk_status_baton *wb,
                                local_abspath,
                                child_info,
                                child_dirent,
+                               apr_hash_get(text_mods, key, klen),
                                dir_repos_root_url,
                                dir_repos_relpath,
                                dir_repos_uuid,
@@ -1448,6 +1703,7 @@ get_child_status(const struct walk_status_baton *wb,
                            parent_abspath,
                            info,
                            dirent,
+                           NULL, /* text_modified */
                            dir_repos_root_url,
                            dir_repos_relpath,
                            dir_repos_uuid,
@@ -2900,6 +3156,7 @@ internal_status(svn_wc__internal_status_t **status,
                                          dirent,
                                          TRUE /* get_all */,
                                          FALSE, check_working_copy,
+                                         NULL /* text_modified */,
                                          NULL /* repos_lock */,
                                          result_pool, scratch_pool));
 }
@@ -49,6 +49,50 @@
 #include "private/svn_wc_private.h"
 
 
+svn_error_t *
+svn_wc__translated_stream_to_nf(svn_stream_t **stream,
+                                const char *local_abspath,
+                                svn_subst_eol_style_t style,
+                                const char *eol,
+                                apr_hash_t *keywords,
+                                svn_boolean_t special,
+                                svn_boolean_t repair_forced,
+                                apr_pool_t *result_pool,
+                                apr_pool_t *scratch_pool)
+{
+  if (special)
+    return svn_error_trace(svn_subst_read_specialfile(stream, local_abspath,
+                                                      result_pool,
+                                                      scratch_pool));
+
+  SVN_ERR(svn_stream_open_readonly(stream, local_abspath, result_pool,
+                                   scratch_pool));
+
+  if (svn_subst_translation_required(style, eol, keywords, special, TRUE))
+    {
+      if (style == svn_subst_eol_style_native)
+        eol = SVN_SUBST_NATIVE_EOL_STR;
+      else if (style == svn_subst_eol_style_fixed)
+        repair_forced = TRUE;
+      else if (style != svn_subst_eol_style_none)
+        return svn_error_create(SVN_ERR_IO_UNKNOWN_EOL, NULL, NULL);
+
+      /* Wrap the stream to translate to normal form */
+      *stream = svn_subst_stream_translated(*stream,
+                                            eol,
+                                            repair_forced,
+                                            keywords,
+                                            FALSE /* expand */,
+                                            result_pool);
+
+      /* streams enforce our contract that TO_NF streams are read-only
+       * by returning SVN_ERR_STREAM_NOT_SUPPORTED when trying to
+       * write to them. */
+    }
+
+  return SVN_NO_ERROR;
+}
+
 svn_error_t *
 svn_wc__internal_translated_stream(svn_stream_t **stream,
                                    svn_wc__db_t *db,
@@ -74,63 +118,38 @@ svn_wc__internal_translated_stream(svn_stream_t **stream,
                                      db, versioned_abspath, NULL, FALSE,
                                      scratch_pool, scratch_pool));
 
+  if (to_nf)
+    return svn_error_trace(svn_wc__translated_stream_to_nf(stream,
+                                                           local_abspath,
+                                                           style, eol,
+                                                           keywords, special,
+                                                           repair_forced,
+                                                           result_pool,
+                                                           scratch_pool));
+
   if (special)
-    {
-      if (to_nf)
-        return svn_subst_read_specialfile(stream, local_abspath, result_pool,
-                                          scratch_pool);
+    return svn_subst_create_specialfile(stream, local_abspath, result_pool,
+                                        scratch_pool);
 
-      return svn_subst_create_specialfile(stream, local_abspath, result_pool,
-                                          scratch_pool);
-    }
+  {
+    apr_file_t *file;
 
-  if (to_nf)
-    SVN_ERR(svn_stream_open_readonly(stream, local_abspath, result_pool,
-                                     scratch_pool));
-  else
-    {
-      apr_file_t *file;
-
-      /* We don't want the "open-exclusively" feature of the normal
-         svn_stream_open_writable interface. Do this manually. */
-      SVN_ERR(svn_io_file_open(&file, local_abspath,
-                               APR_CREATE | APR_WRITE | APR_BUFFERED,
-                               APR_OS_DEFAULT, result_pool));
-      *stream = svn_stream_from_aprfile2(file, FALSE, result_pool);
-    }
+    /* We don't want the "open-exclusively" feature of the normal
+       svn_stream_open_writable interface. Do this manually. */
+    SVN_ERR(svn_io_file_open(&file, local_abspath,
+                             APR_CREATE | APR_WRITE | APR_BUFFERED,
+                             APR_OS_DEFAULT, result_pool));
+    *stream = svn_stream_from_aprfile2(file, FALSE, result_pool);
+  }
 
   if (svn_subst_translation_required(style, eol, keywords, special, TRUE))
     {
-      if (to_nf)
-        {
-          if (style == svn_subst_eol_style_native)
-            eol = SVN_SUBST_NATIVE_EOL_STR;
-          else if (style == svn_subst_eol_style_fixed)
-            repair_forced = TRUE;
-          else if (style != svn_subst_eol_style_none)
-            return svn_error_create(SVN_ERR_IO_UNKNOWN_EOL, NULL, NULL);
-
-          /* Wrap the stream to translate to normal form */
-          *stream = svn_subst_stream_translated(*stream,
-                                                eol,
-                                                repair_forced,
-                                                keywords,
-                                                FALSE /* expand */,
-                                                result_pool);
-
-          /* streams enforce our contract that TO_NF streams are read-only
-           * by returning SVN_ERR_STREAM_NOT_SUPPORTED when trying to
-           * write to them. */
-        }
-      else
-        {
-          *stream = svn_subst_stream_translated(*stream, eol, TRUE,
-                                                keywords, TRUE, result_pool);
+      *stream = svn_subst_stream_translated(*stream, eol, TRUE,
+                                            keywords, TRUE, result_pool);
 
-          /* streams enforce our contract that FROM_NF streams are write-only
-           * by returning SVN_ERR_STREAM_NOT_SUPPORTED when trying to
-           * read them. */
-        }
+      /* streams enforce our contract that FROM_NF streams are write-only
+       * by returning SVN_ERR_STREAM_NOT_SUPPORTED when trying to
+       * read them. */
     }
 
   return SVN_NO_ERROR;
@@ -883,6 +883,9 @@ SELECT id, work FROM work_queue ORDER BY id LIMIT 1
 -- STMT_DELETE_WORK_ITEM
 DELETE FROM work_queue WHERE id = ?1
 
+-- STMT_SELECT_WORK_ITEMS
+SELECT id, work FROM work_queue ORDER BY id LIMIT ?1
+
 -- STMT_INSERT_OR_IGNORE_PRISTINE
 INSERT OR IGNORE INTO pristine (checksum, md5_checksum, size, refcount)
 VALUES (?1, ?2, ?3, 0)
@@ -350,6 +350,59 @@ svn_wc__internal_file_modified_p(svn_boolean_t *modified_p,
                                  svn_boolean_t exact_comparison,
                                  apr_pool_t *scratch_pool);
 
+/* If we own a write lock on LOCAL_ABSPATH in DB, record DIRENT's size and
+ * timestamp as the last-known-unmodified state of the file.  Call this
+ * after a full text comparison found LOCAL_ABSPATH to be unmodified.
+ * See svn_wc__internal_file_modified_p() for the "timestamp repair".
+ */
+svn_error_t *
+svn_wc__repair_timestamps(svn_wc__db_t *db,
+                          const char *local_abspath,
+                          const svn_io_dirent2_t *dirent,
+                          apr_pool_t *scratch_pool);
+
+/* The part of a text modification check that does not need access to
+ * the working copy database.  See svn_wc__text_modified_prepare().  */
+typedef struct svn_wc__text_check_t svn_wc__text_check_t;
+
+/* Split svn_wc__internal_file_modified_p() with EXACT_COMPARISON set to
+ * FALSE into a preparation step accessing DB and a comparison step that
+ * does not, so the latter may run in another thread.
+ *
+ * Look up everything needed to compare LOCAL_ABSPATH with its pristine
+ * text in DB.  If no comparison is possible, set *CHECK to NULL and
+ * *MODIFIED_P to TRUE.  Otherwise, set *CHECK to the object to pass to
+ * svn_wc__text_modified_check(), allocated in RESULT_POOL.
+ *
+ * Use SCRATCH_POOL for temporary allocations.
+ */
+svn_error_t *
+svn_wc__text_modified_prepare(svn_wc__text_check_t **check,
+                              svn_boolean_t *modified_p,
+                              svn_wc__db_t *db,
+                              const char *local_abspath,
+                              apr_pool_t *result_pool,
+                              apr_pool_t *scratch_pool);
+
+/* Complete the text modification check CHECK returned by
+ * svn_wc__text_modified_prepare() and set *MODIFIED_P accordingly.
+ *
+ * If the file had to be compared with its pristine text and was found to
+ * be unmodified, set *COMPARED_DIRENT to the file's dirent, allocated in
+ * RESULT_POOL, such that the caller may pass it to
+ * svn_wc__repair_timestamps().  Otherwise, set it to NULL.
+ *
+ * This does not access the working copy database and may be called
+ * concurrently for different CHECKs.  Use SCRATCH_POOL for temporary
+ * allocations.
+ */
+svn_error_t *
+svn_wc__text_modified_check(svn_boolean_t *modified_p,
+                            const svn_io_dirent2_t **compared_dirent,
+                            const svn_wc__text_check_t *check,
+                            apr_pool_t *result_pool,
+                            apr_pool_t *scratch_pool);
+
 
 /* Prepare to merge a file content change into the working copy.
 
@@ -13596,6 +13596,89 @@ svn_wc__db_wq_record_and_fetch_next(apr_uint64_t *id,
   return SVN_NO_ERROR;
 }
 
+/* The body of svn_wc__db_wq_complete_and_fetch().
+ */
+static svn_error_t *
+wq_complete_and_fetch(apr_array_header_t **work_items,
+                      svn_wc__db_wcroot_t *wcroot,
+                      const apr_array_header_t *completed_ids,
+                      apr_hash_t *record_map,
+                      int max_items,
+                      apr_pool_t *result_pool,
+                      apr_pool_t *scratch_pool)
+{
+  svn_sqlite__stmt_t *stmt;
+  svn_boolean_t have_row;
+  int i;
+
+  for (i = 0; i < completed_ids->nelts; i++)
+    {
+      SVN_ERR(svn_sqlite__get_statement(&stmt, wcroot->sdb,
+                                        STMT_DELETE_WORK_ITEM));
+      SVN_ERR(svn_sqlite__bind_int64(stmt, 1,
+                                     APR_ARRAY_IDX(completed_ids, i,
+                                                   apr_uint64_t)));
+      SVN_ERR(svn_sqlite__step_done(stmt));
+    }
+
+  if (record_map)
+    SVN_ERR(wq_record(wcroot, record_map, scratch_pool));
+
+  if (max_items == 0)
+    return SVN_NO_ERROR;
+
+  *work_items = apr_array_make(result_pool, max_items,
+                               sizeof(svn_wc__db_wq_item_t));
+
+  SVN_ERR(svn_sqlite__get_statement(&stmt, wcroot->sdb,
+                                    STMT_SELECT_WORK_ITEMS));
+  SVN_ERR(svn_sqlite__bind_int(stmt, 1, max_items));
+  SVN_ERR(svn_sqlite__step(&have_row, stmt));
+
+  while (have_row)
+    {
+      svn_wc__db_wq_item_t *item = apr_array_push(*work_items);
+      apr_size_t len;
+      const void *val;
+
+      item->id = svn_sqlite__column_int64(stmt, 0);
+      val = svn_sqlite__column_blob(stmt, 1, &len, result_pool);
+      item->work_item = svn_skel__parse(val, len, result_pool);
+
+      SVN_ERR(svn_sqlite__step(&have_row, stmt));
+    }
+
+  return svn_error_trace(svn_sqlite__reset(stmt));
+}
+
+svn_error_t *
+svn_wc__db_wq_complete_and_fetch(apr_array_header_t **work_items,
+                                 svn_wc__db_t *db,
+                                 const char *wri_abspath,
+                                 const apr_array_header_t *completed_ids,
+                                 apr_hash_t *record_map,
+                                 int max_items,
+                                 apr_pool_t *result_pool,
+                                 apr_pool_t *scratch_pool)
+{
+  svn_wc__db_wcroot_t *wcroot;
+  const char *local_relpath;
+
+  SVN_ERR_ASSERT(work_items != NULL || max_items == 0);
+  SVN_ERR_ASSERT(svn_dirent_is_absolute(wri_abspath));
+
+  SVN_ERR(svn_wc__db_wcroot_parse_local_abspath(&wcroot, &local_relpath, db,
+                              wri_abspath, scratch_pool, scratch_pool));
+  VERIFY_USABLE_WCROOT(wcroot);
+
+  SVN_WC__DB_WITH_TXN(
+    wq_complete_and_fetch(work_items, wcroot, completed_ids, record_map,
+                          max_items, result_pool, scratch_pool),
+    wcroot);
+
+  return SVN_NO_ERROR;
+}
+
 
 
 /* ### temporary API. remove before release.  */
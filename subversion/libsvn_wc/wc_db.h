@@ -264,6 +264,17 @@ svn_wc__db_open(svn_wc__db_t **db,
                 apr_pool_t *scratch_pool);
 
 
+/* Upper limit for the "jobs" option in the working-copy config section. */
+#define SVN_WC__DB_MAX_JOBS 64
+
+/* Return the number of threads that operations on DB may use to access
+   files on disk concurrently, as configured by the "jobs" option in the
+   working-copy section of the config passed to svn_wc__db_open().  The
+   result is always at least 1. */
+int
+svn_wc__db_get_jobs(svn_wc__db_t *db);
+
+
 /* Close DB.  */
 svn_error_t *
 svn_wc__db_close(svn_wc__db_t *db);
@@ -945,6 +956,18 @@ svn_wc__db_pristine_read(svn_stream_t **contents,
                          apr_pool_t *result_pool,
                          apr_pool_t *scratch_pool);
 
+/* If DB has been configured with a shared pristine store that contains
+   the text with SHA1_CHECKSUM, set *CONTENTS to a readable stream of that
+   text, allocated in RESULT_POOL.  Otherwise, set *CONTENTS to NULL.
+
+   Use SCRATCH_POOL for temporary allocations. */
+svn_error_t *
+svn_wc__db_pristine_read_shared(svn_stream_t **contents,
+                                svn_wc__db_t *db,
+                                const svn_checksum_t *sha1_checksum,
+                                apr_pool_t *result_pool,
+                                apr_pool_t *scratch_pool);
+
 /* Baton for svn_wc__db_pristine_install */
 typedef struct svn_wc__db_install_data_t
                svn_wc__db_install_data_t;
@@ -970,9 +993,38 @@ svn_wc__db_pristine_prepare_install(svn_stream_t **stream,
                                     apr_pool_t *result_pool,
                                     apr_pool_t *scratch_pool);
 
+/* Like svn_wc__db_pristine_prepare_install(), but leave the creation of
+   the install stream to the caller.  Set *TEMP_DIR_ABSPATH to the
+   directory in which the caller must create it, using
+   svn_stream__create_for_install(), before handing it over with
+   svn_wc__db_pristine_install_set_stream().
+
+   Creating the stream does not access the database and may therefore
+   happen in a different thread.
+
+   Allocate *INSTALL_DATA and *TEMP_DIR_ABSPATH in RESULT_POOL. */
+svn_error_t *
+svn_wc__db_pristine_prepare_install_deferred(
+  svn_wc__db_install_data_t **install_data,
+  const char **temp_dir_abspath,
+  svn_wc__db_t *db,
+  const char *wri_abspath,
+  apr_pool_t *result_pool,
+  apr_pool_t *scratch_pool);
+
+/* Set the install stream of INSTALL_DATA, as returned by
+   svn_wc__db_pristine_prepare_install_deferred(), to INSTALL_STREAM. */
+void
+svn_wc__db_pristine_install_set_stream(svn_wc__db_install_data_t *install_data,
+                                       svn_stream_t *install_stream);
+
 /* Install the file created via svn_wc__db_pristine_prepare_install() into
    the pristine data store, to be identified by the SHA-1 checksum of its
-   contents, SHA1_CHECKSUM, and whose MD-5 checksum is MD5_CHECKSUM. */
+   contents, SHA1_CHECKSUM, and whose MD-5 checksum is MD5_CHECKSUM.
+
+   If a shared pristine store has been configured for the DB, the file in
+   the working copy will be a hard link to the text in the shared store,
+   where possible. */
 svn_error_t *
 svn_wc__db_pristine_install(svn_wc__db_install_data_t *install_data,
                             const svn_checksum_t *sha1_checksum,
@@ -1040,7 +1092,9 @@ svn_wc__db_pristine_remove(svn_wc__db_t *db,
                            apr_pool_t *scratch_pool);
 
 
-/* Remove all unreferenced pristines in the WC of WRI_ABSPATH in DB. */
+/* Remove all unreferenced pristines in the WC of WRI_ABSPATH in DB.
+   Also remove the texts from the shared pristine store of DB, if any,
+   that no working copy uses anymore. */
 svn_error_t *
 svn_wc__db_pristine_cleanup(svn_wc__db_t *db,
                             const char *wri_abspath,
@@ -3028,6 +3082,39 @@ svn_wc__db_wq_record_and_fetch_next(apr_uint64_t *id,
                                     apr_pool_t *result_pool,
                                     apr_pool_t *scratch_pool);
 
+/* A work queue item as returned by svn_wc__db_wq_complete_and_fetch(). */
+typedef struct svn_wc__db_wq_item_t
+{
+  /* The identifier of the item in the work queue. */
+  apr_uint64_t id;
+
+  /* The work to do. */
+  svn_skel_t *work_item;
+} svn_wc__db_wq_item_t;
+
+/* Batched variant of svn_wc__db_wq_record_and_fetch_next().
+
+   In the WCROOT associated with DB and WRI_ABSPATH, mark all work items
+   whose apr_uint64_t identifiers are in COMPLETED_IDS as completed and
+   record the timestamps and sizes in RECORD_MAP, if not NULL.  Then set
+   *WORK_ITEMS to an array of up to MAX_ITEMS svn_wc__db_wq_item_t for
+   the next work items to complete, in the order they were queued.  All
+   of that happens in a single transaction.
+
+   If MAX_ITEMS is 0, WORK_ITEMS may be NULL and nothing is fetched.
+
+   RESULT_POOL will be used to allocate *WORK_ITEMS, and SCRATCH_POOL
+   will be used for all temporary allocations.  */
+svn_error_t *
+svn_wc__db_wq_complete_and_fetch(apr_array_header_t **work_items,
+                                 svn_wc__db_t *db,
+                                 const char *wri_abspath,
+                                 const apr_array_header_t *completed_ids,
+                                 apr_hash_t *record_map,
+                                 int max_items,
+                                 apr_pool_t *result_pool,
+                                 apr_pool_t *scratch_pool);
+
 
 /* @} */
 
@@ -25,6 +25,10 @@
 
 #define SVN_WC__I_AM_WC_DB
 
+#include <string.h>
+
+#include <apr_user.h>
+
 #include "svn_pools.h"
 #include "svn_io.h"
 #include "svn_dirent_uri.h"
@@ -42,6 +46,43 @@
 
 
 
+/* Returns in PRISTINE_ABSPATH a new string allocated from RESULT_POOL,
+   holding the absolute path to the file location that is dedicated to
+   hold CHECKSUM's pristine file within the pristine store directory
+   BASE_DIR_ABSPATH.  The returned path does not necessarily currently
+   exist.
+
+   Any other allocations are made in SCRATCH_POOL. */
+static svn_error_t *
+get_pristine_fname_in(const char **pristine_abspath,
+                      const char *base_dir_abspath,
+                      const svn_checksum_t *sha1_checksum,
+                      apr_pool_t *result_pool,
+                      apr_pool_t *scratch_pool)
+{
+  const char *hexdigest = svn_checksum_to_cstring(sha1_checksum, scratch_pool);
+  char subdir[3];
+
+  /* We should have a valid checksum and (thus) a valid digest. */
+  SVN_ERR_ASSERT(hexdigest != NULL);
+
+  /* Get the first two characters of the digest, for the subdir. */
+  subdir[0] = hexdigest[0];
+  subdir[1] = hexdigest[1];
+  subdir[2] = '\0';
+
+  hexdigest = apr_pstrcat(scratch_pool, hexdigest, PRISTINE_STORAGE_EXT,
+                          SVN_VA_NULL);
+
+  /* The file is located at DIR/XX/XXYYZZ...svn-base */
+  *pristine_abspath = svn_dirent_join_many(result_pool,
+                                           base_dir_abspath,
+                                           subdir,
+                                           hexdigest,
+                                           SVN_VA_NULL);
+  return SVN_NO_ERROR;
+}
+
 /* Returns in PRISTINE_ABSPATH a new string allocated from RESULT_POOL,
    holding the local absolute path to the file location that is dedicated
    to hold CHECKSUM's pristine file, relating to the pristine store
@@ -57,8 +98,6 @@ get_pristine_fname(const char **pristine_abspath,
                    apr_pool_t *scratch_pool)
 {
   const char *base_dir_abspath;
-  const char *hexdigest = svn_checksum_to_cstring(sha1_checksum, scratch_pool);
-  char subdir[3];
 
   /* ### code is in transition. make sure we have the proper data.  */
   SVN_ERR_ASSERT(pristine_abspath != NULL);
@@ -72,24 +111,11 @@ get_pristine_fname(const char **pristine_abspath,
                                           PRISTINE_STORAGE_RELPATH,
                                           SVN_VA_NULL);
 
-  /* We should have a valid checksum and (thus) a valid digest. */
-  SVN_ERR_ASSERT(hexdigest != NULL);
-
-  /* Get the first two characters of the digest, for the subdir. */
-  subdir[0] = hexdigest[0];
-  subdir[1] = hexdigest[1];
-  subdir[2] = '\0';
-
-  hexdigest = apr_pstrcat(scratch_pool, hexdigest, PRISTINE_STORAGE_EXT,
-                          SVN_VA_NULL);
-
   /* The file is located at DIR/.svn/pristine/XX/XXYYZZ...svn-base */
-  *pristine_abspath = svn_dirent_join_many(result_pool,
-                                           base_dir_abspath,
-                                           subdir,
-                                           hexdigest,
-                                           SVN_VA_NULL);
-  return SVN_NO_ERROR;
+  return svn_error_trace(get_pristine_fname_in(pristine_abspath,
+                                               base_dir_abspath,
+                                               sha1_checksum,
+                                               result_pool, scratch_pool));
 }
 
 
@@ -268,6 +294,215 @@ pristine_get_tempdir(svn_wc__db_wcroot_t *wcroot,
                               PRISTINE_TEMPDIR_RELPATH, SVN_VA_NULL);
 }
 
+/* Permissions of the directories that we create in the shared pristine
+   store.  Nobody else may add texts. */
+#define SHARED_PRISTINE_DIR_PERMS \
+  (APR_UREAD | APR_UWRITE | APR_UEXECUTE | APR_GREAD | APR_GEXECUTE \
+   | APR_WREAD | APR_WEXECUTE)
+
+/* Set *SAFE to TRUE if the node at ABSPATH in the shared pristine store
+ * belongs to the current user and cannot be modified by anybody else.
+ * Otherwise, e.g. if it does not exist, set *SAFE to FALSE.  If
+ * CREATE_DIR is set and ABSPATH does not exist, create it as a directory
+ * with SHARED_PRISTINE_DIR_PERMS first.
+ *
+ * Texts that others can write to or replace must not be linked into our
+ * pristine store.  Where file ownership is not supported, this can't be
+ * checked and we rely on the SHA-1 checks alone.
+ *
+ * Use SCRATCH_POOL for temporary allocations.
+ */
+static svn_error_t *
+check_shared_node(svn_boolean_t *safe,
+                  const char *abspath,
+                  svn_boolean_t create_dir,
+                  apr_pool_t *scratch_pool)
+{
+  apr_finfo_t finfo;
+  svn_error_t *err;
+
+  *safe = FALSE;
+  err = svn_io_stat(&finfo, abspath, APR_FINFO_PROT | APR_FINFO_OWNER,
+                    scratch_pool);
+  if (err && APR_STATUS_IS_ENOENT(err->apr_err) && create_dir)
+    {
+      svn_error_clear(err);
+      err = svn_io_dir_make(abspath, SHARED_PRISTINE_DIR_PERMS,
+                            scratch_pool);
+      if (err && APR_STATUS_IS_ENOENT(err->apr_err))
+        {
+          svn_error_clear(err);
+          err = svn_io_make_dir_recursively(svn_dirent_dirname(abspath,
+                                                               scratch_pool),
+                                            scratch_pool);
+          if (!err)
+            err = svn_io_dir_make(abspath, SHARED_PRISTINE_DIR_PERMS,
+                                  scratch_pool);
+        }
+
+      /* Another process may have created it concurrently. */
+      if (err && APR_STATUS_IS_EEXIST(err->apr_err))
+        {
+          svn_error_clear(err);
+          err = SVN_NO_ERROR;
+        }
+      if (!err)
+        err = svn_io_stat(&finfo, abspath, APR_FINFO_PROT | APR_FINFO_OWNER,
+                          scratch_pool);
+    }
+
+  if (err && APR_STATUS_IS_ENOENT(err->apr_err))
+    {
+      svn_error_clear(err);
+      return SVN_NO_ERROR;
+    }
+  SVN_ERR(err);
+
+#if defined(APR_HAS_USER) && !defined(WIN32) && !defined(__OS2__)
+  {
+    apr_uid_t uid;
+    apr_gid_t gid;
+    apr_status_t status = apr_uid_current(&uid, &gid, scratch_pool);
+
+    if (status)
+      return svn_error_wrap_apr(status, _("Error getting UID of process"));
+
+    *safe = apr_uid_compare(uid, finfo.user) == APR_SUCCESS
+         && !(finfo.protection & (APR_GWRITE | APR_WWRITE));
+  }
+#else
+  *safe = TRUE;
+#endif
+
+  return SVN_NO_ERROR;
+}
+
+/* Set *MATCHES to TRUE if the file at ABSPATH has the SHA1_CHECKSUM.
+ * Use SCRATCH_POOL for temporary allocations.
+ */
+static svn_error_t *
+check_shared_text(svn_boolean_t *matches,
+                  const char *abspath,
+                  const svn_checksum_t *sha1_checksum,
+                  apr_pool_t *scratch_pool)
+{
+  svn_checksum_t *actual_checksum;
+
+  SVN_ERR(svn_io_file_checksum2(&actual_checksum, abspath,
+                                svn_checksum_sha1, scratch_pool));
+  *matches = svn_checksum_match(actual_checksum, sha1_checksum);
+
+  return SVN_NO_ERROR;
+}
+
+/* Install the pristine text in INSTALL_STREAM with SHA1_CHECKSUM at
+ * PRISTINE_ABSPATH, sharing it with the pristine store at
+ * SHARED_STORE_ABSPATH.
+ *
+ * If the shared store already has the text, hard link PRISTINE_ABSPATH to
+ * it.  Otherwise, install a private copy and add that to the shared store.
+ * Thus, the link count of a file in the shared store is the number of
+ * working copies that use it, plus one.  All texts in the store are
+ * read-only.
+ *
+ * The shared store is only an optimization: if hard links are not
+ * possible, e.g. because the store is on a different device, or the store
+ * is writable by other users, just keep private copies.  A text that does
+ * not match its SHA-1 gets replaced in the store.
+ */
+static svn_error_t *
+install_shared_pristine(svn_stream_t *install_stream,
+                        const char *pristine_abspath,
+                        const char *shared_store_abspath,
+                        const svn_checksum_t *sha1_checksum,
+                        apr_pool_t *scratch_pool)
+{
+  const char *shared_abspath;
+  svn_boolean_t safe;
+  svn_boolean_t shared = FALSE;
+  svn_error_t *err;
+
+  SVN_ERR(get_pristine_fname_in(&shared_abspath, shared_store_abspath,
+                                sha1_checksum, scratch_pool, scratch_pool));
+
+  SVN_ERR(check_shared_node(&safe, shared_store_abspath, TRUE,
+                            scratch_pool));
+  if (safe)
+    SVN_ERR(check_shared_node(&safe, svn_dirent_dirname(shared_abspath,
+                                                        scratch_pool),
+                              TRUE, scratch_pool));
+  if (!safe)
+    return svn_error_trace(svn_stream__install_stream(install_stream,
+                                                      pristine_abspath,
+                                                      TRUE, scratch_pool));
+
+  SVN_ERR(check_shared_node(&shared, shared_abspath, FALSE, scratch_pool));
+  if (shared)
+    {
+      svn_boolean_t matches;
+
+      /* A stale orphan would block the link. */
+      SVN_ERR(svn_io_remove_file2(pristine_abspath, TRUE, scratch_pool));
+      SVN_ERR(svn_io_make_dir_recursively(svn_dirent_dirname(pristine_abspath,
+                                                             scratch_pool),
+                                          scratch_pool));
+
+      err = svn_io__file_link(shared_abspath, pristine_abspath, scratch_pool);
+      if (!err)
+        {
+          /* Verify what we actually linked, not what's in the store now. */
+          SVN_ERR(check_shared_text(&matches, pristine_abspath,
+                                    sha1_checksum, scratch_pool));
+          if (matches)
+            return svn_error_trace(
+                     svn_stream__install_delete(install_stream,
+                                                scratch_pool));
+
+          /* Corrupted.  Drop it from the store and add our copy instead. */
+          SVN_ERR(svn_io_remove_file2(pristine_abspath, FALSE,
+                                      scratch_pool));
+          SVN_ERR(svn_io_remove_file2(shared_abspath, TRUE, scratch_pool));
+          shared = FALSE;
+        }
+      else if (APR_STATUS_IS_ENOENT(err->apr_err))
+        {
+          /* Removed from the store by a concurrent cleanup. */
+          svn_error_clear(err);
+          shared = FALSE;
+        }
+      else
+        {
+          /* Not linkable. */
+          svn_error_clear(err);
+        }
+    }
+
+  SVN_ERR(svn_stream__install_stream(install_stream, pristine_abspath,
+                                     TRUE, scratch_pool));
+  SVN_ERR(svn_io_set_file_read_only(pristine_abspath, FALSE, scratch_pool));
+
+  if (!shared)
+    {
+      err = svn_io__file_link(pristine_abspath, shared_abspath,
+                              scratch_pool);
+
+      /* Still offer a copy to other working copies, so they don't have to
+         fetch the text again. */
+      if (err && !APR_STATUS_IS_EEXIST(err->apr_err))
+        {
+          svn_error_clear(err);
+          err = svn_io_copy_file(pristine_abspath, shared_abspath, TRUE,
+                                 scratch_pool);
+          if (!err)
+            err = svn_io_set_file_read_only(shared_abspath, FALSE,
+                                            scratch_pool);
+        }
+      svn_error_clear(err);
+    }
+
+  return SVN_NO_ERROR;
+}
+
 /* Install the pristine text described by BATON into the pristine store of
  * SDB.  If it is already stored then just delete the new file
  * BATON->tempfile_abspath.
@@ -287,6 +522,8 @@ pristine_install_txn(svn_sqlite__db_t *sdb,
                      const svn_checksum_t *sha1_checksum,
                      /* The pristine text's MD-5 checksum. */
                      const svn_checksum_t *md5_checksum,
+                     /* The shared pristine store or NULL. */
+                     const char *shared_store_abspath,
                      apr_pool_t *scratch_pool)
 {
   svn_sqlite__stmt_t *stmt;
@@ -335,8 +572,13 @@ pristine_install_txn(svn_sqlite__db_t *sdb,
     apr_finfo_t finfo;
     SVN_ERR(svn_stream__install_get_info(&finfo, install_stream,
                                          APR_FINFO_SIZE, scratch_pool));
-    SVN_ERR(svn_stream__install_stream(install_stream, pristine_abspath,
-                                       TRUE, scratch_pool));
+    if (shared_store_abspath)
+      SVN_ERR(install_shared_pristine(install_stream, pristine_abspath,
+                                      shared_store_abspath, sha1_checksum,
+                                      scratch_pool));
+    else
+      SVN_ERR(svn_stream__install_stream(install_stream, pristine_abspath,
+                                         TRUE, scratch_pool));
 
     SVN_ERR(svn_sqlite__get_statement(&stmt, sdb, STMT_INSERT_PRISTINE));
     SVN_ERR(svn_sqlite__bind_checksum(stmt, 1, sha1_checksum, scratch_pool));
@@ -354,6 +596,7 @@ struct svn_wc__db_install_data_t
 {
   svn_wc__db_wcroot_t *wcroot;
   svn_stream_t *inner_stream;
+  const char *shared_store_abspath;
 };
 
 svn_error_t *
@@ -380,6 +623,7 @@ svn_wc__db_pristine_prepare_install(svn_stream_t **stream,
 
   *install_data = apr_pcalloc(result_pool, sizeof(**install_data));
   (*install_data)->wcroot = wcroot;
+  (*install_data)->shared_store_abspath = db->shared_pristine_abspath;
 
   SVN_ERR_W(svn_stream__create_for_install(stream,
                                            temp_dir_abspath,
@@ -398,6 +642,41 @@ svn_wc__db_pristine_prepare_install(svn_stream_t **stream,
   return SVN_NO_ERROR;
 }
 
+svn_error_t *
+svn_wc__db_pristine_prepare_install_deferred(
+  svn_wc__db_install_data_t **install_data,
+  const char **temp_dir_abspath,
+  svn_wc__db_t *db,
+  const char *wri_abspath,
+  apr_pool_t *result_pool,
+  apr_pool_t *scratch_pool)
+{
+  svn_wc__db_wcroot_t *wcroot;
+  const char *local_relpath;
+
+  SVN_ERR_ASSERT(svn_dirent_is_absolute(wri_abspath));
+
+  SVN_ERR(svn_wc__db_wcroot_parse_local_abspath(&wcroot, &local_relpath, db,
+                              wri_abspath, scratch_pool, scratch_pool));
+  VERIFY_USABLE_WCROOT(wcroot);
+
+  *temp_dir_abspath = pristine_get_tempdir(wcroot, result_pool,
+                                           scratch_pool);
+
+  *install_data = apr_pcalloc(result_pool, sizeof(**install_data));
+  (*install_data)->wcroot = wcroot;
+  (*install_data)->shared_store_abspath = db->shared_pristine_abspath;
+
+  return SVN_NO_ERROR;
+}
+
+void
+svn_wc__db_pristine_install_set_stream(svn_wc__db_install_data_t *install_data,
+                                       svn_stream_t *install_stream)
+{
+  install_data->inner_stream = install_stream;
+}
+
 svn_error_t *
 svn_wc__db_pristine_install(svn_wc__db_install_data_t *install_data,
                             const svn_checksum_t *sha1_checksum,
@@ -422,6 +701,7 @@ svn_wc__db_pristine_install(svn_wc__db_install_data_t *install_data,
     pristine_install_txn(wcroot->sdb,
                          install_data->inner_stream, pristine_abspath,
                          sha1_checksum, md5_checksum,
+                         install_data->shared_store_abspath,
                          scratch_pool),
     wcroot->sdb);
 
@@ -863,6 +1143,97 @@ pristine_cleanup_wcroot(svn_wc__db_wcroot_t *wcroot,
       svn_error_compose_create(err, svn_sqlite__reset(stmt)));
 }
 
+/* The minimum time since the last link count change of an unused text in
+   the shared pristine store before shared_pristine_cleanup() removes it.
+   This protects texts that another working copy just added. */
+#define SHARED_PRISTINE_MIN_AGE apr_time_from_sec(60 * 60)
+
+/* Remove all texts from the shared pristine store at STORE_ABSPATH that
+   are not linked into any working copy anymore.
+
+   Use SCRATCH_POOL for temporary allocations. */
+static svn_error_t *
+shared_pristine_cleanup(const char *store_abspath,
+                        apr_pool_t *scratch_pool)
+{
+  apr_time_t threshold = apr_time_now() - SHARED_PRISTINE_MIN_AGE;
+  apr_hash_t *subdirs;
+  apr_hash_index_t *hi;
+  apr_pool_t *iterpool;
+  apr_pool_t *fileiterpool;
+  svn_boolean_t safe;
+  svn_error_t *err;
+
+  /* Leave stores alone that we don't use. */
+  SVN_ERR(check_shared_node(&safe, store_abspath, FALSE, scratch_pool));
+  if (!safe)
+    return SVN_NO_ERROR;
+
+  err = svn_io_get_dirents3(&subdirs, store_abspath, TRUE,
+                            scratch_pool, scratch_pool);
+  if (err && APR_STATUS_IS_ENOENT(err->apr_err))
+    {
+      svn_error_clear(err);
+      return SVN_NO_ERROR;
+    }
+  SVN_ERR(err);
+
+  iterpool = svn_pool_create(scratch_pool);
+  fileiterpool = svn_pool_create(scratch_pool);
+  for (hi = apr_hash_first(scratch_pool, subdirs); hi; hi = apr_hash_next(hi))
+    {
+      const char *name = apr_hash_this_key(hi);
+      const svn_io_dirent2_t *dirent = apr_hash_this_val(hi);
+      const char *subdir_abspath;
+      apr_hash_t *files;
+      apr_hash_index_t *hi2;
+
+      if (dirent->kind != svn_node_dir)
+        continue;
+
+      svn_pool_clear(iterpool);
+
+      subdir_abspath = svn_dirent_join(store_abspath, name, iterpool);
+      SVN_ERR(svn_io_get_dirents3(&files, subdir_abspath, TRUE,
+                                  iterpool, iterpool));
+
+      for (hi2 = apr_hash_first(iterpool, files); hi2;
+           hi2 = apr_hash_next(hi2))
+        {
+          const char *file_abspath;
+          apr_size_t len;
+          apr_finfo_t finfo;
+
+          name = apr_hash_this_key(hi2);
+          dirent = apr_hash_this_val(hi2);
+          len = strlen(name);
+
+          /* Skip temporary files of concurrent copies. */
+          if (dirent->kind != svn_node_file
+              || len < sizeof(PRISTINE_STORAGE_EXT)
+              || strcmp(name + len - sizeof(PRISTINE_STORAGE_EXT) + 1,
+                        PRISTINE_STORAGE_EXT) != 0)
+            continue;
+
+          svn_pool_clear(fileiterpool);
+
+          file_abspath = svn_dirent_join(subdir_abspath, name, fileiterpool);
+          err = svn_io_stat(&finfo, file_abspath,
+                            APR_FINFO_NLINK | APR_FINFO_CTIME, fileiterpool);
+          if (!err && finfo.nlink == 1 && finfo.ctime < threshold)
+            err = svn_io_remove_file2(file_abspath, TRUE, fileiterpool);
+
+          /* Other processes may be using the store concurrently. */
+          svn_error_clear(err);
+        }
+    }
+
+  svn_pool_destroy(fileiterpool);
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
+
 svn_error_t *
 svn_wc__db_pristine_cleanup(svn_wc__db_t *db,
                             const char *wri_abspath,
@@ -879,9 +1250,75 @@ svn_wc__db_pristine_cleanup(svn_wc__db_t *db,
 
   SVN_ERR(pristine_cleanup_wcroot(wcroot, scratch_pool));
 
+  if (db->shared_pristine_abspath)
+    SVN_ERR(shared_pristine_cleanup(db->shared_pristine_abspath,
+                                    scratch_pool));
+
   return SVN_NO_ERROR;
 }
 
+svn_error_t *
+svn_wc__db_pristine_read_shared(svn_stream_t **contents,
+                                svn_wc__db_t *db,
+                                const svn_checksum_t *sha1_checksum,
+                                apr_pool_t *result_pool,
+                                apr_pool_t *scratch_pool)
+{
+  const char *shared_abspath;
+  svn_boolean_t safe;
+  svn_boolean_t matches;
+  svn_error_t *err;
+
+  *contents = NULL;
+  if (!db->shared_pristine_abspath
+      || sha1_checksum->kind != svn_checksum_sha1)
+    return SVN_NO_ERROR;
+
+  SVN_ERR(get_pristine_fname_in(&shared_abspath, db->shared_pristine_abspath,
+                                sha1_checksum, scratch_pool, scratch_pool));
+
+  /* Only serve texts that nobody else could have tampered with. */
+  SVN_ERR(check_shared_node(&safe, db->shared_pristine_abspath, FALSE,
+                            scratch_pool));
+  if (safe)
+    SVN_ERR(check_shared_node(&safe, svn_dirent_dirname(shared_abspath,
+                                                        scratch_pool),
+                              FALSE, scratch_pool));
+  if (safe)
+    SVN_ERR(check_shared_node(&safe, shared_abspath, FALSE, scratch_pool));
+  if (!safe)
+    return SVN_NO_ERROR;
+
+  err = check_shared_text(&matches, shared_abspath, sha1_checksum,
+                          scratch_pool);
+  if (err && APR_STATUS_IS_ENOENT(err->apr_err))
+    {
+      /* Removed by a concurrent cleanup. */
+      svn_error_clear(err);
+      return SVN_NO_ERROR;
+    }
+  SVN_ERR(err);
+
+  if (!matches)
+    {
+      /* Corrupted.  Let the next install replace it. */
+      svn_error_clear(svn_io_remove_file2(shared_abspath, TRUE,
+                                          scratch_pool));
+      return SVN_NO_ERROR;
+    }
+
+  err = svn_stream_open_readonly(contents, shared_abspath, result_pool,
+                                 scratch_pool);
+  if (err && APR_STATUS_IS_ENOENT(err->apr_err))
+    {
+      svn_error_clear(err);
+      *contents = NULL;
+      return SVN_NO_ERROR;
+    }
+
+  return svn_error_trace(err);
+}
+
 
 svn_error_t *
 svn_wc__db_pristine_check(svn_boolean_t *present,
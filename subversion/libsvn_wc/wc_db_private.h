@@ -52,6 +52,14 @@ struct svn_wc__db_t {
   /* Busy timeout in ms., 0 for the libsvn_subr default. */
   apr_int32_t timeout;
 
+  /* Number of threads to use for concurrent disk access, see
+     svn_wc__db_get_jobs(). */
+  int jobs;
+
+  /* The directory of the pristine store shared with other working copies
+     or NULL, see svn_wc__db_pristine_install(). */
+  const char *shared_pristine_abspath;
+
   /* Map a given working copy directory to its relevant data.
      const char *local_abspath -> svn_wc__db_wcroot_t *wcroot  */
   apr_hash_t *dir_data;
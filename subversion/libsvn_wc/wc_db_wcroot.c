@@ -232,6 +232,7 @@ svn_wc__db_open(svn_wc__db_t **db,
   (*db)->verify_format = !open_without_upgrade;
   (*db)->enforce_empty_wq = enforce_empty_wq;
   (*db)->dir_data = apr_hash_make(result_pool);
+  (*db)->jobs = 1;
 
   (*db)->state_pool = result_pool;
 
@@ -241,6 +242,8 @@ svn_wc__db_open(svn_wc__db_t **db,
       svn_error_t *err;
       svn_boolean_t sqlite_exclusive = FALSE;
       apr_int64_t timeout;
+      apr_int64_t jobs;
+      const char *shared_pristine_dir;
 
       err = svn_config_get_bool(config, &sqlite_exclusive,
                                 SVN_CONFIG_SECTION_WORKING_COPY,
@@ -261,12 +264,37 @@ svn_wc__db_open(svn_wc__db_t **db,
         svn_error_clear(err);
       else
         (*db)->timeout = (apr_int32_t)timeout;
+
+      err = svn_config_get_int64(config, &jobs,
+                                 SVN_CONFIG_SECTION_WORKING_COPY,
+                                 SVN_CONFIG_OPTION_WC_JOBS,
+                                 1);
+      if (err || jobs < 1 || jobs > SVN_WC__DB_MAX_JOBS)
+        svn_error_clear(err);
+      else
+        (*db)->jobs = (int)jobs;
+
+      svn_config_get(config, &shared_pristine_dir,
+                     SVN_CONFIG_SECTION_WORKING_COPY,
+                     SVN_CONFIG_OPTION_WC_SHARED_PRISTINE_STORE, NULL);
+      if (shared_pristine_dir && *shared_pristine_dir)
+        SVN_ERR(svn_dirent_get_absolute(&(*db)->shared_pristine_abspath,
+                                        svn_dirent_internal_style(
+                                          shared_pristine_dir, scratch_pool),
+                                        result_pool));
     }
 
   return SVN_NO_ERROR;
 }
 
 
+int
+svn_wc__db_get_jobs(svn_wc__db_t *db)
+{
+  return db->jobs;
+}
+
+
 svn_error_t *
 svn_wc__db_close(svn_wc__db_t *db)
 {
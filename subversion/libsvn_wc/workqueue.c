@@ -30,6 +30,7 @@
 #include "svn_subst.h"
 #include "svn_hash.h"
 #include "svn_io.h"
+#include "svn_sorts.h"
 
 #include "wc.h"
 #include "wc_db.h"
@@ -40,6 +41,7 @@
 
 #include "private/svn_io_private.h"
 #include "private/svn_skel.h"
+#include "private/svn_task.h"
 
 
 /* Workqueue operation names.  */
@@ -84,6 +86,11 @@ get_and_record_fileinfo(work_item_baton_t *wqb,
                         svn_boolean_t ignore_enoent,
                         apr_pool_t *scratch_pool);
 
+static void
+record_fileinfo(work_item_baton_t *wqb,
+                const char *local_abspath,
+                const svn_io_dirent2_t *dirent);
+
 /* ------------------------------------------------------------------------ */
 /* OP_REMOVE_BASE  */
 
@@ -445,46 +452,69 @@ svn_wc__wq_build_postupgrade(svn_skel_t **work_item,
 
 /* OP_FILE_INSTALL */
 
-/* Process the OP_FILE_INSTALL work item WORK_ITEM.
- * See svn_wc__wq_build_file_install() which generates this work item.
- * Implements (struct work_item_dispatch).func. */
-static svn_error_t *
-run_file_install(work_item_baton_t *wqb,
-                 svn_wc__db_t *db,
-                 const svn_skel_t *work_item,
-                 const char *wri_abspath,
-                 svn_cancel_func_t cancel_func,
-                 void *cancel_baton,
-                 apr_pool_t *scratch_pool)
+/* Everything needed to install a file without access to the DB, as
+   gathered by prepare_file_install(). */
+typedef struct file_install_t
 {
-  const svn_skel_t *arg1 = work_item->children->next;
-  const svn_skel_t *arg4 = arg1->next->next->next;
-  const char *local_relpath;
+  /* The file to install. */
   const char *local_abspath;
-  svn_boolean_t use_commit_times;
-  svn_boolean_t record_fileinfo;
+
+  /* The repository normal form of its contents. */
+  const char *source_abspath;
+
+  /* Translation settings. */
   svn_boolean_t special;
-  svn_stream_t *src_stream;
   svn_subst_eol_style_t style;
   const char *eol;
   apr_hash_t *keywords;
+
+  /* Where to put the translated file before moving it into place. */
   const char *temp_dir_abspath;
-  svn_stream_t *dst_stream;
+
+  /* Flags to set on the installed file. */
+  svn_boolean_t executable;
+  svn_boolean_t read_only;
+
+  /* Timestamp to set on the installed file, 0 to leave it alone. */
+  apr_time_t affected_time;
+
+  /* Whether to record the installed file's timestamp and size. */
+  svn_boolean_t record_fileinfo;
+} file_install_t;
+
+/* Set *INSTALL to the description of the OP_FILE_INSTALL work item
+ * WORK_ITEM.  This is the part of running the item that needs DB.
+ *
+ * Allocate *INSTALL in RESULT_POOL and use SCRATCH_POOL for temporaries.
+ */
+static svn_error_t *
+prepare_file_install(file_install_t **install,
+                     svn_wc__db_t *db,
+                     const svn_skel_t *work_item,
+                     const char *wri_abspath,
+                     apr_pool_t *result_pool,
+                     apr_pool_t *scratch_pool)
+{
+  const svn_skel_t *arg1 = work_item->children->next;
+  const svn_skel_t *arg4 = arg1->next->next->next;
+  file_install_t *result = apr_pcalloc(result_pool, sizeof(*result));
+  const char *local_relpath;
+  const char *local_abspath;
+  svn_boolean_t use_commit_times;
   apr_int64_t val;
   const char *wcroot_abspath;
-  const char *source_abspath;
   const svn_checksum_t *checksum;
   apr_hash_t *props;
   apr_time_t changed_date;
 
   local_relpath = apr_pstrmemdup(scratch_pool, arg1->data, arg1->len);
   SVN_ERR(svn_wc__db_from_relpath(&local_abspath, db, wri_abspath,
-                                  local_relpath, scratch_pool, scratch_pool));
+                                  local_relpath, result_pool, scratch_pool));
 
   SVN_ERR(svn_skel__parse_int(&val, arg1->next, scratch_pool));
   use_commit_times = (val != 0);
   SVN_ERR(svn_skel__parse_int(&val, arg1->next->next, scratch_pool));
-  record_fileinfo = (val != 0);
+  result->record_fileinfo = (val != 0);
 
   SVN_ERR(svn_wc__db_read_node_install_info(&wcroot_abspath,
                                             &checksum, &props,
@@ -496,9 +526,9 @@ run_file_install(work_item_baton_t *wqb,
     {
       /* Use the provided path for the source.  */
       local_relpath = apr_pstrmemdup(scratch_pool, arg4->data, arg4->len);
-      SVN_ERR(svn_wc__db_from_relpath(&source_abspath, db, wri_abspath,
-                                      local_relpath,
-                                      scratch_pool, scratch_pool));
+      SVN_ERR(svn_wc__db_from_relpath(&result->source_abspath, db,
+                                      wri_abspath, local_relpath,
+                                      result_pool, scratch_pool));
     }
   else if (! checksum)
     {
@@ -518,22 +548,86 @@ run_file_install(work_item_baton_t *wqb,
     }
   else
     {
-      SVN_ERR(svn_wc__db_pristine_get_future_path(&source_abspath,
+      SVN_ERR(svn_wc__db_pristine_get_future_path(&result->source_abspath,
                                                   wcroot_abspath,
                                                   checksum,
-                                                  scratch_pool, scratch_pool));
+                                                  result_pool,
+                                                  scratch_pool));
     }
 
-  SVN_ERR(svn_stream_open_readonly(&src_stream, source_abspath,
-                                   scratch_pool, scratch_pool));
+  result->local_abspath = local_abspath;
 
   /* Fetch all the translation bits.  */
-  SVN_ERR(svn_wc__get_translate_info(&style, &eol,
-                                     &keywords,
-                                     &special, db, local_abspath,
+  SVN_ERR(svn_wc__get_translate_info(&result->style, &result->eol,
+                                     &result->keywords,
+                                     &result->special, db, local_abspath,
                                      props, FALSE,
-                                     scratch_pool, scratch_pool));
-  if (special)
+                                     result_pool, scratch_pool));
+  if (result->special)
+    {
+      /* No need to set exec or read-only flags on special files.  */
+      *install = result;
+      return SVN_NO_ERROR;
+    }
+
+  /* Where is the Right Place to put a temp file in this working copy?  */
+  SVN_ERR(svn_wc__db_temp_wcroot_tempdir(&result->temp_dir_abspath,
+                                         db, wcroot_abspath,
+                                         result_pool, scratch_pool));
+
+#ifndef WIN32
+  result->executable = (props && svn_hash_gets(props, SVN_PROP_EXECUTABLE));
+#endif
+
+  /* Note that this explicitly checks the pristine properties, to make sure
+     that when the lock is locally set (=modification) it is not read only */
+  if (props && svn_hash_gets(props, SVN_PROP_NEEDS_LOCK))
+    {
+      svn_wc__db_status_t status;
+      svn_wc__db_lock_t *lock;
+      SVN_ERR(svn_wc__db_read_info(&status, NULL, NULL, NULL, NULL, NULL, NULL,
+                                   NULL, NULL, NULL, NULL, NULL, NULL, NULL,
+                                   NULL, NULL, &lock, NULL, NULL, NULL, NULL,
+                                   NULL, NULL, NULL, NULL, NULL, NULL,
+                                   db, local_abspath,
+                                   scratch_pool, scratch_pool));
+
+      result->read_only = (!lock && status != svn_wc__db_status_added);
+    }
+
+  if (use_commit_times)
+    result->affected_time = changed_date;
+
+  *install = result;
+  return SVN_NO_ERROR;
+}
+
+/* Install the file described by INSTALL.  This does not access the DB
+ * and may be called from any thread.
+ *
+ * If INSTALL->RECORD_FILEINFO is set, set *DIRENT to the installed file's
+ * dirent, allocated in RESULT_POOL.  Otherwise, set it to NULL.
+ *
+ * Use SCRATCH_POOL for temporary allocations.
+ */
+static svn_error_t *
+perform_file_install(const svn_io_dirent2_t **dirent,
+                     const file_install_t *install,
+                     svn_cancel_func_t cancel_func,
+                     void *cancel_baton,
+                     apr_pool_t *result_pool,
+                     apr_pool_t *scratch_pool)
+{
+  const char *local_abspath = install->local_abspath;
+  svn_stream_t *src_stream;
+  svn_stream_t *dst_stream;
+
+  *dirent = NULL;
+
+  SVN_ERR(svn_stream_open_readonly(&src_stream, install->source_abspath,
+                                   scratch_pool, scratch_pool));
+
+  if (install->special)
     {
       /* When this stream is closed, the resulting special file will
          atomically be created/moved into place at LOCAL_ABSPATH.  */
@@ -546,33 +640,28 @@ run_file_install(work_item_baton_t *wqb,
                                cancel_func, cancel_baton,
                                scratch_pool));
 
-      /* No need to set exec or read-only flags on special files.  */
-
       /* ### Shouldn't this record a timestamp and size, etc.? */
       return SVN_NO_ERROR;
     }
 
-  if (svn_subst_translation_required(style, eol, keywords,
+  if (svn_subst_translation_required(install->style, install->eol,
+                                     install->keywords,
                                      FALSE /* special */,
                                      TRUE /* force_eol_check */))
     {
       /* Wrap it in a translating (expanding) stream.  */
-      src_stream = svn_subst_stream_translated(src_stream, eol,
+      src_stream = svn_subst_stream_translated(src_stream, install->eol,
                                                TRUE /* repair */,
-                                               keywords,
+                                               install->keywords,
                                                TRUE /* expand */,
                                                scratch_pool);
     }
 
-  /* Where is the Right Place to put a temp file in this working copy?  */
-  SVN_ERR(svn_wc__db_temp_wcroot_tempdir(&temp_dir_abspath,
-                                         db, wcroot_abspath,
-                                         scratch_pool, scratch_pool));
-
   /* Translate to a temporary file. We don't want the user seeing a partial
      file, nor let them muck with it while we translate. We may also need to
      get its TRANSLATED_SIZE before the user can monkey it.  */
-  SVN_ERR(svn_stream__create_for_install(&dst_stream, temp_dir_abspath,
+  SVN_ERR(svn_stream__create_for_install(&dst_stream,
+                                         install->temp_dir_abspath,
                                          scratch_pool, scratch_pool));
 
   /* Copy from the source to the dest, translating as we go. This will also
@@ -589,44 +678,48 @@ run_file_install(work_item_baton_t *wqb,
                                      TRUE /* make_parents*/, scratch_pool));
 
   /* Tweak the on-disk file according to its properties.  */
-#ifndef WIN32
-  if (props && svn_hash_gets(props, SVN_PROP_EXECUTABLE))
+  if (install->executable)
     SVN_ERR(svn_io_set_file_executable(local_abspath, TRUE, FALSE,
                                        scratch_pool));
-#endif
 
-  /* Note that this explicitly checks the pristine properties, to make sure
-     that when the lock is locally set (=modification) it is not read only */
-  if (props && svn_hash_gets(props, SVN_PROP_NEEDS_LOCK))
-    {
-      svn_wc__db_status_t status;
-      svn_wc__db_lock_t *lock;
-      SVN_ERR(svn_wc__db_read_info(&status, NULL, NULL, NULL, NULL, NULL, NULL,
-                                   NULL, NULL, NULL, NULL, NULL, NULL, NULL,
-                                   NULL, NULL, &lock, NULL, NULL, NULL, NULL,
-                                   NULL, NULL, NULL, NULL, NULL, NULL,
-                                   db, local_abspath,
-                                   scratch_pool, scratch_pool));
+  if (install->read_only)
+    SVN_ERR(svn_io_set_file_read_only(local_abspath, FALSE, scratch_pool));
 
-      if (!lock && status != svn_wc__db_status_added)
-        SVN_ERR(svn_io_set_file_read_only(local_abspath, FALSE, scratch_pool));
-    }
-
-  if (use_commit_times)
-    {
-      if (changed_date)
-        SVN_ERR(svn_io_set_file_affected_time(changed_date,
-                                              local_abspath,
-                                              scratch_pool));
-    }
+  if (install->affected_time)
+    SVN_ERR(svn_io_set_file_affected_time(install->affected_time,
+                                          local_abspath,
+                                          scratch_pool));
 
   /* ### this should happen before we rename the file into place.  */
-  if (record_fileinfo)
-    {
-      SVN_ERR(get_and_record_fileinfo(wqb, local_abspath,
-                                      FALSE /* ignore_enoent */,
-                                      scratch_pool));
-    }
+  if (install->record_fileinfo)
+    SVN_ERR(svn_io_stat_dirent2(dirent, local_abspath, FALSE, FALSE,
+                                result_pool, scratch_pool));
+
+  return SVN_NO_ERROR;
+}
+
+/* Process the OP_FILE_INSTALL work item WORK_ITEM.
+ * See svn_wc__wq_build_file_install() which generates this work item.
+ * Implements (struct work_item_dispatch).func. */
+static svn_error_t *
+run_file_install(work_item_baton_t *wqb,
+                 svn_wc__db_t *db,
+                 const svn_skel_t *work_item,
+                 const char *wri_abspath,
+                 svn_cancel_func_t cancel_func,
+                 void *cancel_baton,
+                 apr_pool_t *scratch_pool)
+{
+  file_install_t *install;
+  const svn_io_dirent2_t *dirent;
+
+  SVN_ERR(prepare_file_install(&install, db, work_item, wri_abspath,
+                               scratch_pool, scratch_pool));
+  SVN_ERR(perform_file_install(&dirent, install, cancel_func, cancel_baton,
+                               scratch_pool, scratch_pool));
+
+  if (dirent)
+    record_fileinfo(wqb, install->local_abspath, dirent);
 
   return SVN_NO_ERROR;
 }
@@ -1474,6 +1567,329 @@ dispatch_work_item(work_item_baton_t *wqb,
 }
 
 
+/* Number of work items to fetch at once when running the work queue
+   concurrently. */
+#define WQ_BATCH_SIZE 256
+
+/* Return ERR wrapped in an error telling that the work item ID / WORK_ITEM
+   of the queue of WRI_ABSPATH failed.  */
+static svn_error_t *
+work_item_error(svn_error_t *err,
+                const char *wri_abspath,
+                apr_uint64_t id,
+                const svn_skel_t *work_item,
+                apr_pool_t *scratch_pool)
+{
+  const char *skel = svn_skel__unparse(work_item, scratch_pool)->data;
+
+  return svn_error_createf(SVN_ERR_WC_BAD_ADM_LOG, err,
+                           _("Failed to run the WC DB work queue "
+                             "associated with '%s', work item %d %s"),
+                           svn_dirent_local_style(wri_abspath,
+                                                  scratch_pool),
+                           (int)id, skel);
+}
+
+/* Return whether the work item WORK_ITEM can be run concurrently to
+   other such items, i.e. it is an OP_FILE_INSTALL from the pristine store.
+   Set *LOCAL_RELPATH to the path of the file to install. */
+static svn_boolean_t
+is_concurrent_install(const char **local_relpath,
+                      const svn_skel_t *work_item,
+                      apr_pool_t *result_pool)
+{
+  const svn_skel_t *arg1;
+
+  if (! svn_skel__matches_atom(work_item->children, OP_FILE_INSTALL))
+    return FALSE;
+
+  arg1 = work_item->children->next;
+  if (!arg1 || !arg1->next || !arg1->next->next
+      || arg1->next->next->next != NULL)
+    return FALSE;
+
+  *local_relpath = apr_pstrmemdup(result_pool, arg1->data, arg1->len);
+  return TRUE;
+}
+
+/* Baton for the concurrent installation of files in
+   run_file_installs_concurrently(). */
+typedef struct install_baton_t
+{
+  /* The file_install_t * to process, one per task. */
+  apr_array_header_t *installs;
+
+  /* The svn_wc__db_wq_item_t they originate from, in the same order. */
+  const svn_wc__db_wq_item_t *items;
+
+  /* Collects the file info to record. */
+  work_item_baton_t *wqb;
+
+  /* Collects the identifiers of completed work items. */
+  apr_array_header_t *completed_ids;
+} install_baton_t;
+
+/* Implements svn_task__process_func_t for the install_baton_t given as
+   PROCESS_BATON.  Set *RESULT to the svn_io_dirent2_t to record, if any. */
+static svn_error_t *
+install_process(void **result,
+                apr_size_t task_index,
+                void *process_baton,
+                void *thread_context,
+                svn_cancel_func_t cancel_func,
+                void *cancel_baton,
+                apr_pool_t *result_pool,
+                apr_pool_t *scratch_pool)
+{
+  const install_baton_t *baton = process_baton;
+  const file_install_t *install
+    = APR_ARRAY_IDX(baton->installs, task_index, const file_install_t *);
+  const svn_io_dirent2_t *dirent;
+
+  SVN_ERR(perform_file_install(&dirent, install, cancel_func, cancel_baton,
+                               result_pool, scratch_pool));
+
+  *result = (void *)dirent;
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_task__output_func_t for the install_baton_t given as
+   OUTPUT_BATON.  This runs in the thread that owns the DB. */
+static svn_error_t *
+install_output(void *output_baton,
+               apr_size_t task_index,
+               void *result,
+               svn_cancel_func_t cancel_func,
+               void *cancel_baton,
+               apr_pool_t *scratch_pool)
+{
+  install_baton_t *baton = output_baton;
+  const file_install_t *install
+    = APR_ARRAY_IDX(baton->installs, task_index, const file_install_t *);
+  const svn_io_dirent2_t *dirent = result;
+
+  if (dirent)
+    record_fileinfo(baton->wqb, install->local_abspath, dirent);
+
+  APR_ARRAY_PUSH(baton->completed_ids, apr_uint64_t)
+    = baton->items[task_index].id;
+
+  return SVN_NO_ERROR;
+}
+
+/* Run the COUNT work items starting at ITEMS, which are all OP_FILE_INSTALL
+   items for different files as checked by is_concurrent_install(), on up
+   to JOBS threads.
+
+   Append the identifiers of all successfully completed items to
+   COMPLETED_IDS and the file info to record to WQB.  Items are reported
+   complete strictly in queue order.
+
+   Set *PROCESSED to the number of items that were handled.  This is less
+   than COUNT if an item could not be prepared; the caller should then run
+   the remaining items as usual so that the error is reported for the
+   correct work item.
+
+   Use SCRATCH_POOL for temporary allocations. */
+static svn_error_t *
+run_file_installs_concurrently(int *processed,
+                               work_item_baton_t *wqb,
+                               apr_array_header_t *completed_ids,
+                               svn_wc__db_t *db,
+                               const char *wri_abspath,
+                               const svn_wc__db_wq_item_t *items,
+                               int count,
+                               int jobs,
+                               svn_cancel_func_t cancel_func,
+                               void *cancel_baton,
+                               apr_pool_t *scratch_pool)
+{
+  install_baton_t baton;
+  apr_pool_t *iterpool = svn_pool_create(scratch_pool);
+  int done = completed_ids->nelts;
+  svn_error_t *err;
+  int i;
+
+  /* Gather everything that needs the DB in this thread. */
+  baton.installs = apr_array_make(scratch_pool, count,
+                                  sizeof(file_install_t *));
+  for (i = 0; i < count; i++)
+    {
+      file_install_t *install;
+
+      svn_pool_clear(iterpool);
+      err = prepare_file_install(&install, db, items[i].work_item,
+                                 wri_abspath, scratch_pool, iterpool);
+      if (err)
+        {
+          /* Let the caller run this item and report the error. */
+          svn_error_clear(err);
+          break;
+        }
+
+      APR_ARRAY_PUSH(baton.installs, file_install_t *) = install;
+    }
+  svn_pool_destroy(iterpool);
+
+  *processed = baton.installs->nelts;
+  if (*processed == 0)
+    return SVN_NO_ERROR;
+
+  baton.items = items;
+  baton.wqb = wqb;
+  baton.completed_ids = completed_ids;
+
+  err = svn_task__run(MIN(jobs, *processed), *processed,
+                      install_process, &baton,
+                      install_output, &baton,
+                      NULL, NULL,
+                      cancel_func, cancel_baton,
+                      scratch_pool);
+
+  /* All items before the failed one have been completed. */
+  if (err && err->apr_err != SVN_ERR_CANCELLED)
+    {
+      i = completed_ids->nelts - done;
+      err = work_item_error(err, wri_abspath, items[i].id,
+                            items[i].work_item, scratch_pool);
+    }
+
+  return svn_error_trace(err);
+}
+
+/* Like svn_wc__wq_run() but run independent work items on up to JOBS
+   threads.
+
+   Work items are fetched in batches.  Runs of OP_FILE_INSTALL items for
+   different files are handed to run_file_installs_concurrently() and
+   marked as completed together with a single transaction, once all of
+   them have been installed.  As before, a work item is only removed from
+   the queue after it has been completed, so an interrupted run just
+   repeats these file installations on the next 'svn cleanup'.  All other
+   work items are run one at a time and completed immediately, exactly
+   like svn_wc__wq_run() does. */
+static svn_error_t *
+wq_run_concurrently(svn_wc__db_t *db,
+                    const char *wri_abspath,
+                    int jobs,
+                    svn_cancel_func_t cancel_func,
+                    void *cancel_baton,
+                    apr_pool_t *scratch_pool)
+{
+  apr_pool_t *iterpool = svn_pool_create(scratch_pool);
+  apr_pool_t *batch_pool = svn_pool_create(scratch_pool);
+  apr_array_header_t *completed_ids = apr_array_make(scratch_pool,
+                                                     WQ_BATCH_SIZE,
+                                                     sizeof(apr_uint64_t));
+  apr_array_header_t *items = NULL;
+  int next = 0;
+  work_item_baton_t wib = { 0 };
+  wib.result_pool = svn_pool_create(scratch_pool);
+
+  while (TRUE)
+    {
+      const svn_wc__db_wq_item_t *item;
+      apr_hash_t *targets;
+      const char *local_relpath;
+      int count;
+      svn_error_t *err;
+
+      svn_pool_clear(iterpool);
+
+      /* Make sure to do this *early* in the loop iteration.  Completed
+         items must be marked as such before we start worrying about
+         anything else.  Fetch new items if we handled all of them. */
+      if (!items || next == items->nelts)
+        {
+          svn_pool_clear(batch_pool);
+          SVN_ERR(svn_wc__db_wq_complete_and_fetch(&items, db, wri_abspath,
+                                                   completed_ids,
+                                                   wib.record_map,
+                                                   WQ_BATCH_SIZE,
+                                                   batch_pool, iterpool));
+          next = 0;
+        }
+      else if (completed_ids->nelts)
+        {
+          SVN_ERR(svn_wc__db_wq_complete_and_fetch(NULL, db, wri_abspath,
+                                                   completed_ids,
+                                                   wib.record_map, 0,
+                                                   NULL, iterpool));
+        }
+
+      apr_array_clear(completed_ids);
+      svn_pool_clear(wib.result_pool);
+      wib.record_map = NULL;
+      wib.used = FALSE;
+
+      /* Stop work queue processing, if requested. A future 'svn cleanup'
+         should be able to continue the processing.  */
+      if (cancel_func)
+        SVN_ERR(cancel_func(cancel_baton));
+
+      /* If there are no more work items, we're done.  */
+      if (next == items->nelts)
+        break;
+
+      /* Find the longest run of independent file installations. */
+      targets = apr_hash_make(iterpool);
+      for (count = 0; next + count < items->nelts; count++)
+        {
+          item = &APR_ARRAY_IDX(items, next + count, svn_wc__db_wq_item_t);
+          if (!is_concurrent_install(&local_relpath, item->work_item,
+                                     iterpool)
+              || svn_hash_gets(targets, local_relpath))
+            break;
+
+          svn_hash_sets(targets, local_relpath, local_relpath);
+        }
+
+      if (count > 1)
+        {
+          int processed;
+
+          err = run_file_installs_concurrently(
+                  &processed, &wib, completed_ids, db, wri_abspath,
+                  &APR_ARRAY_IDX(items, next, svn_wc__db_wq_item_t),
+                  count, jobs, cancel_func, cancel_baton, iterpool);
+
+          /* Don't redo the installations that succeeded. */
+          if (err && completed_ids->nelts)
+            err = svn_error_compose_create(
+                    err,
+                    svn_wc__db_wq_complete_and_fetch(NULL, db, wri_abspath,
+                                                     completed_ids,
+                                                     wib.record_map, 0,
+                                                     NULL, iterpool));
+          SVN_ERR(err);
+
+          if (processed)
+            {
+              next += processed;
+              continue;
+            }
+        }
+
+      /* Run the next item on its own. */
+      item = &APR_ARRAY_IDX(items, next, svn_wc__db_wq_item_t);
+      err = dispatch_work_item(&wib, db, wri_abspath, item->work_item,
+                               cancel_func, cancel_baton, iterpool);
+      if (err)
+        return svn_error_trace(work_item_error(err, wri_abspath, item->id,
+                                               item->work_item,
+                                               scratch_pool));
+
+      /* The work item finished without error. Mark it completed
+         in the next loop.  */
+      APR_ARRAY_PUSH(completed_ids, apr_uint64_t) = item->id;
+      next++;
+    }
+
+  svn_pool_destroy(iterpool);
+  return SVN_NO_ERROR;
+}
+
+
 svn_error_t *
 svn_wc__wq_run(svn_wc__db_t *db,
                const char *wri_abspath,
@@ -1483,6 +1899,7 @@ svn_wc__wq_run(svn_wc__db_t *db,
 {
   apr_pool_t *iterpool = svn_pool_create(scratch_pool);
   apr_uint64_t last_id = 0;
+  int jobs = svn_wc__db_get_jobs(db);
   work_item_baton_t wib = { 0 };
   wib.result_pool = svn_pool_create(scratch_pool);
 
@@ -1500,6 +1917,14 @@ svn_wc__wq_run(svn_wc__db_t *db,
   }
 #endif
 
+  if (jobs > 1)
+    {
+      svn_pool_destroy(iterpool);
+      return svn_error_trace(wq_run_concurrently(db, wri_abspath, jobs,
+                                                 cancel_func, cancel_baton,
+                                                 scratch_pool));
+    }
+
   while (TRUE)
     {
       apr_uint64_t id;
@@ -1546,16 +1971,8 @@ svn_wc__wq_run(svn_wc__db_t *db,
       err = dispatch_work_item(&wib, db, wri_abspath, work_item,
                                cancel_func, cancel_baton, iterpool);
       if (err)
-        {
-          const char *skel = svn_skel__unparse(work_item, scratch_pool)->data;
-
-          return svn_error_createf(SVN_ERR_WC_BAD_ADM_LOG, err,
-                                   _("Failed to run the WC DB work queue "
-                                     "associated with '%s', work item %d %s"),
-                                   svn_dirent_local_style(wri_abspath,
-                                                          scratch_pool),
-                                   (int)id, skel);
-        }
+        return svn_error_trace(work_item_error(err, wri_abspath, id,
+                                               work_item, scratch_pool));
 
       /* The work item finished without error. Mark it completed
          in the next loop.  */
@@ -1626,8 +2043,20 @@ get_and_record_fileinfo(work_item_baton_t *wqb,
   SVN_ERR(svn_io_stat_dirent2(&dirent, local_abspath, FALSE, ignore_enoent,
                               wqb->result_pool, scratch_pool));
 
+  record_fileinfo(wqb, local_abspath, dirent);
+
+  return SVN_NO_ERROR;
+}
+
+/* Remember to record the timestamp and size of the file at LOCAL_ABSPATH
+   from DIRENT when completing the current work item(s) in WQB. */
+static void
+record_fileinfo(work_item_baton_t *wqb,
+                const char *local_abspath,
+                const svn_io_dirent2_t *dirent)
+{
   if (dirent->kind != svn_node_file)
-    return SVN_NO_ERROR;
+    return;
 
   wqb->used = TRUE;
 
@@ -1635,7 +2064,5 @@ get_and_record_fileinfo(work_item_baton_t *wqb,
     wqb->record_map = apr_hash_make(wqb->result_pool);
 
   svn_hash_sets(wqb->record_map, apr_pstrdup(wqb->result_pool, local_abspath),
-                dirent);
-
-  return SVN_NO_ERROR;
+                svn_io_dirent2_dup(dirent, wqb->result_pool));
 }
@@ -120,6 +120,10 @@ extern module AP_MODULE_DECLARE_DATA dav_svn_module;
 /* The authz_svn provider for bypassing path authz. */
 static authz_svn__subreq_bypass_func_t pathauthz_bypass_func = NULL;
 
+/* Whether to create the in-memory cache in shared memory.  Like the
+   cache size, this is a process-wide setting. */
+static svn_boolean_t in_memory_cache_shared = FALSE;
+
 static int
 init(apr_pool_t *p, apr_pool_t *plog, apr_pool_t *ptemp, server_rec *s)
 {
@@ -150,6 +154,20 @@ init(apr_pool_t *p, apr_pool_t *plog, apr_pool_t *ptemp, server_rec *s)
   conf = ap_get_module_config(s->module_config, &dav_svn_module);
   svn_utf_initialize2(conf->use_utf8, p);
 
+  /* The shared cache must exist before the MPM forks the children. */
+  if (in_memory_cache_shared)
+    {
+      serr = svn_cache_config_init_shared(ptemp);
+      if (serr)
+        {
+          ap_log_perror(APLOG_MARK, APLOG_ERR, serr->apr_err, p,
+                        "mod_dav_svn: error creating shared cache: '%s'",
+                        serr->message ? serr->message : "(no more info)");
+          svn_error_clear(serr);
+          return HTTP_INTERNAL_SERVER_ERROR;
+        }
+    }
+
   return OK;
 }
 
@@ -631,6 +649,14 @@ SVNInMemoryCacheSize_cmd(cmd_parms *cmd, void *config, const char *arg1)
   return NULL;
 }
 
+static const char *
+SVNInMemoryCacheShared_cmd(cmd_parms *cmd, void *config, int arg)
+{
+  in_memory_cache_shared = arg;
+
+  return NULL;
+}
+
 static const char *
 SVNCompressionLevel_cmd(cmd_parms *cmd, void *config, const char *arg1)
 {
@@ -1395,6 +1421,12 @@ static const command_rec cmds[] =
                 "specifies the maximum size in kB per process of Subversion's "
                 "in-memory object cache (default value is 16384; 0 switches "
                 "to dynamically sized caches)."),
+
+  /* per server */
+  AP_INIT_FLAG("SVNInMemoryCacheShared", SVNInMemoryCacheShared_cmd, NULL,
+               RSRC_CONF,
+               "enables sharing the in-memory object cache between all "
+               "server processes (prefork-style MPMs only; default is Off)."),
   /* per server */
   AP_INIT_TAKE1("SVNCompressionLevel", SVNCompressionLevel_cmd, NULL,
                 RSRC_CONF,
@@ -140,7 +140,13 @@ const apr_getopt_option_t svn_cl__options[] =
                        "                             "
                        "  -U ARG, --context ARG: Show ARG lines of context\n"
                        "                             "
-                       "  -p, --show-c-function: Show C function name")},
+                       "  -p, --show-c-function: Show C function name\n"
+                       "                             "
+                       "  --patience: Use the patience diff algorithm\n"
+                       "                             "
+                       "  --memory-limit ARG: Compare blocks of lines if\n"
+                       "                             "
+                       "    lines need more than ARG MB")},
   {"targets",       opt_targets, 1,
                     N_("pass contents of file ARG as additional args")},
   {"depth",         opt_depth, 1,
@@ -51,6 +51,7 @@
 #include "private/svn_cmdline_private.h"
 #include "private/svn_fspath.h"
 #include "private/svn_fs_fs_private.h"
+#include "private/svn_repos_private.h"
 
 #include "svn_private_config.h"
 
@@ -97,6 +98,7 @@ check_lib_versions(void)
 /** Subcommands. **/
 
 static svn_opt_subcommand_t
+  subcommand_build_log_index,
   subcommand_build_repcache,
   subcommand_crashtest,
   subcommand_create,
@@ -159,7 +161,8 @@ enum svnadmin__cmdline_options_t
     svnadmin__normalize_props,
     svnadmin__exclude,
     svnadmin__include,
-    svnadmin__glob
+    svnadmin__glob,
+    svnadmin__split_size
   };
 
 /* Option codes and descriptions.
@@ -256,6 +259,9 @@ static const apr_getopt_option_t options_table[] =
     {"keep-going",    svnadmin__keep_going, 0,
      N_("continue verification after detecting a corruption")},
 
+    {"jobs",          'j', 1,
+     N_("use up to ARG worker threads (default: 1)")},
+
     {"memory-cache-size",     'M', 1,
      N_("size of the extra in-memory cache in MB used to\n"
         "                             minimize redundant operations. Default: 16.\n"
@@ -298,6 +304,9 @@ static const apr_getopt_option_t options_table[] =
         "                             Character '/' is not treated specially, so\n"
         "                             pattern /*/foo matches paths /a/foo and /a/b/foo.") },
 
+    {"split-size", svnadmin__split_size, 1,
+     N_("write a separate dump file for every ARG revisions")},
+
     {NULL}
   };
 
@@ -307,6 +316,16 @@ static const apr_getopt_option_t options_table[] =
  */
 static const svn_opt_subcommand_desc3_t cmd_table[] =
 {
+  {"build-log-index", subcommand_build_log_index, {0}, {N_(
+    "usage: svnadmin build-log-index REPOS_PATH\n"
+    "\n"), N_(
+    "Build the changed-paths index for the repository at REPOS_PATH,\n"
+    "replacing an existing one.  Path-restricted log requests use the\n"
+    "index to find the revisions in which a path changed without walking\n"
+    "its history.  Commits keep the index up to date once it exists.\n"
+   )},
+   {'q', 'M'} },
+
   {"build-repcache", subcommand_build_repcache, {0}, {N_(
     "usage: svnadmin build-repcache REPOS_PATH [-r LOWER[:UPPER]]\n"
     "\n"), N_(
@@ -381,9 +400,18 @@ static const svn_opt_subcommand_desc3_t cmd_table[] =
     "Using --exclude or --include gives results equivalent to authz-based\n"
     "path exclusions. In particular, when the source of a copy is\n"
     "excluded, the copy is transformed into an add (unlike in 'svndumpfilter').\n"
+    "\n"), N_(
+    "Use --jobs to render ranges of revisions concurrently.  The output is\n"
+    "the same as without that option.\n"
+    "\n"), N_(
+    "With --split-size N, write every N revisions to a separate file named\n"
+    "ARG.0000, ARG.0001 etc. where ARG is the file given with -F.  Only the\n"
+    "first file can contain a full tree dump; all others are incremental.\n"
+    "Loading all files in numerical order recreates the repository.\n"
    )},
-  {'r', svnadmin__incremental, svnadmin__deltas, 'q', 'M', 'F',
-   svnadmin__exclude, svnadmin__include, svnadmin__glob },
+  {'r', svnadmin__incremental, svnadmin__deltas, 'q', 'M', 'F', 'j',
+   svnadmin__exclude, svnadmin__include, svnadmin__glob,
+   svnadmin__split_size },
   {{'F', N_("write to file ARG instead of stdout")}} },
 
   {"dump-revprops", subcommand_dump_revprops, {0}, {N_(
@@ -428,8 +456,9 @@ static const svn_opt_subcommand_desc3_t cmd_table[] =
     "Make a hot copy of a repository.\n"
     "If --incremental is passed, data which already exists at the destination\n"
     "is not copied again.  Incremental mode is implemented for FSFS repositories.\n"
+    "Use --jobs to copy multiple revision files or packed shards concurrently.\n"
    )},
-   {svnadmin__clean_logs, svnadmin__incremental, 'q'} },
+   {svnadmin__clean_logs, svnadmin__incremental, 'q', 'j'} },
 
   {"info", subcommand_info, {0}, {N_(
     "usage: svnadmin info REPOS_PATH\n"
@@ -464,13 +493,15 @@ static const svn_opt_subcommand_desc3_t cmd_table[] =
     "one specified in the stream.  Progress feedback is sent to stdout.\n"
     "If --revision is specified, limit the loaded revisions to only those\n"
     "in the dump stream whose revision numbers match the specified range.\n"
+    "Use --jobs with a value of 2 or more to read and parse the dump stream\n"
+    "in a separate thread while the revisions are being committed.\n"
    )},
    {'q', 'r', svnadmin__ignore_uuid, svnadmin__force_uuid,
     svnadmin__ignore_dates,
     svnadmin__use_pre_commit_hook, svnadmin__use_post_commit_hook,
     svnadmin__parent_dir, svnadmin__normalize_props,
     svnadmin__bypass_prop_validation, 'M',
-    svnadmin__no_flush_to_disk, 'F'},
+    svnadmin__no_flush_to_disk, 'F', 'j'},
    {{'F', N_("read from file ARG instead of stdin")}} },
 
   {"load-revprops", subcommand_load_revprops, {0}, {N_(
@@ -519,8 +550,10 @@ static const svn_opt_subcommand_desc3_t cmd_table[] =
     "\n"), N_(
     "Possibly compact the repository into a more efficient storage model.\n"
     "This may not apply to all repositories, in which case, exit.\n"
+    "Use --jobs to pack multiple shards concurrently; the memory used for\n"
+    "packing each shard is reduced accordingly.\n"
    )},
-   {'q', 'M'} },
+   {'q', 'M', 'j'} },
 
   {"recover", subcommand_recover, {0}, {N_(
     "usage: svnadmin recover REPOS_PATH\n"
@@ -628,8 +661,9 @@ static const svn_opt_subcommand_desc3_t cmd_table[] =
     "usage: svnadmin verify REPOS_PATH\n"
     "\n"), N_(
     "Verify the data stored in the repository.\n"
+    "Use --jobs to verify multiple revisions concurrently.\n"
    )},
-   {'t', 'r', 'q', svnadmin__keep_going, 'M',
+   {'t', 'r', 'q', svnadmin__keep_going, 'M', 'j',
     svnadmin__check_normalization, svnadmin__metadata_only} },
 
   { NULL, NULL, {0}, {NULL}, {0} }
@@ -668,11 +702,13 @@ struct svnadmin_opt_state
   enum svn_repos_load_uuid uuid_action;             /* --ignore-uuid,
                                                        --force-uuid */
   apr_uint64_t memory_cache_size;                   /* --memory-cache-size M */
+  int jobs;                                         /* --jobs */
   const char *parent_dir;                           /* --parent-dir */
   const char *file;                                 /* --file */
   apr_array_header_t *exclude;                      /* --exclude */
   apr_array_header_t *include;                      /* --include */
   svn_boolean_t glob;                               /* --pattern */
+  svn_revnum_t split_size;                          /* --split-size */
 
   const char *config_dir;    /* Overriding Configuration Directory */
 };
@@ -1015,7 +1051,7 @@ struct repos_verify_callback_baton
 };
 
 /* Implementation of svn_repos_verify_callback_t to handle errors coming
-   from svn_repos_verify_fs3(). */
+   from svn_repos_verify_fs4(). */
 static svn_error_t *
 repos_verify_callback(void *baton,
                       svn_revnum_t revision,
@@ -1058,7 +1094,7 @@ repos_verify_callback(void *baton,
 
 /* Implementation of svn_repos_notify_func_t to wrap the output to a
    response stream for svn_repos_dump_fs2(), svn_repos_verify_fs(),
-   svn_repos_hotcopy3() and others. */
+   svn_repos_hotcopy4() and others. */
 static void
 repos_notify_handler(void *baton,
                      const svn_repos_notify_t *notify,
@@ -1281,6 +1317,12 @@ repos_notify_handler(void *baton,
                         notify->new_revision));
       return;
 
+    case svn_repos_notify_log_index_rev:
+      svn_error_clear(svn_stream_printf(feedback_stream, scratch_pool,
+                                        _("* Indexed revision %ld.\n"),
+                                        notify->revision));
+      return;
+
     default:
       return;
   }
@@ -1431,27 +1473,20 @@ subcommand_dump(apr_getopt_t *os, void *baton, apr_pool_t *pool)
   svn_revnum_t lower, upper;
   svn_stream_t *feedback_stream = NULL;
   struct dump_filter_baton_t filter_baton = {0};
+  svn_revnum_t range_start, split_size;
+  apr_pool_t *iterpool = svn_pool_create(pool);
+  int i;
 
   /* Expect no more arguments. */
   SVN_ERR(parse_args(NULL, os, 0, 0, pool));
 
+  if (opt_state->split_size && !opt_state->file)
+    return svn_error_create(SVN_ERR_CL_ARG_PARSING_ERROR, NULL,
+                            _("'--split-size' requires '--file'"));
+
   SVN_ERR(open_repos(&repos, opt_state->repository_path, opt_state, pool));
   SVN_ERR(get_dump_range(&lower, &upper, repos, opt_state, pool));
 
-  /* Open the file or STDOUT, depending on whether -F was specified. */
-  if (opt_state->file)
-    {
-      apr_file_t *file;
-
-      /* Overwrite existing files, same as with > redirection. */
-      SVN_ERR(svn_io_file_open(&file, opt_state->file,
-                               APR_WRITE | APR_CREATE | APR_TRUNCATE
-                               | APR_BUFFERED, APR_OS_DEFAULT, pool));
-      out_stream = svn_stream_from_aprfile2(file, FALSE, pool);
-    }
-  else
-    SVN_ERR(svn_stream_for_stdout(&out_stream, pool));
-
   /* Progress feedback goes to STDERR, unless they asked to suppress it. */
   if (! opt_state->quiet)
     feedback_stream = recode_stream_create(stderr, pool);
@@ -1476,14 +1511,54 @@ subcommand_dump(apr_getopt_t *os, void *baton, apr_pool_t *pool)
                                  "cannot be used simultaneously"));
     }
 
-  SVN_ERR(svn_repos_dump_fs4(repos, out_stream, lower, upper,
-                             opt_state->incremental, opt_state->use_deltas,
-                             TRUE, TRUE,
-                             !opt_state->quiet ? repos_notify_handler : NULL,
-                             feedback_stream,
-                             filter_baton.prefixes ? dump_filter_func : NULL,
-                             &filter_baton,
-                             check_cancel, NULL, pool));
+  /* Without --split-size, everything goes into a single range. */
+  split_size = opt_state->split_size ? opt_state->split_size
+                                     : upper - lower + 1;
+
+  for (range_start = lower, i = 0; range_start <= upper;
+       range_start += split_size, ++i)
+    {
+      svn_revnum_t range_end = MIN(upper, range_start + split_size - 1);
+      svn_pool_clear(iterpool);
+
+      /* Open the file or STDOUT, depending on whether -F was specified.
+         Split dumps get numbered files, one per range. */
+      if (opt_state->file)
+        {
+          apr_file_t *file;
+          const char *path = opt_state->split_size
+                           ? apr_psprintf(iterpool, "%s.%04d",
+                                          opt_state->file, i)
+                           : opt_state->file;
+
+          /* Overwrite existing files, same as with > redirection. */
+          SVN_ERR(svn_io_file_open(&file, path,
+                                   APR_WRITE | APR_CREATE | APR_TRUNCATE
+                                   | APR_BUFFERED, APR_OS_DEFAULT,
+                                   iterpool));
+          out_stream = svn_stream_from_aprfile2(file, FALSE, iterpool);
+        }
+      else
+        SVN_ERR(svn_stream_for_stdout(&out_stream, iterpool));
+
+      /* All but the first range continue where the previous one ended.
+         References into the previous ranges are fine, then. */
+      SVN_ERR(svn_repos__dump_fs(repos, out_stream, range_start, range_end,
+                                 lower,
+                                 opt_state->incremental || range_start > lower,
+                                 opt_state->use_deltas, TRUE, TRUE,
+                                 opt_state->jobs,
+                                 !opt_state->quiet
+                                   ? repos_notify_handler : NULL,
+                                 feedback_stream,
+                                 filter_baton.prefixes
+                                   ? dump_filter_func : NULL,
+                                 &filter_baton,
+                                 check_cancel, NULL, iterpool));
+      SVN_ERR(svn_stream_close(out_stream));
+    }
+
+  svn_pool_destroy(iterpool);
 
   return SVN_NO_ERROR;
 }
@@ -1522,8 +1597,8 @@ subcommand_dump_revprops(apr_getopt_t *os, void *baton, apr_pool_t *pool)
   if (! opt_state->quiet)
     feedback_stream = recode_stream_create(stderr, pool);
 
-  SVN_ERR(svn_repos_dump_fs4(repos, out_stream, lower, upper,
-                             FALSE, FALSE, TRUE, FALSE,
+  SVN_ERR(svn_repos_dump_fs5(repos, out_stream, lower, upper,
+                             FALSE, FALSE, TRUE, FALSE, 1,
                              !opt_state->quiet ? repos_notify_handler : NULL,
                              feedback_stream, NULL, NULL,
                              check_cancel, NULL, pool));
@@ -1732,13 +1807,14 @@ subcommand_load(apr_getopt_t *os, void *baton, apr_pool_t *pool)
   if (! opt_state->quiet)
     feedback_stream = recode_stream_create(stdout, pool);
 
-  err = svn_repos_load_fs6(repos, in_stream, lower, upper,
+  err = svn_repos_load_fs7(repos, in_stream, lower, upper,
                            opt_state->uuid_action, opt_state->parent_dir,
                            opt_state->use_pre_commit_hook,
                            opt_state->use_post_commit_hook,
                            !opt_state->bypass_prop_validation,
                            opt_state->ignore_dates,
                            opt_state->normalize_props,
+                           opt_state->jobs,
                            opt_state->quiet ? NULL : repos_notify_handler,
                            feedback_stream, check_cancel, NULL, pool);
 
@@ -2206,7 +2282,8 @@ subcommand_pack(apr_getopt_t *os, void *baton, apr_pool_t *pool)
     feedback_stream = recode_stream_create(stdout, pool);
 
   return svn_error_trace(
-    svn_repos_fs_pack2(repos, !opt_state->quiet ? repos_notify_handler : NULL,
+    svn_repos_fs_pack3(repos, opt_state->jobs,
+                       !opt_state->quiet ? repos_notify_handler : NULL,
                        feedback_stream, check_cancel, NULL, pool));
 }
 
@@ -2272,9 +2349,10 @@ subcommand_verify(apr_getopt_t *os, void *baton, apr_pool_t *pool)
     apr_array_make(pool, 0, sizeof(struct verification_error *));
   verify_baton.result_pool = pool;
 
-  SVN_ERR(svn_repos_verify_fs3(repos, lower, upper,
+  SVN_ERR(svn_repos_verify_fs4(repos, lower, upper,
                                opt_state->check_normalization,
                                opt_state->metadata_only,
+                               opt_state->jobs,
                                !opt_state->quiet
                                  ? repos_notify_handler : NULL,
                                feedback_stream,
@@ -2372,8 +2450,9 @@ subcommand_hotcopy(apr_getopt_t *os, void *baton, apr_pool_t *pool)
   if (! opt_state->quiet)
     feedback_stream = recode_stream_create(stdout, pool);
 
-  return svn_repos_hotcopy3(opt_state->repository_path, new_repos_path,
+  return svn_repos_hotcopy4(opt_state->repository_path, new_repos_path,
                             opt_state->clean_logs, opt_state->incremental,
+                            opt_state->jobs,
                             !opt_state->quiet ? repos_notify_handler : NULL,
                             feedback_stream, check_cancel, NULL, pool);
 }
@@ -2992,6 +3071,29 @@ build_rep_cache(svn_fs_t *fs,
     }
 }
 
+/* This implements `svn_opt_subcommand_t'. */
+static svn_error_t *
+subcommand_build_log_index(apr_getopt_t *os, void *baton, apr_pool_t *pool)
+{
+  struct svnadmin_opt_state *opt_state = baton;
+  svn_repos_t *repos;
+  svn_stream_t *feedback_stream = NULL;
+
+  /* Expect no more arguments. */
+  SVN_ERR(parse_args(NULL, os, 0, 0, pool));
+
+  SVN_ERR(open_repos(&repos, opt_state->repository_path, opt_state, pool));
+
+  /* Progress feedback goes to STDOUT, unless they asked to suppress it. */
+  if (! opt_state->quiet)
+    feedback_stream = recode_stream_create(stdout, pool);
+
+  return svn_error_trace(
+    svn_repos_build_log_index(repos,
+                              !opt_state->quiet ? repos_notify_handler : NULL,
+                              feedback_stream, check_cancel, NULL, pool));
+}
+
 /* This implements `svn_opt_subcommand_t'. */
 static svn_error_t *
 subcommand_build_repcache(apr_getopt_t *os, void *baton, apr_pool_t *pool)
@@ -3076,6 +3178,7 @@ sub_main(int *exit_code, int argc, const char *argv[], apr_pool_t *pool)
   opt_state.start_revision.kind = svn_opt_revision_unspecified;
   opt_state.end_revision.kind = svn_opt_revision_unspecified;
   opt_state.memory_cache_size = svn_cache_config_get()->cache_size;
+  opt_state.jobs = 1;
 
   /* Parse options. */
   SVN_ERR(svn_cmdline__getopt_init(&os, argc, argv, pool));
@@ -3141,6 +3244,15 @@ sub_main(int *exit_code, int argc, const char *argv[], apr_pool_t *pool)
           opt_state.memory_cache_size = 0x100000 * sz_val;
         }
         break;
+      case 'j':
+        {
+          SVN_ERR(svn_cstring_atoi(&opt_state.jobs, opt_arg));
+          if (opt_state.jobs < 1)
+            return svn_error_createf(SVN_ERR_CL_ARG_PARSING_ERROR, NULL,
+                                     _("Invalid number of jobs '%s'"),
+                                     opt_arg);
+        }
+        break;
       case 'F':
         SVN_ERR(svn_utf_cstring_to_utf8(&(opt_state.file), opt_arg, pool));
         dash_F_arg = TRUE;
@@ -3290,6 +3402,17 @@ sub_main(int *exit_code, int argc, const char *argv[], apr_pool_t *pool)
       case svnadmin__glob:
         opt_state.glob = TRUE;
         break;
+      case svnadmin__split_size:
+        {
+          int split_size;
+          SVN_ERR(svn_cstring_atoi(&split_size, opt_arg));
+          if (split_size < 1)
+            return svn_error_createf(SVN_ERR_CL_ARG_PARSING_ERROR, NULL,
+                                     _("Invalid split size '%s'"),
+                                     opt_arg);
+          opt_state.split_size = split_size;
+        }
+        break;
       default:
         {
           SVN_ERR(subcommand_help(NULL, NULL, pool));
@@ -3417,7 +3540,7 @@ sub_main(int *exit_code, int argc, const char *argv[], apr_pool_t *pool)
     svn_cache_config_t settings = *svn_cache_config_get();
 
     settings.cache_size = opt_state.memory_cache_size;
-    settings.single_threaded = TRUE;
+    settings.single_threaded = opt_state.jobs <= 1;
 
     svn_cache_config_set(&settings);
   }
@@ -200,7 +200,13 @@ static const apr_getopt_option_t options_table[] =
       "                             "
       "  -U ARG, --context ARG: Show ARG lines of context\n"
       "                             "
-      "  -p, --show-c-function: Show C function name")},
+      "  -p, --show-c-function: Show C function name\n"
+      "                             "
+      "  --patience: Use the patience diff algorithm\n"
+      "                             "
+      "  --memory-limit ARG: Compare blocks of lines if\n"
+      "                             "
+      "    lines need more than ARG MB")},
 
   {"quiet",             'q', 0,
    N_("no progress (only errors) to stderr")},
@@ -433,6 +433,28 @@ static void convert_case(char *text, svn_boolean_t to_uppercase)
     }
 }
 
+/* Return the user name in B to use for authz purposes, i.e. after any
+   username case normalization that might be requested. */
+static const char *get_authz_user(server_baton_t *b)
+{
+  client_info_t *client_info = b->client_info;
+
+  /* If we have a username, and we've not yet used it + any username
+     case normalization, do so now. */
+  if (client_info->user && (! client_info->authz_user))
+    {
+      char *authz_user = apr_pstrdup(b->pool, client_info->user);
+      if (b->repository->username_case == CASE_FORCE_UPPER)
+        convert_case(authz_user, TRUE);
+      else if (b->repository->username_case == CASE_FORCE_LOWER)
+        convert_case(authz_user, FALSE);
+
+      client_info->authz_user = authz_user;
+    }
+
+  return client_info->authz_user;
+}
+
 /* Set *ALLOWED to TRUE if PATH is accessible in the REQUIRED mode to
    the user described in BATON according to the authz rules in BATON.
    Use POOL for temporary allocations only.  If no authz rules are
@@ -444,7 +466,6 @@ static svn_error_t *authz_check_access(svn_boolean_t *allowed,
                                        apr_pool_t *pool)
 {
   repository_t *repository = b->repository;
-  client_info_t *client_info = b->client_info;
 
   /* If authz cannot be performed, grant access.  This is NOT the same
      as the default policy when authz is performed on a path with no
@@ -465,23 +486,9 @@ static svn_error_t *authz_check_access(svn_boolean_t *allowed,
   if (path && *path != '/')
     path = svn_fspath__canonicalize(path, pool);
 
-  /* If we have a username, and we've not yet used it + any username
-     case normalization that might be requested to determine "the
-     username we used for authz purposes", do so now. */
-  if (client_info->user && (! client_info->authz_user))
-    {
-      char *authz_user = apr_pstrdup(b->pool, client_info->user);
-      if (repository->username_case == CASE_FORCE_UPPER)
-        convert_case(authz_user, TRUE);
-      else if (repository->username_case == CASE_FORCE_LOWER)
-        convert_case(authz_user, FALSE);
-
-      client_info->authz_user = authz_user;
-    }
-
   SVN_ERR(svn_repos_authz_check_access(repository->authzdb,
                                        repository->authz_repos_name,
-                                       path, client_info->authz_user,
+                                       path, get_authz_user(b),
                                        required, allowed, pool));
   if (!*allowed)
     SVN_ERR(log_authz_denied(path, required, b, pool));
@@ -514,6 +521,38 @@ static svn_repos_authz_func_t authz_check_access_cb_func(server_baton_t *baton)
   return NULL;
 }
 
+/* Set *FUNC and *BATON to the read authorization callback for B, like
+ * authz_check_access_cb_func and AB do.  Use the library's callback if
+ * possible, since that lets operations like log check the access to many
+ * paths at once.  That one does not log authorization failures, though.
+ * Allocate the baton in POOL.
+ */
+static void get_authz_read_many_func(svn_repos_authz_func_t *func,
+                                     void **baton,
+                                     server_baton_t *b,
+                                     authz_baton_t *ab,
+                                     apr_pool_t *pool)
+{
+  if (b->repository->authzdb
+      && !(b->logger && b->client_info && b->client_info->user))
+    {
+      svn_repos_authz_read_baton_t *read_baton
+        = apr_pcalloc(pool, sizeof(*read_baton));
+
+      read_baton->authz = b->repository->authzdb;
+      read_baton->repos_name = b->repository->authz_repos_name;
+      read_baton->user = get_authz_user(b);
+
+      *func = svn_repos_authz_check_read;
+      *baton = read_baton;
+    }
+  else
+    {
+      *func = authz_check_access_cb_func(b);
+      *baton = ab;
+    }
+}
+
 /* Set *ALLOWED to TRUE if the REQUIRED access to PATH is granted,
  * according to the state in BATON.  Use POOL for temporary
  * allocations only.  ROOT is not used.  Implements the
@@ -2443,6 +2482,8 @@ log_cmd(svn_ra_svn_conn_t *conn,
   apr_uint64_t limit, include_merged_revs_param;
   log_baton_t lb;
   authz_baton_t ab;
+  svn_repos_authz_func_t authz_read_func;
+  void *authz_read_baton;
 
   ab.server = b;
   ab.conn = conn;
@@ -2516,10 +2557,12 @@ log_cmd(svn_ra_svn_conn_t *conn,
   lb.conn = conn;
   lb.stack_depth = 0;
   lb.started = FALSE;
+  get_authz_read_many_func(&authz_read_func, &authz_read_baton, b, &ab,
+                           pool);
   err = svn_repos_get_logs5(b->repository->repos, full_paths, start_rev,
                             end_rev, (int) limit,
                             strict_node, include_merged_revisions,
-                            revprops, authz_check_access_cb_func(b), &ab,
+                            revprops, authz_read_func, authz_read_baton,
                             send_changed_paths ? path_change_receiver : NULL,
                             send_changed_paths ? &lb : NULL,
                             revision_receiver, &lb, pool);
@@ -3468,6 +3511,8 @@ static svn_error_t *replay_one_revision(svn_ra_svn_conn_t *conn,
   svn_fs_root_t *root;
   svn_error_t *err;
   authz_baton_t ab;
+  svn_repos_authz_func_t authz_read_func;
+  void *authz_read_baton;
 
   ab.server = b;
   ab.conn = conn;
@@ -3480,10 +3525,12 @@ static svn_error_t *replay_one_revision(svn_ra_svn_conn_t *conn,
 
   err = svn_fs_revision_root(&root, b->repository->fs, rev, pool);
 
+  get_authz_read_many_func(&authz_read_func, &authz_read_baton, b, &ab,
+                           pool);
   if (! err)
     err = svn_repos_replay2(root, b->repository->fs_path->data,
                             low_water_mark, send_deltas, editor, edit_baton,
-                            authz_check_access_cb_func(b), &ab, pool);
+                            authz_read_func, authz_read_baton, pool);
 
   if (err)
     svn_error_clear(editor->abort_edit(edit_baton, pool));
@@ -3712,6 +3759,8 @@ list(svn_ra_svn_conn_t *conn,
   int i;
   list_receiver_baton_t rb;
   svn_error_t *err, *write_err;
+  svn_repos_authz_func_t authz_read_func;
+  void *authz_read_baton;
 
   authz_baton_t ab;
   ab.server = b;
@@ -3763,8 +3812,10 @@ list(svn_ra_svn_conn_t *conn,
 
   /* Fetch the directory entries if requested and send them immediately. */
   path_info_only = (rb.dirent_fields & ~SVN_DIRENT_KIND) == 0;
+  get_authz_read_many_func(&authz_read_func, &authz_read_baton, b, &ab,
+                           pool);
   err = svn_repos_list(root, full_path, patterns, depth, path_info_only,
-                       authz_check_access_cb_func(b), &ab, list_receiver,
+                       authz_read_func, authz_read_baton, list_receiver,
                        &rb, NULL, NULL, pool);
 
 
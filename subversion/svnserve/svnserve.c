@@ -222,6 +222,7 @@ void winservice_notify_stop(void)
 #define SVNSERVE_OPT_MAX_REQUEST     274
 #define SVNSERVE_OPT_MAX_RESPONSE    275
 #define SVNSERVE_OPT_CACHE_NODEPROPS 276
+#define SVNSERVE_OPT_SHARED_CACHE    277
 
 /* Text macro because we can't use #ifdef sections inside a N_("...")
    macro expansion. */
@@ -325,6 +326,12 @@ static const apr_getopt_option_t svnserve__options[] =
         "Default is yes.\n"
         "                             "
         "[used for FSFS repositories only]")},
+    {"shared-memory-cache", SVNSERVE_OPT_SHARED_CACHE, 0,
+     N_("share the in-memory cache between all server\n"
+        "                             "
+        "processes instead of giving each its own cache.\n"
+        "                             "
+        "[mode: daemon, fork only]")},
     {"client-speed", SVNSERVE_OPT_CLIENT_SPEED, 1,
      N_("Optimize network handling based on the assumption\n"
         "                             "
@@ -725,6 +732,7 @@ sub_main(int *exit_code, int argc, const char *argv[], apr_pool_t *pool)
   svn_boolean_t cache_txdeltas = TRUE;
   svn_boolean_t cache_revprops = FALSE;
   svn_boolean_t use_block_read = FALSE;
+  svn_boolean_t shared_memory_cache = FALSE;
   apr_uint16_t port = SVN_RA_SVN_PORT;
   const char *host = NULL;
   int family = APR_INET;
@@ -929,6 +937,10 @@ sub_main(int *exit_code, int argc, const char *argv[], apr_pool_t *pool)
           use_block_read = svn_tristate__from_word(arg) == svn_tristate_true;
           break;
 
+        case SVNSERVE_OPT_SHARED_CACHE:
+          shared_memory_cache = TRUE;
+          break;
+
         case SVNSERVE_OPT_CLIENT_SPEED:
           {
             apr_size_t bandwidth = (apr_size_t)apr_strtoi64(arg, NULL, 0);
@@ -1079,6 +1091,15 @@ sub_main(int *exit_code, int argc, const char *argv[], apr_pool_t *pool)
                _("Option --tunnel-user is only valid in tunnel mode"));
     }
 
+  if (shared_memory_cache
+      && (run_mode != run_mode_daemon
+          || handling_mode != connection_mode_fork))
+    {
+      return svn_error_create(SVN_ERR_CL_ARG_PARSING_ERROR, NULL,
+               _("Option --shared-memory-cache is only valid in daemon "
+                 "mode with one process per connection"));
+    }
+
   if (run_mode == run_mode_inetd || run_mode == run_mode_tunnel)
     {
       apr_pool_t *connection_pool;
@@ -1295,6 +1316,11 @@ sub_main(int *exit_code, int argc, const char *argv[], apr_pool_t *pool)
       }
 
     svn_cache_config_set(&settings);
+
+    /* Create the cache before forking the connection processes such
+     * that they all share it. */
+    if (shared_memory_cache)
+      SVN_ERR(svn_cache_config_init_shared(pool));
   }
 
 #if APR_HAS_THREADS
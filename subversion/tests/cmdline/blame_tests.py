@@ -1059,6 +1059,51 @@ def blame_reverse_no_change(sbox):
                                      'blame', '-r5:3', sbox.ospath('iota'))
 
 
+def blame_concurrent_diffs(sbox):
+  "blame with concurrent diffs of revisions"
+
+  sbox.build()
+  wc_dir = sbox.wc_dir
+  iota = sbox.ospath('iota')
+
+  # r2 .. r13 each add a line, some of them also change or remove one.
+  lines = ["This is the file 'iota'.\n"]
+  for rev in range(2, 14):
+    lines.insert(rev % 3, 'line from r%d\n' % rev)
+    if rev % 4 == 0:
+      del lines[-1]
+    if rev % 5 == 0:
+      lines[0] = 'changed in r%d\n' % rev
+    svntest.main.file_write(iota, ''.join(lines))
+    sbox.simple_commit(message='r%d' % rev)
+
+  # And a local modification.
+  svntest.main.file_append(iota, 'local line\n')
+
+  exit_code, expected_output, err = svntest.main.run_svn(None, 'blame', iota)
+  if not expected_output[-1].endswith('local line\n'):
+    raise svntest.Failure("Unexpected blame of the local modification")
+
+  svntest.actions.run_and_verify_svn(expected_output, [],
+                                     'blame', iota,
+                                     '--config-option',
+                                     'config:working-copy:jobs=4')
+
+  exit_code, expected_output, err = svntest.main.run_svn(None, 'blame',
+                                                         '-g', '-r1:13',
+                                                         iota)
+  svntest.actions.run_and_verify_svn(expected_output, [],
+                                     'blame', '-g', '-r1:13', iota,
+                                     '--config-option',
+                                     'config:working-copy:jobs=4')
+
+  exit_code, expected_output, err = svntest.main.run_svn(None, 'blame',
+                                                         '-r13:1', iota)
+  svntest.actions.run_and_verify_svn(expected_output, [],
+                                     'blame', '-r13:1', iota,
+                                     '--config-option',
+                                     'config:working-copy:jobs=4')
+
 ########################################################################
 # Run the tests
 
@@ -1084,6 +1129,7 @@ test_list = [ None,
               blame_eol_handling,
               blame_youngest_to_oldest,
               blame_reverse_no_change,
+              blame_concurrent_diffs,
              ]
 
 if __name__ == '__main__':
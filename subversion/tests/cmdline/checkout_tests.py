@@ -1187,6 +1187,72 @@ def checkout_wc_from_drive(sbox):
 
 #----------------------------------------------------------------------
 
+def checkout_concurrent_file_install(sbox):
+  "checkout and update installing files concurrently"
+
+  sbox.build()
+  wc_dir = sbox.wc_dir
+
+  # Some files need translation or other special treatment.
+  sbox.simple_propset('svn:eol-style', 'CRLF', 'A/mu')
+  sbox.simple_propset('svn:keywords', 'Revision', 'A/D/gamma')
+  svntest.main.file_append(sbox.ospath('A/D/gamma'), '$Revision$\n')
+  sbox.simple_propset('svn:needs-lock', '*', 'iota')
+  sbox.simple_commit(message='props')
+
+  wc2_dir = sbox.add_wc_path('2')
+  expected_output = svntest.main.greek_state.copy()
+  expected_output.wc_dir = wc2_dir
+  expected_output.tweak(status='A ', contents=None)
+  expected_wc = svntest.main.greek_state.copy()
+  expected_wc.tweak('A/mu', contents="This is the file 'mu'.\r\n")
+  expected_wc.tweak('A/D/gamma',
+                    contents="This is the file 'gamma'.\n$Revision: 2 $\n")
+  svntest.actions.run_and_verify_checkout(sbox.repo_url, wc2_dir,
+                                          expected_output, expected_wc,
+                                          [],
+                                          '--config-option',
+                                          'config:working-copy:jobs=4')
+
+  # All file info was recorded, so nothing shows up as modified.
+  expected_status = svntest.actions.get_virginal_state(wc2_dir, 2)
+  svntest.actions.run_and_verify_status(wc2_dir, expected_status)
+  if os.access(os.path.join(wc2_dir, 'iota'), os.W_OK):
+    raise svntest.Failure("'iota' should be read-only")
+
+  # Now update the files in the second working copy.
+  for path in ['A/B/lambda', 'A/D/gamma', 'A/D/G/pi', 'A/D/G/rho',
+               'A/D/H/chi']:
+    svntest.main.file_append(sbox.ospath(path), 'more text\n')
+  sbox.simple_commit(message='more text')
+
+  expected_output = svntest.wc.State(wc2_dir, {
+    'A/B/lambda' : Item(status='U '),
+    'A/D/gamma'  : Item(status='U '),
+    'A/D/G/pi'   : Item(status='U '),
+    'A/D/G/rho'  : Item(status='U '),
+    'A/D/H/chi'  : Item(status='U '),
+    })
+  expected_wc.tweak('A/B/lambda',
+                    contents="This is the file 'lambda'.\nmore text\n")
+  expected_wc.tweak('A/D/gamma',
+                    contents="This is the file 'gamma'.\n$Revision: 3 $\n"
+                             "more text\n")
+  expected_wc.tweak('A/D/G/pi',
+                    contents="This is the file 'pi'.\nmore text\n")
+  expected_wc.tweak('A/D/G/rho',
+                    contents="This is the file 'rho'.\nmore text\n")
+  expected_wc.tweak('A/D/H/chi',
+                    contents="This is the file 'chi'.\nmore text\n")
+  expected_status = svntest.actions.get_virginal_state(wc2_dir, 3)
+  svntest.actions.run_and_verify_update(wc2_dir, expected_output,
+                                        expected_wc, expected_status,
+                                        [], False,
+                                        '--config-option',
+                                        'config:working-copy:jobs=4')
+
+#----------------------------------------------------------------------
+
 # list all tests here, starting with None:
 test_list = [ None,
               checkout_with_obstructions,
@@ -1202,7 +1268,8 @@ test_list = [ None,
               checkout_peg_rev,
               checkout_peg_rev_date,
               co_with_obstructing_local_adds,
-              checkout_wc_from_drive
+              checkout_wc_from_drive,
+              checkout_concurrent_file_install,
             ]
 
 if __name__ == "__main__":
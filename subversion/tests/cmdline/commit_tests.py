@@ -3146,6 +3146,60 @@ def commit_issue4722_checksum(sbox):
       fp.write('abcdefghijklmnopqrstuvwxyz')
   sbox.simple_commit()
 
+def commit_concurrent_txdeltas(sbox):
+  "commit with concurrent text delta computation"
+
+  sbox.build()
+  wc_dir = sbox.wc_dir
+
+  # Several files for the worker threads, some of them translated and
+  # one of them without a delta base.
+  for path in ['iota', 'A/mu', 'A/B/lambda', 'A/B/E/alpha', 'A/B/E/beta',
+               'A/D/gamma', 'A/D/G/pi', 'A/D/G/rho', 'A/D/G/tau',
+               'A/D/H/chi', 'A/D/H/omega', 'A/D/H/psi']:
+    svntest.main.file_append(sbox.ospath(path), 'more text\n' * 100)
+  sbox.simple_propset('svn:eol-style', 'CRLF', 'A/mu')
+  sbox.simple_propset('svn:keywords', 'Revision', 'A/D/gamma')
+  svntest.main.file_append(sbox.ospath('A/D/gamma'), '$Revision$\n')
+  svntest.main.file_write(sbox.ospath('A/new'), 'new file\n')
+  sbox.simple_add('A/new')
+
+  expected_output = svntest.wc.State(wc_dir, {
+    'iota'        : Item(verb='Sending'),
+    'A/mu'        : Item(verb='Sending'),
+    'A/B/lambda'  : Item(verb='Sending'),
+    'A/B/E/alpha' : Item(verb='Sending'),
+    'A/B/E/beta'  : Item(verb='Sending'),
+    'A/D/gamma'   : Item(verb='Sending'),
+    'A/D/G/pi'    : Item(verb='Sending'),
+    'A/D/G/rho'   : Item(verb='Sending'),
+    'A/D/G/tau'   : Item(verb='Sending'),
+    'A/D/H/chi'   : Item(verb='Sending'),
+    'A/D/H/omega' : Item(verb='Sending'),
+    'A/D/H/psi'   : Item(verb='Sending'),
+    'A/new'       : Item(verb='Adding'),
+    })
+  expected_status = svntest.actions.get_virginal_state(wc_dir, 2)
+  expected_status.add({
+    'A/new' : Item(status='  ', wc_rev=2),
+    })
+  svntest.actions.run_and_verify_commit(wc_dir, expected_output,
+                                        expected_status, [],
+                                        '--config-option',
+                                        'config:working-copy:jobs=4')
+
+  # The repository got the same contents as the working copy.
+  for path in ['iota', 'A/mu', 'A/D/gamma', 'A/D/H/psi', 'A/new']:
+    with open(sbox.ospath(path), 'rb') as fp:
+      expected = fp.read()
+    exit_code, actual, err = svntest.main.run_command(
+                               svntest.main.svn_binary, None, True, 'cat',
+                               sbox.repo_url + '/' + path)
+    if b''.join(actual).replace(b'\r\n', b'\n') \
+       != expected.replace(b'\r\n', b'\n').replace(b'$Revision$',
+                                                      b'$Revision: 2 $'):
+      raise svntest.Failure("Unexpected contents of '%s'" % path)
+
 @XFail()
 def commit_sees_tree_conflict_on_unversioned_path(sbox):
   "commit sees tree conflict on unversioned path"
@@ -3260,6 +3314,7 @@ test_list = [ None,
               commit_xml,
               commit_issue4722_checksum,
               commit_sees_tree_conflict_on_unversioned_path,
+              commit_concurrent_txdeltas,
              ]
 
 if __name__ == '__main__':
@@ -4058,6 +4058,297 @@ def build_repcache(sbox):
   if new_rep_cache != rep_cache:
     raise svntest.Failure
 
+def verify_concurrently(sbox):
+  "verify with multiple jobs"
+
+  sbox.build()
+  sbox.simple_append('iota', "Line.\n")
+  sbox.simple_commit(message='r2')
+  sbox.simple_propset('foo', 'bar', 'A/mu')
+  sbox.simple_commit(message='r3')
+  sbox.simple_copy('A/B', 'A/B2')
+  sbox.simple_commit(message='r4')
+
+  exit_code, expected_output, errput = \
+    svntest.main.run_svnadmin("verify", sbox.repo_dir)
+  if errput:
+    raise SVNUnexpectedStderr(errput)
+
+  # Output must be the same and in the same order as for a single job.
+  svntest.actions.run_and_verify_svnadmin(expected_output, [],
+                                          "verify", "--jobs", "3",
+                                          sbox.repo_dir)
+
+@SkipUnless(svntest.main.fs_has_pack)
+def pack_concurrently(sbox):
+  "pack with multiple jobs"
+
+  # Configure two files per shard to get multiple shards to pack.
+  sbox.build(create_wc=False)
+  patch_format(sbox.repo_dir, shard_size=2)
+
+  for i in range(2, 10):
+    svntest.actions.run_and_verify_svnmucc(None, [],
+                                           '-U', sbox.repo_url,
+                                           '-m', 'r%d' % i,
+                                           'mkdir', 'dir%d' % i)
+
+  if svntest.main.is_fs_type_fsfs and svntest.main.options.fsfs_packing:
+    # With --fsfs-packing, everything is already packed.
+    expected_output = None
+  else:
+    # Notifications must arrive in the same order as for a single job.
+    expected_output = ["Packing revisions in shard %d...done.\n" % i
+                       for i in range(0, 5)]
+
+  svntest.actions.run_and_verify_svnadmin(expected_output, [],
+                                          "pack", "--jobs", "3",
+                                          sbox.repo_dir)
+  svntest.actions.run_and_verify_svnadmin(None, [],
+                                          "verify", sbox.repo_dir)
+
+@SkipUnless(svntest.main.is_fs_type_fsfs)
+@SkipUnless(svntest.main.fs_has_pack)
+def fsfs_hotcopy_concurrently(sbox):
+  "hotcopy with multiple jobs"
+
+  # The progress output can be affected by the --fsfs-packing option.
+  if svntest.main.options.fsfs_packing:
+    raise svntest.Skip('fsfs packing set')
+
+  # Three files per shard.  Pack r0 to r8 and keep r9 to r13 unpacked.
+  sbox.build(create_wc=False, empty=True)
+  patch_format(sbox.repo_dir, shard_size=3)
+  for i in range(1, 14):
+    if i == 9:
+      svntest.actions.run_and_verify_svnadmin(None, [], 'pack',
+                                              sbox.repo_dir)
+    svntest.actions.run_and_verify_svnmucc(None, [],
+                                           '-U', sbox.repo_url,
+                                           '-m', 'r%d' % i,
+                                           'mkdir', 'dir-%d' % i)
+
+  # Progress must be reported in the same order as for a single job.
+  expected_output = [
+    "* Copied revisions from 0 to 2.\n",
+    "* Copied revisions from 3 to 5.\n",
+    "* Copied revisions from 6 to 8.\n",
+    ] + ["* Copied revision %d.\n" % i for i in range(9, 14)]
+
+  backup_dir, backup_url = sbox.add_repo_path('backup')
+  svntest.actions.run_and_verify_svnadmin(expected_output, [],
+                                          'hotcopy', '--jobs', '4',
+                                          sbox.repo_dir, backup_dir)
+  check_hotcopy_fsfs(sbox.repo_dir, backup_dir)
+
+  # Pack more revisions and add some on top, then update incrementally.
+  # r12 and r13 are already present in the destination.
+  svntest.actions.run_and_verify_svnadmin(None, [], 'pack', sbox.repo_dir)
+  for i in range(14, 17):
+    svntest.actions.run_and_verify_svnmucc(None, [],
+                                           '-U', sbox.repo_url,
+                                           '-m', 'r%d' % i,
+                                           'mkdir', 'dir-%d' % i)
+
+  expected_output = [
+    "* Copied revisions from 9 to 11.\n",
+    "* Copied revision 14.\n",
+    "* Copied revision 15.\n",
+    "* Copied revision 16.\n",
+    ]
+  svntest.actions.run_and_verify_svnadmin(expected_output, [],
+                                          'hotcopy', '--incremental',
+                                          '--jobs', '4',
+                                          sbox.repo_dir, backup_dir)
+  check_hotcopy_fsfs(sbox.repo_dir, backup_dir)
+
+def load_concurrently(sbox):
+  "load with multiple jobs"
+
+  sbox.build()
+  sbox.simple_append('iota', 'more text\n')
+  sbox.simple_propset('prop', 'value', 'A/mu')
+  sbox.simple_commit()
+  sbox.simple_copy('A/B', 'A/B2')
+  sbox.simple_rm('A/D/G')
+  sbox.simple_commit()
+
+  for deltas in ([], ['--deltas']):
+    _, dump, _ = svntest.actions.run_and_verify_svnadmin(None, [],
+                                                         'dump', '-q',
+                                                         sbox.repo_dir,
+                                                         *deltas)
+
+    # The loaded repository must match the original one.
+    sbox2 = sbox.clone_dependent()
+    sbox2.build(create_wc=False, empty=True)
+    load_and_verify_dumpstream(sbox2, None, [], None, False, dump,
+                               '--jobs', '2')
+
+    _, dump2, _ = svntest.actions.run_and_verify_svnadmin(None, [],
+                                                          'dump', '-q',
+                                                          sbox2.repo_dir,
+                                                          *deltas)
+    svntest.verify.compare_dump_files(None, None, dump, dump2)
+
+def dump_concurrently(sbox):
+  "dump with multiple jobs"
+
+  sbox.build()
+  for i in range(20):
+    sbox.simple_append('iota', 'line %d\n' % i)
+    sbox.simple_commit()
+  sbox.simple_copy('A/B', 'A/B2')
+  sbox.simple_commit()
+
+  for args in ([], ['--deltas'], ['-r', '5:HEAD'],
+               ['-r', '5:HEAD', '--incremental']):
+    _, expected, _ = svntest.actions.run_and_verify_svnadmin(None, [],
+                                                             'dump', '-q',
+                                                             sbox.repo_dir,
+                                                             *args)
+    _, actual, _ = svntest.actions.run_and_verify_svnadmin(None, [],
+                                                           'dump', '-q',
+                                                           '-j', '3',
+                                                           sbox.repo_dir,
+                                                           *args)
+    if expected != actual:
+      raise svntest.Failure('Concurrent dump differs from sequential one')
+
+def dump_split_size(sbox):
+  "dump --split-size"
+
+  sbox.build()
+  for i in range(3):
+    sbox.simple_append('iota', 'line %d\n' % i)
+    sbox.simple_commit()
+
+  # r5 copies from r1, which is in the first file only.
+  sbox.simple_copy('A', 'A_copy')
+  sbox.simple_commit()
+
+  # --split-size needs a target file name
+  svntest.actions.run_and_verify_svnadmin(None,
+                                          '.*--split-size.*requires.*--file',
+                                          'dump', '--split-size', '2',
+                                          sbox.repo_dir)
+
+  # References into previous files are no reason for warnings.
+  prefix = sbox.get_tempname('split-dump')
+  _, _, err = svntest.actions.run_and_verify_svnadmin(None, None,
+                                                      'dump', '--split-size',
+                                                      '2', '-F', prefix,
+                                                      sbox.repo_dir)
+  if [line for line in err if 'WARNING' in line]:
+    raise svntest.Failure('Unexpected warnings: %s' % ''.join(err))
+
+  # r0..r5 give three files with two revisions each.
+  files = [prefix + '.%04d' % i for i in range(3)]
+  if os.path.exists(prefix + '.0003'):
+    raise svntest.Failure('Unexpected dump file %s.0003' % prefix)
+
+  # Loading them in order must recreate the repository.
+  sbox2 = sbox.clone_dependent()
+  sbox2.build(create_wc=False, empty=True)
+  for f in files:
+    with open(f, 'rb') as fp:
+      svntest.actions.run_and_verify_load(sbox2.repo_dir, fp.readlines())
+
+  _, dump, _ = svntest.actions.run_and_verify_svnadmin(None, [],
+                                                       'dump', '-q',
+                                                       sbox.repo_dir)
+  _, dump2, _ = svntest.actions.run_and_verify_svnadmin(None, [],
+                                                        'dump', '-q',
+                                                        sbox2.repo_dir)
+  svntest.verify.compare_dump_files(None, None, dump, dump2)
+
+@SkipUnless(svntest.main.python_sqlite_can_read_without_rowid)
+def build_log_index(sbox):
+  "svnadmin build-log-index"
+
+  sbox.build()
+
+  expected_output = ["* Indexed revision 0.\n", "* Indexed revision 1.\n"]
+  svntest.actions.run_and_verify_svnadmin(expected_output, [],
+                                          "build-log-index", sbox.repo_dir)
+
+  # Commits keep the index up to date.
+  sbox.simple_append('A/mu', 'Changed.\n')
+  sbox.simple_commit(message='r2')
+  sbox.simple_copy('A', 'branch')
+  sbox.simple_commit(message='r3')
+
+  db = svntest.sqlite3.connect(os.path.join(sbox.repo_dir, 'log-index.db'))
+  indexed_rev = db.execute("SELECT revision FROM info").fetchall()
+  db.close()
+  if indexed_rev != [(3,)]:
+    raise svntest.Failure("Unexpected index revision %s" % indexed_rev)
+
+  # Log follows the copy through the index.
+  svntest.actions.run_and_verify_log_xml(
+    expected_log_attrs=[{'revision': '3'}, {'revision': '2'},
+                        {'revision': '1'}],
+    args=[sbox.repo_url + '/branch/mu'])
+
+@SkipUnless(svntest.main.python_sqlite_can_read_without_rowid)
+def log_index_after_restore(sbox):
+  "log index after restoring the repository"
+
+  sbox.build(create_wc=False)
+  svntest.actions.run_and_verify_svnadmin(None, [],
+                                          "build-log-index", sbox.repo_dir)
+
+  # Take a backup at r1, then index r2 and r3.
+  backup_dir = sbox.get_tempname()
+  svntest.actions.run_and_verify_svnadmin(None, [], "hotcopy",
+                                          sbox.repo_dir, backup_dir)
+  sbox.simple_repo_copy('A', 'branch')
+  sbox.simple_repo_copy('A/B', 'branch/B2')
+
+  # Restore the backup underneath the index and commit different r2 and r3.
+  shutil.rmtree(os.path.join(sbox.repo_dir, 'db'))
+  shutil.copytree(os.path.join(backup_dir, 'db'),
+                  os.path.join(sbox.repo_dir, 'db'))
+  sbox.simple_repo_copy('A/B', 'branch')
+  sbox.simple_repo_copy('A/D', 'branch/B2')
+
+  db = svntest.sqlite3.connect(os.path.join(sbox.repo_dir, 'log-index.db'))
+  indexed_rev = db.execute("SELECT revision FROM info").fetchall()
+  db.close()
+  if indexed_rev != [(3,)]:
+    raise svntest.Failure("Unexpected index revision %s" % indexed_rev)
+
+  # The index must describe the new revisions only.
+  svntest.actions.run_and_verify_log_xml(
+    expected_log_attrs=[{'revision': '2'}, {'revision': '1'}],
+    args=[sbox.repo_url + '/branch/lambda'])
+  svntest.actions.run_and_verify_log_xml(
+    expected_log_attrs=[{'revision': '3'}, {'revision': '1'}],
+    args=[sbox.repo_url + '/branch/B2/gamma'])
+
+def log_index_after_date_change(sbox):
+  "log index after changing svn:date"
+
+  sbox.build(create_wc=False)
+  svntest.actions.run_and_verify_svnadmin(None, [],
+                                          "build-log-index", sbox.repo_dir)
+
+  # svnsync and admins change the dates of indexed revisions.
+  date = '2001-02-03T04:05:06.000000Z'
+  date_file = sbox.get_tempname()
+  svntest.main.file_write(date_file, date)
+  svntest.actions.run_and_verify_svnadmin(None, [], "setrevprop",
+                                          sbox.repo_dir, "-r1", "svn:date",
+                                          date_file)
+
+  # The index must still recognize r1.
+  db = svntest.sqlite3.connect(os.path.join(sbox.repo_dir, 'log-index.db'))
+  indexed_date = db.execute("SELECT date FROM revisions "
+                            "WHERE revision = 1").fetchall()
+  db.close()
+  if indexed_date != [(date,)]:
+    raise svntest.Failure("Unexpected indexed date %s" % indexed_date)
+
 
 ########################################################################
 # Run the tests
@@ -4139,6 +4430,15 @@ test_list = [ None,
               dump_include_copied_directory,
               load_normalize_node_props,
               build_repcache,
+              verify_concurrently,
+              pack_concurrently,
+              fsfs_hotcopy_concurrently,
+              load_concurrently,
+              dump_concurrently,
+              dump_split_size,
+              build_log_index,
+              log_index_after_restore,
+              log_index_after_date_change,
              ]
 
 if __name__ == '__main__':
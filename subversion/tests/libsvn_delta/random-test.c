@@ -36,6 +36,7 @@
 #include "svn_delta.h"
 #include "svn_pools.h"
 #include "svn_error.h"
+#include "svn_string.h"
 
 #include "../../libsvn_delta/delta.h"
 #include "delta-window-test.h"
@@ -605,6 +606,96 @@ random_txdelta_to_svndiff_stream_test(apr_pool_t *pool)
   return err;
 }
 
+/* Generate a SIZE bytes source text in SOURCE and a TARGET text that
+   differs from it by small random edits every few KB, using SEED.
+   Allocate both in POOL. */
+static void
+generate_xdelta_texts(svn_stringbuf_t **source,
+                      svn_stringbuf_t **target,
+                      apr_size_t size,
+                      apr_uint32_t seed,
+                      apr_pool_t *pool)
+{
+  apr_size_t i;
+
+  *source = svn_stringbuf_create_ensure(size, pool);
+  for (i = 0; i < size; ++i)
+    svn_stringbuf_appendbyte(*source, (char)svn_test_rand(&seed));
+
+  *target = svn_stringbuf_create_ensure(size + size / 64, pool);
+  for (i = 0; i < size; )
+    {
+      apr_size_t chunk = 1024 + svn_test_rand(&seed) % 8192;
+      apr_size_t edit = svn_test_rand(&seed) % 16;
+
+      if (chunk > size - i)
+        chunk = size - i;
+
+      svn_stringbuf_appendbytes(*target, (*source)->data + i, chunk);
+      while (edit--)
+        svn_stringbuf_appendbyte(*target, (char)svn_test_rand(&seed));
+
+      i += chunk + svn_test_rand(&seed) % 16;
+    }
+}
+
+/* Compute the delta for SOURCE -> TARGET and return the number of
+   windows produced in *WINDOW_COUNT.  Use POOL for temporaries. */
+static svn_error_t *
+run_xdelta(int *window_count,
+           svn_stringbuf_t *source,
+           svn_stringbuf_t *target,
+           apr_pool_t *pool)
+{
+  svn_txdelta_stream_t *delta_stream;
+  svn_txdelta_window_t *window;
+  apr_pool_t *iterpool = svn_pool_create(pool);
+
+  svn_txdelta2(&delta_stream,
+               svn_stream_from_stringbuf(source, pool),
+               svn_stream_from_stringbuf(target, pool),
+               FALSE, pool);
+
+  *window_count = 0;
+  do
+    {
+      svn_pool_clear(iterpool);
+      SVN_ERR(svn_txdelta_next_window(&window, delta_stream, iterpool));
+      if (window)
+        ++*window_count;
+    }
+  while (window);
+
+  svn_pool_destroy(iterpool);
+  return SVN_NO_ERROR;
+}
+
+/* Measure the xdelta throughput for large, mostly similar texts. */
+static svn_error_t *
+xdelta_performance_test(apr_pool_t *pool)
+{
+  enum { TEXT_SIZE = 64 * 1024 * 1024, REPEAT = 4 };
+
+  svn_stringbuf_t *source, *target;
+  apr_time_t start, end;
+  int window_count = 0;
+  int k;
+
+  generate_xdelta_texts(&source, &target, TEXT_SIZE, 0x5eed, pool);
+
+  start = apr_time_now();
+  for (k = 0; k < REPEAT; ++k)
+    SVN_ERR(run_xdelta(&window_count, source, target, pool));
+  end = apr_time_now();
+
+  printf("%d windows, %"APR_TIME_T_FMT" musecs\n", window_count,
+         end - start);
+  printf("%.1f MB/s\n",
+         (double)target->len * REPEAT / (double)(end - start + 1));
+
+  return SVN_NO_ERROR;
+}
+
 /* Change to 1 to enable the unit test for the delta combiner's range index: */
 #if 0
 #include "range-index-test.h"
@@ -625,6 +716,8 @@ static struct svn_test_descriptor_t test_funcs[] =
                    "random combine delta test"),
     SVN_TEST_PASS2(random_txdelta_to_svndiff_stream_test,
                    "random txdelta to svndiff stream test"),
+    SVN_TEST_SKIP2(xdelta_performance_test, TRUE,
+                   "optional xdelta performance test"),
 #ifdef SVN_RANGE_INDEX_TEST_H
     SVN_TEST_PASS2(random_range_index_test,
                    "random range index test"),
@@ -27,6 +27,7 @@
 #include "svn_diff.h"
 #include "svn_pools.h"
 #include "svn_utf.h"
+#include "private/svn_diff_private.h"
 
 /* Used to terminate lines in large multi-line string literals. */
 #define NL APR_EOL_STR
@@ -3065,6 +3066,620 @@ three_way_double_add(apr_pool_t *pool)
   return SVN_NO_ERROR;
 }
 
+/* Implements svn_diff_output_fns_t.output_diff_modified, appending a
+   description of the range to the svn_stringbuf_t BATON. */
+static svn_error_t *
+describe_modified(void *baton,
+                  apr_off_t original_start,
+                  apr_off_t original_length,
+                  apr_off_t modified_start,
+                  apr_off_t modified_length,
+                  apr_off_t latest_start,
+                  apr_off_t latest_length)
+{
+  svn_stringbuf_t *description = baton;
+
+  svn_stringbuf_appendcstr(description,
+                           apr_psprintf(description->pool,
+                                        "%" APR_OFF_T_FMT ",%" APR_OFF_T_FMT
+                                        ":%" APR_OFF_T_FMT ",%" APR_OFF_T_FMT
+                                        " ",
+                                        original_start, original_length,
+                                        modified_start, modified_length));
+  return SVN_NO_ERROR;
+}
+
+/* Verify that diffing ORIGINAL and MODIFIED tokenized with
+   svn_diff__tokens_create() finds the same changes as
+   svn_diff_mem_string_diff() with OPTIONS. */
+static svn_error_t *
+verify_tokens_diff(const char *original,
+                   const char *modified,
+                   const svn_diff_file_options_t *options,
+                   apr_pool_t *pool)
+{
+  svn_diff_output_fns_t output_fns = { NULL };
+  svn_string_t *original_str = svn_string_create(original, pool);
+  svn_string_t *modified_str = svn_string_create(modified, pool);
+  svn_diff__tokens_t *original_tokens;
+  svn_diff__tokens_t *modified_tokens;
+  svn_stringbuf_t *expected = svn_stringbuf_create_empty(pool);
+  svn_stringbuf_t *actual = svn_stringbuf_create_empty(pool);
+  svn_diff_t *diff;
+
+  output_fns.output_diff_modified = describe_modified;
+
+  SVN_ERR(svn_diff_mem_string_diff(&diff, original_str, modified_str,
+                                   options, pool));
+  SVN_ERR(svn_diff_output2(diff, expected, &output_fns, NULL, NULL));
+
+  SVN_ERR(svn_diff__tokens_create(&original_tokens, original_str, pool));
+  SVN_ERR(svn_diff__tokens_create(&modified_tokens, modified_str, pool));
+  SVN_ERR(svn_diff__tokens_diff(&diff, original_tokens, modified_tokens,
+                                options, pool));
+  SVN_ERR(svn_diff_output2(diff, actual, &output_fns, NULL, NULL));
+
+  SVN_TEST_STRING_ASSERT(actual->data, expected->data);
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+test_tokens_diff(apr_pool_t *pool)
+{
+  svn_diff_file_options_t *options = svn_diff_file_options_create(pool);
+  svn_stringbuf_t *long_original = svn_stringbuf_create_empty(pool);
+  svn_stringbuf_t *long_modified = svn_stringbuf_create_empty(pool);
+  int i;
+
+  SVN_ERR(verify_tokens_diff("", "", options, pool));
+  SVN_ERR(verify_tokens_diff("", "a\nb\n", options, pool));
+  SVN_ERR(verify_tokens_diff("a\nb\n", "", options, pool));
+  SVN_ERR(verify_tokens_diff("a\nb\nc\n", "a\nx\nc\n", options, pool));
+  SVN_ERR(verify_tokens_diff("a\nb\nc", "a\nb\nc\n", options, pool));
+  SVN_ERR(verify_tokens_diff("a\r\nb\rc\n", "a\nb\nc\n", options, pool));
+  SVN_ERR(verify_tokens_diff("a\nb\na\nb\n", "b\na\nb\na\n", options, pool));
+
+  /* A change in front of a long identical suffix. */
+  for (i = 0; i < 200; i++)
+    {
+      const char *line = apr_psprintf(pool, "line %d\n", i % 70);
+
+      svn_stringbuf_appendcstr(long_original, line);
+      svn_stringbuf_appendcstr(long_modified, i == 20 ? "changed\n" : line);
+    }
+  SVN_ERR(verify_tokens_diff(long_original->data, long_modified->data,
+                             options, pool));
+
+  options->ignore_eol_style = TRUE;
+  SVN_ERR(verify_tokens_diff("a\r\nb\rc\n", "a\nb\nc\n", options, pool));
+
+  options->ignore_space = svn_diff_file_ignore_space_all;
+  SVN_ERR(verify_tokens_diff("a b\n  c\nd\n", "ab\nc \ne\n", options, pool));
+
+  options->ignore_space = svn_diff_file_ignore_space_change;
+  SVN_ERR(verify_tokens_diff("a  b\nc\td\n", "a b\ncd\n", options, pool));
+
+  return SVN_NO_ERROR;
+}
+
+/* Check that diffing the tokenized ORIGINAL against MODIFIED with
+   OPTIONS finds the same changes as svn_diff_mem_string_diff() finds
+   between their texts ORIGINAL_STR and MODIFIED_STR. */
+static svn_error_t *
+check_tokens_reuse(svn_diff__tokens_t *original,
+                   svn_diff__tokens_t *modified,
+                   const svn_string_t *original_str,
+                   const svn_string_t *modified_str,
+                   const svn_diff_file_options_t *options,
+                   apr_pool_t *pool)
+{
+  svn_diff_output_fns_t output_fns = { NULL };
+  svn_stringbuf_t *expected = svn_stringbuf_create_empty(pool);
+  svn_stringbuf_t *actual = svn_stringbuf_create_empty(pool);
+  svn_diff_t *diff;
+
+  output_fns.output_diff_modified = describe_modified;
+
+  SVN_ERR(svn_diff_mem_string_diff(&diff, original_str, modified_str,
+                                   options, pool));
+  SVN_ERR(svn_diff_output2(diff, expected, &output_fns, NULL, NULL));
+
+  SVN_ERR(svn_diff__tokens_diff(&diff, original, modified, options, pool));
+  SVN_ERR(svn_diff_output2(diff, actual, &output_fns, NULL, NULL));
+
+  SVN_TEST_STRING_ASSERT(actual->data, expected->data);
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+test_tokens_reuse(apr_pool_t *pool)
+{
+  svn_diff_file_options_t *options = svn_diff_file_options_create(pool);
+  svn_string_t *original_str = svn_string_create("a b\r\nc\nd\n", pool);
+  svn_string_t *modified_str = svn_string_create("a  b\nc \ne\n", pool);
+  svn_diff__tokens_t *original;
+  svn_diff__tokens_t *modified;
+  apr_size_t size;
+
+  SVN_ERR(svn_diff__tokens_create(&original, original_str, pool));
+  SVN_ERR(svn_diff__tokens_create(&modified, modified_str, pool));
+
+  SVN_ERR(check_tokens_reuse(original, modified, original_str, modified_str,
+                             options, pool));
+  size = svn_diff__tokens_size(original);
+
+  /* Diffing again with the same options doesn't compute anything new. */
+  SVN_ERR(check_tokens_reuse(original, modified, original_str, modified_str,
+                             options, pool));
+  SVN_TEST_ASSERT(svn_diff__tokens_size(original) == size);
+
+  /* Other options reuse the line boundaries but normalize the lines. */
+  options->ignore_eol_style = TRUE;
+  SVN_ERR(check_tokens_reuse(original, modified, original_str, modified_str,
+                             options, pool));
+  SVN_TEST_ASSERT(svn_diff__tokens_size(original) > size);
+
+  options->ignore_space = svn_diff_file_ignore_space_change;
+  SVN_ERR(check_tokens_reuse(original, modified, original_str, modified_str,
+                             options, pool));
+
+  options->ignore_eol_style = FALSE;
+  options->ignore_space = svn_diff_file_ignore_space_all;
+  SVN_ERR(check_tokens_reuse(original, modified, original_str, modified_str,
+                             options, pool));
+
+  /* A text against itself. */
+  SVN_ERR(check_tokens_reuse(original, original, original_str, original_str,
+                             options, pool));
+
+  return SVN_NO_ERROR;
+}
+
+/* Check that svn_diff_file_diff_2() finds the same changes between
+   ORIGINAL and MODIFIED as svn_diff_mem_string_diff(), which doesn't
+   skip an identical prefix or suffix. */
+static svn_error_t *
+verify_prefix_suffix(const svn_stringbuf_t *original,
+                     const svn_stringbuf_t *modified,
+                     apr_pool_t *pool)
+{
+  svn_diff_file_options_t *options = svn_diff_file_options_create(pool);
+  svn_diff_output_fns_t output_fns = { NULL };
+  svn_stringbuf_t *expected = svn_stringbuf_create_empty(pool);
+  svn_stringbuf_t *actual = svn_stringbuf_create_empty(pool);
+  svn_diff_t *diff;
+
+  output_fns.output_diff_modified = describe_modified;
+
+  SVN_ERR(svn_diff_mem_string_diff(&diff,
+                                   svn_string_create(original->data, pool),
+                                   svn_string_create(modified->data, pool),
+                                   options, pool));
+  SVN_ERR(svn_diff_output2(diff, expected, &output_fns, NULL, NULL));
+
+  SVN_ERR(make_file("prefix-suffix-original", original->data, pool));
+  SVN_ERR(make_file("prefix-suffix-modified", modified->data, pool));
+  SVN_ERR(svn_diff_file_diff_2(&diff, "prefix-suffix-original",
+                               "prefix-suffix-modified", options, pool));
+  SVN_ERR(svn_diff_output2(diff, actual, &output_fns, NULL, NULL));
+  SVN_ERR(svn_io_remove_file2("prefix-suffix-original", FALSE, pool));
+  SVN_ERR(svn_io_remove_file2("prefix-suffix-modified", FALSE, pool));
+
+  SVN_TEST_STRING_ASSERT(actual->data, expected->data);
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+test_prefix_suffix_short_lines(apr_pool_t *pool)
+{
+  /* Lines shorter than a machine word, with all kinds of EOLs and
+     sometimes several EOLs in the same word. */
+  static const char *const lines[] =
+    { "a\n", "\n", "bc\n", "d\r\n", "\r\n", "e\r", "\r", "fghij\n",
+      "klmnopqrstuvwxyz\n", "\n\n" };
+  static const apr_size_t changes[][2] =
+    { { 0, 0 }, { 1, 1 }, { 700, 700 }, { 700, 1300 }, { 1998, 1999 } };
+  apr_size_t variant;
+
+  for (variant = 0; variant < 3; variant++)
+    {
+      apr_size_t change;
+
+      for (change = 0; change < sizeof(changes) / sizeof(changes[0]);
+           change++)
+        {
+          apr_pool_t *iterpool = svn_pool_create(pool);
+          svn_stringbuf_t *original = svn_stringbuf_create_empty(iterpool);
+          svn_stringbuf_t *modified = svn_stringbuf_create_empty(iterpool);
+          apr_size_t i;
+
+          for (i = 0; i < 2000; i++)
+            {
+              /* Variant 0 uses only LFs, variant 1 all lines above and
+                 variant 2 CRLFs instead of LFs. */
+              const char *line = lines[(i * 7) % (variant == 0 ? 3 : 10)];
+
+              if (variant == 2 && line[strlen(line) - 1] == '\n')
+                line = apr_pstrcat(iterpool,
+                                   apr_pstrndup(iterpool, line,
+                                                strlen(line) - 1),
+                                   "\r\n", SVN_VA_NULL);
+
+              svn_stringbuf_appendcstr(original, line);
+              svn_stringbuf_appendcstr(modified,
+                                       (i == changes[change][0]
+                                        || i == changes[change][1])
+                                       ? "changed\n" : line);
+            }
+
+          SVN_ERR(verify_prefix_suffix(original, modified, iterpool));
+          svn_pool_destroy(iterpool);
+        }
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Baton for check_common_lines() and check_modified_lines(). */
+typedef struct common_lines_baton_t
+{
+  /* The lines of the original and the modified text, without EOLs. */
+  apr_array_header_t *lines[2];
+
+  /* The number of lines of each text covered by the hunks so far. */
+  apr_off_t covered[2];
+
+  /* The number of lines found in both texts. */
+  apr_off_t common;
+} common_lines_baton_t;
+
+/* Return the lines of TEXT, which must end with a newline. */
+static apr_array_header_t *
+split_lines(const char *text,
+            apr_pool_t *pool)
+{
+  apr_array_header_t *lines = apr_array_make(pool, 16, sizeof(const char *));
+
+  while (*text)
+    {
+      const char *eol = strchr(text, '\n');
+
+      APR_ARRAY_PUSH(lines, const char *)
+        = apr_pstrndup(pool, text, eol - text);
+      text = eol + 1;
+    }
+
+  return lines;
+}
+
+/* Check that a hunk starting at ORIGINAL_START and MODIFIED_START follows
+   the previous one in both texts. */
+static svn_error_t *
+check_hunk_order(common_lines_baton_t *b,
+                 apr_off_t original_start, apr_off_t original_length,
+                 apr_off_t modified_start, apr_off_t modified_length)
+{
+  SVN_TEST_ASSERT(original_start == b->covered[0]);
+  SVN_TEST_ASSERT(modified_start == b->covered[1]);
+
+  b->covered[0] += original_length;
+  b->covered[1] += modified_length;
+
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_diff_output_fns_t.output_common. */
+static svn_error_t *
+check_common_lines(void *baton,
+                   apr_off_t original_start, apr_off_t original_length,
+                   apr_off_t modified_start, apr_off_t modified_length,
+                   apr_off_t latest_start, apr_off_t latest_length)
+{
+  common_lines_baton_t *b = baton;
+  apr_off_t i;
+
+  SVN_TEST_ASSERT(original_length == modified_length);
+  for (i = 0; i < original_length; i++)
+    SVN_TEST_STRING_ASSERT(APR_ARRAY_IDX(b->lines[0], original_start + i,
+                                         const char *),
+                           APR_ARRAY_IDX(b->lines[1], modified_start + i,
+                                         const char *));
+  b->common += original_length;
+
+  return check_hunk_order(b, original_start, original_length,
+                          modified_start, modified_length);
+}
+
+/* Implements svn_diff_output_fns_t.output_diff_modified. */
+static svn_error_t *
+check_modified_lines(void *baton,
+                     apr_off_t original_start, apr_off_t original_length,
+                     apr_off_t modified_start, apr_off_t modified_length,
+                     apr_off_t latest_start, apr_off_t latest_length)
+{
+  return check_hunk_order(baton, original_start, original_length,
+                          modified_start, modified_length);
+}
+
+/* Check that the hunks of DIFF, a diff of ORIGINAL against MODIFIED,
+   cover both texts in order and that the common hunks really are common,
+   and set *COMMON to the number of common lines. */
+static svn_error_t *
+check_diff_hunks(apr_off_t *common,
+                 svn_diff_t *diff,
+                 const char *original,
+                 const char *modified,
+                 apr_pool_t *pool)
+{
+  svn_diff_output_fns_t output_fns = { NULL };
+  common_lines_baton_t baton = { { NULL } };
+
+  output_fns.output_common = check_common_lines;
+  output_fns.output_diff_modified = check_modified_lines;
+  baton.lines[0] = split_lines(original, pool);
+  baton.lines[1] = split_lines(modified, pool);
+
+  SVN_ERR(svn_diff_output2(diff, &baton, &output_fns, NULL, NULL));
+
+  SVN_TEST_ASSERT(baton.covered[0] == baton.lines[0]->nelts);
+  SVN_TEST_ASSERT(baton.covered[1] == baton.lines[1]->nelts);
+  *common = baton.common;
+
+  return SVN_NO_ERROR;
+}
+
+/* Diff ORIGINAL against MODIFIED with the patience algorithm and check the
+   result with check_diff_hunks(). */
+static svn_error_t *
+verify_patience_diff(apr_off_t *common,
+                     const char *original,
+                     const char *modified,
+                     apr_pool_t *pool)
+{
+  svn_diff_file_options_t *options = svn_diff_file_options_create(pool);
+  svn_diff_t *diff;
+
+  options->algorithm = svn_diff_file_algorithm_patience;
+
+  SVN_ERR(svn_diff_mem_string_diff(&diff,
+                                   svn_string_create(original, pool),
+                                   svn_string_create(modified, pool),
+                                   options, pool));
+
+  return svn_error_trace(check_diff_hunks(common, diff, original, modified,
+                                          pool));
+}
+
+static svn_error_t *
+test_patience_diff(apr_pool_t *pool)
+{
+  svn_diff_file_options_t *options = svn_diff_file_options_create(pool);
+  apr_array_header_t *args = apr_array_make(pool, 1, sizeof(const char *));
+  svn_stringbuf_t *original = svn_stringbuf_create_empty(pool);
+  svn_stringbuf_t *modified = svn_stringbuf_create_empty(pool);
+  apr_off_t expected_common = 0;
+  apr_off_t common;
+  int i;
+
+  APR_ARRAY_PUSH(args, const char *) = "--patience";
+  SVN_ERR(svn_diff_file_options_parse(options, args, pool));
+  SVN_TEST_ASSERT(options->algorithm == svn_diff_file_algorithm_patience);
+
+  SVN_ERR(verify_patience_diff(&common, "", "", pool));
+  SVN_TEST_ASSERT(common == 0);
+  SVN_ERR(verify_patience_diff(&common, "a\nb\n", "", pool));
+  SVN_TEST_ASSERT(common == 0);
+  SVN_ERR(verify_patience_diff(&common, "a\nb\nc\n", "a\nx\nc\n", pool));
+  SVN_TEST_ASSERT(common == 2);
+
+  /* No line is unique, so everything is left to the LCS algorithm. */
+  SVN_ERR(verify_patience_diff(&common, "a\nb\na\nb\n", "b\na\nb\na\n",
+                               pool));
+  SVN_TEST_ASSERT(common == 3);
+
+  /* Two swapped functions. */
+  SVN_ERR(verify_patience_diff(&common,
+                               "int f()\n{\n  return 1;\n}\n\n"
+                               "int g()\n{\n  return 2;\n}\n",
+                               "int g()\n{\n  return 2;\n}\n\n"
+                               "int f()\n{\n  return 1;\n}\n",
+                               pool));
+
+  /* Unique lines with deletions, replacements and insertions, for which
+     there is only one longest common subsequence. */
+  for (i = 0; i < 3000; i++)
+    {
+      const char *line = apr_psprintf(pool, "line %d\n", i);
+
+      svn_stringbuf_appendcstr(original, line);
+      if (i % 89 == 0)
+        svn_stringbuf_appendcstr(modified,
+                                 apr_psprintf(pool, "new %d\n", i));
+      else if (i % 97 != 0)
+        {
+          svn_stringbuf_appendcstr(modified, line);
+          expected_common++;
+        }
+      if (i % 101 == 0)
+        svn_stringbuf_appendcstr(modified,
+                                 apr_psprintf(pool, "inserted %d\n", i));
+    }
+  SVN_ERR(verify_patience_diff(&common, original->data, modified->data,
+                               pool));
+  SVN_TEST_ASSERT(common == expected_common);
+
+  /* Unique lines between many repeated ones. */
+  svn_stringbuf_setempty(original);
+  svn_stringbuf_setempty(modified);
+  for (i = 0; i < 3000; i++)
+    {
+      const char *line = (i % 3 == 0) ? apr_psprintf(pool, "line %d\n", i)
+                                      : (i % 3 == 1) ? "}\n" : "\n";
+
+      svn_stringbuf_appendcstr(original, line);
+      if (i % 50 == 7)
+        svn_stringbuf_appendcstr(modified, "}\n");
+      else if (i % 70 != 0)
+        svn_stringbuf_appendcstr(modified, line);
+    }
+  SVN_ERR(verify_patience_diff(&common, original->data, modified->data,
+                               pool));
+
+  /* Merges use the algorithm as well. */
+  SVN_ERR(three_way_merge("patience1", "patience2", "patience3",
+                          "a\nb\nc\nd\ne\n",
+                          "a\nB\nc\nd\ne\n",
+                          "a\nb\nc\nd\nE\n",
+                          "a\nB\nc\nd\nE\n",
+                          options,
+                          svn_diff_conflict_display_modified_latest,
+                          pool));
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+test_memory_limited_diff(apr_pool_t *pool)
+{
+  svn_diff_file_options_t *options = svn_diff_file_options_create(pool);
+  svn_stringbuf_t *original = svn_stringbuf_create_empty(pool);
+  svn_stringbuf_t *modified = svn_stringbuf_create_empty(pool);
+  svn_stringbuf_t *unified = svn_stringbuf_create_empty(pool);
+  svn_diff_t *diff;
+  apr_off_t common;
+  int i;
+
+  /* 20000 lines with 5 changed ones and a long identical prefix and
+     suffix. */
+  for (i = 0; i < 20000; i++)
+    {
+      const char *line = apr_psprintf(pool, "%d,%d,%d\n", i, i % 7, i % 13);
+
+      svn_stringbuf_appendcstr(original, line);
+      svn_stringbuf_appendcstr(modified,
+                               (i % 4000 == 1000) ? "changed\n" : line);
+    }
+  SVN_ERR(make_file("memory-limit-original", original->data, pool));
+  SVN_ERR(make_file("memory-limit-modified", modified->data, pool));
+
+  /* Without a limit, every line is compared. */
+  SVN_ERR(svn_diff_file_diff_2(&diff, "memory-limit-original",
+                               "memory-limit-modified", options, pool));
+  SVN_ERR(check_diff_hunks(&common, diff, original->data, modified->data,
+                           pool));
+  SVN_TEST_ASSERT(common == 20000 - 5);
+
+  /* A limit far below what the lines need makes the diff compare blocks
+     of lines, so that it reports some unchanged lines as changed. */
+  options->memory_limit = 64 * 1024;
+  SVN_ERR(svn_diff_file_diff_2(&diff, "memory-limit-original",
+                               "memory-limit-modified", options, pool));
+  SVN_ERR(check_diff_hunks(&common, diff, original->data, modified->data,
+                           pool));
+  SVN_TEST_ASSERT(common < 20000 - 5);
+  SVN_TEST_ASSERT(common > 20000 / 2);
+
+  /* The result can be written as a unified diff. */
+  SVN_ERR(svn_diff_file_output_unified4(svn_stream_from_stringbuf(unified,
+                                                                  pool),
+                                        diff,
+                                        "memory-limit-original",
+                                        "memory-limit-modified",
+                                        NULL, NULL, SVN_APR_LOCALE_CHARSET,
+                                        NULL, FALSE, -1, NULL, NULL, pool));
+  SVN_TEST_ASSERT(strstr(unified->data, "\n+changed\n") != NULL);
+
+  /* A limit that the lines fit into changes nothing. */
+  options->memory_limit = 64 * 1024 * 1024;
+  SVN_ERR(svn_diff_file_diff_2(&diff, "memory-limit-original",
+                               "memory-limit-modified", options, pool));
+  SVN_ERR(check_diff_hunks(&common, diff, original->data, modified->data,
+                           pool));
+  SVN_TEST_ASSERT(common == 20000 - 5);
+
+  SVN_ERR(svn_io_remove_file2("memory-limit-original", FALSE, pool));
+  SVN_ERR(svn_io_remove_file2("memory-limit-modified", FALSE, pool));
+
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_diff_output_fns_t.output_common by adding the number of
+   common lines to the apr_off_t * BATON. */
+static svn_error_t *
+count_common_lines(void *baton,
+                   apr_off_t original_start, apr_off_t original_length,
+                   apr_off_t modified_start, apr_off_t modified_length,
+                   apr_off_t latest_start, apr_off_t latest_length)
+{
+  apr_off_t *common = baton;
+
+  *common += original_length;
+  return SVN_NO_ERROR;
+}
+
+/* Diff 20000 lines against lines written with FORMAT, which differ only
+   in white space or EOL style, plus 5 changed lines, with the diff option
+   ARG and a memory limit.  Check that the lines are still compared one by
+   one. */
+static svn_error_t *
+check_memory_limited_normalized_diff(const char *format,
+                                     const char *arg,
+                                     apr_pool_t *pool)
+{
+  svn_diff_file_options_t *options = svn_diff_file_options_create(pool);
+  apr_array_header_t *args = apr_array_make(pool, 3, sizeof(const char *));
+  svn_stringbuf_t *original = svn_stringbuf_create_empty(pool);
+  svn_stringbuf_t *modified = svn_stringbuf_create_empty(pool);
+  svn_diff_output_fns_t output_fns = { NULL };
+  svn_diff_t *diff;
+  apr_off_t common = 0;
+  int i;
+
+  APR_ARRAY_PUSH(args, const char *) = arg;
+  APR_ARRAY_PUSH(args, const char *) = "--memory-limit";
+  APR_ARRAY_PUSH(args, const char *) = "1";
+  SVN_ERR(svn_diff_file_options_parse(options, args, pool));
+  SVN_TEST_ASSERT(options->memory_limit == 1024 * 1024);
+
+  for (i = 0; i < 20000; i++)
+    {
+      svn_stringbuf_appendcstr(original,
+                               apr_psprintf(pool, "%d %d,%d\n",
+                                            i, i % 7, i % 13));
+      svn_stringbuf_appendcstr(modified,
+                               (i % 4000 == 1000)
+                                 ? "changed\n"
+                                 : apr_psprintf(pool, format,
+                                                i, i % 7, i % 13));
+    }
+  SVN_ERR(make_file("memory-limit-original", original->data, pool));
+  SVN_ERR(make_file("memory-limit-modified", modified->data, pool));
+
+  SVN_ERR(svn_diff_file_diff_2(&diff, "memory-limit-original",
+                               "memory-limit-modified", options, pool));
+  output_fns.output_common = count_common_lines;
+  SVN_ERR(svn_diff_output2(diff, &common, &output_fns, NULL, NULL));
+  SVN_TEST_ASSERT(common == 20000 - 5);
+
+  SVN_ERR(svn_io_remove_file2("memory-limit-original", FALSE, pool));
+  SVN_ERR(svn_io_remove_file2("memory-limit-modified", FALSE, pool));
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+test_memory_limited_diff_normalized(apr_pool_t *pool)
+{
+  SVN_ERR(check_memory_limited_normalized_diff("%d  %d,%d\n", "-b", pool));
+  SVN_ERR(check_memory_limited_normalized_diff("%d %d,%d\r\n",
+                                               "--ignore-eol-style", pool));
+
+  return SVN_NO_ERROR;
+}
+
 /* ========================================================================== */
 
 
@@ -3109,6 +3724,18 @@ static struct svn_test_descriptor_t test_funcs[] =
                    "2-way issue #3362 test v2"),
     SVN_TEST_XFAIL2(three_way_double_add,
                    "3-way merge, double add"),
+    SVN_TEST_PASS2(test_tokens_diff,
+                   "diff pre-tokenized texts"),
+    SVN_TEST_PASS2(test_tokens_reuse,
+                   "diff pre-tokenized texts with several options"),
+    SVN_TEST_PASS2(test_prefix_suffix_short_lines,
+                   "identical prefix and suffix of short lines"),
+    SVN_TEST_PASS2(test_patience_diff,
+                   "patience diff"),
+    SVN_TEST_PASS2(test_memory_limited_diff,
+                   "file diff with a memory limit"),
+    SVN_TEST_PASS2(test_memory_limited_diff_normalized,
+                   "memory limited diff ignoring white space or EOLs"),
     SVN_TEST_NULL
   };
 
@@ -191,7 +191,7 @@ create_packed_filesystem(const char *dir,
   /* Now pack the FS */
   pnb.expected_shard = 0;
   pnb.expected_action = svn_fs_pack_notify_start;
-  return svn_fs_pack(dir, pack_notify, &pnb, NULL, NULL, pool);
+  return svn_fs_pack2(dir, 1, pack_notify, &pnb, NULL, NULL, pool);
 }
 
 /* Create a packed FSFS filesystem for revprop tests at REPO_NAME with
@@ -226,7 +226,7 @@ prepare_revprop_repo(svn_fs_t **fs,
   svn_pool_destroy(subpool);
 
   /* Pack the repository. */
-  SVN_ERR(svn_fs_pack(repo_name, NULL, NULL, NULL, NULL, pool));
+  SVN_ERR(svn_fs_pack2(repo_name, 1, NULL, NULL, NULL, NULL, pool));
 
   return SVN_NO_ERROR;
 }
@@ -663,7 +663,7 @@ recover_fully_packed(const svn_test_opts_t *opts,
   SVN_ERR(svn_fs_commit_txn(&conflict, &after_rev, txn, subpool));
   SVN_TEST_ASSERT(SVN_IS_VALID_REVNUM(after_rev));
   svn_pool_destroy(subpool);
-  SVN_ERR(svn_fs_pack(REPO_NAME, NULL, NULL, NULL, NULL, pool));
+  SVN_ERR(svn_fs_pack2(REPO_NAME, 1, NULL, NULL, NULL, NULL, pool));
   SVN_ERR(svn_fs_recover(REPO_NAME, NULL, NULL, pool));
 
   /* Now, delete the youngest revprop file, and recover again.  This
@@ -1002,7 +1002,7 @@ upgrade_txns_to_log_addressing(const svn_test_opts_t *opts,
   /* Pack repo to verify that old and new shard get packed according to
      their respective addressing mode */
 
-  SVN_ERR(svn_fs_pack(repo_name, NULL, NULL, NULL, NULL, pool));
+  SVN_ERR(svn_fs_pack2(repo_name, 1, NULL, NULL, NULL, NULL, pool));
 
   /* verify that our changes got in */
 
@@ -1796,7 +1796,7 @@ pack_with_limited_memory(const svn_test_opts_t *opts,
 
       /* Pack it with a narrow memory budget. */
       SVN_ERR(svn_fs_open2(&fs, dir, NULL, iterpool, iterpool));
-      SVN_ERR(svn_fs_fs__pack(fs, max_mem, NULL, NULL, NULL, NULL,
+      SVN_ERR(svn_fs_fs__pack(fs, max_mem, 1, NULL, NULL, NULL, NULL,
                               iterpool));
 
       /* To be sure: Verify that we didn't break the repo. */
@@ -1812,6 +1812,57 @@ pack_with_limited_memory(const svn_test_opts_t *opts,
 #undef MAX_REV
 #undef SHARD_SIZE
 
+/* ------------------------------------------------------------------------ */
+/* Pack multiple shards concurrently and verify that notifications still
+   arrive in order and that the result is a valid, fully packed repo. */
+#define REPO_NAME "test-repo-pack-concurrently"
+#define SHARD_SIZE 3
+#define MAX_REV (11 * SHARD_SIZE + 1)
+static svn_error_t *
+pack_concurrently(const svn_test_opts_t *opts,
+                  apr_pool_t *pool)
+{
+  struct pack_notify_baton pnb;
+  svn_fs_t *fs;
+  svn_fs_root_t *root;
+  svn_stringbuf_t *contents;
+  svn_revnum_t rev;
+  apr_pool_t *iterpool;
+
+  SVN_ERR(create_non_packed_filesystem(REPO_NAME, opts, MAX_REV, SHARD_SIZE,
+                                       pool));
+
+  /* Use a small memory budget to exercise the per-job memory split. */
+  pnb.expected_shard = 0;
+  pnb.expected_action = svn_fs_pack_notify_start;
+  SVN_ERR(svn_fs_open2(&fs, REPO_NAME, NULL, pool, pool));
+  SVN_ERR(svn_fs_fs__pack(fs, 4000, 4, pack_notify, &pnb, NULL, NULL,
+                          pool));
+  SVN_TEST_ASSERT(pnb.expected_shard == (MAX_REV + 1) / SHARD_SIZE);
+  SVN_TEST_ASSERT(pnb.expected_action == svn_fs_pack_notify_start);
+
+  /* All contents must be accessible from a fresh FS instance. */
+  SVN_ERR(svn_fs_open2(&fs, REPO_NAME, NULL, pool, pool));
+  iterpool = svn_pool_create(pool);
+  for (rev = 2; rev <= MAX_REV; ++rev)
+    {
+      svn_pool_clear(iterpool);
+      SVN_ERR(svn_fs_revision_root(&root, fs, rev, iterpool));
+      SVN_ERR(svn_test__get_file_contents(root, "iota", &contents,
+                                          iterpool));
+      SVN_TEST_STRING_ASSERT(contents->data, get_rev_contents(rev, iterpool));
+    }
+  svn_pool_destroy(iterpool);
+
+  SVN_ERR(svn_fs_verify(REPO_NAME, NULL, 0, MAX_REV, NULL, NULL, NULL, NULL,
+                        pool));
+
+  return SVN_NO_ERROR;
+}
+#undef REPO_NAME
+#undef MAX_REV
+#undef SHARD_SIZE
+
 /* ------------------------------------------------------------------------ */
 
 #define REPO_NAME "test-repo-large_delta_against_plain"
@@ -1943,6 +1994,8 @@ static struct svn_test_descriptor_t test_funcs[] =
                        "pack with limited memory for metadata"),
     SVN_TEST_OPTS_PASS(large_delta_against_plain,
                        "large deltas against PLAIN, issue #4658"),
+    SVN_TEST_OPTS_PASS(pack_concurrently,
+                       "pack multiple shards concurrently"),
     SVN_TEST_NULL
   };
 
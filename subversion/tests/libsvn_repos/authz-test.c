@@ -25,6 +25,9 @@
 #include "svn_pools.h"
 #include "svn_iter.h"
 #include "svn_hash.h"
+#include "svn_dirent_uri.h"
+#include "svn_repos.h"
+#include "private/svn_sorts_private.h"
 #include "private/svn_subr_private.h"
 
 #include "../../libsvn_repos/authz.h"
@@ -511,6 +514,246 @@ reposful_reposless_stanzas_inherit(apr_pool_t *pool)
    return SVN_NO_ERROR;
 }
 
+/* Rules with nested, wildcard and user-specific path rules for the
+ * lookup tests below. */
+static const char lookup_rules[] =
+  "[groups]"                 NL
+  "dev = alice, bob, dave"   NL
+  ""                         NL
+  "[/]"                      NL
+  "* = r"                    NL
+  ""                         NL
+  "[/trunk]"                 NL
+  "@dev = rw"                NL
+  ""                         NL
+  "[/trunk/secret]"          NL
+  "* ="                      NL
+  "alice = r"                NL
+  ""                         NL
+  "[:glob:/trunk/**/private]" NL
+  "* ="                      NL
+  ""                         NL
+  "[:glob:/branches/*/doc]"  NL
+  "@dev = rw"                NL
+  "carol = rw"               NL
+  ;
+
+/* Paths to check against LOOKUP_RULES, in an order that makes lookups
+ * start at every kind of common ancestor of the previous path. */
+static const char *lookup_paths[] =
+  {
+    "/trunk/a/b",
+    "/trunk/a/c",
+    "/trunk/secret/x",
+    "/trunk/a/private",
+    "/trunk/secret",
+    "/branches/b1/doc/x",
+    "/branches/b1/src",
+    "/branches/b2/doc",
+    "/trunk/a/b/private/y",
+    "/trunk/a/b/c/d",
+    "/trunk",
+    "/tags/t/x",
+    "/trunk/a/b/c",
+    "/trunk//a/b",
+    "/",
+    NULL
+  };
+
+static svn_error_t *
+test_lookup_cache(apr_pool_t *pool)
+{
+  const char *users[] = { "alice", "bob", "carol", NULL };
+  const svn_repos_authz_access_t required[] =
+    {
+      svn_authz_read,
+      svn_authz_write,
+      svn_authz_write | svn_authz_recursive
+    };
+  apr_pool_t *iterpool = svn_pool_create(pool);
+  int u;
+
+  for (u = 0; u < sizeof(users) / sizeof(users[0]); ++u)
+    {
+      svn_authz_t *authz;
+      int pass;
+
+      SVN_ERR(svn_repos_authz_parse2(&authz,
+                                     svn_stream_from_string(
+                                       svn_string_create(lookup_rules, pool),
+                                       pool),
+                                     NULL, NULL, NULL, pool, pool));
+
+      /* Walk the paths forward and backward with the same AUTHZ and
+       * compare each result with that of a fresh instance. */
+      for (pass = 0; pass < 2; ++pass)
+        {
+          int count = sizeof(lookup_paths) / sizeof(lookup_paths[0]) - 1;
+          int i;
+
+          for (i = 0; i < count; ++i)
+            {
+              const char *path = lookup_paths[pass ? count - 1 - i : i];
+              int r;
+
+              for (r = 0; r < sizeof(required) / sizeof(required[0]); ++r)
+                {
+                  svn_authz_t *fresh;
+                  svn_boolean_t expected;
+                  svn_boolean_t access_granted;
+
+                  svn_pool_clear(iterpool);
+                  SVN_ERR(svn_repos_authz_parse2(&fresh,
+                            svn_stream_from_string(
+                              svn_string_create(lookup_rules, iterpool),
+                              iterpool),
+                            NULL, NULL, NULL, iterpool, iterpool));
+                  SVN_ERR(svn_repos_authz_check_access(fresh, "repo", path,
+                                                       users[u],
+                                                       required[r],
+                                                       &expected,
+                                                       iterpool));
+
+                  SVN_ERR(svn_repos_authz_check_access(authz, "repo", path,
+                                                       users[u],
+                                                       required[r],
+                                                       &access_granted,
+                                                       iterpool));
+                  if (access_granted != expected)
+                    return svn_error_createf(SVN_ERR_TEST_FAILED, NULL,
+                                             "Access %d for user '%s' on "
+                                             "'%s' is %d, expected %d",
+                                             required[r],
+                                             users[u] ? users[u] : "(null)",
+                                             path, access_granted, expected);
+                }
+            }
+        }
+    }
+
+  svn_pool_destroy(iterpool);
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+test_check_access_many(apr_pool_t *pool)
+{
+  const char *users[] = { "alice", "carol", NULL };
+  apr_array_header_t *paths = apr_array_make(pool, 16, sizeof(const char *));
+  apr_array_header_t *sorted;
+  int u;
+  int i;
+
+  for (i = 0; lookup_paths[i]; ++i)
+    APR_ARRAY_PUSH(paths, const char *) = lookup_paths[i];
+
+  sorted = apr_array_copy(pool, paths);
+  svn_sort__array(sorted, svn_sort_compare_paths);
+
+  for (u = 0; u < sizeof(users) / sizeof(users[0]); ++u)
+    {
+      svn_authz_t *authz;
+      int k;
+
+      SVN_ERR(svn_repos_authz_parse2(&authz,
+                                     svn_stream_from_string(
+                                       svn_string_create(lookup_rules, pool),
+                                       pool),
+                                     NULL, NULL, NULL, pool, pool));
+
+      /* Batch results must match single lookups, in any order. */
+      for (k = 0; k < 2; ++k)
+        {
+          apr_array_header_t *batch = k ? sorted : paths;
+          svn_boolean_t *granted = apr_pcalloc(pool, batch->nelts
+                                                     * sizeof(*granted));
+
+          SVN_ERR(svn_repos_authz_check_access_many(authz, "repo", batch,
+                                                    users[u],
+                                                    svn_authz_write,
+                                                    granted, pool));
+          for (i = 0; i < batch->nelts; ++i)
+            {
+              const char *path = APR_ARRAY_IDX(batch, i, const char *);
+              svn_boolean_t expected;
+
+              SVN_ERR(svn_repos_authz_check_access(authz, "repo", path,
+                                                   users[u], svn_authz_write,
+                                                   &expected, pool));
+              if (granted[i] != expected)
+                return svn_error_createf(SVN_ERR_TEST_FAILED, NULL,
+                                         "Write access for user '%s' on "
+                                         "'%s' is %d, expected %d",
+                                         users[u] ? users[u] : "(null)",
+                                         path, granted[i], expected);
+            }
+        }
+    }
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+test_shared_user_trees(apr_pool_t *pool)
+{
+  const char *users[] = { "alice", "bob", "dave", "carol", "alice" };
+  const svn_boolean_t can_read_secret[] = { TRUE, FALSE, FALSE, FALSE, TRUE };
+  const svn_boolean_t can_write_doc[] = { TRUE, TRUE, TRUE, TRUE, TRUE };
+  const svn_boolean_t can_write_trunk[] = { TRUE, TRUE, TRUE, FALSE, TRUE };
+  const char *sandbox;
+  const char *rules_path;
+  svn_authz_t *shared_authz;
+  int i;
+
+  /* Enable the filtered tree caches.  They must outlive this test. */
+  SVN_ERR(svn_repos_authz_initialize(svn_pool_create(NULL)));
+
+  SVN_ERR(svn_test_make_sandbox_dir(&sandbox, "authz-shared-trees", pool));
+  rules_path = svn_dirent_join(sandbox, "authz", pool);
+  SVN_ERR(svn_io_file_create(rules_path, lookup_rules, pool));
+
+  /* Users with the same rules (bob and dave) may share a filtered tree
+   * while the others must get trees of their own.  Check with a new
+   * authz instance for every user as well as with one instance that is
+   * reused for all of them. */
+  SVN_ERR(svn_repos_authz_read4(&shared_authz, rules_path, NULL, TRUE,
+                                NULL, NULL, NULL, pool, pool));
+  for (i = 0; i < sizeof(users) / sizeof(users[0]); ++i)
+    {
+      svn_authz_t *authz;
+      int k;
+
+      SVN_ERR(svn_repos_authz_read4(&authz, rules_path, NULL, TRUE, NULL,
+                                    NULL, NULL, pool, pool));
+
+      for (k = 0; k < 2; ++k)
+        {
+          svn_authz_t *current = k ? shared_authz : authz;
+          svn_boolean_t access_granted;
+
+          SVN_ERR(svn_repos_authz_check_access(current, "repo",
+                                               "/trunk/secret/x", users[i],
+                                               svn_authz_read,
+                                               &access_granted, pool));
+          SVN_TEST_ASSERT(access_granted == can_read_secret[i]);
+
+          SVN_ERR(svn_repos_authz_check_access(current, "repo",
+                                               "/branches/b1/doc", users[i],
+                                               svn_authz_write,
+                                               &access_granted, pool));
+          SVN_TEST_ASSERT(access_granted == can_write_doc[i]);
+
+          SVN_ERR(svn_repos_authz_check_access(current, "repo",
+                                               "/trunk/a", users[i],
+                                               svn_authz_write,
+                                               &access_granted, pool));
+          SVN_TEST_ASSERT(access_granted == can_write_trunk[i]);
+        }
+    }
+
+  return SVN_NO_ERROR;
+}
+
 static int max_threads = 4;
 
 static struct svn_test_descriptor_t test_funcs[] =
@@ -524,6 +767,12 @@ static struct svn_test_descriptor_t test_funcs[] =
                    "issue 4741 groups"),
     SVN_TEST_XFAIL2(reposful_reposless_stanzas_inherit,
                     "[foo:/] inherits [/]"),
+    SVN_TEST_PASS2(test_lookup_cache,
+                   "test lookups resuming at common ancestors"),
+    SVN_TEST_PASS2(test_shared_user_trees,
+                   "test filtered trees shared between users"),
+    SVN_TEST_PASS2(test_check_access_many,
+                   "test svn_repos_authz_check_access_many"),
     SVN_TEST_NULL
   };
 
@@ -76,8 +76,8 @@ test_dump_bad_props(svn_stringbuf_t **dump_data_p,
   SVN_TEST_ASSERT(SVN_IS_VALID_REVNUM(youngest_rev));
 
   /* Test that a dump completes without error. */
-  SVN_ERR(svn_repos_dump_fs4(repos, stream, start_rev, end_rev,
-                             FALSE, FALSE, TRUE, TRUE,
+  SVN_ERR(svn_repos_dump_fs5(repos, stream, start_rev, end_rev,
+                             FALSE, FALSE, TRUE, TRUE, 1,
                              notify_func, notify_baton,
                              NULL, NULL, NULL, NULL,
                              pool));
@@ -120,7 +120,7 @@ test_load_bad_props(svn_stringbuf_t *dump_data,
   svn_revnum_t youngest_rev;
   svn_string_t *loaded_prop_val;
 
-  SVN_ERR(svn_repos_load_fs6(repos, stream,
+  SVN_ERR(svn_repos_load_fs7(repos, stream,
                              SVN_INVALID_REVNUM, SVN_INVALID_REVNUM,
                              svn_repos_load_uuid_default,
                              parent_fspath,
@@ -128,6 +128,7 @@ test_load_bad_props(svn_stringbuf_t *dump_data,
                              validate_props,
                              FALSE /*ignore_dates*/,
                              FALSE /*normalize_props*/,
+                             1 /*jobs*/,
                              notify_func, notify_baton,
                              NULL, NULL, /*cancellation*/
                              pool));
@@ -273,6 +274,238 @@ test_load_r0_mergeinfo(const svn_test_opts_t *opts,
   return SVN_NO_ERROR;
 }
 
+/* Create a few revisions in the empty repository REPOS that exercise all
+ * kinds of dump records, including a file larger than the pipeline's
+ * batch size. */
+static svn_error_t *
+create_load_test_revisions(svn_repos_t *repos,
+                           apr_pool_t *pool)
+{
+  svn_fs_t *fs = svn_repos_fs(repos);
+  svn_fs_txn_t *txn;
+  svn_fs_root_t *txn_root, *rev_root;
+  svn_revnum_t youngest_rev = 0;
+  svn_stringbuf_t *contents = svn_stringbuf_create_empty(pool);
+  int i;
+
+  for (i = 0; i < 100000; ++i)
+    svn_stringbuf_appendcstr(contents,
+                             apr_psprintf(pool, "line %d of big file\n", i));
+
+  /* r1: add a directory and a big file */
+  SVN_ERR(svn_fs_begin_txn2(&txn, fs, youngest_rev, 0, pool));
+  SVN_ERR(svn_fs_txn_root(&txn_root, txn, pool));
+  SVN_ERR(svn_fs_make_dir(txn_root, "A", pool));
+  SVN_ERR(svn_fs_make_file(txn_root, "A/big", pool));
+  SVN_ERR(svn_test__set_file_contents(txn_root, "A/big", contents->data,
+                                      pool));
+  SVN_ERR(svn_fs_change_node_prop(txn_root, "A", "prop",
+                                  svn_string_create("value", pool), pool));
+  SVN_ERR(svn_repos_fs_commit_txn(NULL, repos, &youngest_rev, txn, pool));
+
+  /* r2: modify the file, copy the directory, change a property */
+  svn_stringbuf_appendcstr(contents, "one more line\n");
+  SVN_ERR(svn_fs_begin_txn2(&txn, fs, youngest_rev, 0, pool));
+  SVN_ERR(svn_fs_txn_root(&txn_root, txn, pool));
+  SVN_ERR(svn_test__set_file_contents(txn_root, "A/big", contents->data,
+                                      pool));
+  SVN_ERR(svn_fs_change_node_prop(txn_root, "A", "prop", NULL, pool));
+  SVN_ERR(svn_fs_revision_root(&rev_root, fs, youngest_rev, pool));
+  SVN_ERR(svn_fs_copy(rev_root, "A", txn_root, "B", pool));
+  SVN_ERR(svn_fs_make_file(txn_root, "A/small", pool));
+  SVN_ERR(svn_test__set_file_contents(txn_root, "A/small", "small\n",
+                                      pool));
+  SVN_ERR(svn_repos_fs_commit_txn(NULL, repos, &youngest_rev, txn, pool));
+
+  /* r3: delete the big file */
+  SVN_ERR(svn_fs_begin_txn2(&txn, fs, youngest_rev, 0, pool));
+  SVN_ERR(svn_fs_txn_root(&txn_root, txn, pool));
+  SVN_ERR(svn_fs_delete(txn_root, "A/big", pool));
+  SVN_ERR(svn_repos_fs_commit_txn(NULL, repos, &youngest_rev, txn, pool));
+
+  return SVN_NO_ERROR;
+}
+
+/* Dump revisions START_REV to END_REV of REPOS into *DUMP_DATA, using
+ * deltas if USE_DELTAS is set and up to JOBS threads. */
+static svn_error_t *
+dump_range(svn_stringbuf_t **dump_data,
+           svn_repos_t *repos,
+           svn_revnum_t start_rev,
+           svn_revnum_t end_rev,
+           svn_boolean_t incremental,
+           svn_boolean_t use_deltas,
+           int jobs,
+           apr_pool_t *pool)
+{
+  svn_stream_t *stream;
+
+  *dump_data = svn_stringbuf_create_empty(pool);
+  stream = svn_stream_from_stringbuf(*dump_data, pool);
+  SVN_ERR(svn_repos_dump_fs5(repos, stream, start_rev, end_rev,
+                             incremental, use_deltas, TRUE, TRUE, jobs,
+                             NULL, NULL, NULL, NULL, NULL, NULL, pool));
+
+  return svn_error_trace(svn_stream_close(stream));
+}
+
+/* Dump all of REPOS into *DUMP_DATA, using deltas if USE_DELTAS is set. */
+static svn_error_t *
+dump_repos(svn_stringbuf_t **dump_data,
+           svn_repos_t *repos,
+           svn_boolean_t use_deltas,
+           apr_pool_t *pool)
+{
+  return svn_error_trace(dump_range(dump_data, repos, SVN_INVALID_REVNUM,
+                                    SVN_INVALID_REVNUM, FALSE, use_deltas,
+                                    1, pool));
+}
+
+/* Load a dump of REPOS with or without deltas, with JOBS > 1, and verify
+ * that the result is the same as the original repository. */
+static svn_error_t *
+test_load_pipelined(const svn_test_opts_t *opts,
+                    apr_pool_t *pool)
+{
+  svn_repos_t *repos;
+  int use_deltas;
+
+  SVN_ERR(svn_test__create_repos(&repos, "test-repo-load-pipelined",
+                                 opts, pool));
+  SVN_ERR(create_load_test_revisions(repos, pool));
+
+  for (use_deltas = 0; use_deltas < 2; ++use_deltas)
+    {
+      svn_repos_t *loaded_repos;
+      svn_stringbuf_t *dump_data, *loaded_dump_data;
+      svn_stream_t *stream;
+      const char *name = apr_psprintf(pool, "test-repo-load-pipelined-%d",
+                                      use_deltas);
+
+      SVN_ERR(dump_repos(&dump_data, repos, use_deltas, pool));
+      SVN_ERR(svn_test__create_repos(&loaded_repos, name, opts, pool));
+      stream = svn_stream_from_stringbuf(dump_data, pool);
+      SVN_ERR(svn_repos_load_fs7(loaded_repos, stream,
+                                 SVN_INVALID_REVNUM, SVN_INVALID_REVNUM,
+                                 svn_repos_load_uuid_force, NULL,
+                                 FALSE, FALSE, /*use_*_commit_hook*/
+                                 TRUE /*validate_props*/,
+                                 FALSE /*ignore_dates*/,
+                                 FALSE /*normalize_props*/,
+                                 2 /*jobs*/,
+                                 NULL, NULL, NULL, NULL, pool));
+
+      SVN_ERR(dump_repos(&loaded_dump_data, loaded_repos, use_deltas, pool));
+      SVN_TEST_ASSERT(svn_stringbuf_compare(dump_data, loaded_dump_data));
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Verify that a parse error in the pipelined load is reported and that
+ * all revisions before the broken one have been committed. */
+static svn_error_t *
+test_load_pipelined_error(const svn_test_opts_t *opts,
+                          apr_pool_t *pool)
+{
+  svn_repos_t *repos, *loaded_repos;
+  svn_stringbuf_t *dump_data;
+  svn_stream_t *stream;
+  svn_revnum_t youngest_rev;
+  const char *r2, *r3;
+  svn_error_t *err;
+
+  SVN_ERR(svn_test__create_repos(&repos, "test-repo-load-pipelined-err",
+                                 opts, pool));
+  SVN_ERR(create_load_test_revisions(repos, pool));
+  SVN_ERR(dump_repos(&dump_data, repos, FALSE, pool));
+
+  /* Truncate the dump in the middle of the big file text in r2. */
+  r2 = strstr(dump_data->data, "Revision-number: 2\n");
+  r3 = strstr(dump_data->data, "Revision-number: 3\n");
+  SVN_TEST_ASSERT(r2 && r3);
+  svn_stringbuf_remove(dump_data, (r2 - dump_data->data) + (r3 - r2) / 2,
+                       dump_data->len);
+
+  SVN_ERR(svn_test__create_repos(&loaded_repos,
+                                 "test-repo-load-pipelined-err-2",
+                                 opts, pool));
+  stream = svn_stream_from_stringbuf(dump_data, pool);
+  err = svn_repos_load_fs7(loaded_repos, stream,
+                           SVN_INVALID_REVNUM, SVN_INVALID_REVNUM,
+                           svn_repos_load_uuid_force, NULL,
+                           FALSE, FALSE, TRUE, FALSE, FALSE, 2,
+                           NULL, NULL, NULL, NULL, pool);
+  SVN_TEST_ASSERT_ANY_ERROR(err);
+
+  SVN_ERR(svn_fs_youngest_rev(&youngest_rev, svn_repos_fs(loaded_repos),
+                              pool));
+  SVN_TEST_ASSERT(youngest_rev == 1);
+
+  return SVN_NO_ERROR;
+}
+
+/* Verify that concurrent dumps of various ranges produce exactly the
+ * same output as sequential ones. */
+static svn_error_t *
+test_dump_concurrent(const svn_test_opts_t *opts,
+                     apr_pool_t *pool)
+{
+  svn_repos_t *repos;
+  svn_fs_t *fs;
+  svn_fs_txn_t *txn;
+  svn_fs_root_t *txn_root;
+  svn_revnum_t youngest_rev;
+  apr_pool_t *iterpool = svn_pool_create(pool);
+  int i;
+
+  SVN_ERR(svn_test__create_repos(&repos, "test-repo-dump-concurrent",
+                                 opts, pool));
+  SVN_ERR(create_load_test_revisions(repos, pool));
+
+  /* Add enough revisions to span several dump tasks. */
+  fs = svn_repos_fs(repos);
+  SVN_ERR(svn_fs_youngest_rev(&youngest_rev, fs, pool));
+  for (i = 0; i < 50; ++i)
+    {
+      const char *path;
+      svn_boolean_t is_file;
+
+      svn_pool_clear(iterpool);
+      path = apr_psprintf(iterpool, "B/file-%d", i % 7);
+      SVN_ERR(svn_fs_begin_txn2(&txn, fs, youngest_rev, 0, iterpool));
+      SVN_ERR(svn_fs_txn_root(&txn_root, txn, iterpool));
+      SVN_ERR(svn_fs_is_file(&is_file, txn_root, path, iterpool));
+      if (!is_file)
+        SVN_ERR(svn_fs_make_file(txn_root, path, iterpool));
+      SVN_ERR(svn_test__set_file_contents(txn_root, path,
+                                          apr_psprintf(iterpool,
+                                                       "change %d\n", i),
+                                          iterpool));
+      SVN_ERR(svn_repos_fs_commit_txn(NULL, repos, &youngest_rev, txn,
+                                      iterpool));
+    }
+
+  for (i = 0; i < 8; ++i)
+    {
+      svn_stringbuf_t *expected, *actual;
+      svn_boolean_t incremental = (i & 1) != 0;
+      svn_boolean_t use_deltas = (i & 2) != 0;
+      svn_revnum_t start_rev = (i & 4) ? 2 : 0;
+
+      svn_pool_clear(iterpool);
+      SVN_ERR(dump_range(&expected, repos, start_rev, youngest_rev,
+                         incremental, use_deltas, 1, iterpool));
+      SVN_ERR(dump_range(&actual, repos, start_rev, youngest_rev,
+                         incremental, use_deltas, 4, iterpool));
+      SVN_TEST_ASSERT(svn_stringbuf_compare(expected, actual));
+    }
+
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
+
 /* The test table.  */
 
 static int max_threads = 4;
@@ -284,6 +517,12 @@ static struct svn_test_descriptor_t test_funcs[] =
                        "test dumping with r0 mergeinfo"),
     SVN_TEST_OPTS_PASS(test_load_r0_mergeinfo,
                        "test loading with r0 mergeinfo"),
+    SVN_TEST_OPTS_PASS(test_load_pipelined,
+                       "test pipelined loading"),
+    SVN_TEST_OPTS_PASS(test_load_pipelined_error,
+                       "test pipelined loading of a broken dump"),
+    SVN_TEST_OPTS_PASS(test_dump_concurrent,
+                       "test concurrent dumping"),
     SVN_TEST_NULL
   };
 
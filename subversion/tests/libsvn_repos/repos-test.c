@@ -3512,6 +3512,224 @@ get_logs(const svn_test_opts_t *opts,
   return SVN_NO_ERROR;
 }
 
+/* Implements svn_repos_log_entry_receiver_t, appending the revision of
+   LOG_ENTRY to the svn_stringbuf_t * BATON. */
+static svn_error_t *
+log_entry_revs_receiver(void *baton,
+                        svn_repos_log_entry_t *log_entry,
+                        apr_pool_t *scratch_pool)
+{
+  svn_stringbuf_t *revs = baton;
+
+  svn_stringbuf_appendcstr(revs, apr_psprintf(scratch_pool, " %ld",
+                                              log_entry->revision));
+  return SVN_NO_ERROR;
+}
+
+/* Set *REVS to the revisions that svn_repos_get_logs5() reports for PATH
+   in REPOS from START to END, followed by the code of the error it fails
+   with, if any.  Allocate *REVS in POOL. */
+static svn_error_t *
+get_log_revs(const char **revs,
+             svn_repos_t *repos,
+             const char *path,
+             svn_revnum_t start,
+             svn_revnum_t end,
+             svn_boolean_t strict,
+             apr_pool_t *pool)
+{
+  apr_array_header_t *paths = apr_array_make(pool, 1, sizeof(const char *));
+  svn_stringbuf_t *buf = svn_stringbuf_create_empty(pool);
+  svn_error_t *err;
+
+  APR_ARRAY_PUSH(paths, const char *) = path;
+  err = svn_repos_get_logs5(repos, paths, start, end, 0, strict, FALSE,
+                            NULL, NULL, NULL, NULL, NULL,
+                            log_entry_revs_receiver, buf, pool);
+  if (err)
+    {
+      svn_stringbuf_appendcstr(buf, apr_psprintf(pool, " error %d",
+                                                 err->apr_err));
+      svn_error_clear(err);
+    }
+
+  *revs = buf->data;
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+test_log_index(const svn_test_opts_t *opts,
+               apr_pool_t *pool)
+{
+  static const char * const paths[] = {
+    "/A", "/A/mu", "/A/B/E/alpha", "/A/B/E", "/A/D/G/pi", "/iota",
+    "/branch", "/branch/mu", "/branch/B", "/branch/B/E/alpha",
+    "/branch/B/E/beta", "/branch/B/lambda", "/branch/new", "/", "/missing",
+    NULL
+  };
+  svn_repos_t *repos;
+  svn_fs_t *fs;
+  svn_fs_txn_t *txn;
+  svn_fs_root_t *txn_root, *rev_root;
+  svn_revnum_t youngest_rev = 0;
+  apr_hash_t *expected = apr_hash_make(pool);
+  apr_pool_t *subpool = svn_pool_create(pool);
+  const char *index_path;
+  const char *backup_path;
+  const char *revs;
+  svn_node_kind_t kind;
+  svn_revnum_t start, end;
+  int i, strict, pass;
+
+  SVN_ERR(svn_test__create_repos(&repos, "test-repo-log-index",
+                                 opts, pool));
+  fs = svn_repos_fs(repos);
+
+  /* Revision 1:  Add the Greek tree. */
+  SVN_ERR(svn_fs_begin_txn(&txn, fs, youngest_rev, subpool));
+  SVN_ERR(svn_fs_txn_root(&txn_root, txn, subpool));
+  SVN_ERR(svn_test__create_greek_tree(txn_root, subpool));
+  SVN_ERR(svn_repos_fs_commit_txn(NULL, repos, &youngest_rev, txn, subpool));
+  svn_pool_clear(subpool);
+
+  /* Revision 2:  Tweak A/mu and A/B/E/alpha. */
+  SVN_ERR(svn_fs_begin_txn(&txn, fs, youngest_rev, subpool));
+  SVN_ERR(svn_fs_txn_root(&txn_root, txn, subpool));
+  SVN_ERR(svn_test__set_file_contents(txn_root, "A/mu",
+                                      "Revision 2", subpool));
+  SVN_ERR(svn_test__set_file_contents(txn_root, "A/B/E/alpha",
+                                      "Revision 2", subpool));
+  SVN_ERR(svn_repos_fs_commit_txn(NULL, repos, &youngest_rev, txn, subpool));
+  svn_pool_clear(subpool);
+
+  /* Revision 3:  Copy A to branch. */
+  SVN_ERR(svn_fs_begin_txn(&txn, fs, youngest_rev, subpool));
+  SVN_ERR(svn_fs_txn_root(&txn_root, txn, subpool));
+  SVN_ERR(svn_fs_revision_root(&rev_root, fs, youngest_rev, subpool));
+  SVN_ERR(svn_fs_copy(rev_root, "A", txn_root, "branch", subpool));
+  SVN_ERR(svn_repos_fs_commit_txn(NULL, repos, &youngest_rev, txn, subpool));
+  svn_pool_clear(subpool);
+
+  /* Revision 4:  Tweak branch/mu and add branch/new. */
+  SVN_ERR(svn_fs_begin_txn(&txn, fs, youngest_rev, subpool));
+  SVN_ERR(svn_fs_txn_root(&txn_root, txn, subpool));
+  SVN_ERR(svn_test__set_file_contents(txn_root, "branch/mu",
+                                      "Revision 4", subpool));
+  SVN_ERR(svn_fs_make_file(txn_root, "branch/new", subpool));
+  SVN_ERR(svn_repos_fs_commit_txn(NULL, repos, &youngest_rev, txn, subpool));
+  svn_pool_clear(subpool);
+
+  /* Revision 5:  Delete A/B/E/beta, tweak A/D/G/pi and A/B/E/alpha. */
+  SVN_ERR(svn_fs_begin_txn(&txn, fs, youngest_rev, subpool));
+  SVN_ERR(svn_fs_txn_root(&txn_root, txn, subpool));
+  SVN_ERR(svn_fs_delete(txn_root, "A/B/E/beta", subpool));
+  SVN_ERR(svn_test__set_file_contents(txn_root, "A/D/G/pi",
+                                      "Revision 5", subpool));
+  SVN_ERR(svn_test__set_file_contents(txn_root, "A/B/E/alpha",
+                                      "Revision 5", subpool));
+  SVN_ERR(svn_repos_fs_commit_txn(NULL, repos, &youngest_rev, txn, subpool));
+  svn_pool_clear(subpool);
+
+  /* Revision 6:  Replace branch/B with a copy of A/B@5. */
+  SVN_ERR(svn_fs_begin_txn(&txn, fs, youngest_rev, subpool));
+  SVN_ERR(svn_fs_txn_root(&txn_root, txn, subpool));
+  SVN_ERR(svn_fs_revision_root(&rev_root, fs, youngest_rev, subpool));
+  SVN_ERR(svn_fs_delete(txn_root, "branch/B", subpool));
+  SVN_ERR(svn_fs_copy(rev_root, "A/B", txn_root, "branch/B", subpool));
+  SVN_ERR(svn_repos_fs_commit_txn(NULL, repos, &youngest_rev, txn, subpool));
+  svn_pool_clear(subpool);
+
+  /* Build the index now, so that the remaining commits have to update
+     it. */
+  SVN_ERR(svn_repos_build_log_index(repos, NULL, NULL, NULL, NULL, pool));
+  index_path = svn_dirent_join(svn_repos_path(repos, pool), "log-index.db",
+                               pool);
+  backup_path = apr_pstrcat(pool, index_path, ".bak", SVN_VA_NULL);
+  SVN_ERR(svn_io_check_path(index_path, &kind, pool));
+  SVN_TEST_ASSERT(kind == svn_node_file);
+
+  /* Revision 7:  Tweak branch/B/E/alpha and set a property on branch. */
+  SVN_ERR(svn_fs_begin_txn(&txn, fs, youngest_rev, subpool));
+  SVN_ERR(svn_fs_txn_root(&txn_root, txn, subpool));
+  SVN_ERR(svn_test__set_file_contents(txn_root, "branch/B/E/alpha",
+                                      "Revision 7", subpool));
+  SVN_ERR(svn_fs_change_node_prop(txn_root, "branch", "prop",
+                                  svn_string_create("value", subpool),
+                                  subpool));
+  SVN_ERR(svn_repos_fs_commit_txn(NULL, repos, &youngest_rev, txn, subpool));
+  svn_pool_clear(subpool);
+
+  /* Revision 8:  Delete iota. */
+  SVN_ERR(svn_fs_begin_txn(&txn, fs, youngest_rev, subpool));
+  SVN_ERR(svn_fs_txn_root(&txn_root, txn, subpool));
+  SVN_ERR(svn_fs_delete(txn_root, "iota", subpool));
+  SVN_ERR(svn_repos_fs_commit_txn(NULL, repos, &youngest_rev, txn, subpool));
+  svn_pool_clear(subpool);
+
+  /* Revision 9:  Add a new iota and tweak branch/B/lambda. */
+  SVN_ERR(svn_fs_begin_txn(&txn, fs, youngest_rev, subpool));
+  SVN_ERR(svn_fs_txn_root(&txn_root, txn, subpool));
+  SVN_ERR(svn_fs_make_file(txn_root, "iota", subpool));
+  SVN_ERR(svn_test__set_file_contents(txn_root, "branch/B/lambda",
+                                      "Revision 9", subpool));
+  SVN_ERR(svn_repos_fs_commit_txn(NULL, repos, &youngest_rev, txn, subpool));
+  svn_pool_clear(subpool);
+
+  /* Log every path over all ranges, first with the index moved out of
+     the way and then with the index, and expect the same results. */
+  for (pass = 0; pass < 2; pass++)
+    {
+      if (pass == 0)
+        SVN_ERR(svn_io_file_rename2(index_path, backup_path, FALSE, pool));
+      else
+        SVN_ERR(svn_io_file_rename2(backup_path, index_path, FALSE, pool));
+
+      for (i = 0; paths[i]; i++)
+        for (strict = 0; strict < 2; strict++)
+          for (start = 0; start <= youngest_rev; start++)
+            for (end = 0; end <= youngest_rev; end++)
+              {
+                const char *key = apr_psprintf(pool, "%s %d %ld %ld",
+                                               paths[i], strict, start, end);
+                const char *expected_revs;
+
+                svn_pool_clear(subpool);
+                SVN_ERR(get_log_revs(&revs, repos, paths[i], start, end,
+                                     strict, subpool));
+                if (pass == 0)
+                  {
+                    svn_hash_sets(expected, key, apr_pstrdup(pool, revs));
+                    continue;
+                  }
+
+                expected_revs = svn_hash_gets(expected, key);
+                if (strcmp(revs, expected_revs) != 0)
+                  return svn_error_createf(SVN_ERR_TEST_FAILED, NULL,
+                                           "Log of '%s' is '%s' with the "
+                                           "index but '%s' without",
+                                           key, revs, expected_revs);
+              }
+    }
+
+  /* Make sure the comparison above covered copies and replacements. */
+  SVN_ERR(get_log_revs(&revs, repos, "/branch/B/E/alpha", youngest_rev, 0,
+                       FALSE, subpool));
+  SVN_TEST_STRING_ASSERT(revs, " 7 6 5 2 1");
+  SVN_ERR(get_log_revs(&revs, repos, "/branch/B/E/alpha", youngest_rev, 0,
+                       TRUE, subpool));
+  SVN_TEST_STRING_ASSERT(revs, " 7 6");
+  SVN_ERR(get_log_revs(&revs, repos, "/branch/mu", youngest_rev, 0,
+                       FALSE, subpool));
+  SVN_TEST_STRING_ASSERT(revs, " 4 3 2 1");
+  SVN_ERR(get_log_revs(&revs, repos, "/iota", youngest_rev, 0,
+                       FALSE, subpool));
+  SVN_TEST_STRING_ASSERT(revs, " 9");
+
+  svn_pool_destroy(subpool);
+  return SVN_NO_ERROR;
+}
+
+
 
 /* Tests for svn_repos_get_file_revsN() */
 
@@ -4505,6 +4723,8 @@ static struct svn_test_descriptor_t test_funcs[] =
                        "test if revprops are validated by repos"),
     SVN_TEST_OPTS_PASS(get_logs,
                        "test svn_repos_get_logs ranges and limits"),
+    SVN_TEST_OPTS_PASS(test_log_index,
+                       "test svn_repos_get_logs5 with a log index"),
     SVN_TEST_OPTS_PASS(test_get_file_revs,
                        "test svn_repos_get_file_revsN"),
     SVN_TEST_OPTS_PASS(issue_4060,
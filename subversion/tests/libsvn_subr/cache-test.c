@@ -22,12 +22,16 @@
  */
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <apr_general.h>
 #include <apr_lib.h>
 #include <apr_time.h>
+#include <apr_thread_proc.h>
 
 #include "svn_pools.h"
+#include "svn_dirent_uri.h"
+#include "svn_io.h"
 
 #include "private/svn_cache.h"
 #include "svn_private_config.h"
@@ -590,7 +594,665 @@ test_membuffer_unaligned_fixed_keys(apr_pool_t *pool)
   return SVN_NO_ERROR;
 }
 
+static svn_error_t *
+test_membuffer_prefix_stats(apr_pool_t *pool)
+{
+  svn_cache__t *cache1, *cache2;
+  svn_membuffer_t *membuffer;
+  svn_cache__info_t info;
+  svn_revnum_t twenty = 20, *answer;
+  svn_boolean_t found;
+
+  SVN_ERR(svn_cache__membuffer_cache_create(&membuffer, 1024*1024, 0, 1,
+                                            TRUE, TRUE, pool));
+
+  /* Two independent front-ends for the same kind of data. */
+  SVN_ERR(svn_cache__create_membuffer_cache(
+            &cache1, membuffer, serialize_revnum, deserialize_revnum,
+            APR_HASH_KEY_STRING, "stats:",
+            SVN_CACHE__MEMBUFFER_DEFAULT_PRIORITY, FALSE, FALSE,
+            pool, pool));
+  SVN_ERR(svn_cache__create_membuffer_cache(
+            &cache2, membuffer, serialize_revnum, deserialize_revnum,
+            APR_HASH_KEY_STRING, "stats:",
+            SVN_CACHE__MEMBUFFER_DEFAULT_PRIORITY, FALSE, FALSE,
+            pool, pool));
+
+  SVN_ERR(svn_cache__set(cache1, "twenty", &twenty, pool));
+  SVN_ERR(svn_cache__get((void **) &answer, &found, cache2, "twenty", pool));
+  SVN_TEST_ASSERT(found && *answer == 20);
+  SVN_ERR(svn_cache__get((void **) &answer, &found, cache1, "thirty", pool));
+  SVN_TEST_ASSERT(!found);
+
+  /* Per-instance stats only see their own lookups while the per-prefix
+   * stats cover both front-ends. */
+  SVN_ERR(svn_cache__get_info(cache1, &info, TRUE, pool));
+  SVN_TEST_ASSERT(info.gets == 1 && info.hits == 0);
+  SVN_TEST_ASSERT(info.prefix_gets == 2 && info.prefix_hits == 1);
+
+  /* Resetting the instance stats does not affect the per-prefix ones. */
+  SVN_ERR(svn_cache__get_info(cache2, &info, TRUE, pool));
+  SVN_TEST_ASSERT(info.gets == 1 && info.hits == 1);
+  SVN_TEST_ASSERT(info.prefix_gets == 2 && info.prefix_hits == 1);
+
+  return SVN_NO_ERROR;
+}
+
+/* Number of entries in the working set of test_membuffer_scan_resistance. */
+#define HOT_KEY_COUNT 50
+
+/* Number of entries scanned once by test_membuffer_scan_resistance.  Their
+ * total size is several times the capacity of its cache. */
+#define COLD_KEY_COUNT 5000
+
+/* Read all HOT_KEY_COUNT entries of the working set from CACHE and fail
+ * if any of them is missing.  Use SCRATCH_POOL for temporary allocations.
+ */
+static svn_error_t *
+read_hot_keys(svn_cache__t *cache,
+              apr_pool_t *scratch_pool)
+{
+  apr_pool_t *iterpool = svn_pool_create(scratch_pool);
+  int i;
+
+  for (i = 0; i < HOT_KEY_COUNT; ++i)
+    {
+      svn_stringbuf_t *value;
+      svn_boolean_t found;
+
+      svn_pool_clear(iterpool);
+      SVN_ERR(svn_cache__get((void **) &value, &found, cache,
+                             apr_psprintf(iterpool, "hot-%d", i),
+                             iterpool));
+      if (! found)
+        return svn_error_createf(SVN_ERR_TEST_FAILED, NULL,
+                                 "hot entry %d has been evicted", i);
+    }
+
+  svn_pool_destroy(iterpool);
+  return SVN_NO_ERROR;
+}
+
+/* Scan many entries that are used only once through a small cache while
+ * the entries of a working set are being used repeatedly.  The scan must
+ * not evict the working set. */
+static svn_error_t *
+test_membuffer_scan_resistance(apr_pool_t *pool)
+{
+  svn_cache__t *cache;
+  svn_membuffer_t *membuffer;
+  svn_stringbuf_t *value = svn_stringbuf_create_ensure(1000, pool);
+  apr_pool_t *iterpool = svn_pool_create(pool);
+  int i;
+
+  /* Room for less than a thousand entries of VALUE's size and directory
+   * space to spare, so all evictions are driven by the data size. */
+  SVN_ERR(svn_cache__membuffer_cache_create(&membuffer, 1024*1024,
+                                            128*1024, 1, TRUE, TRUE, pool));
+  SVN_ERR(svn_cache__create_membuffer_cache(
+            &cache, membuffer, NULL, NULL,
+            APR_HASH_KEY_STRING, "scan:",
+            SVN_CACHE__MEMBUFFER_DEFAULT_PRIORITY, FALSE, FALSE,
+            pool, pool));
+
+  while (value->len < 1000)
+    svn_stringbuf_appendbyte(value, 'x');
+
+  for (i = 0; i < HOT_KEY_COUNT; ++i)
+    {
+      svn_pool_clear(iterpool);
+      SVN_ERR(svn_cache__set(cache, apr_psprintf(iterpool, "hot-%d", i),
+                             value, iterpool));
+    }
+
+  /* One pass over the cold entries, each of which gets looked up and then
+   * added, just like a cache user would do. */
+  for (i = 0; i < COLD_KEY_COUNT; ++i)
+    {
+      const char *key;
+      void *cold_value;
+      svn_boolean_t found;
+
+      svn_pool_clear(iterpool);
+      if (i % 100 == 0)
+        SVN_ERR(read_hot_keys(cache, iterpool));
+
+      key = apr_psprintf(iterpool, "cold-%d", i);
+      SVN_ERR(svn_cache__get(&cold_value, &found, cache, key, iterpool));
+      SVN_TEST_ASSERT(! found);
+      SVN_ERR(svn_cache__set(cache, key, value, iterpool));
+    }
+
+  /* The whole working set must still be there. */
+  SVN_ERR(read_hot_keys(cache, iterpool));
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
+
+/* Create a shared membuffer cache, fill it from a forked child process
+ * and read the data back in the parent. */
+static svn_error_t *
+test_membuffer_shared_memory(apr_pool_t *pool)
+{
+#if APR_HAS_FORK
+  svn_cache__t *cache;
+  svn_membuffer_t *membuffer;
+  svn_revnum_t twenty = 20, *answer;
+  svn_boolean_t found;
+  apr_proc_t proc;
+  apr_status_t status;
+  int exit_code;
+  apr_exit_why_e exit_why;
+
+  svn_error_t *err = svn_cache__membuffer_cache_create_shared(&membuffer,
+                                                              1024*1024, 0,
+                                                              1, TRUE, pool);
+  if (err && err->apr_err == SVN_ERR_UNSUPPORTED_FEATURE)
+    {
+      svn_error_clear(err);
+      return svn_error_create(SVN_ERR_TEST_SKIPPED, NULL,
+                              "shared memory caches are not supported");
+    }
+  SVN_ERR(err);
+
+  SVN_ERR(svn_cache__create_membuffer_cache(
+            &cache, membuffer, serialize_revnum, deserialize_revnum,
+            APR_HASH_KEY_STRING, "shared:",
+            SVN_CACHE__MEMBUFFER_DEFAULT_PRIORITY, FALSE, FALSE,
+            pool, pool));
+
+  status = apr_proc_fork(&proc, pool);
+  if (status == APR_INCHILD)
+    {
+      err = svn_cache__set(cache, "twenty", &twenty, pool);
+      exit(err ? EXIT_FAILURE : EXIT_SUCCESS);
+    }
+  else if (status != APR_INPARENT)
+    return svn_error_wrap_apr(status, "Can't fork");
+
+  status = apr_proc_wait(&proc, &exit_code, &exit_why, APR_WAIT);
+  if (status != APR_CHILD_DONE)
+    return svn_error_wrap_apr(status, "Can't wait for child process");
+  SVN_TEST_ASSERT(APR_PROC_CHECK_EXIT(exit_why) && exit_code == 0);
+
+  /* The data written by the child must be visible here. */
+  SVN_ERR(svn_cache__get((void **) &answer, &found, cache, "twenty", pool));
+  SVN_TEST_ASSERT(found && *answer == 20);
+#endif
+
+  return SVN_NO_ERROR;
+}
+
+#if APR_HAS_THREADS
+
+/* Number of keys used by the concurrent membuffer access tests. */
+#define CONCURRENT_KEY_COUNT 1000
+
+/* Baton for the threads in run_concurrent_access. */
+typedef struct concurrent_access_baton_t
+{
+  /* The cache shared by all threads. */
+  svn_membuffer_t *membuffer;
+
+  /* Number of lookups (or updates) to perform per thread. */
+  int iterations;
+
+  /* Set for the thread modifying the cache. */
+  svn_boolean_t writer;
+
+  /* Number of successful lookups. */
+  int hits;
+
+  /* The first error encountered by the thread. */
+  svn_error_t *err;
+} concurrent_access_baton_t;
+
+/* Body of the threads in run_concurrent_access.  Read or modify the cache
+ * described by BATON and verify that all data read is consistent. */
+static svn_error_t *
+access_cache_concurrently(concurrent_access_baton_t *baton,
+                          apr_pool_t *pool)
+{
+  svn_cache__t *cache;
+  apr_pool_t *iterpool = svn_pool_create(pool);
+  int i;
+
+  /* Every thread uses its own front-end, like separate svn_fs_t would. */
+  SVN_ERR(svn_cache__create_membuffer_cache(
+            &cache, baton->membuffer, serialize_revnum, deserialize_revnum,
+            APR_HASH_KEY_STRING, "concurrent:",
+            SVN_CACHE__MEMBUFFER_DEFAULT_PRIORITY, FALSE, FALSE,
+            pool, pool));
+
+  for (i = 0; i < baton->iterations; ++i)
+    {
+      svn_revnum_t key_value = (i * 7919) % CONCURRENT_KEY_COUNT;
+      const char *key;
+
+      svn_pool_clear(iterpool);
+      key = apr_psprintf(iterpool, "key-%ld", key_value);
+
+      if (baton->writer)
+        {
+          /* Flip the sign to actually modify the cached data. */
+          svn_revnum_t value = (i & 1) ? -key_value : key_value;
+          SVN_ERR(svn_cache__set(cache, key, &value, iterpool));
+        }
+      else
+        {
+          svn_revnum_t *answer;
+          svn_boolean_t found;
+
+          SVN_ERR(svn_cache__get((void **) &answer, &found, cache, key,
+                                 iterpool));
+          if (!found)
+            continue;
+
+          if (*answer != key_value && *answer != -key_value)
+            return svn_error_createf(SVN_ERR_TEST_FAILED, NULL,
+                                     "expected %ld but found %ld for '%s'",
+                                     key_value, *answer, key);
+          baton->hits++;
+        }
+    }
+
+  svn_pool_destroy(iterpool);
+  return SVN_NO_ERROR;
+}
+
+/* apr_thread_start_t implementation calling access_cache_concurrently. */
+static void * APR_THREAD_FUNC
+concurrent_access_thread(apr_thread_t *tid, void *data)
+{
+  concurrent_access_baton_t *baton = data;
+  apr_pool_t *pool = svn_pool_create(NULL);
+
+  baton->err = access_cache_concurrently(baton, pool);
+  svn_pool_destroy(pool);
+  apr_thread_exit(tid, APR_SUCCESS);
+
+  return NULL;
+}
+
+/* Fill a single-segment, thread-safe membuffer cache and access it from
+ * READER_COUNT threads doing ITERATIONS lookups each.  If WITH_WRITER is
+ * set, another thread keeps modifying the cached items at the same time.
+ * Return the lookup rate per second in *READS_PER_SEC.
+ */
+static svn_error_t *
+run_concurrent_access(double *reads_per_sec,
+                      int reader_count,
+                      int iterations,
+                      svn_boolean_t with_writer,
+                      apr_pool_t *pool)
+{
+  int thread_count = reader_count + (with_writer ? 1 : 0);
+  apr_thread_t **threads = apr_pcalloc(pool, thread_count * sizeof(*threads));
+  concurrent_access_baton_t *batons
+    = apr_pcalloc(pool, thread_count * sizeof(*batons));
+  concurrent_access_baton_t filler = { 0 };
+  apr_time_t start;
+  apr_status_t status;
+  svn_error_t *err = SVN_NO_ERROR;
+  int hits = 0;
+  int i;
+
+  /* One segment only to maximize contention. */
+  SVN_ERR(svn_cache__membuffer_cache_create(&filler.membuffer, 0x400000, 0,
+                                            1, TRUE, FALSE, pool));
+
+  /* Pre-populate the cache. */
+  filler.writer = TRUE;
+  filler.iterations = CONCURRENT_KEY_COUNT;
+  SVN_ERR(access_cache_concurrently(&filler, pool));
+
+  start = apr_time_now();
+  for (i = 0; i < thread_count; ++i)
+    {
+      batons[i].membuffer = filler.membuffer;
+      batons[i].iterations = iterations;
+      batons[i].writer = i == reader_count;
+
+      status = apr_thread_create(&threads[i], NULL, concurrent_access_thread,
+                                 &batons[i], pool);
+      if (status)
+        return svn_error_wrap_apr(status, "Can't create thread");
+    }
+
+  for (i = 0; i < thread_count; ++i)
+    {
+      apr_status_t retval;
+      status = apr_thread_join(&retval, threads[i]);
+      if (status)
+        return svn_error_wrap_apr(status, "Can't join thread");
+
+      err = svn_error_compose_create(err, batons[i].err);
+      hits += batons[i].hits;
+    }
+
+  *reads_per_sec = (double)reader_count * iterations * APR_USEC_PER_SEC
+                 / (double)(apr_time_now() - start + 1);
+
+  SVN_ERR(err);
+  if (hits == 0)
+    return svn_error_create(SVN_ERR_TEST_FAILED, NULL,
+                            "no cache hits during concurrent access");
+
+  return SVN_NO_ERROR;
+}
+
+#endif
+
+static svn_error_t *
+test_membuffer_concurrent_access(apr_pool_t *pool)
+{
+#if APR_HAS_THREADS
+  double reads_per_sec;
+  SVN_ERR(run_concurrent_access(&reads_per_sec, 4, 20000, TRUE, pool));
+#endif
+
+  return SVN_NO_ERROR;
+}
+
+/* Measure membuffer lookup throughput for increasing numbers of reader
+ * threads, with and without a concurrent writer. */
+static svn_error_t *
+test_membuffer_contention_performance(apr_pool_t *pool)
+{
+#if APR_HAS_THREADS
+  int reader_count;
+
+  for (reader_count = 1; reader_count <= 16; reader_count *= 2)
+    {
+      double read_only, with_writer;
+      SVN_ERR(run_concurrent_access(&read_only, reader_count, 1000000,
+                                    FALSE, pool));
+      SVN_ERR(run_concurrent_access(&with_writer, reader_count, 1000000,
+                                    TRUE, pool));
+
+      printf("%2d readers: %.0f reads/s, %.0f reads/s with writer\n",
+             reader_count, read_only, with_writer);
+    }
+#endif
+
+  return SVN_NO_ERROR;
+}
+
 
+/* Return a new persistent cache for revision numbers on top of STORE and
+ * an empty inprocess cache in *CACHE_P.  Allocate everything in POOL. */
+static svn_error_t *
+create_persistent_cache(svn_cache__t **cache_p,
+                        svn_cache__persistent_store_t *store,
+                        apr_pool_t *pool)
+{
+  svn_cache__t *l1_cache;
+
+  SVN_ERR(svn_cache__create_inprocess(&l1_cache,
+                                      serialize_revnum, deserialize_revnum,
+                                      APR_HASH_KEY_STRING, 16, 16, TRUE,
+                                      "", pool));
+  SVN_ERR(svn_cache__create_persistent(cache_p, l1_cache, store, "revnum",
+                                       serialize_revnum, deserialize_revnum,
+                                       APR_HASH_KEY_STRING, pool));
+
+  return SVN_NO_ERROR;
+}
+
+/* Open the private persistent store at PATH with VERSION and return a
+ * new persistent cache for revision numbers on top of an empty inprocess
+ * cache in *CACHE_P.  Allocate everything in POOL. */
+static svn_error_t *
+open_persistent_cache(svn_cache__t **cache_p,
+                      const char *path,
+                      const char *version,
+                      apr_pool_t *pool)
+{
+  svn_cache__persistent_store_t *store;
+
+  SVN_ERR(svn_cache__persistent_store_open(&store, path, version, 0x10000,
+                                           FALSE, pool, pool));
+  SVN_ERR(create_persistent_cache(cache_p, store, pool));
+
+  return SVN_NO_ERROR;
+}
+
+/* Verify that CACHE contains the value 20 for key "twenty" if and only if
+ * EXPECTED is set.  Use POOL for temporary allocations. */
+static svn_error_t *
+check_persistent_twenty(svn_cache__t *cache,
+                        svn_boolean_t expected,
+                        apr_pool_t *pool)
+{
+  svn_revnum_t *answer;
+  svn_boolean_t found;
+
+  SVN_ERR(svn_cache__get((void **) &answer, &found, cache, "twenty", pool));
+  SVN_TEST_ASSERT(found == expected);
+  if (found)
+    SVN_TEST_ASSERT(*answer == 20);
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+test_persistent_cache(apr_pool_t *pool)
+{
+  const char *dir, *path;
+  svn_cache__t *cache;
+  apr_file_t *file;
+  apr_pool_t *subpool = svn_pool_create(pool);
+
+  SVN_ERR(svn_test_make_sandbox_dir(&dir, "cache-test-persistent", pool));
+  path = svn_dirent_join(dir, "store", pool);
+
+  /* Populate a new store. */
+  SVN_ERR(open_persistent_cache(&cache, path, "v1", subpool));
+  SVN_ERR(basic_cache_test(cache, FALSE, subpool));
+  svn_pool_clear(subpool);
+
+  /* After reopening, the data must be there even though the first level
+   * starts out empty. */
+  SVN_ERR(open_persistent_cache(&cache, path, "v1", subpool));
+  SVN_ERR(check_persistent_twenty(cache, TRUE, subpool));
+  svn_pool_clear(subpool);
+
+  /* A different version must not see the old data and replaces it. */
+  SVN_ERR(open_persistent_cache(&cache, path, "v2", subpool));
+  SVN_ERR(check_persistent_twenty(cache, FALSE, subpool));
+  SVN_ERR(basic_cache_test(cache, FALSE, subpool));
+  svn_pool_clear(subpool);
+
+  SVN_ERR(open_persistent_cache(&cache, path, "v1", subpool));
+  SVN_ERR(check_persistent_twenty(cache, FALSE, subpool));
+  SVN_ERR(basic_cache_test(cache, FALSE, subpool));
+  svn_pool_clear(subpool);
+
+  /* Simulate a crash while appending a record.  The store gets reset. */
+  SVN_ERR(svn_io_file_open(&file, path, APR_WRITE | APR_APPEND,
+                           APR_OS_DEFAULT, subpool));
+  SVN_ERR(svn_io_file_write_full(file, "xyz", 3, NULL, subpool));
+  SVN_ERR(svn_io_file_close(file, subpool));
+  svn_pool_clear(subpool);
+
+  SVN_ERR(open_persistent_cache(&cache, path, "v1", subpool));
+  SVN_ERR(check_persistent_twenty(cache, FALSE, subpool));
+
+  svn_pool_destroy(subpool);
+  return SVN_NO_ERROR;
+}
+
+/* Verify that CACHE contains the value EXPECTED for KEY.  Use POOL for
+ * temporary allocations. */
+static svn_error_t *
+check_persistent_value(svn_cache__t *cache,
+                       const char *key,
+                       svn_revnum_t expected,
+                       apr_pool_t *pool)
+{
+  svn_revnum_t *answer;
+  svn_boolean_t found;
+
+  SVN_ERR(svn_cache__get((void **) &answer, &found, cache, key, pool));
+  SVN_TEST_ASSERT(found);
+  SVN_TEST_INT_ASSERT(*answer, expected);
+
+  return SVN_NO_ERROR;
+}
+
+/* Set *SIZE to the size of the file at PATH.  Use POOL for temporary
+ * allocations. */
+static svn_error_t *
+get_file_size(svn_filesize_t *size,
+              const char *path,
+              apr_pool_t *pool)
+{
+  apr_finfo_t finfo;
+
+  SVN_ERR(svn_io_stat(&finfo, path, APR_FINFO_SIZE, pool));
+  *size = finfo.size;
+
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_cache__partial_setter_func_t for revision numbers by
+ * incrementing the value. */
+static svn_error_t *
+increment_revnum(void **data,
+                 apr_size_t *data_len,
+                 void *baton,
+                 apr_pool_t *result_pool)
+{
+  ++*(svn_revnum_t *)*data;
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+test_persistent_cache_updates(apr_pool_t *pool)
+{
+  const char *dir, *path, *stamp;
+  svn_cache__persistent_store_t *store;
+  svn_cache__t *cache;
+  svn_revnum_t value = 20;
+  svn_filesize_t size, new_size;
+  apr_pool_t *subpool = svn_pool_create(pool);
+
+  SVN_ERR(svn_test_make_sandbox_dir(&dir, "cache-test-persistent-updates",
+                                    pool));
+  path = svn_dirent_join(dir, "store", pool);
+
+  SVN_ERR(open_persistent_cache(&cache, path, "v1", subpool));
+  SVN_ERR(svn_cache__set(cache, "twenty", &value, subpool));
+  SVN_ERR(get_file_size(&size, path, subpool));
+
+  /* Setting the same value again must not grow the file. */
+  SVN_ERR(svn_cache__set(cache, "twenty", &value, subpool));
+  SVN_ERR(get_file_size(&new_size, path, subpool));
+  SVN_TEST_INT_ASSERT(new_size, size);
+
+  /* Neither must setting it in a new process. */
+  svn_pool_clear(subpool);
+  SVN_ERR(open_persistent_cache(&cache, path, "v1", subpool));
+  SVN_ERR(svn_cache__set(cache, "twenty", &value, subpool));
+  SVN_ERR(get_file_size(&new_size, path, subpool));
+  SVN_TEST_INT_ASSERT(new_size, size);
+
+  /* Changed values supersede the old ones. */
+  value = 21;
+  SVN_ERR(svn_cache__set(cache, "twenty", &value, subpool));
+  svn_pool_clear(subpool);
+  SVN_ERR(open_persistent_cache(&cache, path, "v1", subpool));
+  SVN_ERR(check_persistent_value(cache, "twenty", 21, subpool));
+
+  /* Partial updates reach the store, too, whether the entry is in the
+   * first level (after the lookup above) or not. */
+  SVN_ERR(svn_cache__set_partial(cache, "twenty", increment_revnum, NULL,
+                                 subpool));
+  svn_pool_clear(subpool);
+  SVN_ERR(open_persistent_cache(&cache, path, "v1", subpool));
+  SVN_ERR(svn_cache__set_partial(cache, "twenty", increment_revnum, NULL,
+                                 subpool));
+  svn_pool_clear(subpool);
+  SVN_ERR(open_persistent_cache(&cache, path, "v1", subpool));
+  SVN_ERR(check_persistent_value(cache, "twenty", 23, subpool));
+
+  /* Stamps survive reopening the store until it gets reset. */
+  svn_pool_clear(subpool);
+  SVN_ERR(svn_cache__persistent_store_open(&store, path, "v1", 0x10000,
+                                           FALSE, subpool, subpool));
+  SVN_ERR(svn_cache__persistent_store_set_stamp(store, "42", subpool));
+  svn_pool_clear(subpool);
+  SVN_ERR(svn_cache__persistent_store_open(&store, path, "v1", 0x10000,
+                                           FALSE, subpool, subpool));
+  SVN_ERR(svn_cache__persistent_store_get_stamp(&stamp, store, subpool));
+  SVN_TEST_STRING_ASSERT(stamp, "42");
+
+  SVN_ERR(svn_cache__persistent_store_reset(store, subpool));
+  svn_pool_clear(subpool);
+  SVN_ERR(open_persistent_cache(&cache, path, "v1", subpool));
+  SVN_ERR(check_persistent_twenty(cache, FALSE, subpool));
+
+  svn_pool_destroy(subpool);
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+test_persistent_cache_compaction(apr_pool_t *pool)
+{
+  const char *dir, *path;
+  svn_cache__persistent_store_t *store;
+  svn_cache__t *cache;
+  const char *stamp;
+  svn_revnum_t *value;
+  svn_boolean_t found;
+  svn_filesize_t size;
+  apr_pool_t *subpool = svn_pool_create(pool);
+  apr_pool_t *iterpool = svn_pool_create(pool);
+  svn_revnum_t i;
+
+  SVN_ERR(svn_test_make_sandbox_dir(&dir,
+                                    "cache-test-persistent-compaction",
+                                    pool));
+  path = svn_dirent_join(dir, "store", pool);
+
+  /* Write more than fits into the store. */
+  SVN_ERR(svn_cache__persistent_store_open(&store, path, "v1", 0x10000,
+                                           FALSE, subpool, subpool));
+  SVN_ERR(svn_cache__persistent_store_set_stamp(store, "stamp", subpool));
+  SVN_ERR(create_persistent_cache(&cache, store, subpool));
+  for (i = 0; i < 5000; ++i)
+    {
+      const char *key;
+
+      svn_pool_clear(iterpool);
+      key = apr_psprintf(iterpool, "key %ld", i);
+      SVN_ERR(svn_cache__set(cache, key, &i, iterpool));
+    }
+
+  SVN_ERR(get_file_size(&size, path, subpool));
+  SVN_TEST_ASSERT(size <= 0x10000);
+
+  /* The newest entries and the stamp must have been kept, the oldest
+   * ones must have been dropped. */
+  svn_pool_clear(subpool);
+  SVN_ERR(svn_cache__persistent_store_open(&store, path, "v1", 0x10000,
+                                           FALSE, subpool, subpool));
+  SVN_ERR(svn_cache__persistent_store_get_stamp(&stamp, store, subpool));
+  SVN_TEST_STRING_ASSERT(stamp, "stamp");
+
+  SVN_ERR(create_persistent_cache(&cache, store, subpool));
+  SVN_ERR(check_persistent_value(cache, "key 4999", 4999, subpool));
+  SVN_ERR(svn_cache__get((void **) &value, &found, cache, "key 0",
+                         subpool));
+  SVN_TEST_ASSERT(!found);
+
+  svn_pool_destroy(iterpool);
+  svn_pool_destroy(subpool);
+  return SVN_NO_ERROR;
+}
+
+
 /* The test table.  */
 
 static int max_threads = 1;
@@ -616,6 +1278,22 @@ static struct svn_test_descriptor_t test_funcs[] =
                    "test membuffer cache with unaligned string keys"),
     SVN_TEST_PASS2(test_membuffer_unaligned_fixed_keys,
                    "test membuffer cache with unaligned fixed keys"),
+    SVN_TEST_PASS2(test_membuffer_prefix_stats,
+                   "test per-prefix membuffer cache statistics"),
+    SVN_TEST_PASS2(test_membuffer_scan_resistance,
+                   "test that scans don't evict membuffer working sets"),
+    SVN_TEST_SKIP2(test_membuffer_shared_memory, ! APR_HAS_FORK,
+                   "basic shared memory membuffer test"),
+    SVN_TEST_SKIP2(test_membuffer_concurrent_access, ! APR_HAS_THREADS,
+                   "test concurrent membuffer cache access"),
+    SVN_TEST_SKIP2(test_membuffer_contention_performance, TRUE,
+                   "optional membuffer cache contention benchmark"),
+    SVN_TEST_PASS2(test_persistent_cache,
+                   "test persistent second-level cache"),
+    SVN_TEST_PASS2(test_persistent_cache_updates,
+                   "test updating a persistent cache"),
+    SVN_TEST_PASS2(test_persistent_cache_compaction,
+                   "test compacting a full persistent cache"),
     SVN_TEST_NULL
   };
 
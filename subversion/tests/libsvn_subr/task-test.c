@@ -0,0 +1,172 @@
+/*
+ * task-test.c:  a collection of svn_task__* tests
+ *
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ */
+
+/* ====================================================================
+   To add tests, look toward the bottom of this file.
+
+*/
+
+
+
+#include <apr_pools.h>
+
+#include "../svn_test.h"
+
+#include "svn_error.h"
+#include "private/svn_task.h"
+
+/* Number of tasks to run in each test. */
+enum { TASK_COUNT = 1000 };
+
+/* Task index at which the error tests fail. */
+enum { FAILING_TASK = 567 };
+
+/* Output baton used by the tests. */
+typedef struct output_baton_t
+{
+  /* Number of results seen so far. */
+  apr_size_t count;
+
+  /* Sum of all results. */
+  apr_uint64_t sum;
+} output_baton_t;
+
+/* Implements svn_task__process_func_t.  Return the square of TASK_INDEX.
+ * If BATON is not NULL, fail for task FAILING_TASK. */
+static svn_error_t *
+square_task(void **result,
+            apr_size_t task_index,
+            void *baton,
+            void *thread_context,
+            svn_cancel_func_t cancel_func,
+            void *cancel_baton,
+            apr_pool_t *result_pool,
+            apr_pool_t *scratch_pool)
+{
+  apr_uint64_t *value = apr_palloc(result_pool, sizeof(*value));
+
+  if (baton && task_index == FAILING_TASK)
+    return svn_error_create(SVN_ERR_TEST_FAILED, NULL, "task failed");
+
+  if (cancel_func)
+    SVN_ERR(cancel_func(cancel_baton));
+
+  *value = (apr_uint64_t)task_index * task_index;
+  *result = value;
+
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_task__output_func_t.  Verify that results arrive in
+ * order and accumulate them in the output_baton_t BATON. */
+static svn_error_t *
+sum_output(void *baton,
+           apr_size_t task_index,
+           void *result,
+           svn_cancel_func_t cancel_func,
+           void *cancel_baton,
+           apr_pool_t *scratch_pool)
+{
+  output_baton_t *output_baton = baton;
+  apr_uint64_t *value = result;
+
+  SVN_TEST_ASSERT(task_index == output_baton->count);
+  SVN_TEST_ASSERT(*value == (apr_uint64_t)task_index * task_index);
+
+  output_baton->count++;
+  output_baton->sum += *value;
+
+  return SVN_NO_ERROR;
+}
+
+/* Run TASK_COUNT tasks on CONCURRENCY threads and check the results.
+ * Use POOL for temporaries. */
+static svn_error_t *
+run_square_tasks(int concurrency,
+                 apr_pool_t *pool)
+{
+  output_baton_t output_baton = { 0 };
+  apr_uint64_t expected = (apr_uint64_t)(TASK_COUNT - 1) * TASK_COUNT
+                        * (2 * TASK_COUNT - 1) / 6;
+
+  SVN_ERR(svn_task__run(concurrency, TASK_COUNT, square_task, NULL,
+                        sum_output, &output_baton, NULL, NULL, NULL, NULL,
+                        pool));
+
+  SVN_TEST_ASSERT(output_baton.count == TASK_COUNT);
+  SVN_TEST_ASSERT(output_baton.sum == expected);
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+test_sequential(apr_pool_t *pool)
+{
+  return svn_error_trace(run_square_tasks(1, pool));
+}
+
+static svn_error_t *
+test_concurrent(apr_pool_t *pool)
+{
+  return svn_error_trace(run_square_tasks(8, pool));
+}
+
+static svn_error_t *
+test_error_order(apr_pool_t *pool)
+{
+  int concurrency;
+
+  for (concurrency = 1; concurrency <= 8; concurrency *= 2)
+    {
+      output_baton_t output_baton = { 0 };
+
+      /* The run must fail and all tasks before the failing one must
+       * have been passed to the output function. */
+      SVN_TEST_ASSERT_ERROR(svn_task__run(concurrency, TASK_COUNT,
+                                          square_task, &output_baton,
+                                          sum_output, &output_baton,
+                                          NULL, NULL, NULL, NULL, pool),
+                            SVN_ERR_TEST_FAILED);
+      SVN_TEST_ASSERT(output_baton.count == FAILING_TASK);
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* An array of all test functions */
+
+static int max_threads = 1;
+
+static struct svn_test_descriptor_t test_funcs[] =
+  {
+    SVN_TEST_NULL,
+    SVN_TEST_PASS2(test_sequential,
+                   "sequential task execution"),
+    SVN_TEST_PASS2(test_concurrent,
+                   "concurrent task execution with ordered output"),
+    SVN_TEST_PASS2(test_error_order,
+                   "task errors are reported in task order"),
+    SVN_TEST_NULL
+  };
+
+SVN_TEST_MAIN
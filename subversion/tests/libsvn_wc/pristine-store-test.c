@@ -39,6 +39,7 @@
 #include "svn_repos.h"
 #include "svn_wc.h"
 #include "svn_client.h"
+#include "svn_config.h"
 
 #include "utils.h"
 
@@ -47,6 +48,7 @@
 #include "../../libsvn_wc/wc-queries.h"
 #include "../../libsvn_wc/workqueue.h"
 
+#include "private/svn_io_private.h"
 #include "private/svn_wc_private.h"
 
 #include "../svn_test.h"
@@ -307,6 +309,199 @@ reject_mismatching_text(const svn_test_opts_t *opts,
 }
 
 
+/* Install DATA as a pristine text in the WC at WC_ABSPATH of DB and set
+ * *SHA1 to its checksum. */
+static svn_error_t *
+install_text(const svn_checksum_t **sha1,
+             svn_wc__db_t *db,
+             const char *wc_abspath,
+             const char *data,
+             apr_pool_t *pool)
+{
+  svn_wc__db_install_data_t *install_data;
+  svn_stream_t *pristine_stream;
+  svn_checksum_t *data_sha1, *data_md5;
+  apr_size_t sz = strlen(data);
+
+  SVN_ERR(svn_wc__db_pristine_prepare_install(&pristine_stream,
+                                              &install_data,
+                                              &data_sha1, &data_md5,
+                                              db, wc_abspath,
+                                              pool, pool));
+  SVN_ERR(svn_stream_write(pristine_stream, data, &sz));
+  SVN_ERR(svn_stream_close(pristine_stream));
+  SVN_ERR(svn_wc__db_pristine_install(install_data, data_sha1, data_md5,
+                                      pool));
+
+  *sha1 = data_sha1;
+  return SVN_NO_ERROR;
+}
+
+/* Test sharing pristine texts between working copies. */
+static svn_error_t *
+pristine_shared_store(const svn_test_opts_t *opts,
+                      apr_pool_t *pool)
+{
+  svn_test__sandbox_t b1, b2;
+  svn_config_t *config;
+  svn_wc_context_t *wc_ctx1, *wc_ctx2;
+  const char *store_abspath;
+  const char *shared_abspath;
+  const char *hexdigest;
+  const svn_checksum_t *sha1;
+  svn_stream_t *contents;
+  svn_boolean_t same;
+  svn_boolean_t read_only;
+  apr_finfo_t finfo;
+
+  const char data[] = "Shared text";
+
+  SVN_ERR(svn_test__sandbox_create(&b1, "pristine_shared_store_1", opts,
+                                   pool));
+  SVN_ERR(svn_test__sandbox_create(&b2, "pristine_shared_store_2", opts,
+                                   pool));
+
+  store_abspath = svn_dirent_join(svn_dirent_dirname(b1.wc_abspath, pool),
+                                  "pristine_shared_store", pool);
+  SVN_ERR(svn_io_remove_dir2(store_abspath, TRUE, NULL, NULL, pool));
+  svn_test_add_dir_cleanup(store_abspath);
+
+  SVN_ERR(svn_config_create2(&config, FALSE, FALSE, pool));
+  svn_config_set(config, SVN_CONFIG_SECTION_WORKING_COPY,
+                 SVN_CONFIG_OPTION_WC_SHARED_PRISTINE_STORE, store_abspath);
+  SVN_ERR(svn_wc_context_create(&wc_ctx1, config, pool, pool));
+  SVN_ERR(svn_wc_context_create(&wc_ctx2, config, pool, pool));
+
+  /* Installing a text adds it to the shared store. */
+  SVN_ERR(install_text(&sha1, wc_ctx1->db, b1.wc_abspath, data, pool));
+
+  hexdigest = svn_checksum_to_cstring(sha1, pool);
+  shared_abspath = svn_dirent_join_many(pool, store_abspath,
+                                        apr_pstrndup(pool, hexdigest, 2),
+                                        apr_pstrcat(pool, hexdigest,
+                                                    ".svn-base",
+                                                    SVN_VA_NULL),
+                                        SVN_VA_NULL);
+
+  /* Nobody may modify the shared text in place. */
+  SVN_ERR(svn_io_stat(&finfo, shared_abspath,
+                      APR_FINFO_PROT | APR_FINFO_OWNER, pool));
+  SVN_ERR(svn_io__is_finfo_read_only(&read_only, &finfo, pool));
+  SVN_TEST_ASSERT(read_only);
+
+  /* The other working copy finds it there, without having it itself. */
+  SVN_ERR(svn_wc__get_pristine_contents_by_checksum(&contents, wc_ctx2,
+                                                    b2.wc_abspath, sha1,
+                                                    pool, pool));
+  SVN_TEST_ASSERT(contents != NULL);
+  SVN_ERR(svn_stream_contents_same2(&same, contents,
+                                    svn_stream_from_string(
+                                      svn_string_create(data, pool), pool),
+                                    pool));
+  SVN_TEST_ASSERT(same);
+
+  /* Both working copies link to the same file. */
+  SVN_ERR(install_text(&sha1, wc_ctx2->db, b2.wc_abspath, data, pool));
+#ifndef WIN32
+  SVN_ERR(svn_io_stat(&finfo, shared_abspath, APR_FINFO_NLINK, pool));
+  SVN_TEST_INT_ASSERT(finfo.nlink, 3);
+#endif
+
+  /* Removing them from the working copies leaves the shared text until it
+   * has been unused for a while. */
+  SVN_ERR(svn_wc__db_pristine_remove(wc_ctx1->db, b1.wc_abspath, sha1,
+                                     pool));
+  SVN_ERR(svn_wc__db_pristine_remove(wc_ctx2->db, b2.wc_abspath, sha1,
+                                     pool));
+  SVN_ERR(svn_wc__db_pristine_cleanup(wc_ctx1->db, b1.wc_abspath, pool));
+  SVN_ERR(svn_io_stat(&finfo, shared_abspath, APR_FINFO_NLINK, pool));
+#ifndef WIN32
+  SVN_TEST_INT_ASSERT(finfo.nlink, 1);
+#endif
+
+  SVN_ERR(svn_wc_context_destroy(wc_ctx1));
+  SVN_ERR(svn_wc_context_destroy(wc_ctx2));
+
+  return SVN_NO_ERROR;
+}
+
+/* Test that corrupted texts in the shared store are neither served nor
+ * linked into working copies. */
+static svn_error_t *
+pristine_shared_store_corrupt(const svn_test_opts_t *opts,
+                              apr_pool_t *pool)
+{
+  svn_test__sandbox_t b1, b2;
+  svn_config_t *config;
+  svn_wc_context_t *wc_ctx1, *wc_ctx2;
+  const char *store_abspath;
+  const char *shared_abspath;
+  const char *pristine_abspath;
+  const char *hexdigest;
+  const svn_checksum_t *sha1;
+  svn_checksum_t *actual_sha1;
+  svn_stream_t *contents;
+
+  const char data[] = "Shared text";
+
+  SVN_ERR(svn_test__sandbox_create(&b1, "pristine_shared_store_corrupt_1",
+                                   opts, pool));
+  SVN_ERR(svn_test__sandbox_create(&b2, "pristine_shared_store_corrupt_2",
+                                   opts, pool));
+
+  store_abspath = svn_dirent_join(svn_dirent_dirname(b1.wc_abspath, pool),
+                                  "pristine_shared_store_corrupt", pool);
+  SVN_ERR(svn_io_remove_dir2(store_abspath, TRUE, NULL, NULL, pool));
+  svn_test_add_dir_cleanup(store_abspath);
+
+  SVN_ERR(svn_config_create2(&config, FALSE, FALSE, pool));
+  svn_config_set(config, SVN_CONFIG_SECTION_WORKING_COPY,
+                 SVN_CONFIG_OPTION_WC_SHARED_PRISTINE_STORE, store_abspath);
+  SVN_ERR(svn_wc_context_create(&wc_ctx1, config, pool, pool));
+  SVN_ERR(svn_wc_context_create(&wc_ctx2, config, pool, pool));
+
+  SVN_ERR(install_text(&sha1, wc_ctx1->db, b1.wc_abspath, data, pool));
+
+  hexdigest = svn_checksum_to_cstring(sha1, pool);
+  shared_abspath = svn_dirent_join_many(pool, store_abspath,
+                                        apr_pstrndup(pool, hexdigest, 2),
+                                        apr_pstrcat(pool, hexdigest,
+                                                    ".svn-base",
+                                                    SVN_VA_NULL),
+                                        SVN_VA_NULL);
+
+  /* Replace the shared text with something else. */
+  SVN_ERR(svn_io_remove_file2(shared_abspath, FALSE, pool));
+  SVN_ERR(svn_io_file_create(shared_abspath, "Corrupted text", pool));
+  SVN_ERR(svn_io_set_file_read_only(shared_abspath, FALSE, pool));
+
+  /* The other working copy must not use it ... */
+  SVN_ERR(svn_wc__get_pristine_contents_by_checksum(&contents, wc_ctx2,
+                                                    b2.wc_abspath, sha1,
+                                                    pool, pool));
+  SVN_TEST_ASSERT(contents == NULL);
+
+  /* ... and keeps the correct text when installing it. */
+  SVN_ERR(svn_io_file_create(shared_abspath, "Corrupted text", pool));
+  SVN_ERR(svn_io_set_file_read_only(shared_abspath, FALSE, pool));
+  SVN_ERR(install_text(&sha1, wc_ctx2->db, b2.wc_abspath, data, pool));
+  SVN_ERR(svn_wc__db_pristine_get_path(&pristine_abspath, wc_ctx2->db,
+                                       b2.wc_abspath, sha1, pool, pool));
+  SVN_ERR(svn_io_file_checksum2(&actual_sha1, pristine_abspath,
+                                svn_checksum_sha1, pool));
+  SVN_TEST_ASSERT(svn_checksum_match(actual_sha1, sha1));
+
+  /* The store has the correct text again. */
+  SVN_ERR(svn_io_file_checksum2(&actual_sha1, shared_abspath,
+                                svn_checksum_sha1, pool));
+  SVN_TEST_ASSERT(svn_checksum_match(actual_sha1, sha1));
+
+  SVN_ERR(svn_wc_context_destroy(wc_ctx1));
+  SVN_ERR(svn_wc_context_destroy(wc_ctx2));
+
+  return SVN_NO_ERROR;
+}
+
 static int max_threads = -1;
 
 static struct svn_test_descriptor_t test_funcs[] =
@@ -318,6 +513,10 @@ static struct svn_test_descriptor_t test_funcs[] =
                        "pristine_delete_while_open"),
     SVN_TEST_OPTS_PASS(reject_mismatching_text,
                        "reject_mismatching_text"),
+    SVN_TEST_OPTS_PASS(pristine_shared_store,
+                       "pristine_shared_store"),
+    SVN_TEST_OPTS_PASS(pristine_shared_store_corrupt,
+                       "pristine_shared_store_corrupt"),
     SVN_TEST_NULL
   };
 
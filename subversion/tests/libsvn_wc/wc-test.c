@@ -493,6 +493,89 @@ test_internal_file_modified(const svn_test_opts_t *opts, apr_pool_t *pool)
   return SVN_NO_ERROR;
 }
 
+/* Implements svn_wc_status_func4_t by appending LOCAL_ABSPATH and the
+   node and text status to the apr_array_header_t * BATON. */
+static svn_error_t *
+collect_status(void *baton,
+               const char *local_abspath,
+               const svn_wc_status3_t *status,
+               apr_pool_t *scratch_pool)
+{
+  apr_array_header_t *statuses = baton;
+
+  APR_ARRAY_PUSH(statuses, const char *)
+    = apr_psprintf(statuses->pool, "%s %d %d", local_abspath,
+                   status->node_status, status->text_status);
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+test_parallel_status(const svn_test_opts_t *opts, apr_pool_t *pool)
+{
+  svn_test__sandbox_t b;
+  svn_config_t *config;
+  svn_wc__db_t *db;
+  apr_array_header_t *expected = apr_array_make(pool, 0, sizeof(char *));
+  apr_array_header_t *actual = apr_array_make(pool, 0, sizeof(char *));
+  const char *rho_path;
+  apr_time_t time;
+  int i;
+
+  SVN_ERR(svn_test__sandbox_create(&b, "parallel_status", opts, pool));
+  SVN_ERR(sbox_add_and_commit_greek_tree(&b));
+
+  /* Same size but different contents. */
+  SVN_ERR(sbox_file_write(&b, "A/D/G/pi", "This is the file 'PI'.\n"));
+  /* Unmodified but with a different timestamp. */
+  rho_path = sbox_wc_path(&b, "A/D/G/rho");
+  SVN_ERR(svn_io_file_affected_time(&time, rho_path, pool));
+  SVN_ERR(svn_io_set_file_affected_time(time + apr_time_from_sec(1),
+                                        rho_path, pool));
+  /* Different size. */
+  SVN_ERR(sbox_file_write(&b, "A/D/G/tau", "new tau\n"));
+  SVN_ERR(sbox_file_write(&b, "A/D/G/unversioned", "new file\n"));
+
+  /* Sequential status walk. */
+  SVN_ERR(svn_wc__internal_walk_status(b.wc_ctx->db, b.wc_abspath,
+                                       svn_depth_infinity, TRUE, FALSE,
+                                       FALSE, NULL, collect_status, expected,
+                                       NULL, NULL, pool));
+
+  /* The same with concurrent text comparisons. */
+  SVN_ERR(svn_config_create2(&config, FALSE, FALSE, pool));
+  svn_config_set(config, SVN_CONFIG_SECTION_WORKING_COPY,
+                 SVN_CONFIG_OPTION_WC_JOBS, "4");
+  SVN_ERR(svn_wc__db_open(&db, config, FALSE, TRUE, pool, pool));
+  SVN_TEST_ASSERT(svn_wc__db_get_jobs(db) == 4);
+  SVN_ERR(svn_wc__internal_walk_status(db, b.wc_abspath,
+                                       svn_depth_infinity, TRUE, FALSE,
+                                       FALSE, NULL, collect_status, actual,
+                                       NULL, NULL, pool));
+  SVN_ERR(svn_wc__db_close(db));
+
+  /* Same results in the same order. */
+  SVN_TEST_INT_ASSERT(actual->nelts, expected->nelts);
+  for (i = 0; i < expected->nelts; i++)
+    SVN_TEST_STRING_ASSERT(APR_ARRAY_IDX(actual, i, const char *),
+                           APR_ARRAY_IDX(expected, i, const char *));
+
+  for (i = 0; i < actual->nelts; i++)
+    {
+      const char *line = APR_ARRAY_IDX(actual, i, const char *);
+      svn_boolean_t modified
+        = strstr(line, apr_psprintf(pool, " %d %d", svn_wc_status_modified,
+                                    svn_wc_status_modified)) != NULL;
+
+      if (strstr(line, "pi ") || strstr(line, "tau "))
+        SVN_TEST_ASSERT(modified);
+      else
+        SVN_TEST_ASSERT(!modified);
+    }
+
+  return SVN_NO_ERROR;
+}
+
 /* ---------------------------------------------------------------------- */
 /* The list of test functions */
 
@@ -515,6 +598,8 @@ static struct svn_test_descriptor_t test_funcs[] =
                        "test legacy commit2"),
     SVN_TEST_OPTS_PASS(test_internal_file_modified,
                        "test internal_file_modified"),
+    SVN_TEST_OPTS_PASS(test_parallel_status,
+                       "test status walk with concurrent text checks"),
     SVN_TEST_NULL
   };
 
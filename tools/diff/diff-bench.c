@@ -0,0 +1,260 @@
+/* diff-bench.c -- measure the throughput of file diffs
+ *
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ */
+
+/* Generate pairs of large text files and time svn_diff_file_diff_2() on
+ * them.  Run the same command with two builds to compare them, e.g.
+ *
+ *   diff-bench -s 64 -l 8 -n 5
+ *
+ * The scenarios are:
+ *
+ *   prefix   one changed line in the middle; almost everything is found
+ *            by the identical prefix and suffix scans
+ *   scatter  a changed line every 1000 lines; almost everything goes
+ *            through the tokenizer and the LCS
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <apr.h>
+#include <apr_general.h>
+#include <apr_file_io.h>
+#include <apr_time.h>
+
+#include "svn_pools.h"
+#include "svn_diff.h"
+#include "svn_dirent_uri.h"
+#include "svn_io.h"
+#include "svn_string.h"
+
+/* Append about SIZE bytes of text to ORIGINAL and MODIFIED, with lines of
+ * about LINE_LENGTH bytes (including the EOL).  Every CHANGE_INTERVAL-th
+ * line differs between the two, starting at line FIRST_CHANGE. */
+static void
+generate_text(svn_stringbuf_t *original,
+              svn_stringbuf_t *modified,
+              apr_size_t size,
+              apr_size_t line_length,
+              const char *eol,
+              apr_size_t first_change,
+              apr_size_t change_interval)
+{
+  static const char alphabet[] = "abcdefghijklmnopqrstuvwxyz0123456789 ";
+  apr_size_t eol_len = strlen(eol);
+  apr_size_t text_len = line_length > eol_len ? line_length - eol_len : 0;
+  apr_uint32_t seed = 4711;
+  apr_size_t line;
+
+  for (line = 0; original->len < size; line++)
+    {
+      apr_size_t start = original->len;
+      apr_size_t len = text_len / 2 + (seed >> 16) % (text_len + 1);
+      apr_size_t i;
+
+      for (i = 0; i < len; i++)
+        {
+          seed = seed * 1103515245 + 12345;
+          svn_stringbuf_appendbyte(original,
+                                   alphabet[(seed >> 16)
+                                            % (sizeof(alphabet) - 1)]);
+        }
+      svn_stringbuf_appendcstr(original, eol);
+
+      if (line >= first_change
+          && (line - first_change) % change_interval == 0)
+        {
+          svn_stringbuf_appendcstr(modified, "changed");
+          svn_stringbuf_appendcstr(modified, eol);
+        }
+      else
+        svn_stringbuf_appendbytes(modified, original->data + start,
+                                  original->len - start);
+    }
+}
+
+/* Diff the files ORIGINAL_PATH and MODIFIED_PATH ITERATIONS times and
+ * print the throughput as NAME.  SIZE is the size of one file. */
+static svn_error_t *
+run_scenario(const char *name,
+             const char *original_path,
+             const char *modified_path,
+             apr_size_t size,
+             int iterations,
+             const svn_diff_file_options_t *options,
+             apr_pool_t *pool)
+{
+  apr_pool_t *iterpool = svn_pool_create(pool);
+  apr_time_t best = 0;
+  int i;
+
+  for (i = 0; i < iterations; i++)
+    {
+      svn_diff_t *diff;
+      apr_time_t start;
+      apr_time_t duration;
+
+      svn_pool_clear(iterpool);
+
+      start = apr_time_now();
+      SVN_ERR(svn_diff_file_diff_2(&diff, original_path, modified_path,
+                                   options, iterpool));
+      duration = apr_time_now() - start;
+
+      if (i == 0 || duration < best)
+        best = duration;
+    }
+  svn_pool_destroy(iterpool);
+
+  if (best == 0)
+    best = 1;
+
+  printf("%-8s %10.3f ms %10.1f MB/s\n", name,
+         (double)best / 1000,
+         2.0 * size / (1024 * 1024) / ((double)best / APR_USEC_PER_SEC));
+
+  return SVN_NO_ERROR;
+}
+
+/* Generate the files for one scenario in DIR and time their diff. */
+static svn_error_t *
+benchmark(const char *name,
+          const char *dir,
+          apr_size_t size,
+          apr_size_t line_length,
+          const char *eol,
+          svn_boolean_t scatter,
+          int iterations,
+          const svn_diff_file_options_t *options,
+          apr_pool_t *pool)
+{
+  svn_stringbuf_t *original = svn_stringbuf_create_ensure(size + 1024, pool);
+  svn_stringbuf_t *modified = svn_stringbuf_create_ensure(size + 1024, pool);
+  const char *original_path = svn_dirent_join(dir, "original", pool);
+  const char *modified_path = svn_dirent_join(dir, "modified", pool);
+  apr_size_t lines = size / line_length;
+
+  if (scatter)
+    generate_text(original, modified, size, line_length, eol, 500, 1000);
+  else
+    generate_text(original, modified, size, line_length, eol,
+                  lines / 2, lines + 1);
+
+  SVN_ERR(svn_io_file_create_bytes(original_path, original->data,
+                                   original->len, pool));
+  SVN_ERR(svn_io_file_create_bytes(modified_path, modified->data,
+                                   modified->len, pool));
+
+  SVN_ERR(run_scenario(name, original_path, modified_path, original->len,
+                       iterations, options, pool));
+
+  SVN_ERR(svn_io_remove_file2(original_path, FALSE, pool));
+  SVN_ERR(svn_io_remove_file2(modified_path, FALSE, pool));
+
+  return SVN_NO_ERROR;
+}
+
+static void
+print_usage(const char *progname)
+{
+  printf("Usage: %s [-s MB] [-l LINE_LENGTH] [-n ITERATIONS] [--crlf] "
+         "[-w] [--patience] [-m MB] [DIR]\n"
+         "\n"
+         "Time diffs of generated files of MB megabytes (default: 64)\n"
+         "with lines of about LINE_LENGTH bytes (default: 40), using\n"
+         "the best of ITERATIONS runs (default: 3).  The files are\n"
+         "created in DIR (default: the current directory).  With -m,\n"
+         "the diff may use about MB megabytes of memory for its tokens.\n",
+         progname);
+}
+
+int main(int argc, const char *argv[])
+{
+  apr_pool_t *pool;
+  svn_error_t *err = SVN_NO_ERROR;
+  svn_diff_file_options_t *options;
+  apr_size_t size = 64;
+  apr_size_t line_length = 40;
+  int iterations = 3;
+  const char *eol = "\n";
+  const char *dir = ".";
+  int i;
+
+  apr_initialize();
+  atexit(apr_terminate);
+
+  pool = svn_pool_create(NULL);
+  options = svn_diff_file_options_create(pool);
+
+  for (i = 1; i < argc; i++)
+    {
+      if (!strcmp(argv[i], "-s") && i + 1 < argc)
+        size = (apr_size_t)atol(argv[++i]);
+      else if (!strcmp(argv[i], "-l") && i + 1 < argc)
+        line_length = (apr_size_t)atol(argv[++i]);
+      else if (!strcmp(argv[i], "-n") && i + 1 < argc)
+        iterations = atoi(argv[++i]);
+      else if (!strcmp(argv[i], "--crlf"))
+        eol = "\r\n";
+      else if (!strcmp(argv[i], "-w"))
+        options->ignore_space = svn_diff_file_ignore_space_all;
+      else if (!strcmp(argv[i], "--patience"))
+        options->algorithm = svn_diff_file_algorithm_patience;
+      else if (!strcmp(argv[i], "-m") && i + 1 < argc)
+        options->memory_limit = (apr_size_t)atol(argv[++i]) * 1024 * 1024;
+      else if (argv[i][0] != '-' && !strcmp(dir, "."))
+        dir = argv[i];
+      else
+        {
+          print_usage(argv[0]);
+          return 2;
+        }
+    }
+
+  if (size == 0 || line_length < 2 || iterations < 1)
+    {
+      print_usage(argv[0]);
+      return 2;
+    }
+
+  printf("%" APR_SIZE_T_FMT " MB, lines of ~%" APR_SIZE_T_FMT " bytes, "
+         "%s EOLs, best of %d\n",
+         size, line_length, eol[0] == '\r' ? "CRLF" : "LF", iterations);
+
+  size *= 1024 * 1024;
+  err = benchmark("prefix", dir, size, line_length, eol, FALSE,
+                  iterations, options, pool);
+  if (!err)
+    err = benchmark("scatter", dir, size, line_length, eol, TRUE,
+                    iterations, options, pool);
+
+  if (err)
+    {
+      svn_handle_error2(err, stderr, FALSE, "diff-bench: ");
+      svn_error_clear(err);
+      return 1;
+    }
+
+  svn_pool_destroy(pool);
+  return 0;
+}